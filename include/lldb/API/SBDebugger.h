@@ -153,6 +153,11 @@ public:
   ///     must be less than the value returned by GetNumAvailablePlatforms().
   lldb::SBStructuredData GetAvailablePlatformInfoAtIndex(uint32_t idx);
 
+  /// Get the number of bytes used by the string pool, by each module and by
+  /// the processes of this debugger's targets, the same numbers as the
+  /// "statistics memory" command reports.
+  lldb::SBStructuredData GetMemoryStatistics();
+
   lldb::SBSourceManager GetSourceManager();
 
   // REMOVE: just for a quick fix, need to expose platforms through
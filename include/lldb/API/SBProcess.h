@@ -165,6 +165,14 @@ public:
 
   lldb::SBError Continue();
 
+  //------------------------------------------------------------------
+  /// Resume the process, running it backward if \a direction is
+  /// lldb::eRunReverse. Running backward goes to the previous breakpoint
+  /// or watchpoint hit, or to the start of the execution history, which the
+  /// process must be recording.
+  //------------------------------------------------------------------
+  lldb::SBError ContinueInDirection(lldb::RunDirection direction);
+
   lldb::SBError Stop();
 
   lldb::SBError Kill();
@@ -32,6 +32,7 @@
 #include "lldb/Utility/ConstString.h" // for ConstString
 #include "lldb/Utility/FileSpec.h"    // for FileSpec
 #include "lldb/Utility/Status.h"      // for Status
+#include "lldb/Utility/StructuredData.h"
 #include "lldb/Utility/UserID.h"
 #include "lldb/lldb-defines.h"              // for DISALLOW_COPY_AND_ASSIGN
 #include "lldb/lldb-enumerations.h"         // for ScriptLanguage, Langua...
@@ -180,6 +181,13 @@ public:
 
   PlatformList &GetPlatformList() { return m_platform_list; }
 
+  //------------------------------------------------------------------
+  /// Report the memory used by the string pool, and by the modules and the
+  /// processes of this debugger's targets, in bytes. The numbers come from
+  /// counters the owners keep; nothing is parsed or walked to compute them.
+  //------------------------------------------------------------------
+  StructuredData::DictionarySP GetMemoryStatistics();
+
   void DispatchInputInterrupt();
 
   void DispatchInputEndOfFile();
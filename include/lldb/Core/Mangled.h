@@ -182,6 +182,17 @@ public:
   //----------------------------------------------------------------------
   const ConstString &GetDemangledName(lldb::LanguageType language) const;
 
+  //----------------------------------------------------------------------
+  /// Demangled name get accessor that doesn't demangle.
+  ///
+  /// @return
+  ///     The demangled name if it was already computed or set, an empty
+  ///     string otherwise.
+  //----------------------------------------------------------------------
+  const ConstString &GetDemangledNameIfComputed() const {
+    return m_demangled;
+  }
+
   //----------------------------------------------------------------------
   /// Display demangled name get accessor.
   ///
@@ -26,11 +26,13 @@
 #include "lldb/lldb-forward.h"
 #include "lldb/lldb-types.h" // for addr_t, offset_t
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Chrono.h"
 
 #include <atomic>
+#include <functional>
 #include <memory> // for enable_shared_from_this
 #include <mutex>
 #include <stddef.h> // for size_t
@@ -609,6 +611,71 @@ public:
 
   void PreloadSymbols();
 
+  // Read ahead the debug information for the types with the given names.
+  // See SymbolFile::PrefetchTypes().
+  void PrefetchTypes(llvm::ArrayRef<ConstString> names);
+
+  //------------------------------------------------------------------
+  /// The number of bytes used by debug information parsed from the symbol
+  /// file that FreeParsedDebugInfo() could free.
+  //------------------------------------------------------------------
+  size_t GetParsedDebugInfoSize();
+
+  //------------------------------------------------------------------
+  /// Free the parts of the parsed debug information that can be parsed
+  /// again on demand. Neither this nor GetParsedDebugInfoSize() counts as a
+  /// use of the debug information.
+  ///
+  /// @return
+  ///     The number of bytes freed.
+  //------------------------------------------------------------------
+  size_t FreeParsedDebugInfo();
+
+  //------------------------------------------------------------------
+  /// The debug info use epoch during which this module's debug information
+  /// was last used.
+  //------------------------------------------------------------------
+  uint64_t GetLastDebugInfoUse() const { return m_last_debug_info_use; }
+
+  //------------------------------------------------------------------
+  /// Start a new debug info use epoch. This happens at every public stop,
+  /// so modules are only ordered by the stop they were last used before.
+  /// In exchange, using the debug info only reads a shared counter and
+  /// writes the module's own stamp once per stop.
+  //------------------------------------------------------------------
+  static void AdvanceDebugInfoUseEpoch();
+
+  //------------------------------------------------------------------
+  /// The number of bytes used by what has been parsed from this module so
+  /// far, by kind.
+  //------------------------------------------------------------------
+  struct MemoryUsage {
+    size_t GetTotal() const {
+      return symbols + symbol_indexes + debug_info + line_tables +
+             type_systems;
+    }
+
+    MemoryUsage &operator+=(const MemoryUsage &rhs) {
+      symbols += rhs.symbols;
+      symbol_indexes += rhs.symbol_indexes;
+      debug_info += rhs.debug_info;
+      line_tables += rhs.line_tables;
+      type_systems += rhs.type_systems;
+      return *this;
+    }
+
+    size_t symbols = 0;
+    size_t symbol_indexes = 0;
+    size_t debug_info = 0;
+    size_t line_tables = 0;
+    size_t type_systems = 0;
+  };
+
+  //------------------------------------------------------------------
+  /// Get the memory used by this module. Nothing is parsed to compute it.
+  //------------------------------------------------------------------
+  MemoryUsage GetMemoryUsage();
+
   void SetSymbolFileFileSpec(const FileSpec &file);
 
   const llvm::sys::TimePoint<> &GetModificationTime() const {
@@ -921,6 +988,8 @@ public:
 
   TypeSystem *GetTypeSystemForLanguage(lldb::LanguageType language);
 
+  void ForEachTypeSystem(std::function<bool(TypeSystem *)> const &callback);
+
   // Special error functions that can do printf style formatting that will
   // prepend the message with something appropriate for this module (like the
   // architecture, path and object name (if any)). This centralizes code so
@@ -1115,6 +1184,7 @@ protected:
   std::atomic<bool> m_did_load_objfile{false};
   std::atomic<bool> m_did_load_symbol_vendor{false};
   std::atomic<bool> m_did_set_uuid{false};
+  std::atomic<uint64_t> m_last_debug_info_use{0};
   mutable bool m_file_has_changed : 1,
       m_first_file_changed_log : 1; /// See if the module was modified after it
                                     /// was initially opened.
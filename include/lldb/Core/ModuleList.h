@@ -22,6 +22,7 @@
 
 #include "llvm/ADT/DenseSet.h"
 
+#include <atomic>
 #include <functional>
 #include <list>
 #include <mutex>
@@ -82,6 +83,9 @@ public:
   FileSpec GetClangModulesCachePath() const;
   bool SetClangModulesCachePath(llvm::StringRef path);
   bool GetEnableExternalLookup() const;
+  bool GetEnableRegexIndex() const;
+  FileSpec GetIndexCachePath() const;
+  uint64_t GetDebugInfoMemoryBudget() const;
 }; 
 
 //----------------------------------------------------------------------
@@ -547,6 +551,25 @@ public:
   static size_t RemoveOrphanSharedModules(bool mandatory);
 
   static bool RemoveSharedModuleIfOrphaned(const Module *module_ptr);
+
+  // Counters for the debug info freed to stay within symbols.memory-budget.
+  struct DebugInfoEvictionStats {
+    std::atomic<uint64_t> num_evictions{0};
+    std::atomic<uint64_t> bytes_freed{0};
+    // Units parsed again after their debug info was freed, and the time that
+    // took.
+    std::atomic<uint64_t> num_reparses{0};
+    std::atomic<uint64_t> reparse_nanos{0};
+  };
+
+  static DebugInfoEvictionStats &GetDebugInfoEvictionStats();
+
+  //------------------------------------------------------------------
+  /// Free the parsed debug info of the least recently used modules in this
+  /// list until all of it fits in symbols.memory-budget. Modules of other
+  /// targets and debuggers are left alone.
+  //------------------------------------------------------------------
+  void EnforceDebugInfoMemoryBudget();
   
   void ForEach(std::function<bool(const lldb::ModuleSP &module_sp)> const
                    &callback) const;
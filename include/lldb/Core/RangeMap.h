@@ -931,6 +931,8 @@ public:
 
   size_t GetSize() const { return m_entries.size(); }
 
+  size_t MemorySize() const { return m_entries.capacity() * sizeof(Entry); }
+
   const Entry *GetEntryAtIndex(size_t i) const {
     return ((i < m_entries.size()) ? &m_entries[i] : nullptr);
   }
@@ -202,6 +202,11 @@ public:
   //------------------------------------------------------------------
   bool IsEmpty() const { return m_map.empty(); }
 
+  //------------------------------------------------------------------
+  // Get the number of bytes used by the entries of this map.
+  //------------------------------------------------------------------
+  size_t MemorySize() const { return m_map.capacity() * sizeof(Entry); }
+
   //------------------------------------------------------------------
   // Reserve memory for at least "n" entries in the map. This is useful to call
   // when you know you will be adding a lot of entries using
@@ -22,6 +22,8 @@
 
 #define HAVE_SYS_EVENT_H 1
 
+#define HAVE_SYS_EPOLL_H 0
+
 #define HAVE_PPOLL 0
 
 #define HAVE_SIGACTION 1
@@ -22,6 +22,8 @@
 
 #cmakedefine01 HAVE_SYS_EVENT_H
 
+#cmakedefine01 HAVE_SYS_EPOLL_H
+
 #cmakedefine01 HAVE_PPOLL
 
 #cmakedefine01 HAVE_SIGACTION
@@ -34,4 +36,8 @@
 #cmakedefine HAVE_LIBCOMPRESSION
 #endif
 
+#ifndef HAVE_LIBZ
+#cmakedefine HAVE_LIBZ
+#endif
+
 #endif // #ifndef LLDB_HOST_CONFIG_H
@@ -31,6 +31,9 @@ struct ResumeAction {
                          // eStateRunning, and eStateStepping.
   int signal; // When resuming this thread, resume it with this signal if this
               // value is > 0
+  lldb::addr_t step_range_start; // A stepping thread keeps stepping while
+  lldb::addr_t step_range_end;   // its pc is in [start, end). Ignored when
+                                 // the range is empty.
 };
 
 //------------------------------------------------------------------
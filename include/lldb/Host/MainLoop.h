@@ -13,18 +13,24 @@
 #include "lldb/Host/Config.h"
 #include "lldb/Host/MainLoopBase.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include <csignal>
 
-#if !HAVE_PPOLL && !HAVE_SYS_EVENT_H && !defined(__ANDROID__)
+#if HAVE_SYS_EPOLL_H && !defined(__ANDROID__)
+#define MAINLOOP_USE_EPOLL 1
+#endif
+
+#if !HAVE_PPOLL && !HAVE_SYS_EVENT_H && !defined(__ANDROID__) &&              \
+    !MAINLOOP_USE_EPOLL
 #define SIGNAL_POLLING_UNSUPPORTED 1
 #endif
 
 namespace lldb_private {
 
 // Implementation of the MainLoopBase class. It can monitor file descriptors
-// for readability using ppoll, kqueue, poll or WSAPoll. On Windows it only
-// supports polling sockets, and will not work on generic file handles or
-// pipes. On systems without kqueue or ppoll handling singnals is not
+// for readability using epoll, ppoll, kqueue, poll or WSAPoll. On Windows it
+// only supports polling sockets, and will not work on generic file handles or
+// pipes. On systems without epoll, kqueue or ppoll handling singnals is not
 // supported. In addition to the common base, this class provides the ability
 // to invoke a given handler when a signal is received.
 //
@@ -103,6 +109,13 @@ private:
   llvm::DenseMap<int, SignalInfo> m_signals;
 #if HAVE_SYS_EVENT_H
   int m_kqueue;
+#endif
+#if MAINLOOP_USE_EPOLL
+  // The descriptors are added to the epoll set as they are registered, rather
+  // than on every iteration. Those epoll can't watch, such as regular files,
+  // are always readable.
+  int m_epoll;
+  llvm::DenseSet<IOObject::WaitableHandle> m_unwatched_fds;
 #endif
   bool m_terminate_request : 1;
 };
@@ -11,22 +11,126 @@
 #define utility_TaskPool_h_
 
 #include "llvm/ADT/STLExtras.h"
+#include <atomic>
+#include <cstddef>
 #include <functional> // for bind, function
 #include <future>
-#include <list>
-#include <memory>      // for make_shared
-#include <mutex>       // for mutex, unique_lock, condition_variable
+#include <memory>
 #include <type_traits> // for forward, result_of, move
 
 namespace lldb_private {
 
+// A move-only void() callable for the task pool. Callables of up to
+// kInlineSize bytes, which covers lambdas capturing a few references and
+// std::packaged_task, are stored in place rather than on the heap.
+class Task {
+public:
+  static constexpr size_t kInlineSize = 6 * sizeof(void *);
+
+  Task() = default;
+
+  template <typename F, typename = typename std::enable_if<!std::is_same<
+                            typename std::decay<F>::type, Task>::value>::type>
+  Task(F &&f) {
+    Init<typename std::decay<F>::type>(std::forward<F>(f));
+  }
+
+  Task(Task &&other) { MoveFrom(other); }
+
+  Task &operator=(Task &&other) {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  ~Task() { Reset(); }
+
+  explicit operator bool() const { return m_ops != nullptr; }
+
+  void operator()() { m_ops->invoke(&m_storage); }
+
+private:
+  struct Ops {
+    void (*invoke)(void *storage);
+    // Move construct the callable in dst from src and destroy src.
+    void (*relocate)(void *dst, void *src);
+    void (*destroy)(void *storage);
+  };
+
+  template <typename F> struct InlineOps {
+    static void Invoke(void *storage) { (*static_cast<F *>(storage))(); }
+    static void Relocate(void *dst, void *src) {
+      new (dst) F(std::move(*static_cast<F *>(src)));
+      static_cast<F *>(src)->~F();
+    }
+    static void Destroy(void *storage) { static_cast<F *>(storage)->~F(); }
+    static const Ops ops;
+  };
+
+  template <typename F> struct HeapOps {
+    static void Invoke(void *storage) { (**static_cast<F **>(storage))(); }
+    static void Relocate(void *dst, void *src) {
+      *static_cast<F **>(dst) = *static_cast<F **>(src);
+    }
+    static void Destroy(void *storage) { delete *static_cast<F **>(storage); }
+    static const Ops ops;
+  };
+
+  typedef typename std::aligned_storage<kInlineSize>::type Storage;
+
+  template <typename F, typename U> void Init(U &&f) {
+    if (sizeof(F) <= sizeof(Storage) &&
+        alignof(F) <= alignof(Storage) &&
+        std::is_nothrow_move_constructible<F>::value) {
+      new (&m_storage) F(std::forward<U>(f));
+      m_ops = &InlineOps<F>::ops;
+    } else {
+      *reinterpret_cast<F **>(&m_storage) = new F(std::forward<U>(f));
+      m_ops = &HeapOps<F>::ops;
+    }
+  }
+
+  void MoveFrom(Task &other) {
+    m_ops = other.m_ops;
+    if (m_ops)
+      m_ops->relocate(&m_storage, &other.m_storage);
+    other.m_ops = nullptr;
+  }
+
+  void Reset() {
+    if (m_ops)
+      m_ops->destroy(&m_storage);
+    m_ops = nullptr;
+  }
+
+  const Ops *m_ops = nullptr;
+  Storage m_storage;
+
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+};
+
+template <typename F>
+const Task::Ops Task::InlineOps<F>::ops = {&Invoke, &Relocate, &Destroy};
+template <typename F>
+const Task::Ops Task::HeapOps<F>::ops = {&Invoke, &Relocate, &Destroy};
+
+class TaskGroup;
+class TaskPoolImpl;
+
 // Global TaskPool class for running tasks in parallel on a set of worker
-// thread created the first time the task pool is used. The TaskPool provide no
-// guarantee about the order the task will be run and about what tasks will run
-// in parallel. None of the task added to the task pool should block on
-// something (mutex, future, condition variable) what will be set only by the
-// completion of an other task on the task pool as they may run on the same
-// thread sequentally.
+// threads created the first time the task pool is used. Each worker has its
+// own queue of tasks; tasks added from a worker go to that worker's queue,
+// and idle workers steal from the others. The TaskPool provides no guarantee
+// about the order the tasks will be run and about what tasks will run in
+// parallel.
+//
+// Blocking on a std::future returned by AddTask() from a task may deadlock
+// if the task it waits for is queued behind it. Use a TaskGroup, RunTasks()
+// or TaskMapOverInt() instead: their waits run the group's own queued tasks
+// until the group is done, so they can be nested.
 class TaskPool {
 public:
   // Add a new task to the task pool and return a std::future belonging to the
@@ -39,52 +143,112 @@ public:
   // Run all of the specified tasks on the task pool and wait until all of them
   // are finished before returning. This method is intended to be used for
   // small number tasks where listing them as function arguments is acceptable.
-  // For running large number of tasks you should use AddTask for each task and
-  // then call wait() on each returned future.
+  // For running large number of tasks you should use a TaskGroup.
   template <typename... T> static void RunTasks(T &&... tasks);
 
 private:
   TaskPool() = delete;
 
+  friend class TaskGroup;
+
   template <typename... T> struct RunTaskImpl;
 
-  static void AddTaskImpl(std::function<void()> &&task_fn);
+  static void AddTaskImpl(Task &&task, TaskGroup *group = nullptr);
+
+  // Run the queued tasks of \a group on the calling thread until all of its
+  // tasks are done.
+  static void RunUntilDone(TaskGroup &group);
+
+  // Wake the threads waiting for a group so they check it again.
+  static void NotifyWaiters();
+};
+
+// A set of tasks that are waited for together. The thread waiting for them
+// runs the group's queued tasks in the meantime, so waiting from a pool
+// thread can't starve the pool. It never picks up unrelated tasks, which
+// could take much longer than the group itself.
+class TaskGroup {
+public:
+  TaskGroup() = default;
+
+  ~TaskGroup() { Wait(); }
+
+  template <typename F> void Add(F &&f) {
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    TaskPool::AddTaskImpl(
+        Task(Runner<typename std::decay<F>::type>(*this, std::forward<F>(f))),
+        this);
+  }
+
+  void Wait() {
+    if (!IsDone())
+      TaskPool::RunUntilDone(*this);
+  }
+
+  bool IsDone() const {
+    return m_pending.load(std::memory_order_acquire) == 0;
+  }
+
+private:
+  friend class TaskPoolImpl;
+
+  template <typename F> struct Runner {
+    template <typename U>
+    Runner(TaskGroup &group, U &&f) : group(&group), f(std::forward<U>(f)) {}
+    void operator()() {
+      f();
+      if (group->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        TaskPool::NotifyWaiters();
+    }
+    TaskGroup *group;
+    F f;
+  };
+
+  std::atomic<size_t> m_pending{0};
+  // The tasks that are queued and not started yet. The waiting thread sleeps
+  // while there are none.
+  std::atomic<size_t> m_queued{0};
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
 };
 
 template <typename F, typename... Args>
 std::future<typename std::result_of<F(Args...)>::type>
 TaskPool::AddTask(F &&f, Args &&... args) {
-  auto task_sp = std::make_shared<
-      std::packaged_task<typename std::result_of<F(Args...)>::type()>>(
+  std::packaged_task<typename std::result_of<F(Args...)>::type()> task(
       std::bind(std::forward<F>(f), std::forward<Args>(args)...));
-
-  AddTaskImpl([task_sp]() { (*task_sp)(); });
-
-  return task_sp->get_future();
+  auto future = task.get_future();
+  AddTaskImpl(Task(std::move(task)));
+  return future;
 }
 
 template <typename... T> void TaskPool::RunTasks(T &&... tasks) {
-  RunTaskImpl<T...>::Run(std::forward<T>(tasks)...);
+  TaskGroup group;
+  RunTaskImpl<T...>::Run(group, std::forward<T>(tasks)...);
+  group.Wait();
 }
 
 template <typename Head, typename... Tail>
 struct TaskPool::RunTaskImpl<Head, Tail...> {
-  static void Run(Head &&h, Tail &&... t) {
-    auto f = AddTask(std::forward<Head>(h));
-    RunTaskImpl<Tail...>::Run(std::forward<Tail>(t)...);
-    f.wait();
+  static void Run(TaskGroup &group, Head &&h, Tail &&... t) {
+    group.Add(std::forward<Head>(h));
+    RunTaskImpl<Tail...>::Run(group, std::forward<Tail>(t)...);
   }
 };
 
 template <> struct TaskPool::RunTaskImpl<> {
-  static void Run() {}
+  static void Run(TaskGroup &group) {}
 };
 
-// Run 'func' on every value from begin .. end-1.  Each worker will grab
-// 'batch_size' numbers at a time to work on, so for very fast functions, batch
-// should be large enough to avoid too much cache line contention.
+// Run 'func' on every value from begin .. end-1. Each worker grabs
+// 'batch_size' numbers at a time to work on, so for very fast functions,
+// batch should be large enough to avoid too much cache line contention. At
+// most 'max_parallelism' threads, the calling one included, work on the
+// range at once; 0 means as many as the pool has.
 void TaskMapOverInt(size_t begin, size_t end,
-                    const llvm::function_ref<void(size_t)> &func);
+                    const llvm::function_ref<void(size_t)> &func,
+                    size_t batch_size = 1, size_t max_parallelism = 0);
 
 unsigned GetHardwareConcurrencyHint();
 
@@ -49,6 +49,12 @@ public:
 
   Status RemoveTrapsFromBuffer(lldb::addr_t addr, void *buf, size_t size) const;
 
+  // Called after the memory in [addr, addr + size) was overwritten with
+  // contents that have no breakpoint traps, such as a saved copy of the
+  // memory. Saves the new opcodes under the enabled software breakpoints in
+  // the range and writes their traps again.
+  Status ReinsertTraps(lldb::addr_t addr, size_t size);
+
 private:
   typedef std::map<lldb::addr_t, NativeBreakpointSP> BreakpointMap;
 
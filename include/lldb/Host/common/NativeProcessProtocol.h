@@ -25,12 +25,22 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <string>
 #include <vector>
 
 namespace lldb_private {
 class MemoryRegionInfo;
 class ResumeActionList;
 
+// One entry of the dynamic linker's link_map list.
+struct SVR4LibraryInfo {
+  std::string name;
+  lldb::addr_t link_map;
+  lldb::addr_t base_addr;
+  lldb::addr_t ld_addr;
+  lldb::addr_t next;
+};
+
 //------------------------------------------------------------------
 // NativeProcessProtocol
 //------------------------------------------------------------------
@@ -87,6 +97,19 @@ public:
   virtual Status ReadMemoryWithoutTrap(lldb::addr_t addr, void *buf,
                                        size_t size, size_t &bytes_read) = 0;
 
+  //----------------------------------------------------------------------
+  /// Reads a null terminated string from memory.
+  ///
+  /// Memory is read in page sized pieces, so this never reads past the
+  /// page holding the terminator.
+  ///
+  /// @param[out] total_bytes_read
+  ///     The number of bytes read, not counting the terminator. The string
+  ///     in \a buffer is always terminated, and truncated if it doesn't fit.
+  //----------------------------------------------------------------------
+  Status ReadCStringFromMemory(lldb::addr_t addr, char *buffer,
+                               size_t max_size, size_t &total_bytes_read);
+
   virtual Status WriteMemory(lldb::addr_t addr, const void *buf, size_t size,
                              size_t &bytes_written) = 0;
 
@@ -97,6 +120,23 @@ public:
 
   virtual lldb::addr_t GetSharedLibraryInfoAddress() = 0;
 
+  //----------------------------------------------------------------------
+  /// Get the address of the pointer to the dynamic linker's r_debug
+  /// structure, the value of the DT_DEBUG entry in the dynamic section of
+  /// the executable. This is what the qShlibInfoAddr packet returns.
+  //----------------------------------------------------------------------
+  virtual lldb::addr_t GetDebugEntryAddress() { return LLDB_INVALID_ADDRESS; }
+
+  //----------------------------------------------------------------------
+  /// Walks the dynamic linker's list of loaded libraries, as reported by
+  /// the qXfer:libraries-svr4:read packet.
+  //----------------------------------------------------------------------
+  virtual llvm::Expected<std::vector<SVR4LibraryInfo>>
+  GetLoadedSVR4Libraries() {
+    return llvm::make_error<llvm::StringError>(
+        "Not implemented", llvm::inconvertibleErrorCode());
+  }
+
   virtual bool IsAlive() const;
 
   virtual size_t UpdateThreads() = 0;
@@ -181,6 +221,58 @@ public:
     return GetThreadByID(m_current_thread_id);
   }
 
+  //----------------------------------------------------------------------
+  // Non-stop mode
+  //----------------------------------------------------------------------
+
+  //------------------------------------------------------------------
+  /// Enable or disable non-stop mode.
+  ///
+  /// In non-stop mode a thread that stops for an event does not stop
+  /// the other threads of the process. Each stopped thread is reported
+  /// to the delegates with NativeDelegate::ThreadStopped() instead of a
+  /// change of the process state. Only processes created by a Factory
+  /// that SupportsNonStopMode() honor this.
+  //------------------------------------------------------------------
+  void SetNonStopMode(bool enabled) { m_non_stop = enabled; }
+
+  bool GetNonStopMode() const { return m_non_stop; }
+
+  //----------------------------------------------------------------------
+  // Reverse execution
+  //----------------------------------------------------------------------
+
+  //------------------------------------------------------------------
+  /// Start or stop recording the execution history of the process.
+  ///
+  /// The process must be stopped. While the history is recorded, the
+  /// process can run backward with ReverseResume().
+  //------------------------------------------------------------------
+  virtual Status SetRecordHistory(bool enabled) {
+    return Status("Not implemented");
+  }
+
+  //------------------------------------------------------------------
+  /// Run the process backward through its recorded history.
+  ///
+  /// @param[in] tid
+  ///     The thread to step backward, if \a state is eStateStepping.
+  ///
+  /// @param[in] state
+  ///     eStateStepping to run \a tid backward by one instruction, or
+  ///     eStateRunning to run the process backward to the last
+  ///     breakpoint or watchpoint hit.
+  ///
+  /// @return
+  ///     Status indicating what went wrong. On success, the process
+  ///     state goes to running then stopped, like it does for Resume(),
+  ///     and the stop reason is eStopReasonHistoryBoundary if the
+  ///     process got to the start of its history.
+  //------------------------------------------------------------------
+  virtual Status ReverseResume(lldb::tid_t tid, lldb::StateType state) {
+    return Status("Not implemented");
+  }
+
   //----------------------------------------------------------------------
   // Access to inferior stdio
   //----------------------------------------------------------------------
@@ -205,6 +297,11 @@ public:
                                      lldb::StateType state) = 0;
 
     virtual void DidExec(NativeProcessProtocol *process) = 0;
+
+    // Called in non-stop mode when a single thread stops while the other
+    // threads of the process may still be running.
+    virtual void ThreadStopped(NativeProcessProtocol *process,
+                               NativeThreadProtocol &thread) = 0;
   };
 
   //------------------------------------------------------------------
@@ -250,6 +347,16 @@ public:
   class Factory {
   public:
     virtual ~Factory();
+
+    //------------------------------------------------------------------
+    /// @return
+    ///     True if the processes created by this factory can run in
+    ///     non-stop mode.
+    ///
+    /// @see NativeProcessProtocol::SetNonStopMode
+    //------------------------------------------------------------------
+    virtual bool SupportsNonStopMode() const { return false; }
+
     //------------------------------------------------------------------
     /// Launch a process for debugging.
     ///
@@ -420,6 +527,7 @@ protected:
   HardwareBreakpointMap m_hw_breakpoints_map;
   int m_terminal_fd;
   uint32_t m_stop_id = 0;
+  bool m_non_stop = false;
 
   // Set of signal numbers that LLDB directly injects back to inferior without
   // stopping it.
@@ -461,6 +569,11 @@ protected:
   // -----------------------------------------------------------
   void NotifyDidExec();
 
+  // -----------------------------------------------------------
+  /// Notify the delegates that \a thread stopped in non-stop mode.
+  // -----------------------------------------------------------
+  void NotifyThreadStopped(NativeThreadProtocol &thread);
+
   NativeThreadProtocol *GetThreadByIDUnlocked(lldb::tid_t tid);
 
 private:
@@ -0,0 +1,132 @@
+//===-- ConnectionSharedMemory.h --------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_Host_linux_ConnectionSharedMemory_h_
+#define liblldb_Host_linux_ConnectionSharedMemory_h_
+
+// C++ Includes
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// Other libraries and framework includes
+#include "llvm/ADT/Optional.h"
+
+// Project includes
+#include "lldb/Utility/Connection.h"
+#include "lldb/lldb-forward.h"
+
+namespace lldb_private {
+
+class Status;
+
+//----------------------------------------------------------------------
+// A connection to a process on the same host through a shared memory
+// mapping, which holds a ring buffer for each direction.
+//
+// The connection is set up over an existing connection, the control
+// connection: one side creates the mapping with Create() and sends the URI
+// GetURI() returns, and the other side maps it with Connect(). From then on
+// the data goes through the rings, and the control connection only wakes up
+// the side that connected and tells either side when the other went away.
+//
+// A reader that finds its ring empty says so in the ring before waiting, so
+// that the writer only makes a system call to wake it when it is waiting.
+// The side that created the mapping waits on a futex. The side that
+// connected is expected to wait in a MainLoop on GetReadObject(), so it is
+// woken up by a byte written to the control connection.
+//----------------------------------------------------------------------
+class ConnectionSharedMemory : public Connection {
+public:
+  static const char *SHM_SCHEME;
+
+  ConnectionSharedMemory(lldb::ConnectionSP control_sp);
+
+  ~ConnectionSharedMemory() override;
+
+  // Create a new mapping for the peer to connect to. If the peer never maps
+  // it, destroying the connection removes the file, and leaves the control
+  // connection alone.
+  Status Create();
+
+  bool IsConnected() const override;
+
+  // Map the mapping the peer created, given its "shm://<path>" URI. Only
+  // regular files under /dev/shm/lldb-* that belong to this user and only
+  // this user can access are accepted.
+  lldb::ConnectionStatus Connect(llvm::StringRef url,
+                                 Status *error_ptr) override;
+
+  lldb::ConnectionStatus Disconnect(Status *error_ptr) override;
+
+  size_t Read(void *dst, size_t dst_len, const Timeout<std::micro> &timeout,
+              lldb::ConnectionStatus &status, Status *error_ptr) override;
+
+  size_t Write(const void *src, size_t src_len, lldb::ConnectionStatus &status,
+               Status *error_ptr) override;
+
+  std::string GetURI() override;
+
+  bool InterruptRead() override;
+
+  lldb::IOObjectSP GetReadObject() override;
+
+private:
+  struct Ring;
+  struct Header;
+
+  typedef llvm::Optional<std::chrono::steady_clock::time_point> Deadline;
+
+  Status Map(int fd, size_t size);
+
+  void SetRings(bool creator);
+
+  // Copy out what the read ring holds, up to \a dst_len bytes.
+  size_t ReadRing(void *dst, size_t dst_len);
+
+  // Wait until \a word no longer holds \a value or \a deadline passes. The
+  // wait also ends when the peer goes away, and when the read is interrupted
+  // if \a interruptible.
+  lldb::ConnectionStatus Wait(std::atomic<uint32_t> &word, uint32_t value,
+                              const Deadline &deadline, bool interruptible);
+
+  // Wait for a byte on the control connection.
+  lldb::ConnectionStatus WaitForDoorbell(const Deadline &deadline);
+
+  // Read what is pending on the control connection. Returns false if the
+  // peer closed it.
+  bool DrainControl();
+
+  bool PeerClosed();
+
+  // Whether the side that connected mapped the mapping this side created.
+  bool PeerMapped() const;
+
+  lldb::ConnectionSP m_control_sp;
+  std::string m_path;
+  bool m_created;
+  void *m_mapping;
+  size_t m_mapping_size;
+  Ring *m_read_ring;
+  Ring *m_write_ring;
+  uint8_t *m_read_data;
+  uint8_t *m_write_data;
+  uint32_t m_ring_size;
+  bool m_wait_for_doorbell; // our reads wait on the control connection
+  bool m_ring_doorbell;     // the peer's reads do
+  std::atomic<bool> m_connected;
+  std::atomic<bool> m_peer_closed;
+  std::atomic<bool> m_interrupted;
+
+  DISALLOW_COPY_AND_ASSIGN(ConnectionSharedMemory);
+};
+
+} // namespace lldb_private
+
+#endif // liblldb_Host_linux_ConnectionSharedMemory_h_
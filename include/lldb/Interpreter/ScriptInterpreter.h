@@ -429,6 +429,26 @@ public:
 
   virtual std::unique_ptr<ScriptInterpreterLocker> AcquireInterpreterLock();
 
+  //------------------------------------------------------------------
+  /// Bracket an operation, like printing a value, that may call many
+  /// scripted formatters. Between the two calls the interpreter may keep
+  /// its session state alive on the calling thread instead of setting it up
+  /// again for every formatter callback. The interpreter lock is still only
+  /// held while a callback runs. Batches can nest and only the outermost one
+  /// has any effect.
+  //------------------------------------------------------------------
+  virtual void BeginFormatterBatch() {}
+
+  virtual void EndFormatterBatch() {}
+
+  //------------------------------------------------------------------
+  /// Report the number of calls and the time spent in each scripted
+  /// summary and synthetic children provider.
+  //------------------------------------------------------------------
+  virtual void DumpFormatterStatistics(Stream &strm) {}
+
+  virtual void ClearFormatterStatistics() {}
+
   const char *GetScriptInterpreterPtyName();
 
   int GetMasterFileDescriptor();
@@ -448,6 +468,29 @@ protected:
   lldb::ScriptLanguage m_script_lang;
 };
 
+//----------------------------------------------------------------------
+/// RAII helper for ScriptInterpreter::BeginFormatterBatch() and
+/// ScriptInterpreter::EndFormatterBatch().
+//----------------------------------------------------------------------
+class ScriptInterpreterFormatterBatch {
+public:
+  ScriptInterpreterFormatterBatch(ScriptInterpreter *interpreter)
+      : m_interpreter(interpreter) {
+    if (m_interpreter)
+      m_interpreter->BeginFormatterBatch();
+  }
+
+  ~ScriptInterpreterFormatterBatch() {
+    if (m_interpreter)
+      m_interpreter->EndFormatterBatch();
+  }
+
+private:
+  ScriptInterpreter *m_interpreter;
+
+  DISALLOW_COPY_AND_ASSIGN(ScriptInterpreterFormatterBatch);
+};
+
 } // namespace lldb_private
 
 #endif // liblldb_ScriptInterpreter_h_
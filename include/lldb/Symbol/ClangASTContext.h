@@ -431,6 +431,8 @@ public:
   // TypeSystem methods
   //------------------------------------------------------------------
   DWARFASTParser *GetDWARFParser() override;
+
+  size_t MemorySize() override;
   PDBASTParser *GetPDBParser();
 
   //------------------------------------------------------------------
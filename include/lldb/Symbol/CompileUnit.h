@@ -245,6 +245,11 @@ public:
   //------------------------------------------------------------------
   LineTable *GetLineTable();
 
+  //------------------------------------------------------------------
+  /// Get the number of bytes used by the line table, without parsing it.
+  //------------------------------------------------------------------
+  size_t GetLineTableMemorySize() const;
+
   DebugMacros *GetDebugMacros();
 
   //------------------------------------------------------------------
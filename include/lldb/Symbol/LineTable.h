@@ -202,6 +202,11 @@ public:
   //------------------------------------------------------------------
   uint32_t GetSize() const;
 
+  //------------------------------------------------------------------
+  /// Get the number of bytes used by the line table entries.
+  //------------------------------------------------------------------
+  size_t MemorySize() const;
+
   typedef lldb_private::RangeArray<lldb::addr_t, lldb::addr_t, 32>
       FileAddressRanges;
 
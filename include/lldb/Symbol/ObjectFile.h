@@ -351,6 +351,11 @@ public:
   //------------------------------------------------------------------
   virtual Symtab *GetSymtab() = 0;
 
+  //------------------------------------------------------------------
+  /// Gets the symbol table if it has been parsed already.
+  //------------------------------------------------------------------
+  Symtab *GetSymtabIfParsed() const { return m_symtab_ap.get(); }
+
   //------------------------------------------------------------------
   /// Perform relocations on the section if necessary.
   ///
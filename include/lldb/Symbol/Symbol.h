@@ -15,6 +15,11 @@
 #include "lldb/Symbol/SymbolContextScope.h"
 #include "lldb/Utility/UserID.h"
 #include "lldb/lldb-private.h"
+#include "llvm/ADT/STLExtras.h"
+
+namespace llvm {
+class raw_ostream;
+}
 
 namespace lldb_private {
 
@@ -231,6 +236,40 @@ public:
 
   bool ContainsFileAddress(lldb::addr_t file_addr) const;
 
+  //------------------------------------------------------------------
+  /// The number of bytes Encode() writes for every symbol.
+  //------------------------------------------------------------------
+  static const size_t kEncodedSize = 44;
+
+  //------------------------------------------------------------------
+  /// Encode the symbol for the symbol table cache.
+  ///
+  /// @param[in] add_string
+  ///     Called with each name of the symbol, returns the offset at which
+  ///     it is written in the string table saved with the symbols.
+  //------------------------------------------------------------------
+  void Encode(llvm::raw_ostream &os,
+              llvm::function_ref<uint32_t(const ConstString &)> add_string)
+      const;
+
+  //------------------------------------------------------------------
+  /// Decode a symbol written by Encode().
+  ///
+  /// @param[in] find_section
+  ///     Returns the section with the given ID, or an empty pointer.
+  ///
+  /// @param[in] get_string
+  ///     Returns the name at the given string table offset, or false if
+  ///     the offset isn't valid.
+  ///
+  /// @return
+  ///     False if the data is truncated or refers to sections or names
+  ///     that don't exist.
+  //------------------------------------------------------------------
+  bool Decode(const DataExtractor &data, lldb::offset_t *offset_ptr,
+              llvm::function_ref<lldb::SectionSP(lldb::user_id_t)> find_section,
+              llvm::function_ref<bool(uint32_t, ConstString &)> get_string);
+
 protected:
   // This is the internal guts of ResolveReExportedSymbol, it assumes
   // reexport_name is not null, and that module_spec is valid.  We track the
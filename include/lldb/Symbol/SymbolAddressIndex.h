@@ -0,0 +1,118 @@
+//===-- SymbolAddressIndex.h ------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_SymbolAddressIndex_h_
+#define liblldb_SymbolAddressIndex_h_
+
+#include "lldb/lldb-types.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace lldb_private {
+
+//----------------------------------------------------------------------
+/// @class SymbolAddressIndex SymbolAddressIndex.h
+/// "lldb/Symbol/SymbolAddressIndex.h"
+/// @brief A sorted index from file address ranges to symbol indexes.
+///
+/// The entries are stored in columns rather than as an array of
+/// structures: binary searches only touch the array of start addresses,
+/// and sizes are stored in 32 bits, with the rare larger size kept on the
+/// side. Each entry also records how far the ranges of it and all the
+/// entries before it reach, so a lookup can stop walking backwards as soon
+/// as no earlier range can contain the address. This makes finding all
+/// ranges that contain an address cost O(log n + k) instead of a scan of
+/// the whole table.
+//----------------------------------------------------------------------
+class SymbolAddressIndex {
+public:
+  SymbolAddressIndex() = default;
+
+  void Clear();
+
+  void Append(lldb::addr_t base, lldb::addr_t size, uint32_t symbol_idx);
+
+  //------------------------------------------------------------------
+  /// Sort the entries by start address, then size, then symbol index.
+  /// Must be called after the last Append() or SetByteSizeAtIndex() and
+  /// before the index is searched.
+  //------------------------------------------------------------------
+  void Sort();
+
+  size_t GetSize() const { return m_bases.size(); }
+
+  bool IsEmpty() const { return m_bases.empty(); }
+
+  lldb::addr_t GetBaseAtIndex(size_t i) const { return m_bases[i]; }
+
+  lldb::addr_t GetByteSizeAtIndex(size_t i) const;
+
+  void SetByteSizeAtIndex(size_t i, lldb::addr_t size);
+
+  uint32_t GetSymbolIndexAtIndex(size_t i) const { return m_symbol_indexes[i]; }
+
+  //------------------------------------------------------------------
+  /// @return
+  ///     The symbol index of the first entry that starts at \a addr, or
+  ///     UINT32_MAX if there is none.
+  //------------------------------------------------------------------
+  uint32_t FindSymbolIndexStartingAt(lldb::addr_t addr) const;
+
+  //------------------------------------------------------------------
+  /// @return
+  ///     The symbol index of the first entry, in sorted order, whose range
+  ///     contains \a addr, or UINT32_MAX if there is none.
+  //------------------------------------------------------------------
+  uint32_t FindSymbolIndexContaining(lldb::addr_t addr) const;
+
+  //------------------------------------------------------------------
+  /// Append the symbol index of every entry whose range contains \a addr
+  /// to \a symbol_indexes, in sorted order.
+  ///
+  /// @return
+  ///     The number of symbol indexes appended.
+  //------------------------------------------------------------------
+  size_t
+  FindSymbolIndexesContaining(lldb::addr_t addr,
+                              std::vector<uint32_t> &symbol_indexes) const;
+
+  void SizeToFit();
+
+  size_t MemorySize() const;
+
+private:
+  // Sizes and reaches that don't fit in 32 bits.
+  static constexpr uint32_t kLarge = UINT32_MAX;
+
+  bool Contains(size_t i, lldb::addr_t addr) const {
+    return addr >= m_bases[i] && addr - m_bases[i] < GetByteSizeAtIndex(i);
+  }
+
+  // Call \a callback with the index of each entry that contains \a addr, in
+  // decreasing order, until it returns false.
+  template <typename F>
+  void ForEachContainingEntry(lldb::addr_t addr, F callback) const;
+
+  void ComputeReaches();
+
+  std::vector<lldb::addr_t> m_bases;
+  std::vector<uint32_t> m_sizes;
+  std::vector<uint32_t> m_symbol_indexes;
+  // m_reaches[i] is how far past m_bases[i] the ranges of entries 0 to i
+  // reach at most, or kLarge if it doesn't fit in 32 bits.
+  std::vector<uint32_t> m_reaches;
+  // The sizes of the entries whose entry in m_sizes is kLarge.
+  llvm::DenseMap<uint32_t, lldb::addr_t> m_large_sizes;
+};
+
+} // namespace lldb_private
+
+#endif // liblldb_SymbolAddressIndex_h_
@@ -17,6 +17,7 @@
 #include "lldb/Symbol/Type.h"
 #include "lldb/lldb-private.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseSet.h"
 
 namespace lldb_private {
@@ -182,6 +183,18 @@ public:
 
   virtual void PreloadSymbols();
 
+  // Read ahead the debug information of the types with the given names and
+  // of what they refer to, so that looking them up later is cheaper. This is
+  // only a hint; the default does nothing.
+  virtual void PrefetchTypes(llvm::ArrayRef<ConstString> names) {}
+
+  // The number of bytes of parsed data that FreeParsedData() could free.
+  virtual size_t GetParsedDataSize() { return 0; }
+
+  // Free parsed data that can be parsed again when it is needed, and return
+  // the number of bytes freed. Called with the module mutex held.
+  virtual size_t FreeParsedData() { return 0; }
+
   virtual lldb_private::TypeSystem *
   GetTypeSystemForLanguage(lldb::LanguageType language);
 
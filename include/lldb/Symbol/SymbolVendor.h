@@ -113,6 +113,9 @@ public:
 
   virtual size_t GetNumCompileUnits();
 
+  // The number of bytes used by the line tables parsed so far.
+  size_t GetLineTablesMemorySize();
+
   virtual bool SetCompileUnitAtIndex(size_t cu_idx,
                                      const lldb::CompUnitSP &cu_sp);
 
@@ -10,13 +10,16 @@
 #ifndef liblldb_Symtab_h_
 #define liblldb_Symtab_h_
 
+#include <memory>
 #include <mutex>
 #include <vector>
 
 #include "lldb/Core/RangeMap.h"
 #include "lldb/Core/UniqueCStringMap.h"
 #include "lldb/Symbol/Symbol.h"
+#include "lldb/Symbol/SymbolAddressIndex.h"
 #include "lldb/lldb-private.h"
+#include "llvm/ADT/STLExtras.h"
 
 namespace lldb_private {
 
@@ -41,10 +44,31 @@ public:
   ~Symtab();
 
   void PreloadSymbols();
+
+  //------------------------------------------------------------------
+  /// Save the symbols, along with their name and address indexes, in the
+  /// index cache so later sessions can load them with LoadFromCache().
+  /// The indexes are built first. Does nothing if the index cache is
+  /// disabled or the module has no UUID.
+  //------------------------------------------------------------------
+  void SaveToCache();
+
+  //------------------------------------------------------------------
+  /// Replace the symbols and their indexes with the ones saved in the
+  /// index cache for the object file of this symbol table.
+  ///
+  /// @return
+  ///     True if a valid snapshot was found and loaded.
+  //------------------------------------------------------------------
+  bool LoadFromCache();
   void Reserve(size_t count);
   Symbol *Resize(size_t count);
   uint32_t AddSymbol(const Symbol &symbol);
   size_t GetNumSymbols() const;
+  // The number of bytes used by the symbols, and by the indexes built to
+  // look them up by name and address.
+  size_t GetSymbolsMemorySize() const;
+  size_t GetIndexesMemorySize() const;
   void SectionFileAddressesChanged();
   void Dump(Stream *s, Target *target, SortOrder sort_type);
   void Dump(Stream *s, Target *target, std::vector<uint32_t> &indexes) const;
@@ -135,6 +159,7 @@ public:
       collection new_symbols(m_symbols.begin(), m_symbols.end());
       m_symbols.swap(new_symbols);
     }
+    m_file_addr_to_index.SizeToFit();
   }
 
   void AppendSymbolNamesToMap(const IndexCollection &indexes,
@@ -147,18 +172,31 @@ protected:
   typedef std::vector<Symbol> collection;
   typedef collection::iterator iterator;
   typedef collection::const_iterator const_iterator;
-  typedef RangeDataVector<lldb::addr_t, lldb::addr_t, uint32_t>
-      FileRangeToIndexMap;
   void InitNameIndexes();
   void InitAddressIndexes();
 
+  //------------------------------------------------------------------
+  /// Get the trigram index of the symbol names, building it (or loading
+  /// it from the index cache) on first use.
+  ///
+  /// @return
+  ///     nullptr if regular expression indexing is disabled.
+  //------------------------------------------------------------------
+  const TrigramIndex *GetRegexIndex();
+
+  // Call \a callback with the index of every symbol that may match
+  // \a regexp, in increasing order.
+  void ForEachRegexCandidate(const RegularExpression &regexp,
+                             llvm::function_ref<void(uint32_t)> callback);
+
   ObjectFile *m_objfile;
   collection m_symbols;
-  FileRangeToIndexMap m_file_addr_to_index;
+  SymbolAddressIndex m_file_addr_to_index;
   UniqueCStringMap<uint32_t> m_name_to_index;
   UniqueCStringMap<uint32_t> m_basename_to_index;
   UniqueCStringMap<uint32_t> m_method_to_index;
   UniqueCStringMap<uint32_t> m_selector_to_index;
+  std::unique_ptr<TrigramIndex> m_regex_index;
   mutable std::recursive_mutex
       m_mutex; // Provide thread safety for this symbol table
   bool m_file_addr_to_index_computed : 1, m_name_indexes_computed : 1;
@@ -99,6 +99,10 @@ public:
 
   virtual DWARFASTParser *GetDWARFParser() { return nullptr; }
 
+  // The number of bytes allocated for the types and declarations of this
+  // type system.
+  virtual size_t MemorySize() { return 0; }
+
   virtual SymbolFile *GetSymbolFile() const { return m_sym_file; }
 
   // Returns true if the symbol file changed during the set accessor.
@@ -0,0 +1,164 @@
+//===-- HeapSnapshot.h ------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_HeapSnapshot_h_
+#define liblldb_HeapSnapshot_h_
+
+// C Includes
+// C++ Includes
+#include <string>
+#include <vector>
+
+// Other libraries and framework includes
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+// Project includes
+#include "lldb/Utility/Status.h"
+#include "lldb/lldb-private.h"
+
+namespace lldb_private {
+
+//----------------------------------------------------------------------
+/// @class HeapSnapshot HeapSnapshot.h "lldb/Target/HeapSnapshot.h"
+/// @brief A graph of the heap objects of a process and the references
+/// between them.
+///
+/// A snapshot is captured by walking the glibc malloc chunk chains found
+/// in the writable memory regions of a process, and then scanning every
+/// writable region for pointer sized values that point into an allocated
+/// chunk. References from outside the heap (globals, stacks) make their
+/// targets roots. Objects whose first word is a C++ vtable pointer are
+/// given the name of the dynamic type.
+///
+/// From the graph the snapshot computes which objects can't be reached
+/// from any root (leak candidates) and, using the dominator tree, how
+/// many bytes each object keeps alive.
+///
+/// Snapshots are saved in a columnar binary format so that they can be
+/// compared against later snapshots of the same process.
+//----------------------------------------------------------------------
+class HeapSnapshot {
+public:
+  static const uint32_t kInvalidIndex = UINT32_MAX;
+
+  struct TypeStatistics {
+    std::string name;
+    uint64_t count = 0;
+    uint64_t size = 0;
+    // Bytes kept alive by the objects of this type. Objects that are
+    // dominated by another object of the same type are only counted once.
+    uint64_t retained_size = 0;
+    uint64_t unreachable_count = 0;
+    uint64_t unreachable_size = 0;
+  };
+
+  struct TypeDelta {
+    std::string name;
+    int64_t count_delta = 0;
+    int64_t size_delta = 0;
+    // Objects in the later snapshot that weren't there before (matched by
+    // address, size and type).
+    uint64_t new_objects = 0;
+  };
+
+  HeapSnapshot();
+
+  //------------------------------------------------------------------
+  /// Walk the heap of \a process and build a snapshot of it.
+  ///
+  /// Works with any process plugin that can describe its memory regions,
+  /// including core files.
+  //------------------------------------------------------------------
+  static Status Capture(Process &process, HeapSnapshot &snapshot);
+
+  Status Save(const FileSpec &file) const;
+
+  static Status Load(const FileSpec &file, HeapSnapshot &snapshot);
+
+  //------------------------------------------------------------------
+  /// Building a snapshot by hand. Objects must be added in increasing
+  /// address order and must not overlap. Finalize() has to be called once
+  /// all objects and references are added.
+  //------------------------------------------------------------------
+  uint32_t AddObject(lldb::addr_t addr, uint64_t size,
+                     llvm::StringRef type_name = llvm::StringRef());
+
+  void AddReference(uint32_t from, uint32_t to);
+
+  void SetIsRoot(uint32_t idx);
+
+  void Finalize();
+
+  size_t GetNumObjects() const { return m_addrs.size(); }
+
+  size_t GetNumReferences() const { return m_edge_targets.size(); }
+
+  lldb::addr_t GetObjectAddress(uint32_t idx) const { return m_addrs[idx]; }
+
+  uint64_t GetObjectSize(uint32_t idx) const { return m_sizes[idx]; }
+
+  llvm::StringRef GetObjectTypeName(uint32_t idx) const {
+    return m_type_names[m_types[idx]];
+  }
+
+  bool IsRoot(uint32_t idx) const { return m_flags[idx] & eFlagRoot; }
+
+  bool IsReachable(uint32_t idx) const { return m_flags[idx] & eFlagReachable; }
+
+  uint64_t GetRetainedSize(uint32_t idx) const { return m_retained[idx]; }
+
+  /// The index of the object that dominates \a idx, or kInvalidIndex if
+  /// the object is only kept alive by roots (or not at all).
+  uint32_t GetDominator(uint32_t idx) const { return m_idom[idx]; }
+
+  llvm::ArrayRef<uint32_t> GetReferences(uint32_t idx) const;
+
+  /// The index of the object containing \a addr, or kInvalidIndex.
+  uint32_t FindObjectContaining(lldb::addr_t addr) const;
+
+  /// Per type totals, sorted by decreasing retained size.
+  std::vector<TypeStatistics> GetTypeStatistics() const;
+
+  /// Per type growth from \a before to \a after, sorted by decreasing size
+  /// growth.
+  static std::vector<TypeDelta> Diff(const HeapSnapshot &before,
+                                     const HeapSnapshot &after);
+
+private:
+  enum : uint8_t { eFlagRoot = (1u << 0), eFlagReachable = (1u << 1) };
+
+  uint32_t GetTypeIndex(llvm::StringRef type_name);
+
+  void ComputeReachability();
+
+  void ComputeDominators();
+
+  // Columns, one entry per object.
+  std::vector<lldb::addr_t> m_addrs;
+  std::vector<uint64_t> m_sizes;
+  std::vector<uint32_t> m_types;
+  std::vector<uint8_t> m_flags;
+  // References in compressed sparse row form: the references of object i
+  // are m_edge_targets[m_edge_offsets[i], m_edge_offsets[i + 1]).
+  std::vector<uint64_t> m_edge_offsets;
+  std::vector<uint32_t> m_edge_targets;
+  // Derived data, recomputed by Finalize().
+  std::vector<uint32_t> m_idom;
+  std::vector<uint64_t> m_retained;
+
+  std::vector<std::string> m_type_names;
+  llvm::StringMap<uint32_t> m_type_indexes;
+  std::vector<std::pair<uint32_t, uint32_t>> m_pending_edges;
+};
+
+} // namespace lldb_private
+
+#endif // liblldb_HeapSnapshot_h_
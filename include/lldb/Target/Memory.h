@@ -54,6 +54,9 @@ public:
   void AddL1CacheData(lldb::addr_t addr,
                       const lldb::DataBufferSP &data_buffer_sp);
 
+  // The number of bytes of memory held in the cache.
+  size_t GetMemorySize();
+
 protected:
   typedef std::map<lldb::addr_t, lldb::DataBufferSP> BlockMap;
   typedef RangeArray<lldb::addr_t, lldb::addr_t, 4> InvalidRanges;
@@ -67,6 +70,7 @@ protected:
                        // a chunk
   BlockMap m_L2_cache; // A memory cache of fixed size chinks
                        // (m_L2_cache_line_byte_size bytes in size each)
+  size_t m_L1_cache_byte_size; // The sum of the sizes of the m_L1_cache blocks
   InvalidRanges m_invalid_ranges;
   Process &m_process;
   uint32_t m_L2_cache_line_byte_size;
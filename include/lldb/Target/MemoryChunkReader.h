@@ -0,0 +1,116 @@
+//===-- MemoryChunkReader.h -------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_MemoryChunkReader_h_
+#define liblldb_MemoryChunkReader_h_
+
+// C Includes
+// C++ Includes
+#include <future>
+#include <vector>
+
+// Other libraries and framework includes
+#include "llvm/ADT/ArrayRef.h"
+
+// Project includes
+#include "lldb/Target/MemoryRegionInfo.h"
+#include "lldb/lldb-private.h"
+
+namespace lldb_private {
+
+//----------------------------------------------------------------------
+/// @class MemoryChunkReader MemoryChunkReader.h
+/// "lldb/Target/MemoryChunkReader.h"
+/// @brief Streams a large range of process memory in fixed size chunks.
+///
+/// Only two chunks are ever held in memory, so arbitrarily large ranges
+/// can be processed with bounded memory. While the caller works on one
+/// chunk the next one is already being read on the task pool, which hides
+/// most of the round trip latency of remote targets. Regions that the
+/// process reports as unreadable are skipped without being read, and a
+/// chunk that can only be partially read is truncated.
+///
+/// Consecutive chunks can be made to overlap, which lets searches find
+/// matches that straddle a chunk boundary.
+//----------------------------------------------------------------------
+class MemoryChunkReader {
+public:
+  static const size_t kDefaultChunkSize = 1024 * 1024;
+
+  //------------------------------------------------------------------
+  /// @param[in] overlap
+  ///     When a chunk directly follows the previous one, the last
+  ///     \a overlap bytes of the previous chunk are repeated at its start.
+  //------------------------------------------------------------------
+  MemoryChunkReader(const lldb::ProcessSP &process_sp, lldb::addr_t low,
+                    lldb::addr_t high, size_t chunk_size = kDefaultChunkSize,
+                    size_t overlap = 0);
+
+  ~MemoryChunkReader();
+
+  //------------------------------------------------------------------
+  /// Get the next chunk of memory.
+  ///
+  /// @param[out] addr
+  ///     The address of the first byte of \a data.
+  ///
+  /// @param[out] data
+  ///     The chunk contents. Only valid until the next call.
+  ///
+  /// @param[out] fresh_addr
+  ///     The first address in the chunk that was not part of the previous
+  ///     chunk. Anything below it was repeated because of the overlap.
+  ///
+  /// @return
+  ///     False once the whole range has been returned.
+  //------------------------------------------------------------------
+  bool ReadNextChunk(lldb::addr_t &addr, llvm::ArrayRef<uint8_t> &data,
+                     lldb::addr_t &fresh_addr);
+
+  /// The number of bytes that were read from the process so far.
+  uint64_t GetBytesRead() const { return m_bytes_read; }
+
+  /// The number of bytes in the range that could not be read so far.
+  uint64_t GetBytesSkipped() const { return m_bytes_skipped; }
+
+private:
+  struct Chunk {
+    lldb::addr_t addr = LLDB_INVALID_ADDRESS;
+    size_t requested_size = 0;
+    std::vector<uint8_t> bytes;
+  };
+
+  static Chunk ReadChunk(lldb::ProcessSP process_sp, lldb::addr_t addr,
+                         size_t size);
+
+  // Pick the range of the next read, skipping over unreadable regions.
+  bool GetNextReadRange(lldb::addr_t &addr, size_t &size);
+
+  // Start reading the next chunk on the task pool.
+  void StartNextRead();
+
+  lldb::ProcessSP m_process_sp;
+  lldb::addr_t m_next_addr;
+  const lldb::addr_t m_high_addr;
+  const size_t m_chunk_size;
+  const size_t m_overlap;
+  MemoryRegionInfo m_region;
+  bool m_use_region_info;
+  std::future<Chunk> m_pending;
+  std::vector<uint8_t> m_buffer;
+  lldb::addr_t m_buffer_addr;
+  uint64_t m_bytes_read;
+  uint64_t m_bytes_skipped;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryChunkReader);
+};
+
+} // namespace lldb_private
+
+#endif // liblldb_MemoryChunkReader_h_
@@ -875,6 +875,24 @@ public:
 
   virtual size_t LoadModules(LoadedModuleInfoList &) { return 0; }
 
+  //------------------------------------------------------------------
+  /// Ask the process for the list of loaded shared libraries, without
+  /// loading them into the target.
+  ///
+  /// Dynamic loader plug-ins can use this instead of walking the runtime
+  /// linker's structures in memory when the connection to the process
+  /// can provide the whole list at once.
+  ///
+  /// @param[out] list
+  ///     The loaded libraries, in the order the runtime linker keeps them.
+  ///
+  /// @return
+  ///     An error if the process can't provide the list.
+  //------------------------------------------------------------------
+  virtual Status GetLoadedModuleList(LoadedModuleInfoList &list) {
+    return Status("loaded module list not supported");
+  }
+
 protected:
   virtual JITLoaderList &GetJITLoaders();
 
@@ -1028,6 +1046,19 @@ public:
 
   Status ResumeSynchronous(Stream *stream);
 
+  //------------------------------------------------------------------
+  /// Set the direction in which the threads that have no thread plan of
+  /// their own run when the process resumes.
+  ///
+  /// Only process plug-ins that can run backward accept
+  /// lldb::eRunReverse, see DoResume().
+  //------------------------------------------------------------------
+  void SetBaseDirection(lldb::RunDirection direction) {
+    m_base_direction = direction;
+  }
+
+  lldb::RunDirection GetBaseDirection() const { return m_base_direction; }
+
   //------------------------------------------------------------------
   /// Halts a running process.
   ///
@@ -1281,6 +1312,10 @@ public:
   /// process is resumed. If no run control action is given to a thread it
   /// will be resumed by default.
   ///
+  /// @param[in] direction
+  ///     The direction to run the threads in. Plug-ins that can't run a
+  ///     process backward return an error for lldb::eRunReverse.
+  ///
   /// @return
   ///     Returns \b true if the process successfully resumes using
   ///     the thread run control actions, \b false otherwise.
@@ -1289,7 +1324,7 @@ public:
   /// @see Thread:Step()
   /// @see Thread:Suspend()
   //------------------------------------------------------------------
-  virtual Status DoResume() {
+  virtual Status DoResume(lldb::RunDirection direction) {
     Status error;
     error.SetErrorStringWithFormat(
         "error: %s does not support resuming processes",
@@ -1484,6 +1519,11 @@ public:
   //------------------------------------------------------------------
   void Flush();
 
+  //------------------------------------------------------------------
+  /// Get the number of bytes of inferior memory held in the memory cache.
+  //------------------------------------------------------------------
+  size_t GetMemoryCacheByteSize() { return m_memory_cache.GetMemorySize(); }
+
   //------------------------------------------------------------------
   /// Get accessor for the current process state.
   ///
@@ -2332,6 +2372,12 @@ public:
   // doesn't work for a specific process plug-in.
   virtual Status DisableSoftwareBreakpoint(BreakpointSite *bp_site);
 
+  // Whether a thread resumed from \a bp_site steps over it without our help,
+  // so that the thread doesn't need to push a ThreadPlanStepOverBreakpoint.
+  virtual bool StepsOverBreakpointSite(BreakpointSite &bp_site) {
+    return false;
+  }
+
   BreakpointSiteList &GetBreakpointSiteList();
 
   const BreakpointSiteList &GetBreakpointSiteList() const;
@@ -2836,6 +2882,10 @@ protected:
   //------------------------------------------------------------------
   Status PrivateResume();
 
+  // Find the direction the threads about to resume run in. Returns false,
+  // with an error, if their thread plans disagree.
+  bool GetResumeDirection(lldb::RunDirection &direction, Status &error);
+
   //------------------------------------------------------------------
   // Called internally
   //------------------------------------------------------------------
@@ -3100,6 +3150,7 @@ protected:
   bool m_finalize_called; // This is set at the end of Process::Finalize()
   bool m_clear_thread_plans_on_stop;
   bool m_force_next_event_delivery;
+  lldb::RunDirection m_base_direction; // See SetBaseDirection()
   lldb::StateType m_last_broadcast_state; /// This helps with the Public event
                                           /// coalescing in
                                           /// ShouldBroadcastEvent.
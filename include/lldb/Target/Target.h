@@ -89,6 +89,8 @@ public:
 
   void SetPreloadSymbols(bool b);
 
+  bool GetParallelModuleLoad() const;
+
   bool GetDisableASLR() const;
 
   void SetDisableASLR(bool b);
@@ -132,6 +134,8 @@ public:
 
   bool GetEnableNotifyAboutFixIts() const;
 
+  bool GetPrefetchExpressionTypes() const;
+
   bool GetEnableSaveObjects() const;
 
   bool GetEnableSyntheticValue() const;
@@ -1004,6 +1008,9 @@ public:
                                               lldb::LanguageType language,
                                               bool create_on_demand = true);
 
+  // The number of bytes allocated by the scratch type systems.
+  size_t GetScratchTypeSystemsMemorySize();
+
   PersistentExpressionState *
   GetPersistentExpressionStateForLanguage(lldb::LanguageType language);
 
@@ -655,12 +655,18 @@ public:
   /// @param[in] stop_other_threads
   ///    \b true if we will stop other threads while we single step this one.
   ///
+  /// @param[in] direction
+  ///    lldb::eRunReverse to step back to the previous instruction, which
+  ///    only processes that record their execution history can do. Stepping
+  ///    back always steps into calls.
+  ///
   /// @return
   ///     A shared pointer to the newly queued thread plan, or nullptr if the
   ///     plan could not be queued.
   //------------------------------------------------------------------
   virtual lldb::ThreadPlanSP QueueThreadPlanForStepSingleInstruction(
-      bool step_over, bool abort_other_plans, bool stop_other_threads);
+      bool step_over, bool abort_other_plans, bool stop_other_threads,
+      lldb::RunDirection direction = lldb::eRunForward);
 
   //------------------------------------------------------------------
   /// Queues the plan used to step through an address range, stepping  over
@@ -820,6 +826,32 @@ public:
       uint32_t frame_idx,
       LazyBool step_out_avoids_code_without_debug_info = eLazyBoolCalculate);
 
+  //------------------------------------------------------------------
+  /// Queue the plan used to run \a thread backward out of the function of
+  /// frame 0, to the instruction that called it. The process must record its
+  /// execution history.
+  ///
+  /// @param[in] abort_other_plans
+  ///    \b true if we discard the currently queued plans and replace them with
+  ///    this one.
+  ///    Otherwise this plan will go on the end of the plan stack.
+  ///
+  /// @param[in] stop_other_threads
+  ///    \b true if we will stop other threads while we step this one.
+  ///
+  /// @param[in] stop_vote
+  /// @param[in] run_vote
+  ///    See standard meanings for the stop & run votes in ThreadPlan.h.
+  ///
+  /// @return
+  ///     A shared pointer to the newly queued thread plan, or nullptr if the
+  ///     plan could not be queued.
+  //------------------------------------------------------------------
+  virtual lldb::ThreadPlanSP
+  QueueThreadPlanForReverseStepOut(bool abort_other_plans,
+                                   bool stop_other_threads, Vote stop_vote,
+                                   Vote run_vote);
+
   //------------------------------------------------------------------
   /// Queue the plan used to step out of the function at the current PC of
   /// a thread.  This version does not consult the should stop here callback,
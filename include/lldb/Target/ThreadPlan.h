@@ -350,6 +350,7 @@ public:
     eKindPython,
     eKindStepInstruction,
     eKindStepOut,
+    eKindReverseStepOut,
     eKindStepOverBreakpoint,
     eKindStepOverRange,
     eKindStepInRange,
@@ -442,6 +443,17 @@ public:
 
   virtual bool StopOthers();
 
+  // The direction the thread runs in while this is its current plan. Only
+  // processes that record their execution history can run backward.
+  virtual lldb::RunDirection GetDirection() { return lldb::eRunForward; }
+
+  // If the plan single steps the thread until it leaves a range of
+  // addresses, returns true with the range in \a start and \a end. Processes
+  // that know how can then step through the range without stopping.
+  virtual bool GetSteppingRange(lldb::addr_t &start, lldb::addr_t &end) {
+    return false;
+  }
+
   // This is the wrapper for DoWillResume that does generic ThreadPlan logic,
   // then calls DoWillResume.
   bool WillResume(lldb::StateType resume_state, bool current_plan);
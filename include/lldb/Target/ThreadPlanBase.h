@@ -38,6 +38,7 @@ public:
   Vote ShouldReportStop(Event *event_ptr) override;
   bool StopOthers() override;
   lldb::StateType GetPlanRunState() override;
+  lldb::RunDirection GetDirection() override;
   bool WillStop() override;
   bool MischiefManaged() override;
 
@@ -0,0 +1,74 @@
+//===-- ThreadPlanReverseStepOut.h ------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_ThreadPlanReverseStepOut_h_
+#define liblldb_ThreadPlanReverseStepOut_h_
+
+// C Includes
+// C++ Includes
+// Other libraries and framework includes
+// Project includes
+#include "lldb/Target/Thread.h"
+#include "lldb/Target/ThreadPlan.h"
+
+namespace lldb_private {
+
+//------------------------------------------------------------------
+// ThreadPlanReverseStepOut:
+//
+// Runs the thread backward out of the function of frame 0, to the call
+// instruction that called it. The process must be able to run backward. The
+// thread runs back to the entry of the function, where a breakpoint stops
+// it when the CFA is that of the frame we started from, then steps back one
+// instruction.
+//------------------------------------------------------------------
+
+class ThreadPlanReverseStepOut : public ThreadPlan {
+public:
+  ThreadPlanReverseStepOut(Thread &thread, bool stop_others, Vote stop_vote,
+                           Vote run_vote);
+
+  ~ThreadPlanReverseStepOut() override;
+
+  void GetDescription(Stream *s, lldb::DescriptionLevel level) override;
+  bool ValidatePlan(Stream *error) override;
+  bool ShouldStop(Event *event_ptr) override;
+  bool StopOthers() override { return m_stop_others; }
+  lldb::StateType GetPlanRunState() override { return lldb::eStateRunning; }
+  lldb::RunDirection GetDirection() override { return lldb::eRunReverse; }
+  bool WillStop() override { return true; }
+  bool MischiefManaged() override;
+  void DidPush() override;
+
+protected:
+  bool DoPlanExplainsStop(Event *event_ptr) override;
+
+private:
+  // Whether the thread is at the entry of the function of the frame we
+  // started from.
+  bool AtFrameEntry();
+
+  // Queue the plan that steps back from the function entry to the call.
+  void QueueStepBackPlan();
+
+  void RemoveEntryBreakpoint();
+
+  bool m_stop_others;
+  lldb::addr_t m_step_from_insn;
+  lldb::addr_t m_entry_addr;
+  lldb::addr_t m_cfa;
+  lldb::break_id_t m_entry_bp_id;
+  lldb::ThreadPlanSP m_step_back_plan_sp;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadPlanReverseStepOut);
+};
+
+} // namespace lldb_private
+
+#endif // liblldb_ThreadPlanReverseStepOut_h_
@@ -23,7 +23,8 @@ namespace lldb_private {
 class ThreadPlanStepInstruction : public ThreadPlan {
 public:
   ThreadPlanStepInstruction(Thread &thread, bool step_over, bool stop_others,
-                            Vote stop_vote, Vote run_vote);
+                            Vote stop_vote, Vote run_vote,
+                            lldb::RunDirection direction = lldb::eRunForward);
 
   ~ThreadPlanStepInstruction() override;
 
@@ -32,6 +33,7 @@ public:
   bool ShouldStop(Event *event_ptr) override;
   bool StopOthers() override;
   lldb::StateType GetPlanRunState() override;
+  lldb::RunDirection GetDirection() override { return m_direction; }
   bool WillStop() override;
   bool MischiefManaged() override;
   bool IsPlanStale() override;
@@ -43,11 +45,13 @@ protected:
 
 private:
   friend lldb::ThreadPlanSP Thread::QueueThreadPlanForStepSingleInstruction(
-      bool step_over, bool abort_other_plans, bool stop_other_threads);
+      bool step_over, bool abort_other_plans, bool stop_other_threads,
+      lldb::RunDirection direction);
 
   lldb::addr_t m_instruction_addr;
   bool m_stop_other_threads;
   bool m_step_over;
+  lldb::RunDirection m_direction;
   // These two are used only for the step over case.
   bool m_start_has_symbol;
   StackID m_stack_id;
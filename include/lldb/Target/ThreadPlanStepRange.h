@@ -38,6 +38,7 @@ public:
   Vote ShouldReportStop(Event *event_ptr) override;
   bool StopOthers() override;
   lldb::StateType GetPlanRunState() override;
+  bool GetSteppingRange(lldb::addr_t &start, lldb::addr_t &end) override;
   bool WillStop() override;
   bool MischiefManaged() override;
   void DidPush() override;
@@ -0,0 +1,120 @@
+//===-- BytePatternMatcher.h ------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLDB_UTILITY_BYTEPATTERNMATCHER_H
+#define LLDB_UTILITY_BYTEPATTERNMATCHER_H
+
+#include "lldb/lldb-types.h"
+#include "llvm/ADT/ArrayRef.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace lldb_private {
+
+//----------------------------------------------------------------------
+/// @class BytePatternMatcher BytePatternMatcher.h
+/// "lldb/Utility/BytePatternMatcher.h"
+/// @brief Searches blocks of memory for any of a set of byte patterns.
+///
+/// Every pattern can carry a mask, in which case only the bits that are
+/// set in the mask take part in the comparison. Candidates are located by
+/// scanning for one fully masked "anchor" byte of each pattern with
+/// memchr, which the C library vectorizes, so the common case of a rare
+/// anchor byte runs at memory bandwidth instead of comparing every offset.
+//----------------------------------------------------------------------
+class BytePatternMatcher {
+public:
+  struct Match {
+    lldb::addr_t addr;
+    size_t pattern_index;
+
+    bool operator<(const Match &rhs) const {
+      if (addr != rhs.addr)
+        return addr < rhs.addr;
+      return pattern_index < rhs.pattern_index;
+    }
+  };
+
+  BytePatternMatcher() = default;
+
+  //------------------------------------------------------------------
+  /// Add a pattern to search for.
+  ///
+  /// @param[in] bytes
+  ///     The bytes to look for. Must not be empty.
+  ///
+  /// @param[in] mask
+  ///     Either empty, or exactly as long as \a bytes.
+  ///
+  /// @return
+  ///     False if the pattern or its mask are malformed.
+  //------------------------------------------------------------------
+  bool AddPattern(llvm::ArrayRef<uint8_t> bytes,
+                  llvm::ArrayRef<uint8_t> mask = llvm::None);
+
+  /// Only report matches whose address is a multiple of \a alignment.
+  void SetAlignment(uint64_t alignment) {
+    m_alignment = alignment ? alignment : 1;
+  }
+
+  uint64_t GetAlignment() const { return m_alignment; }
+
+  size_t GetNumPatterns() const { return m_patterns.size(); }
+
+  /// The length of the longest pattern. Callers that feed the matcher
+  /// consecutive blocks must overlap them by this many bytes minus one
+  /// to see matches that straddle a block boundary.
+  size_t GetMaxPatternSize() const { return m_max_size; }
+
+  size_t GetPatternSize(size_t pattern_index) const {
+    return m_patterns[pattern_index].bytes.size();
+  }
+
+  //------------------------------------------------------------------
+  /// Find every match in \a data.
+  ///
+  /// @param[in] data
+  ///     The bytes to search.
+  ///
+  /// @param[in] base_addr
+  ///     The address of the first byte of \a data. Used for the alignment
+  ///     check and for the reported match addresses.
+  ///
+  /// @param[out] matches
+  ///     Matches are appended to this vector, sorted by address.
+  //------------------------------------------------------------------
+  void FindMatches(llvm::ArrayRef<uint8_t> data, lldb::addr_t base_addr,
+                   std::vector<Match> &matches) const;
+
+private:
+  struct Pattern {
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> mask; // Empty if every bit is significant.
+    // Index of a byte that has to match exactly. Only valid if has_anchor is
+    // set; patterns in which every byte is (partially) masked out are
+    // compared at every offset.
+    size_t anchor;
+    bool has_anchor;
+  };
+
+  bool MatchesAt(const Pattern &pattern, const uint8_t *data) const;
+
+  void FindPatternMatches(const Pattern &pattern, size_t pattern_index,
+                          llvm::ArrayRef<uint8_t> data, lldb::addr_t base_addr,
+                          std::vector<Match> &matches) const;
+
+  std::vector<Pattern> m_patterns;
+  uint64_t m_alignment = 1;
+  size_t m_max_size = 0;
+};
+
+} // namespace lldb_private
+
+#endif // LLDB_UTILITY_BYTEPATTERNMATCHER_H
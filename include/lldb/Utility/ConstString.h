@@ -458,6 +458,21 @@ public:
   //------------------------------------------------------------------
   static size_t StaticMemorySize();
 
+  struct MemoryStats {
+    size_t GetBytesTotal() const { return bytes_total; }
+    size_t GetBytesUsed() const { return bytes_used; }
+    size_t GetBytesUnused() const { return bytes_total - bytes_used; }
+    size_t bytes_total = 0;
+    size_t bytes_used = 0;
+  };
+
+  //------------------------------------------------------------------
+  /// Get the memory the global string pool has allocated, and how much of
+  /// it holds strings. Unlike StaticMemorySize(), this doesn't visit every
+  /// string.
+  //------------------------------------------------------------------
+  static MemoryStats GetMemoryStats();
+
 protected:
   //------------------------------------------------------------------
   // Member variables
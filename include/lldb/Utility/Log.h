@@ -44,6 +44,7 @@ class raw_ostream;
 #define LLDB_LOG_OPTION_BACKTRACE (1U << 7)
 #define LLDB_LOG_OPTION_APPEND (1U << 8)
 #define LLDB_LOG_OPTION_PREPEND_FILE_FUNCTION (1U << 9)
+#define LLDB_LOG_OPTION_ASYNC (1U << 10)
 
 //----------------------------------------------------------------------
 // Logging Functions
@@ -122,6 +123,17 @@ public:
 
   static void ListAllLogChannels(llvm::raw_ostream &stream);
 
+  //------------------------------------------------------------------
+  /// Wait until the messages logged so far by channels enabled with
+  /// LLDB_LOG_OPTION_ASYNC have been written out.
+  ///
+  /// Asynchronous channels hand their messages to a background thread
+  /// instead of writing them while the caller waits. When a thread logs
+  /// faster than the messages can be written, messages are dropped and a
+  /// note with the number of dropped messages is written in their place.
+  //------------------------------------------------------------------
+  static void FlushAsyncMessages();
+
   //------------------------------------------------------------------
   // Member functions
   //
@@ -184,6 +196,8 @@ private:
   void WriteHeader(llvm::raw_ostream &OS, llvm::StringRef file,
                    llvm::StringRef function);
   void WriteMessage(const std::string &message);
+  void WriteMessageAsync(Flags options, llvm::StringRef file,
+                         llvm::StringRef function, std::string message);
 
   void Format(llvm::StringRef file, llvm::StringRef function,
               const llvm::formatv_object_base &payload);
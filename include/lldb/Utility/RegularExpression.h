@@ -183,6 +183,14 @@ public:
   //------------------------------------------------------------------
   llvm::StringRef GetText() const;
 
+  //------------------------------------------------------------------
+  /// Get the flags regular expressions are compiled with.
+  ///
+  /// @return
+  ///     The \c regcomp() flags, like \c REG_EXTENDED.
+  //------------------------------------------------------------------
+  int GetCompileFlags() const;
+
   //------------------------------------------------------------------
   /// Test if valid.
   ///
@@ -74,6 +74,7 @@ public:
     eServerPacketType_qFileLoadAddress,
     eServerPacketType_QEnvironment,
     eServerPacketType_QEnableErrorStrings,
+    eServerPacketType_QEnableCompression,
     eServerPacketType_QLaunchArch,
     eServerPacketType_QSetDisableASLR,
     eServerPacketType_QSetDetachOnError,
@@ -99,13 +100,16 @@ public:
     // debug server packages
     eServerPacketType_QEnvironmentHexEncoded,
     eServerPacketType_QListThreadsInStopReply,
+    eServerPacketType_QNonStop,
     eServerPacketType_QPassSignals,
+    eServerPacketType_QRecordHistory,
     eServerPacketType_QRestoreRegisterState,
     eServerPacketType_QSaveRegisterState,
     eServerPacketType_QSetLogging,
     eServerPacketType_QSetMaxPacketSize,
     eServerPacketType_QSetMaxPayloadSize,
     eServerPacketType_QSetEnableAsyncProfiling,
+    eServerPacketType_QSharedMemoryTransport,
     eServerPacketType_QSyncThreadState,
     eServerPacketType_QThreadSuffixSupported,
 
@@ -130,6 +134,7 @@ public:
     eServerPacketType_qWatchpointSupportInfo,
     eServerPacketType_qWatchpointSupportInfoSupported,
     eServerPacketType_qXfer_auxv_read,
+    eServerPacketType_qXfer_libraries_svr4_read,
 
     eServerPacketType_jSignalsInfo,
     eServerPacketType_jModulesInfo,
@@ -140,9 +145,12 @@ public:
     eServerPacketType_vAttachName,
     eServerPacketType_vCont,
     eServerPacketType_vCont_actions, // vCont?
+    eServerPacketType_vStopped,
 
     eServerPacketType_stop_reason, // '?'
 
+    eServerPacketType_bc, // reverse continue
+    eServerPacketType_bs, // reverse step
     eServerPacketType_c,
     eServerPacketType_C,
     eServerPacketType_D,
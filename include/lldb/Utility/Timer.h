@@ -15,6 +15,10 @@
 #include <atomic>
 #include <stdint.h> // for uint32_t
 
+namespace llvm {
+class raw_ostream;
+}
+
 namespace lldb_private {
 class Stream;
 
@@ -59,6 +63,30 @@ public:
 
   static void ResetCategoryTimes();
 
+  //--------------------------------------------------------------
+  /// Record a begin/end event with the thread and a timestamp for every
+  /// timer, on top of the per category totals.
+  ///
+  /// Each thread records into its own fixed size ring buffer, so tracing
+  /// takes no locks and long sessions only keep the most recent events.
+  //--------------------------------------------------------------
+  static void SetTracing(bool enable);
+
+  static bool IsTracing() {
+    return g_tracing.load(std::memory_order_relaxed);
+  }
+
+  //--------------------------------------------------------------
+  /// Drop the events recorded so far.
+  //--------------------------------------------------------------
+  static void ResetTrace();
+
+  //--------------------------------------------------------------
+  /// Write the recorded events in the Chrome trace event format, which
+  /// chrome://tracing and Perfetto can display.
+  //--------------------------------------------------------------
+  static void DumpTrace(llvm::raw_ostream &os);
+
 protected:
   using TimePoint = std::chrono::steady_clock::time_point;
   void ChildDuration(TimePoint::duration dur) { m_child_duration += dur; }
@@ -66,8 +94,12 @@ protected:
   Category &m_category;
   TimePoint m_total_start;
   TimePoint::duration m_child_duration{0};
+  // The index of this timer's event in the thread's trace buffer, or
+  // UINT64_MAX if it isn't being traced.
+  uint64_t m_trace_index = UINT64_MAX;
 
   static std::atomic<bool> g_quiet;
+  static std::atomic<bool> g_tracing;
   static std::atomic<unsigned> g_display_depth;
 
 private:
@@ -0,0 +1,128 @@
+//===-- TrigramIndex.h ------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLDB_UTILITY_TRIGRAMINDEX_H
+#define LLDB_UTILITY_TRIGRAMINDEX_H
+
+#include "lldb/lldb-types.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace lldb_private {
+
+class DataExtractor;
+class RegularExpression;
+
+//----------------------------------------------------------------------
+/// @class TrigramIndex TrigramIndex.h "lldb/Utility/TrigramIndex.h"
+/// @brief An index from three character substrings to the names that
+/// contain them, used to speed up regular expression searches.
+///
+/// Most regular expressions people search symbols with contain literal
+/// text that every match has to contain ("foo::Bar", "^std::vector<").
+/// Only names that contain all trigrams of those literals can match, so
+/// intersecting the posting lists of the trigrams gives a small candidate
+/// set on which the real regular expression needs to be run.
+///
+/// Trigrams are case folded so the index can be used regardless of how
+/// the regular expression treats case. The index only ever narrows the
+/// search; callers still have to run the regular expression on every
+/// candidate.
+//----------------------------------------------------------------------
+class TrigramIndex {
+public:
+  TrigramIndex() = default;
+
+  //------------------------------------------------------------------
+  /// Add a name to the index. Ids must be added in increasing order; the
+  /// same id may be added with more than one name.
+  //------------------------------------------------------------------
+  void Insert(uint32_t id, llvm::StringRef name);
+
+  //------------------------------------------------------------------
+  /// Pack the posting lists. Must be called after the last Insert() and
+  /// before the index is queried.
+  //------------------------------------------------------------------
+  void Finalize();
+
+  void Clear();
+
+  bool IsEmpty() const { return m_trigrams.empty(); }
+
+  //------------------------------------------------------------------
+  /// Find the ids of the names that may match \a regex.
+  ///
+  /// @param[in] regex
+  ///     A POSIX extended regular expression.
+  ///
+  /// @param[out] ids
+  ///     The candidate ids in increasing order.
+  ///
+  /// @return
+  ///     False if the regular expression has no literal text the index
+  ///     can use, in which case every name is a candidate and \a ids is
+  ///     left untouched.
+  //------------------------------------------------------------------
+  bool FindCandidates(llvm::StringRef regex,
+                      std::vector<uint32_t> &ids) const;
+
+  //------------------------------------------------------------------
+  /// Find the ids of the names that may match the compiled regular
+  /// expression \a regex. This also returns false if \a regex isn't valid
+  /// or was compiled with flags that change how its text is read, like
+  /// \c REG_NOSPEC, so that every name has to be searched.
+  //------------------------------------------------------------------
+  bool FindCandidates(const RegularExpression &regex,
+                      std::vector<uint32_t> &ids) const;
+
+  //------------------------------------------------------------------
+  /// Extract literal strings that any string matching \a regex must
+  /// contain. This errs on the side of returning fewer literals: syntax
+  /// it doesn't fully understand just doesn't contribute any.
+  //------------------------------------------------------------------
+  static std::vector<std::string> GetRequiredLiterals(llvm::StringRef regex);
+
+  size_t GetMemoryUsage() const;
+
+  void Encode(llvm::raw_ostream &os) const;
+
+  //------------------------------------------------------------------
+  /// Read an index written by Encode().
+  ///
+  /// @return
+  ///     False if the data is malformed, in which case the index is left
+  ///     empty.
+  //------------------------------------------------------------------
+  bool Decode(const DataExtractor &data, lldb::offset_t *offset_ptr);
+
+private:
+  llvm::ArrayRef<uint32_t> GetPostings(uint32_t trigram) const;
+
+  // The posting lists of the trigrams in m_trigrams (sorted) are stored
+  // back to back in m_postings, and the list of m_trigrams[i] starts at
+  // m_offsets[i].
+  std::vector<uint32_t> m_trigrams;
+  std::vector<uint32_t> m_offsets;
+  std::vector<uint32_t> m_postings;
+  // Posting lists while names are being inserted.
+  llvm::DenseMap<uint32_t, std::vector<uint32_t>> m_pending;
+};
+
+} // namespace lldb_private
+
+#endif // LLDB_UTILITY_TRIGRAMINDEX_H
@@ -99,6 +99,11 @@ FLAGS_ENUM(LaunchFlags){
 //----------------------------------------------------------------------
 enum RunMode { eOnlyThisThread, eAllThreads, eOnlyDuringStepping };
 
+//----------------------------------------------------------------------
+// Thread Run Directions
+//----------------------------------------------------------------------
+enum RunDirection { eRunForward, eRunReverse };
+
 //----------------------------------------------------------------------
 // Byte ordering definitions
 //----------------------------------------------------------------------
@@ -224,7 +229,8 @@ enum StopReason {
   eStopReasonExec, // Program was re-exec'ed
   eStopReasonPlanComplete,
   eStopReasonThreadExiting,
-  eStopReasonInstrumentation
+  eStopReasonInstrumentation,
+  eStopReasonHistoryBoundary // Reverse execution reached the recorded history
 };
 
 //----------------------------------------------------------------------
@@ -259,6 +259,7 @@ class ThreadPlanStepThrough;
 class ThreadPlanTracer;
 class ThreadSpec;
 class TraceOptions;
+class TrigramIndex;
 class Type;
 class TypeAndOrName;
 class TypeCategoryMap;
@@ -0,0 +1,33 @@
+// REQUIRES: lld
+
+// Regular expressions with literal text are answered from the trigram index
+// of the function names. Make sure only names the regular expression really
+// matches are returned.
+
+// RUN: clang %s -g -c -o %t.o --target=x86_64-pc-linux -mllvm -accel-tables=Disable
+// RUN: ld.lld %t.o -o %t
+// RUN: lldb-test symbols --name='^foo_b[a-z]r_ba+z' --regex --find=function %t | \
+// RUN:   FileCheck %s
+// RUN: lldb-test symbols --name='bar::qu\.x' --regex --find=function %t | \
+// RUN:   FileCheck --check-prefix=ESCAPED %s
+// RUN: lldb-test symbols --name='not_there.*at_all' --regex --find=function %t | \
+// RUN:   FileCheck --check-prefix=EMPTY %s
+
+// CHECK: Found 2 functions:
+// CHECK-DAG: name = "foo_bar_baz()", mangled = "_Z11foo_bar_bazv"
+// CHECK-DAG: name = "foo_ber_baaz()", mangled = "_Z12foo_ber_baazv"
+
+// ESCAPED: Found 0 functions:
+
+// EMPTY: Found 0 functions:
+
+void foo_bar_baz() {}
+void foo_ber_baaz() {}
+void Foo_Bar_Baz() {}
+void xfoo_bar_baz() {}
+void foo_bar_bz() {}
+namespace bar {
+void quux() {}
+} // namespace bar
+
+extern "C" void _start() {}
@@ -0,0 +1,18 @@
+// REQUIRES: lld
+
+// RUN: clang %s -c -o %t.o --target=x86_64-pc-linux
+// RUN: ld.lld %t.o -o %t
+// RUN: lldb-test symbols --symtab-memory %t | FileCheck %s
+// RUN: not lldb-test symbols --symtab-memory --find=function --name=foo %t \
+// RUN:   2>&1 | FileCheck --check-prefix=ERROR %s
+
+// CHECK: Symbols: {{[1-9][0-9]*}}
+// CHECK-NEXT: Symbol bytes: {{[1-9][0-9]*}}
+// CHECK-NEXT: Index bytes: {{[1-9][0-9]*}}
+// CHECK-NEXT: Bytes per symbol: {{[0-9]+\.[0-9]}}
+
+// ERROR: -symtab-memory cannot be combined with -verify or -find.
+
+int foo(int x) { return x + 1; }
+int bar(int x) { return foo(x) * 2; }
+extern "C" void _start() { bar(1); }
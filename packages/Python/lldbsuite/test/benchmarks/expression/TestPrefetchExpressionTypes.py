@@ -0,0 +1,85 @@
+"""Test the first expression's response time with and without prefetching the
+debug information of the types it names."""
+
+from __future__ import print_function
+
+
+import os
+import sys
+import lldb
+from lldbsuite.test import configuration
+from lldbsuite.test import lldbtest_config
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbbench import *
+
+
+class PrefetchExpressionTypesBench(BenchBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    def setUp(self):
+        BenchBase.setUp(self)
+        # lldb itself is a large C++ binary.
+        self.exe = lldbtest_config.lldbExec
+        self.break_spec = '-n main'
+        self.expr = 'expr sizeof(Driver) + sizeof(lldb::SBDebugger)'
+        self.count = 10
+
+    @benchmarks_test
+    @no_debug_info_test
+    @expectedFailureAll(
+        oslist=["windows"],
+        bugnumber="llvm.org/pr22274: need a pexpect replacement for windows")
+    def test_prefetch_expression_types(self):
+        """Test the first expression with and without prefetching types."""
+        print()
+        self.run_first_expression_bench(False)
+        without_avg = self.stopwatch.avg()
+        print("lldb first expression benchmark without prefetch:",
+              self.stopwatch)
+        self.run_first_expression_bench(True)
+        with_avg = self.stopwatch.avg()
+        print("lldb first expression benchmark with prefetch:", self.stopwatch)
+        print("with_avg/without_avg: %f" % (with_avg / without_avg))
+
+    def run_first_expression_bench(self, prefetch):
+        import pexpect
+        # Set self.child_prompt, which is "(lldb) ".
+        self.child_prompt = '(lldb) '
+        prompt = self.child_prompt
+
+        # Reset the stopwatch now.
+        self.stopwatch.reset()
+        for i in range(self.count):
+            # So that the child gets torn down after the test.
+            self.child = pexpect.spawn(
+                '%s %s %s' %
+                (lldbtest_config.lldbExec, self.lldbOption, self.exe))
+            child = self.child
+
+            # Turn on logging for what the child sends back.
+            if self.TraceOn():
+                child.logfile_read = sys.stdout
+
+            child.sendline('settings set target.prefetch-expression-types %s' %
+                           ('true' if prefetch else 'false'))
+            child.expect_exact(prompt)
+            child.sendline('breakpoint set %s' % self.break_spec)
+            child.expect_exact(prompt)
+            child.sendline('run')
+            child.expect_exact(prompt)
+
+            # A new process each time, so the types are looked up every time.
+            with self.stopwatch:
+                child.sendline(self.expr)
+                child.expect_exact(prompt)
+
+            child.sendline('quit')
+            try:
+                self.child.expect(pexpect.EOF)
+            except:
+                pass
+
+        # The test is about to end and if we come to here, the child process has
+        # been terminated.  Mark it so.
+        self.child = None
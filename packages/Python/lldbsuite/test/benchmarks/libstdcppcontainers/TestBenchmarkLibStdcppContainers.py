@@ -0,0 +1,81 @@
+"""
+Compare the native libstdc++ synthetic providers with the Python ones.
+"""
+
+from __future__ import print_function
+
+
+import lldb
+from lldbsuite.test.lldbbench import *
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class TestBenchmarkLibStdcppContainers(BenchBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    # The Python providers that used to back these containers.
+    python_providers = {
+        'map': ('^std::map<.+> >(( )?&)?$',
+                'lldb.formatters.cpp.gnu_libstdcpp.StdMapSynthProvider'),
+        'list': ('^std::(__cxx11::)?list<.+>(( )?&)?$',
+                 'lldb.formatters.cpp.gnu_libstdcpp.StdListSynthProvider'),
+    }
+
+    @benchmarks_test
+    @add_test_categories(["libstdcxx"])
+    def test_run_command(self):
+        """Benchmark printing 100k element libstdc++ containers"""
+        self.build()
+        self.data_formatter_commands()
+
+    def setUp(self):
+        # Call super's setUp().
+        BenchBase.setUp(self)
+
+    def data_formatter_commands(self):
+        """Benchmark printing 100k element libstdc++ containers"""
+        self.runCmd("file " + self.getBuildArtifact("a.out"),
+                    CURRENT_EXECUTABLE_SET)
+
+        lldbutil.run_break_set_by_source_regexp(self, "break here")
+
+        self.runCmd("run", RUN_SUCCEEDED)
+
+        # The stop reason of the thread should be breakpoint.
+        self.expect("thread list", STOPPED_DUE_TO_BREAKPOINT,
+                    substrs=['stopped',
+                             'stop reason = breakpoint'])
+
+        # This is the function to remove the custom formats in order to have a
+        # clean slate for the next test case.
+        def cleanup():
+            self.runCmd('type format clear', check=False)
+            self.runCmd('type summary clear', check=False)
+            self.runCmd('type filter clear', check=False)
+            self.runCmd('type synth clear', check=False)
+            self.runCmd(
+                "settings set target.max-children-count 256",
+                check=False)
+
+        # Execute the cleanup function during test case tear down.
+        self.addTearDownHook(cleanup)
+
+        self.runCmd("settings set target.max-children-count 100000")
+
+        for name in ['map', 'list', 'unordered_map', 'deque']:
+            sw = Stopwatch()
+            with sw:
+                self.expect('frame variable -A %s' % name,
+                            substrs=['size=100000', '[99999]'])
+            print("native %s: %s" % (name, sw))
+
+        for name, (regex, provider) in self.python_providers.items():
+            self.runCmd('type synthetic add -x "%s" -l %s' % (regex, provider))
+            sw = Stopwatch()
+            with sw:
+                self.expect('frame variable -A %s' % name,
+                            substrs=['size=100000', '[99999]'])
+            print("python %s: %s" % (name, sw))
@@ -0,0 +1,20 @@
+#include <deque>
+#include <list>
+#include <map>
+#include <unordered_map>
+
+int main()
+{
+    const int count = 100000;
+    std::map<int, int> map;
+    std::list<int> list;
+    std::unordered_map<int, int> unordered_map;
+    std::deque<int> deque;
+    for (int i = 0; i < count; i++) {
+        map[i] = i;
+        list.push_back(i);
+        unordered_map[i] = i;
+        deque.push_back(i);
+    }
+    return map.size() + list.size() + unordered_map.size() + deque.size(); // break here
+}
@@ -0,0 +1,89 @@
+"""Test the cost of recording the execution history on stepping, and the
+speed of stepping backward."""
+
+from __future__ import print_function
+
+import os
+import sys
+import lldb
+from lldbsuite.test import configuration
+from lldbsuite.test import lldbtest_config
+from lldbsuite.test.lldbbench import *
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class ReverseSteppingSpeedBench(BenchBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    def setUp(self):
+        BenchBase.setUp(self)
+        # lldb itself is a large process, with a lot of writable memory.
+        self.exe = lldbtest_config.lldbExec
+        self.break_spec = '-n main'
+        self.count = 50
+
+    @benchmarks_test
+    @no_debug_info_test
+    @skipUnlessPlatform(["linux"])
+    def test_run_lldb_reverse_steppings(self):
+        """Test stepping with and without a recorded history."""
+        print()
+        self.run_lldb_steppings(False)
+        without_avg = self.stopwatch.avg()
+        print("lldb step-inst benchmark without history:", self.stopwatch)
+        self.run_lldb_steppings(True)
+        with_avg = self.stopwatch.avg()
+        print("lldb step-inst benchmark with history:", self.stopwatch)
+        print("with_avg/without_avg: %f" % (with_avg / without_avg))
+        print("lldb reverse step-inst benchmark:", self.reverse_stopwatch)
+
+    def run_lldb_steppings(self, record_history):
+        import pexpect
+        # Set self.child_prompt, which is "(lldb) ".
+        self.child_prompt = '(lldb) '
+        prompt = self.child_prompt
+
+        # So that the child gets torn down after the test.
+        self.child = pexpect.spawn(
+            '%s %s %s' %
+            (lldbtest_config.lldbExec, self.lldbOption, self.exe))
+        child = self.child
+
+        # Turn on logging for what the child sends back.
+        if self.TraceOn():
+            child.logfile_read = sys.stdout
+
+        child.expect_exact(prompt)
+        child.sendline(
+            'settings set plugin.process.gdb-remote.record-history %s' %
+            ('true' if record_history else 'false'))
+        child.expect_exact(prompt)
+        child.sendline('breakpoint set %s' % self.break_spec)
+        child.expect_exact(prompt)
+        child.sendline('run')
+        child.expect_exact(prompt)
+
+        # Every stop takes a checkpoint when the history is recorded.
+        self.stopwatch.reset()
+        for i in range(self.count):
+            with self.stopwatch:
+                child.sendline('thread step-inst')
+                child.expect_exact(prompt)
+
+        if record_history:
+            self.reverse_stopwatch = Stopwatch()
+            for i in range(self.count):
+                with self.reverse_stopwatch:
+                    child.sendline('thread step-inst --reverse')
+                    child.expect_exact(prompt)
+
+        child.sendline('quit')
+        try:
+            self.child.expect(pexpect.EOF)
+        except:
+            pass
+
+        self.child = None
@@ -0,0 +1,55 @@
+"""
+Benchmark how long stopping and resuming a process with many threads takes.
+"""
+
+from __future__ import print_function
+
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbbench import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class TestThreadStopLatency(BenchBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    def setUp(self):
+        BenchBase.setUp(self)
+        self.num_threads = 4000
+        self.num_ticks = 20
+
+    @benchmarks_test
+    @skipUnlessPlatform(["linux"])
+    def test_stop_latency(self):
+        """Time continuing from one breakpoint hit to the next with thousands
+        of threads, which all need to be stopped and resumed every time."""
+        self.build()
+        exe = self.getBuildArtifact("a.out")
+        target = self.dbg.CreateTarget(exe)
+        self.assertTrue(target, VALID_TARGET)
+        bkpt = target.BreakpointCreateBySourceRegex(
+            "// break here", lldb.SBFileSpec("main.cpp"))
+        self.assertTrue(bkpt.GetNumLocations() > 0)
+
+        process = target.LaunchSimple(
+            [str(self.num_threads), str(self.num_ticks)], None,
+            self.get_process_working_directory())
+        self.assertTrue(process, PROCESS_IS_VALID)
+        self.assertEqual(
+            len(lldbutil.get_threads_stopped_at_breakpoint(process, bkpt)), 1)
+        self.assertEqual(process.GetNumThreads(), self.num_threads + 1)
+
+        stopwatch = Stopwatch()
+        for i in range(self.num_ticks - 1):
+            with stopwatch:
+                threads = lldbutil.continue_to_breakpoint(process, bkpt)
+            self.assertEqual(len(threads), 1)
+
+        print("%d threads, continue to breakpoint: %s" %
+              (self.num_threads, stopwatch))
+        bkpt.SetEnabled(False)
+        process.Continue()
+        self.assertEqual(process.GetState(), lldb.eStateExited)
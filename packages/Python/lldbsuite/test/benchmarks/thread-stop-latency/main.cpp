@@ -0,0 +1,31 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+std::atomic<bool> g_done(false);
+
+void worker() {
+  // Mostly blocked, like the idle threads of a big server.
+  while (!g_done)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+void tick(int i) {
+  (void)i; // break here
+}
+
+int main(int argc, char **argv) {
+  const int num_threads = argc > 1 ? std::atoi(argv[1]) : 1000;
+  const int num_ticks = argc > 2 ? std::atoi(argv[2]) : 20;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i)
+    threads.emplace_back(worker);
+  for (int i = 0; i < num_ticks; ++i)
+    tick(i);
+  g_done = true;
+  for (std::thread &t : threads)
+    t.join();
+  return 0;
+}
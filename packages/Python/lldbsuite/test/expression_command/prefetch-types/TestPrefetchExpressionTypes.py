@@ -0,0 +1,42 @@
+"""
+Test that expressions naming types give the same results whether or not their
+debug information is read ahead.
+"""
+
+from __future__ import print_function
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class PrefetchExpressionTypesTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    def check_expressions(self, prefetch):
+        self.build()
+        self.runCmd("settings set target.prefetch-expression-types " +
+                    ("true" if prefetch else "false"))
+        self.addTearDownHook(lambda: self.runCmd(
+            "settings clear target.prefetch-expression-types"))
+
+        (target, process, thread, bkpt) = lldbutil.run_to_source_breakpoint(
+            self, "// Break here", lldb.SBFileSpec("main.cpp"))
+        frame = thread.GetFrameAtIndex(0)
+
+        for expr, result in [("line.to.x", 5),
+                             ("((Point *)&line.from)->base_value", 1),
+                             ("line.to.extra.value", 4),
+                             ("sizeof(Line) == 2 * sizeof(Point)", 1)]:
+            value = frame.EvaluateExpression(expr)
+            self.assertTrue(value.GetError().Success(),
+                            "%s: %s" % (expr, value.GetError()))
+            self.assertEqual(value.GetValueAsSigned(), result, expr)
+
+    def test_with_prefetch(self):
+        self.check_expressions(True)
+
+    def test_without_prefetch(self):
+        self.check_expressions(False)
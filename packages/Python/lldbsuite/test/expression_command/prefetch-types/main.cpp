@@ -0,0 +1,25 @@
+template <typename T> struct Wrapper {
+  T value;
+};
+
+struct Base {
+  int base_value = 1;
+};
+
+struct Point : Base {
+  int x = 2;
+  int y = 3;
+  Wrapper<long> extra = {4};
+};
+
+struct Line {
+  Point from;
+  Point to;
+};
+
+int main(int argc, char **argv) {
+  Line line;
+  line.to.x = 5;
+  // Break here
+  return line.from.x;
+}
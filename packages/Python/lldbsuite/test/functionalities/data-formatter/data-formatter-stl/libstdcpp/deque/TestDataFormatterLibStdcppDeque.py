@@ -0,0 +1,46 @@
+"""
+Test lldb data formatter subsystem.
+"""
+
+from __future__ import print_function
+
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class LibStdcppDequeDataFormatterTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    @add_test_categories(["libstdcxx"])
+    def test_with_run_command(self):
+        """Test that std::deque is displayed correctly across buffers."""
+        self.build()
+        lldbutil.run_to_source_breakpoint(
+            self, "Set break point at this line.",
+            lldb.SBFileSpec("main.cpp", False))
+
+        self.expect("frame variable empty",
+                    substrs=['size=0',
+                             '{}'])
+
+        self.expect("frame variable numbers",
+                    substrs=['size=301',
+                             '[0] = -2',
+                             '[1] = -1',
+                             '[2] = 1',
+                             '[255] = 254'])
+
+        # Elements past the first buffer of 128 ints.
+        self.expect("frame variable numbers[200]",
+                    substrs=['= 199'])
+        self.expect("frame variable numbers[300]",
+                    substrs=['= 299'])
+
+        self.expect("frame variable strings",
+                    substrs=['size=2',
+                             '[0] = "world"',
+                             '[1] = "hello"'])
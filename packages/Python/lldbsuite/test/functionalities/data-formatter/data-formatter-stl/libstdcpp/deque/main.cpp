@@ -0,0 +1,19 @@
+#include <deque>
+#include <string>
+
+int main()
+{
+    std::deque<int> empty;
+    std::deque<int> numbers;
+    for (int i = 0; i < 300; i++)
+        numbers.push_back(i);
+    // Make the deque start in the middle of its first buffer.
+    numbers.pop_front();
+    numbers.push_front(-1);
+    numbers.push_front(-2);
+
+    std::deque<std::string> strings;
+    strings.push_back("hello");
+    strings.push_front("world");
+    return numbers.size() + strings.size() + empty.size(); // Set break point at this line.
+}
@@ -0,0 +1,53 @@
+"""
+Test lldb data formatter subsystem.
+"""
+
+from __future__ import print_function
+
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class LibStdcppUnorderedDataFormatterTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    @add_test_categories(["libstdcxx"])
+    def test_with_run_command(self):
+        """Test that the std::unordered_* containers are displayed correctly."""
+        self.build()
+        lldbutil.run_to_source_breakpoint(
+            self, "Set break point at this line.",
+            lldb.SBFileSpec("main.cpp", False))
+
+        self.look_for_content_and_continue(
+            "map", ['std::unordered_map', 'size=5 {', 'hello', 'world',
+                    'this', 'is', 'me'])
+
+        self.look_for_content_and_continue(
+            "mmap", ['std::unordered_multimap', 'size=6 {', 'first = 3',
+                     'second = "this"', 'first = 2', 'second = "hello"'])
+
+        self.look_for_content_and_continue(
+            "iset", ['std::unordered_set', 'size=5 {', '\[\d\] = 5',
+                     '\[\d\] = 3', '\[\d\] = 2'])
+
+        self.look_for_content_and_continue(
+            "sset", ['std::unordered_set', 'size=5 {', '\[\d\] = "is"',
+                     '\[\d\] = "world"', '\[\d\] = "hello"'])
+
+        self.look_for_content_and_continue(
+            "imset", ['std::unordered_multiset', 'size=6 {',
+                      '(\[\d\] = 3(\\n|.)+){3}', '\[\d\] = 2', '\[\d\] = 1'])
+
+        self.look_for_content_and_continue(
+            "smset", ['std::unordered_multiset', 'size=5 {',
+                      '(\[\d\] = "is"(\\n|.)+){2}',
+                      '(\[\d\] = "world"(\\n|.)+){2}'])
+
+    def look_for_content_and_continue(self, var_name, patterns):
+        self.expect(("frame variable %s" % var_name), patterns=patterns)
+        self.runCmd("continue")
@@ -0,0 +1,47 @@
+"""
+Test that the time spent in Python formatters is reported by
+'statistics dump'.
+"""
+
+from __future__ import print_function
+
+
+import os
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class FormatterStatisticsTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    @skipIfRemote
+    def test_formatter_statistics(self):
+        """Test that Python summary calls are counted per formatter."""
+        self.build()
+        lldbutil.run_to_source_breakpoint(
+            self, "Set break point at this line.", lldb.SBFileSpec("main.cpp"))
+
+        # This is the function to remove the custom formats in order to have a
+        # clean slate for the next test case.
+        def cleanup():
+            self.runCmd('type summary clear', check=False)
+            self.runCmd('statistics disable', check=False)
+
+        # Execute the cleanup function during test case tear down.
+        self.addTearDownHook(cleanup)
+
+        self.runCmd("command script import " +
+                    os.path.join(self.getSourceDir(), "point_summary.py"))
+        self.runCmd("type summary add Point -F point_summary.point_summary")
+        self.runCmd("statistics enable")
+
+        # All the summaries are computed while printing a single value.
+        self.expect("frame variable points",
+                    substrs=['[0] = (0, 0)', '[15] = (15, -15)'])
+
+        self.expect("statistics dump",
+                    substrs=['Python formatters:'],
+                    patterns=['\(\d+ calls\) for point_summary.point_summary'])
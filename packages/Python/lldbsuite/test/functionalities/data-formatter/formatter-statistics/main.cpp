@@ -0,0 +1,13 @@
+struct Point {
+  int x;
+  int y;
+};
+
+int main() {
+  Point points[16];
+  for (int i = 0; i < 16; ++i) {
+    points[i].x = i;
+    points[i].y = -i;
+  }
+  return points[15].x; // Set break point at this line.
+}
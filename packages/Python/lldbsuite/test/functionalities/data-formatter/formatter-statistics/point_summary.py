@@ -0,0 +1,4 @@
+def point_summary(valobj, internal_dict):
+    x = valobj.GetChildMemberWithName('x').GetValueAsSigned()
+    y = valobj.GetChildMemberWithName('y').GetValueAsSigned()
+    return '(%d, %d)' % (x, y)
@@ -0,0 +1,53 @@
+"""
+Test that debugging works the same when the debug info is freed at every stop
+to stay within symbols.memory-budget.
+"""
+
+from __future__ import print_function
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class DebugInfoMemoryBudgetTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    NO_DEBUG_INFO_TESTCASE = True
+
+    def test_size_suffix(self):
+        self.addTearDownHook(lambda: self.runCmd(
+            "settings clear symbols.memory-budget"))
+        self.runCmd("settings set symbols.memory-budget 8GB")
+        self.expect("settings show symbols.memory-budget",
+                    substrs=["8589934592"])
+        self.expect("settings set symbols.memory-budget 8XB", error=True)
+
+    def test_tiny_budget(self):
+        self.build()
+        self.addTearDownHook(lambda: self.runCmd(
+            "settings clear symbols.memory-budget"))
+        # Everything that can be freed is freed at every stop.
+        self.runCmd("settings set symbols.memory-budget 1")
+
+        (target, process, thread, bkpt) = lldbutil.run_to_source_breakpoint(
+            self, "// Break in advance", lldb.SBFileSpec("other.c"))
+        for i in range(4):
+            frame = thread.GetFrameAtIndex(0)
+            self.assertEqual(frame.GetFunctionName(), "advance")
+            counter = frame.FindVariable("counter").Dereference()
+            self.assertEqual(
+                counter.GetChildMemberWithName("count").GetValueAsSigned(),
+                3 * i)
+            value = frame.EvaluateExpression("counter->step")
+            self.assertTrue(value.GetError().Success())
+            self.assertEqual(value.GetValueAsSigned(), 3)
+            self.assertEqual(thread.GetFrameAtIndex(1).GetLineEntry().GetLine(),
+                             line_number("main.c", "total += advance"))
+            process.Continue()
+
+        self.assertEqual(process.GetState(), lldb.eStateExited)
+        self.assertEqual(process.GetExitStatus(), 0)
+        self.expect("statistics dump")
@@ -0,0 +1,14 @@
+struct Counter {
+  int count;
+  int step;
+};
+
+int advance(struct Counter *counter);
+
+int main() {
+  struct Counter counter = {0, 3};
+  int total = 0;
+  for (int i = 0; i < 4; ++i)
+    total += advance(&counter);
+  return total == 30 ? 0 : 1; // Break in main
+}
@@ -0,0 +1,9 @@
+struct Counter {
+  int count;
+  int step;
+};
+
+int advance(struct Counter *counter) {
+  counter->count += counter->step; // Break in advance
+  return counter->count;
+}
@@ -69,3 +69,30 @@ class MemoryFindTestCase(TestBase):
 
         self.expect('memory find -s "nothere" `stringdata` `stringdata+10`',
                     substrs=['data not found within the range.'])
+
+        # Several patterns are searched for in a single pass, and --all
+        # reports every match in address order.
+        self.expect(
+            'memory find -s "like" -s "hello" --all `stringdata` `stringdata+(int)strlen(stringdata)`',
+            substrs=[
+                '68 65 6c 6c 6f',
+                '6c 69 6b 65',
+                'no more matches within the range.'])
+
+        # Only the bits set in the mask are compared.
+        self.expect(
+            'memory find -s "hXllo" -m ff00ffffff `stringdata` `stringdata+(int)strlen(stringdata)`',
+            substrs=[
+                'data found at location: 0x',
+                'hello world'])
+
+        self.expect(
+            'memory find -s "hello" -m ff00 `stringdata` `stringdata+(int)strlen(stringdata)`',
+            error=True,
+            substrs=['the mask is 2 bytes long but the pattern is 5 bytes long'])
+
+        self.expect(
+            'memory find -s "hello" -m xyz `stringdata` `stringdata+(int)strlen(stringdata)`',
+            error=True,
+            substrs=['invalid mask'])
+
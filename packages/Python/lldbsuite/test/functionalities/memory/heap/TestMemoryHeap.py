@@ -0,0 +1,82 @@
+"""
+Test the 'memory heap' commands.
+"""
+
+from __future__ import print_function
+
+
+import lldb
+from lldbsuite.test.lldbtest import *
+import lldbsuite.test.lldbutil as lldbutil
+from lldbsuite.test.decorators import *
+
+
+class MemoryHeapTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    def get_type_row(self, output, type_name):
+        for line in output.splitlines():
+            fields = line.split()
+            if fields and fields[-1] == type_name:
+                return [int(f) for f in fields[:-1]]
+        self.fail("no row for %s in:\n%s" % (type_name, output))
+
+    # The heap walker understands the glibc malloc chunk layout.
+    @skipUnlessPlatform(["linux"])
+    def test_memory_heap(self):
+        """Test taking, inspecting and comparing heap snapshots."""
+        self.build()
+        exe = self.getBuildArtifact("a.out")
+        self.runCmd("file " + exe, CURRENT_EXECUTABLE_SET)
+
+        lldbutil.run_break_set_by_source_regexp(
+            self, "Take the first snapshot here")
+        lldbutil.run_break_set_by_source_regexp(
+            self, "Take the second snapshot here")
+        self.runCmd("run", RUN_SUCCEEDED)
+
+        snapshot = self.getBuildArtifact("first.heap")
+        self.expect("memory heap snapshot " + snapshot,
+                    substrs=["Wrote", "objects", "references",
+                             "not reachable from any root"])
+
+        # The list hangs off a global, so all of it is reachable and the
+        # head node retains the whole list. Nothing points to the leaked
+        # objects any more.
+        self.runCmd("memory heap top --count 0 " + snapshot)
+        count, size, retained, leaked, leaked_size = self.get_type_row(
+            self.res.GetOutput(), "Kept")
+        self.assertEqual(count, 100)
+        self.assertEqual(leaked, 0)
+        self.assertTrue(retained >= size)
+
+        count, size, retained, leaked, leaked_size = self.get_type_row(
+            self.res.GetOutput(), "Leaked")
+        self.assertEqual(count, 50)
+        self.assertTrue(leaked >= 45)
+
+        self.runCmd("continue")
+        self.runCmd("memory heap diff " + snapshot)
+        count_delta, size_delta, new_objects = self.get_type_row(
+            self.res.GetOutput(), "Kept")
+        self.assertEqual(count_delta, 50)
+        self.assertEqual(new_objects, 50)
+        self.assertTrue(size_delta > 0)
+
+        self.expect("memory heap top " + self.getBuildArtifact("missing.heap"),
+                    error=True, substrs=["unable to read"])
+
+        # The heap can only be walked while the process is stopped.
+        process = self.dbg.GetSelectedTarget().GetProcess()
+        self.dbg.SetAsync(True)
+        process.Continue()
+        lldbutil.expect_state_changes(self, self.dbg.GetListener(), process,
+                                      [lldb.eStateRunning])
+        self.expect("memory heap top", error=True,
+                    substrs=["Process is running"])
+        self.expect("memory heap diff " + snapshot, error=True,
+                    substrs=["Process is running"])
+        process.Stop()
+        lldbutil.expect_state_changes(self, self.dbg.GetListener(), process,
+                                      [lldb.eStateStopped])
@@ -0,0 +1,47 @@
+//===-- main.cpp ------------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+struct Base {
+  virtual ~Base() {}
+};
+
+struct Kept : Base {
+  Kept *next = nullptr;
+  char payload[40];
+};
+
+struct Leaked : Base {
+  char payload[100];
+};
+
+Kept *g_list = nullptr;
+volatile bool g_spin = true;
+
+void __attribute__((noinline)) keep(int count) {
+  for (int i = 0; i < count; ++i) {
+    Kept *kept = new Kept;
+    kept->next = g_list;
+    g_list = kept;
+  }
+}
+
+void __attribute__((noinline)) leak(int count) {
+  for (int i = 0; i < count; ++i)
+    new Leaked;
+}
+
+int main(int argc, char const *argv[]) {
+  keep(100);
+  leak(50);
+  int first_snapshot = 0; // Take the first snapshot here.
+  keep(50);
+  while (g_spin) // Take the second snapshot here.
+    ;
+  return first_snapshot;
+}
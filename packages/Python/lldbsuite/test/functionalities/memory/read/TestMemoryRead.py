@@ -8,6 +8,7 @@ from __future__ import print_function
 import os
 import time
 import re
+import struct
 import lldb
 from lldbsuite.test.lldbtest import *
 import lldbsuite.test.lldbutil as lldbutil
@@ -119,6 +120,22 @@ class MemoryReadTestCase(TestBase):
                 '18',
                 '20'])
 
+        # Binary dumps to a file are streamed straight to disk.
+        outfile = self.getBuildArtifact("my_ints.bin")
+        self.expect(
+            'memory read --binary --outfile "%s" `&my_ints[0]` `&my_ints[11]`' %
+            outfile,
+            substrs=['44 bytes written to'])
+        with open(outfile, 'rb') as f:
+            self.assertEqual(struct.unpack('11i', f.read()),
+                             tuple(range(2, 24, 2)))
+
+        self.expect(
+            'memory read --binary --append-outfile --outfile "%s" `&my_ints[0]` `&my_ints[2]`' %
+            outfile,
+            substrs=['8 bytes appended to'])
+        self.assertEqual(os.path.getsize(outfile), 52)
+
         # the gdb format specifier and the size in characters for
         # the returned values including the 0x prefix.
         variations = [['b', 4], ['h', 6], ['w', 10], ['g', 18]]
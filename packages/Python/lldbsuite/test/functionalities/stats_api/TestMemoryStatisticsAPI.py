@@ -0,0 +1,61 @@
+# Test SBDebugger::GetMemoryStatistics() and "statistics memory".
+
+import json
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class TestMemoryStatsAPI(TestBase):
+    mydir = TestBase.compute_mydir(__file__)
+
+    def get_memory_stats(self):
+        stream = lldb.SBStream()
+        self.assertTrue(
+            self.dbg.GetMemoryStatistics().GetAsJSON(stream).Success())
+        return json.loads(stream.GetData())
+
+    def test_memory_stats_api(self):
+        self.build()
+        exe = self.getBuildArtifact("a.out")
+        (target, process, thread, bkpt) = lldbutil.run_to_name_breakpoint(
+            self, "main")
+        frame = thread.GetFrameAtIndex(0)
+        self.assertTrue(frame.EvaluateExpression("1 + 1").IsValid())
+        process.ReadMemory(frame.GetSP(), 64, lldb.SBError())
+
+        stats = self.get_memory_stats()
+        self.assertTrue(stats["strings"]["used"] > 0)
+        self.assertTrue(stats["strings"]["total"] >= stats["strings"]["used"])
+
+        exe_stats = [module for module in stats["modules"]
+                     if module["path"] == exe]
+        self.assertEqual(len(exe_stats), 1)
+        exe_stats = exe_stats[0]
+        self.assertTrue(exe_stats["symbols"] > 0)
+        self.assertTrue(exe_stats["line_tables"] > 0)
+        self.assertEqual(exe_stats["total"],
+                         sum(exe_stats[key] for key in
+                             ["symbols", "symbol_indexes", "debug_info",
+                              "line_tables", "type_systems"]))
+
+        target_stats = [t for t in stats["targets"] if t["executable"] == exe]
+        self.assertEqual(len(target_stats), 1)
+        self.assertTrue(target_stats[0]["scratch_type_systems"] > 0)
+
+        totals = stats["totals"]
+        self.assertEqual(totals["total"],
+                         sum(value for key, value in totals.items()
+                             if key != "total"))
+
+        self.expect("statistics memory",
+                    substrs=["String pool", "Line tables", "Total", exe])
+
+        # Another debugger without targets reports none of these modules.
+        other = lldb.SBDebugger.Create()
+        self.addTearDownHook(lambda: lldb.SBDebugger.Destroy(other))
+        stream = lldb.SBStream()
+        self.assertTrue(
+            other.GetMemoryStatistics().GetAsJSON(stream).Success())
+        self.assertEqual(json.loads(stream.GetData())["modules"], [])
@@ -0,0 +1,73 @@
+"""
+Test that symbol tables saved in symbols.index-cache-path are loaded by later
+sessions and answer lookups like freshly parsed ones.
+"""
+
+from __future__ import print_function
+
+import glob
+import os
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class SymtabCacheTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    NO_DEBUG_INFO_TESTCASE = True
+
+    def create_target_and_dump(self, exe):
+        target = self.dbg.CreateTarget(exe)
+        self.assertTrue(target, VALID_TARGET)
+        module = target.GetModuleAtIndex(0)
+        self.assertTrue(module.GetNumSymbols() > 0)
+        results = []
+        for command in ["image dump symtab -s address a.out",
+                        "image lookup -n sum_of_squares",
+                        "image lookup -r -s square"]:
+            self.runCmd(command)
+            results.append(self.res.GetOutput())
+        address = module.FindSymbol("sum_of_squares").GetStartAddress()
+        self.runCmd("image lookup -a 0x%x" % (address.GetFileAddress() + 1))
+        results.append(self.res.GetOutput())
+        del address, module
+        self.dbg.DeleteTarget(target)
+        # Drop the module so the next target reads the symbol table again.
+        lldb.SBDebugger.MemoryPressureDetected()
+        return results
+
+    @skipUnlessPlatform(["linux", "freebsd", "netbsd"])
+    def test_symtab_cache(self):
+        self.build()
+        exe = self.getBuildArtifact("a.out")
+        cache_dir = self.getBuildArtifact("index-cache")
+        self.addTearDownHook(lambda: self.runCmd(
+            "settings clear symbols.index-cache-path"))
+        self.runCmd("settings set symbols.index-cache-path " + cache_dir)
+
+        parsed = self.create_target_and_dump(exe)
+        cache_files = glob.glob(os.path.join(cache_dir, "*-a.out.symtab"))
+        self.assertEqual(len(cache_files), 1)
+
+        loaded = self.create_target_and_dump(exe)
+        self.assertEqual(parsed, loaded)
+        self.assertTrue("sum_of_squares" in loaded[1])
+
+        # A damaged cache file is ignored.
+        with open(cache_files[0], "r+b") as f:
+            f.truncate(64)
+        self.assertEqual(parsed, self.create_target_and_dump(exe))
+
+        # A cache file saved for an older copy of the binary is rebuilt, even
+        # though the binary kept its name and UUID.
+        with open(cache_files[0], "rb") as f:
+            saved = f.read()
+        stat = os.stat(exe)
+        os.utime(exe, (stat.st_atime, stat.st_mtime + 10))
+        self.assertEqual(parsed, self.create_target_and_dump(exe))
+        with open(cache_files[0], "rb") as f:
+            self.assertNotEqual(saved, f.read())
@@ -0,0 +1,10 @@
+static int square(int x) { return x * x; }
+
+int sum_of_squares(int n) {
+  int total = 0;
+  for (int i = 0; i < n; ++i)
+    total += square(i);
+  return total;
+}
+
+int main(int argc, char **argv) { return sum_of_squares(argc) == 0; }
@@ -0,0 +1,104 @@
+from __future__ import print_function
+
+import zlib
+
+import gdbremote_testcase
+import lldbgdbserverutils
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class TestGdbRemoteCompression(gdbremote_testcase.GdbRemoteTestCaseBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    # Long enough that the hex encoded read is above the stub's compression
+    # threshold.
+    MESSAGE_SIZE = 256
+    MEMORY_CONTENTS = "compress me " * 20
+
+    def enable_compression(self):
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=[
+                "set-message:%s" % self.MEMORY_CONTENTS,
+                "get-data-address-hex:g_message",
+                "sleep:5"])
+        self.test_sequence.add_log_lines([
+            "read packet: $c#63",
+            {"type": "output_match", "regex": self.maybe_strict_output_regex(
+                r"data address: 0x([0-9a-fA-F]+)\r\n"),
+             "capture": {1: "message_address"}},
+        ], True)
+        self.add_interrupt_packets()
+        self.add_qSupported_packets()
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        self.assertIsNotNone(context.get("message_address"))
+        message_address = int(context.get("message_address"), 16)
+
+        features = self.parse_qSupported_response(context)
+        compressions = features.get("SupportedCompressions", "").split(",")
+        if "zlib-deflate" not in compressions:
+            self.skipTest("zlib compression not supported")
+
+        # The OK is the last uncompressed packet.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines([
+            "read packet: $QEnableCompression:type:zlib-deflate;#00",
+            "send packet: $OK#00",
+        ], True)
+        self.assertIsNotNone(self.expect_gdbremote_sequence())
+        return message_address
+
+    @llgs_test
+    def test_large_packets_are_deflated_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        message_address = self.enable_compression()
+
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines([
+            "read packet: $m{0:x},{1:x}#00".format(
+                message_address, self.MESSAGE_SIZE),
+            {"direction": "send",
+             "regex": re.compile(r"^\$C([0-9]+):(.*)#[0-9a-fA-F]{2}$",
+                                 re.MULTILINE | re.DOTALL),
+             "capture": {1: "uncompressed_size",
+                         2: "compressed_raw"}},
+        ], True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        # The payload is raw deflate data with the binary escaping applied,
+        # and the size is that of the uncompressed payload.
+        compressed = self.decode_gdbremote_binary(
+            context.get("compressed_raw"))
+        payload = zlib.decompress(compressed, -15)
+        self.assertEqual(len(payload), int(context.get("uncompressed_size")))
+        self.assertLess(len(compressed), len(payload))
+
+        expected = self.MEMORY_CONTENTS + \
+            "\0" * (self.MESSAGE_SIZE - len(self.MEMORY_CONTENTS))
+        self.assertEqual(
+            lldbgdbserverutils.gdbremote_hex_decode_string(payload), expected)
+
+    @llgs_test
+    def test_small_packets_are_not_deflated_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        self.enable_compression()
+
+        # Short replies go out as they are, behind an 'N'.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines([
+            "read packet: $qC#b4",
+            {"direction": "send",
+             "regex": r"^\$NQC([0-9a-fA-F]+)#[0-9a-fA-F]{2}$",
+             "capture": {1: "thread_id"}},
+        ], True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        self.assertIsNotNone(context.get("thread_id"))
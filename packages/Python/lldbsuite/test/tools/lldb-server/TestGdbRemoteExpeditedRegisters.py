@@ -1,7 +1,9 @@
 from __future__ import print_function
 
 
+import json
 import gdbremote_testcase
+import lldbgdbserverutils
 from lldbsuite.test.decorators import *
 from lldbsuite.test.lldbtest import *
 from lldbsuite.test import lldbutil
@@ -160,3 +162,132 @@ class TestGdbRemoteExpeditedRegisters(
         self.build()
         self.set_inferior_startup_launch()
         self.stop_notification_contains_sp_register()
+
+    def stop_notification_contains_stack_memory(self):
+        # Generate a stop reply, parse out the expedited memory.
+        procs = self.prep_debug_monitor_and_inferior(inferior_args=["sleep:2"])
+        self.add_process_info_collection_packets()
+        self.test_sequence.add_log_lines([
+            "read packet: $c#63",
+            "read packet: {}".format(chr(3)),
+            {"direction": "send",
+             "regex": r"^\$T([0-9a-fA-F]+)([^#]+)#[0-9a-fA-F]{2}$",
+             "capture": {1: "stop_result",
+                         2: "key_vals_text"}},
+        ], True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        endian = self.parse_process_info_response(context).get("endian")
+        self.assertIsNotNone(endian)
+
+        key_vals_text = context.get("key_vals_text")
+        kv_dict = self.parse_key_val_dict(key_vals_text)
+        memory = kv_dict.get("memory")
+        self.assertIsNotNone(memory)
+        if not isinstance(memory, list):
+            memory = [memory]
+        memory_addrs = [int(m.split("=")[0], 0) for m in memory]
+
+        # The top of the stack is one of the expedited blocks.
+        expedited_registers = self.extract_registers_from_stop_notification(
+            key_vals_text)
+        reg_info = self.find_generic_register_with_name(
+            self.gather_register_infos(), "sp")
+        self.assertIsNotNone(reg_info)
+        sp = lldbgdbserverutils.unpack_register_hex_unsigned(
+            endian, expedited_registers[reg_info["lldb_register_index"]])
+        self.assertIn(sp, memory_addrs)
+
+    @llgs_test
+    def test_stop_notification_contains_stack_memory_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        self.stop_notification_contains_stack_memory()
+
+    def gather_threads_info(self, options=None):
+        # Stop the inferior and ask for the expedited data of its threads.
+        procs = self.prep_debug_monitor_and_inferior(inferior_args=["sleep:2"])
+        self.add_process_info_collection_packets()
+        packet = "jThreadsInfo"
+        if options is not None:
+            packet += ":" + json.dumps(options, separators=(",", ":"))
+        packet = packet.replace("}", "}]")
+        self.test_sequence.add_log_lines([
+            "read packet: $c#63",
+            "read packet: {}".format(chr(3)),
+            {"direction": "send",
+             "regex": r"^\$T([0-9a-fA-F]+)([^#]+)#[0-9a-fA-F]{2}$"},
+            "read packet: {}".format(
+                lldbgdbserverutils.gdbremote_packet_encode_string(packet)),
+            {"direction": "send",
+             "regex": r"^\$(\[.*\])#[0-9a-fA-F]{2}$",
+             "capture": {1: "threads_info"}},
+        ], True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        endian = self.parse_process_info_response(context).get("endian")
+        self.assertIsNotNone(endian)
+
+        threads_info = json.loads(
+            self.decode_gdbremote_binary(context.get("threads_info")))
+        self.assertTrue(len(threads_info) > 0)
+        return (endian, threads_info)
+
+    def threads_info_contains_stack_memory(self):
+        (endian, threads_info) = self.gather_threads_info()
+        reg_info = self.find_generic_register_with_name(
+            self.gather_register_infos(), "sp")
+        self.assertIsNotNone(reg_info)
+        sp_index = str(reg_info["lldb_register_index"])
+
+        # By default, the registers needed to start a backtrace are expedited,
+        # and the top of the stack is one of the expedited blocks.
+        for thread_info in threads_info:
+            registers = thread_info.get("registers")
+            self.assertIsNotNone(registers)
+            self.assertIn(sp_index, registers)
+            self.assertTrue(len(registers) <= 4)
+            sp = lldbgdbserverutils.unpack_register_hex_unsigned(
+                endian, registers[sp_index])
+
+            memory = thread_info.get("memory")
+            self.assertIsNotNone(memory)
+            for block in memory:
+                self.assertTrue(len(block["bytes"]) > 0)
+                self.assertEqual(len(block["bytes"]) % 2, 0)
+            self.assertIn(sp, [block["address"] for block in memory])
+
+    @llgs_test
+    def test_threads_info_contains_stack_memory_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        self.threads_info_contains_stack_memory()
+
+    def threads_info_with_options(self):
+        (endian, threads_info) = self.gather_threads_info(
+            {"full_gprs": True, "stack_memory": 0})
+        reg_infos = self.gather_register_infos()
+
+        # All the registers of the first set that aren't part of other
+        # registers are expedited, and no stack memory is.
+        gpr_set = reg_infos[0].get("set")
+        self.assertIsNotNone(gpr_set)
+        gprs = set(str(reg_info["lldb_register_index"])
+                   for reg_info in reg_infos
+                   if reg_info.get("set") == gpr_set and
+                   "container-regs" not in reg_info)
+        self.assertTrue(len(gprs) > 4)
+        for thread_info in threads_info:
+            registers = thread_info.get("registers")
+            self.assertIsNotNone(registers)
+            self.assertEqual(set(registers.keys()), gprs)
+            self.assertNotIn("memory", thread_info)
+
+    @llgs_test
+    def test_threads_info_with_options_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        self.threads_info_with_options()
@@ -0,0 +1,144 @@
+from __future__ import print_function
+
+import xml.etree.ElementTree as ET
+
+import gdbremote_testcase
+import lldbgdbserverutils
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class TestGdbRemoteLibrariesSvr4Support(gdbremote_testcase.GdbRemoteTestCaseBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    FEATURE_NAME = "qXfer:libraries-svr4:read"
+
+    def setup_test(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+
+        # Wait for main so the dynamic linker has loaded everything, then
+        # interrupt to leave the process stopped.
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=["message:main entered", "sleep:5"])
+        self.test_sequence.add_log_lines([
+            "read packet: $c#63",
+            {"type": "output_match", "regex": self.maybe_strict_output_regex(
+                r"message:main entered\r\n")},
+        ], True)
+        self.add_interrupt_packets()
+        self.add_qSupported_packets()
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        return self.parse_qSupported_response(context)
+
+    def get_libraries_svr4_data(self, length):
+        data = ""
+        offset = 0
+        while True:
+            self.reset_test_sequence()
+            self.test_sequence.add_log_lines(
+                [
+                    "read packet: $qXfer:libraries-svr4:read::{:x},{:x}:#00".format(
+                        offset, length),
+                    {
+                        "direction": "send",
+                        "regex": re.compile(
+                            r"^\$([^E])(.*)#[0-9a-fA-F]{2}$",
+                            re.MULTILINE | re.DOTALL),
+                        "capture": {
+                            1: "response_type",
+                            2: "content_raw"}}],
+                True)
+            context = self.expect_gdbremote_sequence()
+            self.assertIsNotNone(context)
+
+            chunk = self.decode_gdbremote_binary(context.get("content_raw"))
+            data += chunk
+            offset += len(chunk)
+            if context.get("response_type") == "l":
+                return data
+            self.assertEqual(context.get("response_type"), "m")
+            self.assertEqual(len(chunk), length)
+
+    def check_libraries_svr4(self, length):
+        features = self.setup_test()
+        self.assertEqual(features.get(self.FEATURE_NAME), "+")
+
+        root = ET.fromstring(self.get_libraries_svr4_data(length))
+        self.assertEqual(root.tag, "library-list-svr4")
+        # The rendezvous address comes from qShlibInfoAddr instead.
+        self.assertIsNone(root.get("main-lm"))
+        libraries = root.findall("library")
+        self.assertTrue(len(libraries) > 0)
+        link_maps = set()
+        for library in libraries:
+            self.assertTrue(len(library.get("name")) > 0)
+            for attribute in ["lm", "l_addr", "l_ld"]:
+                self.assertIsNotNone(library.get(attribute))
+            link_maps.add(int(library.get("lm"), 16))
+        # Each library has its own link map entry.
+        self.assertEqual(len(link_maps), len(libraries))
+        self.assertTrue(any("libc" in library.get("name")
+                            for library in libraries))
+
+    @llgs_test
+    @skipUnlessPlatform(["linux"])
+    def test_libraries_svr4_llgs(self):
+        self.check_libraries_svr4(0x10000)
+
+    @llgs_test
+    @skipUnlessPlatform(["linux"])
+    def test_libraries_svr4_chunked_llgs(self):
+        self.check_libraries_svr4(0x40)
+
+    def read_pointer(self, address, word_size, endian):
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $m{0:x},{1:x}#00".format(address, word_size),
+             {"direction": "send",
+              "regex": r"^\$([0-9a-fA-F]+)#[0-9a-fA-F]{2}$",
+              "capture": {1: "contents"}}],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        return lldbgdbserverutils.unpack_register_hex_unsigned(
+            endian, context.get("contents"))
+
+    @llgs_test
+    @skipUnlessPlatform(["linux"])
+    def test_shlib_info_addr_llgs(self):
+        self.setup_test()
+        self.reset_test_sequence()
+        self.add_process_info_collection_packets()
+        self.test_sequence.add_log_lines(
+            ["read packet: $qShlibInfoAddr#00",
+             {"direction": "send",
+              "regex": r"^\$([0-9a-fA-F]+)#[0-9a-fA-F]{2}$",
+              "capture": {1: "debug_entry"}}],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        proc_info = self.parse_process_info_response(context)
+        word_size = int(proc_info["ptrsize"])
+        endian = proc_info["endian"]
+
+        # The reply is the DT_DEBUG slot, which the dynamic linker points at
+        # its r_debug. The main executable's link map heads r_map, and the
+        # next entry is the first library the svr4 list reports.
+        r_debug = self.read_pointer(int(context.get("debug_entry"), 16),
+                                    word_size, endian)
+        self.assertNotEqual(r_debug, 0)
+        # r_version is an int followed by the pointer-aligned r_map.
+        r_map = self.read_pointer(r_debug + word_size, word_size, endian)
+        self.assertNotEqual(r_map, 0)
+        # l_next follows l_addr, l_name and l_ld.
+        l_next = self.read_pointer(r_map + 3 * word_size, word_size, endian)
+
+        root = ET.fromstring(self.get_libraries_svr4_data(0x10000))
+        libraries = root.findall("library")
+        self.assertTrue(len(libraries) > 0)
+        self.assertEqual(l_next, int(libraries[0].get("lm"), 16))
@@ -0,0 +1,188 @@
+from __future__ import print_function
+
+import time
+
+import gdbremote_testcase
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class TestGdbRemoteNonStop(gdbremote_testcase.GdbRemoteTestCaseBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    THREAD_COUNT = 3
+
+    def start_threads_and_enable_non_stop(self, code_address_of=None):
+        inferior_args = ["thread:new"] * (self.THREAD_COUNT - 1)
+        inferior_args.append("sleep:30")
+        if code_address_of:
+            inferior_args.insert(
+                0, "get-code-address-hex:{}".format(code_address_of))
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=inferior_args)
+
+        # Let the threads start in all-stop mode, then stop them all.
+        self.test_sequence.add_log_lines(["read packet: $c#63"], True)
+        if code_address_of:
+            self.test_sequence.add_log_lines(
+                [{"type": "output_match",
+                  "regex": self.maybe_strict_output_regex(
+                      r"code address: 0x([0-9a-fA-F]+)\r\n"),
+                  "capture": {1: "code_address"}}],
+                True)
+        context = self.expect_gdbremote_sequence()
+        self.code_address = None
+        if code_address_of:
+            self.code_address = int(context.get("code_address"), 16)
+        time.sleep(1)
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: {}".format(chr(3)),
+             {"direction": "send",
+              "regex": r"^\$T([0-9a-fA-F]{2})([^#]*)#[0-9a-fA-F]{2}$"}],
+            True)
+        self.expect_gdbremote_sequence()
+
+        threads = self.wait_for_thread_count(self.THREAD_COUNT)
+        self.assertEqual(len(threads), self.THREAD_COUNT)
+
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $QNonStop:1#8d",
+             "send packet: $OK#00",
+             "read packet: $c#63",
+             "send packet: $OK#00"],
+            True)
+        self.expect_gdbremote_sequence()
+        return procs, threads
+
+    def expect_stop_notification(self):
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            [{"direction": "send",
+              "regex": r"^%Stop:T[0-9a-fA-F]{2}thread:([0-9a-fA-F]+);",
+              "capture": {1: "tid"}}],
+            True)
+        context = self.expect_gdbremote_sequence()
+        return int(context.get("tid"), 16)
+
+    def get_stopped_threads(self):
+        # '?' reports the first stopped thread, vStopped the rest.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $?#3f",
+             {"direction": "send",
+              "regex": r"^\$T[0-9a-fA-F]{2}thread:([0-9a-fA-F]+);",
+              "capture": {1: "tid"}}],
+            True)
+        context = self.expect_gdbremote_sequence()
+        stopped = [int(context.get("tid"), 16)]
+        while True:
+            self.reset_test_sequence()
+            self.test_sequence.add_log_lines(
+                ["read packet: $vStopped#55",
+                 {"direction": "send",
+                  "regex": r"^\$(OK|T[0-9a-fA-F]{2}thread:([0-9a-fA-F]+);)",
+                  "capture": {1: "reply", 2: "tid"}}],
+                True)
+            context = self.expect_gdbremote_sequence()
+            if context.get("reply") == "OK":
+                return stopped
+            stopped.append(int(context.get("tid"), 16))
+
+    def stop_one_thread(self):
+        procs, threads = self.start_threads_and_enable_non_stop()
+
+        # Stop a single thread. Only that thread reports a stop.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $vCont;t:{:x}#00".format(threads[1]),
+             "send packet: $OK#00"],
+            True)
+        self.expect_gdbremote_sequence()
+        self.assertEqual(self.expect_stop_notification(), threads[1])
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $vStopped#55",
+             "send packet: $OK#00"],
+            True)
+        self.expect_gdbremote_sequence()
+
+        # The other threads are still running.
+        self.assertEqual(self.get_stopped_threads(), [threads[1]])
+
+        # Interrupting stops the rest, one notification at a time.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: {}".format(chr(3))], True)
+        self.expect_gdbremote_sequence()
+        self.expect_stop_notification()
+        time.sleep(1)
+        self.assertEqual(sorted(self.get_stopped_threads()), sorted(threads))
+
+    @llgs_test
+    @skipUnlessPlatform(["linux"])
+    def test_stop_one_thread_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        self.stop_one_thread()
+
+    def set_breakpoint_while_main_thread_runs(self):
+        procs, threads = self.start_threads_and_enable_non_stop(
+            code_address_of="hello")
+        self.reset_test_sequence()
+        self.add_process_info_collection_packets()
+        context = self.expect_gdbremote_sequence()
+        pid = int(self.parse_process_info_response(context)["pid"], 16)
+        self.assertIn(pid, threads)
+
+        # Stop a thread other than the main one, which keeps sleeping.
+        tid = [thread for thread in threads if thread != pid][0]
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $vCont;t:{:x}#00".format(tid),
+             "send packet: $OK#00"],
+            True)
+        self.expect_gdbremote_sequence()
+        self.assertEqual(self.expect_stop_notification(), tid)
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $vStopped#55",
+             "send packet: $OK#00"],
+            True)
+        self.expect_gdbremote_sequence()
+        self.assertEqual(self.get_stopped_threads(), [tid])
+
+        # Memory is written through the stopped thread, since the main
+        # thread can't be traced while it runs.
+        self.reset_test_sequence()
+        self.add_set_breakpoint_packets(self.code_address, do_continue=False)
+        self.test_sequence.add_log_lines(
+            ["read packet: $m{0:x},1#00".format(self.code_address),
+             {"direction": "send",
+              "regex": r"^\$([0-9a-fA-F]{2})#[0-9a-fA-F]{2}$",
+              "capture": {1: "byte"}}],
+            True)
+        self.add_remove_breakpoint_packets(self.code_address)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        # Reads hide the breakpoint's trap opcode.
+        original = context.get("byte")
+
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $m{0:x},1#00".format(self.code_address),
+             "send packet: ${}#00".format(original)],
+            True)
+        self.expect_gdbremote_sequence()
+
+    @llgs_test
+    @skipUnlessPlatform(["linux"])
+    def test_set_breakpoint_while_main_thread_runs_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        self.set_breakpoint_while_main_thread_runs()
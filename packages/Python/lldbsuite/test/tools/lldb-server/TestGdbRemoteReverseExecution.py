@@ -0,0 +1,87 @@
+from __future__ import print_function
+
+
+import gdbremote_testcase
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class TestGdbRemoteReverseExecution(gdbremote_testcase.GdbRemoteTestCaseBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    def stop_reply_for(self, packet, pc_index):
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: ${}#00".format(packet),
+             {"direction": "send",
+              "regex": r"^\$T([0-9a-fA-F]{2})([^#]+)#[0-9a-fA-F]{2}$",
+              "capture": {1: "stop_signo", 2: "key_vals_text"}}],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        key_vals_text = context.get("key_vals_text")
+        key_vals = self.parse_key_val_dict(key_vals_text)
+        registers = self.extract_registers_from_stop_notification(
+            key_vals_text)
+        self.assertTrue(pc_index in registers)
+        return (key_vals, registers[pc_index])
+
+    def run_backward_through_steps(self):
+        procs = self.prep_debug_monitor_and_inferior(inferior_args=["sleep:1"])
+        self.add_qSupported_packets()
+        self.test_sequence.add_log_lines(
+            ["read packet: $QRecordHistory:1#00",
+             {"direction": "send",
+              "regex": r"^\$(OK|E[0-9a-fA-F]{2}.*)#[0-9a-fA-F]{2}$",
+              "capture": {1: "record_result"}}],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        # Kernels without soft-dirty page bits can't record the history.
+        if context.get("record_result") != "OK":
+            self.skipTest("the execution history can't be recorded")
+
+        supported_dict = self.parse_qSupported_response(context)
+        self.assertEqual(supported_dict.get("ReverseStep"), "+")
+        self.assertEqual(supported_dict.get("ReverseContinue"), "+")
+
+        reg_infos = self.gather_register_infos()
+        pc_reg_info = self.find_generic_register_with_name(reg_infos, "pc")
+        self.assertIsNotNone(pc_reg_info)
+        pc_index = pc_reg_info["lldb_register_index"]
+
+        # Record a few steps from the launch stop.
+        (key_vals, pc) = self.stop_reply_for("?", pc_index)
+        pcs = [pc]
+        for _ in range(3):
+            (key_vals, pc) = self.stop_reply_for("s", pc_index)
+            pcs.append(pc)
+
+        # Stepping back retraces them.
+        for expected_pc in reversed(pcs[1:-1]):
+            (key_vals, pc) = self.stop_reply_for("bs", pc_index)
+            self.assertEqual(pc, expected_pc)
+            self.assertFalse("replaylog" in key_vals)
+
+        # There is no breakpoint to stop at, so running backward goes to the
+        # start of the history.
+        (key_vals, pc) = self.stop_reply_for("bc", pc_index)
+        self.assertEqual(pc, pcs[0])
+        self.assertEqual(key_vals.get("reason"), "history boundary")
+        self.assertEqual(key_vals.get("replaylog"), "begin")
+
+        # The process runs forward from there again.
+        (key_vals, pc) = self.stop_reply_for("s", pc_index)
+        self.assertEqual(pc, pcs[1])
+
+    @llgs_test
+    @skipUnlessPlatform(["linux"])
+    @skipIf(archs=no_match(["i386", "x86_64"]))
+    def test_run_backward_through_steps_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        self.run_backward_through_steps()
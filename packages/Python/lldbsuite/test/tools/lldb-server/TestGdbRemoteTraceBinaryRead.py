@@ -0,0 +1,108 @@
+from __future__ import print_function
+
+import gdbremote_testcase
+import lldbgdbserverutils
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class TestGdbRemoteTraceBinaryRead(gdbremote_testcase.GdbRemoteTestCaseBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    FEATURE_NAME = "jTraceBinaryRead"
+
+    TRACE_BUFFER_SIZE = 4096
+
+    def start_trace(self):
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=["message:main entered", "sleep:5"])
+        self.add_qSupported_packets()
+        self.add_process_info_collection_packets()
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        features = self.parse_qSupported_response(context)
+        if features.get(self.FEATURE_NAME) != "+":
+            self.skipTest("binary trace reads not supported")
+
+        # The main thread's id is the process id.
+        process_info = self.parse_process_info_response(context)
+        self.assertIsNotNone(process_info)
+        tid = int(process_info["pid"], 16)
+
+        # Trace the main thread up to main, then leave the process stopped.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines([
+            "read packet: $jTraceStart:{{\"type\":1,\"buffersize\":{0},"
+            "\"threadid\":{1},\"metabuffersize\":0}}#00".format(
+                self.TRACE_BUFFER_SIZE, tid),
+            {"direction": "send",
+             "regex": r"^\$(E?[0-9a-fA-F]+)(;.*)?#[0-9a-fA-F]{2}$",
+             "capture": {1: "trace_id"}},
+        ], True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        trace_id = context.get("trace_id")
+        if trace_id.startswith("E"):
+            self.skipTest("processor trace not available")
+
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines([
+            "read packet: $c#63",
+            {"type": "output_match", "regex": self.maybe_strict_output_regex(
+                r"message:main entered\r\n")},
+        ], True)
+        self.add_interrupt_packets()
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        return (int(trace_id, 16), tid)
+
+    def read_trace_buffer(self, trace_id, tid, binary):
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines([
+            "read packet: $jTraceBufferRead:{{{0}\"traceid\":{1},"
+            "\"threadid\":{2},\"offset\":0,\"buffersize\":{3}}}#00".format(
+                "\"binary\":true," if binary else "", trace_id, tid,
+                self.TRACE_BUFFER_SIZE),
+            {"direction": "send",
+             "regex": re.compile(r"^\$([^E].*)#[0-9a-fA-F]{2}$",
+                                 re.MULTILINE | re.DOTALL),
+             "capture": {1: "content_raw"}},
+        ], True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        content_raw = context.get("content_raw")
+        self.assertIsNotNone(content_raw)
+        return content_raw
+
+    @llgs_test
+    def test_binary_read_matches_hex_read_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        (trace_id, tid) = self.start_trace()
+
+        hex_data = lldbgdbserverutils.gdbremote_hex_decode_string(
+            self.read_trace_buffer(trace_id, tid, False))
+        self.assertTrue(len(hex_data) > 0)
+
+        binary_reply = self.read_trace_buffer(trace_id, tid, True)
+        self.assertEqual(binary_reply[0], "b")
+        binary_reply = binary_reply[1:]
+
+        # '#', '$', '}' and '*' only appear escaped: the stub doesn't use run
+        # length encoding, and an unescaped '#' would end the packet early.
+        self.assertNotIn("$", binary_reply)
+        self.assertNotIn("*", binary_reply)
+        i = 0
+        while i < len(binary_reply):
+            if binary_reply[i] == "}":
+                self.assertTrue(i + 1 < len(binary_reply))
+                self.assertIn(chr(ord(binary_reply[i + 1]) ^ 0x20), "#$}*")
+                i += 1
+            i += 1
+
+        # Both forms carry the same bytes, with the escaping undone.
+        self.assertEqual(self.decode_gdbremote_binary(binary_reply), hex_data)
@@ -1,6 +1,7 @@
 from __future__ import print_function
 
 import gdbremote_testcase
+import lldbgdbserverutils
 from lldbsuite.test.decorators import *
 from lldbsuite.test.lldbtest import *
 from lldbsuite.test import lldbutil
@@ -39,6 +40,106 @@ class TestGdbRemote_vCont(gdbremote_testcase.GdbRemoteTestCaseBase):
     def vCont_supports_S(self):
         self.vCont_supports_mode("S")
 
+    def vCont_supports_r(self):
+        self.vCont_supports_mode("r")
+
+    def range_step_runs_to_end_of_range(self):
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=[
+                "get-code-address-hex:swap_chars",
+                "get-data-address-hex:g_c1",
+                "get-data-address-hex:g_c2",
+                "sleep:1",
+                "call-function:swap_chars",
+                "sleep:5"])
+        self.add_qSupported_packets()
+        self.add_process_info_collection_packets()
+        self.test_sequence.add_log_lines(
+            ["read packet: $c#63",
+             {"type": "output_match", "regex": r"^code address: 0x([0-9a-fA-F]+)\r\ndata address: 0x([0-9a-fA-F]+)\r\ndata address: 0x([0-9a-fA-F]+)\r\n$",
+              "capture": {1: "function_address", 2: "g_c1_address",
+                          3: "g_c2_address"}},
+             "read packet: {}".format(chr(3)),
+             {"direction": "send", "regex": r"^\$T([0-9a-fA-F]{2})thread:([0-9a-fA-F]+);", "capture": {1: "stop_signo", 2: "stop_thread_id"}}],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        supported_dict = self.parse_qSupported_response(context)
+        self.assertEqual(supported_dict.get("BreakpointStepOver"), "+")
+        endian = self.parse_process_info_response(context).get("endian")
+        self.assertIsNotNone(endian)
+        thread_id = int(context.get("stop_thread_id"), 16)
+        function_address = int(context.get("function_address"), 16)
+        args = {}
+        args["g_c1_address"] = int(context.get("g_c1_address"), 16)
+        args["g_c2_address"] = int(context.get("g_c2_address"), 16)
+
+        # Step from the entry of swap_chars to the line that undoes its first
+        # swap. The line table gives where that line starts, relative to the
+        # function.
+        target = self.dbg.CreateTarget(self.getBuildArtifact("a.out"))
+        self.assertTrue(target.IsValid())
+        functions = target.FindFunctions("swap_chars")
+        self.assertEqual(functions.GetSize(), 1)
+        context = functions.GetContextAtIndex(0)
+        function = context.GetFunction()
+        self.assertTrue(function.IsValid())
+        function_start = function.GetStartAddress().GetFileAddress()
+        function_end = function.GetEndAddress().GetFileAddress()
+        stop_line = line_number(
+            self.getSourcePath("main.cpp"), "// Second swap")
+        compile_unit = context.GetCompileUnit()
+        stop_addresses = []
+        for i in range(compile_unit.GetNumLineEntries()):
+            line_entry = compile_unit.GetLineEntryAtIndex(i)
+            address = line_entry.GetStartAddress().GetFileAddress()
+            if line_entry.GetLine() == stop_line and \
+                    function_start <= address < function_end:
+                stop_addresses.append(address)
+        self.assertTrue(len(stop_addresses) > 0)
+        range_end = function_address + min(stop_addresses) - function_start
+        self.assertTrue(function_address < range_end)
+
+        reg_infos = self.gather_register_infos()
+        pc_reg_info = self.find_generic_register_with_name(reg_infos, "pc")
+        self.assertIsNotNone(pc_reg_info)
+        pc_index = pc_reg_info["lldb_register_index"]
+
+        # Stop at the entry of the function, and leave the breakpoint there:
+        # the stub steps over it.
+        self.reset_test_sequence()
+        self.add_set_breakpoint_packets(function_address, do_continue=True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        # Step through the range with a single packet.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $vCont;r{0:x},{1:x}:{2:x}#00".format(
+                function_address, range_end, thread_id),
+             {"direction": "send",
+              "regex": r"^\$T([0-9a-fA-F]{2})([^#]+)#[0-9a-fA-F]{2}$",
+              "capture": {1: "stop_signo", 2: "key_vals_text"}}],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        key_vals_text = context.get("key_vals_text")
+        key_vals = self.parse_key_val_dict(key_vals_text)
+        self.assertEqual(key_vals.get("reason"), "trace")
+        registers = self.extract_registers_from_stop_notification(
+            key_vals_text)
+        self.assertTrue(pc_index in registers)
+        pc = lldbgdbserverutils.unpack_register_hex_unsigned(
+            endian, registers[pc_index])
+        self.assertEqual(pc, range_end)
+
+        # The first swap ran, and the second one didn't.
+        args["expected_g_c1"] = "1"
+        args["expected_g_c2"] = "0"
+        self.assertTrue(self.g_c1_c2_contents_are(args))
+
     @expectedFailureAll(oslist=["ios", "tvos", "watchos", "bridgeos"], bugnumber="rdar://27005337")
     @debugserver_test
     def test_vCont_supports_c_debugserver(self):
@@ -157,3 +258,18 @@ class TestGdbRemote_vCont(gdbremote_testcase.GdbRemoteTestCaseBase):
         self.set_inferior_startup_launch()
         self.single_step_only_steps_one_instruction(
             use_Hc_packet=False, step_instruction="vCont;s:{thread}")
+
+    @llgs_test
+    def test_vCont_supports_r_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.vCont_supports_r()
+
+    @llgs_test
+    @skipUnlessPlatform(["linux"])
+    @skipIf(archs=no_match(["i386", "x86_64"]))
+    def test_range_step_runs_to_end_of_range_llgs(self):
+        self.init_llgs_test()
+        self.build()
+        self.set_inferior_startup_launch()
+        self.range_step_runs_to_end_of_range()
@@ -935,7 +935,14 @@ class GdbRemoteTestCaseBase(TestBase):
         "qXfer:libraries-svr4:read",
         "qXfer:features:read",
         "qEcho",
-        "QPassSignals"
+        "QPassSignals",
+        "QNonStop",
+        "jTraceBinaryRead",
+        "SupportedCompressions",
+        "ReverseStep",
+        "ReverseContinue",
+        "BreakpointStepOver",
+        "SharedMemoryTransport"
     ]
 
     def parse_qSupported_response(self, context):
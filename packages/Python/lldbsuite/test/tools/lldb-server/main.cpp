@@ -143,7 +143,7 @@ static void swap_chars() {
   g_c1 = '1';
   g_c2 = '0';
 
-  g_c1 = '0';
+  g_c1 = '0'; // Second swap
   g_c2 = '1';
 }
 
@@ -68,7 +68,7 @@ class SocketPacketPump(object):
     content into the two queues.
     """
 
-    _GDB_REMOTE_PACKET_REGEX = re.compile(r'^\$([^\#]*)#[0-9a-fA-F]{2}')
+    _GDB_REMOTE_PACKET_REGEX = re.compile(r'^[\$%]([^\#]*)#[0-9a-fA-F]{2}')
 
     def __init__(self, pump_socket, pump_queues, logger=None):
         if not pump_socket:
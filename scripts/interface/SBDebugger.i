@@ -280,6 +280,14 @@ public:
     lldb::SBStructuredData
     GetAvailablePlatformInfoAtIndex (uint32_t idx);
 
+    %feature("docstring", "
+    Get the number of bytes used by the string pool, by each module and by
+    the processes of this debugger's targets, the same numbers as the
+    'statistics memory' command reports.
+    ") GetMemoryStatistics;
+    lldb::SBStructuredData
+    GetMemoryStatistics ();
+
     lldb::SBSourceManager
     GetSourceManager ();
 
@@ -227,6 +227,14 @@ public:
     lldb::SBError
     Continue ();
 
+    %feature("docstring", "
+    Resumes the process, backward if direction is eRunReverse. Running
+    backward goes to the previous breakpoint or watchpoint hit, or to the
+    start of the execution history, which the process must be recording.
+    ") ContinueInDirection;
+    lldb::SBError
+    ContinueInDirection (lldb::RunDirection direction);
+
     lldb::SBError
     Stop ();
 
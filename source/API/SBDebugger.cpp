@@ -884,6 +884,13 @@ SBStructuredData SBDebugger::GetAvailablePlatformInfoAtIndex(uint32_t idx) {
   return data;
 }
 
+SBStructuredData SBDebugger::GetMemoryStatistics() {
+  SBStructuredData data;
+  if (m_opaque_sp)
+    data.m_impl_up->SetObjectSP(m_opaque_sp->GetMemoryStatistics());
+  return data;
+}
+
 void SBDebugger::DispatchInput(void *baton, const void *data, size_t data_len) {
   DispatchInput(data, data_len);
 }
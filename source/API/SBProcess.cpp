@@ -660,20 +660,24 @@ uint32_t SBProcess::GetAddressByteSize() const {
   return size;
 }
 
-SBError SBProcess::Continue() {
+SBError SBProcess::Continue() { return ContinueInDirection(eRunForward); }
+
+SBError SBProcess::ContinueInDirection(RunDirection direction) {
   Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_API));
 
   SBError sb_error;
   ProcessSP process_sp(GetSP());
 
   if (log)
-    log->Printf("SBProcess(%p)::Continue ()...",
-                static_cast<void *>(process_sp.get()));
+    log->Printf("SBProcess(%p)::Continue (%s)...",
+                static_cast<void *>(process_sp.get()),
+                direction == eRunReverse ? "reverse" : "forward");
 
   if (process_sp) {
     std::lock_guard<std::recursive_mutex> guard(
         process_sp->GetTarget().GetAPIMutex());
 
+    process_sp->SetBaseDirection(direction);
     if (process_sp->GetTarget().GetDebugger().GetAsyncExecution())
       sb_error.ref() = process_sp->Resume();
     else
@@ -32,6 +32,8 @@
 #include "lldb/Utility/RegularExpression.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/Timer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace lldb;
 using namespace lldb_private;
@@ -48,6 +50,7 @@ static OptionDefinition g_log_options[] = {
   { LLDB_OPT_SET_1, false, "stack",      'S', OptionParser::eNoArgument,       nullptr, nullptr, 0, eArgTypeNone,     "Append a stack backtrace to each log line." },
   { LLDB_OPT_SET_1, false, "append",     'a', OptionParser::eNoArgument,       nullptr, nullptr, 0, eArgTypeNone,     "Append to the log file instead of overwriting." },
   { LLDB_OPT_SET_1, false, "file-function",'F',OptionParser::eNoArgument,      nullptr, nullptr, 0, eArgTypeNone,     "Prepend the names of files and function that generate the logs." },
+  { LLDB_OPT_SET_1, false, "async",      'A', OptionParser::eNoArgument,       nullptr, nullptr, 0, eArgTypeNone,     "Write log messages from a background thread instead of the thread that logs them. Messages may be dropped if they are logged faster than they can be written." },
     // clang-format on
 };
 
@@ -130,6 +133,9 @@ public:
       case 'F':
         log_options |= LLDB_LOG_OPTION_PREPEND_FILE_FUNCTION;
         break;
+      case 'A':
+        log_options |= LLDB_LOG_OPTION_ASYNC;
+        break;
       default:
         error.SetErrorStringWithFormat("unrecognized option '%c'",
                                        short_option);
@@ -305,8 +311,9 @@ public:
       : CommandObjectParsed(interpreter, "log timers",
                             "Enable, disable, dump, and reset LLDB internal "
                             "performance timers.",
-                            "log timers < enable <depth> | disable | dump | "
-                            "increment <bool> | reset >") {}
+                            "log timers < enable <depth> | disable | "
+                            "dump [--trace <file>] | increment <bool> | "
+                            "trace <bool> | reset >") {}
 
   ~CommandObjectLogTimer() override = default;
 
@@ -329,6 +336,7 @@ protected:
         result.SetStatus(eReturnStatusSuccessFinishResult);
       } else if (sub_command.equals_lower("reset")) {
         Timer::ResetCategoryTimes();
+        Timer::ResetTrace();
         result.SetStatus(eReturnStatusSuccessFinishResult);
       }
     } else if (args.GetArgumentCount() == 2) {
@@ -352,6 +360,33 @@ protected:
           result.SetStatus(eReturnStatusSuccessFinishNoResult);
         } else
           result.AppendError("Could not convert increment value to boolean.");
+      } else if (sub_command.equals_lower("trace")) {
+        bool success;
+        bool trace = OptionArgParser::ToBoolean(param, false, &success);
+        if (success) {
+          Timer::SetTracing(trace);
+          result.SetStatus(eReturnStatusSuccessFinishNoResult);
+        } else
+          result.AppendError("Could not convert trace value to boolean.");
+      }
+    } else if (args.GetArgumentCount() == 3) {
+      auto sub_command = args[0].ref;
+      auto option = args[1].ref;
+
+      if (sub_command.equals_lower("dump") && option == "--trace") {
+        FileSpec file(args[2].ref, true);
+        std::error_code ec;
+        llvm::raw_fd_ostream os(file.GetPath(), ec, llvm::sys::fs::F_Text);
+        if (ec) {
+          result.AppendErrorWithFormat("Could not open '%s': %s.\n",
+                                       file.GetPath().c_str(),
+                                       ec.message().c_str());
+          return false;
+        }
+        Timer::DumpTrace(os);
+        result.AppendMessageWithFormat("Wrote trace to '%s'.\n",
+                                       file.GetPath().c_str());
+        result.SetStatus(eReturnStatusSuccessFinishResult);
       }
     }
 
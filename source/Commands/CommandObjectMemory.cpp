@@ -13,6 +13,7 @@
 // C++ Includes
 // Other libraries and framework includes
 #include "clang/AST/Decl.h"
+#include "llvm/ADT/StringExtras.h"
 
 // Project includes
 #include "CommandObjectMemory.h"
@@ -35,12 +36,15 @@
 #include "lldb/Symbol/ClangASTContext.h"
 #include "lldb/Symbol/SymbolFile.h"
 #include "lldb/Symbol/TypeList.h"
+#include "lldb/Target/HeapSnapshot.h"
+#include "lldb/Target/MemoryChunkReader.h"
 #include "lldb/Target/MemoryHistory.h"
 #include "lldb/Target/MemoryRegionInfo.h"
 #include "lldb/Target/Process.h"
 #include "lldb/Target/StackFrame.h"
 #include "lldb/Target/Thread.h"
 #include "lldb/Utility/Args.h"
+#include "lldb/Utility/BytePatternMatcher.h"
 #include "lldb/Utility/DataBufferHeap.h"
 #include "lldb/Utility/DataBufferLLVM.h"
 #include "lldb/Utility/StreamString.h"
@@ -643,6 +647,22 @@ protected:
       return false;
     }
 
+    // Binary dumps to a file don't need the whole range in memory at once,
+    // so stream them straight to disk.
+    ProcessSP process_sp = m_exe_ctx.GetProcessSP();
+    if (m_memory_options.m_output_as_binary &&
+        m_outfile_options.GetFile().GetCurrentValue() &&
+        !clang_ast_type.GetOpaqueQualType() &&
+        m_format_options.GetFormatValue().GetCurrentValue() != eFormatCString &&
+        process_sp && process_sp->IsAlive()) {
+      m_prev_format_options = m_format_options;
+      m_prev_memory_options = m_memory_options;
+      m_prev_outfile_options = m_outfile_options;
+      m_prev_varobj_options = m_varobj_options;
+      m_prev_clang_ast_type = clang_ast_type;
+      return WriteMemoryToFile(process_sp, addr, total_byte_size, result);
+    }
+
     DataBufferSP data_sp;
     size_t bytes_read = 0;
     if (clang_ast_type.GetOpaqueQualType()) {
@@ -870,6 +890,77 @@ protected:
     return true;
   }
 
+  // Write |size| bytes of memory starting at |addr| to the output file. The
+  // range is read in chunks and each chunk is written out as soon as it
+  // arrives, so only a couple of chunks are ever held in memory.
+  bool WriteMemoryToFile(const ProcessSP &process_sp, lldb::addr_t addr,
+                         size_t size, CommandReturnObject &result) {
+    char path[PATH_MAX];
+    m_outfile_options.GetFile().GetCurrentValue().GetPath(path, sizeof(path));
+
+    uint32_t open_options = File::eOpenOptionWrite | File::eOpenOptionCanCreate;
+    const bool append = m_outfile_options.GetAppend().GetCurrentValue();
+    if (append)
+      open_options |= File::eOpenOptionAppend;
+
+    StreamFile outfile_stream;
+    if (outfile_stream.GetFile().Open(path, open_options).Fail()) {
+      result.AppendErrorWithFormat("Failed to open file '%s' for %s.\n", path,
+                                   append ? "append" : "write");
+      result.SetStatus(eReturnStatusFailed);
+      return false;
+    }
+
+    MemoryChunkReader reader(process_sp, addr, addr + size);
+    lldb::addr_t chunk_addr, fresh_addr;
+    llvm::ArrayRef<uint8_t> chunk;
+    uint64_t bytes_written = 0;
+    bool write_failed = false;
+    while (reader.ReadNextChunk(chunk_addr, chunk, fresh_addr)) {
+      // Stop at the first hole so the file stays a contiguous image of the
+      // memory starting at |addr|.
+      if (chunk_addr != addr + bytes_written)
+        break;
+      const size_t written = outfile_stream.Write(chunk.data(), chunk.size());
+      bytes_written += written;
+      if (written != chunk.size()) {
+        write_failed = true;
+        break;
+      }
+      if (m_interpreter.WasInterrupted())
+        break;
+    }
+
+    m_next_addr = addr + bytes_written;
+    m_prev_byte_size = bytes_written;
+
+    if (write_failed) {
+      result.AppendErrorWithFormat("Failed to write %" PRIu64
+                                   " bytes to '%s'.\n",
+                                   (uint64_t)size, path);
+      result.SetStatus(eReturnStatusFailed);
+      return false;
+    }
+    if (bytes_written == 0) {
+      result.AppendErrorWithFormat("failed to read memory from 0x%" PRIx64
+                                   ".\n",
+                                   addr);
+      result.SetStatus(eReturnStatusFailed);
+      return false;
+    }
+    if (bytes_written < size)
+      result.AppendWarningWithFormat(
+          "Not all bytes (%" PRIu64 "/%" PRIu64
+          ") were able to be read from 0x%" PRIx64 ".\n",
+          bytes_written, (uint64_t)size, addr);
+
+    result.GetOutputStream().Printf("%" PRIu64 " bytes %s to '%s'\n",
+                                    bytes_written,
+                                    append ? "appended" : "written", path);
+    result.SetStatus(eReturnStatusSuccessFinishResult);
+    return true;
+  }
+
   OptionGroupOptions m_option_group;
   OptionGroupFormat m_format_options;
   OptionGroupReadMemory m_memory_options;
@@ -887,8 +978,11 @@ protected:
 OptionDefinition g_memory_find_option_table[] = {
     // clang-format off
   {LLDB_OPT_SET_1,   true,  "expression",  'e', OptionParser::eRequiredArgument, nullptr, nullptr, 0, eArgTypeExpression, "Evaluate an expression to obtain a byte pattern."},
-  {LLDB_OPT_SET_2,   true,  "string",      's', OptionParser::eRequiredArgument, nullptr, nullptr, 0, eArgTypeName,       "Use text to find a byte pattern."},
+  {LLDB_OPT_SET_2,   true,  "string",      's', OptionParser::eRequiredArgument, nullptr, nullptr, 0, eArgTypeName,       "Use text to find a byte pattern. Can be specified more than once to look for several patterns in a single pass."},
   {LLDB_OPT_SET_ALL, false, "count",       'c', OptionParser::eRequiredArgument, nullptr, nullptr, 0, eArgTypeCount,      "How many times to perform the search."},
+  {LLDB_OPT_SET_ALL, false, "all",         'A', OptionParser::eNoArgument,       nullptr, nullptr, 0, eArgTypeNone,       "Report every match within the range instead of stopping after --count matches."},
+  {LLDB_OPT_SET_ALL, false, "mask",        'm', OptionParser::eRequiredArgument, nullptr, nullptr, 0, eArgTypeValue,      "A string of hex bytes (e.g. ff00ffff) that memory is masked with before it is compared. Must be as long as the pattern."},
+  {LLDB_OPT_SET_ALL, false, "alignment",   'a', OptionParser::eRequiredArgument, nullptr, nullptr, 0, eArgTypeByteSize,   "Only report matches at addresses that are a multiple of this value."},
   {LLDB_OPT_SET_ALL, false, "dump-offset", 'o', OptionParser::eRequiredArgument, nullptr, nullptr, 0, eArgTypeOffset,     "When dumping memory for a match, an offset from the match location to start dumping from."},
     // clang-format on
 };
@@ -900,7 +994,9 @@ class CommandObjectMemoryFind : public CommandObjectParsed {
 public:
   class OptionGroupFindMemory : public OptionGroup {
   public:
-    OptionGroupFindMemory() : OptionGroup(), m_count(1), m_offset(0) {}
+    OptionGroupFindMemory()
+        : OptionGroup(), m_count(1), m_offset(0), m_alignment(1),
+          m_find_all(false) {}
 
     ~OptionGroupFindMemory() override = default;
 
@@ -920,7 +1016,7 @@ public:
         break;
 
       case 's':
-        m_string.SetValueFromString(option_value);
+        m_strings.push_back(option_value);
         break;
 
       case 'c':
@@ -928,6 +1024,20 @@ public:
           error.SetErrorString("unrecognized value for count");
         break;
 
+      case 'A':
+        m_find_all = true;
+        break;
+
+      case 'm':
+        m_mask.SetValueFromString(option_value);
+        break;
+
+      case 'a':
+        if (m_alignment.SetValueFromString(option_value).Fail() ||
+            m_alignment.GetCurrentValue() == 0)
+          error.SetErrorString("unrecognized value for alignment");
+        break;
+
       case 'o':
         if (m_offset.SetValueFromString(option_value).Fail())
           error.SetErrorString("unrecognized value for dump-offset");
@@ -943,14 +1053,21 @@ public:
 
     void OptionParsingStarting(ExecutionContext *execution_context) override {
       m_expr.Clear();
-      m_string.Clear();
+      m_strings.clear();
       m_count.Clear();
+      m_offset.Clear();
+      m_mask.Clear();
+      m_alignment.Clear();
+      m_find_all = false;
     }
 
     OptionValueString m_expr;
-    OptionValueString m_string;
+    std::vector<std::string> m_strings;
     OptionValueUInt64 m_count;
     OptionValueUInt64 m_offset;
+    OptionValueString m_mask;
+    OptionValueUInt64 m_alignment;
+    bool m_find_all;
   };
 
   CommandObjectMemoryFind(CommandInterpreter &interpreter)
@@ -993,35 +1110,6 @@ public:
   Options *GetOptions() override { return &m_option_group; }
 
 protected:
-  class ProcessMemoryIterator {
-  public:
-    ProcessMemoryIterator(ProcessSP process_sp, lldb::addr_t base)
-        : m_process_sp(process_sp), m_base_addr(base), m_is_valid(true) {
-      lldbassert(process_sp.get() != nullptr);
-    }
-
-    bool IsValid() { return m_is_valid; }
-
-    uint8_t operator[](lldb::addr_t offset) {
-      if (!IsValid())
-        return 0;
-
-      uint8_t retval = 0;
-      Status error;
-      if (0 ==
-          m_process_sp->ReadMemory(m_base_addr + offset, &retval, 1, error)) {
-        m_is_valid = false;
-        return 0;
-      }
-
-      return retval;
-    }
-
-  private:
-    ProcessSP m_process_sp;
-    lldb::addr_t m_base_addr;
-    bool m_is_valid;
-  };
   bool DoExecute(Args &command, CommandReturnObject &result) override {
     // No need to check "process" for validity as eCommandRequiresProcess
     // ensures it is valid
@@ -1054,13 +1142,20 @@ protected:
       return false;
     }
 
-    lldb::addr_t found_location = LLDB_INVALID_ADDRESS;
-
-    DataBufferHeap buffer;
+    std::vector<DataBufferHeap> patterns;
 
-    if (m_memory_options.m_string.OptionWasSet())
-      buffer.CopyData(m_memory_options.m_string.GetStringValue());
-    else if (m_memory_options.m_expr.OptionWasSet()) {
+    if (!m_memory_options.m_strings.empty()) {
+      for (const std::string &str : m_memory_options.m_strings) {
+        if (str.empty()) {
+          result.AppendError("cannot search for an empty string");
+          return false;
+        }
+        patterns.emplace_back();
+        patterns.back().CopyData(str);
+      }
+    } else if (m_memory_options.m_expr.OptionWasSet()) {
+      patterns.emplace_back();
+      DataBufferHeap &buffer = patterns.back();
       StackFrame *frame = m_exe_ctx.GetFramePtr();
       ValueObjectSP result_sp;
       if ((eExpressionCompleted ==
@@ -1106,73 +1201,115 @@ protected:
       return false;
     }
 
-    size_t count = m_memory_options.m_count.GetCurrentValue();
-    found_location = low_addr;
+    std::vector<uint8_t> mask;
+    if (m_memory_options.m_mask.OptionWasSet() &&
+        !ParseHexBytes(m_memory_options.m_mask.GetStringValue(), mask)) {
+      result.AppendErrorWithFormat("invalid mask '%s', expected a string of "
+                                   "hex bytes",
+                                   m_memory_options.m_mask.GetCurrentValue());
+      return false;
+    }
+
+    BytePatternMatcher matcher;
+    matcher.SetAlignment(m_memory_options.m_alignment.GetCurrentValue());
+    for (const DataBufferHeap &pattern : patterns) {
+      llvm::ArrayRef<uint8_t> bytes(pattern.GetBytes(), pattern.GetByteSize());
+      if (!matcher.AddPattern(bytes, mask)) {
+        result.AppendErrorWithFormat(
+            "the mask is %" PRIu64 " bytes long but the pattern is %" PRIu64
+            " bytes long",
+            (uint64_t)mask.size(), (uint64_t)bytes.size());
+        return false;
+      }
+    }
+
+    uint64_t count = m_memory_options.m_find_all
+                         ? UINT64_MAX
+                         : m_memory_options.m_count.GetCurrentValue();
     bool ever_found = false;
-    while (count) {
-      found_location = FastSearch(found_location, high_addr, buffer.GetBytes(),
-                                  buffer.GetByteSize());
-      if (found_location == LLDB_INVALID_ADDRESS) {
-        if (!ever_found) {
-          result.AppendMessage("data not found within the range.\n");
-          result.SetStatus(lldb::eReturnStatusSuccessFinishNoResult);
-        } else
-          result.AppendMessage("no more matches within the range.\n");
-        break;
+
+    // Stream the range through the matcher. Consecutive chunks overlap by
+    // one byte less than the longest pattern so that matches straddling a
+    // chunk boundary are seen as well.
+    MemoryChunkReader reader(m_exe_ctx.GetProcessSP(), low_addr, high_addr,
+                             MemoryChunkReader::kDefaultChunkSize,
+                             matcher.GetMaxPatternSize() - 1);
+    std::vector<BytePatternMatcher::Match> matches;
+    lldb::addr_t chunk_addr, fresh_addr;
+    llvm::ArrayRef<uint8_t> chunk;
+    bool interrupted = false;
+    while (count && !interrupted &&
+           reader.ReadNextChunk(chunk_addr, chunk, fresh_addr)) {
+      matches.clear();
+      matcher.FindMatches(chunk, chunk_addr, matches);
+      for (const BytePatternMatcher::Match &match : matches) {
+        // Matches that lie entirely within the overlap were already reported
+        // for the previous chunk.
+        if (match.addr + matcher.GetPatternSize(match.pattern_index) <=
+            fresh_addr)
+          continue;
+        DumpMatch(match.addr, result);
+        ever_found = true;
+        if (--count == 0)
+          break;
       }
-      result.AppendMessageWithFormat("data found at location: 0x%" PRIx64 "\n",
-                                     found_location);
-
-      DataBufferHeap dumpbuffer(32, 0);
-      process->ReadMemory(
-          found_location + m_memory_options.m_offset.GetCurrentValue(),
-          dumpbuffer.GetBytes(), dumpbuffer.GetByteSize(), error);
-      if (!error.Fail()) {
-        DataExtractor data(dumpbuffer.GetBytes(), dumpbuffer.GetByteSize(),
-                           process->GetByteOrder(),
-                           process->GetAddressByteSize());
-        DumpDataExtractor(
-            data, &result.GetOutputStream(), 0, lldb::eFormatBytesWithASCII, 1,
-            dumpbuffer.GetByteSize(), 16,
-            found_location + m_memory_options.m_offset.GetCurrentValue(), 0, 0);
-        result.GetOutputStream().EOL();
+      if (m_interpreter.WasInterrupted()) {
+        result.AppendMessage("search interrupted.\n");
+        interrupted = true;
       }
+    }
 
-      --count;
-      found_location++;
-      ever_found = true;
+    if (count && !interrupted) {
+      if (!ever_found)
+        result.AppendMessage("data not found within the range.\n");
+      else
+        result.AppendMessage("no more matches within the range.\n");
     }
+    if (reader.GetBytesSkipped())
+      result.AppendWarningWithFormat(
+          "%" PRIu64 " bytes within the range could not be read.\n",
+          reader.GetBytesSkipped());
 
     result.SetStatus(lldb::eReturnStatusSuccessFinishResult);
     return true;
   }
 
-  lldb::addr_t FastSearch(lldb::addr_t low, lldb::addr_t high, uint8_t *buffer,
-                          size_t buffer_size) {
-    const size_t region_size = high - low;
-
-    if (region_size < buffer_size)
-      return LLDB_INVALID_ADDRESS;
-
-    std::vector<size_t> bad_char_heuristic(256, buffer_size);
-    ProcessSP process_sp = m_exe_ctx.GetProcessSP();
-    ProcessMemoryIterator iterator(process_sp, low);
+  void DumpMatch(lldb::addr_t found_location, CommandReturnObject &result) {
+    Process *process = m_exe_ctx.GetProcessPtr();
+    result.AppendMessageWithFormat("data found at location: 0x%" PRIx64 "\n",
+                                   found_location);
 
-    for (size_t idx = 0; idx < buffer_size - 1; idx++) {
-      decltype(bad_char_heuristic)::size_type bcu_idx = buffer[idx];
-      bad_char_heuristic[bcu_idx] = buffer_size - idx - 1;
-    }
-    for (size_t s = 0; s <= (region_size - buffer_size);) {
-      int64_t j = buffer_size - 1;
-      while (j >= 0 && buffer[j] == iterator[s + j])
-        j--;
-      if (j < 0)
-        return low + s;
-      else
-        s += bad_char_heuristic[iterator[s + buffer_size - 1]];
+    const lldb::addr_t dump_addr =
+        found_location + m_memory_options.m_offset.GetCurrentValue();
+    DataBufferHeap dumpbuffer(32, 0);
+    Status error;
+    process->ReadMemory(dump_addr, dumpbuffer.GetBytes(),
+                        dumpbuffer.GetByteSize(), error);
+    if (!error.Fail()) {
+      DataExtractor data(dumpbuffer.GetBytes(), dumpbuffer.GetByteSize(),
+                         process->GetByteOrder(),
+                         process->GetAddressByteSize());
+      DumpDataExtractor(data, &result.GetOutputStream(), 0,
+                        lldb::eFormatBytesWithASCII, 1,
+                        dumpbuffer.GetByteSize(), 16, dump_addr, 0, 0);
+      result.GetOutputStream().EOL();
     }
+  }
 
-    return LLDB_INVALID_ADDRESS;
+  // Parse a string of hex digit pairs, optionally prefixed with "0x".
+  static bool ParseHexBytes(llvm::StringRef str, std::vector<uint8_t> &bytes) {
+    str.consume_front("0x");
+    if (str.empty() || str.size() % 2)
+      return false;
+    bytes.clear();
+    for (size_t i = 0; i < str.size(); i += 2) {
+      const unsigned hi = llvm::hexDigitValue(str[i]);
+      const unsigned lo = llvm::hexDigitValue(str[i + 1]);
+      if (hi == ~0U || lo == ~0U)
+        return false;
+      bytes.push_back((hi << 4) | lo);
+    }
+    return true;
   }
 
   OptionGroupOptions m_option_group;
@@ -1767,6 +1904,314 @@ protected:
   lldb::addr_t m_prev_end_addr;
 };
 
+//-------------------------------------------------------------------------
+// CommandObjectMemoryHeap
+//-------------------------------------------------------------------------
+
+static OptionDefinition g_memory_heap_report_options[] = {
+    // clang-format off
+  {LLDB_OPT_SET_1, false, "count", 'c', OptionParser::eRequiredArgument, nullptr, nullptr, 0, eArgTypeCount, "The number of types to list (0 for all of them)."},
+    // clang-format on
+};
+
+class HeapReportOptions : public Options {
+public:
+  HeapReportOptions() : Options() { OptionParsingStarting(nullptr); }
+
+  ~HeapReportOptions() override = default;
+
+  Status SetOptionValue(uint32_t option_idx, llvm::StringRef option_arg,
+                        ExecutionContext *execution_context) override {
+    Status error;
+    const int short_option = m_getopt_table[option_idx].val;
+
+    switch (short_option) {
+    case 'c':
+      if (option_arg.getAsInteger(0, m_count))
+        error.SetErrorStringWithFormat("invalid integer value for option '%c'",
+                                       short_option);
+      break;
+    default:
+      error.SetErrorStringWithFormat("invalid short option character '%c'",
+                                     short_option);
+      break;
+    }
+    return error;
+  }
+
+  void OptionParsingStarting(ExecutionContext *execution_context) override {
+    m_count = 20;
+  }
+
+  llvm::ArrayRef<OptionDefinition> GetDefinitions() override {
+    return llvm::makeArrayRef(g_memory_heap_report_options);
+  }
+
+  size_t GetCount(size_t num_entries) const {
+    return m_count ? std::min<size_t>(m_count, num_entries) : num_entries;
+  }
+
+  uint32_t m_count;
+};
+
+static const char *GetHeapTypeName(const std::string &name) {
+  return name.empty() ? "<unknown>" : name.c_str();
+}
+
+// Load the snapshot in |path|, or take one of the current process if no
+// path was given.
+static bool GetHeapSnapshot(ExecutionContext &exe_ctx, const char *path,
+                            HeapSnapshot &snapshot,
+                            CommandReturnObject &result) {
+  Status error;
+  if (path) {
+    error = HeapSnapshot::Load(FileSpec(path, true), snapshot);
+  } else {
+    Process *process = exe_ctx.GetProcessPtr();
+    if (!process || !process->IsAlive()) {
+      result.AppendError("no snapshot file given and no process to snapshot");
+      result.SetStatus(eReturnStatusFailed);
+      return false;
+    }
+    error = HeapSnapshot::Capture(*process, snapshot);
+  }
+  if (error.Fail()) {
+    result.AppendError(error.AsCString());
+    result.SetStatus(eReturnStatusFailed);
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------
+// Take a snapshot of the heap and save it to a file
+//----------------------------------------------------------------------
+class CommandObjectMemoryHeapSnapshot : public CommandObjectParsed {
+public:
+  CommandObjectMemoryHeapSnapshot(CommandInterpreter &interpreter)
+      : CommandObjectParsed(
+            interpreter, "memory heap snapshot",
+            "Walk the malloc heap of the current process, record all the "
+            "allocated blocks and the pointers between them, and save the "
+            "result to a file.",
+            "memory heap snapshot <file>",
+            eCommandRequiresProcess | eCommandTryTargetAPILock |
+                eCommandProcessMustBeLaunched | eCommandProcessMustBePaused) {
+    CommandArgumentEntry arg;
+    CommandArgumentData file_arg;
+    file_arg.arg_type = eArgTypeFilename;
+    file_arg.arg_repetition = eArgRepeatPlain;
+    arg.push_back(file_arg);
+    m_arguments.push_back(arg);
+  }
+
+  ~CommandObjectMemoryHeapSnapshot() override = default;
+
+protected:
+  bool DoExecute(Args &command, CommandReturnObject &result) override {
+    if (command.GetArgumentCount() != 1) {
+      result.AppendErrorWithFormat("'%s' takes one argument:\nUsage: %s\n",
+                                   m_cmd_name.c_str(), m_cmd_syntax.c_str());
+      result.SetStatus(eReturnStatusFailed);
+      return false;
+    }
+
+    HeapSnapshot snapshot;
+    if (!GetHeapSnapshot(m_exe_ctx, nullptr, snapshot, result))
+      return false;
+
+    FileSpec file(command[0].ref, true);
+    Status error = snapshot.Save(file);
+    if (error.Fail()) {
+      result.AppendErrorWithFormat("failed to write '%s': %s\n",
+                                   file.GetPath().c_str(), error.AsCString());
+      result.SetStatus(eReturnStatusFailed);
+      return false;
+    }
+
+    uint64_t total_size = 0, unreachable_count = 0, unreachable_size = 0;
+    for (uint32_t i = 0; i < snapshot.GetNumObjects(); ++i) {
+      total_size += snapshot.GetObjectSize(i);
+      if (!snapshot.IsReachable(i)) {
+        ++unreachable_count;
+        unreachable_size += snapshot.GetObjectSize(i);
+      }
+    }
+    Stream &strm = result.GetOutputStream();
+    strm.Printf("Wrote %" PRIu64 " objects (%" PRIu64 " bytes) and %" PRIu64
+                " references to '%s'.\n",
+                (uint64_t)snapshot.GetNumObjects(), total_size,
+                (uint64_t)snapshot.GetNumReferences(), file.GetPath().c_str());
+    strm.Printf("%" PRIu64 " objects (%" PRIu64
+                " bytes) are not reachable from any root.\n",
+                unreachable_count, unreachable_size);
+    result.SetStatus(eReturnStatusSuccessFinishResult);
+    return true;
+  }
+};
+
+//----------------------------------------------------------------------
+// List the types that keep the most memory alive
+//----------------------------------------------------------------------
+class CommandObjectMemoryHeapTop : public CommandObjectParsed {
+public:
+  CommandObjectMemoryHeapTop(CommandInterpreter &interpreter)
+      : CommandObjectParsed(
+            interpreter, "memory heap top",
+            "List the types of heap objects that retain the most memory, "
+            "either in a saved snapshot or in the current process. Objects "
+            "are typed by their vtable; everything else is <unknown>.",
+            "memory heap top [<file>]",
+            eCommandTryTargetAPILock | eCommandProcessMustBePaused),
+        m_options() {
+    CommandArgumentEntry arg;
+    CommandArgumentData file_arg;
+    file_arg.arg_type = eArgTypeFilename;
+    file_arg.arg_repetition = eArgRepeatOptional;
+    arg.push_back(file_arg);
+    m_arguments.push_back(arg);
+  }
+
+  ~CommandObjectMemoryHeapTop() override = default;
+
+  Options *GetOptions() override { return &m_options; }
+
+protected:
+  bool DoExecute(Args &command, CommandReturnObject &result) override {
+    if (command.GetArgumentCount() > 1) {
+      result.AppendErrorWithFormat("'%s' takes at most one argument:\n"
+                                   "Usage: %s\n",
+                                   m_cmd_name.c_str(), m_cmd_syntax.c_str());
+      result.SetStatus(eReturnStatusFailed);
+      return false;
+    }
+
+    HeapSnapshot snapshot;
+    if (!GetHeapSnapshot(m_exe_ctx,
+                         command.GetArgumentCount() ? command[0].c_str()
+                                                    : nullptr,
+                         snapshot, result))
+      return false;
+
+    std::vector<HeapSnapshot::TypeStatistics> stats =
+        snapshot.GetTypeStatistics();
+    Stream &strm = result.GetOutputStream();
+    strm.Printf("%10s %14s %14s %10s %14s  %s\n", "count", "size", "retained",
+                "leaked", "leaked size", "type");
+    strm.Printf("%10s %14s %14s %10s %14s  %s\n", "----------",
+                "--------------", "--------------", "----------",
+                "--------------", "----");
+    const size_t count = m_options.GetCount(stats.size());
+    for (size_t i = 0; i < count; ++i) {
+      const HeapSnapshot::TypeStatistics &type_stats = stats[i];
+      strm.Printf("%10" PRIu64 " %14" PRIu64 " %14" PRIu64 " %10" PRIu64
+                  " %14" PRIu64 "  %s\n",
+                  type_stats.count, type_stats.size, type_stats.retained_size,
+                  type_stats.unreachable_count, type_stats.unreachable_size,
+                  GetHeapTypeName(type_stats.name));
+    }
+    result.SetStatus(eReturnStatusSuccessFinishResult);
+    return true;
+  }
+
+  HeapReportOptions m_options;
+};
+
+//----------------------------------------------------------------------
+// Compare two heap snapshots
+//----------------------------------------------------------------------
+class CommandObjectMemoryHeapDiff : public CommandObjectParsed {
+public:
+  CommandObjectMemoryHeapDiff(CommandInterpreter &interpreter)
+      : CommandObjectParsed(
+            interpreter, "memory heap diff",
+            "Show which types of heap objects grew between two snapshots. If "
+            "only one snapshot is given it is compared against the heap of "
+            "the current process.",
+            "memory heap diff <before-file> [<after-file>]",
+            eCommandTryTargetAPILock | eCommandProcessMustBePaused),
+        m_options() {
+    CommandArgumentEntry arg1;
+    CommandArgumentData before_arg;
+    before_arg.arg_type = eArgTypeFilename;
+    before_arg.arg_repetition = eArgRepeatPlain;
+    arg1.push_back(before_arg);
+    m_arguments.push_back(arg1);
+
+    CommandArgumentEntry arg2;
+    CommandArgumentData after_arg;
+    after_arg.arg_type = eArgTypeFilename;
+    after_arg.arg_repetition = eArgRepeatOptional;
+    arg2.push_back(after_arg);
+    m_arguments.push_back(arg2);
+  }
+
+  ~CommandObjectMemoryHeapDiff() override = default;
+
+  Options *GetOptions() override { return &m_options; }
+
+protected:
+  bool DoExecute(Args &command, CommandReturnObject &result) override {
+    const size_t argc = command.GetArgumentCount();
+    if (argc < 1 || argc > 2) {
+      result.AppendErrorWithFormat("'%s' takes one or two arguments:\n"
+                                   "Usage: %s\n",
+                                   m_cmd_name.c_str(), m_cmd_syntax.c_str());
+      result.SetStatus(eReturnStatusFailed);
+      return false;
+    }
+
+    HeapSnapshot before, after;
+    if (!GetHeapSnapshot(m_exe_ctx, command[0].c_str(), before, result) ||
+        !GetHeapSnapshot(m_exe_ctx, argc == 2 ? command[1].c_str() : nullptr,
+                         after, result))
+      return false;
+
+    std::vector<HeapSnapshot::TypeDelta> deltas =
+        HeapSnapshot::Diff(before, after);
+    Stream &strm = result.GetOutputStream();
+    if (deltas.empty()) {
+      strm.PutCString("The heaps are identical.\n");
+      result.SetStatus(eReturnStatusSuccessFinishResult);
+      return true;
+    }
+    strm.Printf("%12s %15s %12s  %s\n", "count delta", "size delta",
+                "new objects", "type");
+    strm.Printf("%12s %15s %12s  %s\n", "------------", "---------------",
+                "------------", "----");
+    const size_t count = m_options.GetCount(deltas.size());
+    for (size_t i = 0; i < count; ++i) {
+      const HeapSnapshot::TypeDelta &delta = deltas[i];
+      strm.Printf("%+12" PRId64 " %+15" PRId64 " %12" PRIu64 "  %s\n",
+                  delta.count_delta, delta.size_delta, delta.new_objects,
+                  GetHeapTypeName(delta.name));
+    }
+    result.SetStatus(eReturnStatusSuccessFinishResult);
+    return true;
+  }
+
+  HeapReportOptions m_options;
+};
+
+class CommandObjectMemoryHeap : public CommandObjectMultiword {
+public:
+  CommandObjectMemoryHeap(CommandInterpreter &interpreter)
+      : CommandObjectMultiword(
+            interpreter, "memory heap",
+            "Commands for analyzing the malloc heap of a process or core file.",
+            "memory heap <subcommand> [<subcommand-options>]") {
+    LoadSubCommand("snapshot",
+                   CommandObjectSP(
+                       new CommandObjectMemoryHeapSnapshot(interpreter)));
+    LoadSubCommand(
+        "top", CommandObjectSP(new CommandObjectMemoryHeapTop(interpreter)));
+    LoadSubCommand(
+        "diff", CommandObjectSP(new CommandObjectMemoryHeapDiff(interpreter)));
+  }
+
+  ~CommandObjectMemoryHeap() override = default;
+};
+
 //-------------------------------------------------------------------------
 // CommandObjectMemory
 //-------------------------------------------------------------------------
@@ -1786,6 +2231,8 @@ CommandObjectMemory::CommandObjectMemory(CommandInterpreter &interpreter)
                  CommandObjectSP(new CommandObjectMemoryHistory(interpreter)));
   LoadSubCommand("region",
                  CommandObjectSP(new CommandObjectMemoryRegion(interpreter)));
+  LoadSubCommand("heap",
+                 CommandObjectSP(new CommandObjectMemoryHeap(interpreter)));
 }
 
 CommandObjectMemory::~CommandObjectMemory() = default;
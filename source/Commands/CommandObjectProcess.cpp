@@ -558,7 +558,8 @@ protected:
 
 static OptionDefinition g_process_continue_options[] = {
     // clang-format off
-  { LLDB_OPT_SET_ALL, false, "ignore-count",'i', OptionParser::eRequiredArgument, nullptr, nullptr, 0, eArgTypeUnsignedInteger, "Ignore <N> crossings of the breakpoint (if it exists) for the currently selected thread." }
+  { LLDB_OPT_SET_ALL, false, "ignore-count",'i', OptionParser::eRequiredArgument, nullptr, nullptr, 0, eArgTypeUnsignedInteger, "Ignore <N> crossings of the breakpoint (if it exists) for the currently selected thread." },
+  { LLDB_OPT_SET_ALL, false, "reverse",     'r', OptionParser::eNoArgument,       nullptr, nullptr, 0, eArgTypeNone,            "Run the process backward, to the previous breakpoint or watchpoint hit or the start of its recorded execution history.  The process must be recording its execution history." }
     // clang-format on
 };
 
@@ -600,6 +601,10 @@ protected:
               option_arg.str().c_str());
         break;
 
+      case 'r':
+        m_reverse = true;
+        break;
+
       default:
         error.SetErrorStringWithFormat("invalid short option character '%c'",
                                        short_option);
@@ -610,6 +615,7 @@ protected:
 
     void OptionParsingStarting(ExecutionContext *execution_context) override {
       m_ignore = 0;
+      m_reverse = false;
     }
 
     llvm::ArrayRef<OptionDefinition> GetDefinitions() override {
@@ -617,6 +623,7 @@ protected:
     }
 
     uint32_t m_ignore;
+    bool m_reverse;
   };
 
   bool DoExecute(Args &command, CommandReturnObject &result) override {
@@ -669,6 +676,9 @@ protected:
         }
       }
 
+      process->SetBaseDirection(m_options.m_reverse ? eRunReverse
+                                                    : eRunForward);
+
       const uint32_t iohandler_id = process->GetIOHandlerID();
 
       StreamString stream;
@@ -8,9 +8,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "CommandObjectStats.h"
+#include "lldb/Core/Debugger.h"
+#include "lldb/Core/ModuleList.h"
 #include "lldb/Host/Host.h"
 #include "lldb/Interpreter/CommandInterpreter.h"
 #include "lldb/Interpreter/CommandReturnObject.h"
+#include "lldb/Interpreter/ScriptInterpreter.h"
 #include "lldb/Target/Target.h"
 
 using namespace lldb;
@@ -36,6 +39,9 @@ protected:
     }
 
     target->SetCollectingStats(true);
+    if (ScriptInterpreter *script_interpreter =
+            m_interpreter.GetScriptInterpreter(false))
+      script_interpreter->ClearFormatterStatistics();
     result.SetStatus(eReturnStatusSuccessFinishResult);
     return true;
   }
@@ -87,6 +93,105 @@ protected:
           stat);
       i += 1;
     }
+    const ModuleList::DebugInfoEvictionStats &eviction_stats =
+        ModuleList::GetDebugInfoEvictionStats();
+    if (eviction_stats.num_evictions.load()) {
+      result.AppendMessageWithFormat(
+          "Debug info evictions : %" PRIu64 " (%" PRIu64 " bytes)\n",
+          eviction_stats.num_evictions.load(),
+          eviction_stats.bytes_freed.load());
+      result.AppendMessageWithFormat(
+          "Debug info reparses : %" PRIu64 " (%.6f seconds)\n",
+          eviction_stats.num_reparses.load(),
+          eviction_stats.reparse_nanos.load() / 1e9);
+    }
+    if (ScriptInterpreter *script_interpreter =
+            m_interpreter.GetScriptInterpreter(false))
+      script_interpreter->DumpFormatterStatistics(result.GetOutputStream());
+    result.SetStatus(eReturnStatusSuccessFinishResult);
+    return true;
+  }
+};
+
+class CommandObjectStatsMemory : public CommandObjectParsed {
+public:
+  CommandObjectStatsMemory(CommandInterpreter &interpreter)
+      : CommandObjectParsed(
+            interpreter, "memory",
+            "Show the number of bytes used by the string pool, by what was "
+            "parsed from the modules of each target and by the process "
+            "memory caches.",
+            nullptr) {}
+
+  ~CommandObjectStatsMemory() override = default;
+
+protected:
+  bool DoExecute(Args &command, CommandReturnObject &result) override {
+    StructuredData::DictionarySP stats_sp =
+        m_interpreter.GetDebugger().GetMemoryStatistics();
+    Stream &strm = result.GetOutputStream();
+
+    StructuredData::Dictionary *totals = nullptr;
+    stats_sp->GetValueForKeyAsDictionary("totals", totals);
+    StructuredData::Dictionary *strings = nullptr;
+    stats_sp->GetValueForKeyAsDictionary("strings", strings);
+    uint64_t unused_strings = 0;
+    strings->GetValueForKeyAsInteger("unused", unused_strings);
+
+    static const struct {
+      const char *key;
+      const char *description;
+    } g_subsystems[] = {{"strings", "String pool"},
+                        {"symbols", "Symbols"},
+                        {"symbol_indexes", "Symbol name indexes"},
+                        {"debug_info", "Debug info entries"},
+                        {"line_tables", "Line tables"},
+                        {"type_systems", "Module type systems"},
+                        {"scratch_type_systems", "Scratch type systems"},
+                        {"memory_cache", "Process memory caches"},
+                        {"total", "Total"}};
+    for (const auto &subsystem : g_subsystems) {
+      uint64_t bytes = 0;
+      totals->GetValueForKeyAsInteger(subsystem.key, bytes);
+      strm.Printf("%-24s %14" PRIu64, subsystem.description, bytes);
+      if (strcmp(subsystem.key, "strings") == 0)
+        strm.Printf(" (%" PRIu64 " unused)", unused_strings);
+      strm.EOL();
+    }
+
+    StructuredData::Array *modules = nullptr;
+    stats_sp->GetValueForKeyAsArray("modules", modules);
+    std::vector<StructuredData::Dictionary *> sorted_modules;
+    modules->ForEach([&sorted_modules](StructuredData::Object *object) {
+      sorted_modules.push_back(object->GetAsDictionary());
+      return true;
+    });
+    auto get_total = [](StructuredData::Dictionary *module) {
+      uint64_t total = 0;
+      module->GetValueForKeyAsInteger("total", total);
+      return total;
+    };
+    std::stable_sort(sorted_modules.begin(), sorted_modules.end(),
+                     [&](StructuredData::Dictionary *lhs,
+                         StructuredData::Dictionary *rhs) {
+                       return get_total(lhs) > get_total(rhs);
+                     });
+
+    strm.Printf("\n%12s %12s %12s %12s %12s %12s  %s\n", "Symbols",
+                "Indexes", "Debug info", "Line tables", "Types", "Total",
+                "Module");
+    for (StructuredData::Dictionary *module : sorted_modules) {
+      for (const char *key : {"symbols", "symbol_indexes", "debug_info",
+                              "line_tables", "type_systems", "total"}) {
+        uint64_t bytes = 0;
+        module->GetValueForKeyAsInteger(key, bytes);
+        strm.Printf("%12" PRIu64 " ", bytes);
+      }
+      llvm::StringRef path;
+      module->GetValueForKeyAsString("path", path);
+      strm.Printf(" %s\n", path.str().c_str());
+    }
+
     result.SetStatus(eReturnStatusSuccessFinishResult);
     return true;
   }
@@ -102,6 +207,8 @@ CommandObjectStats::CommandObjectStats(CommandInterpreter &interpreter)
                  CommandObjectSP(new CommandObjectStatsDisable(interpreter)));
   LoadSubCommand("dump",
                  CommandObjectSP(new CommandObjectStatsDump(interpreter)));
+  LoadSubCommand("memory",
+                 CommandObjectSP(new CommandObjectStatsMemory(interpreter)));
 }
 
 CommandObjectStats::~CommandObjectStats() = default;
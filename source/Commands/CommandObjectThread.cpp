@@ -421,6 +421,7 @@ static OptionDefinition g_thread_step_scope_options[] = {
   { LLDB_OPT_SET_1, false, "count",                     'c', OptionParser::eRequiredArgument, nullptr, nullptr,            1, eArgTypeCount,             "How many times to perform the stepping operation - currently only supported for step-inst and next-inst." },
   { LLDB_OPT_SET_1, false, "end-linenumber",            'e', OptionParser::eRequiredArgument, nullptr, nullptr,            1, eArgTypeLineNum,           "The line at which to stop stepping - defaults to the next line and only supported for step-in and step-over.  You can also pass the string 'block' to step to the end of the current block.  This is particularly useful in conjunction with --step-target to step through a complex calling sequence." },
   { LLDB_OPT_SET_1, false, "run-mode",                  'm', OptionParser::eRequiredArgument, nullptr, g_tri_running_mode, 0, eArgTypeRunMode,           "Determine how to run other threads while stepping the current thread." },
+  { LLDB_OPT_SET_1, false, "reverse",                   'R', OptionParser::eNoArgument,       nullptr, nullptr,            0, eArgTypeNone,              "Run the thread backward - only supported for step-inst, which steps back one instruction, and step-out, which steps back to the call of the current function.  The process must be recording its execution history." },
   { LLDB_OPT_SET_1, false, "step-over-regexp",          'r', OptionParser::eRequiredArgument, nullptr, nullptr,            0, eArgTypeRegularExpression, "A regular expression that defines function names to not to stop at when stepping in." },
   { LLDB_OPT_SET_1, false, "step-in-target",            't', OptionParser::eRequiredArgument, nullptr, nullptr,            0, eArgTypeFunctionName,      "The name of the directly called function step in should stop at when stepping into." },
   { LLDB_OPT_SET_2, false, "python-class",              'C', OptionParser::eRequiredArgument, nullptr, nullptr,            0, eArgTypePythonClass,       "The name of the class that will manage this step - only supported for Scripted Step." }
@@ -504,6 +505,10 @@ public:
         m_avoid_regexp.assign(option_arg);
         break;
 
+      case 'R':
+        m_reverse = true;
+        break;
+
       case 't':
         m_step_in_target.clear();
         m_step_in_target.assign(option_arg);
@@ -534,6 +539,7 @@ public:
       m_step_count = 1;
       m_end_line = LLDB_INVALID_LINE_NUMBER;
       m_end_line_is_block_end = false;
+      m_reverse = false;
     }
 
     llvm::ArrayRef<OptionDefinition> GetDefinitions() override {
@@ -550,6 +556,7 @@ public:
     uint32_t m_step_count;
     uint32_t m_end_line;
     bool m_end_line_is_block_end;
+    bool m_reverse;
   };
 
   CommandObjectThreadStepWithTypeAndScope(CommandInterpreter &interpreter,
@@ -642,6 +649,14 @@ protected:
       return false;
     }
 
+    if (m_options.m_reverse && m_step_type != eStepTypeTrace &&
+        m_step_type != eStepTypeOut) {
+      result.AppendErrorWithFormat(
+          "reverse option is only valid for step-inst and step-out");
+      result.SetStatus(eReturnStatusFailed);
+      return false;
+    }
+
     const bool abort_other_plans = false;
     const lldb::RunMode stop_other_threads = m_options.m_run_mode;
 
@@ -731,10 +746,15 @@ protected:
             true, abort_other_plans, bool_stop_other_threads);
     } else if (m_step_type == eStepTypeTrace) {
       new_plan_sp = thread->QueueThreadPlanForStepSingleInstruction(
-          false, abort_other_plans, bool_stop_other_threads);
+          false, abort_other_plans, bool_stop_other_threads,
+          m_options.m_reverse ? eRunReverse : eRunForward);
     } else if (m_step_type == eStepTypeTraceOver) {
       new_plan_sp = thread->QueueThreadPlanForStepSingleInstruction(
           true, abort_other_plans, bool_stop_other_threads);
+    } else if (m_step_type == eStepTypeOut && m_options.m_reverse) {
+      new_plan_sp = thread->QueueThreadPlanForReverseStepOut(
+          abort_other_plans, bool_stop_other_threads, eVoteYes,
+          eVoteNoOpinion);
     } else if (m_step_type == eStepTypeOut) {
       new_plan_sp = thread->QueueThreadPlanForStepOut(
           abort_other_plans, nullptr, false, bool_stop_other_threads, eVoteYes,
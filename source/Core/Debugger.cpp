@@ -14,6 +14,7 @@
 #include "lldb/Core/FormatEntity.h"
 #include "lldb/Core/Listener.h" // for Listener
 #include "lldb/Core/Mangled.h"  // for Mangled
+#include "lldb/Core/Module.h"
 #include "lldb/Core/ModuleList.h"  // for Mangled
 #include "lldb/Core/PluginManager.h"
 #include "lldb/Core/State.h"
@@ -52,6 +53,7 @@
 #include "lldb/Host/windows/PosixApi.h" // for PATH_MAX
 #endif
 
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/None.h"      // for None
 #include "llvm/ADT/STLExtras.h" // for make_unique
 #include "llvm/ADT/StringRef.h"
@@ -1708,3 +1710,89 @@ Status Debugger::RunREPL(LanguageType language, const char *repl_options) {
 
   return err;
 }
+
+StructuredData::DictionarySP Debugger::GetMemoryStatistics() {
+  auto stats_sp = std::make_shared<StructuredData::Dictionary>();
+  auto totals_sp = std::make_shared<StructuredData::Dictionary>();
+  size_t total = 0;
+
+  const ConstString::MemoryStats string_stats = ConstString::GetMemoryStats();
+  auto strings_sp = std::make_shared<StructuredData::Dictionary>();
+  strings_sp->AddIntegerItem("total", string_stats.GetBytesTotal());
+  strings_sp->AddIntegerItem("used", string_stats.GetBytesUsed());
+  strings_sp->AddIntegerItem("unused", string_stats.GetBytesUnused());
+  stats_sp->AddItem("strings", strings_sp);
+  totals_sp->AddIntegerItem("strings", string_stats.GetBytesTotal());
+  total += string_stats.GetBytesTotal();
+
+  // Only the modules of this debugger's targets. They are copied out of the
+  // module lists first, so no list stays locked while each module takes its
+  // own locks to report its usage.
+  std::vector<ModuleSP> modules;
+  llvm::DenseSet<Module *> seen_modules;
+  const size_t num_targets = m_target_list.GetNumTargets();
+  for (size_t i = 0; i < num_targets; ++i) {
+    if (TargetSP target_sp = m_target_list.GetTargetAtIndex(i)) {
+      target_sp->GetImages().ForEach([&](const ModuleSP &module_sp) {
+        if (seen_modules.insert(module_sp.get()).second)
+          modules.push_back(module_sp);
+        return true;
+      });
+    }
+  }
+
+  auto modules_sp = std::make_shared<StructuredData::Array>();
+  Module::MemoryUsage module_totals;
+  for (const ModuleSP &module : modules) {
+    const Module::MemoryUsage usage = module->GetMemoryUsage();
+    module_totals += usage;
+    auto module_sp = std::make_shared<StructuredData::Dictionary>();
+    module_sp->AddStringItem("path", module->GetFileSpec().GetPath());
+    module_sp->AddIntegerItem("symbols", usage.symbols);
+    module_sp->AddIntegerItem("symbol_indexes", usage.symbol_indexes);
+    module_sp->AddIntegerItem("debug_info", usage.debug_info);
+    module_sp->AddIntegerItem("line_tables", usage.line_tables);
+    module_sp->AddIntegerItem("type_systems", usage.type_systems);
+    module_sp->AddIntegerItem("total", usage.GetTotal());
+    modules_sp->AddItem(module_sp);
+  }
+  stats_sp->AddItem("modules", modules_sp);
+  totals_sp->AddIntegerItem("symbols", module_totals.symbols);
+  totals_sp->AddIntegerItem("symbol_indexes", module_totals.symbol_indexes);
+  totals_sp->AddIntegerItem("debug_info", module_totals.debug_info);
+  totals_sp->AddIntegerItem("line_tables", module_totals.line_tables);
+  totals_sp->AddIntegerItem("type_systems", module_totals.type_systems);
+  total += module_totals.GetTotal();
+
+  auto targets_sp = std::make_shared<StructuredData::Array>();
+  size_t memory_cache_total = 0;
+  size_t scratch_total = 0;
+  for (size_t i = 0; i < num_targets; ++i) {
+    TargetSP target_sp = m_target_list.GetTargetAtIndex(i);
+    if (!target_sp)
+      continue;
+    size_t memory_cache = 0;
+    if (ProcessSP process_sp = target_sp->GetProcessSP())
+      memory_cache = process_sp->GetMemoryCacheByteSize();
+    const size_t scratch = target_sp->GetScratchTypeSystemsMemorySize();
+    memory_cache_total += memory_cache;
+    scratch_total += scratch;
+
+    auto target_dict_sp = std::make_shared<StructuredData::Dictionary>();
+    std::string executable;
+    if (Module *exe_module = target_sp->GetExecutableModulePointer())
+      executable = exe_module->GetFileSpec().GetPath();
+    target_dict_sp->AddStringItem("executable", executable);
+    target_dict_sp->AddIntegerItem("memory_cache", memory_cache);
+    target_dict_sp->AddIntegerItem("scratch_type_systems", scratch);
+    targets_sp->AddItem(target_dict_sp);
+  }
+  stats_sp->AddItem("targets", targets_sp);
+  totals_sp->AddIntegerItem("memory_cache", memory_cache_total);
+  totals_sp->AddIntegerItem("scratch_type_systems", scratch_total);
+  total += memory_cache_total + scratch_total;
+
+  totals_sp->AddIntegerItem("total", total);
+  stats_sp->AddItem("totals", totals_sp);
+  return stats_sp;
+}
@@ -349,6 +349,11 @@ TypeSystem *Module::GetTypeSystemForLanguage(LanguageType language) {
   return m_type_system_map.GetTypeSystemForLanguage(language, this, true);
 }
 
+void Module::ForEachTypeSystem(
+    std::function<bool(TypeSystem *)> const &callback) {
+  m_type_system_map.ForEach(callback);
+}
+
 void Module::ParseAllDebugSymbols() {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
   size_t num_comp_units = GetNumCompileUnits();
@@ -1039,8 +1044,18 @@ size_t Module::FindTypes(
   return num_matches;
 }
 
+static std::atomic<uint64_t> g_debug_info_use_epoch{0};
+
+void Module::AdvanceDebugInfoUseEpoch() {
+  g_debug_info_use_epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
 SymbolVendor *Module::GetSymbolVendor(bool can_create,
                                       lldb_private::Stream *feedback_strm) {
+  const uint64_t epoch =
+      g_debug_info_use_epoch.load(std::memory_order_relaxed);
+  if (m_last_debug_info_use.load(std::memory_order_relaxed) != epoch)
+    m_last_debug_info_use.store(epoch, std::memory_order_relaxed);
   if (!m_did_load_symbol_vendor.load()) {
     std::lock_guard<std::recursive_mutex> guard(m_mutex);
     if (!m_did_load_symbol_vendor.load() && can_create) {
@@ -1416,6 +1431,52 @@ void Module::PreloadSymbols() {
   }
 }
 
+void Module::PrefetchTypes(llvm::ArrayRef<ConstString> names) {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  SymbolVendor *sym_vendor = GetSymbolVendor();
+  if (!sym_vendor)
+    return;
+  if (SymbolFile *symbol_file = sym_vendor->GetSymbolFile())
+    symbol_file->PrefetchTypes(names);
+}
+
+size_t Module::GetParsedDebugInfoSize() {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  if (!m_symfile_ap)
+    return 0;
+  SymbolFile *symbol_file = m_symfile_ap->GetSymbolFile();
+  return symbol_file ? symbol_file->GetParsedDataSize() : 0;
+}
+
+Module::MemoryUsage Module::GetMemoryUsage() {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  MemoryUsage usage;
+  if (m_objfile_sp) {
+    if (Symtab *symtab = m_objfile_sp->GetSymtabIfParsed()) {
+      usage.symbols = symtab->GetSymbolsMemorySize();
+      usage.symbol_indexes = symtab->GetIndexesMemorySize();
+    }
+  }
+  if (m_symfile_ap) {
+    usage.line_tables = m_symfile_ap->GetLineTablesMemorySize();
+    if (SymbolFile *symbol_file = m_symfile_ap->GetSymbolFile())
+      usage.debug_info = symbol_file->GetParsedDataSize();
+  }
+  m_type_system_map.ForEach([&usage](TypeSystem *type_system) {
+    usage.type_systems += type_system->MemorySize();
+    return true;
+  });
+  return usage;
+}
+
+size_t Module::FreeParsedDebugInfo() {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  if (!m_symfile_ap)
+    return 0;
+  SymbolFile *symbol_file = m_symfile_ap->GetSymbolFile();
+  return symbol_file ? symbol_file->FreeParsedData() : 0;
+}
+
 void Module::SetSymbolFileFileSpec(const FileSpec &file) {
   if (!file.Exists())
     return;
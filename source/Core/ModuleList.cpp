@@ -23,6 +23,7 @@
 #include "lldb/Utility/ConstString.h" // for ConstString
 #include "lldb/Utility/Log.h"
 #include "lldb/Utility/Logging.h" // for GetLogIfAnyCategoriesSet
+#include "lldb/Utility/Timer.h"
 #include "lldb/Utility/UUID.h"    // for UUID, operator!=, operator==
 #include "lldb/lldb-defines.h"    // for LLDB_INVALID_INDEX32
 
@@ -75,9 +76,30 @@ PropertyDefinition g_properties[] = {
     {"clang-modules-cache-path", OptionValue::eTypeFileSpec, true, 0, nullptr,
      nullptr,
      "The path to the clang modules cache directory (-fmodules-cache-path)."},
+    {"enable-regex-index", OptionValue::eTypeBoolean, true, true, nullptr,
+     nullptr,
+     "Build an index of the trigrams in symbol and debug info names the first "
+     "time a module is searched with a regular expression, and use it to "
+     "skip names that can't match."},
+    {"index-cache-path", OptionValue::eTypeFileSpec, true, 0, nullptr,
+     nullptr,
+     "The directory in which the symbol tables of modules, and indexes "
+     "built from them, are kept between sessions. Nothing is cached if this "
+     "is empty."},
+    {"memory-budget", OptionValue::eTypeUInt64, true, 0, nullptr, nullptr,
+     "The number of bytes the parsed debug information of a target's modules "
+     "may use, e.g. 8GB. When the process stops with more than that in use, "
+     "the debug information of the target's least recently used modules is "
+     "freed, and parsed again if it is needed. Zero means no limit."},
     {nullptr, OptionValue::eTypeInvalid, false, 0, nullptr, nullptr, nullptr}};
 
-enum { ePropertyEnableExternalLookup, ePropertyClangModulesCachePath };
+enum {
+  ePropertyEnableExternalLookup,
+  ePropertyClangModulesCachePath,
+  ePropertyEnableRegexIndex,
+  ePropertyIndexCachePath,
+  ePropertyMemoryBudget
+};
 
 } // namespace
 
@@ -108,6 +130,25 @@ bool ModuleListProperties::SetClangModulesCachePath(llvm::StringRef path) {
       nullptr, ePropertyClangModulesCachePath, path);
 }
 
+bool ModuleListProperties::GetEnableRegexIndex() const {
+  const uint32_t idx = ePropertyEnableRegexIndex;
+  return m_collection_sp->GetPropertyAtIndexAsBoolean(
+      nullptr, idx, g_properties[idx].default_uint_value != 0);
+}
+
+FileSpec ModuleListProperties::GetIndexCachePath() const {
+  return m_collection_sp
+      ->GetPropertyAtIndexAsOptionValueFileSpec(nullptr, false,
+                                                ePropertyIndexCachePath)
+      ->GetCurrentValue();
+}
+
+uint64_t ModuleListProperties::GetDebugInfoMemoryBudget() const {
+  const uint32_t idx = ePropertyMemoryBudget;
+  return m_collection_sp->GetPropertyAtIndexAsUInt64(
+      nullptr, idx, g_properties[idx].default_uint_value);
+}
+
 
 ModuleList::ModuleList()
     : m_modules(), m_modules_mutex(), m_notifier(nullptr) {}
@@ -766,13 +807,82 @@ size_t ModuleList::RemoveOrphanSharedModules(bool mandatory) {
   return GetSharedModuleList().RemoveOrphans(mandatory);
 }
 
+ModuleList::DebugInfoEvictionStats &ModuleList::GetDebugInfoEvictionStats() {
+  static DebugInfoEvictionStats g_stats;
+  return g_stats;
+}
+
+void ModuleList::EnforceDebugInfoMemoryBudget() {
+  // Debug info used from now on counts as more recent than what was used up
+  // to this stop.
+  Module::AdvanceDebugInfoUseEpoch();
+  const uint64_t budget =
+      GetGlobalModuleListProperties().GetDebugInfoMemoryBudget();
+  if (budget == 0)
+    return;
+
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, "ModuleList::EnforceDebugInfoMemoryBudget()");
+
+  struct Candidate {
+    ModuleSP module_sp;
+    uint64_t last_use;
+    size_t size;
+  };
+  std::vector<Candidate> candidates;
+  size_t total_size = 0;
+  ForEach([&](const ModuleSP &module_sp) {
+    // Modules that are busy on another thread are left alone.
+    std::unique_lock<std::recursive_mutex> lock(module_sp->GetMutex(),
+                                                std::try_to_lock);
+    if (!lock.owns_lock())
+      return true;
+    size_t size = module_sp->GetParsedDebugInfoSize();
+    if (size == 0)
+      return true;
+    total_size += size;
+    candidates.push_back({module_sp, module_sp->GetLastDebugInfoUse(), size});
+    return true;
+  });
+  if (total_size <= budget)
+    return;
+
+  // Free the modules that were used the longest time ago first, and the
+  // larger ones first among those last used at the same stop.
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate &lhs, const Candidate &rhs) {
+              if (lhs.last_use != rhs.last_use)
+                return lhs.last_use < rhs.last_use;
+              return lhs.size > rhs.size;
+            });
+
+  Log *log = GetLogIfAnyCategoriesSet(LIBLLDB_LOG_MODULES);
+  DebugInfoEvictionStats &stats = GetDebugInfoEvictionStats();
+  for (const Candidate &candidate : candidates) {
+    if (total_size <= budget)
+      break;
+    std::unique_lock<std::recursive_mutex> lock(
+        candidate.module_sp->GetMutex(), std::try_to_lock);
+    if (!lock.owns_lock())
+      continue;
+    size_t freed = candidate.module_sp->FreeParsedDebugInfo();
+    if (freed == 0)
+      continue;
+    LLDB_LOG(log, "freed {0} bytes of debug info of {1}", freed,
+             candidate.module_sp->GetFileSpec().GetPath());
+    total_size -= std::min(total_size, freed);
+    stats.num_evictions.fetch_add(1);
+    stats.bytes_freed.fetch_add(freed);
+  }
+}
+
 Status ModuleList::GetSharedModule(const ModuleSpec &module_spec,
                                    ModuleSP &module_sp,
                                    const FileSpecList *module_search_paths_ptr,
                                    ModuleSP *old_module_sp_ptr,
                                    bool *did_create_ptr, bool always_create) {
   ModuleList &shared_module_list = GetSharedModuleList();
-  std::lock_guard<std::recursive_mutex> guard(
+  std::unique_lock<std::recursive_mutex> guard(
       shared_module_list.m_modules_mutex);
   char path[PATH_MAX];
 
@@ -789,67 +899,66 @@ Status ModuleList::GetSharedModule(const ModuleSpec &module_spec,
   const FileSpec &module_file_spec = module_spec.GetFileSpec();
   const ArchSpec &arch = module_spec.GetArchitecture();
 
-  // Make sure no one else can try and get or create a module while this
-  // function is actively working on it by doing an extra lock on the global
-  // mutex list.
-  if (!always_create) {
+  // Find a module in the shared list that matches the spec and hasn't been
+  // modified from when it was last loaded. Must be called with the lock held.
+  auto find_unchanged_module = [&]() {
     ModuleList matching_module_list;
     const size_t num_matching_modules =
         shared_module_list.FindModules(module_spec, matching_module_list);
-    if (num_matching_modules > 0) {
-      for (size_t module_idx = 0; module_idx < num_matching_modules;
-           ++module_idx) {
-        module_sp = matching_module_list.GetModuleAtIndex(module_idx);
-
-        // Make sure the file for the module hasn't been modified
-        if (module_sp->FileHasChanged()) {
-          if (old_module_sp_ptr && !*old_module_sp_ptr)
-            *old_module_sp_ptr = module_sp;
-
-          Log *log(lldb_private::GetLogIfAnyCategoriesSet(LIBLLDB_LOG_MODULES));
-          if (log != nullptr)
-            log->Printf("module changed: %p, removing from global module list",
-                        static_cast<void *>(module_sp.get()));
-
-          shared_module_list.Remove(module_sp);
-          module_sp.reset();
-        } else {
-          // The module matches and the module was not modified from when it
-          // was last loaded.
-          return error;
-        }
+    for (size_t module_idx = 0; module_idx < num_matching_modules;
+         ++module_idx) {
+      module_sp = matching_module_list.GetModuleAtIndex(module_idx);
+
+      // Make sure the file for the module hasn't been modified
+      if (module_sp->FileHasChanged()) {
+        if (old_module_sp_ptr && !*old_module_sp_ptr)
+          *old_module_sp_ptr = module_sp;
+
+        Log *log(lldb_private::GetLogIfAnyCategoriesSet(LIBLLDB_LOG_MODULES));
+        if (log != nullptr)
+          log->Printf("module changed: %p, removing from global module list",
+                      static_cast<void *>(module_sp.get()));
+
+        shared_module_list.Remove(module_sp);
+        module_sp.reset();
+      } else {
+        return true;
       }
     }
-  }
+    return false;
+  };
 
-  if (module_sp)
+  if (!always_create && find_unchanged_module())
     return error;
 
-  module_sp.reset(new Module(module_spec));
+  // Creating a module parses its object file, which can take a while for
+  // large files. Don't hold the lock while doing so: modules are prepared
+  // on many threads at once when a process loads its shared libraries, and
+  // getting the others shouldn't have to wait for this one.
+  guard.unlock();
+  ModuleSP new_module_sp(new Module(module_spec));
   // Make sure there are a module and an object file since we can specify a
   // valid file path with an architecture that might not be in that file. By
-  // getting the object file we can guarantee that the architecture matches
-  if (module_sp->GetObjectFile()) {
-    // If we get in here we got the correct arch, now we just need to verify
-    // the UUID if one was given
-    if (uuid_ptr && *uuid_ptr != module_sp->GetUUID()) {
-      module_sp.reset();
-    } else {
-      if (module_sp->GetObjectFile() &&
-          module_sp->GetObjectFile()->GetType() ==
-              ObjectFile::eTypeStubLibrary) {
-        module_sp.reset();
-      } else {
-        if (did_create_ptr) {
-          *did_create_ptr = true;
-        }
+  // getting the object file we can guarantee that the architecture matches,
+  // and then we just need to verify the UUID if one was given.
+  ObjectFile *objfile = new_module_sp->GetObjectFile();
+  const bool is_usable =
+      objfile && (!uuid_ptr || *uuid_ptr == new_module_sp->GetUUID()) &&
+      objfile->GetType() != ObjectFile::eTypeStubLibrary;
+  guard.lock();
+
+  // Another thread may have added a module for the same spec while the lock
+  // was released. Use that one, so there is only ever one.
+  if (!always_create && find_unchanged_module())
+    return error;
 
-        shared_module_list.ReplaceEquivalent(module_sp);
-        return error;
-      }
-    }
-  } else {
-    module_sp.reset();
+  if (is_usable) {
+    module_sp = new_module_sp;
+    if (did_create_ptr)
+      *did_create_ptr = true;
+
+    shared_module_list.ReplaceEquivalent(module_sp);
+    return error;
   }
 
   if (module_search_paths_ptr) {
@@ -16,6 +16,7 @@
 #include "lldb/Core/ValueObject.h"
 #include "lldb/DataFormatters/DataVisualization.h"
 #include "lldb/Interpreter/CommandInterpreter.h"
+#include "lldb/Interpreter/ScriptInterpreter.h"
 #include "lldb/Target/Language.h"
 #include "lldb/Target/Target.h"
 #include "lldb/Utility/Stream.h"
@@ -76,6 +77,18 @@ void ValueObjectPrinter::Init(
 }
 
 bool ValueObjectPrinter::PrintValueObject() {
+  // Printing a value can call many scripted formatters, one or more for every
+  // child. Let the script interpreter set up once for the whole printout
+  // rather than for each of those calls.
+  ScriptInterpreter *script_interpreter = nullptr;
+  if (m_curr_depth == 0 && m_orig_valobj) {
+    if (TargetSP target_sp = m_orig_valobj->GetTargetSP())
+      script_interpreter =
+          target_sp->GetDebugger().GetCommandInterpreter().GetScriptInterpreter(
+              false);
+  }
+  ScriptInterpreterFormatterBatch formatter_batch(script_interpreter);
+
   if (!GetMostSpecializedValue() || m_valobj == nullptr)
     return false;
 
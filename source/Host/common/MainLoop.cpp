@@ -20,12 +20,15 @@
 #include <vector>
 
 // Multiplexing is implemented using kqueue on systems that support it (BSD
-// variants including OSX). On linux we use ppoll, while android uses pselect
-// (ppoll is present but not implemented properly). On windows we use WSApoll
-// (which does not support signals).
+// variants including OSX). On linux we use epoll, falling back to ppoll where
+// it is not available, while android uses pselect (ppoll is present but not
+// implemented properly). On windows we use WSApoll (which does not support
+// signals).
 
 #if HAVE_SYS_EVENT_H
 #include <sys/event.h>
+#elif MAINLOOP_USE_EPOLL
+#include <sys/epoll.h>
 #elif defined(_WIN32)
 #include <winsock2.h>
 #elif defined(__ANDROID__)
@@ -84,7 +87,10 @@ private:
   int num_events = -1;
 
 #else
-#ifdef __ANDROID__
+#if MAINLOOP_USE_EPOLL
+  struct epoll_event out_events[16];
+  int num_events = -1;
+#elif defined(__ANDROID__)
   fd_set read_fd_set;
 #else
   std::vector<struct pollfd> read_fds;
@@ -132,7 +138,7 @@ void MainLoop::RunImpl::ProcessEvents() {
 }
 #else
 MainLoop::RunImpl::RunImpl(MainLoop &loop) : loop(loop) {
-#ifndef __ANDROID__
+#if !MAINLOOP_USE_EPOLL && !defined(__ANDROID__)
   read_fds.reserve(loop.m_read_fds.size());
 #endif
 }
@@ -152,7 +158,24 @@ sigset_t MainLoop::RunImpl::get_sigmask() {
 #endif
 }
 
-#ifdef __ANDROID__
+#if MAINLOOP_USE_EPOLL
+Status MainLoop::RunImpl::Poll() {
+  sigset_t sigmask = get_sigmask();
+
+  // The descriptors epoll can't watch are always readable, so don't block if
+  // there are any.
+  int timeout = loop.m_unwatched_fds.empty() ? -1 : 0;
+  num_events = epoll_pwait(loop.m_epoll, out_events,
+                           llvm::array_lengthof(out_events), timeout, &sigmask);
+  if (num_events == -1) {
+    num_events = 0;
+    if (errno != EINTR)
+      return Status(errno, eErrorTypePOSIX);
+  }
+
+  return Status();
+}
+#elif defined(__ANDROID__)
 Status MainLoop::RunImpl::Poll() {
   // ppoll(2) is not supported on older all android versions. Also, older
   // versions android (API <= 19) implemented pselect in a non-atomic way, as a
@@ -208,7 +231,17 @@ Status MainLoop::RunImpl::Poll() {
 #endif
 
 void MainLoop::RunImpl::ProcessEvents() {
-#ifdef __ANDROID__
+#if MAINLOOP_USE_EPOLL
+  // The callbacks can unregister descriptors, so collect the ready ones before
+  // invoking any of them. ProcessReadObject() skips those no longer watched.
+  assert(num_events >= 0);
+  std::vector<IOObject::WaitableHandle> fds(loop.m_unwatched_fds.begin(),
+                                            loop.m_unwatched_fds.end());
+  for (int i = 0; i < num_events; ++i)
+    fds.push_back(out_events[i].data.fd);
+
+  for (const auto &handle : fds) {
+#elif defined(__ANDROID__)
   // Collect first all readable file descriptors into a separate vector and
   // then iterate over it to invoke callbacks. Iterating directly over
   // loop.m_read_fds is not possible because the callbacks can modify the
@@ -250,10 +283,17 @@ MainLoop::MainLoop() {
   m_kqueue = kqueue();
   assert(m_kqueue >= 0);
 #endif
+#if MAINLOOP_USE_EPOLL
+  m_epoll = epoll_create1(EPOLL_CLOEXEC);
+  assert(m_epoll >= 0);
+#endif
 }
 MainLoop::~MainLoop() {
 #if HAVE_SYS_EVENT_H
   close(m_kqueue);
+#endif
+#if MAINLOOP_USE_EPOLL
+  close(m_epoll);
 #endif
   assert(m_read_fds.size() == 0);
   assert(m_signals.size() == 0);
@@ -273,14 +313,30 @@ MainLoop::ReadHandleUP MainLoop::RegisterReadObject(const IOObjectSP &object_sp,
     return nullptr;
   }
 
-  const bool inserted =
-      m_read_fds.insert({object_sp->GetWaitableHandle(), callback}).second;
+  const IOObject::WaitableHandle handle = object_sp->GetWaitableHandle();
+  const bool inserted = m_read_fds.insert({handle, callback}).second;
   if (!inserted) {
     error.SetErrorStringWithFormat("File descriptor %d already monitored.",
-                                   object_sp->GetWaitableHandle());
+                                   handle);
     return nullptr;
   }
 
+#if MAINLOOP_USE_EPOLL
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.u64 = 0;
+  ev.data.fd = handle;
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, handle, &ev) == -1) {
+    // epoll refuses regular files, which never block.
+    if (errno != EPERM) {
+      error.SetErrorToErrno();
+      m_read_fds.erase(handle);
+      return nullptr;
+    }
+    m_unwatched_fds.insert(handle);
+  }
+#endif
+
   return CreateReadHandle(object_sp);
 }
 
@@ -321,8 +377,8 @@ MainLoop::RegisterSignal(int signo, const Callback &callback, Status &error) {
 #endif
 
   // If we're using kqueue, the signal needs to be unblocked in order to
-  // recieve it. If using pselect/ppoll, we need to block it, and later unblock
-  // it as a part of the system call.
+  // recieve it. If using pselect/ppoll/epoll, we need to block it, and later
+  // unblock it as a part of the system call.
   ret = pthread_sigmask(HAVE_SYS_EVENT_H ? SIG_UNBLOCK : SIG_BLOCK,
                         &new_action.sa_mask, &old_set);
   assert(ret == 0 && "pthread_sigmask failed");
@@ -337,6 +393,16 @@ void MainLoop::UnregisterReadObject(IOObject::WaitableHandle handle) {
   bool erased = m_read_fds.erase(handle);
   UNUSED_IF_ASSERT_DISABLED(erased);
   assert(erased);
+
+#if MAINLOOP_USE_EPOLL
+  // The epoll set refers to the open file description rather than to the
+  // descriptor: closing the descriptor leaves it in the set as long as a
+  // duplicate of it is open, and the loop would keep waking up for it. So
+  // always remove it, and owners should unregister a descriptor before
+  // closing it.
+  if (!m_unwatched_fds.erase(handle))
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, handle, nullptr);
+#endif
 }
 
 void MainLoop::UnregisterSignal(int signo) {
@@ -227,3 +227,23 @@ Status NativeBreakpointList::RemoveTrapsFromBuffer(lldb::addr_t addr, void *buf,
   }
   return Status();
 }
+
+Status NativeBreakpointList::ReinsertTraps(lldb::addr_t addr, size_t size) {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+
+  for (const auto &map : m_breakpoints) {
+    lldb::addr_t bp_addr = map.first;
+    if (bp_addr < addr || addr + size <= bp_addr)
+      continue;
+    const auto &bp_sp = map.second;
+    if (!bp_sp->IsSoftwareBreakpoint() || !bp_sp->IsEnabled())
+      continue;
+    auto software_bp_sp = std::static_pointer_cast<SoftwareBreakpoint>(bp_sp);
+    Status error = SoftwareBreakpoint::EnableSoftwareBreakpoint(
+        software_bp_sp->m_process, bp_addr, software_bp_sp->m_opcode_size,
+        software_bp_sp->m_trap_opcodes, software_bp_sp->m_saved_opcodes);
+    if (error.Fail())
+      return error;
+  }
+  return Status();
+}
@@ -17,6 +17,9 @@
 #include "lldb/Utility/Log.h"
 #include "lldb/lldb-enumerations.h"
 
+#include <algorithm>
+#include <cstring>
+
 using namespace lldb;
 using namespace lldb_private;
 
@@ -356,6 +359,15 @@ void NativeProcessProtocol::NotifyDidExec() {
   }
 }
 
+void NativeProcessProtocol::NotifyThreadStopped(NativeThreadProtocol &thread) {
+  Log *log(GetLogIfAllCategoriesSet(LIBLLDB_LOG_PROCESS));
+  LLDB_LOG(log, "pid {0} tid {1} stopped", GetID(), thread.GetID());
+
+  std::lock_guard<std::recursive_mutex> guard(m_delegates_mutex);
+  for (auto native_delegate : m_delegates)
+    native_delegate->ThreadStopped(this, thread);
+}
+
 Status NativeProcessProtocol::SetSoftwareBreakpoint(lldb::addr_t addr,
                                                     uint32_t size_hint) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
@@ -388,6 +400,48 @@ Status NativeProcessProtocol::DisableBreakpoint(lldb::addr_t addr) {
   return m_breakpoint_list.DisableBreakpoint(addr);
 }
 
+Status NativeProcessProtocol::ReadCStringFromMemory(lldb::addr_t addr,
+                                                    char *buffer,
+                                                    size_t max_size,
+                                                    size_t &total_bytes_read) {
+  // Reads don't cross this boundary, so that a string right before an
+  // unmapped page can still be read. It is no bigger than any page size.
+  static const size_t boundary = 4096;
+
+  total_bytes_read = 0;
+  if (max_size == 0)
+    return Status("no room for the string terminator");
+
+  size_t bytes_left = max_size - 1;
+  addr_t curr_addr = addr;
+  char *curr_buffer = buffer;
+  Status status;
+  while (bytes_left > 0) {
+    size_t bytes_to_boundary = boundary - (curr_addr % boundary);
+    size_t bytes_to_read = std::min(bytes_left, bytes_to_boundary);
+    size_t bytes_read = 0;
+    status = ReadMemory(curr_addr, curr_buffer, bytes_to_read, bytes_read);
+    if (bytes_read == 0)
+      break;
+
+    void *str_end = std::memchr(curr_buffer, '\0', bytes_read);
+    if (str_end != nullptr) {
+      total_bytes_read =
+          static_cast<size_t>(static_cast<char *>(str_end) - buffer);
+      status.Clear();
+      break;
+    }
+
+    total_bytes_read += bytes_read;
+    curr_buffer += bytes_read;
+    curr_addr += bytes_read;
+    bytes_left -= bytes_read;
+  }
+
+  buffer[total_bytes_read] = '\0';
+  return status;
+}
+
 lldb::StateType NativeProcessProtocol::GetState() const {
   std::lock_guard<std::recursive_mutex> guard(m_state_mutex);
   return m_state;
@@ -10,110 +10,311 @@
 #include "lldb/Host/TaskPool.h"
 #include "lldb/Host/ThreadLauncher.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint> // for uint32_t
-#include <queue>   // for queue
-#include <thread>  // for thread
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <thread> // for thread
+#include <vector>
 
 namespace lldb_private {
 
-namespace {
 class TaskPoolImpl {
 public:
   static TaskPoolImpl &GetInstance();
 
-  void AddTask(std::function<void()> &&task_fn);
+  void AddTask(Task &&task, TaskGroup *group);
+
+  void RunUntilDone(TaskGroup &group);
+
+  void NotifyWaiters();
 
 private:
+  // Workers exit after being idle for this long, and are started again when
+  // there is work.
+  static constexpr std::chrono::milliseconds kIdleTimeout{500};
+
+  struct QueuedTask {
+    Task task;
+    // The group the task belongs to, if any.
+    TaskGroup *group;
+  };
+
+  struct Worker {
+    size_t index;
+    bool active = false;
+    std::mutex mutex;
+    // The worker takes tasks from the back, thieves from the front.
+    std::deque<QueuedTask> tasks;
+  };
+
   TaskPoolImpl();
 
-  static lldb::thread_result_t WorkerPtr(void *pool);
+  static lldb::thread_result_t WorkerPtr(void *worker);
+
+  void Run(Worker &worker);
+
+  // Find a task: in the calling worker's own queue, then in the queue of
+  // tasks added from outside the pool, then in the other workers' queues.
+  // If \a group is set, only a task of that group is taken.
+  Task FindTask(TaskGroup *group);
+
+  Task StealTask(size_t start, TaskGroup *group);
+
+  bool TakeTask(std::deque<QueuedTask> &tasks, bool from_back,
+                TaskGroup *group, Task &task);
+
+  void WakeWorker();
 
-  static void Worker(TaskPoolImpl *pool);
+  static thread_local Worker *t_worker;
 
-  std::queue<std::function<void()>> m_tasks;
-  std::mutex m_tasks_mutex;
-  uint32_t m_thread_count;
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  // The number of tasks in all queues.
+  std::atomic<size_t> m_num_queued{0};
+
+  // Protects m_tasks, the worker's active flags and the counters below.
+  std::mutex m_mutex;
+  std::deque<QueuedTask> m_tasks;
+  std::condition_variable m_workers_cv;
+  std::condition_variable m_waiters_cv;
+  size_t m_num_active = 0;
+  std::atomic<size_t> m_num_sleeping{0};
+  std::atomic<size_t> m_num_waiting{0};
 };
 
-} // end of anonymous namespace
+constexpr std::chrono::milliseconds TaskPoolImpl::kIdleTimeout;
+thread_local TaskPoolImpl::Worker *TaskPoolImpl::t_worker = nullptr;
 
 TaskPoolImpl &TaskPoolImpl::GetInstance() {
-  static TaskPoolImpl g_task_pool_impl;
-  return g_task_pool_impl;
+  // Leaked on purpose: detached workers may still be waiting for work when
+  // static destructors run.
+  static TaskPoolImpl *g_task_pool_impl = new TaskPoolImpl();
+  return *g_task_pool_impl;
+}
+
+void TaskPool::AddTaskImpl(Task &&task, TaskGroup *group) {
+  TaskPoolImpl::GetInstance().AddTask(std::move(task), group);
 }
 
-void TaskPool::AddTaskImpl(std::function<void()> &&task_fn) {
-  TaskPoolImpl::GetInstance().AddTask(std::move(task_fn));
+void TaskPool::RunUntilDone(TaskGroup &group) {
+  TaskPoolImpl::GetInstance().RunUntilDone(group);
 }
 
-TaskPoolImpl::TaskPoolImpl() : m_thread_count(0) {}
+void TaskPool::NotifyWaiters() { TaskPoolImpl::GetInstance().NotifyWaiters(); }
+
+TaskPoolImpl::TaskPoolImpl() {
+  for (size_t i = 0; i < GetHardwareConcurrencyHint(); ++i) {
+    m_workers.emplace_back(new Worker());
+    m_workers.back()->index = i;
+  }
+}
 
 unsigned GetHardwareConcurrencyHint() {
   // std::thread::hardware_concurrency may return 0 if the value is not well
   // defined or not computable.
-  static const unsigned g_hardware_concurrency = 
+  static const unsigned g_hardware_concurrency =
     std::max(1u, std::thread::hardware_concurrency());
   return g_hardware_concurrency;
 }
 
-void TaskPoolImpl::AddTask(std::function<void()> &&task_fn) {
-  const size_t min_stack_size = 8 * 1024 * 1024;
+void TaskPoolImpl::AddTask(Task &&task, TaskGroup *group) {
+  // Counted before the task can be taken, so the count never underflows.
+  if (group)
+    group->m_queued.fetch_add(1);
+  if (Worker *worker = t_worker) {
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->tasks.push_back({std::move(task), group});
+  } else {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push_back({std::move(task), group});
+  }
+  m_num_queued.fetch_add(1);
+
+  // Pairs with the check of the group's queued tasks in RunUntilDone().
+  if (group && m_num_waiting.load() > 0) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_waiters_cv.notify_all();
+  }
+  WakeWorker();
+}
+
+void TaskPoolImpl::WakeWorker() {
+  // Pairs with the check of m_num_queued in Run() before a worker sleeps.
+  if (m_num_sleeping.load() > 0) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_workers_cv.notify_one();
+    return;
+  }
 
-  std::unique_lock<std::mutex> lock(m_tasks_mutex);
-  m_tasks.emplace(std::move(task_fn));
-  if (m_thread_count < GetHardwareConcurrencyHint()) {
-    m_thread_count++;
-    // Note that this detach call needs to happen with the m_tasks_mutex held.
-    // This prevents the thread from exiting prematurely and triggering a linux
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_num_active == m_workers.size())
+    return;
+  for (auto &worker : m_workers) {
+    if (worker->active)
+      continue;
+    worker->active = true;
+    ++m_num_active;
+    const size_t min_stack_size = 8 * 1024 * 1024;
+    // Note that this detach call needs to happen with m_mutex held. This
+    // prevents the thread from exiting prematurely and triggering a linux
     // libc bug (https://sourceware.org/bugzilla/show_bug.cgi?id=19951).
     lldb_private::ThreadLauncher::LaunchThread("task-pool.worker", WorkerPtr,
-                                               this, nullptr, min_stack_size)
+                                               worker.get(), nullptr,
+                                               min_stack_size)
         .Release();
+    return;
   }
 }
 
-lldb::thread_result_t TaskPoolImpl::WorkerPtr(void *pool) {
-  Worker((TaskPoolImpl *)pool);
+lldb::thread_result_t TaskPoolImpl::WorkerPtr(void *worker) {
+  GetInstance().Run(*static_cast<Worker *>(worker));
   return 0;
 }
 
-void TaskPoolImpl::Worker(TaskPoolImpl *pool) {
+void TaskPoolImpl::Run(Worker &worker) {
+  t_worker = &worker;
   while (true) {
-    std::unique_lock<std::mutex> lock(pool->m_tasks_mutex);
-    if (pool->m_tasks.empty()) {
-      pool->m_thread_count--;
-      break;
+    if (Task task = FindTask(nullptr)) {
+      task();
+      continue;
     }
 
-    std::function<void()> f = std::move(pool->m_tasks.front());
-    pool->m_tasks.pop();
-    lock.unlock();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_num_sleeping.fetch_add(1);
+    // Pairs with the check of m_num_sleeping in WakeWorker().
+    bool timed_out = false;
+    if (m_num_queued.load() == 0)
+      timed_out = m_workers_cv.wait_for(lock, kIdleTimeout) ==
+                  std::cv_status::timeout;
+    m_num_sleeping.fetch_sub(1);
+    // Nothing can be in our own queue, since only we add to it.
+    if (timed_out && m_num_queued.load() == 0) {
+      worker.active = false;
+      --m_num_active;
+      t_worker = nullptr;
+      return;
+    }
+  }
+}
+
+bool TaskPoolImpl::TakeTask(std::deque<QueuedTask> &tasks, bool from_back,
+                            TaskGroup *group, Task &task) {
+  if (tasks.empty())
+    return false;
+  auto it = from_back ? std::prev(tasks.end()) : tasks.begin();
+  if (group) {
+    auto matches = [group](const QueuedTask &queued) {
+      return queued.group == group;
+    };
+    if (from_back) {
+      auto rit = std::find_if(tasks.rbegin(), tasks.rend(), matches);
+      if (rit == tasks.rend())
+        return false;
+      it = std::prev(rit.base());
+    } else {
+      it = std::find_if(tasks.begin(), tasks.end(), matches);
+      if (it == tasks.end())
+        return false;
+    }
+  }
+  task = std::move(it->task);
+  if (it->group)
+    it->group->m_queued.fetch_sub(1);
+  tasks.erase(it);
+  return true;
+}
+
+Task TaskPoolImpl::FindTask(TaskGroup *group) {
+  Task task;
+  if (m_num_queued.load(std::memory_order_relaxed) == 0)
+    return task;
+
+  if (Worker *worker = t_worker) {
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    TakeTask(worker->tasks, true, group, task);
+  }
+
+  if (!task) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TakeTask(m_tasks, false, group, task);
+  }
 
-    f();
+  if (!task)
+    task = StealTask(t_worker ? t_worker->index + 1 : 0, group);
+
+  if (task)
+    m_num_queued.fetch_sub(1);
+  return task;
+}
+
+Task TaskPoolImpl::StealTask(size_t start, TaskGroup *group) {
+  Task task;
+  for (size_t i = 0; i < m_workers.size() && !task; ++i) {
+    Worker &victim = *m_workers[(start + i) % m_workers.size()];
+    if (&victim == t_worker)
+      continue;
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    TakeTask(victim.tasks, false, group, task);
+  }
+  return task;
+}
+
+void TaskPoolImpl::RunUntilDone(TaskGroup &group) {
+  while (!group.IsDone()) {
+    if (Task task = FindTask(&group)) {
+      task();
+      continue;
+    }
+
+    // The group's other tasks are running on other threads. Sleep until the
+    // last of them finishes, or until one of them adds a task to the group.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_num_waiting.fetch_add(1);
+    m_waiters_cv.wait(lock, [&group] {
+      return group.IsDone() || group.m_queued.load() > 0;
+    });
+    m_num_waiting.fetch_sub(1);
   }
 }
 
+void TaskPoolImpl::NotifyWaiters() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_waiters_cv.notify_all();
+}
+
 void TaskMapOverInt(size_t begin, size_t end,
-                    const llvm::function_ref<void(size_t)> &func) {
-  const size_t num_workers = std::min<size_t>(end, GetHardwareConcurrencyHint());
+                    const llvm::function_ref<void(size_t)> &func,
+                    size_t batch_size, size_t max_parallelism) {
+  if (begin >= end)
+    return;
+  batch_size = std::max<size_t>(batch_size, 1);
+  const size_t num_batches = (end - begin + batch_size - 1) / batch_size;
+  size_t num_workers =
+      std::min<size_t>(num_batches, GetHardwareConcurrencyHint());
+  if (max_parallelism)
+    num_workers = std::min(num_workers, max_parallelism);
+
   std::atomic<size_t> idx{begin};
-  
-  auto wrapper = [&idx, end, &func]() {
+  auto wrapper = [&idx, end, batch_size, &func]() {
     while (true) {
-      size_t i = idx.fetch_add(1);
-      if (i >= end)
+      size_t batch_begin = idx.fetch_add(batch_size);
+      if (batch_begin >= end)
         break;
-      func(i);
+      size_t batch_end = std::min(end, batch_begin + batch_size);
+      for (size_t i = batch_begin; i < batch_end; ++i)
+        func(i);
     }
   };
 
-  std::vector<std::future<void>> futures;
-  futures.reserve(num_workers);
-  for (size_t i = 0; i < num_workers; i++)
-    futures.push_back(TaskPool::AddTask(wrapper));
-  for (size_t i = 0; i < num_workers; i++)
-    futures[i].wait();
+  // The calling thread is one of the workers.
+  TaskGroup group;
+  for (size_t i = 1; i < num_workers; i++)
+    group.Add(wrapper);
+  wrapper();
+  group.Wait();
 }
 
 } // namespace lldb_private
-
@@ -0,0 +1,489 @@
+//===-- ConnectionSharedMemory.cpp ------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Host/linux/ConnectionSharedMemory.h"
+
+// C Includes
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// C++ Includes
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+// Project includes
+#include "lldb/Utility/Log.h"
+#include "lldb/Utility/Logging.h"
+#include "lldb/Utility/Status.h"
+#include "lldb/Utility/Timeout.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+const char *ConnectionSharedMemory::SHM_SCHEME = "shm";
+
+namespace {
+const uint32_t kMagic = 0x4d534c4c; // "LLSM"
+const uint32_t kVersion = 2;
+
+// Where the mappings are created. Connect() refuses any other file.
+const char kPathPrefix[] = "/dev/shm/lldb-";
+
+// The size of each ring, a power of two. Large enough for the biggest
+// packets to go through in one piece.
+const uint32_t kRingSize = 1 << 20;
+
+// The rings start on the page after the header.
+const size_t kDataOffset = 4096;
+
+// How long a futex wait lasts at most before looking at the control
+// connection, to find out whether the peer went away.
+const std::chrono::milliseconds kWaitSlice(100);
+} // namespace
+
+// The indexes are free running counts of the bytes written and read, so the
+// ring is empty when they are equal and full when they are kRingSize apart.
+struct alignas(64) ConnectionSharedMemory::Ring {
+  std::atomic<uint32_t> head; // bytes written
+  std::atomic<uint32_t> tail; // bytes read
+  std::atomic<uint32_t> reader_waiting;
+  std::atomic<uint32_t> writer_waiting;
+  std::atomic<uint32_t> closed; // either side disconnected
+};
+
+struct ConnectionSharedMemory::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t ring_size;
+  std::atomic<uint32_t> mapped; // the peer of the creator mapped it
+  // rings[0] carries what the side that created the mapping writes.
+  Ring rings[2];
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "the ring indexes are used as futex words");
+
+static int Futex(std::atomic<uint32_t> &word, int op, uint32_t value,
+                 const struct timespec *timeout) {
+  // The words are shared with another process, so these are not the private
+  // futex operations.
+  return syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), op, value,
+                 timeout, nullptr, 0);
+}
+
+static void Wake(std::atomic<uint32_t> &word) {
+  Futex(word, FUTEX_WAKE, INT_MAX, nullptr);
+}
+
+ConnectionSharedMemory::ConnectionSharedMemory(ConnectionSP control_sp)
+    : Connection(), m_control_sp(std::move(control_sp)), m_path(),
+      m_created(false), m_mapping(nullptr), m_mapping_size(0),
+      m_read_ring(nullptr), m_write_ring(nullptr), m_read_data(nullptr),
+      m_write_data(nullptr), m_ring_size(0), m_wait_for_doorbell(false),
+      m_ring_doorbell(false), m_connected(false), m_peer_closed(false),
+      m_interrupted(false) {}
+
+ConnectionSharedMemory::~ConnectionSharedMemory() {
+  Disconnect(nullptr);
+  // The peer removes the file once it mapped it. Otherwise nobody else will.
+  if (m_created && !PeerMapped())
+    unlink(m_path.c_str());
+  if (m_mapping)
+    munmap(m_mapping, m_mapping_size);
+}
+
+Status ConnectionSharedMemory::Create() {
+  Log *log(lldb_private::GetLogIfAnyCategoriesSet(LIBLLDB_LOG_CONNECTION));
+  static std::atomic<uint32_t> g_count(0);
+
+  const size_t size = kDataOffset + 2 * size_t(kRingSize);
+  int fd;
+  do {
+    m_path = kPathPrefix + std::to_string(getpid()) + "-" +
+             std::to_string(g_count++);
+    fd = open(m_path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  } while (fd == -1 && errno == EEXIST);
+  if (fd == -1)
+    return Status(errno, eErrorTypePOSIX);
+  m_created = true;
+
+  Status error;
+  if (ftruncate(fd, size) == -1)
+    error.SetErrorToErrno();
+  else
+    error = Map(fd, size);
+  close(fd);
+  if (error.Fail()) {
+    unlink(m_path.c_str());
+    m_created = false;
+    return error;
+  }
+
+  // The file starts out zeroed, which is the initial state of the rings.
+  static_assert(sizeof(Header) <= kDataOffset, "the header overlaps the rings");
+  Header *header = static_cast<Header *>(m_mapping);
+  header->version = kVersion;
+  header->ring_size = kRingSize;
+  header->magic = kMagic;
+  SetRings(true);
+
+  if (log)
+    log->Printf("%p ConnectionSharedMemory::Create() => %s",
+                static_cast<void *>(this), m_path.c_str());
+  return error;
+}
+
+bool ConnectionSharedMemory::IsConnected() const { return m_connected; }
+
+bool ConnectionSharedMemory::PeerMapped() const {
+  return m_mapping && static_cast<const Header *>(m_mapping)->mapped != 0;
+}
+
+ConnectionStatus ConnectionSharedMemory::Connect(llvm::StringRef url,
+                                                 Status *error_ptr) {
+  Log *log(lldb_private::GetLogIfAnyCategoriesSet(LIBLLDB_LOG_CONNECTION));
+
+  Status error;
+  llvm::StringRef path = url;
+  if (!path.consume_front(std::string(SHM_SCHEME) + "://") ||
+      !path.startswith(kPathPrefix) || path.size() == strlen(kPathPrefix) ||
+      path.drop_front(strlen(kPathPrefix)).contains('/') ||
+      path.contains("..")) {
+    // The path comes from the peer, and the file gets mapped and removed:
+    // only accept the files Create() makes.
+    error.SetErrorStringWithFormat("invalid shared memory URI '%s'",
+                                   url.str().c_str());
+  } else {
+    int fd = open(path.str().c_str(), O_RDWR | O_CLOEXEC | O_NOFOLLOW);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1)
+      error.SetErrorToErrno();
+    else if (!S_ISREG(st.st_mode) || st.st_uid != geteuid() ||
+             (st.st_mode & 07777) != 0600)
+      // Not a file that Create() made for this user: leave it alone.
+      error.SetErrorString("shared memory file is not private to this user");
+    else if (size_t(st.st_size) < kDataOffset)
+      error.SetErrorString("shared memory file is too small");
+    else
+      error = Map(fd, st.st_size);
+    if (fd != -1)
+      close(fd);
+  }
+
+  if (error.Success()) {
+    const Header *header = static_cast<const Header *>(m_mapping);
+    const uint32_t ring_size = header->ring_size;
+    if (header->magic != kMagic || header->version != kVersion ||
+        ring_size == 0 || (ring_size & (ring_size - 1)) != 0 ||
+        m_mapping_size < kDataOffset + 2 * size_t(ring_size))
+      error.SetErrorString("not an lldb shared memory connection");
+  }
+
+  if (log)
+    log->Printf("%p ConnectionSharedMemory::Connect(%s) => %s",
+                static_cast<void *>(this), url.str().c_str(),
+                error.Success() ? "success" : error.AsCString());
+
+  if (error.Fail()) {
+    if (error_ptr)
+      *error_ptr = error;
+    return eConnectionStatusError;
+  }
+
+  // Both sides have it mapped now, nobody needs to find it anymore.
+  static_cast<Header *>(m_mapping)->mapped = 1;
+  m_path = path.str();
+  unlink(m_path.c_str());
+  SetRings(false);
+  if (error_ptr)
+    error_ptr->Clear();
+  return eConnectionStatusSuccess;
+}
+
+Status ConnectionSharedMemory::Map(int fd, size_t size) {
+  void *mapping =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED)
+    return Status(errno, eErrorTypePOSIX);
+  m_mapping = mapping;
+  m_mapping_size = size;
+  return Status();
+}
+
+void ConnectionSharedMemory::SetRings(bool creator) {
+  Header *header = static_cast<Header *>(m_mapping);
+  uint8_t *data = static_cast<uint8_t *>(m_mapping) + kDataOffset;
+  const int write_index = creator ? 0 : 1;
+
+  m_ring_size = header->ring_size;
+  m_write_ring = &header->rings[write_index];
+  m_write_data = data + write_index * m_ring_size;
+  m_read_ring = &header->rings[1 - write_index];
+  m_read_data = data + (1 - write_index) * m_ring_size;
+  m_wait_for_doorbell = !creator;
+  m_ring_doorbell = creator;
+  m_connected = true;
+}
+
+ConnectionStatus ConnectionSharedMemory::Disconnect(Status *error_ptr) {
+  if (m_connected.exchange(false)) {
+    m_write_ring->closed = 1;
+    m_read_ring->closed = 1;
+    // Wake up whoever waits on the rings, on either side.
+    Wake(m_write_ring->head);
+    Wake(m_write_ring->tail);
+    Wake(m_read_ring->head);
+    Wake(m_read_ring->tail);
+    // The control connection is only ours once both sides mapped the
+    // mapping. Until then, the creator's caller still uses it.
+    if (m_control_sp && (!m_created || PeerMapped()))
+      return m_control_sp->Disconnect(error_ptr);
+  }
+  if (error_ptr)
+    error_ptr->Clear();
+  return eConnectionStatusSuccess;
+}
+
+size_t ConnectionSharedMemory::ReadRing(void *dst, size_t dst_len) {
+  const uint32_t tail = m_read_ring->tail.load(std::memory_order_relaxed);
+  const uint32_t head = m_read_ring->head.load(std::memory_order_acquire);
+  const size_t len = std::min<size_t>(head - tail, dst_len);
+  if (len == 0)
+    return 0;
+
+  const size_t offset = tail & (m_ring_size - 1);
+  const size_t first = std::min<size_t>(len, m_ring_size - offset);
+  uint8_t *bytes = static_cast<uint8_t *>(dst);
+  memcpy(bytes, m_read_data + offset, first);
+  memcpy(bytes + first, m_read_data, len - first);
+  m_read_ring->tail = tail + len;
+
+  if (m_read_ring->writer_waiting && m_read_ring->writer_waiting.exchange(0))
+    Wake(m_read_ring->tail);
+  return len;
+}
+
+size_t ConnectionSharedMemory::Read(void *dst, size_t dst_len,
+                                    const Timeout<std::micro> &timeout,
+                                    ConnectionStatus &status,
+                                    Status *error_ptr) {
+  if (error_ptr)
+    error_ptr->Clear();
+  if (!m_connected) {
+    status = eConnectionStatusNoConnection;
+    if (error_ptr)
+      error_ptr->SetErrorString("not connected");
+    return 0;
+  }
+
+  // Whatever rang the doorbell will be found in the ring.
+  if (m_wait_for_doorbell && !DrainControl())
+    m_peer_closed = true;
+
+  Deadline deadline;
+  if (timeout)
+    deadline = std::chrono::steady_clock::now() + *timeout;
+
+  while (true) {
+    const size_t bytes_read = ReadRing(dst, dst_len);
+    if (bytes_read > 0) {
+      status = eConnectionStatusSuccess;
+      return bytes_read;
+    }
+    if (PeerClosed()) {
+      status = eConnectionStatusEndOfFile;
+      return 0;
+    }
+    if (m_interrupted.exchange(false)) {
+      status = eConnectionStatusInterrupted;
+      return 0;
+    }
+
+    // Tell the writer we are going to wait before looking at the ring one
+    // last time, so that either we see its data or it sees us waiting.
+    m_read_ring->reader_waiting = 1;
+    const uint32_t head = m_read_ring->head;
+    if (head != m_read_ring->tail.load(std::memory_order_relaxed))
+      continue;
+    if (timeout && *timeout == std::chrono::microseconds::zero()) {
+      status = eConnectionStatusTimedOut;
+      return 0;
+    }
+
+    status = m_wait_for_doorbell ? WaitForDoorbell(deadline)
+                                 : Wait(m_read_ring->head, head, deadline,
+                                        /*interruptible=*/true);
+    if (status == eConnectionStatusTimedOut)
+      return 0;
+  }
+}
+
+size_t ConnectionSharedMemory::Write(const void *src, size_t src_len,
+                                     ConnectionStatus &status,
+                                     Status *error_ptr) {
+  if (error_ptr)
+    error_ptr->Clear();
+  if (!m_connected) {
+    status = eConnectionStatusNoConnection;
+    if (error_ptr)
+      error_ptr->SetErrorString("not connected");
+    return 0;
+  }
+
+  const uint8_t *bytes = static_cast<const uint8_t *>(src);
+  size_t bytes_written = 0;
+  while (bytes_written < src_len) {
+    if (PeerClosed()) {
+      status = eConnectionStatusLostConnection;
+      if (error_ptr)
+        error_ptr->SetErrorString("the peer closed the connection");
+      return bytes_written;
+    }
+
+    const uint32_t head = m_write_ring->head.load(std::memory_order_relaxed);
+    const uint32_t tail = m_write_ring->tail.load(std::memory_order_acquire);
+    const size_t space = m_ring_size - (head - tail);
+    if (space == 0) {
+      // Wait for the reader to make room, the same way it waits for data.
+      m_write_ring->writer_waiting = 1;
+      if (m_write_ring->tail == tail)
+        Wait(m_write_ring->tail, tail, llvm::None, /*interruptible=*/false);
+      continue;
+    }
+
+    const size_t len = std::min(space, src_len - bytes_written);
+    const size_t offset = head & (m_ring_size - 1);
+    const size_t first = std::min<size_t>(len, m_ring_size - offset);
+    memcpy(m_write_data + offset, bytes + bytes_written, first);
+    memcpy(m_write_data, bytes + bytes_written + first, len - first);
+    m_write_ring->head = head + len;
+    bytes_written += len;
+
+    if (m_write_ring->reader_waiting &&
+        m_write_ring->reader_waiting.exchange(0)) {
+      if (m_ring_doorbell) {
+        const char doorbell = 0;
+        ConnectionStatus control_status;
+        m_control_sp->Write(&doorbell, 1, control_status, nullptr);
+      } else {
+        Wake(m_write_ring->head);
+      }
+    }
+  }
+
+  status = eConnectionStatusSuccess;
+  return bytes_written;
+}
+
+ConnectionStatus ConnectionSharedMemory::Wait(std::atomic<uint32_t> &word,
+                                              uint32_t value,
+                                              const Deadline &deadline,
+                                              bool interruptible) {
+  while (word == value) {
+    if (PeerClosed() || (interruptible && m_interrupted))
+      return eConnectionStatusSuccess;
+
+    std::chrono::steady_clock::duration slice = kWaitSlice;
+    if (deadline) {
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= *deadline)
+        return eConnectionStatusTimedOut;
+      slice = std::min(slice, *deadline - now);
+    }
+
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(slice).count();
+    struct timespec ts;
+    ts.tv_sec = nsec / 1000000000;
+    ts.tv_nsec = nsec % 1000000000;
+    if (Futex(word, FUTEX_WAIT, value, &ts) == -1 && errno == ETIMEDOUT &&
+        !DrainControl())
+      m_peer_closed = true;
+  }
+  return eConnectionStatusSuccess;
+}
+
+ConnectionStatus
+ConnectionSharedMemory::WaitForDoorbell(const Deadline &deadline) {
+  Timeout<std::micro> timeout(llvm::None);
+  if (deadline)
+    timeout = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::max(*deadline - std::chrono::steady_clock::now(),
+                 std::chrono::steady_clock::duration::zero()));
+
+  char buffer[64];
+  ConnectionStatus status;
+  m_control_sp->Read(buffer, sizeof(buffer), timeout, status, nullptr);
+  switch (status) {
+  case eConnectionStatusSuccess:
+    return eConnectionStatusSuccess;
+  case eConnectionStatusTimedOut:
+    return eConnectionStatusTimedOut;
+  case eConnectionStatusInterrupted:
+    m_interrupted = true;
+    return eConnectionStatusSuccess;
+  default:
+    m_peer_closed = true;
+    return eConnectionStatusSuccess;
+  }
+}
+
+bool ConnectionSharedMemory::DrainControl() {
+  if (!m_control_sp)
+    return true;
+
+  char buffer[64];
+  while (true) {
+    ConnectionStatus status;
+    const size_t bytes_read =
+        m_control_sp->Read(buffer, sizeof(buffer),
+                           std::chrono::microseconds(0), status, nullptr);
+    switch (status) {
+    case eConnectionStatusSuccess:
+      if (bytes_read < sizeof(buffer))
+        return true;
+      break;
+    case eConnectionStatusTimedOut:
+    case eConnectionStatusInterrupted:
+      return true;
+    default:
+      return false;
+    }
+  }
+}
+
+bool ConnectionSharedMemory::PeerClosed() {
+  if (m_peer_closed)
+    return true;
+  if (m_read_ring->closed || m_write_ring->closed)
+    m_peer_closed = true;
+  return m_peer_closed;
+}
+
+std::string ConnectionSharedMemory::GetURI() {
+  return std::string(SHM_SCHEME) + "://" + m_path;
+}
+
+bool ConnectionSharedMemory::InterruptRead() {
+  m_interrupted = true;
+  if (m_read_ring)
+    Wake(m_read_ring->head);
+  if (m_wait_for_doorbell && m_control_sp)
+    m_control_sp->InterruptRead();
+  return true;
+}
+
+IOObjectSP ConnectionSharedMemory::GetReadObject() {
+  return m_control_sp ? m_control_sp->GetReadObject() : IOObjectSP();
+}
@@ -29,6 +29,36 @@ lldb::OptionValueSP OptionValueUInt64::Create(llvm::StringRef value_str,
   return value_sp;
 }
 
+// Parse a number, optionally followed by a K, M or G (KB, MB, GB, KiB, ...)
+// suffix that multiplies it by a power of 1024.
+static bool ParseUInt64WithSizeSuffix(llvm::StringRef str, uint64_t &value) {
+  size_t digits = str.find_first_not_of("0123456789");
+  if (digits == 0 || digits == llvm::StringRef::npos)
+    return false;
+  const std::string suffix = str.drop_front(digits).trim().lower();
+  unsigned shift;
+  switch (suffix.empty() ? 0 : suffix[0]) {
+  case 'k':
+    shift = 10;
+    break;
+  case 'm':
+    shift = 20;
+    break;
+  case 'g':
+    shift = 30;
+    break;
+  default:
+    return false;
+  }
+  if (suffix.size() > 1 && suffix.substr(1) != "b" && suffix.substr(1) != "ib")
+    return false;
+  if (str.take_front(digits).getAsInteger(10, value) ||
+      value > (UINT64_MAX >> shift))
+    return false;
+  value <<= shift;
+  return true;
+}
+
 void OptionValueUInt64::DumpValue(const ExecutionContext *exe_ctx, Stream &strm,
                                   uint32_t dump_mask) {
   if (dump_mask & eDumpOptionType)
@@ -54,6 +84,8 @@ Status OptionValueUInt64::SetValueFromString(llvm::StringRef value_ref,
     bool success = false;
     std::string value_str = value_ref.trim().str();
     uint64_t value = StringConvert::ToUInt64(value_str.c_str(), 0, 0, &success);
+    if (!success)
+      success = ParseUInt64WithSizeSuffix(value_str, value);
     if (success) {
       m_value_was_set = true;
       m_current_value = value;
@@ -15,11 +15,14 @@
 #include "lldb/Target/Process.h"
 #include "lldb/Target/Target.h"
 #include "lldb/Utility/ArchSpec.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/Log.h"
 #include "lldb/Utility/Status.h"
 
 #include "llvm/Support/Path.h"
 
+#include <set>
+
 #include "DYLDRendezvous.h"
 
 using namespace lldb;
@@ -182,10 +185,17 @@ bool DYLDRendezvous::IsValid() {
 bool DYLDRendezvous::UpdateSOEntries(bool fromRemote) {
   SOEntry entry;
   LoadedModuleInfoList module_list;
-
-  // If we can't get the SO info from the remote, return failure.
-  if (fromRemote && m_process->LoadModules(module_list) == 0)
-    return false;
+  const bool transitioning =
+      m_current.state == eAdd || m_current.state == eDelete;
+
+  // If we can't get the SO info from the remote, return failure. While a
+  // library is being added or removed the list is still the one we got at the
+  // last consistent state, so don't ask for it again.
+  if (fromRemote && !(transitioning && !m_loaded_modules.m_list.empty())) {
+    Status error = m_process->GetLoadedModuleList(module_list);
+    if (error.Fail() || module_list.m_list.empty())
+      return false;
+  }
 
   if (!fromRemote && m_current.map_addr == 0)
     return false;
@@ -199,7 +209,7 @@ bool DYLDRendezvous::UpdateSOEntries(bool fromRemote) {
 
   // If we are about to add or remove a shared object clear out the current
   // state and take a snapshot of the currently loaded images.
-  if (m_current.state == eAdd || m_current.state == eDelete) {
+  if (transitioning) {
     // Some versions of the android dynamic linker might send two notifications
     // with state == eAdd back to back. Ignore them until we get an eConsistent
     // notification.
@@ -207,12 +217,17 @@ bool DYLDRendezvous::UpdateSOEntries(bool fromRemote) {
           (m_previous.state == eAdd && m_current.state == eDelete)))
       return false;
 
-    m_soentries.clear();
-    if (fromRemote)
-      return SaveSOEntriesFromRemote(module_list);
-
     m_added_soentries.clear();
     m_removed_soentries.clear();
+    if (fromRemote) {
+      // m_soentries already matches m_loaded_modules.
+      if (module_list.m_list.empty())
+        return true;
+      m_soentries.clear();
+      return SaveSOEntriesFromRemote(module_list);
+    }
+
+    m_soentries.clear();
     return TakeSnapshot(m_soentries);
   }
   assert(m_current.state == eConsistent);
@@ -271,17 +286,29 @@ bool DYLDRendezvous::SaveSOEntriesFromRemote(
   return true;
 }
 
+// A library is identified by its link map entry and its name; the runtime
+// linker may reuse the memory of an unloaded library's entry for a new one.
+typedef std::pair<addr_t, std::string> ModuleKey;
+
+static ModuleKey
+GetModuleKey(LoadedModuleInfoList::LoadedModuleInfo const &modInfo) {
+  ModuleKey key;
+  modInfo.get_link_map(key.first);
+  modInfo.get_name(key.second);
+  return key;
+}
+
+static std::set<ModuleKey> GetModuleKeys(LoadedModuleInfoList &module_list) {
+  std::set<ModuleKey> keys;
+  for (auto const &modInfo : module_list.m_list)
+    keys.insert(GetModuleKey(modInfo));
+  return keys;
+}
+
 bool DYLDRendezvous::AddSOEntriesFromRemote(LoadedModuleInfoList &module_list) {
+  const std::set<ModuleKey> existing = GetModuleKeys(m_loaded_modules);
   for (auto const &modInfo : module_list.m_list) {
-    bool found = false;
-    for (auto const &existing : m_loaded_modules.m_list) {
-      if (modInfo == existing) {
-        found = true;
-        break;
-      }
-    }
-
-    if (found)
+    if (existing.count(GetModuleKey(modInfo)))
       continue;
 
     SOEntry entry;
@@ -289,8 +316,10 @@ bool DYLDRendezvous::AddSOEntriesFromRemote(LoadedModuleInfoList &module_list) {
       return false;
 
     // Only add shared libraries and not the executable.
-    if (!SOEntryIsMainExecutable(entry))
+    if (!SOEntryIsMainExecutable(entry)) {
       m_soentries.push_back(entry);
+      m_added_soentries.push_back(entry);
+    }
   }
 
   m_loaded_modules = module_list;
@@ -299,16 +328,10 @@ bool DYLDRendezvous::AddSOEntriesFromRemote(LoadedModuleInfoList &module_list) {
 
 bool DYLDRendezvous::RemoveSOEntriesFromRemote(
     LoadedModuleInfoList &module_list) {
+  const std::set<ModuleKey> current = GetModuleKeys(module_list);
+  std::set<addr_t> removed_link_maps;
   for (auto const &existing : m_loaded_modules.m_list) {
-    bool found = false;
-    for (auto const &modInfo : module_list.m_list) {
-      if (modInfo == existing) {
-        found = true;
-        break;
-      }
-    }
-
-    if (found)
+    if (current.count(GetModuleKey(existing)))
       continue;
 
     SOEntry entry;
@@ -317,14 +340,23 @@ bool DYLDRendezvous::RemoveSOEntriesFromRemote(
 
     // Only add shared libraries and not the executable.
     if (!SOEntryIsMainExecutable(entry)) {
-      auto pos = std::find(m_soentries.begin(), m_soentries.end(), entry);
-      if (pos == m_soentries.end())
-        return false;
-
-      m_soentries.erase(pos);
+      removed_link_maps.insert(entry.link_addr);
+      m_removed_soentries.push_back(entry);
     }
   }
 
+  if (!removed_link_maps.empty()) {
+    const size_t num_entries = m_soentries.size();
+    m_soentries.erase(
+        std::remove_if(m_soentries.begin(), m_soentries.end(),
+                       [&](const SOEntry &entry) {
+                         return removed_link_maps.count(entry.link_addr) != 0;
+                       }),
+        m_soentries.end());
+    if (num_entries - m_soentries.size() != removed_link_maps.size())
+      return false;
+  }
+
   m_loaded_modules = module_list;
   return true;
 }
@@ -484,37 +516,41 @@ bool DYLDRendezvous::ReadSOEntryFromMemory(lldb::addr_t addr, SOEntry &entry) {
 
   entry.link_addr = addr;
 
-  if (!(addr = ReadPointer(addr, &entry.base_addr)))
-    return false;
-
   // mips adds an extra load offset field to the link map struct on FreeBSD and
   // NetBSD (need to validate other OSes).
   // http://svnweb.freebsd.org/base/head/sys/sys/link_elf.h?revision=217153&view=markup#l57
   const ArchSpec &arch = m_process->GetTarget().GetArchitecture();
-  if ((arch.GetTriple().getOS() == llvm::Triple::FreeBSD ||
+  const bool has_mips_l_offs =
+      (arch.GetTriple().getOS() == llvm::Triple::FreeBSD ||
        arch.GetTriple().getOS() == llvm::Triple::NetBSD) &&
       (arch.GetMachine() == llvm::Triple::mips ||
        arch.GetMachine() == llvm::Triple::mipsel ||
        arch.GetMachine() == llvm::Triple::mips64 ||
-       arch.GetMachine() == llvm::Triple::mips64el)) {
-    addr_t mips_l_offs;
-    if (!(addr = ReadPointer(addr, &mips_l_offs)))
-      return false;
-    if (mips_l_offs != 0 && mips_l_offs != entry.base_addr)
-      return false;
-  }
-
-  if (!(addr = ReadPointer(addr, &entry.path_addr)))
-    return false;
-
-  if (!(addr = ReadPointer(addr, &entry.dyn_addr)))
-    return false;
+       arch.GetMachine() == llvm::Triple::mips64el);
 
-  if (!(addr = ReadPointer(addr, &entry.next)))
+  // Read the whole entry at once rather than a pointer at a time; this is a
+  // round trip per read when debugging remotely.
+  const uint32_t addr_size = m_process->GetAddressByteSize();
+  const size_t num_fields = has_mips_l_offs ? 6 : 5;
+  uint8_t buffer[6 * sizeof(addr_t)];
+  Status error;
+  if (m_process->ReadMemory(addr, buffer, num_fields * addr_size, error) !=
+      num_fields * addr_size)
     return false;
+  DataExtractor data(buffer, num_fields * addr_size,
+                     m_process->GetByteOrder(), addr_size);
+  lldb::offset_t offset = 0;
 
-  if (!(addr = ReadPointer(addr, &entry.prev)))
-    return false;
+  entry.base_addr = data.GetAddress(&offset);
+  if (has_mips_l_offs) {
+    addr_t mips_l_offs = data.GetAddress(&offset);
+    if (mips_l_offs != 0 && mips_l_offs != entry.base_addr)
+      return false;
+  }
+  entry.path_addr = data.GetAddress(&offset);
+  entry.dyn_addr = data.GetAddress(&offset);
+  entry.next = data.GetAddress(&offset);
+  entry.prev = data.GetAddress(&offset);
 
   std::string file_path = ReadStringFromMemory(entry.path_addr);
   entry.file_spec.SetFile(file_path, false, FileSpec::Style::native);
@@ -19,6 +19,7 @@
 #include "lldb/Core/ModuleSpec.h"
 #include "lldb/Core/PluginManager.h"
 #include "lldb/Core/Section.h"
+#include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/Function.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Target/MemoryRegionInfo.h"
@@ -28,6 +29,7 @@
 #include "lldb/Target/Thread.h"
 #include "lldb/Target/ThreadPlanRunToAddress.h"
 #include "lldb/Utility/Log.h"
+#include "lldb/Utility/Timer.h"
 
 // C++ Includes
 // C Includes
@@ -428,7 +430,14 @@ void DynamicLoaderPOSIXDYLD::RefreshModules() {
   if (m_rendezvous.ModulesDidLoad()) {
     ModuleList new_modules;
 
+    std::vector<FileSpec> module_names;
     E = m_rendezvous.loaded_end();
+    for (I = m_rendezvous.loaded_begin(); I != E; ++I)
+      module_names.push_back(I->file_spec);
+    m_process->PrefetchModuleSpecs(
+        module_names, m_process->GetTarget().GetArchitecture().GetTriple());
+    PrepareModules(module_names);
+
     for (I = m_rendezvous.loaded_begin(); I != E; ++I) {
       ModuleSP module_sp =
           LoadModuleAtAddress(I->file_spec, I->link_addr, I->base_addr, true);
@@ -580,6 +589,7 @@ void DynamicLoaderPOSIXDYLD::LoadAllCurrentModules() {
     module_names.push_back(I->file_spec);
   m_process->PrefetchModuleSpecs(
       module_names, m_process->GetTarget().GetArchitecture().GetTriple());
+  PrepareModules(module_names);
 
   for (I = m_rendezvous.begin(), E = m_rendezvous.end(); I != E; ++I) {
     ModuleSP module_sp =
@@ -600,6 +610,46 @@ void DynamicLoaderPOSIXDYLD::LoadAllCurrentModules() {
   m_process->GetTarget().ModulesDidLoad(module_list);
 }
 
+void DynamicLoaderPOSIXDYLD::PrepareModules(
+    const std::vector<FileSpec> &files) {
+  Target &target = m_process->GetTarget();
+  PlatformSP platform_sp = target.GetPlatform();
+  if (files.size() < 2 || !platform_sp || !target.GetParallelModuleLoad())
+    return;
+
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, "%s (%zu modules)", LLVM_PRETTY_FUNCTION,
+                     files.size());
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_DYNAMIC_LOADER));
+  LLDB_LOG(log, "preparing {0} modules in parallel", files.size());
+
+  const ArchSpec arch = target.GetArchitecture();
+  const FileSpecList search_paths = target.GetExecutableSearchPaths();
+  Process *process = m_process;
+  const bool preload_symbols = target.GetPreloadSymbols();
+
+  TaskMapOverInt(0, files.size(), [&](size_t idx) {
+    ModuleSpec module_spec(files[idx], arch);
+    ModuleSP module_sp = target.GetImages().FindFirstModule(module_spec);
+    // The platform leaves the module in the global module list, where
+    // Target::GetSharedModule() will find it again.
+    if (!module_sp)
+      platform_sp->GetSharedModule(module_spec, process, module_sp,
+                                   &search_paths, nullptr, nullptr);
+    if (!module_sp)
+      return;
+
+    // All of these are computed once and cached by the module. Indexing
+    // DWARF uses the task pool itself, which is fine: waiting on it from a
+    // pool thread runs the queued tasks.
+    module_sp->GetUUID();
+    module_sp->GetSectionList();
+    module_sp->GetSymbolVendor();
+    if (preload_symbols)
+      module_sp->PreloadSymbols();
+  });
+}
+
 addr_t DynamicLoaderPOSIXDYLD::ComputeLoadOffset() {
   addr_t virt_entry;
 
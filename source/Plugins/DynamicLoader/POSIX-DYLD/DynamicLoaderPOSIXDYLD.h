@@ -142,6 +142,14 @@ protected:
   /// of all dependent modules.
   virtual void LoadAllCurrentModules();
 
+  /// Locates the modules for @p files and parses their object files and
+  /// symbol files on the task pool.
+  ///
+  /// None of this touches the target, so the LoadModuleAtAddress() calls
+  /// that follow still add the modules and their sections to the target in
+  /// order, but find all the expensive work done already.
+  void PrepareModules(const std::vector<lldb_private::FileSpec> &files);
+
   void LoadVDSO();
 
   // Loading an interpreter module (if present) assumming m_interpreter_base
@@ -51,9 +51,14 @@
 #include "lldb/Utility/ConstString.h"
 #include "lldb/Utility/Log.h"
 #include "lldb/Utility/StreamString.h"
+#include "lldb/Utility/Timer.h"
 
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclObjC.h"
+#include "clang/Basic/IdentifierTable.h"
+#include "clang/Lex/Lexer.h"
+
+#include "llvm/ADT/StringSet.h"
 
 using namespace lldb_private;
 
@@ -406,6 +411,59 @@ llvm::Optional<lldb::LanguageType> ClangUserExpression::GetLanguageForExpr(
   return lang_type;
 }
 
+// Return the identifiers in the expression that aren't keywords, in the order
+// they first appear.
+static std::vector<ConstString> GetIdentifiers(llvm::StringRef expr) {
+  const size_t kMaxIdentifiers = 64;
+  clang::LangOptions lang_opts;
+  lang_opts.CPlusPlus = true;
+  lang_opts.CPlusPlus11 = true;
+  lang_opts.ObjC1 = true;
+  lang_opts.ObjC2 = true;
+  clang::IdentifierTable keywords(lang_opts);
+  clang::Lexer lexer(clang::SourceLocation(), lang_opts, expr.begin(),
+                     expr.begin(), expr.end());
+
+  std::vector<ConstString> names;
+  llvm::StringSet<> seen;
+  clang::Token token;
+  lexer.LexFromRawLexer(token);
+  while (token.isNot(clang::tok::eof) && names.size() < kMaxIdentifiers) {
+    if (token.is(clang::tok::raw_identifier)) {
+      llvm::StringRef name = token.getRawIdentifier();
+      if (keywords.get(name).getTokenID() == clang::tok::identifier &&
+          seen.insert(name).second)
+        names.push_back(ConstString(name));
+    }
+    lexer.LexFromRawLexer(token);
+  }
+  return names;
+}
+
+void ClangUserExpression::PrefetchTypes(ExecutionContext &exe_ctx) {
+  Target *target = exe_ctx.GetTargetPtr();
+  if (!target || !target->GetPrefetchExpressionTypes())
+    return;
+
+  std::vector<ConstString> names = GetIdentifiers(m_expr_text);
+  if (names.empty())
+    return;
+
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, LLVM_PRETTY_FUNCTION);
+
+  // One module at a time: resolving a type under one module's lock can look
+  // up types in other modules, for example with -gmodules, and take their
+  // locks. Each module still reads its debug information in parallel.
+  std::vector<lldb::ModuleSP> modules;
+  target->GetImages().ForEach([&modules](const lldb::ModuleSP &module_sp) {
+    modules.push_back(module_sp);
+    return true;
+  });
+  for (const lldb::ModuleSP &module_sp : modules)
+    module_sp->PrefetchTypes(names);
+}
+
 bool ClangUserExpression::PrepareForParsing(
     DiagnosticManager &diagnostic_manager, ExecutionContext &exe_ctx) {
   InstallContext(exe_ctx);
@@ -490,6 +548,10 @@ bool ClangUserExpression::Parse(DiagnosticManager &diagnostic_manager,
   // succeeds or the rewrite parser we might make if it fails.  But the
   // parser_sp will never be empty.
 
+  // Read the debug information for the types the expression mentions before
+  // clang asks for them one at a time.
+  PrefetchTypes(exe_ctx);
+
   ClangExpressionParser parser(exe_scope, *this, generate_debug_info);
 
   unsigned num_errors = parser.Parse(diagnostic_manager);
@@ -180,6 +180,7 @@ private:
                                    ExecutionContext &exe_ctx);
   bool PrepareForParsing(DiagnosticManager &diagnostic_manager,
                          ExecutionContext &exe_ctx);
+  void PrefetchTypes(ExecutionContext &exe_ctx);
 
   ClangUserExpressionHelper m_type_system_helper;
 
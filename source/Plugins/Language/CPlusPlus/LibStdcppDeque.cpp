@@ -0,0 +1,248 @@
+//===-- LibStdcppDeque.cpp --------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibStdcpp.h"
+
+// C Includes
+// C++ Includes
+// Other libraries and framework includes
+// Project includes
+#include "lldb/Core/ValueObject.h"
+#include "lldb/DataFormatters/FormattersHelpers.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Target/Target.h"
+#include "lldb/Utility/DataExtractor.h"
+#include "lldb/Utility/Status.h"
+#include "lldb/Utility/Stream.h"
+
+using namespace lldb;
+using namespace lldb_private;
+using namespace lldb_private::formatters;
+
+namespace {
+
+/*
+ (std::deque<int, std::allocator<int> >) d = {
+   (std::_Deque_base<int, std::allocator<int> >) _M_impl = {
+     (std::_Deque_base<...>::_Map_pointer) _M_map = 0x0000000000614c20
+     (std::size_t) _M_map_size = 8
+     (std::_Deque_base<...>::iterator) _M_start = {
+       (int *) _M_cur = 0x0000000000614c70
+       (int *) _M_first = 0x0000000000614c70
+       (int *) _M_last = 0x0000000000614e70
+       (std::_Deque_iterator<...>::_Map_pointer) _M_node = 0x0000000000614c38
+     }
+     (std::_Deque_base<...>::iterator) _M_finish = { ... }
+   }
+ }
+
+ The elements live in fixed size buffers that are referenced from the
+ _M_map array. The buffer pointers for everything that is displayed are
+ fetched from _M_map with a single memory read, after which every element
+ address can be computed without touching the inferior again.
+ */
+class LibStdcppDequeSyntheticFrontEnd : public SyntheticChildrenFrontEnd {
+public:
+  explicit LibStdcppDequeSyntheticFrontEnd(lldb::ValueObjectSP valobj_sp);
+
+  size_t CalculateNumChildren() override;
+
+  lldb::ValueObjectSP GetChildAtIndex(size_t idx) override;
+
+  bool Update() override;
+
+  bool MightHaveChildren() override;
+
+  size_t GetIndexOfChildWithName(const ConstString &name) override;
+
+private:
+  struct DequeIterator {
+    lldb::addr_t cur = 0;
+    lldb::addr_t first = 0;
+    lldb::addr_t last = 0;
+    lldb::addr_t node = 0;
+  };
+
+  static bool ReadIterator(ValueObject &iter, DequeIterator &result);
+
+  // Read the buffer pointers covering the first |count| elements.
+  bool FetchBuffers(size_t count);
+
+  ExecutionContextRef m_exe_ctx_ref;
+  CompilerType m_element_type;
+  uint64_t m_element_size;
+  uint64_t m_buffer_size; // Elements per buffer.
+  uint64_t m_start_offset; // Index of the first element in the first buffer.
+  DequeIterator m_start;
+  size_t m_count;
+  size_t m_list_capping_size;
+  std::vector<lldb::addr_t> m_buffers;
+};
+
+} // end of anonymous namespace
+
+LibStdcppDequeSyntheticFrontEnd::LibStdcppDequeSyntheticFrontEnd(
+    lldb::ValueObjectSP valobj_sp)
+    : SyntheticChildrenFrontEnd(*valobj_sp), m_exe_ctx_ref(), m_element_type(),
+      m_element_size(0), m_buffer_size(0), m_start_offset(0), m_start(),
+      m_count(0), m_list_capping_size(0), m_buffers() {
+  if (valobj_sp)
+    Update();
+}
+
+bool LibStdcppDequeSyntheticFrontEnd::ReadIterator(ValueObject &iter,
+                                                   DequeIterator &result) {
+  ValueObjectSP cur_sp(iter.GetChildMemberWithName(ConstString("_M_cur"), true));
+  ValueObjectSP first_sp(
+      iter.GetChildMemberWithName(ConstString("_M_first"), true));
+  ValueObjectSP last_sp(
+      iter.GetChildMemberWithName(ConstString("_M_last"), true));
+  ValueObjectSP node_sp(
+      iter.GetChildMemberWithName(ConstString("_M_node"), true));
+  if (!cur_sp || !first_sp || !last_sp || !node_sp)
+    return false;
+  result.cur = cur_sp->GetValueAsUnsigned(0);
+  result.first = first_sp->GetValueAsUnsigned(0);
+  result.last = last_sp->GetValueAsUnsigned(0);
+  result.node = node_sp->GetValueAsUnsigned(0);
+  return result.cur >= result.first && result.cur <= result.last &&
+         result.node != 0;
+}
+
+bool LibStdcppDequeSyntheticFrontEnd::Update() {
+  m_count = 0;
+  m_buffers.clear();
+
+  ValueObjectSP valobj_sp = m_backend.GetSP();
+  if (!valobj_sp)
+    return false;
+  m_exe_ctx_ref = valobj_sp->GetExecutionContextRef();
+
+  m_list_capping_size = 0;
+  if (TargetSP target_sp = valobj_sp->GetTargetSP())
+    m_list_capping_size = target_sp->GetMaximumNumberOfChildrenToDisplay();
+  if (m_list_capping_size == 0)
+    m_list_capping_size = 255;
+
+  CompilerType deque_type = valobj_sp->GetCompilerType();
+  if (deque_type.IsReferenceType())
+    deque_type = deque_type.GetNonReferenceType();
+  if (deque_type.GetNumTemplateArguments() == 0)
+    return false;
+  m_element_type = deque_type.GetTypeTemplateArgument(0);
+  if (!m_element_type)
+    return false;
+  m_element_size = m_element_type.GetByteSize(nullptr);
+  if (m_element_size == 0)
+    return false;
+
+  ValueObjectSP start_sp(valobj_sp->GetChildAtNamePath(
+      {ConstString("_M_impl"), ConstString("_M_start")}));
+  ValueObjectSP finish_sp(valobj_sp->GetChildAtNamePath(
+      {ConstString("_M_impl"), ConstString("_M_finish")}));
+  if (!start_sp || !finish_sp)
+    return false;
+
+  DequeIterator finish;
+  if (!ReadIterator(*start_sp, m_start) || !ReadIterator(*finish_sp, finish))
+    return false;
+  if (finish.node < m_start.node)
+    return false;
+
+  // All buffers have the same size, so derive it from the first one rather
+  // than hardcoding the _GLIBCXX_DEQUE_BUF_SIZE heuristic.
+  if (m_start.last <= m_start.first)
+    return false;
+  m_buffer_size = (m_start.last - m_start.first) / m_element_size;
+  if (m_buffer_size == 0)
+    return false;
+  m_start_offset = (m_start.cur - m_start.first) / m_element_size;
+
+  ProcessSP process_sp(valobj_sp->GetProcessSP());
+  if (!process_sp)
+    return false;
+  const uint64_t num_nodes =
+      (finish.node - m_start.node) / process_sp->GetAddressByteSize();
+
+  // Elements left in the first buffer, plus all the full buffers in between,
+  // plus the elements used in the last buffer.
+  const uint64_t used = (num_nodes * m_buffer_size) +
+                        (finish.cur - finish.first) / m_element_size;
+  if (used < m_start_offset)
+    return false;
+  m_count = used - m_start_offset;
+  return false;
+}
+
+bool LibStdcppDequeSyntheticFrontEnd::FetchBuffers(size_t count) {
+  ProcessSP process_sp(m_backend.GetProcessSP());
+  if (!process_sp)
+    return false;
+  const uint32_t addr_size = process_sp->GetAddressByteSize();
+
+  const size_t num_buffers =
+      (m_start_offset + count + m_buffer_size - 1) / m_buffer_size;
+  if (num_buffers <= m_buffers.size())
+    return true;
+
+  // Fetch all the missing buffer pointers in one go.
+  const size_t first = m_buffers.size();
+  const size_t size = (num_buffers - first) * addr_size;
+  std::vector<uint8_t> buffer(size);
+  Status error;
+  if (process_sp->ReadMemory(m_start.node + first * addr_size, buffer.data(),
+                             size, error) != size ||
+      error.Fail())
+    return false;
+
+  DataExtractor data(buffer.data(), size, process_sp->GetByteOrder(),
+                     addr_size);
+  lldb::offset_t offset = 0;
+  while (m_buffers.size() < num_buffers)
+    m_buffers.push_back(data.GetAddress(&offset));
+  return true;
+}
+
+size_t LibStdcppDequeSyntheticFrontEnd::CalculateNumChildren() {
+  return m_count;
+}
+
+lldb::ValueObjectSP
+LibStdcppDequeSyntheticFrontEnd::GetChildAtIndex(size_t idx) {
+  if (idx >= CalculateNumChildren())
+    return lldb::ValueObjectSP();
+
+  // Grab the buffers for everything that will be displayed at once.
+  if (!FetchBuffers(std::max(idx + 1, std::min(m_count, m_list_capping_size))))
+    return lldb::ValueObjectSP();
+
+  const uint64_t offset = m_start_offset + idx;
+  const lldb::addr_t buffer = m_buffers[offset / m_buffer_size];
+  if (buffer == 0)
+    return lldb::ValueObjectSP();
+
+  StreamString name;
+  name.Printf("[%" PRIu64 "]", (uint64_t)idx);
+  return CreateValueObjectFromAddress(
+      name.GetString(), buffer + (offset % m_buffer_size) * m_element_size,
+      m_exe_ctx_ref, m_element_type);
+}
+
+bool LibStdcppDequeSyntheticFrontEnd::MightHaveChildren() { return true; }
+
+size_t LibStdcppDequeSyntheticFrontEnd::GetIndexOfChildWithName(
+    const ConstString &name) {
+  return ExtractIndexFromString(name.GetCString());
+}
+
+SyntheticChildrenFrontEnd *
+lldb_private::formatters::LibStdcppDequeSyntheticFrontEndCreator(
+    CXXSyntheticChildren *, lldb::ValueObjectSP valobj_sp) {
+  return (valobj_sp ? new LibStdcppDequeSyntheticFrontEnd(valobj_sp) : nullptr);
+}
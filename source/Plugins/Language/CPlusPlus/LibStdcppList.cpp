@@ -0,0 +1,220 @@
+//===-- LibStdcppList.cpp ---------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibStdcpp.h"
+
+// C Includes
+// C++ Includes
+// Other libraries and framework includes
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/MathExtras.h"
+
+// Project includes
+#include "lldb/Core/ValueObject.h"
+#include "lldb/DataFormatters/FormattersHelpers.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Target/Target.h"
+#include "lldb/Utility/Status.h"
+#include "lldb/Utility/Stream.h"
+
+using namespace lldb;
+using namespace lldb_private;
+using namespace lldb_private::formatters;
+
+namespace {
+
+/*
+ (std::__cxx11::list<int, std::allocator<int> >) numbers_list = {
+   (std::__cxx11::_List_base<int, std::allocator<int> >) _M_impl = {
+     (std::__detail::_List_node_header) _M_node = {
+       (std::__detail::_List_node_base *) _M_next = 0x0000000000614c20
+       (std::__detail::_List_node_base *) _M_prev = 0x0000000000614c80
+       (std::size_t) _M_size = 4
+     }
+   }
+ }
+
+ Every node starts with the same {_M_next, _M_prev} pair, followed by the
+ element storage. The nodes are walked by reading the _M_next pointers
+ straight out of process memory instead of materializing a ValueObject for
+ every hop, so printing a long list costs one pointer read per element.
+ */
+class LibStdcppListSyntheticFrontEnd : public SyntheticChildrenFrontEnd {
+public:
+  explicit LibStdcppListSyntheticFrontEnd(lldb::ValueObjectSP valobj_sp);
+
+  size_t CalculateNumChildren() override;
+
+  lldb::ValueObjectSP GetChildAtIndex(size_t idx) override;
+
+  bool Update() override;
+
+  bool MightHaveChildren() override;
+
+  size_t GetIndexOfChildWithName(const ConstString &name) override;
+
+private:
+  // Walk the node chain until at least |count| nodes are known, the chain
+  // ends or a loop is detected.
+  void FetchNodes(size_t count);
+
+  ExecutionContextRef m_exe_ctx_ref;
+  CompilerType m_element_type;
+  lldb::addr_t m_header_address;
+  lldb::addr_t m_next_node;
+  uint64_t m_value_offset;
+  size_t m_count;
+  size_t m_list_capping_size;
+  std::vector<lldb::addr_t> m_nodes;
+  llvm::DenseSet<lldb::addr_t> m_visited;
+};
+
+} // end of anonymous namespace
+
+LibStdcppListSyntheticFrontEnd::LibStdcppListSyntheticFrontEnd(
+    lldb::ValueObjectSP valobj_sp)
+    : SyntheticChildrenFrontEnd(*valobj_sp), m_exe_ctx_ref(), m_element_type(),
+      m_header_address(LLDB_INVALID_ADDRESS),
+      m_next_node(LLDB_INVALID_ADDRESS), m_value_offset(0), m_count(0),
+      m_list_capping_size(0), m_nodes(), m_visited() {
+  if (valobj_sp)
+    Update();
+}
+
+bool LibStdcppListSyntheticFrontEnd::Update() {
+  m_header_address = LLDB_INVALID_ADDRESS;
+  m_next_node = LLDB_INVALID_ADDRESS;
+  m_count = 0;
+  m_nodes.clear();
+  m_visited.clear();
+
+  ValueObjectSP valobj_sp = m_backend.GetSP();
+  if (!valobj_sp)
+    return false;
+  m_exe_ctx_ref = valobj_sp->GetExecutionContextRef();
+
+  ProcessSP process_sp(valobj_sp->GetProcessSP());
+  if (!process_sp)
+    return false;
+
+  m_list_capping_size = 0;
+  if (TargetSP target_sp = valobj_sp->GetTargetSP())
+    m_list_capping_size = target_sp->GetMaximumNumberOfChildrenToDisplay();
+  if (m_list_capping_size == 0)
+    m_list_capping_size = 255;
+
+  CompilerType list_type = valobj_sp->GetCompilerType();
+  if (list_type.IsReferenceType())
+    list_type = list_type.GetNonReferenceType();
+  if (list_type.GetNumTemplateArguments() == 0)
+    return false;
+  m_element_type = list_type.GetTypeTemplateArgument(0);
+  if (!m_element_type)
+    return false;
+
+  ValueObjectSP node_sp(valobj_sp->GetChildAtNamePath(
+      {ConstString("_M_impl"), ConstString("_M_node")}));
+  if (!node_sp)
+    return false;
+
+  ValueObjectSP next_sp(
+      node_sp->GetChildMemberWithName(ConstString("_M_next"), true));
+  if (!next_sp)
+    return false;
+
+  m_header_address = node_sp->GetAddressOf(true, nullptr);
+  if (m_header_address == LLDB_INVALID_ADDRESS || m_header_address == 0)
+    return false;
+
+  // The element storage follows the two link pointers, padded up to the
+  // alignment of the element type.
+  const uint32_t addr_size = process_sp->GetAddressByteSize();
+  const uint64_t align = m_element_type.GetTypeBitAlign() / 8;
+  m_value_offset = llvm::alignTo(2 * addr_size, align ? align : 1);
+
+  const lldb::addr_t first = next_sp->GetValueAsUnsigned(0);
+  if (first == 0 || first == m_header_address)
+    return false;
+  m_next_node = first;
+
+  // libstdc++ 7 and later cache the element count in the list header
+  // (_M_size). The libstdc++ 5 and 6 C++11 ABI stored it in the _M_data
+  // member of a _List_node<size_t> header instead. Older versions don't
+  // track it at all and the count has to be found by walking the list.
+  ValueObjectSP size_sp(
+      node_sp->GetChildMemberWithName(ConstString("_M_size"), true));
+  if (!size_sp)
+    size_sp = node_sp->GetChildMemberWithName(ConstString("_M_data"), true);
+  if (size_sp) {
+    m_count = size_sp->GetValueAsUnsigned(0);
+  } else {
+    FetchNodes(m_list_capping_size);
+    m_count = m_nodes.size();
+  }
+  return false;
+}
+
+void LibStdcppListSyntheticFrontEnd::FetchNodes(size_t count) {
+  ProcessSP process_sp(m_backend.GetProcessSP());
+  if (!process_sp)
+    return;
+
+  while (m_nodes.size() < count && m_next_node != LLDB_INVALID_ADDRESS) {
+    const lldb::addr_t node = m_next_node;
+    m_next_node = LLDB_INVALID_ADDRESS;
+    if (node == 0 || node == m_header_address)
+      break;
+    // A node we have already seen means the list is corrupt.
+    if (!m_visited.insert(node).second)
+      break;
+
+    Status error;
+    const lldb::addr_t next = process_sp->ReadPointerFromMemory(node, error);
+    if (error.Fail())
+      break;
+    m_nodes.push_back(node);
+    m_next_node = next;
+  }
+}
+
+size_t LibStdcppListSyntheticFrontEnd::CalculateNumChildren() {
+  return m_count;
+}
+
+lldb::ValueObjectSP
+LibStdcppListSyntheticFrontEnd::GetChildAtIndex(size_t idx) {
+  if (idx >= CalculateNumChildren())
+    return lldb::ValueObjectSP();
+
+  // Children are usually requested in order, so walk a bit ahead of the
+  // requested index to amortize the reads.
+  if (idx >= m_nodes.size())
+    FetchNodes(std::max(idx + 1, std::min<size_t>(m_count, 2 * idx + 32)));
+  if (idx >= m_nodes.size())
+    return lldb::ValueObjectSP();
+
+  StreamString name;
+  name.Printf("[%" PRIu64 "]", (uint64_t)idx);
+  return CreateValueObjectFromAddress(name.GetString(),
+                                      m_nodes[idx] + m_value_offset,
+                                      m_exe_ctx_ref, m_element_type);
+}
+
+bool LibStdcppListSyntheticFrontEnd::MightHaveChildren() { return true; }
+
+size_t LibStdcppListSyntheticFrontEnd::GetIndexOfChildWithName(
+    const ConstString &name) {
+  return ExtractIndexFromString(name.GetCString());
+}
+
+SyntheticChildrenFrontEnd *
+lldb_private::formatters::LibStdcppListSyntheticFrontEndCreator(
+    CXXSyntheticChildren *, lldb::ValueObjectSP valobj_sp) {
+  return (valobj_sp ? new LibStdcppListSyntheticFrontEnd(valobj_sp) : nullptr);
+}
@@ -0,0 +1,255 @@
+//===-- LibStdcppMap.cpp ----------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibStdcpp.h"
+
+// C Includes
+// C++ Includes
+// Other libraries and framework includes
+#include "llvm/Support/MathExtras.h"
+
+// Project includes
+#include "lldb/Core/ValueObject.h"
+#include "lldb/DataFormatters/FormattersHelpers.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Target/Target.h"
+#include "lldb/Utility/DataExtractor.h"
+#include "lldb/Utility/Status.h"
+#include "lldb/Utility/Stream.h"
+
+using namespace lldb;
+using namespace lldb_private;
+using namespace lldb_private::formatters;
+
+namespace {
+
+/*
+ (std::map<int, int, std::less<int>, std::allocator<std::pair<const int,
+ int> > >) ii = {
+   (std::map<...>::_Rep_type) _M_t = {
+     (std::_Rb_tree<...>::_Rb_tree_impl<...>) _M_impl = {
+       (std::_Rb_tree_node_base) _M_header = {
+         (std::_Rb_tree_color) _M_color = _S_red
+         (std::_Rb_tree_node_base::_Base_ptr) _M_parent = 0x0000000000614c20
+         (std::_Rb_tree_node_base::_Base_ptr) _M_left = 0x0000000000614c20
+         (std::_Rb_tree_node_base::_Base_ptr) _M_right = 0x0000000000614c20
+       }
+       (std::size_t) _M_node_count = 1
+     }
+   }
+ }
+
+ The same tree backs std::map, std::multimap, std::set and std::multiset.
+ Every node starts with a _Rb_tree_node_base and is followed by the value.
+ The tree is walked in order with an explicit stack, and each node's links
+ are fetched with a single memory read, so every node is read exactly once.
+ */
+class LibStdcppMapSyntheticFrontEnd : public SyntheticChildrenFrontEnd {
+public:
+  explicit LibStdcppMapSyntheticFrontEnd(lldb::ValueObjectSP valobj_sp);
+
+  size_t CalculateNumChildren() override;
+
+  lldb::ValueObjectSP GetChildAtIndex(size_t idx) override;
+
+  bool Update() override;
+
+  bool MightHaveChildren() override;
+
+  size_t GetIndexOfChildWithName(const ConstString &name) override;
+
+private:
+  struct NodeLinks {
+    lldb::addr_t node;
+    lldb::addr_t right;
+  };
+
+  // Read the _M_left and _M_right links of |node| with one memory read.
+  bool ReadNodeLinks(lldb::addr_t node, lldb::addr_t &left,
+                     lldb::addr_t &right);
+
+  // Push |node| and its chain of left children onto the traversal stack.
+  bool PushLeftSpine(lldb::addr_t node);
+
+  // Continue the in-order traversal until at least |count| nodes are known.
+  void FetchNodes(size_t count);
+
+  ExecutionContextRef m_exe_ctx_ref;
+  CompilerType m_element_type;
+  uint64_t m_value_offset;
+  uint32_t m_addr_size;
+  lldb::ByteOrder m_byte_order;
+  size_t m_count;
+  size_t m_nodes_read;
+  bool m_garbage;
+  std::vector<NodeLinks> m_stack;
+  std::vector<lldb::addr_t> m_nodes;
+};
+
+} // end of anonymous namespace
+
+LibStdcppMapSyntheticFrontEnd::LibStdcppMapSyntheticFrontEnd(
+    lldb::ValueObjectSP valobj_sp)
+    : SyntheticChildrenFrontEnd(*valobj_sp), m_exe_ctx_ref(), m_element_type(),
+      m_value_offset(0), m_addr_size(0), m_byte_order(lldb::eByteOrderInvalid),
+      m_count(0), m_nodes_read(0), m_garbage(false), m_stack(), m_nodes() {
+  if (valobj_sp)
+    Update();
+}
+
+bool LibStdcppMapSyntheticFrontEnd::Update() {
+  m_count = 0;
+  m_nodes_read = 0;
+  m_garbage = false;
+  m_stack.clear();
+  m_nodes.clear();
+
+  ValueObjectSP valobj_sp = m_backend.GetSP();
+  if (!valobj_sp)
+    return false;
+  m_exe_ctx_ref = valobj_sp->GetExecutionContextRef();
+
+  ProcessSP process_sp(valobj_sp->GetProcessSP());
+  if (!process_sp)
+    return false;
+  m_addr_size = process_sp->GetAddressByteSize();
+  m_byte_order = process_sp->GetByteOrder();
+
+  ValueObjectSP tree_sp(
+      valobj_sp->GetChildMemberWithName(ConstString("_M_t"), true));
+  if (!tree_sp)
+    return false;
+
+  // _M_t is a std::_Rb_tree<Key, Value, KeyOfValue, Compare, Alloc>, whose
+  // second template argument is the element type of the container. This is
+  // more reliable than digging it out of the allocator, for which GCC
+  // doesn't always emit template parameters.
+  CompilerType tree_type = tree_sp->GetCompilerType().GetCanonicalType();
+  if (tree_type.GetNumTemplateArguments() < 2)
+    return false;
+  m_element_type = tree_type.GetTypeTemplateArgument(1);
+  if (!m_element_type)
+    return false;
+
+  ValueObjectSP header_sp(tree_sp->GetChildAtNamePath(
+      {ConstString("_M_impl"), ConstString("_M_header")}));
+  ValueObjectSP count_sp(tree_sp->GetChildAtNamePath(
+      {ConstString("_M_impl"), ConstString("_M_node_count")}));
+  if (!header_sp || !count_sp)
+    return false;
+
+  ValueObjectSP root_sp(
+      header_sp->GetChildMemberWithName(ConstString("_M_parent"), true));
+  if (!root_sp)
+    return false;
+  const lldb::addr_t root = root_sp->GetValueAsUnsigned(0);
+  if (root == 0)
+    return false;
+
+  const uint64_t header_size = header_sp->GetCompilerType().GetByteSize(
+      nullptr); // Safe to pass NULL for exe_scope here
+  if (header_size == 0)
+    return false;
+  const uint64_t align = m_element_type.GetTypeBitAlign() / 8;
+  m_value_offset = llvm::alignTo(header_size, align ? align : 1);
+
+  m_count = count_sp->GetValueAsUnsigned(0);
+  if (!PushLeftSpine(root))
+    m_count = 0;
+  return false;
+}
+
+bool LibStdcppMapSyntheticFrontEnd::ReadNodeLinks(lldb::addr_t node,
+                                                  lldb::addr_t &left,
+                                                  lldb::addr_t &right) {
+  ProcessSP process_sp(m_backend.GetProcessSP());
+  if (!process_sp)
+    return false;
+
+  // _M_color is padded to pointer size, so the node header is four
+  // pointer-sized words: {_M_color, _M_parent, _M_left, _M_right}.
+  uint8_t buffer[4 * sizeof(uint64_t)];
+  const size_t size = 4 * m_addr_size;
+  if (size > sizeof(buffer))
+    return false;
+
+  Status error;
+  if (process_sp->ReadMemory(node, buffer, size, error) != size ||
+      error.Fail())
+    return false;
+
+  DataExtractor data(buffer, size, m_byte_order, m_addr_size);
+  lldb::offset_t offset = 2 * m_addr_size;
+  left = data.GetAddress(&offset);
+  right = data.GetAddress(&offset);
+  return true;
+}
+
+bool LibStdcppMapSyntheticFrontEnd::PushLeftSpine(lldb::addr_t node) {
+  while (node != 0) {
+    // A well formed tree never has more nodes than _M_node_count. If we see
+    // more than that we are looking at garbage (e.g. an uninitialized map),
+    // so stop walking it.
+    if (++m_nodes_read > m_count) {
+      m_garbage = true;
+      return false;
+    }
+    lldb::addr_t left = 0, right = 0;
+    if (!ReadNodeLinks(node, left, right)) {
+      m_garbage = true;
+      return false;
+    }
+    m_stack.push_back({node, right});
+    node = left;
+  }
+  return true;
+}
+
+void LibStdcppMapSyntheticFrontEnd::FetchNodes(size_t count) {
+  while (m_nodes.size() < count && !m_garbage && !m_stack.empty()) {
+    NodeLinks current = m_stack.back();
+    m_stack.pop_back();
+    m_nodes.push_back(current.node);
+    if (!PushLeftSpine(current.right))
+      break;
+  }
+}
+
+size_t LibStdcppMapSyntheticFrontEnd::CalculateNumChildren() {
+  return m_count;
+}
+
+lldb::ValueObjectSP LibStdcppMapSyntheticFrontEnd::GetChildAtIndex(size_t idx) {
+  if (idx >= CalculateNumChildren())
+    return lldb::ValueObjectSP();
+
+  if (idx >= m_nodes.size())
+    FetchNodes(idx + 1);
+  if (idx >= m_nodes.size())
+    return lldb::ValueObjectSP();
+
+  StreamString name;
+  name.Printf("[%" PRIu64 "]", (uint64_t)idx);
+  return CreateValueObjectFromAddress(name.GetString(),
+                                      m_nodes[idx] + m_value_offset,
+                                      m_exe_ctx_ref, m_element_type);
+}
+
+bool LibStdcppMapSyntheticFrontEnd::MightHaveChildren() { return true; }
+
+size_t LibStdcppMapSyntheticFrontEnd::GetIndexOfChildWithName(
+    const ConstString &name) {
+  return ExtractIndexFromString(name.GetCString());
+}
+
+SyntheticChildrenFrontEnd *
+lldb_private::formatters::LibStdcppMapSyntheticFrontEndCreator(
+    CXXSyntheticChildren *, lldb::ValueObjectSP valobj_sp) {
+  return (valobj_sp ? new LibStdcppMapSyntheticFrontEnd(valobj_sp) : nullptr);
+}
@@ -0,0 +1,188 @@
+//===-- LibStdcppUnorderedMap.cpp -------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibStdcpp.h"
+
+// C Includes
+// C++ Includes
+// Other libraries and framework includes
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/MathExtras.h"
+
+// Project includes
+#include "lldb/Core/ValueObject.h"
+#include "lldb/DataFormatters/FormattersHelpers.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Utility/Status.h"
+#include "lldb/Utility/Stream.h"
+
+using namespace lldb;
+using namespace lldb_private;
+using namespace lldb_private::formatters;
+
+namespace {
+
+/*
+ (std::unordered_map<int, int, ...>) um = {
+   (std::unordered_map<...>::_Hashtable) _M_h = {
+     (std::__detail::_Hash_node_base **) _M_buckets = 0x0000000000614c50
+     (std::size_t) _M_bucket_count = 7
+     (std::__detail::_Hash_node_base) _M_before_begin = {
+       (std::__detail::_Hash_node_base *) _M_nxt = 0x0000000000614ca0
+     }
+     (std::size_t) _M_element_count = 3
+     ...
+   }
+ }
+
+ All the elements of a libstdc++ hashtable are threaded onto one singly
+ linked list that starts at _M_before_begin. Each node is a _M_nxt pointer
+ followed by the element storage (and, optionally, the cached hash code).
+ */
+class LibStdcppUnorderedMapSyntheticFrontEnd
+    : public SyntheticChildrenFrontEnd {
+public:
+  explicit LibStdcppUnorderedMapSyntheticFrontEnd(
+      lldb::ValueObjectSP valobj_sp);
+
+  size_t CalculateNumChildren() override;
+
+  lldb::ValueObjectSP GetChildAtIndex(size_t idx) override;
+
+  bool Update() override;
+
+  bool MightHaveChildren() override;
+
+  size_t GetIndexOfChildWithName(const ConstString &name) override;
+
+private:
+  void FetchNodes(size_t count);
+
+  ExecutionContextRef m_exe_ctx_ref;
+  CompilerType m_element_type;
+  lldb::addr_t m_next_node;
+  uint64_t m_value_offset;
+  size_t m_count;
+  std::vector<lldb::addr_t> m_nodes;
+  llvm::DenseSet<lldb::addr_t> m_visited;
+};
+
+} // end of anonymous namespace
+
+LibStdcppUnorderedMapSyntheticFrontEnd::LibStdcppUnorderedMapSyntheticFrontEnd(
+    lldb::ValueObjectSP valobj_sp)
+    : SyntheticChildrenFrontEnd(*valobj_sp), m_exe_ctx_ref(), m_element_type(),
+      m_next_node(0), m_value_offset(0), m_count(0), m_nodes(), m_visited() {
+  if (valobj_sp)
+    Update();
+}
+
+bool LibStdcppUnorderedMapSyntheticFrontEnd::Update() {
+  m_next_node = 0;
+  m_count = 0;
+  m_nodes.clear();
+  m_visited.clear();
+
+  ValueObjectSP valobj_sp = m_backend.GetSP();
+  if (!valobj_sp)
+    return false;
+  m_exe_ctx_ref = valobj_sp->GetExecutionContextRef();
+
+  ProcessSP process_sp(valobj_sp->GetProcessSP());
+  if (!process_sp)
+    return false;
+
+  ValueObjectSP table_sp(
+      valobj_sp->GetChildMemberWithName(ConstString("_M_h"), true));
+  if (!table_sp)
+    return false;
+
+  // _M_h is a std::_Hashtable<Key, Value, ...>; the second template argument
+  // is the element type for all four unordered containers.
+  CompilerType table_type = table_sp->GetCompilerType().GetCanonicalType();
+  if (table_type.GetNumTemplateArguments() < 2)
+    return false;
+  m_element_type = table_type.GetTypeTemplateArgument(1);
+  if (!m_element_type)
+    return false;
+
+  ValueObjectSP count_sp(
+      table_sp->GetChildMemberWithName(ConstString("_M_element_count"), true));
+  ValueObjectSP first_sp(table_sp->GetChildAtNamePath(
+      {ConstString("_M_before_begin"), ConstString("_M_nxt")}));
+  if (!count_sp || !first_sp)
+    return false;
+
+  const uint32_t addr_size = process_sp->GetAddressByteSize();
+  const uint64_t align = m_element_type.GetTypeBitAlign() / 8;
+  m_value_offset = llvm::alignTo(addr_size, align ? align : 1);
+
+  m_count = count_sp->GetValueAsUnsigned(0);
+  m_next_node = first_sp->GetValueAsUnsigned(0);
+  if (m_next_node == 0)
+    m_count = 0;
+  return false;
+}
+
+void LibStdcppUnorderedMapSyntheticFrontEnd::FetchNodes(size_t count) {
+  ProcessSP process_sp(m_backend.GetProcessSP());
+  if (!process_sp)
+    return;
+
+  while (m_nodes.size() < count && m_next_node != 0) {
+    const lldb::addr_t node = m_next_node;
+    m_next_node = 0;
+    if (!m_visited.insert(node).second)
+      break;
+
+    Status error;
+    const lldb::addr_t next = process_sp->ReadPointerFromMemory(node, error);
+    if (error.Fail())
+      break;
+    m_nodes.push_back(node);
+    m_next_node = next;
+  }
+}
+
+size_t LibStdcppUnorderedMapSyntheticFrontEnd::CalculateNumChildren() {
+  return m_count;
+}
+
+lldb::ValueObjectSP
+LibStdcppUnorderedMapSyntheticFrontEnd::GetChildAtIndex(size_t idx) {
+  if (idx >= CalculateNumChildren())
+    return lldb::ValueObjectSP();
+
+  if (idx >= m_nodes.size())
+    FetchNodes(std::max(idx + 1, std::min<size_t>(m_count, 2 * idx + 32)));
+  if (idx >= m_nodes.size())
+    return lldb::ValueObjectSP();
+
+  StreamString name;
+  name.Printf("[%" PRIu64 "]", (uint64_t)idx);
+  return CreateValueObjectFromAddress(name.GetString(),
+                                      m_nodes[idx] + m_value_offset,
+                                      m_exe_ctx_ref, m_element_type);
+}
+
+bool LibStdcppUnorderedMapSyntheticFrontEnd::MightHaveChildren() {
+  return true;
+}
+
+size_t LibStdcppUnorderedMapSyntheticFrontEnd::GetIndexOfChildWithName(
+    const ConstString &name) {
+  return ExtractIndexFromString(name.GetCString());
+}
+
+SyntheticChildrenFrontEnd *
+lldb_private::formatters::LibStdcppUnorderedMapSyntheticFrontEndCreator(
+    CXXSyntheticChildren *, lldb::ValueObjectSP valobj_sp) {
+  return (valobj_sp ? new LibStdcppUnorderedMapSyntheticFrontEnd(valobj_sp)
+                    : nullptr);
+}
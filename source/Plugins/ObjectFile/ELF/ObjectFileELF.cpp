@@ -2807,6 +2807,23 @@ Symtab *ObjectFileELF::GetSymtab() {
           section_list->FindSectionByType(eSectionTypeELFDynamicSymbols, true)
               .get();
     }
+
+    // Use the symbols saved by an earlier session if there are any. On ARM
+    // and MIPS, parsing the symbols also fills m_address_class_map, which the
+    // cache doesn't hold, so always parse them there.
+    ArchSpec arch;
+    GetArchitecture(arch);
+    const llvm::Triple::ArchType machine = arch.GetMachine();
+    const bool use_cache = machine != llvm::Triple::arm &&
+                           machine != llvm::Triple::aarch64 &&
+                           !arch.IsMIPS();
+    std::unique_ptr<Symtab> cached_symtab_ap(
+        new Symtab(symtab ? symtab->GetObjectFile() : this));
+    if (use_cache && cached_symtab_ap->LoadFromCache()) {
+      m_symtab_ap = std::move(cached_symtab_ap);
+      return m_symtab_ap.get();
+    }
+
     if (symtab) {
       m_symtab_ap.reset(new Symtab(symtab->GetObjectFile()));
       symbol_id += ParseSymbolTable(m_symtab_ap.get(), symbol_id, symtab);
@@ -2854,6 +2871,10 @@ Symtab *ObjectFileELF::GetSymtab() {
       m_symtab_ap.reset(new Symtab(this));
 
     m_symtab_ap->CalculateSymbolSizes();
+    // The symbols were appended one by one, release the excess capacity.
+    m_symtab_ap->Finalize();
+    if (use_cache)
+      m_symtab_ap->SaveToCache();
   }
 
   return m_symtab_ap.get();
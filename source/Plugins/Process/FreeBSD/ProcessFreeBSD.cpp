@@ -127,9 +127,13 @@ Status ProcessFreeBSD::DoDetach(bool keep_stopped) {
   return error;
 }
 
-Status ProcessFreeBSD::DoResume() {
+Status ProcessFreeBSD::DoResume(RunDirection direction) {
   Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
 
+  if (direction == eRunReverse)
+    return Status("error: %s does not support reverse execution",
+                  GetPluginName().GetCString());
+
   SetPrivateState(eStateRunning);
 
   std::lock_guard<std::recursive_mutex> guard(m_thread_list.GetMutex());
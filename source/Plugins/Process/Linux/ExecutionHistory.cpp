@@ -0,0 +1,943 @@
+//===-- ExecutionHistory.cpp ---------------------------------- -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ExecutionHistory.h"
+
+// C Includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// C++ Includes
+#include <algorithm>
+#include <set>
+
+// Other libraries and framework includes
+#include "lldb/Core/RegisterValue.h"
+#include "lldb/Host/common/NativeBreakpoint.h"
+#include "lldb/Host/linux/Uio.h"
+#include "lldb/Target/MemoryRegionInfo.h"
+#include "lldb/Utility/Log.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/Support/Errno.h"
+#include "llvm/Support/FormatVariadic.h"
+
+#include "NativeProcessLinux.h"
+#include "NativeThreadLinux.h"
+#include "Plugins/Process/POSIX/ProcessPOSIXLog.h"
+
+using namespace lldb;
+using namespace lldb_private;
+using namespace lldb_private::process_linux;
+
+// Bits of the entries of /proc/<pid>/pagemap
+static const uint64_t k_pagemap_soft_dirty = 1ull << 55;
+static const uint64_t k_pagemap_swapped = 1ull << 62;
+static const uint64_t k_pagemap_present = 1ull << 63;
+
+// Number of pagemap entries read at once.
+static const size_t k_pagemap_chunk = 512;
+
+// Past this many checkpoints, or this many bytes of saved pages, the oldest
+// checkpoints are merged.
+static const size_t k_max_checkpoints = 1024;
+static const size_t k_max_history_bytes = 1024 * 1024 * 1024;
+
+// Replay gives up on stepping a thread to its target after this many steps.
+static const uint32_t k_max_replay_steps = 100000;
+
+static const uint32_t k_unlimited = UINT32_MAX;
+
+static bool ClearRefs(::pid_t pid) {
+  // Writing 4 clears the soft-dirty bits of all the pages of the process.
+  std::string path = llvm::formatv("/proc/{0}/clear_refs", pid).str();
+  int fd = llvm::sys::RetryAfterSignal(-1, ::open, path.c_str(),
+                                       O_WRONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+  bool success = ::write(fd, "4", 1) == 1;
+  ::close(fd);
+  return success;
+}
+
+// Whether the kernel tracks soft-dirty bits. Without CONFIG_MEM_SOFT_DIRTY
+// clear_refs accepts 4 but the bits are never set, so check that writing to
+// a page of our own marks it.
+static bool SoftDirtyBitsSupported() {
+  static const bool supported = [] {
+    const size_t page_size = ::sysconf(_SC_PAGESIZE);
+    void *page = ::mmap(nullptr, page_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (page == MAP_FAILED)
+      return false;
+    auto unmap = llvm::make_scope_exit([&] { ::munmap(page, page_size); });
+
+    *static_cast<volatile char *>(page) = 1;
+    if (!ClearRefs(::getpid()))
+      return false;
+    *static_cast<volatile char *>(page) = 2;
+
+    int fd = llvm::sys::RetryAfterSignal(-1, ::open, "/proc/self/pagemap",
+                                         O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return false;
+    uint64_t entry = 0;
+    const off_t offset =
+        reinterpret_cast<uintptr_t>(page) / page_size * sizeof(entry);
+    bool dirty = ::pread(fd, &entry, sizeof(entry), offset) == sizeof(entry) &&
+                 (entry & k_pagemap_soft_dirty);
+    ::close(fd);
+    return dirty;
+  }();
+  return supported;
+}
+
+static size_t
+GetPageBytes(const std::shared_ptr<const std::vector<uint8_t>> &page) {
+  return page ? page->size() : 0;
+}
+
+ExecutionHistory::ExecutionHistory(NativeProcessLinux &process)
+    : m_process(process), m_page_size(::sysconf(_SC_PAGESIZE)),
+      m_zero_page(m_page_size) {}
+
+Status ExecutionHistory::Start() {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  if (!m_process.SupportHardwareSingleStepping())
+    return Status("reverse execution needs hardware single stepping");
+  // Comparing every page at every stop instead would make each stop cost in
+  // proportion to the size of the process.
+  if (!SoftDirtyBitsSupported())
+    return Status("reverse execution needs the soft-dirty page bits of the "
+                  "kernel (CONFIG_MEM_SOFT_DIRTY)");
+
+  ClearHistory();
+
+  Checkpoint checkpoint;
+  Status error = TakeCheckpoint(m_process.GetCurrentThreadID(), checkpoint);
+  if (error.Fail()) {
+    ClearHistory();
+    return error;
+  }
+  m_checkpoints.push_back(std::move(checkpoint));
+
+  LLDB_LOG(log, "pid {0}: recording history, {1} bytes of pages",
+           m_process.GetID(), m_history_bytes);
+  return Status();
+}
+
+void ExecutionHistory::ProcessStopped(NativeThreadLinux &thread) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  // An exec replaced the whole address space, so the history starts over.
+  ThreadStopInfo stop_info;
+  std::string description;
+  if (thread.GetStopReason(stop_info, description) &&
+      stop_info.reason == eStopReasonExec) {
+    ResetHistory(thread.GetID());
+    return;
+  }
+
+  Checkpoint checkpoint;
+  Status error = TakeCheckpoint(thread.GetID(), checkpoint);
+  if (error.Fail()) {
+    // The pages that changed are lost, and the soft-dirty bits may not be
+    // reliable anymore.
+    LLDB_LOG(log, "failed to take a checkpoint, no longer recording: {0}",
+             error);
+    ClearHistory();
+    return;
+  }
+  checkpoint.stepped = checkpoint.stop_info.reason == eStopReasonTrace;
+  m_checkpoints.push_back(std::move(checkpoint));
+  TrimHistory();
+
+  LLDB_LOG(log, "checkpoint {0}: {1} pages, {2} bytes in the history",
+           m_checkpoints.size() - 1, m_checkpoints.back().pages.size(),
+           m_history_bytes);
+}
+
+//----------------------------------------------------------------------
+// Checkpoints
+//----------------------------------------------------------------------
+
+Status ExecutionHistory::TakeCheckpoint(lldb::tid_t stop_tid,
+                                        Checkpoint &checkpoint) {
+  checkpoint.id = m_next_checkpoint_id++;
+  for (const auto &thread_up : m_process.m_threads) {
+    auto &thread = static_cast<NativeThreadLinux &>(*thread_up);
+    Status error = ReadThreadState(thread, checkpoint.threads[thread.GetID()]);
+    if (error.Fail())
+      return error;
+  }
+
+  checkpoint.stop_tid = stop_tid;
+  if (NativeThreadLinux *thread = m_process.GetThreadByID(stop_tid))
+    thread->GetStopReason(checkpoint.stop_info, checkpoint.stop_description);
+  else
+    checkpoint.stop_info.reason = eStopReasonNone;
+
+  Status error = ReadChangedPages(checkpoint);
+  if (error.Fail())
+    return error;
+  return ClearSoftDirtyBits();
+}
+
+Status ExecutionHistory::ReadThreadState(NativeThreadLinux &thread,
+                                         ThreadState &state) {
+  NativeRegisterContextLinux &reg_ctx = thread.GetRegisterContext();
+  Status error = reg_ctx.ReadAllRegisterValues(state.registers);
+  if (error.Fail())
+    return error;
+  error = ReadGPRs(thread, state.gprs);
+  if (error.Fail())
+    return error;
+  state.pc = reg_ctx.GetPC();
+
+  ThreadStopInfo stop_info;
+  std::string description;
+  state.at_breakpoint = thread.GetStopReason(stop_info, description) &&
+                        stop_info.reason == eStopReasonBreakpoint;
+  return Status();
+}
+
+Status ExecutionHistory::ReadGPRs(NativeThreadLinux &thread,
+                                  std::vector<uint64_t> &gprs) {
+  NativeRegisterContextLinux &reg_ctx = thread.GetRegisterContext();
+  const RegisterSet *reg_set = reg_ctx.GetRegisterSet(0);
+  if (!reg_set)
+    return Status("no general purpose registers");
+
+  // The flags depend on the path that led to a position, so they are left
+  // out of the comparison.
+  const uint32_t flags_reg = reg_ctx.ConvertRegisterKindToRegisterNumber(
+      eRegisterKindGeneric, LLDB_REGNUM_GENERIC_FLAGS);
+
+  gprs.clear();
+  for (size_t i = 0; i < reg_set->num_registers; ++i) {
+    const uint32_t reg = reg_set->registers[i];
+    const RegisterInfo *reg_info = reg_ctx.GetRegisterInfoAtIndex(reg);
+    if (reg == flags_reg || !reg_info || reg_info->value_regs)
+      continue;
+    RegisterValue value;
+    Status error = reg_ctx.ReadRegister(reg_info, value);
+    if (error.Fail())
+      return error;
+    gprs.push_back(value.GetAsUInt64());
+  }
+  return Status();
+}
+
+Status ExecutionHistory::ForEachWritablePage(
+    llvm::function_ref<Status(lldb::addr_t, uint64_t, bool)> callback) {
+  // The mappings may have changed without a stop of the process while
+  // replaying.
+  m_process.m_mem_region_cache.clear();
+  Status error = m_process.PopulateMemoryRegionCache();
+  if (error.Fail())
+    return error;
+
+  std::string path =
+      llvm::formatv("/proc/{0}/pagemap", m_process.GetID()).str();
+  int fd = llvm::sys::RetryAfterSignal(-1, ::open, path.c_str(),
+                                       O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return Status(errno, eErrorTypePOSIX);
+  auto close_fd = llvm::make_scope_exit([fd] { ::close(fd); });
+
+  std::vector<uint64_t> entries(k_pagemap_chunk);
+  for (const auto &region : m_process.m_mem_region_cache) {
+    const MemoryRegionInfo &info = region.first;
+    if (info.GetReadable() != MemoryRegionInfo::eYes ||
+        info.GetWritable() != MemoryRegionInfo::eYes)
+      continue;
+
+    // Pages of anonymous mappings that were never touched read as zeros,
+    // those of file mappings read from the file.
+    llvm::StringRef name = info.GetName().GetStringRef();
+    const bool anonymous = name.empty() || name.startswith("[");
+
+    lldb::addr_t addr = info.GetRange().GetRangeBase();
+    const lldb::addr_t end = info.GetRange().GetRangeEnd();
+    while (addr < end) {
+      const size_t count =
+          std::min<size_t>(entries.size(), (end - addr) / m_page_size);
+      const size_t size = count * sizeof(uint64_t);
+      const off_t offset = addr / m_page_size * sizeof(uint64_t);
+      if (::pread(fd, entries.data(), size, offset) != ssize_t(size))
+        return Status("failed to read %s", path.c_str());
+
+      for (size_t i = 0; i < count; ++i, addr += m_page_size) {
+        error = callback(addr, entries[i], anonymous);
+        if (error.Fail())
+          return error;
+      }
+    }
+  }
+  return Status();
+}
+
+Status ExecutionHistory::ReadChangedPages(Checkpoint &checkpoint) {
+  const bool first = m_checkpoints.empty();
+  return ForEachWritablePage([&](lldb::addr_t addr, uint64_t entry,
+                                 bool anonymous) {
+    if (!first && !(entry & k_pagemap_soft_dirty))
+      return Status();
+
+    PageSP page;
+    if (!anonymous || (entry & (k_pagemap_present | k_pagemap_swapped))) {
+      Status error = ReadPage(addr, page);
+      if (error.Fail())
+        return error;
+    }
+
+    m_history_bytes += GetPageBytes(page);
+    m_pages[addr].push_back({checkpoint.id, std::move(page)});
+    checkpoint.pages.push_back(addr);
+    return Status();
+  });
+}
+
+Status ExecutionHistory::ReadPage(lldb::addr_t addr, PageSP &page) {
+  auto data = std::make_shared<std::vector<uint8_t>>(m_page_size);
+  size_t bytes_read = 0;
+  // The saved pages never hold breakpoint traps, so that restoring them
+  // doesn't bring back breakpoints that were removed since.
+  Status error = m_process.ReadMemoryWithoutTrap(addr, data->data(),
+                                                 m_page_size, bytes_read);
+  if (error.Fail())
+    return error;
+  if (bytes_read != m_page_size)
+    return Status("failed to read the page at 0x%" PRIx64, addr);
+
+  if (*data == m_zero_page)
+    page.reset();
+  else
+    page = std::move(data);
+  return Status();
+}
+
+Status ExecutionHistory::WritePage(lldb::addr_t addr, size_t index) {
+  PageSP page;
+  if (!FindPage(addr, index, page))
+    return Status();
+
+  const uint8_t *bytes = page ? page->data() : m_zero_page.data();
+  struct iovec local_iov, remote_iov;
+  local_iov.iov_base = const_cast<uint8_t *>(bytes);
+  local_iov.iov_len = m_page_size;
+  remote_iov.iov_base = reinterpret_cast<void *>(addr);
+  remote_iov.iov_len = m_page_size;
+  if (process_vm_writev(m_process.GetID(), &local_iov, 1, &remote_iov, 1,
+                        0) != ssize_t(m_page_size)) {
+    size_t bytes_written = 0;
+    Status error =
+        m_process.WriteMemory(addr, bytes, m_page_size, bytes_written);
+    if (error.Fail())
+      return error;
+  }
+
+  return m_process.m_breakpoint_list.ReinsertTraps(addr, m_page_size);
+}
+
+bool ExecutionHistory::FindPage(lldb::addr_t addr, size_t index,
+                                PageSP &page) const {
+  auto pos = m_pages.find(addr);
+  if (pos == m_pages.end())
+    return false;
+
+  // The last version saved at or before the checkpoint
+  const uint64_t id = m_checkpoints[index].id;
+  const std::vector<PageVersion> &versions = pos->second;
+  auto next = std::upper_bound(
+      versions.begin(), versions.end(), id,
+      [](uint64_t id, const PageVersion &version) {
+        return id < version.checkpoint_id;
+      });
+  if (next == versions.begin())
+    return false;
+  page = std::prev(next)->page;
+  return true;
+}
+
+Status ExecutionHistory::ClearSoftDirtyBits() {
+  if (!ClearRefs(m_process.GetID()))
+    return Status("failed to clear the soft-dirty bits of pid %" PRIu64,
+                  m_process.GetID());
+  return Status();
+}
+
+void ExecutionHistory::ClearHistory() {
+  m_checkpoints.clear();
+  m_pages.clear();
+  m_history_bytes = 0;
+}
+
+bool ExecutionHistory::CanRestore(size_t index) const {
+  const Checkpoint &checkpoint = m_checkpoints[index];
+  if (checkpoint.threads.size() != m_process.m_threads.size())
+    return false;
+  for (const auto &thread : m_process.m_threads) {
+    if (!checkpoint.threads.count(thread->GetID()))
+      return false;
+  }
+  return true;
+}
+
+Status ExecutionHistory::Restore(size_t index) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  if (!CanRestore(index))
+    return Status("the threads of the process changed");
+
+  // The pages that changed since the checkpoint are those saved by the
+  // checkpoints after it, and those written since the last one.
+  std::set<lldb::addr_t> changed;
+  for (size_t i = index + 1; i < m_checkpoints.size(); ++i) {
+    for (lldb::addr_t addr : m_checkpoints[i].pages)
+      changed.insert(addr);
+  }
+
+  size_t count = 0;
+  Status error = ForEachWritablePage([&](lldb::addr_t addr, uint64_t entry,
+                                         bool anonymous) {
+    if (!(entry & k_pagemap_soft_dirty) && !changed.count(addr))
+      return Status();
+    ++count;
+    return WritePage(addr, index);
+  });
+  if (error.Fail())
+    return error;
+
+  for (const auto &thread_up : m_process.m_threads) {
+    auto &thread = static_cast<NativeThreadLinux &>(*thread_up);
+    const ThreadState &state = m_checkpoints[index].threads[thread.GetID()];
+    error = thread.GetRegisterContext().WriteAllRegisterValues(state.registers);
+    if (error.Fail())
+      return error;
+  }
+
+  error = ClearSoftDirtyBits();
+  if (error.Fail())
+    return error;
+  LLDB_LOG(log, "restored checkpoint {0}, {1} pages", index, count);
+  return Status();
+}
+
+void ExecutionHistory::TruncateHistory(size_t size) {
+  while (m_checkpoints.size() > size) {
+    // The last checkpoint saved the last version of each of its pages.
+    for (lldb::addr_t addr : m_checkpoints.back().pages) {
+      auto pos = m_pages.find(addr);
+      m_history_bytes -= GetPageBytes(pos->second.back().page);
+      pos->second.pop_back();
+      if (pos->second.empty())
+        m_pages.erase(pos);
+    }
+    m_checkpoints.pop_back();
+  }
+}
+
+void ExecutionHistory::TrimHistory() {
+  while (m_checkpoints.size() > 2 &&
+         (m_checkpoints.size() > k_max_checkpoints ||
+          m_history_bytes > k_max_history_bytes)) {
+    // Fold the second checkpoint into the first one.
+    Checkpoint &first = m_checkpoints[0];
+    Checkpoint &second = m_checkpoints[1];
+    for (lldb::addr_t addr : second.pages) {
+      std::vector<PageVersion> &versions = m_pages[addr];
+      if (versions.front().checkpoint_id == first.id) {
+        m_history_bytes -= GetPageBytes(versions.front().page);
+        versions.erase(versions.begin());
+      } else {
+        first.pages.push_back(addr);
+      }
+      versions.front().checkpoint_id = first.id;
+    }
+    first.threads = std::move(second.threads);
+    first.stop_tid = second.stop_tid;
+    first.stop_info = second.stop_info;
+    first.stop_description = std::move(second.stop_description);
+    first.stepped = false;
+    m_checkpoints.erase(m_checkpoints.begin() + 1);
+  }
+}
+
+void ExecutionHistory::ResetHistory(lldb::tid_t stop_tid) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  ClearHistory();
+
+  Checkpoint checkpoint;
+  Status error = TakeCheckpoint(stop_tid, checkpoint);
+  if (error.Fail()) {
+    LLDB_LOG(log, "failed to take a checkpoint, no longer recording: {0}",
+             error);
+    ClearHistory();
+    return;
+  }
+  m_checkpoints.push_back(std::move(checkpoint));
+}
+
+//----------------------------------------------------------------------
+// Reverse operations
+//----------------------------------------------------------------------
+
+// The position of a checkpoint can only be found again if its thread
+// stopped there on its own.
+static bool IsLocatable(const ThreadStopInfo &stop_info) {
+  switch (stop_info.reason) {
+  case eStopReasonBreakpoint:
+  case eStopReasonTrace:
+  case eStopReasonWatchpoint:
+    return true;
+  default:
+    return false;
+  }
+}
+
+Status ExecutionHistory::ReverseStep(NativeThreadLinux &thread, bool &resumed,
+                                     lldb::tid_t &tid) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  resumed = false;
+  tid = thread.GetID();
+  if (m_checkpoints.empty())
+    return Status("no execution history");
+
+  m_tid = tid;
+  m_replayed = false;
+  m_operation = eOperationStep;
+  m_start_index = m_checkpoints.size() - 1;
+
+  // The last stop is the current position.
+  const size_t current = m_checkpoints.size() - 1;
+  const Checkpoint &last = m_checkpoints[current];
+  auto target = last.threads.find(tid);
+  if (target == last.threads.end())
+    return Status("thread %" PRIu64 " has no history", tid);
+
+  // A single step of the thread only needs the previous checkpoint.
+  if (current > 0 && last.stepped && last.stop_tid == tid &&
+      CanRestore(current - 1)) {
+    if (LandAtCheckpoint(current - 1)) {
+      for (const auto &thread_up : m_process.m_threads)
+        static_cast<NativeThreadLinux &>(*thread_up).SetStoppedWithNoReason();
+      thread.SetStoppedByTrace();
+      EndOperation();
+      return Status();
+    }
+  }
+
+  // Find the segment of the history in which the thread last ran.
+  size_t end = current;
+  while (end > 0 && CanRestore(end - 1)) {
+    const auto &threads = m_checkpoints[end - 1].threads;
+    auto pos = threads.find(tid);
+    if (pos == threads.end() || pos->second.pc != target->second.pc ||
+        pos->second.gprs != target->second.gprs)
+      break;
+    --end;
+  }
+  if (end == 0 || !CanRestore(end - 1) ||
+      !m_checkpoints[end - 1].threads.count(tid)) {
+    tid = StopAtHistoryBoundary(end);
+    return Status();
+  }
+
+  LLDB_LOG(log, "tid {0}: stepping back into checkpoints {1} to {2}", tid,
+           end - 1, end);
+  m_segment = end - 1;
+  SetTarget(tid, target->second);
+  m_pass = 1;
+  resumed = RunPass(k_unlimited, 0, tid);
+  return Status();
+}
+
+Status ExecutionHistory::ReverseContinue(bool &resumed, lldb::tid_t &tid) {
+  resumed = false;
+  if (m_checkpoints.empty())
+    return Status("no execution history");
+
+  m_tid = LLDB_INVALID_THREAD_ID;
+  m_replayed = false;
+  m_operation = eOperationContinue;
+  m_start_index = m_checkpoints.size() - 1;
+  m_segment = m_start_index;
+  resumed = ReplayPreviousSegment(tid);
+  return Status();
+}
+
+bool ExecutionHistory::ReplayPreviousSegment(lldb::tid_t &tid) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  const Checkpoint &end = m_checkpoints[m_segment];
+  auto target = end.threads.find(end.stop_tid);
+  if (m_segment == 0 || !IsLocatable(end.stop_info) ||
+      target == end.threads.end() || !CanRestore(m_segment - 1)) {
+    tid = StopAtHistoryBoundary(m_segment);
+    return false;
+  }
+
+  LLDB_LOG(log, "continuing back into checkpoints {0} to {1}", m_segment - 1,
+           m_segment);
+  --m_segment;
+  SetTarget(end.stop_tid, target->second);
+  m_pass = 1;
+  return RunPass(k_unlimited, 0, tid);
+}
+
+void ExecutionHistory::SetTarget(lldb::tid_t tid, const ThreadState &state) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  if (m_replay_breakpoint != state.pc) {
+    if (m_replay_breakpoint != LLDB_INVALID_ADDRESS &&
+        !m_replay_breakpoint_is_user)
+      m_process.RemoveBreakpoint(m_replay_breakpoint);
+    m_replay_breakpoint = state.pc;
+
+    // The target is found with a breakpoint at its pc, unless the client
+    // already has one there.
+    NativeBreakpointSP breakpoint_sp;
+    m_replay_breakpoint_is_user =
+        m_process.m_breakpoint_list.GetBreakpoint(state.pc, breakpoint_sp)
+            .Success();
+    if (!m_replay_breakpoint_is_user) {
+      Status error = m_process.SetBreakpoint(state.pc, 0, false);
+      if (error.Fail())
+        LLDB_LOG(log, "failed to set the replay breakpoint at {0:x}: {1}",
+                 state.pc, error);
+    }
+  }
+
+  m_target_tid = tid;
+  m_target = state;
+}
+
+bool ExecutionHistory::IsAtTarget(NativeThreadLinux &thread) {
+  if (thread.GetID() != m_target_tid ||
+      thread.GetRegisterContext().GetPC() != m_target.pc)
+    return false;
+  std::vector<uint64_t> gprs;
+  return ReadGPRs(thread, gprs).Success() && gprs == m_target.gprs;
+}
+
+bool ExecutionHistory::RunPass(uint32_t event_limit, uint32_t step_limit,
+                               lldb::tid_t &tid) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+  LLDB_LOG(log, "pass {0}: {1} events then {2} steps", m_pass, event_limit,
+           step_limit);
+
+  Status error = Restore(m_segment);
+  if (error.Fail()) {
+    LLDB_LOG(log, "failed to restore checkpoint {0}: {1}", m_segment, error);
+    ResetHistory(tid);
+    EndOperation();
+    return false;
+  }
+  m_replayed = true;
+
+  m_event_limit = event_limit;
+  m_step_limit = step_limit;
+  m_events = 0;
+  m_steps = 0;
+  m_pass_ran = false;
+
+  // The threads that were at a breakpoint went on past it.
+  m_threads_to_step_over.clear();
+  for (const auto &thread : m_checkpoints[m_segment].threads) {
+    if (thread.second.at_breakpoint)
+      m_threads_to_step_over.push_back(thread.first);
+  }
+
+  if (ContinuePass())
+    return true;
+  return PassCompleted(tid);
+}
+
+bool ExecutionHistory::ContinuePass() {
+  if (m_events < m_event_limit) {
+    if (!m_threads_to_step_over.empty()) {
+      NativeThreadLinux *thread =
+          m_process.GetThreadByID(m_threads_to_step_over.back());
+      m_threads_to_step_over.pop_back();
+      if (thread) {
+        m_phase = ePhaseStepOver;
+        StepThread(*thread);
+        return true;
+      }
+      return ContinuePass();
+    }
+
+    m_phase = ePhaseRun;
+    m_pass_ran = true;
+    for (const auto &thread : m_process.m_threads) {
+      m_process.ResumeThread(static_cast<NativeThreadLinux &>(*thread),
+                             eStateRunning, LLDB_INVALID_SIGNAL_NUMBER);
+    }
+    return true;
+  }
+
+  if (m_steps < m_step_limit) {
+    NativeThreadLinux *thread = m_process.GetThreadByID(m_tid);
+    if (!thread)
+      return false;
+    m_phase = ePhaseStep;
+    StepThread(*thread);
+    return true;
+  }
+
+  return false;
+}
+
+void ExecutionHistory::StepThread(NativeThreadLinux &thread) {
+  const lldb::addr_t pc = thread.GetRegisterContext().GetPC();
+  NativeBreakpointSP breakpoint_sp;
+  if (m_process.m_breakpoint_list.GetBreakpoint(pc, breakpoint_sp).Success() &&
+      breakpoint_sp->IsEnabled() && breakpoint_sp->IsSoftwareBreakpoint() &&
+      m_process.m_breakpoint_list.DisableBreakpoint(pc).Success())
+    m_disabled_breakpoint = pc;
+
+  m_pass_ran = true;
+  m_process.ResumeThread(thread, eStateStepping, LLDB_INVALID_SIGNAL_NUMBER);
+}
+
+bool ExecutionHistory::ReplayStopped(lldb::tid_t &tid) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  if (m_disabled_breakpoint != LLDB_INVALID_ADDRESS) {
+    m_process.m_breakpoint_list.EnableBreakpoint(m_disabled_breakpoint);
+    m_disabled_breakpoint = LLDB_INVALID_ADDRESS;
+  }
+
+  NativeThreadLinux *thread = m_process.GetThreadByID(tid);
+  if (!thread || !CanRestore(m_segment)) {
+    LLDB_LOG(log, "the threads changed while replaying");
+    tid = AbortOperation();
+    return false;
+  }
+
+  ThreadStopInfo stop_info;
+  std::string description;
+  thread->GetStopReason(stop_info, description);
+
+  switch (m_phase) {
+  case ePhaseStepOver:
+  case ePhaseStep:
+    if (stop_info.reason != eStopReasonTrace)
+      break;
+    if (m_phase == ePhaseStep) {
+      ++m_steps;
+      if (m_operation == eOperationStep && m_pass == 2 &&
+          IsAtTarget(*thread))
+        return PassCompleted(tid);
+    }
+    if (ContinuePass())
+      return true;
+    return PassCompleted(tid);
+
+  case ePhaseRun: {
+    if (IsAtTarget(*thread)) {
+      if (m_pass == 1)
+        return PassCompleted(tid);
+      // A later pass didn't get as far as the first one.
+      break;
+    }
+
+    bool event;
+    if (stop_info.reason == eStopReasonBreakpoint) {
+      const lldb::addr_t pc = thread->GetRegisterContext().GetPC();
+      if (m_operation == eOperationStep)
+        event = tid == m_tid && pc == m_replay_breakpoint;
+      else
+        event = pc != m_replay_breakpoint || m_replay_breakpoint_is_user;
+    } else if (stop_info.reason == eStopReasonWatchpoint) {
+      event = m_operation == eOperationContinue;
+    } else {
+      break;
+    }
+    if (event)
+      ++m_events;
+
+    for (const auto &thread_up : m_process.m_threads) {
+      ThreadStopInfo info;
+      std::string desc;
+      if (thread_up->GetStopReason(info, desc) &&
+          info.reason == eStopReasonBreakpoint)
+        m_threads_to_step_over.push_back(thread_up->GetID());
+    }
+    if (ContinuePass())
+      return true;
+    return PassCompleted(tid);
+  }
+  }
+
+  // Anything else means the replay went another way than the execution it
+  // replays.
+  LLDB_LOG(log, "replay diverged: tid {0} stopped with reason {1}", tid,
+           stop_info.reason);
+  tid = AbortOperation();
+  return false;
+}
+
+bool ExecutionHistory::PassCompleted(lldb::tid_t &tid) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+  LLDB_LOG(log, "pass {0} complete: {1} events, {2} steps", m_pass, m_events,
+           m_steps);
+
+  if (m_operation == eOperationContinue) {
+    if (m_pass == 2) {
+      // At the last breakpoint or watchpoint hit of the segment.
+      Land(tid);
+      return false;
+    }
+
+    if (m_events > 0) {
+      m_pass = 2;
+      return RunPass(m_events, 0, tid);
+    }
+
+    // Nothing was hit in the segment, so the hit is its start, if that is a
+    // breakpoint that still exists or a watchpoint.
+    const Checkpoint &start = m_checkpoints[m_segment];
+    NativeBreakpointSP breakpoint_sp;
+    auto stop_thread = start.threads.find(start.stop_tid);
+    bool hit = start.stop_info.reason == eStopReasonWatchpoint ||
+               (start.stop_info.reason == eStopReasonBreakpoint &&
+                stop_thread != start.threads.end() &&
+                m_process.m_breakpoint_list
+                    .GetBreakpoint(stop_thread->second.pc, breakpoint_sp)
+                    .Success());
+    if (hit && LandAtCheckpoint(m_segment)) {
+      tid = start.stop_tid;
+      for (const auto &thread_up : m_process.m_threads)
+        static_cast<NativeThreadLinux &>(*thread_up).SetStoppedWithNoReason();
+      if (NativeThreadLinux *thread = m_process.GetThreadByID(tid))
+        thread->SetStoppedWithStopInfo(start.stop_info,
+                                       start.stop_description);
+      EndOperation();
+      return false;
+    }
+    return ReplayPreviousSegment(tid);
+  }
+
+  switch (m_pass) {
+  case 1:
+    // The thread passes the target pc m_events times before it gets to
+    // the target.
+    m_hits = m_events;
+    m_pass = 2;
+    return RunPass(m_hits, k_max_replay_steps, tid);
+
+  case 2: {
+    NativeThreadLinux *thread = m_process.GetThreadByID(m_tid);
+    if (!thread || !IsAtTarget(*thread)) {
+      // The target is more than k_max_replay_steps steps after the last
+      // time its thread passed its pc, or the replay went another way.
+      LLDB_LOG(log, "stepping didn't get to the target");
+      tid = AbortOperation();
+      return false;
+    }
+    // The target is m_steps steps after the last pass, so the instruction
+    // before it is one step less.
+    m_pass = 3;
+    return RunPass(m_hits, m_steps - 1, tid);
+  }
+
+  default:
+    tid = m_tid;
+    for (const auto &thread_up : m_process.m_threads)
+      static_cast<NativeThreadLinux &>(*thread_up).SetStoppedWithNoReason();
+    if (NativeThreadLinux *thread = m_process.GetThreadByID(m_tid))
+      thread->SetStoppedByTrace();
+    Land(tid);
+    return false;
+  }
+}
+
+void ExecutionHistory::Land(lldb::tid_t tid) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  EndOperation();
+
+  // What came after the segment didn't happen anymore.
+  TruncateHistory(m_segment + 1);
+  if (!m_pass_ran)
+    return;
+
+  Checkpoint checkpoint;
+  Status error = TakeCheckpoint(tid, checkpoint);
+  if (error.Fail()) {
+    LLDB_LOG(log, "failed to take a checkpoint: {0}", error);
+    ResetHistory(tid);
+    return;
+  }
+  m_checkpoints.push_back(std::move(checkpoint));
+}
+
+bool ExecutionHistory::LandAtCheckpoint(size_t index) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+
+  Status error = Restore(index);
+  if (error.Fail()) {
+    LLDB_LOG(log, "failed to restore checkpoint {0}: {1}", index, error);
+    return false;
+  }
+  TruncateHistory(index + 1);
+  return true;
+}
+
+lldb::tid_t ExecutionHistory::StopAtHistoryBoundary(size_t index) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+  LLDB_LOG(log, "history boundary at checkpoint {0}", index);
+
+  const bool at_end = index + 1 == m_checkpoints.size();
+  if ((m_replayed || !at_end) && !LandAtCheckpoint(index)) {
+    // The replay left the process somewhere else; make that the start of
+    // the history.
+    ResetHistory(m_process.GetCurrentThreadID());
+  }
+
+  lldb::tid_t tid = m_tid;
+  if (!m_process.GetThreadByID(tid) && !m_checkpoints.empty())
+    tid = m_checkpoints.back().stop_tid;
+  if (!m_process.GetThreadByID(tid))
+    tid = m_process.GetCurrentThreadID();
+
+  for (const auto &thread_up : m_process.m_threads) {
+    auto &thread = static_cast<NativeThreadLinux &>(*thread_up);
+    if (thread.GetID() == tid)
+      thread.SetStoppedByHistoryBoundary();
+    else
+      thread.SetStoppedWithNoReason();
+  }
+  EndOperation();
+  return tid;
+}
+
+lldb::tid_t ExecutionHistory::AbortOperation() {
+  // The replay is somewhere between two checkpoints that the client never
+  // saw. Go back to where the operation started rather than report that.
+  return StopAtHistoryBoundary(m_start_index);
+}
+
+void ExecutionHistory::EndOperation() {
+  if (m_disabled_breakpoint != LLDB_INVALID_ADDRESS) {
+    m_process.m_breakpoint_list.EnableBreakpoint(m_disabled_breakpoint);
+    m_disabled_breakpoint = LLDB_INVALID_ADDRESS;
+  }
+  if (m_replay_breakpoint != LLDB_INVALID_ADDRESS &&
+      !m_replay_breakpoint_is_user)
+    m_process.RemoveBreakpoint(m_replay_breakpoint);
+  m_replay_breakpoint = LLDB_INVALID_ADDRESS;
+  m_replay_breakpoint_is_user = false;
+  m_operation = eOperationNone;
+}
@@ -0,0 +1,235 @@
+//===-- ExecutionHistory.h ------------------------------------ -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_ExecutionHistory_H_
+#define liblldb_ExecutionHistory_H_
+
+#include "lldb/Host/Debug.h"
+#include "lldb/Utility/Status.h"
+#include "lldb/lldb-forward.h"
+#include "lldb/lldb-types.h"
+#include "llvm/ADT/STLExtras.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lldb_private {
+
+namespace process_linux {
+
+class NativeProcessLinux;
+class NativeThreadLinux;
+
+// ---------------------------------------------------------------------
+// This class records the execution history of a process so that it can be
+// run backward, as asked for by the bs and bc packets.
+//
+// Every time the process stops, a checkpoint of it is taken: the registers
+// of all its threads, and the writable memory pages that changed since the
+// previous checkpoint. The pages are found with the soft-dirty bits of the
+// kernel (see Documentation/vm/soft-dirty.txt), so a checkpoint costs in
+// proportion to the memory the inferior wrote rather than to its size. The
+// first checkpoint holds every writable page. Without soft-dirty bits the
+// history isn't recorded at all.
+//
+// Going backward restores an earlier checkpoint and replays the execution
+// from it, to find the last breakpoint hit before the current position, or
+// the instruction before it. A position is recognized when the thread that
+// stopped there arrives at its pc with the same general purpose registers.
+// Replay re-executes system calls and doesn't reproduce the interleaving
+// of threads, so it may diverge from the original execution; replay stops
+// where it diverged in that case.
+// ---------------------------------------------------------------------
+class ExecutionHistory {
+public:
+  ExecutionHistory(NativeProcessLinux &process);
+
+  // Take the first checkpoint. The process must be stopped.
+  Status Start();
+
+  // Whether the history is still recorded. It stops when a checkpoint
+  // can't be taken.
+  bool IsRecording() const { return !m_checkpoints.empty(); }
+
+  // Whether a reverse operation is replaying the execution.
+  bool IsReplaying() const { return m_operation != eOperationNone; }
+
+  // Take a checkpoint of the process, which just stopped because of
+  // \a thread.
+  void ProcessStopped(NativeThreadLinux &thread);
+
+  // Called instead of ProcessStopped() while replaying, when the process
+  // stopped because of \a tid. Returns true if the process was resumed to
+  // continue the replay. Otherwise the reverse operation is done, and \a tid
+  // is the thread whose stop to report.
+  bool ReplayStopped(lldb::tid_t &tid);
+
+  // Run \a thread backward by one instruction. Sets \a resumed if the
+  // process runs to replay the execution; otherwise the operation already
+  // completed and the stop of \a tid must be reported.
+  Status ReverseStep(NativeThreadLinux &thread, bool &resumed,
+                     lldb::tid_t &tid);
+
+  // Run the process backward until the last breakpoint or watchpoint hit
+  // before the current position, or the start of the history.
+  Status ReverseContinue(bool &resumed, lldb::tid_t &tid);
+
+private:
+  // Contents of a page at a checkpoint. A null pointer is a page of zeros.
+  typedef std::shared_ptr<const std::vector<uint8_t>> PageSP;
+
+  struct ThreadState {
+    lldb::DataBufferSP registers;
+    std::vector<uint64_t> gprs; // general purpose registers but the flags
+    lldb::addr_t pc = LLDB_INVALID_ADDRESS;
+    bool at_breakpoint = false; // stopped by the breakpoint at pc
+  };
+
+  // The contents of a page from a checkpoint on.
+  struct PageVersion {
+    uint64_t checkpoint_id;
+    PageSP page;
+  };
+
+  struct Checkpoint {
+    uint64_t id = 0; // increases with every checkpoint taken
+    std::map<lldb::tid_t, ThreadState> threads;
+    std::vector<lldb::addr_t> pages; // pages changed since the previous
+    lldb::tid_t stop_tid = LLDB_INVALID_THREAD_ID;
+    ThreadStopInfo stop_info;
+    std::string stop_description;
+    bool stepped = false; // stop_tid got here with one step from the previous
+  };
+
+  enum Operation { eOperationNone, eOperationStep, eOperationContinue };
+
+  enum Phase { ePhaseStepOver, ePhaseRun, ePhaseStep };
+
+  Status TakeCheckpoint(lldb::tid_t stop_tid, Checkpoint &checkpoint);
+
+  Status ReadThreadState(NativeThreadLinux &thread, ThreadState &state);
+
+  Status ReadGPRs(NativeThreadLinux &thread, std::vector<uint64_t> &gprs);
+
+  // Call \a callback with the address and the /proc/<pid>/pagemap entry of
+  // every writable page of the process.
+  Status ForEachWritablePage(
+      llvm::function_ref<Status(lldb::addr_t, uint64_t, bool)> callback);
+
+  // Save the pages that changed since the previous checkpoint as versions
+  // of \a checkpoint.
+  Status ReadChangedPages(Checkpoint &checkpoint);
+
+  Status ReadPage(lldb::addr_t addr, PageSP &page);
+
+  // Write back the contents the page at \a addr had at checkpoint \a index.
+  Status WritePage(lldb::addr_t addr, size_t index);
+
+  // Find the contents the page at \a addr had at checkpoint \a index.
+  // Returns false if the page wasn't mapped yet.
+  bool FindPage(lldb::addr_t addr, size_t index, PageSP &page) const;
+
+  Status ClearSoftDirtyBits();
+
+  // Forget all the checkpoints, which stops the recording.
+  void ClearHistory();
+
+  // Whether the threads of the process are those of checkpoint \a index.
+  bool CanRestore(size_t index) const;
+
+  Status Restore(size_t index);
+
+  // Drop the checkpoints after the first \a size ones.
+  void TruncateHistory(size_t size);
+
+  // Merge the oldest checkpoints once the history gets too large.
+  void TrimHistory();
+
+  // Forget the history and start it over at the current position.
+  void ResetHistory(lldb::tid_t stop_tid);
+
+  // Replay from m_segment to the position of thread \a tid in \a state.
+  void SetTarget(lldb::tid_t tid, const ThreadState &state);
+
+  bool IsAtTarget(NativeThreadLinux &thread);
+
+  // Replay from m_segment, running all the threads until \a event_limit
+  // events, then stepping m_tid until \a step_limit steps. Returns true if
+  // the process was resumed; otherwise the replay is over and \a tid is the
+  // thread whose stop to report.
+  bool RunPass(uint32_t event_limit, uint32_t step_limit, lldb::tid_t &tid);
+
+  // Resume the process for the next part of the pass. Returns false if the
+  // pass is complete.
+  bool ContinuePass();
+
+  // Single step \a thread, over the breakpoint at its pc if there is one.
+  void StepThread(NativeThreadLinux &thread);
+
+  // Go on with the operation once a pass is complete.
+  bool PassCompleted(lldb::tid_t &tid);
+
+  // Replay the segment before m_segment, for ReverseContinue().
+  bool ReplayPreviousSegment(lldb::tid_t &tid);
+
+  // Make the current position of the replay the end of the history.
+  void Land(lldb::tid_t tid);
+
+  // Go back to checkpoint \a index and make it the end of the history.
+  // Returns false if it can't be restored.
+  bool LandAtCheckpoint(size_t index);
+
+  // Go back to checkpoint \a index, which the process can't run backward
+  // past, and report the history boundary. Returns the thread to report.
+  lldb::tid_t StopAtHistoryBoundary(size_t index);
+
+  // Give up on the reverse operation: go back to the checkpoint it started
+  // from and report the history boundary there. Returns the thread to
+  // report.
+  lldb::tid_t AbortOperation();
+
+  void EndOperation();
+
+  NativeProcessLinux &m_process;
+  std::vector<Checkpoint> m_checkpoints;
+  uint64_t m_next_checkpoint_id = 0;
+  // The versions of every page saved in the history, oldest first
+  std::map<lldb::addr_t, std::vector<PageVersion>> m_pages;
+  size_t m_page_size;
+  std::vector<uint8_t> m_zero_page;
+  size_t m_history_bytes = 0;
+
+  // State of the ongoing reverse operation
+  Operation m_operation = eOperationNone;
+  Phase m_phase = ePhaseRun;
+  size_t m_start_index = 0; // the checkpoint the operation started from
+  size_t m_segment = 0; // replaying from m_checkpoints[m_segment]
+  uint32_t m_pass = 0;
+  bool m_replayed = false;  // some checkpoint was restored
+  bool m_pass_ran = false;  // the current pass resumed the process
+  lldb::tid_t m_tid = LLDB_INVALID_THREAD_ID; // thread stepping backward
+  lldb::tid_t m_target_tid = LLDB_INVALID_THREAD_ID;
+  ThreadState m_target;
+  lldb::addr_t m_replay_breakpoint = LLDB_INVALID_ADDRESS;
+  bool m_replay_breakpoint_is_user = false;
+  uint32_t m_event_limit = 0;
+  uint32_t m_step_limit = 0;
+  uint32_t m_events = 0;
+  uint32_t m_steps = 0;
+  uint32_t m_hits = 0; // times m_tid passes the target pc before the target
+  std::vector<lldb::tid_t> m_threads_to_step_over;
+  lldb::addr_t m_disabled_breakpoint = LLDB_INVALID_ADDRESS;
+};
+
+} // namespace process_linux
+} // namespace lldb_private
+
+#endif // liblldb_ExecutionHistory_H_
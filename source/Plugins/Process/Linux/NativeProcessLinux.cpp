@@ -16,6 +16,7 @@
 #include <unistd.h>
 
 // C++ Includes
+#include <algorithm>
 #include <fstream>
 #include <mutex>
 #include <sstream>
@@ -40,6 +41,8 @@
 #include "lldb/Target/Process.h"
 #include "lldb/Target/ProcessLaunchInfo.h"
 #include "lldb/Target/Target.h"
+#include "lldb/Utility/DataBufferHeap.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/LLDBAssert.h"
 #include "lldb/Utility/Status.h"
 #include "lldb/Utility/StringExtractor.h"
@@ -51,6 +54,7 @@
 #include "Plugins/Process/POSIX/ProcessPOSIXLog.h"
 #include "Procfs.h"
 
+#include <elf.h>
 #include <linux/unistd.h>
 #include <sys/socket.h>
 #include <sys/syscall.h>
@@ -602,15 +606,19 @@ void NativeProcessLinux::MonitorSIGTRAP(const siginfo_t &info,
 
     // Exec clears any pending notifications.
     m_pending_notification_tid = LLDB_INVALID_THREAD_ID;
+    // The new image has its own dynamic linker state.
+    m_debug_entry_addr = LLDB_INVALID_ADDRESS;
+    m_shared_library_info_addr = LLDB_INVALID_ADDRESS;
 
     // Remove all but the main thread here.  Linux fork creates a new process
     // which only copies the main thread.
     LLDB_LOG(log, "exec received, stop tracking all but main thread");
 
     for (auto i = m_threads.begin(); i != m_threads.end();) {
-      if ((*i)->GetID() == GetID())
+      if ((*i)->GetID() == GetID()) {
+        ThreadRemoved(static_cast<NativeThreadLinux &>(**i));
         i = m_threads.erase(i);
-      else
+      } else
         ++i;
     }
     assert(m_threads.size() == 1);
@@ -749,6 +757,9 @@ void NativeProcessLinux::MonitorTrace(NativeThreadLinux &thread) {
   // This thread is currently stopped.
   thread.SetStoppedByTrace();
 
+  if (ContinueLocalStepping(thread))
+    return;
+
   StopRunningThreads(thread.GetID());
 }
 
@@ -764,8 +775,11 @@ void NativeProcessLinux::MonitorBreakpoint(NativeThreadLinux &thread) {
     LLDB_LOG(log, "pid = {0} fixup: {1}", thread.GetID(), error);
 
   if (m_threads_stepping_with_breakpoint.find(thread.GetID()) !=
-      m_threads_stepping_with_breakpoint.end())
+      m_threads_stepping_with_breakpoint.end()) {
     thread.SetStoppedByTrace();
+    if (ContinueLocalStepping(thread))
+      return;
+  }
 
   StopRunningThreads(thread.GetID());
 }
@@ -838,6 +852,10 @@ void NativeProcessLinux::MonitorSignal(const siginfo_t &info,
 
         SetCurrentThreadID(thread.GetID());
         SignalIfAllThreadsStopped();
+      } else if (m_threads_to_report.count(thread.GetID())) {
+        // In non-stop mode, this is a stop the client asked for.
+        thread.SetStoppedWithNoReason();
+        ReportThreadStop(thread);
       } else {
         // We can end up here if stop was initiated by LLGS but by this time a
         // thread stop has occurred - maybe initiated by another event.
@@ -1040,6 +1058,22 @@ NativeProcessLinux::SetupSoftwareSingleStepping(NativeThreadLinux &thread) {
   return Status();
 }
 
+void NativeProcessLinux::RemoveSoftwareSingleStepBreakpoint(
+    NativeThreadLinux &thread) {
+  auto pos = m_threads_stepping_with_breakpoint.find(thread.GetID());
+  if (pos == m_threads_stepping_with_breakpoint.end())
+    return;
+
+  Status error = RemoveBreakpoint(pos->second);
+  if (error.Fail()) {
+    Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS |
+                                      LIBLLDB_LOG_BREAKPOINTS));
+    LLDB_LOG(log, "pid = {0} remove stepping breakpoint: {1}", pos->first,
+             error);
+  }
+  m_threads_stepping_with_breakpoint.erase(pos);
+}
+
 bool NativeProcessLinux::SupportHardwareSingleStepping() const {
   if (m_arch.GetMachine() == llvm::Triple::arm ||
       m_arch.GetMachine() == llvm::Triple::mips64 ||
@@ -1054,31 +1088,31 @@ Status NativeProcessLinux::Resume(const ResumeActionList &resume_actions) {
   Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
   LLDB_LOG(log, "pid {0}", GetID());
 
-  bool software_single_step = !SupportHardwareSingleStepping();
-
-  if (software_single_step) {
-    for (const auto &thread : m_threads) {
-      assert(thread && "thread list should not contain NULL threads");
-
-      const ResumeAction *const action =
-          resume_actions.GetActionForThread(thread->GetID(), true);
-      if (action == nullptr)
-        continue;
-
-      if (action->state == eStateStepping) {
-        Status error = SetupSoftwareSingleStepping(
-            static_cast<NativeThreadLinux &>(*thread));
-        if (error.Fail())
-          return error;
-      }
+  // With thousands of threads, look the actions up by thread ID rather than
+  // scanning the action list for every thread.
+  llvm::DenseMap<lldb::tid_t, const ResumeAction *> actions_by_tid;
+  const ResumeAction *default_action = nullptr;
+  for (size_t i = 0; i < resume_actions.GetSize(); ++i) {
+    const ResumeAction &action = resume_actions.GetFirst()[i];
+    if (action.tid == LLDB_INVALID_THREAD_ID) {
+      if (!default_action)
+        default_action = &action;
+    } else {
+      actions_by_tid.insert({action.tid, &action});
     }
   }
+  auto get_action = [&](lldb::tid_t tid) {
+    auto pos = actions_by_tid.find(tid);
+    return pos == actions_by_tid.end() ? default_action : pos->second;
+  };
 
+  // Gather the threads to resume, so that those sitting on a breakpoint can
+  // step over it first.
+  std::vector<ResumeAction> resumes;
   for (const auto &thread : m_threads) {
     assert(thread && "thread list should not contain NULL threads");
 
-    const ResumeAction *const action =
-        resume_actions.GetActionForThread(thread->GetID(), true);
+    const ResumeAction *const action = get_action(thread->GetID());
 
     if (action == nullptr) {
       LLDB_LOG(log, "no action specified for pid {0} tid {1}", GetID(),
@@ -1092,15 +1126,23 @@ Status NativeProcessLinux::Resume(const ResumeActionList &resume_actions) {
     switch (action->state) {
     case eStateRunning:
     case eStateStepping: {
-      // Run the thread, possibly feeding it the signal.
-      const int signo = action->signal;
-      ResumeThread(static_cast<NativeThreadLinux &>(*thread), action->state,
-                   signo);
+      // In non-stop mode, actions only apply to the threads that are stopped.
+      if (m_non_stop && StateIsRunningState(thread->GetState()))
+        break;
+      ResumeAction resume = *action;
+      resume.tid = thread->GetID();
+      resumes.push_back(resume);
       break;
     }
 
-    case eStateSuspended:
     case eStateStopped:
+      // Stopped threads stay stopped. In non-stop mode, this asks a running
+      // thread to stop.
+      if (m_non_stop && StateIsRunningState(thread->GetState()))
+        RequestThreadStop(static_cast<NativeThreadLinux &>(*thread));
+      break;
+
+    case eStateSuspended:
       llvm_unreachable("Unexpected state");
 
     default:
@@ -1111,9 +1153,176 @@ Status NativeProcessLinux::Resume(const ResumeActionList &resume_actions) {
     }
   }
 
+  for (const ResumeAction &resume : resumes) {
+    NativeThreadLinux *thread = GetThreadByID(resume.tid);
+    // Stepping through a range in software would write the memory of the
+    // process while other threads run, so those step one instruction.
+    if (resume.state == eStateStepping &&
+        resume.step_range_start < resume.step_range_end &&
+        SupportHardwareSingleStepping())
+      m_step_ranges[resume.tid] = {resume.step_range_start,
+                                   resume.step_range_end};
+
+    // Rather than leaving it to the client, step over the breakpoint the
+    // thread is sitting on, if any. In non-stop mode the other threads may be
+    // running and would miss the breakpoint while it is removed, so the
+    // client steps over it with all the threads stopped instead.
+    if (m_non_stop)
+      continue;
+    const lldb::addr_t pc = thread->GetRegisterContext().GetPC();
+    NativeBreakpointSP breakpoint_sp;
+    if (m_breakpoint_list.GetBreakpoint(pc, breakpoint_sp).Success() &&
+        breakpoint_sp->IsEnabled() && breakpoint_sp->IsSoftwareBreakpoint())
+      m_threads_to_step_over.push_back(resume.tid);
+  }
+
+  m_deferred_resumes = std::move(resumes);
+  return StepOverBreakpoints();
+}
+
+Status NativeProcessLinux::StepOverBreakpoints() {
+  Log *log(
+      GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_BREAKPOINTS));
+
+  while (!m_threads_to_step_over.empty()) {
+    const lldb::tid_t tid = m_threads_to_step_over.front();
+    m_threads_to_step_over.erase(m_threads_to_step_over.begin());
+    NativeThreadLinux *thread = GetThreadByID(tid);
+    auto resume = llvm::find_if(m_deferred_resumes,
+                                [tid](const ResumeAction &action) {
+                                  return action.tid == tid;
+                                });
+    if (!thread || resume == m_deferred_resumes.end())
+      continue;
+
+    const lldb::addr_t pc = thread->GetRegisterContext().GetPC();
+    Status error = m_breakpoint_list.DisableBreakpoint(pc);
+    if (error.Fail()) {
+      LLDB_LOG(log, "tid {0} can't step over the breakpoint at {1:x}: {2}",
+               tid, pc, error);
+      continue;
+    }
+    LLDB_LOG(log, "tid {0} steps over the breakpoint at {1:x}", tid, pc);
+    m_step_over_tid = tid;
+    m_step_over_addr = pc;
+
+    // The signal to resume the thread with is delivered by the step.
+    const int signo = resume->signal;
+    resume->signal = 0;
+    if (!SupportHardwareSingleStepping()) {
+      error = SetupSoftwareSingleStepping(*thread);
+      if (error.Fail())
+        return error;
+    }
+    return ResumeThread(*thread, eStateStepping, signo);
+  }
+
+  std::vector<ResumeAction> resumes = std::move(m_deferred_resumes);
+  m_deferred_resumes.clear();
+
+  // Set up all the software single steps first, as the memory of the process
+  // can't be written once its main thread runs.
+  if (!SupportHardwareSingleStepping()) {
+    for (const ResumeAction &resume : resumes) {
+      NativeThreadLinux *thread = GetThreadByID(resume.tid);
+      if (!thread || resume.state != eStateStepping)
+        continue;
+      Status error = SetupSoftwareSingleStepping(*thread);
+      if (error.Fail())
+        return error;
+    }
+  }
+
+  for (const ResumeAction &resume : resumes) {
+    // Run the thread, possibly feeding it the signal.
+    if (NativeThreadLinux *thread = GetThreadByID(resume.tid))
+      ResumeThread(*thread, resume.state, resume.signal);
+  }
   return Status();
 }
 
+bool NativeProcessLinux::ContinueLocalStepping(NativeThreadLinux &thread) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_THREAD));
+  const lldb::tid_t tid = thread.GetID();
+
+  bool continue_step = false;
+  if (tid == m_step_over_tid) {
+    RemoveSoftwareSingleStepBreakpoint(thread);
+    m_breakpoint_list.EnableBreakpoint(m_step_over_addr);
+    m_step_over_tid = LLDB_INVALID_THREAD_ID;
+    m_step_over_addr = LLDB_INVALID_ADDRESS;
+
+    auto resume = llvm::find_if(m_deferred_resumes,
+                                [tid](const ResumeAction &action) {
+                                  return action.tid == tid;
+                                });
+    if (resume != m_deferred_resumes.end() &&
+        resume->state == eStateRunning) {
+      // The thread resumes with the others.
+      StepOverBreakpoints();
+      return true;
+    }
+    continue_step = true;
+  }
+
+  auto range = m_step_ranges.find(tid);
+  if (range == m_step_ranges.end())
+    return false;
+
+  // Keep stepping while in the range, unless a stop is already on its way.
+  // Stopping at a breakpoint in the range lets the client see it.
+  const lldb::addr_t pc = thread.GetRegisterContext().GetPC();
+  NativeBreakpointSP breakpoint_sp;
+  if (m_pending_notification_tid != LLDB_INVALID_THREAD_ID ||
+      pc < range->second.first || pc >= range->second.second ||
+      (m_breakpoint_list.GetBreakpoint(pc, breakpoint_sp).Success() &&
+       breakpoint_sp->IsEnabled())) {
+    m_step_ranges.erase(range);
+    if (m_pending_notification_tid != LLDB_INVALID_THREAD_ID) {
+      // The thread counts as stopped by the stop that is on its way.
+      SignalIfAllThreadsStopped();
+      return true;
+    }
+    return false;
+  }
+
+  LLDB_LOG(log, "tid {0} keeps stepping at {1:x}", tid, pc);
+  if (continue_step) {
+    // The thread steps on once the others are resumed.
+    StepOverBreakpoints();
+    return true;
+  }
+  ResumeThread(thread, eStateStepping, LLDB_INVALID_SIGNAL_NUMBER);
+  return true;
+}
+
+void NativeProcessLinux::ClearLocalStepping(lldb::tid_t tid) {
+  if (m_step_over_tid != LLDB_INVALID_THREAD_ID &&
+      (tid == LLDB_INVALID_THREAD_ID || tid == m_step_over_tid)) {
+    m_breakpoint_list.EnableBreakpoint(m_step_over_addr);
+    m_step_over_tid = LLDB_INVALID_THREAD_ID;
+    m_step_over_addr = LLDB_INVALID_ADDRESS;
+  }
+
+  if (tid == LLDB_INVALID_THREAD_ID) {
+    m_threads_to_step_over.clear();
+    m_deferred_resumes.clear();
+    m_step_ranges.clear();
+    return;
+  }
+
+  m_threads_to_step_over.erase(std::remove(m_threads_to_step_over.begin(),
+                                           m_threads_to_step_over.end(), tid),
+                               m_threads_to_step_over.end());
+  m_deferred_resumes.erase(std::remove_if(m_deferred_resumes.begin(),
+                                          m_deferred_resumes.end(),
+                                          [tid](const ResumeAction &action) {
+                                            return action.tid == tid;
+                                          }),
+                           m_deferred_resumes.end());
+  m_step_ranges.erase(tid);
+}
+
 Status NativeProcessLinux::Halt() {
   Status error;
 
@@ -1164,6 +1373,15 @@ Status NativeProcessLinux::Interrupt() {
   // chosen thread that will be the stop-reason thread.
   Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
 
+  if (m_non_stop) {
+    // Stop every running thread; each one reports its own stop.
+    for (const auto &thread : m_threads) {
+      if (StateIsRunningState(thread->GetState()))
+        RequestThreadStop(static_cast<NativeThreadLinux &>(*thread));
+    }
+    return Status();
+  }
+
   NativeThreadProtocol *running_thread = nullptr;
   NativeThreadProtocol *stopped_thread = nullptr;
 
@@ -1490,9 +1708,174 @@ Status NativeProcessLinux::DeallocateMemory(lldb::addr_t addr) {
   return Status("not implemented");
 }
 
+lldb::addr_t NativeProcessLinux::GetDebugEntryAddress() {
+  if (m_debug_entry_addr != LLDB_INVALID_ADDRESS)
+    return m_debug_entry_addr;
+
+  // The program headers, and through them the dynamic section, are found
+  // through the auxiliary vector.
+  auto buffer_or_error = GetAuxvData();
+  if (!buffer_or_error)
+    return LLDB_INVALID_ADDRESS;
+  const uint32_t addr_size = m_arch.GetAddressByteSize();
+  const lldb::ByteOrder byte_order = m_arch.GetByteOrder();
+  DataExtractor auxv((*buffer_or_error)->getBufferStart(),
+                     (*buffer_or_error)->getBufferSize(), byte_order,
+                     addr_size);
+
+  lldb::addr_t phdr_addr = LLDB_INVALID_ADDRESS;
+  uint64_t phdr_count = 0;
+  lldb::offset_t offset = 0;
+  while (auxv.ValidOffsetForDataOfSize(offset, 2 * addr_size)) {
+    const uint64_t type = auxv.GetAddress(&offset);
+    const uint64_t value = auxv.GetAddress(&offset);
+    if (type == AT_NULL)
+      break;
+    if (type == AT_PHDR)
+      phdr_addr = value;
+    else if (type == AT_PHNUM)
+      phdr_count = value;
+  }
+  if (phdr_addr == LLDB_INVALID_ADDRESS || phdr_count == 0)
+    return LLDB_INVALID_ADDRESS;
+
+  // Read all program headers at once.
+  const bool is_64 = addr_size == 8;
+  const size_t phdr_size = is_64 ? sizeof(Elf64_Phdr) : sizeof(Elf32_Phdr);
+  DataBufferHeap phdrs(phdr_count * phdr_size, 0);
+  size_t bytes_read;
+  if (ReadMemory(phdr_addr, phdrs.GetBytes(), phdrs.GetByteSize(), bytes_read)
+          .Fail() ||
+      bytes_read != phdrs.GetByteSize())
+    return LLDB_INVALID_ADDRESS;
+  DataExtractor phdr_data(phdrs.GetBytes(), phdrs.GetByteSize(), byte_order,
+                          addr_size);
+
+  lldb::addr_t load_bias = 0;
+  lldb::addr_t dynamic_vaddr = LLDB_INVALID_ADDRESS;
+  uint64_t dynamic_size = 0;
+  for (uint64_t i = 0; i < phdr_count; ++i) {
+    offset = i * phdr_size;
+    const uint32_t p_type = phdr_data.GetU32(&offset);
+    // The 64 bit header has p_flags before p_offset, the 32 bit one after
+    // p_align.
+    offset += is_64 ? 4 + 8 : 4;
+    const lldb::addr_t p_vaddr = phdr_data.GetAddress(&offset);
+    phdr_data.GetAddress(&offset); // p_paddr
+    phdr_data.GetAddress(&offset); // p_filesz
+    const uint64_t p_memsz = phdr_data.GetAddress(&offset);
+    if (p_type == PT_PHDR) {
+      load_bias = phdr_addr - p_vaddr;
+    } else if (p_type == PT_DYNAMIC) {
+      dynamic_vaddr = p_vaddr;
+      dynamic_size = p_memsz;
+    }
+  }
+  if (dynamic_vaddr == LLDB_INVALID_ADDRESS || dynamic_size == 0 ||
+      dynamic_size > 1024 * 1024)
+    return LLDB_INVALID_ADDRESS;
+
+  DataBufferHeap dynamic(dynamic_size, 0);
+  if (ReadMemory(dynamic_vaddr + load_bias, dynamic.GetBytes(),
+                 dynamic.GetByteSize(), bytes_read)
+          .Fail())
+    return LLDB_INVALID_ADDRESS;
+  DataExtractor dynamic_data(dynamic.GetBytes(), bytes_read, byte_order,
+                             addr_size);
+  offset = 0;
+  while (dynamic_data.ValidOffsetForDataOfSize(offset, 2 * addr_size)) {
+    const uint64_t tag = dynamic_data.GetAddress(&offset);
+    if (tag == DT_NULL)
+      break;
+    if (tag == DT_DEBUG) {
+      m_debug_entry_addr = dynamic_vaddr + load_bias + offset;
+      break;
+    }
+    dynamic_data.GetAddress(&offset);
+  }
+  return m_debug_entry_addr;
+}
+
 lldb::addr_t NativeProcessLinux::GetSharedLibraryInfoAddress() {
-  // punt on this for now
-  return LLDB_INVALID_ADDRESS;
+  if (m_shared_library_info_addr != LLDB_INVALID_ADDRESS)
+    return m_shared_library_info_addr;
+
+  // The DT_DEBUG entry of the executable's dynamic section points to the
+  // r_debug structure. The dynamic linker fills it in once it has
+  // initialized itself.
+  const lldb::addr_t debug_entry_addr = GetDebugEntryAddress();
+  if (debug_entry_addr == LLDB_INVALID_ADDRESS)
+    return LLDB_INVALID_ADDRESS;
+  const uint32_t addr_size = m_arch.GetAddressByteSize();
+  uint8_t bytes[8];
+  size_t bytes_read;
+  if (ReadMemory(debug_entry_addr, bytes, addr_size, bytes_read).Fail() ||
+      bytes_read != addr_size)
+    return LLDB_INVALID_ADDRESS;
+  DataExtractor data(bytes, addr_size, m_arch.GetByteOrder(), addr_size);
+  lldb::offset_t offset = 0;
+  const lldb::addr_t value = data.GetAddress(&offset);
+  if (value != 0)
+    m_shared_library_info_addr = value;
+  return m_shared_library_info_addr;
+}
+
+llvm::Expected<std::vector<SVR4LibraryInfo>>
+NativeProcessLinux::GetLoadedSVR4Libraries() {
+  const lldb::addr_t info_addr = GetSharedLibraryInfoAddress();
+  if (info_addr == LLDB_INVALID_ADDRESS)
+    return llvm::make_error<StringError>("Invalid shared library info address",
+                                         llvm::inconvertibleErrorCode());
+
+  // struct r_debug { int r_version; struct link_map *r_map; ... }, with
+  // r_map aligned to the pointer size.
+  const uint32_t addr_size = m_arch.GetAddressByteSize();
+  const lldb::ByteOrder byte_order = m_arch.GetByteOrder();
+  lldb::addr_t link_map = 0;
+  size_t bytes_read;
+  Status error =
+      ReadMemory(info_addr + addr_size, &link_map, addr_size, bytes_read);
+  if (error.Fail() || bytes_read != addr_size)
+    return llvm::make_error<StringError>("Could not read the link map head",
+                                         llvm::inconvertibleErrorCode());
+  DataExtractor head(&link_map, addr_size, byte_order, addr_size);
+  lldb::offset_t offset = 0;
+  link_map = head.GetAddress(&offset);
+
+  // struct link_map { l_addr, l_name, l_ld, l_next, l_prev }, all pointer
+  // sized. Each entry is read with one memory read.
+  std::vector<SVR4LibraryInfo> libraries;
+  uint8_t entry_bytes[5 * 8];
+  char name_buffer[PATH_MAX];
+  while (link_map != 0) {
+    // Guard against a corrupt, circular list.
+    if (libraries.size() >= 65536)
+      return llvm::make_error<StringError>("Link map list is too long",
+                                           llvm::inconvertibleErrorCode());
+    error = ReadMemory(link_map, entry_bytes, 5 * addr_size, bytes_read);
+    if (error.Fail() || bytes_read != 5 * addr_size)
+      return llvm::make_error<StringError>("Could not read a link map entry",
+                                           llvm::inconvertibleErrorCode());
+    DataExtractor entry(entry_bytes, 5 * addr_size, byte_order, addr_size);
+    offset = 0;
+    SVR4LibraryInfo info;
+    info.link_map = link_map;
+    info.base_addr = entry.GetAddress(&offset);
+    const lldb::addr_t name_addr = entry.GetAddress(&offset);
+    info.ld_addr = entry.GetAddress(&offset);
+    info.next = entry.GetAddress(&offset);
+
+    size_t name_size = 0;
+    if (name_addr != 0 &&
+        ReadCStringFromMemory(name_addr, name_buffer, sizeof(name_buffer),
+                              name_size)
+            .Success())
+      info.name.assign(name_buffer, name_size);
+
+    link_map = info.next;
+    libraries.push_back(std::move(info));
+  }
+  return std::move(libraries);
 }
 
 size_t NativeProcessLinux::UpdateThreads() {
@@ -1654,13 +2037,14 @@ Status NativeProcessLinux::ReadMemory(lldb::addr_t addr, void *buf, size_t size,
   unsigned char *dst = static_cast<unsigned char *>(buf);
   size_t remainder;
   long data;
+  const lldb::tid_t tid = GetMemoryAccessThreadID();
 
   Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_MEMORY));
   LLDB_LOG(log, "addr = {0}, buf = {1}, size = {2}", addr, buf, size);
 
   for (bytes_read = 0; bytes_read < size; bytes_read += remainder) {
     Status error = NativeProcessLinux::PtraceWrapper(
-        PTRACE_PEEKDATA, GetID(), (void *)addr, nullptr, 0, &data);
+        PTRACE_PEEKDATA, tid, (void *)addr, nullptr, 0, &data);
     if (error.Fail())
       return error;
 
@@ -1691,6 +2075,7 @@ Status NativeProcessLinux::WriteMemory(lldb::addr_t addr, const void *buf,
   const unsigned char *src = static_cast<const unsigned char *>(buf);
   size_t remainder;
   Status error;
+  const lldb::tid_t tid = GetMemoryAccessThreadID();
 
   Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_MEMORY));
   LLDB_LOG(log, "addr = {0}, buf = {1}, size = {2}", addr, buf, size);
@@ -1704,7 +2089,7 @@ Status NativeProcessLinux::WriteMemory(lldb::addr_t addr, const void *buf,
       memcpy(&data, src, k_ptrace_word_size);
 
       LLDB_LOG(log, "[{0:x}]:{1:x}", addr, data);
-      error = NativeProcessLinux::PtraceWrapper(PTRACE_POKEDATA, GetID(),
+      error = NativeProcessLinux::PtraceWrapper(PTRACE_POKEDATA, tid,
                                                 (void *)addr, (void *)data);
       if (error.Fail())
         return error;
@@ -1732,6 +2117,18 @@ Status NativeProcessLinux::WriteMemory(lldb::addr_t addr, const void *buf,
   return error;
 }
 
+lldb::tid_t NativeProcessLinux::GetMemoryAccessThreadID() const {
+  if (m_non_stop) {
+    for (const auto &thread : m_threads) {
+      if (!StateIsRunningState(thread->GetState()))
+        return thread->GetID();
+    }
+  }
+  // With every thread running there is nothing to trace through, and the
+  // access fails.
+  return GetID();
+}
+
 Status NativeProcessLinux::GetSignalInfo(lldb::tid_t tid, void *siginfo) {
   return PtraceWrapper(PTRACE_GETSIGINFO, tid, nullptr, siginfo);
 }
@@ -1749,16 +2146,7 @@ Status NativeProcessLinux::Detach(lldb::tid_t tid) {
 }
 
 bool NativeProcessLinux::HasThreadNoLock(lldb::tid_t thread_id) {
-  for (const auto &thread : m_threads) {
-    assert(thread && "thread list should not contain NULL threads");
-    if (thread->GetID() == thread_id) {
-      // We have this thread.
-      return true;
-    }
-  }
-
-  // We don't have this thread.
-  return false;
+  return m_threads_by_id.count(thread_id) != 0;
 }
 
 bool NativeProcessLinux::StopTrackingThread(lldb::tid_t thread_id) {
@@ -1766,16 +2154,25 @@ bool NativeProcessLinux::StopTrackingThread(lldb::tid_t thread_id) {
   LLDB_LOG(log, "tid: {0})", thread_id);
 
   bool found = false;
-  for (auto it = m_threads.begin(); it != m_threads.end(); ++it) {
-    if (*it && ((*it)->GetID() == thread_id)) {
-      m_threads.erase(it);
-      found = true;
-      break;
-    }
-  }
-
-  if (found)
+  auto thread_it = m_threads_by_id.find(thread_id);
+  if (thread_it != m_threads_by_id.end()) {
+    NativeThreadLinux *thread = thread_it->second;
+    ThreadRemoved(*thread);
+    m_threads.erase(llvm::find_if(
+        m_threads, [thread](const std::unique_ptr<NativeThreadProtocol> &t) {
+          return t.get() == thread;
+        }));
+    found = true;
+  }
+
+  if (found) {
     StopTracingForThread(thread_id);
+    // The other threads go on if the thread stepping over a breakpoint exits.
+    const bool stepping_over = thread_id == m_step_over_tid;
+    ClearLocalStepping(thread_id);
+    if (stepping_over)
+      StepOverBreakpoints();
+  }
   SignalIfAllThreadsStopped();
   return found;
 }
@@ -1792,6 +2189,8 @@ NativeThreadLinux &NativeProcessLinux::AddThread(lldb::tid_t thread_id) {
     SetCurrentThreadID(thread_id);
 
   m_threads.push_back(llvm::make_unique<NativeThreadLinux>(*this, thread_id));
+  m_threads_by_id[thread_id] =
+      static_cast<NativeThreadLinux *>(m_threads.back().get());
 
   if (m_pt_proces_trace_id != LLDB_INVALID_UID) {
     auto traceMonitor = ProcessorTraceMonitor::Create(
@@ -1810,6 +2209,23 @@ NativeThreadLinux &NativeProcessLinux::AddThread(lldb::tid_t thread_id) {
   return static_cast<NativeThreadLinux &>(*m_threads.back());
 }
 
+void NativeProcessLinux::ThreadRemoved(NativeThreadLinux &thread) {
+  if (StateIsRunningState(thread.GetState()))
+    --m_num_running_threads;
+  m_threads_by_id.erase(thread.GetID());
+  m_threads_to_report.erase(thread.GetID());
+}
+
+void NativeProcessLinux::ThreadStateChanged(lldb::StateType old_state,
+                                            lldb::StateType new_state) {
+  const bool was_running = StateIsRunningState(old_state);
+  const bool is_running = StateIsRunningState(new_state);
+  if (is_running && !was_running)
+    ++m_num_running_threads;
+  else if (was_running && !is_running)
+    --m_num_running_threads;
+}
+
 Status
 NativeProcessLinux::FixupBreakpointPCAsNeeded(NativeThreadLinux &thread) {
   Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_BREAKPOINTS));
@@ -1924,8 +2340,8 @@ Status NativeProcessLinux::GetFileLoadAddress(const llvm::StringRef &file_name,
 }
 
 NativeThreadLinux *NativeProcessLinux::GetThreadByID(lldb::tid_t tid) {
-  return static_cast<NativeThreadLinux *>(
-      NativeProcessProtocol::GetThreadByID(tid));
+  std::lock_guard<std::recursive_mutex> guard(m_threads_mutex);
+  return m_threads_by_id.lookup(tid);
 }
 
 Status NativeProcessLinux::ResumeThread(NativeThreadLinux &thread,
@@ -1974,6 +2390,13 @@ void NativeProcessLinux::StopRunningThreads(const lldb::tid_t triggering_tid) {
   LLDB_LOG(log, "about to process event: (triggering_tid: {0})",
            triggering_tid);
 
+  if (m_non_stop) {
+    // Only the triggering thread stops, the others keep running.
+    if (NativeThreadLinux *thread = GetThreadByID(triggering_tid))
+      ReportThreadStop(*thread);
+    return;
+  }
+
   m_pending_notification_tid = triggering_tid;
 
   // Request a stop for all the thread stops that need to be stopped and are
@@ -1991,10 +2414,8 @@ void NativeProcessLinux::SignalIfAllThreadsStopped() {
   if (m_pending_notification_tid == LLDB_INVALID_THREAD_ID)
     return; // No pending notification. Nothing to do.
 
-  for (const auto &thread_sp : m_threads) {
-    if (StateIsRunningState(thread_sp->GetState()))
-      return; // Some threads are still running. Don't signal yet.
-  }
+  if (m_num_running_threads > 0)
+    return; // Some threads are still running. Don't signal yet.
 
   // We have a pending notification and all threads have stopped.
   Log *log(
@@ -2009,11 +2430,117 @@ void NativeProcessLinux::SignalIfAllThreadsStopped() {
                thread_info.first, error);
   }
   m_threads_stepping_with_breakpoint.clear();
+  ClearLocalStepping();
+
+  lldb::tid_t tid = m_pending_notification_tid;
+  m_pending_notification_tid = LLDB_INVALID_THREAD_ID;
+
+  if (m_history) {
+    // While running backward, the stops belong to the replay until it is
+    // over.
+    if (m_history->IsReplaying()) {
+      if (m_history->ReplayStopped(tid))
+        return;
+    } else if (NativeThreadLinux *thread = GetThreadByID(tid)) {
+      m_history->ProcessStopped(*thread);
+    }
+    if (!m_history->IsRecording()) {
+      LLDB_LOG(log, "pid {0}: the execution history is no longer recorded",
+               GetID());
+      m_history.reset();
+    }
+  }
 
   // Notify the delegate about the stop
-  SetCurrentThreadID(m_pending_notification_tid);
+  SetCurrentThreadID(tid);
   SetState(StateType::eStateStopped, true);
-  m_pending_notification_tid = LLDB_INVALID_THREAD_ID;
+}
+
+void NativeProcessLinux::ReportThreadStop(NativeThreadLinux &thread) {
+  Log *log(
+      GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_BREAKPOINTS));
+  LLDB_LOG(log, "tid: {0}", thread.GetID());
+
+  m_threads_to_report.erase(thread.GetID());
+
+  // Clear the temporary breakpoint if this thread was single stepping in
+  // software.
+  RemoveSoftwareSingleStepBreakpoint(thread);
+
+  ClearLocalStepping(thread.GetID());
+
+  SetCurrentThreadID(thread.GetID());
+  // The process as a whole only counts as stopped once all its threads are.
+  // The delegates hear about each thread instead.
+  if (m_num_running_threads == 0)
+    SetState(StateType::eStateStopped, false);
+  NotifyThreadStopped(thread);
+}
+
+void NativeProcessLinux::RequestThreadStop(NativeThreadLinux &thread) {
+  m_threads_to_report.insert(thread.GetID());
+  thread.RequestStop();
+}
+
+Status NativeProcessLinux::SetRecordHistory(bool enabled) {
+  if (!enabled) {
+    if (m_history && m_history->IsReplaying())
+      return Status("the process is running backward");
+    m_history.reset();
+    return Status();
+  }
+
+  if (m_non_stop)
+    return Status("the execution history can't be recorded in non-stop mode");
+  if (m_history)
+    return Status();
+
+  auto history = llvm::make_unique<ExecutionHistory>(*this);
+  Status error = history->Start();
+  if (error.Fail())
+    return error;
+  m_history = std::move(history);
+  return Status();
+}
+
+Status NativeProcessLinux::ReverseResume(lldb::tid_t tid,
+                                         lldb::StateType state) {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_PROCESS));
+  LLDB_LOG(log, "pid {0} tid {1} state {2}", GetID(), tid, state);
+
+  if (!m_history)
+    return Status("the execution history isn't recorded");
+  if (m_history->IsReplaying())
+    return Status("the process is already running backward");
+
+  bool resumed = false;
+  lldb::tid_t stop_tid = LLDB_INVALID_THREAD_ID;
+  Status error;
+  switch (state) {
+  case eStateStepping: {
+    NativeThreadLinux *thread = GetThreadByID(tid);
+    if (!thread)
+      return Status("no thread %" PRIu64, tid);
+    error = m_history->ReverseStep(*thread, resumed, stop_tid);
+    break;
+  }
+  case eStateRunning:
+    error = m_history->ReverseContinue(resumed, stop_tid);
+    break;
+  default:
+    return Status("unexpected state %s", StateAsCString(state));
+  }
+  if (!resumed && !m_history->IsRecording())
+    m_history.reset();
+  if (error.Fail() || resumed)
+    return error;
+
+  // The history had what it takes, and the process didn't need to run. It
+  // still goes through a resume and a stop for the delegates.
+  SetState(StateType::eStateRunning, true);
+  SetCurrentThreadID(stop_tid);
+  SetState(StateType::eStateStopped, true);
+  return Status();
 }
 
 void NativeProcessLinux::ThreadWasCreated(NativeThreadLinux &thread) {
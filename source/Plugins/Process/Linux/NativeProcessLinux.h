@@ -20,7 +20,10 @@
 #include "lldb/Utility/ArchSpec.h"
 #include "lldb/Utility/FileSpec.h"
 #include "lldb/lldb-types.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 
+#include "ExecutionHistory.h"
 #include "NativeThreadLinux.h"
 #include "ProcessorTrace.h"
 #include "lldb/Host/common/NativeProcessProtocol.h"
@@ -38,6 +41,9 @@ namespace process_linux {
 ///
 /// Changes in the inferior process state are broadcasted.
 class NativeProcessLinux : public NativeProcessProtocol {
+  friend class ExecutionHistory;
+  friend class NativeThreadLinux;
+
 public:
   class Factory : public NativeProcessProtocol::Factory {
   public:
@@ -48,6 +54,8 @@ public:
     llvm::Expected<std::unique_ptr<NativeProcessProtocol>>
     Attach(lldb::pid_t pid, NativeDelegate &native_delegate,
            MainLoop &mainloop) const override;
+
+    bool SupportsNonStopMode() const override { return true; }
   };
 
   // ---------------------------------------------------------------------
@@ -84,6 +92,11 @@ public:
 
   lldb::addr_t GetSharedLibraryInfoAddress() override;
 
+  lldb::addr_t GetDebugEntryAddress() override;
+
+  llvm::Expected<std::vector<SVR4LibraryInfo>>
+  GetLoadedSVR4Libraries() override;
+
   size_t UpdateThreads() override;
 
   const ArchSpec &GetArchitecture() const override { return m_arch; }
@@ -124,6 +137,10 @@ public:
 
   Status GetTraceConfig(lldb::user_id_t traceid, TraceOptions &config) override;
 
+  Status SetRecordHistory(bool enabled) override;
+
+  Status ReverseResume(lldb::tid_t tid, lldb::StateType state) override;
+
   // ---------------------------------------------------------------------
   // Interface used by NativeRegisterContext-derived classes.
   // ---------------------------------------------------------------------
@@ -151,10 +168,44 @@ private:
 
   lldb::tid_t m_pending_notification_tid = LLDB_INVALID_THREAD_ID;
 
+  // The threads by ID, so that wait notifications can be matched to their
+  // thread without a scan of m_threads.
+  llvm::DenseMap<lldb::tid_t, NativeThreadLinux *> m_threads_by_id;
+
+  // The number of threads in a running state, so that we know when all
+  // threads stopped without a scan of m_threads after every stop.
+  size_t m_num_running_threads = 0;
+
+  // The address of the value of the DT_DEBUG entry in the executable's
+  // dynamic section, and of the dynamic linker's r_debug structure it points
+  // to once the dynamic linker has been initialized.
+  lldb::addr_t m_debug_entry_addr = LLDB_INVALID_ADDRESS;
+  lldb::addr_t m_shared_library_info_addr = LLDB_INVALID_ADDRESS;
+
   // List of thread ids stepping with a breakpoint with the address of
   // the relevan breakpoint
   std::map<lldb::tid_t, lldb::addr_t> m_threads_stepping_with_breakpoint;
 
+  // In non-stop mode, the threads we asked to stop on behalf of the client,
+  // whose stops must be reported rather than swallowed.
+  llvm::DenseSet<lldb::tid_t> m_threads_to_report;
+
+  // The execution history, while it is recorded.
+  std::unique_ptr<ExecutionHistory> m_history;
+
+  // In all-stop mode, the threads resumed from a software breakpoint step
+  // over it before the others resume, one at a time, with the trap removed
+  // while it steps.
+  std::vector<lldb::tid_t> m_threads_to_step_over;
+  lldb::tid_t m_step_over_tid = LLDB_INVALID_THREAD_ID;
+  lldb::addr_t m_step_over_addr = LLDB_INVALID_ADDRESS;
+  // What to resume the threads with once the breakpoints are stepped over.
+  std::vector<ResumeAction> m_deferred_resumes;
+
+  // The threads stepping through a range of addresses, which stop only once
+  // they leave it.
+  std::map<lldb::tid_t, std::pair<lldb::addr_t, lldb::addr_t>> m_step_ranges;
+
   // ---------------------------------------------------------------------
   // Private Instance Methods
   // ---------------------------------------------------------------------
@@ -184,12 +235,34 @@ private:
 
   Status SetupSoftwareSingleStepping(NativeThreadLinux &thread);
 
+  // Remove the breakpoint \a thread single steps in software with, if any.
+  void RemoveSoftwareSingleStepBreakpoint(NativeThreadLinux &thread);
+
+  // Step the next thread of m_threads_to_step_over over its breakpoint, or
+  // resume the threads of m_deferred_resumes once there are none left.
+  Status StepOverBreakpoints();
+
+  // Called when \a thread completed a single step. Returns true if the step
+  // was part of a breakpoint step over or a range step, which went on.
+  // Otherwise the stop of \a thread must be reported.
+  bool ContinueLocalStepping(NativeThreadLinux &thread);
+
+  // Drop the breakpoint step overs and range steps of \a tid, or of all the
+  // threads, as their stop gets reported.
+  void ClearLocalStepping(lldb::tid_t tid = LLDB_INVALID_THREAD_ID);
+
   bool HasThreadNoLock(lldb::tid_t thread_id);
 
   bool StopTrackingThread(lldb::tid_t thread_id);
 
   NativeThreadLinux &AddThread(lldb::tid_t thread_id);
 
+  // Bookkeeping for a thread that is about to be removed from m_threads.
+  void ThreadRemoved(NativeThreadLinux &thread);
+
+  // Called by NativeThreadLinux whenever its state changes.
+  void ThreadStateChanged(lldb::StateType old_state, lldb::StateType new_state);
+
   Status GetSoftwareBreakpointPCOffset(uint32_t &actual_opcode_size);
 
   Status FixupBreakpointPCAsNeeded(NativeThreadLinux &thread);
@@ -217,6 +290,18 @@ private:
   // Notify the delegate if all threads have stopped.
   void SignalIfAllThreadsStopped();
 
+  // In non-stop mode, report that \a thread stopped while leaving the other
+  // threads alone.
+  void ReportThreadStop(NativeThreadLinux &thread);
+
+  // In non-stop mode, ask a running thread to stop and report its stop.
+  void RequestThreadStop(NativeThreadLinux &thread);
+
+  // The thread to peek and poke memory through. ptrace only works on stopped
+  // threads, and in non-stop mode the main thread may be running while
+  // others are stopped.
+  lldb::tid_t GetMemoryAccessThreadID() const;
+
   // Resume the given thread, optionally passing it the given signal. The type
   // of resume
   // operation (continue, single-step) depends on the state parameter.
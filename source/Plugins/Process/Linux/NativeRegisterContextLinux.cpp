@@ -25,6 +25,17 @@ NativeRegisterContextLinux::NativeRegisterContextLinux(
     RegisterInfoInterface *reg_info_interface_p)
     : NativeRegisterContextRegisterInfo(native_thread, reg_info_interface_p) {}
 
+void NativeRegisterContextLinux::InvalidateAllRegisters() {
+  Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_REGISTERS));
+  if (m_num_ptrace_calls > 0)
+    LLDB_LOG(log, "tid {0}: {1} register ptrace calls while stopped",
+             m_thread.GetID(), m_num_ptrace_calls);
+
+  m_gpr_valid = false;
+  m_fpr_valid = false;
+  m_num_ptrace_calls = 0;
+}
+
 lldb::ByteOrder NativeRegisterContextLinux::GetByteOrder() const {
   return m_thread.GetProcess().GetByteOrder();
 }
@@ -42,6 +53,9 @@ Status NativeRegisterContextLinux::ReadRegisterRaw(uint32_t reg_index,
 Status
 NativeRegisterContextLinux::WriteRegisterRaw(uint32_t reg_index,
                                              const RegisterValue &reg_value) {
+  // The register is written directly, not through the cached GPR buffer.
+  m_gpr_valid = false;
+
   uint32_t reg_to_write = reg_index;
   RegisterValue value_to_write = reg_value;
 
@@ -96,12 +110,17 @@ NativeRegisterContextLinux::WriteRegisterRaw(uint32_t reg_index,
 }
 
 Status NativeRegisterContextLinux::ReadGPR() {
+  if (m_gpr_valid)
+    return Status();
+
   void *buf = GetGPRBuffer();
   if (!buf)
     return Status("GPR buffer is NULL");
   size_t buf_size = GetGPRSize();
 
-  return DoReadGPR(buf, buf_size);
+  Status error = DoReadGPR(buf, buf_size);
+  m_gpr_valid = error.Success();
+  return error;
 }
 
 Status NativeRegisterContextLinux::WriteGPR() {
@@ -110,16 +129,24 @@ Status NativeRegisterContextLinux::WriteGPR() {
     return Status("GPR buffer is NULL");
   size_t buf_size = GetGPRSize();
 
-  return DoWriteGPR(buf, buf_size);
+  // After a successful write the buffer holds the register values.
+  Status error = DoWriteGPR(buf, buf_size);
+  m_gpr_valid = error.Success();
+  return error;
 }
 
 Status NativeRegisterContextLinux::ReadFPR() {
+  if (m_fpr_valid)
+    return Status();
+
   void *buf = GetFPRBuffer();
   if (!buf)
     return Status("FPR buffer is NULL");
   size_t buf_size = GetFPRSize();
 
-  return DoReadFPR(buf, buf_size);
+  Status error = DoReadFPR(buf, buf_size);
+  m_fpr_valid = error.Success();
+  return error;
 }
 
 Status NativeRegisterContextLinux::WriteFPR() {
@@ -128,11 +155,14 @@ Status NativeRegisterContextLinux::WriteFPR() {
     return Status("FPR buffer is NULL");
   size_t buf_size = GetFPRSize();
 
-  return DoWriteFPR(buf, buf_size);
+  Status error = DoWriteFPR(buf, buf_size);
+  m_fpr_valid = error.Success();
+  return error;
 }
 
 Status NativeRegisterContextLinux::ReadRegisterSet(void *buf, size_t buf_size,
                                                    unsigned int regset) {
+  ++m_num_ptrace_calls;
   return NativeProcessLinux::PtraceWrapper(PTRACE_GETREGSET, m_thread.GetID(),
                                            static_cast<void *>(&regset), buf,
                                            buf_size);
@@ -140,6 +170,7 @@ Status NativeRegisterContextLinux::ReadRegisterSet(void *buf, size_t buf_size,
 
 Status NativeRegisterContextLinux::WriteRegisterSet(void *buf, size_t buf_size,
                                                     unsigned int regset) {
+  ++m_num_ptrace_calls;
   return NativeProcessLinux::PtraceWrapper(PTRACE_SETREGSET, m_thread.GetID(),
                                            static_cast<void *>(&regset), buf,
                                            buf_size);
@@ -152,6 +183,7 @@ Status NativeRegisterContextLinux::DoReadRegisterValue(uint32_t offset,
   Log *log(ProcessPOSIXLog::GetLogIfAllCategoriesSet(POSIX_LOG_REGISTERS));
 
   long data;
+  ++m_num_ptrace_calls;
   Status error = NativeProcessLinux::PtraceWrapper(
       PTRACE_PEEKUSER, m_thread.GetID(), reinterpret_cast<void *>(offset),
       nullptr, 0, &data);
@@ -171,26 +203,31 @@ Status NativeRegisterContextLinux::DoWriteRegisterValue(
   void *buf = reinterpret_cast<void *>(value.GetAsUInt64());
   LLDB_LOG(log, "{0}: {1}", reg_name, buf);
 
+  ++m_num_ptrace_calls;
   return NativeProcessLinux::PtraceWrapper(
       PTRACE_POKEUSER, m_thread.GetID(), reinterpret_cast<void *>(offset), buf);
 }
 
 Status NativeRegisterContextLinux::DoReadGPR(void *buf, size_t buf_size) {
+  ++m_num_ptrace_calls;
   return NativeProcessLinux::PtraceWrapper(PTRACE_GETREGS, m_thread.GetID(),
                                            nullptr, buf, buf_size);
 }
 
 Status NativeRegisterContextLinux::DoWriteGPR(void *buf, size_t buf_size) {
+  ++m_num_ptrace_calls;
   return NativeProcessLinux::PtraceWrapper(PTRACE_SETREGS, m_thread.GetID(),
                                            nullptr, buf, buf_size);
 }
 
 Status NativeRegisterContextLinux::DoReadFPR(void *buf, size_t buf_size) {
+  ++m_num_ptrace_calls;
   return NativeProcessLinux::PtraceWrapper(PTRACE_GETFPREGS, m_thread.GetID(),
                                            nullptr, buf, buf_size);
 }
 
 Status NativeRegisterContextLinux::DoWriteFPR(void *buf, size_t buf_size) {
+  ++m_num_ptrace_calls;
   return NativeProcessLinux::PtraceWrapper(PTRACE_SETFPREGS, m_thread.GetID(),
                                            nullptr, buf, buf_size);
 }
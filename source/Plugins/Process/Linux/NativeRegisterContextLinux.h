@@ -29,6 +29,10 @@ public:
   CreateHostNativeRegisterContextLinux(const ArchSpec &target_arch,
                                        NativeThreadProtocol &native_thread);
 
+  // Drop the cached register sets. This must be called before the thread
+  // runs, as its registers are only cached while it is stopped.
+  void InvalidateAllRegisters();
+
 protected:
   lldb::ByteOrder GetByteOrder() const;
 
@@ -77,6 +81,17 @@ protected:
   virtual Status DoReadFPR(void *buf, size_t buf_size);
 
   virtual Status DoWriteFPR(void *buf, size_t buf_size);
+
+  // Whether the GPR and FPR buffers hold the current register values. They
+  // are filled by the first ReadGPR()/ReadFPR() after the thread stops, and
+  // stay valid until the thread resumes or a register is written around the
+  // buffers.
+  bool m_gpr_valid = false;
+  bool m_fpr_valid = false;
+
+  // The number of ptrace calls made to access registers since the thread
+  // stopped, logged when it resumes.
+  uint32_t m_num_ptrace_calls = 0;
 };
 
 } // namespace process_linux
@@ -1018,6 +1018,9 @@ Status NativeRegisterContextLinux_mips64::WriteRegisterRaw(
   if (reg_info->invalidate_regs)
     lldbassert(false && "reg_info->invalidate_regs is unhandled");
 
+  // The register is written directly, not through the cached GPR buffer.
+  m_gpr_valid = false;
+
   uint32_t offset = reg_info->kinds[lldb::eRegisterKindProcessPlugin];
   return DoWriteRegisterValue(offset, reg_info->name, value);
 }
@@ -407,6 +407,37 @@ NativeRegisterContextLinux_x86_64::ReadRegister(const RegisterInfo *reg_info,
     error = ReadFPR();
     if (error.Fail())
       return error;
+  } else if (IsGPR(reg)) {
+    // Read the whole GPR set once per stop, instead of every register with a
+    // ptrace call of its own. The buffer has the layout of the user area, so
+    // sub-registers like ah are found at their own offset.
+    error = ReadGPR();
+    if (error.Fail())
+      return error;
+    assert(reg_info->byte_offset + reg_info->byte_size <=
+           sizeof(m_gpr_x86_64));
+    const uint8_t *src =
+        reinterpret_cast<const uint8_t *>(m_gpr_x86_64) + reg_info->byte_offset;
+    switch (reg_info->byte_size) {
+    case 1:
+      reg_value.SetUInt8(*src);
+      break;
+    case 2:
+      reg_value.SetUInt16(*reinterpret_cast<const uint16_t *>(src));
+      break;
+    case 4:
+      reg_value.SetUInt32(*reinterpret_cast<const uint32_t *>(src));
+      break;
+    case 8:
+      reg_value.SetUInt64(*reinterpret_cast<const uint64_t *>(src));
+      break;
+    default:
+      assert(false && "Unhandled data size.");
+      error.SetErrorStringWithFormat("unhandled byte size: %" PRIu32,
+                                     reg_info->byte_size);
+      break;
+    }
+    return error;
   } else {
     uint32_t full_reg = reg;
     bool is_subreg = reg_info->invalidate_regs &&
@@ -551,6 +582,14 @@ Status NativeRegisterContextLinux_x86_64::WriteRegister(
                                                ? reg_info->name
                                                : "<unknown register>");
 
+  // The register is written into the FPR buffer, which is then written back
+  // as a whole, so it needs to hold the current values of the others.
+  if (IsFPR(reg_index) || IsAVX(reg_index) || IsMPX(reg_index)) {
+    Status error = ReadFPR();
+    if (error.Fail())
+      return error;
+  }
+
   UpdateXSTATEforWrite(reg_index);
 
   if (IsGPR(reg_index))
@@ -718,8 +757,10 @@ Status NativeRegisterContextLinux_x86_64::ReadAllRegisterValues(
   if (reg_info == nullptr)
     reg_info = GetRegisterInfoInterface().GetDynamicRegisterInfo("orig_rax");
 
-  if (reg_info != nullptr)
+  if (reg_info != nullptr) {
+    m_gpr_valid = false;
     return DoWriteRegisterValue(reg_info->byte_offset, reg_info->name, value);
+  }
 
   return error;
 }
@@ -853,16 +894,21 @@ bool NativeRegisterContextLinux_x86_64::IsFPR(uint32_t reg_index) const {
 }
 
 Status NativeRegisterContextLinux_x86_64::WriteFPR() {
+  Status error;
   switch (m_xstate_type) {
   case XStateType::FXSAVE:
-    return WriteRegisterSet(
+    error = WriteRegisterSet(
         &m_iovec, sizeof(m_fpr.fxsave),
         fxsr_regset(GetRegisterInfoInterface().GetTargetArchitecture()));
+    break;
   case XStateType::XSAVE:
-    return WriteRegisterSet(&m_iovec, sizeof(m_fpr.xsave), NT_X86_XSTATE);
+    error = WriteRegisterSet(&m_iovec, sizeof(m_fpr.xsave), NT_X86_XSTATE);
+    break;
   default:
     return Status("Unrecognized FPR type.");
   }
+  m_fpr_valid = error.Success();
+  return error;
 }
 
 bool NativeRegisterContextLinux_x86_64::IsAVX(uint32_t reg_index) const {
@@ -949,13 +995,19 @@ size_t NativeRegisterContextLinux_x86_64::GetFPRSize() {
 }
 
 Status NativeRegisterContextLinux_x86_64::ReadFPR() {
+  if (m_fpr_valid)
+    return Status();
+
   Status error;
 
-  // Probe XSAVE and if it is not supported fall back to FXSAVE.
+  // Probe XSAVE and if it is not supported fall back to FXSAVE. The XSAVE
+  // area holds the FPU, SSE, AVX and MPX state, so a single read covers all
+  // of them.
   if (m_xstate_type != XStateType::FXSAVE) {
     error = ReadRegisterSet(&m_iovec, sizeof(m_fpr.xsave), NT_X86_XSTATE);
     if (!error.Fail()) {
       m_xstate_type = XStateType::XSAVE;
+      m_fpr_valid = true;
       return error;
     }
   }
@@ -964,6 +1016,7 @@ Status NativeRegisterContextLinux_x86_64::ReadFPR() {
       fxsr_regset(GetRegisterInfoInterface().GetTargetArchitecture()));
   if (!error.Fail()) {
     m_xstate_type = XStateType::FXSAVE;
+    m_fpr_valid = true;
     return error;
   }
   return Status("Unrecognized FPR type.");
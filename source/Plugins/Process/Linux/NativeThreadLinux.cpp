@@ -78,6 +78,9 @@ void LogThreadStopInfo(Log &log, const ThreadStopInfo &stop_info,
   case eStopReasonInstrumentation:
     log.Printf("%s: %s instrumentation", __FUNCTION__, header);
     return;
+  case eStopReasonHistoryBoundary:
+    log.Printf("%s: %s history boundary", __FUNCTION__, header);
+    return;
   default:
     log.Printf("%s: %s invalid stop reason %" PRIu32, __FUNCTION__, header,
                static_cast<uint32_t>(stop_info.reason));
@@ -205,17 +208,17 @@ Status NativeThreadLinux::RemoveHardwareBreakpoint(lldb::addr_t addr) {
 
 Status NativeThreadLinux::Resume(uint32_t signo) {
   const StateType new_state = StateType::eStateRunning;
-  MaybeLogStateChange(new_state);
-  m_state = new_state;
+  SetState(new_state);
 
   m_stop_info.reason = StopReason::eStopReasonNone;
   m_stop_description.clear();
 
   // If watchpoints have been set, but none on this thread, then this is a new
-  // thread. So set all existing watchpoints.
-  if (m_watchpoint_index_map.empty()) {
-    NativeProcessLinux &process = GetProcess();
-
+  // thread. So set all existing watchpoints. New threads start without any,
+  // so there is nothing to do if no watchpoints are set; this saves a few
+  // ptrace calls per thread on every resume.
+  NativeProcessLinux &process = GetProcess();
+  if (m_watchpoint_index_map.empty() && !process.GetWatchpointMap().empty()) {
     const auto &watchpoint_map = process.GetWatchpointMap();
     m_reg_context_up->ClearAllHardwareWatchpoints();
     for (const auto &pair : watchpoint_map) {
@@ -225,9 +228,8 @@ Status NativeThreadLinux::Resume(uint32_t signo) {
   }
 
   // Set all active hardware breakpoint on all threads.
-  if (m_hw_break_index_map.empty()) {
-    NativeProcessLinux &process = GetProcess();
-
+  if (m_hw_break_index_map.empty() &&
+      !process.GetHardwareBreakpointMap().empty()) {
     const auto &hw_breakpoint_map = process.GetHardwareBreakpointMap();
     m_reg_context_up->ClearAllHardwareBreakpoints();
     for (const auto &pair : hw_breakpoint_map) {
@@ -241,14 +243,14 @@ Status NativeThreadLinux::Resume(uint32_t signo) {
   if (signo != LLDB_INVALID_SIGNAL_NUMBER)
     data = signo;
 
+  m_reg_context_up->InvalidateAllRegisters();
   return NativeProcessLinux::PtraceWrapper(PTRACE_CONT, GetID(), nullptr,
                                            reinterpret_cast<void *>(data));
 }
 
 Status NativeThreadLinux::SingleStep(uint32_t signo) {
   const StateType new_state = StateType::eStateStepping;
-  MaybeLogStateChange(new_state);
-  m_state = new_state;
+  SetState(new_state);
   m_stop_info.reason = StopReason::eStopReasonNone;
 
   if(!m_step_workaround) {
@@ -265,6 +267,7 @@ Status NativeThreadLinux::SingleStep(uint32_t signo) {
   // If hardware single-stepping is not supported, we just do a continue. The
   // breakpoint on the next instruction has been setup in
   // NativeProcessLinux::Resume.
+  m_reg_context_up->InvalidateAllRegisters();
   return NativeProcessLinux::PtraceWrapper(
       GetProcess().SupportHardwareSingleStepping() ? PTRACE_SINGLESTEP
                                                    : PTRACE_CONT,
@@ -321,8 +324,7 @@ void NativeThreadLinux::SetStopped() {
     m_step_workaround.reset();
 
   const StateType new_state = StateType::eStateStopped;
-  MaybeLogStateChange(new_state);
-  m_state = new_state;
+  SetState(new_state);
   m_stop_description.clear();
 }
 
@@ -397,10 +399,24 @@ void NativeThreadLinux::SetStoppedWithNoReason() {
   m_stop_info.details.signal.signo = 0;
 }
 
+void NativeThreadLinux::SetStoppedByHistoryBoundary() {
+  SetStopped();
+
+  m_stop_info.reason = StopReason::eStopReasonHistoryBoundary;
+  m_stop_info.details.signal.signo = 0;
+}
+
+void NativeThreadLinux::SetStoppedWithStopInfo(const ThreadStopInfo &stop_info,
+                                               const std::string &description) {
+  SetStopped();
+
+  m_stop_info = stop_info;
+  m_stop_description = description;
+}
+
 void NativeThreadLinux::SetExited() {
   const StateType new_state = StateType::eStateExited;
-  MaybeLogStateChange(new_state);
-  m_state = new_state;
+  SetState(new_state);
 
   m_stop_info.reason = StopReason::eStopReasonThreadExiting;
 }
@@ -446,6 +462,12 @@ void NativeThreadLinux::MaybeLogStateChange(lldb::StateType new_state) {
            m_process.GetID(), GetID(), old_state, new_state);
 }
 
+void NativeThreadLinux::SetState(lldb::StateType new_state) {
+  MaybeLogStateChange(new_state);
+  GetProcess().ThreadStateChanged(m_state, new_state);
+  m_state = new_state;
+}
+
 NativeProcessLinux &NativeThreadLinux::GetProcess() {
   return static_cast<NativeProcessLinux &>(m_process);
 }
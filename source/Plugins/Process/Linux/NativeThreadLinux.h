@@ -23,9 +23,11 @@
 namespace lldb_private {
 namespace process_linux {
 
+class ExecutionHistory;
 class NativeProcessLinux;
 
 class NativeThreadLinux : public NativeThreadProtocol {
+  friend class ExecutionHistory;
   friend class NativeProcessLinux;
 
 public:
@@ -88,6 +90,12 @@ private:
 
   void SetStoppedWithNoReason();
 
+  void SetStoppedByHistoryBoundary();
+
+  // Stop with a stop reason saved from an earlier stop.
+  void SetStoppedWithStopInfo(const ThreadStopInfo &stop_info,
+                              const std::string &description);
+
   void SetExited();
 
   Status RequestStop();
@@ -97,6 +105,9 @@ private:
   // ---------------------------------------------------------------------
   void MaybeLogStateChange(lldb::StateType new_state);
 
+  // Change the state, and let the process know.
+  void SetState(lldb::StateType new_state);
+
   NativeProcessLinux &GetProcess();
 
   void SetStopped();
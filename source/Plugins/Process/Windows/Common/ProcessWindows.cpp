@@ -335,8 +335,12 @@ ProcessWindows::DoAttachToProcessWithID(lldb::pid_t pid,
   return error;
 }
 
-Status ProcessWindows::DoResume() {
+Status ProcessWindows::DoResume(RunDirection direction) {
   Log *log = ProcessWindowsLog::GetLogIfAny(WINDOWS_LOG_PROCESS);
+  if (direction == eRunReverse)
+    return Status("error: %s does not support reverse execution",
+                  GetPluginName().GetCString());
+
   llvm::sys::ScopedLock lock(m_mutex);
   Status error;
 
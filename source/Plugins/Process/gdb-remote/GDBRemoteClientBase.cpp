@@ -14,6 +14,7 @@
 #include "lldb/Target/Process.h"
 #include "lldb/Target/UnixSignals.h"
 #include "lldb/Utility/LLDBAssert.h"
+#include "lldb/Utility/Timer.h"
 
 #include "ProcessGDBRemoteLog.h"
 
@@ -201,6 +202,11 @@ GDBRemoteClientBase::SendPacketAndReceiveResponseWithOutputSupport(
 GDBRemoteCommunication::PacketResult
 GDBRemoteClientBase::SendPacketAndWaitForResponseNoLock(
     llvm::StringRef payload, StringExtractorGDBRemote &response) {
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  // Only a trace keeps the payload, so don't format it otherwise.
+  Timer scoped_timer(func_cat, "%.*s",
+                     Timer::IsTracing() ? int(payload.size()) : 0,
+                     payload.data());
   PacketResult packet_result = SendPacketNoLock(payload);
   if (packet_result != PacketResult::Success)
     return packet_result;
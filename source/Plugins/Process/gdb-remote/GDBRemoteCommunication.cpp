@@ -17,6 +17,7 @@
 // C++ Includes
 // Other libraries and framework includes
 #include "lldb/Core/StreamFile.h"
+#include "lldb/Host/Config.h"
 #include "lldb/Host/ConnectionFileDescriptor.h"
 #include "lldb/Host/Host.h"
 #include "lldb/Host/HostInfo.h"
@@ -29,6 +30,7 @@
 #include "lldb/Utility/FileSpec.h"
 #include "lldb/Utility/Log.h"
 #include "lldb/Utility/RegularExpression.h"
+#include "lldb/Utility/StreamGDBRemote.h"
 #include "lldb/Utility/StreamString.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ScopedPrinter.h"
@@ -76,14 +78,15 @@ void GDBRemoteCommunication::History::AddPacket(char packet_char,
   }
 }
 
-void GDBRemoteCommunication::History::AddPacket(const std::string &src,
+void GDBRemoteCommunication::History::AddPacket(llvm::StringRef src,
                                                 uint32_t src_len,
                                                 PacketType type,
                                                 uint32_t bytes_transmitted) {
   const size_t size = m_packets.size();
   if (size > 0) {
     const uint32_t idx = GetNextIndex();
-    m_packets[idx].packet.assign(src, 0, src_len);
+    src = src.substr(0, src_len);
+    m_packets[idx].packet.assign(src.data(), src.size());
     m_packets[idx].type = type;
     m_packets[idx].bytes_transmitted = bytes_transmitted;
     m_packets[idx].packet_idx = m_total_packet_count;
@@ -139,8 +142,8 @@ GDBRemoteCommunication::GDBRemoteCommunication(const char *comm_name,
 #endif
       m_echo_number(0), m_supports_qEcho(eLazyBoolCalculate), m_history(512),
       m_send_acks(true), m_compression_type(CompressionType::None),
-      m_listen_url() {
-}
+      m_send_compression_type(CompressionType::None), m_listen_url(),
+      m_bytes_pos(0) {}
 
 //----------------------------------------------------------------------
 // Destructor
@@ -189,10 +192,27 @@ size_t GDBRemoteCommunication::SendNack() {
 
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunication::SendPacketNoLock(llvm::StringRef payload) {
+  return SendPacketNoLockImpl('$', payload);
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunication::SendNotificationPacketNoLock(llvm::StringRef payload) {
+  return SendPacketNoLockImpl('%', payload);
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunication::SendPacketNoLockImpl(char start,
+                                             llvm::StringRef payload) {
   if (IsConnected()) {
+    std::string compressed_payload;
+    if (m_send_compression_type != CompressionType::None) {
+      compressed_payload = CompressPayload(payload);
+      payload = compressed_payload;
+    }
+
     StreamString packet(0, 4, eByteOrderBig);
 
-    packet.PutChar('$');
+    packet.PutChar(start);
     packet.Write(payload.data(), payload.size());
     packet.PutChar('#');
     packet.PutHex8(CalculcateChecksum(payload));
@@ -245,7 +265,8 @@ GDBRemoteCommunication::SendPacketNoLock(llvm::StringRef payload) {
                         History::ePacketTypeSend, bytes_written);
 
     if (bytes_written == packet_length) {
-      if (GetSendAcks())
+      // Notifications are not acknowledged.
+      if (GetSendAcks() && start == '$')
         return GetAck();
       else
         return PacketResult::Success;
@@ -332,7 +353,9 @@ GDBRemoteCommunication::PacketResult
 GDBRemoteCommunication::WaitForPacketNoLock(StringExtractorGDBRemote &packet,
                                             Timeout<std::micro> timeout,
                                             bool sync_on_timeout) {
-  uint8_t buffer[8192];
+  if (m_read_buffer.empty())
+    m_read_buffer.resize(64 * 1024);
+  uint8_t *buffer = m_read_buffer.data();
   Status error;
 
   Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_PACKETS));
@@ -345,7 +368,8 @@ GDBRemoteCommunication::WaitForPacketNoLock(StringExtractorGDBRemote &packet,
   bool disconnected = false;
   while (IsConnected() && !timed_out) {
     lldb::ConnectionStatus status = eConnectionStatusNoConnection;
-    size_t bytes_read = Read(buffer, sizeof(buffer), timeout, status, &error);
+    size_t bytes_read =
+        Read(buffer, m_read_buffer.size(), timeout, status, &error);
 
     LLDB_LOGV(log,
               "Read(buffer, sizeof(buffer), timeout = {0}, "
@@ -690,6 +714,48 @@ bool GDBRemoteCommunication::DecompressPacket() {
   return true;
 }
 
+std::string GDBRemoteCommunication::CompressPayload(llvm::StringRef payload) {
+#if defined(HAVE_LIBZ)
+  // Packets smaller than this gain little from compression, and debugserver
+  // uses the same threshold.
+  const size_t min_compressed_payload_size = 384;
+
+  if (m_send_compression_type == CompressionType::ZlibDeflate &&
+      payload.size() >= min_compressed_payload_size) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+
+    // Raw deflate (negative window bits), which is what DecompressPacket and
+    // debugserver expect.
+    if (deflateInit2(&stream, 5, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) ==
+        Z_OK) {
+      std::vector<uint8_t> compressed(deflateBound(&stream, payload.size()));
+      stream.next_in = (Bytef *)payload.data();
+      stream.avail_in = (uInt)payload.size();
+      stream.next_out = (Bytef *)compressed.data();
+      stream.avail_out = (uInt)compressed.size();
+      int status = deflate(&stream, Z_FINISH);
+      deflateEnd(&stream);
+      if (status == Z_STREAM_END && stream.total_out < payload.size()) {
+        StreamGDBRemote strm;
+        strm.Printf("C%" PRIu64 ":", (uint64_t)payload.size());
+        strm.PutEscapedBytes(compressed.data(), stream.total_out);
+        return strm.GetString();
+      }
+    }
+  }
+#endif
+
+  std::string uncompressed;
+  uncompressed.reserve(payload.size() + 1);
+  uncompressed.push_back('N');
+  uncompressed.append(payload.data(), payload.size());
+  return uncompressed;
+}
+
 GDBRemoteCommunication::PacketType
 GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
                                        StringExtractorGDBRemote &packet) {
@@ -704,13 +770,20 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
       log->Printf("GDBRemoteCommunication::%s adding %u bytes: %.*s",
                   __FUNCTION__, (uint32_t)src_len, (uint32_t)src_len, src);
     }
+    // Drop the bytes of the packets already taken off the buffer once they
+    // make up most of it, so that the cost of moving the remaining ones stays
+    // proportional to what was received.
+    if (m_bytes_pos > m_bytes.size() / 2) {
+      m_bytes.erase(0, m_bytes_pos);
+      m_bytes_pos = 0;
+    }
     m_bytes.append((const char *)src, src_len);
   }
 
   bool isNotifyPacket = false;
 
   // Parse up the packets into gdb remote packets
-  if (!m_bytes.empty()) {
+  if (m_bytes_pos < m_bytes.size()) {
     // end_idx must be one past the last valid packet byte. Start it off with
     // an invalid value that is the same as the current index.
     size_t content_start = 0;
@@ -719,15 +792,19 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
     size_t checksum_idx = std::string::npos;
 
     // Size of packet before it is decompressed, for logging purposes
-    size_t original_packet_size = m_bytes.size();
+    size_t original_packet_size = m_bytes.size() - m_bytes_pos;
     if (CompressionIsEnabled()) {
+      // DecompressPacket() works on the packet at the start of m_bytes.
+      m_bytes.erase(0, m_bytes_pos);
+      m_bytes_pos = 0;
       if (DecompressPacket() == false) {
         packet.Clear();
         return GDBRemoteCommunication::PacketType::Standard;
       }
     }
 
-    switch (m_bytes[0]) {
+    llvm::StringRef bytes = llvm::StringRef(m_bytes).drop_front(m_bytes_pos);
+    switch (bytes[0]) {
     case '+':                            // Look for ack
     case '-':                            // Look for cancel
     case '\x03':                         // ^C to halt target
@@ -741,9 +818,9 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
     case '$':
       // Look for a standard gdb packet?
       {
-        size_t hash_pos = m_bytes.find('#');
-        if (hash_pos != std::string::npos) {
-          if (hash_pos + 2 < m_bytes.size()) {
+        size_t hash_pos = bytes.find('#');
+        if (hash_pos != llvm::StringRef::npos) {
+          if (hash_pos + 2 < bytes.size()) {
             checksum_idx = hash_pos + 1;
             // Skip the dollar sign
             content_start = 1;
@@ -766,11 +843,11 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
       // in m_bytes, so we need to find the first byte that is a '+' (ACK), '-'
       // (NACK), \x03 (CTRL+C interrupt), or '$' character (start of packet
       // header) or of course, the end of the data in m_bytes...
-      const size_t bytes_len = m_bytes.size();
+      const size_t bytes_len = bytes.size();
       bool done = false;
       uint32_t idx;
       for (idx = 1; !done && idx < bytes_len; ++idx) {
-        switch (m_bytes[idx]) {
+        switch (bytes[idx]) {
         case '+':
         case '-':
         case '\x03':
@@ -785,8 +862,8 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
       }
       if (log)
         log->Printf("GDBRemoteCommunication::%s tossing %u junk bytes: '%.*s'",
-                    __FUNCTION__, idx - 1, idx - 1, m_bytes.c_str());
-      m_bytes.erase(0, idx - 1);
+                    __FUNCTION__, idx - 1, idx - 1, bytes.data());
+      m_bytes_pos += idx - 1;
     } break;
     }
 
@@ -796,8 +873,8 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
     } else if (total_length > 0) {
 
       // We have a valid packet...
-      assert(content_length <= m_bytes.size());
-      assert(total_length <= m_bytes.size());
+      assert(content_length <= bytes.size());
+      assert(total_length <= bytes.size());
       assert(content_length <= total_length);
       size_t content_end = content_start + content_length;
 
@@ -814,9 +891,9 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
         bool binary = false;
         // Only detect binary for packets that start with a '$' and have a
         // '#CC' checksum
-        if (m_bytes[0] == '$' && total_length > 4) {
+        if (bytes[0] == '$' && total_length > 4) {
           for (size_t i = 0; !binary && i < total_length; ++i) {
-            unsigned char c = m_bytes[i];
+            unsigned char c = bytes[i];
             if (isprint(c) == 0 && isspace(c) == 0) {
               binary = true;
             }
@@ -828,39 +905,39 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
           if (CompressionIsEnabled())
             strm.Printf("<%4" PRIu64 ":%" PRIu64 "> read packet: %c",
                         (uint64_t)original_packet_size, (uint64_t)total_length,
-                        m_bytes[0]);
+                        bytes[0]);
           else
             strm.Printf("<%4" PRIu64 "> read packet: %c",
-                        (uint64_t)total_length, m_bytes[0]);
+                        (uint64_t)total_length, bytes[0]);
           for (size_t i = content_start; i < content_end; ++i) {
             // Remove binary escaped bytes when displaying the packet...
-            const char ch = m_bytes[i];
+            const char ch = bytes[i];
             if (ch == 0x7d) {
               // 0x7d is the escape character.  The next character is to be
               // XOR'd with 0x20.
-              const char escapee = m_bytes[++i] ^ 0x20;
+              const char escapee = bytes[++i] ^ 0x20;
               strm.Printf("%2.2x", escapee);
             } else {
               strm.Printf("%2.2x", (uint8_t)ch);
             }
           }
           // Packet footer...
-          strm.Printf("%c%c%c", m_bytes[total_length - 3],
-                      m_bytes[total_length - 2], m_bytes[total_length - 1]);
+          strm.Printf("%c%c%c", bytes[total_length - 3],
+                      bytes[total_length - 2], bytes[total_length - 1]);
           log->PutString(strm.GetString());
         } else {
           if (CompressionIsEnabled())
             log->Printf("<%4" PRIu64 ":%" PRIu64 "> read packet: %.*s",
                         (uint64_t)original_packet_size, (uint64_t)total_length,
-                        (int)(total_length), m_bytes.c_str());
+                        (int)(total_length), bytes.data());
           else
             log->Printf("<%4" PRIu64 "> read packet: %.*s",
                         (uint64_t)total_length, (int)(total_length),
-                        m_bytes.c_str());
+                        bytes.data());
         }
       }
 
-      m_history.AddPacket(m_bytes, total_length, History::ePacketTypeRecv,
+      m_history.AddPacket(bytes, total_length, History::ePacketTypeRecv,
                           total_length);
 
       // Clear packet_str in case there is some existing data in it.
@@ -868,9 +945,9 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
       // Copy the packet from m_bytes to packet_str expanding the run-length
       // encoding in the process. Reserve enough byte for the most common case
       // (no RLE used)
-      packet_str.reserve(m_bytes.length());
-      for (std::string::const_iterator c = m_bytes.begin() + content_start;
-           c != m_bytes.begin() + content_end; ++c) {
+      packet_str.reserve(content_length);
+      for (llvm::StringRef::const_iterator c = bytes.begin() + content_start;
+           c != bytes.begin() + content_end; ++c) {
         if (*c == '*') {
           // '*' indicates RLE. Next character will give us the repeat count
           // and previous character is what is to be repeated.
@@ -891,21 +968,21 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
         }
       }
 
-      if (m_bytes[0] == '$' || m_bytes[0] == '%') {
-        assert(checksum_idx < m_bytes.size());
-        if (::isxdigit(m_bytes[checksum_idx + 0]) ||
-            ::isxdigit(m_bytes[checksum_idx + 1])) {
+      if (bytes[0] == '$' || bytes[0] == '%') {
+        assert(checksum_idx < bytes.size());
+        if (::isxdigit(bytes[checksum_idx + 0]) ||
+            ::isxdigit(bytes[checksum_idx + 1])) {
           if (GetSendAcks()) {
-            const char *packet_checksum_cstr = &m_bytes[checksum_idx];
+            const char *packet_checksum_cstr = bytes.data() + checksum_idx;
             char packet_checksum = strtol(packet_checksum_cstr, NULL, 16);
-            char actual_checksum = CalculcateChecksum(
-                llvm::StringRef(m_bytes).slice(content_start, content_end));
+            char actual_checksum =
+                CalculcateChecksum(bytes.slice(content_start, content_end));
             success = packet_checksum == actual_checksum;
             if (!success) {
               if (log)
                 log->Printf("error: checksum mismatch: %.*s expected 0x%2.2x, "
                             "got 0x%2.2x",
-                            (int)(total_length), m_bytes.c_str(),
+                            (int)(total_length), bytes.data(),
                             (uint8_t)packet_checksum, (uint8_t)actual_checksum);
             }
             // Send the ack or nack if needed
@@ -917,12 +994,17 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
         } else {
           success = false;
           if (log)
-            log->Printf("error: invalid checksum in packet: '%s'\n",
-                        m_bytes.c_str());
+            log->Printf("error: invalid checksum in packet: '%.*s'\n",
+                        (int)(total_length), bytes.data());
         }
       }
 
-      m_bytes.erase(0, total_length);
+      // Taking the packet off the buffer only moves m_bytes_pos past it.
+      m_bytes_pos += total_length;
+      if (m_bytes_pos == m_bytes.size()) {
+        m_bytes.clear();
+        m_bytes_pos = 0;
+      }
       packet.SetFilePos(0);
 
       if (isNotifyPacket)
@@ -177,7 +177,7 @@ protected:
     void AddPacket(char packet_char, PacketType type,
                    uint32_t bytes_transmitted);
 
-    void AddPacket(const std::string &src, uint32_t src_len, PacketType type,
+    void AddPacket(llvm::StringRef src, uint32_t src_len, PacketType type,
                    uint32_t bytes_transmitted);
 
     void Dump(Stream &strm) const;
@@ -226,9 +226,16 @@ protected:
                       // a single process
 
   CompressionType m_compression_type;
+  // The compression applied to the packets we send, as opposed to
+  // m_compression_type which applies to the packets we receive. Only a server
+  // compresses, after the client asks for it with QEnableCompression.
+  CompressionType m_send_compression_type;
 
   PacketResult SendPacketNoLock(llvm::StringRef payload);
 
+  // Send an asynchronous notification ("%payload#checksum").
+  PacketResult SendNotificationPacketNoLock(llvm::StringRef payload);
+
   PacketResult ReadPacket(StringExtractorGDBRemote &response,
                           Timeout<std::micro> timeout, bool sync_on_timeout);
 
@@ -260,6 +267,11 @@ protected:
   // on m_bytes.  The checksum was for the compressed packet.
   bool DecompressPacket();
 
+  // Returns the payload to send for \a payload when m_send_compression_type
+  // is enabled: "C<size>:" followed by the escaped compressed bytes, or "N"
+  // followed by \a payload when it is too small to be worth compressing.
+  std::string CompressPayload(llvm::StringRef payload);
+
   Status StartListenThread(const char *hostname = "127.0.0.1",
                            uint16_t port = 0);
 
@@ -289,6 +301,17 @@ private:
   HostThread m_listen_thread;
   std::string m_listen_url;
 
+  // The packets received are parsed out of m_bytes from m_bytes_pos on. The
+  // bytes before it belong to packets already handed out, and are dropped
+  // lazily.
+  size_t m_bytes_pos;
+
+  // WaitForPacketNoLock() reads into this buffer, large enough to take in
+  // many packets at once.
+  std::vector<uint8_t> m_read_buffer;
+
+  PacketResult SendPacketNoLockImpl(char start, llvm::StringRef payload);
+
   DISALLOW_COPY_AND_ASSIGN(GDBRemoteCommunication);
 };
 
@@ -45,6 +45,10 @@
 #include <compression.h>
 #endif
 
+#if defined(__linux__) && !defined(__ANDROID__)
+#include "lldb/Host/linux/ConnectionSharedMemory.h"
+#endif
+
 using namespace lldb;
 using namespace lldb_private;
 using namespace lldb_private::process_gdb_remote;
@@ -88,6 +92,12 @@ GDBRemoteCommunicationClient::GDBRemoteCommunicationClient()
       m_supports_jLoadedDynamicLibrariesInfos(eLazyBoolCalculate),
       m_supports_jGetSharedCacheInfo(eLazyBoolCalculate),
       m_supports_QPassSignals(eLazyBoolCalculate),
+      m_supports_jTraceBinaryRead(eLazyBoolCalculate),
+      m_supports_jThreadsInfo_options(eLazyBoolCalculate),
+      m_supports_reverse_step(eLazyBoolCalculate),
+      m_supports_reverse_continue(eLazyBoolCalculate),
+      m_supports_breakpoint_step_over(eLazyBoolCalculate),
+      m_supports_shared_memory_transport(eLazyBoolCalculate),
       m_supports_error_string_reply(eLazyBoolCalculate),
       m_supports_qProcessInfoPID(true), m_supports_qfProcessInfo(true),
       m_supports_qUserName(true), m_supports_qGroupName(true),
@@ -95,8 +105,8 @@ GDBRemoteCommunicationClient::GDBRemoteCommunicationClient()
       m_supports_z1(true), m_supports_z2(true), m_supports_z3(true),
       m_supports_z4(true), m_supports_QEnvironment(true),
       m_supports_QEnvironmentHexEncoded(true), m_supports_qSymbol(true),
-      m_qSymbol_requests_done(false), m_supports_qModuleInfo(true),
-      m_supports_jThreadsInfo(true), m_supports_jModulesInfo(true),
+      m_qSymbol_requests_done(false), m_supports_jThreadsInfo(true),
+      m_supports_jModulesInfo(true), m_supports_qModuleInfo(true),
       m_curr_pid(LLDB_INVALID_PROCESS_ID), m_curr_tid(LLDB_INVALID_THREAD_ID),
       m_curr_tid_run(LLDB_INVALID_THREAD_ID),
       m_num_supported_hardware_watchpoints(0), m_host_arch(), m_process_arch(),
@@ -159,6 +169,48 @@ bool GDBRemoteCommunicationClient::GetQPassSignalsSupported() {
   return m_supports_QPassSignals == eLazyBoolYes;
 }
 
+bool GDBRemoteCommunicationClient::GetJTraceBinaryReadSupported() {
+  if (m_supports_jTraceBinaryRead == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_jTraceBinaryRead == eLazyBoolYes;
+}
+
+bool GDBRemoteCommunicationClient::GetThreadsInfoOptionsSupported() {
+  if (m_supports_jThreadsInfo_options == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_jThreadsInfo_options == eLazyBoolYes;
+}
+
+bool GDBRemoteCommunicationClient::GetReverseStepSupported() {
+  if (m_supports_reverse_step == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_reverse_step == eLazyBoolYes;
+}
+
+bool GDBRemoteCommunicationClient::GetReverseContinueSupported() {
+  if (m_supports_reverse_continue == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_reverse_continue == eLazyBoolYes;
+}
+
+bool GDBRemoteCommunicationClient::GetBreakpointStepOverSupported() {
+  if (m_supports_breakpoint_step_over == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_breakpoint_step_over == eLazyBoolYes;
+}
+
+bool GDBRemoteCommunicationClient::GetSharedMemoryTransportSupported() {
+  if (m_supports_shared_memory_transport == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_shared_memory_transport == eLazyBoolYes;
+}
+
 bool GDBRemoteCommunicationClient::GetAugmentedLibrariesSVR4ReadSupported() {
   if (m_supports_augmented_libraries_svr4_read == eLazyBoolCalculate) {
     GetRemoteQSupported();
@@ -390,10 +442,9 @@ void GDBRemoteCommunicationClient::GetRemoteQSupported() {
     // Look for a list of compressions in the features list e.g.
     // qXfer:features:read+;PacketSize=20000;qEcho+;SupportedCompressions=zlib-
     // deflate,lzma
-    const char *features_list = ::strstr(response_cstr, "qXfer:features:");
-    if (features_list) {
+    {
       const char *compressions =
-          ::strstr(features_list, "SupportedCompressions=");
+          ::strstr(response_cstr, "SupportedCompressions=");
       if (compressions) {
         std::vector<std::string> supported_compressions;
         compressions += sizeof("SupportedCompressions=") - 1;
@@ -441,6 +492,36 @@ void GDBRemoteCommunicationClient::GetRemoteQSupported() {
     else
       m_supports_QPassSignals = eLazyBoolNo;
 
+    if (::strstr(response_cstr, "jTraceBinaryRead+"))
+      m_supports_jTraceBinaryRead = eLazyBoolYes;
+    else
+      m_supports_jTraceBinaryRead = eLazyBoolNo;
+
+    if (::strstr(response_cstr, "jThreadsInfoOptions+"))
+      m_supports_jThreadsInfo_options = eLazyBoolYes;
+    else
+      m_supports_jThreadsInfo_options = eLazyBoolNo;
+
+    if (::strstr(response_cstr, "ReverseStep+"))
+      m_supports_reverse_step = eLazyBoolYes;
+    else
+      m_supports_reverse_step = eLazyBoolNo;
+
+    if (::strstr(response_cstr, "ReverseContinue+"))
+      m_supports_reverse_continue = eLazyBoolYes;
+    else
+      m_supports_reverse_continue = eLazyBoolNo;
+
+    if (::strstr(response_cstr, "BreakpointStepOver+"))
+      m_supports_breakpoint_step_over = eLazyBoolYes;
+    else
+      m_supports_breakpoint_step_over = eLazyBoolNo;
+
+    if (::strstr(response_cstr, "SharedMemoryTransport+"))
+      m_supports_shared_memory_transport = eLazyBoolYes;
+    else
+      m_supports_shared_memory_transport = eLazyBoolNo;
+
     const char *packet_size_str = ::strstr(response_cstr, "PacketSize=");
     if (packet_size_str) {
       StringExtractorGDBRemote packet_response(packet_size_str +
@@ -573,14 +654,29 @@ bool GDBRemoteCommunicationClient::GetpPacketSupported(lldb::tid_t tid) {
   return m_supports_p;
 }
 
-StructuredData::ObjectSP GDBRemoteCommunicationClient::GetThreadsInfo() {
+StructuredData::ObjectSP
+GDBRemoteCommunicationClient::GetThreadsInfo(bool full_gprs,
+                                             uint64_t stack_memory) {
   // Get information on all threads at one using the "jThreadsInfo" packet
   StructuredData::ObjectSP object_sp;
 
   if (m_supports_jThreadsInfo) {
+    StreamGDBRemote payload;
+    payload.PutCString("jThreadsInfo");
+    if (GetThreadsInfoOptionsSupported()) {
+      StructuredData::Dictionary options;
+      options.AddBooleanItem("full_gprs", full_gprs);
+      options.AddIntegerItem("stack_memory", stack_memory);
+      StreamString unescaped_options;
+      options.Dump(unescaped_options, false);
+      payload.PutChar(':');
+      payload.PutEscapedBytes(unescaped_options.GetData(),
+                              unescaped_options.GetSize());
+    }
+
     StringExtractorGDBRemote response;
     response.SetResponseValidatorToJSON();
-    if (SendPacketAndWaitForResponse("jThreadsInfo", response, false) ==
+    if (SendPacketAndWaitForResponse(payload.GetString(), response, false) ==
         PacketResult::Success) {
       if (response.IsUnsupportedResponse()) {
         m_supports_jThreadsInfo = false;
@@ -3477,6 +3573,12 @@ Status GDBRemoteCommunicationClient::SendGetTraceDataPacket(
   if (thread_id != LLDB_INVALID_THREAD_ID)
     json_packet.AddIntegerItem("threadid", thread_id);
 
+  // Ask for the raw bytes when the server can send them, which halves the
+  // size of the reply compared to hex encoding.
+  const bool binary = GetJTraceBinaryReadSupported();
+  if (binary)
+    json_packet.AddBooleanItem("binary", true);
+
   StreamString json_string;
   json_packet.Dump(json_string, false);
 
@@ -3484,7 +3586,19 @@ Status GDBRemoteCommunicationClient::SendGetTraceDataPacket(
   StringExtractorGDBRemote response;
   if (SendPacketAndWaitForResponse(packet.GetString(), response, true) ==
       GDBRemoteCommunication::PacketResult::Success) {
-    if (response.IsNormalResponse()) {
+    if (binary && response.IsNormalResponse()) {
+      // Binary replies are "b" followed by the data. The binary escapes were
+      // already removed when the packet was read.
+      llvm::StringRef data = response.GetStringRef();
+      if (!data.consume_front("b")) {
+        error.SetErrorString("invalid binary trace data reply");
+        buffer = buffer.slice(buffer.size());
+        return error;
+      }
+      size_t filled_size = std::min(data.size(), buffer.size());
+      ::memcpy(buffer.data(), data.data(), filled_size);
+      buffer = llvm::MutableArrayRef<uint8_t>(buffer.data(), filled_size);
+    } else if (response.IsNormalResponse()) {
       size_t filled_size = response.GetHexBytesAvail(buffer);
       buffer = llvm::MutableArrayRef<uint8_t>(buffer.data(), filled_size);
     } else {
@@ -3959,6 +4073,59 @@ Status GDBRemoteCommunicationClient::SendSignalsToIgnore(
   }
 }
 
+Status GDBRemoteCommunicationClient::SetRecordHistory(bool enable) {
+  StreamString packet;
+  packet.Printf("QRecordHistory:%d", enable ? 1 : 0);
+
+  StringExtractorGDBRemote response;
+  if (SendPacketAndWaitForResponse(packet.GetString(), response, false) !=
+      PacketResult::Success)
+    return Status("Sending QRecordHistory packet failed");
+
+  if (response.IsOKResponse())
+    return Status();
+  if (response.IsErrorResponse())
+    return response.GetStatus();
+  return Status("QRecordHistory is not supported by the remote stub");
+}
+
+bool GDBRemoteCommunicationClient::EnableSharedMemoryTransport() {
+#if defined(__linux__) && !defined(__ANDROID__)
+  Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_PACKETS));
+
+  if (!GetSharedMemoryTransportSupported())
+    return false;
+
+  std::unique_ptr<ConnectionSharedMemory> conn_up(
+      new ConnectionSharedMemory(m_connection_sp));
+  Status error = conn_up->Create();
+  if (error.Fail()) {
+    LLDB_LOG(log, "creating the shared memory failed: {0}", error);
+    return false;
+  }
+
+  // The server only finds the mapping if it runs on this host. Otherwise it
+  // returns an error, and we stay on the current connection. Dropping conn_up
+  // on the way out removes the file the server didn't map.
+  StreamString packet;
+  packet.PutCString("QSharedMemoryTransport:");
+  packet.PutCStringAsRawHex8(conn_up->GetURI().c_str());
+  StringExtractorGDBRemote response;
+  if (SendPacketAndWaitForResponse(packet.GetString(), response, false) !=
+          PacketResult::Success ||
+      !response.IsOKResponse()) {
+    LLDB_LOG(log, "the server can't use the shared memory: {0}",
+             response.GetStringRef());
+    return false;
+  }
+
+  m_connection_sp.reset(conn_up.release());
+  return true;
+#else
+  return false;
+#endif
+}
+
 Status GDBRemoteCommunicationClient::ConfigureRemoteStructuredData(
     const ConstString &type_name, const StructuredData::ObjectSP &config_sp) {
   Status error;
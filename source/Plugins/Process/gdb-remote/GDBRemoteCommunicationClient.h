@@ -14,6 +14,7 @@
 
 // C Includes
 // C++ Includes
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <mutex>
@@ -351,6 +352,16 @@ public:
 
   bool GetQPassSignalsSupported();
 
+  bool GetJTraceBinaryReadSupported();
+
+  bool GetReverseStepSupported();
+
+  bool GetReverseContinueSupported();
+
+  bool GetBreakpointStepOverSupported();
+
+  bool GetSharedMemoryTransportSupported();
+
   bool GetAugmentedLibrariesSVR4ReadSupported();
 
   bool GetQXferFeaturesReadSupported();
@@ -434,7 +445,13 @@ public:
 
   bool AvoidGPackets(ProcessGDBRemote *process);
 
-  StructuredData::ObjectSP GetThreadsInfo();
+  // Get the stop info of all the threads with jThreadsInfo. If the server
+  // supports it, ask it to expedite all the GPRs of every thread if
+  // \a full_gprs, and up to \a stack_memory bytes of their stacks.
+  StructuredData::ObjectSP GetThreadsInfo(bool full_gprs,
+                                          uint64_t stack_memory);
+
+  bool GetThreadsInfoOptionsSupported();
 
   bool GetThreadExtendedInfoSupported();
 
@@ -458,6 +475,15 @@ public:
   // Sends QPassSignals packet to the server with given signals to ignore.
   Status SendSignalsToIgnore(llvm::ArrayRef<int32_t> signals);
 
+  // Sends QRecordHistory packet to the server to start or stop recording the
+  // execution history the bs and bc packets run backward through.
+  Status SetRecordHistory(bool enable);
+
+  // Move the connection to a shared memory mapping with the server, if the
+  // server supports it and runs on this host. Returns true if the packets now
+  // go through the shared memory.
+  bool EnableSharedMemoryTransport();
+
   //------------------------------------------------------------------
   /// Return the feature set supported by the gdb-remote server.
   ///
@@ -552,6 +578,12 @@ protected:
   LazyBool m_supports_jLoadedDynamicLibrariesInfos;
   LazyBool m_supports_jGetSharedCacheInfo;
   LazyBool m_supports_QPassSignals;
+  LazyBool m_supports_jTraceBinaryRead;
+  LazyBool m_supports_jThreadsInfo_options;
+  LazyBool m_supports_reverse_step;
+  LazyBool m_supports_reverse_continue;
+  LazyBool m_supports_breakpoint_step_over;
+  LazyBool m_supports_shared_memory_transport;
   LazyBool m_supports_error_string_reply;
 
   bool m_supports_qProcessInfoPID : 1, m_supports_qfProcessInfo : 1,
@@ -560,8 +592,9 @@ protected:
       m_supports_z2 : 1, m_supports_z3 : 1, m_supports_z4 : 1,
       m_supports_QEnvironment : 1, m_supports_QEnvironmentHexEncoded : 1,
       m_supports_qSymbol : 1, m_qSymbol_requests_done : 1,
-      m_supports_qModuleInfo : 1, m_supports_jThreadsInfo : 1,
-      m_supports_jModulesInfo : 1;
+      m_supports_jThreadsInfo : 1, m_supports_jModulesInfo : 1;
+  // Modules can be looked up from several threads at once.
+  std::atomic<bool> m_supports_qModuleInfo;
 
   lldb::pid_t m_curr_pid;
   lldb::tid_t m_curr_tid; // Current gdb remote protocol thread index for all
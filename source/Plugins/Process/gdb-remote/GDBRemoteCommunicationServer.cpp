@@ -33,6 +33,10 @@ GDBRemoteCommunicationServer::GDBRemoteCommunicationServer(
       StringExtractorGDBRemote::eServerPacketType_QEnableErrorStrings,
       [this](StringExtractorGDBRemote packet, Status &error, bool &interrupt,
              bool &quit) { return this->Handle_QErrorStringEnable(packet); });
+  RegisterPacketHandler(
+      StringExtractorGDBRemote::eServerPacketType_QEnableCompression,
+      [this](StringExtractorGDBRemote packet, Status &error, bool &interrupt,
+             bool &quit) { return this->Handle_QEnableCompression(packet); });
 }
 
 GDBRemoteCommunicationServer::~GDBRemoteCommunicationServer() {}
@@ -123,6 +127,30 @@ GDBRemoteCommunicationServer::Handle_QErrorStringEnable(
   return SendOKResponse();
 }
 
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServer::Handle_QEnableCompression(
+    StringExtractorGDBRemote &packet) {
+  packet.SetFilePos(::strlen("QEnableCompression:"));
+
+  llvm::StringRef key, value;
+  CompressionType type = CompressionType::None;
+  while (packet.GetNameColonValue(key, value)) {
+#if defined(HAVE_LIBZ)
+    if (key == "type" && value == "zlib-deflate")
+      type = CompressionType::ZlibDeflate;
+#endif
+  }
+
+  if (type == CompressionType::None)
+    return SendErrorResponse(0x4c);
+
+  // The OK itself goes out uncompressed, every packet after it is compressed.
+  PacketResult result = SendOKResponse();
+  if (result == PacketResult::Success)
+    m_send_compression_type = type;
+  return result;
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServer::SendIllFormedResponse(
     const StringExtractorGDBRemote &failed_packet, const char *message) {
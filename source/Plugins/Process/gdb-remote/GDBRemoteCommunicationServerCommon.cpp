@@ -836,6 +836,20 @@ GDBRemoteCommunicationServerCommon::Handle_qSupported(
 #if defined(__linux__) || defined(__NetBSD__)
   response.PutCString(";QPassSignals+");
   response.PutCString(";qXfer:auxv:read+");
+  response.PutCString(";jThreadsInfoOptions+");
+#endif
+#if defined(__linux__)
+  response.PutCString(";qXfer:libraries-svr4:read+");
+  response.PutCString(";QNonStop+");
+  response.PutCString(";jTraceBinaryRead+");
+  response.PutCString(";ReverseStep+;ReverseContinue+");
+  response.PutCString(";BreakpointStepOver+");
+#endif
+#if defined(__linux__) && !defined(__ANDROID__)
+  response.PutCString(";SharedMemoryTransport+");
+#endif
+#if defined(HAVE_LIBZ)
+  response.PutCString(";SupportedCompressions=zlib-deflate");
 #endif
 
   return SendPacketNoLock(response.GetString());
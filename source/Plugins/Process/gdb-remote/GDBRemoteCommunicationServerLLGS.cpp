@@ -18,6 +18,7 @@
 // C++ Includes
 #include <chrono>
 #include <cstring>
+#include <map>
 #include <thread>
 
 // Other libraries and framework includes
@@ -46,6 +47,10 @@
 #include "llvm/ADT/Triple.h"
 #include "llvm/Support/ScopedPrinter.h"
 
+#if defined(__linux__) && !defined(__ANDROID__)
+#include "lldb/Host/linux/ConnectionSharedMemory.h"
+#endif
+
 // Project includes
 #include "ProcessGDBRemote.h"
 #include "ProcessGDBRemoteLog.h"
@@ -66,7 +71,9 @@ enum GDBRemoteServerError {
   eErrorFirst = 29,
   eErrorNoProcess = eErrorFirst,
   eErrorResume,
-  eErrorExitStatus
+  eErrorExitStatus,
+  eErrorNonStop,
+  eErrorHistory
 };
 }
 
@@ -85,6 +92,10 @@ GDBRemoteCommunicationServerLLGS::GDBRemoteCommunicationServerLLGS(
 void GDBRemoteCommunicationServerLLGS::RegisterPacketHandlers() {
   RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_C,
                                 &GDBRemoteCommunicationServerLLGS::Handle_C);
+  RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_bc,
+                                &GDBRemoteCommunicationServerLLGS::Handle_bc);
+  RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_bs,
+                                &GDBRemoteCommunicationServerLLGS::Handle_bs);
   RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_c,
                                 &GDBRemoteCommunicationServerLLGS::Handle_c);
   RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_D,
@@ -155,6 +166,12 @@ void GDBRemoteCommunicationServerLLGS::RegisterPacketHandlers() {
   RegisterMemberFunctionHandler(
       StringExtractorGDBRemote::eServerPacketType_qXfer_auxv_read,
       &GDBRemoteCommunicationServerLLGS::Handle_qXfer_auxv_read);
+  RegisterMemberFunctionHandler(
+      StringExtractorGDBRemote::eServerPacketType_qXfer_libraries_svr4_read,
+      &GDBRemoteCommunicationServerLLGS::Handle_qXfer_libraries_svr4_read);
+  RegisterMemberFunctionHandler(
+      StringExtractorGDBRemote::eServerPacketType_qShlibInfoAddr,
+      &GDBRemoteCommunicationServerLLGS::Handle_qShlibInfoAddr);
   RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_s,
                                 &GDBRemoteCommunicationServerLLGS::Handle_s);
   RegisterMemberFunctionHandler(
@@ -179,6 +196,18 @@ void GDBRemoteCommunicationServerLLGS::RegisterPacketHandlers() {
   RegisterMemberFunctionHandler(
       StringExtractorGDBRemote::eServerPacketType_QPassSignals,
       &GDBRemoteCommunicationServerLLGS::Handle_QPassSignals);
+  RegisterMemberFunctionHandler(
+      StringExtractorGDBRemote::eServerPacketType_QNonStop,
+      &GDBRemoteCommunicationServerLLGS::Handle_QNonStop);
+  RegisterMemberFunctionHandler(
+      StringExtractorGDBRemote::eServerPacketType_QRecordHistory,
+      &GDBRemoteCommunicationServerLLGS::Handle_QRecordHistory);
+  RegisterMemberFunctionHandler(
+      StringExtractorGDBRemote::eServerPacketType_QSharedMemoryTransport,
+      &GDBRemoteCommunicationServerLLGS::Handle_QSharedMemoryTransport);
+  RegisterMemberFunctionHandler(
+      StringExtractorGDBRemote::eServerPacketType_vStopped,
+      &GDBRemoteCommunicationServerLLGS::Handle_vStopped);
 
   RegisterMemberFunctionHandler(
       StringExtractorGDBRemote::eServerPacketType_jTraceStart,
@@ -234,6 +263,7 @@ Status GDBRemoteCommunicationServerLLGS::LaunchProcess() {
     if (!process_or)
       return Status(process_or.takeError());
     m_debugged_process_up = std::move(*process_or);
+    m_debugged_process_up->SetNonStopMode(m_non_stop);
   }
 
   // Handle mirroring of inferior stdout/stderr over the gdb-remote protocol as
@@ -304,6 +334,7 @@ Status GDBRemoteCommunicationServerLLGS::AttachToProcess(lldb::pid_t pid) {
     return status;
   }
   m_debugged_process_up = std::move(*process_or);
+  m_debugged_process_up->SetNonStopMode(m_non_stop);
 
   // Setup stdout/stderr mapping from inferior.
   auto terminal_fd = m_debugged_process_up->GetTerminalFileDescriptor();
@@ -340,7 +371,7 @@ void GDBRemoteCommunicationServerLLGS::InitializeDelegate(
 
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::SendWResponse(
-    NativeProcessProtocol *process) {
+    NativeProcessProtocol *process, bool notification) {
   assert(process && "process cannot be NULL");
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
 
@@ -360,6 +391,11 @@ GDBRemoteCommunicationServerLLGS::SendWResponse(
            *wait_status);
 
   StreamGDBRemote response;
+  if (notification) {
+    response.PutCString("Stop:");
+    response.Format("{0:g}", *wait_status);
+    return SendNotificationPacketNoLock(response.GetString());
+  }
   response.Format("{0:g}", *wait_status);
   return SendPacketNoLock(response.GetString());
 }
@@ -401,37 +437,43 @@ static void WriteRegisterValueInHexFixedWidth(
   }
 }
 
-static JSONObject::SP GetRegistersAsJSON(NativeThreadProtocol &thread) {
+static JSONObject::SP GetRegistersAsJSON(NativeThreadProtocol &thread,
+                                        bool full_gprs) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_THREAD));
 
   NativeRegisterContext& reg_ctx = thread.GetRegisterContext();
 
   JSONObject::SP register_object_sp = std::make_shared<JSONObject>();
 
-#ifdef LLDB_JTHREADSINFO_FULL_REGISTER_SET
-  // Expedite all registers in the first register set (i.e. should be GPRs)
-  // that are not contained in other registers.
-  const RegisterSet *reg_set_p = reg_ctx_sp->GetRegisterSet(0);
-  if (!reg_set_p)
-    return nullptr;
-  for (const uint32_t *reg_num_p = reg_set_p->registers;
-       *reg_num_p != LLDB_INVALID_REGNUM; ++reg_num_p) {
-    uint32_t reg_num = *reg_num_p;
-#else
-  // Expedite only a couple of registers until we figure out why sending
-  // registers is expensive.
-  static const uint32_t k_expedited_registers[] = {
-      LLDB_REGNUM_GENERIC_PC, LLDB_REGNUM_GENERIC_SP, LLDB_REGNUM_GENERIC_FP,
-      LLDB_REGNUM_GENERIC_RA, LLDB_INVALID_REGNUM};
-
-  for (const uint32_t *generic_reg_p = k_expedited_registers;
-       *generic_reg_p != LLDB_INVALID_REGNUM; ++generic_reg_p) {
-    uint32_t reg_num = reg_ctx.ConvertRegisterKindToRegisterNumber(
-        eRegisterKindGeneric, *generic_reg_p);
-    if (reg_num == LLDB_INVALID_REGNUM)
-      continue; // Target does not support the given register.
-#endif
+  std::vector<uint32_t> reg_nums;
+  if (full_gprs) {
+    // Expedite all registers in the first register set (i.e. should be GPRs)
+    // that are not contained in other registers.
+    const RegisterSet *reg_set_p = reg_ctx.GetRegisterSetCount() > 0
+                                       ? reg_ctx.GetRegisterSet(0)
+                                       : nullptr;
+    if (!reg_set_p)
+      return nullptr;
+    for (const uint32_t *reg_num_p = reg_set_p->registers;
+         *reg_num_p != LLDB_INVALID_REGNUM; ++reg_num_p)
+      reg_nums.push_back(*reg_num_p);
+  } else {
+    // Expedite only the registers needed to start a backtrace. The whole GPR
+    // set takes a thread's entry from 3 to 24 registers on x86-64, about 500
+    // more bytes per thread, which adds up in processes with many threads.
+    static const uint32_t k_expedited_registers[] = {
+        LLDB_REGNUM_GENERIC_PC, LLDB_REGNUM_GENERIC_SP, LLDB_REGNUM_GENERIC_FP,
+        LLDB_REGNUM_GENERIC_RA};
+    for (uint32_t generic_reg : k_expedited_registers) {
+      uint32_t reg_num = reg_ctx.ConvertRegisterKindToRegisterNumber(
+          eRegisterKindGeneric, generic_reg);
+      if (reg_num == LLDB_INVALID_REGNUM)
+        continue; // Target does not support the given register.
+      reg_nums.push_back(reg_num);
+    }
+  }
 
+  for (uint32_t reg_num : reg_nums) {
     const RegisterInfo *const reg_info_p =
         reg_ctx.GetRegisterInfoAtIndex(reg_num);
     if (reg_info_p == nullptr) {
@@ -469,6 +511,131 @@ static JSONObject::SP GetRegistersAsJSON(NativeThreadProtocol &thread) {
   return register_object_sp;
 }
 
+// Stack memory expedited in stop replies, keyed by address.
+typedef std::map<lldb::addr_t, std::vector<uint8_t>> ExpeditedMemoryMap;
+
+// The number of bytes above the stack pointer that are expedited. This
+// covers the spill area and return address of a frameless leaf function.
+static const size_t k_expedited_stack_bytes = 256;
+
+// The number of frame pointer chain entries expedited in jThreadsInfo and in
+// stop replies. The stop reply only needs to get a step or a breakpoint
+// condition past the first frames; jThreadsInfo is sent before a public stop
+// and should cover complete backtraces.
+static const uint32_t k_jthreadsinfo_frame_limit = 64;
+static const uint32_t k_stop_reply_frame_limit = 2;
+
+// The number of bytes of memory expedited in one jThreadsInfo reply, across
+// all threads, unless the client asks for another amount. Each byte is sent
+// as two hex digits. A thread with a 64 frame chain takes 256 + 64 * 16 bytes
+// on a 64-bit target, so the stacks of the first dozen threads are expedited
+// and the rest are read on demand.
+static const size_t k_jthreadsinfo_memory_budget = 16 * 1024;
+
+// The most memory a client can ask for in one jThreadsInfo reply.
+static const size_t k_jthreadsinfo_max_memory_budget = 1024 * 1024;
+
+// What jThreadsInfo expedites for every thread. Clients can change it with
+// the options of the packet.
+struct ThreadsInfoOptions {
+  bool full_gprs = false; // all the GPRs rather than pc, sp, fp and ra
+  size_t memory_budget = k_jthreadsinfo_memory_budget;
+};
+
+static void ReadExpeditedStackMemory(NativeProcessProtocol &process,
+                                     NativeThreadProtocol &thread,
+                                     uint32_t frame_limit,
+                                     ExpeditedMemoryMap &memory_map) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_THREAD));
+
+  NativeRegisterContext &reg_ctx = thread.GetRegisterContext();
+  const size_t addr_size = process.GetArchitecture().GetAddressByteSize();
+  if (addr_size != 4 && addr_size != 8)
+    return;
+
+  // The top of the stack. The read stops early at the end of the mapping.
+  const lldb::addr_t sp = reg_ctx.GetSP(0);
+  lldb::addr_t stack_end = sp;
+  if (sp != 0) {
+    std::vector<uint8_t> bytes(k_expedited_stack_bytes);
+    size_t bytes_read = 0;
+    Status error = process.ReadMemoryWithoutTrap(sp, bytes.data(),
+                                                 bytes.size(), bytes_read);
+    if (error.Fail())
+      LLDB_LOG(log, "failed to read stack memory at {0:x}: {1}", sp, error);
+    if (bytes_read > 0) {
+      bytes.resize(bytes_read);
+      stack_end = sp + bytes_read;
+      memory_map.emplace(sp, std::move(bytes));
+    }
+  }
+
+  // The saved frame pointer and return address of every frame on the frame
+  // pointer chain.
+  lldb::addr_t fp = reg_ctx.GetFP(0);
+  for (uint32_t frame = 0; fp != 0 && frame < frame_limit; ++frame) {
+    std::vector<uint8_t> bytes(2 * addr_size);
+    size_t bytes_read = 0;
+    Status error = process.ReadMemoryWithoutTrap(fp, bytes.data(),
+                                                 bytes.size(), bytes_read);
+    if (error.Fail() || bytes_read != bytes.size())
+      break;
+    lldb::addr_t next_fp;
+    if (addr_size == 4) {
+      uint32_t next_fp32;
+      memcpy(&next_fp32, bytes.data(), sizeof(next_fp32));
+      next_fp = next_fp32;
+    } else
+      memcpy(&next_fp, bytes.data(), sizeof(next_fp));
+
+    // Frames that were already read with the top of the stack don't need an
+    // entry of their own.
+    if (fp < sp || fp + bytes.size() > stack_end)
+      memory_map.emplace(fp, std::move(bytes));
+
+    // The stack grows down, so a chain that doesn't go up is corrupt.
+    if (next_fp <= fp)
+      break;
+    fp = next_fp;
+  }
+}
+
+static JSONArray::SP GetMemoryAsJSON(NativeProcessProtocol &process,
+                                     NativeThreadProtocol &thread,
+                                     size_t &memory_budget) {
+  if (memory_budget == 0)
+    return nullptr;
+
+  ExpeditedMemoryMap memory_map;
+  ReadExpeditedStackMemory(process, thread, k_jthreadsinfo_frame_limit,
+                           memory_map);
+  if (memory_map.empty())
+    return nullptr;
+
+  JSONArray::SP memory_array_sp = std::make_shared<JSONArray>();
+  for (const auto &entry : memory_map) {
+    // The blocks are sorted by address, so the top of the stack and the
+    // innermost frames come first.
+    if (entry.second.size() > memory_budget) {
+      memory_budget = 0;
+      break;
+    }
+    memory_budget -= entry.second.size();
+
+    JSONObject::SP memory_obj_sp = std::make_shared<JSONObject>();
+    memory_obj_sp->SetObject("address",
+                             std::make_shared<JSONNumber>(entry.first));
+    StreamString bytes;
+    bytes.PutBytesAsRawHex8(entry.second.data(), entry.second.size());
+    memory_obj_sp->SetObject("bytes",
+                             std::make_shared<JSONString>(bytes.GetString()));
+    memory_array_sp->AppendObject(memory_obj_sp);
+  }
+  if (memory_array_sp->GetNumElements() == 0)
+    return nullptr;
+  return memory_array_sp;
+}
+
 static const char *GetStopReasonString(StopReason stop_reason) {
   switch (stop_reason) {
   case eStopReasonTrace:
@@ -483,6 +650,8 @@ static const char *GetStopReasonString(StopReason stop_reason) {
     return "exception";
   case eStopReasonExec:
     return "exec";
+  case eStopReasonHistoryBoundary:
+    return "history boundary";
   case eStopReasonInstrumentation:
   case eStopReasonInvalid:
   case eStopReasonPlanComplete:
@@ -493,11 +662,13 @@ static const char *GetStopReasonString(StopReason stop_reason) {
   return nullptr;
 }
 
-static JSONArray::SP GetJSONThreadsInfo(NativeProcessProtocol &process,
-                                        bool abridged) {
+static JSONArray::SP
+GetJSONThreadsInfo(NativeProcessProtocol &process, bool abridged,
+                   const ThreadsInfoOptions &options = ThreadsInfoOptions()) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_THREAD));
 
   JSONArray::SP threads_array_sp = std::make_shared<JSONArray>();
+  size_t memory_budget = options.memory_budget;
 
   // Ensure we can get info on the given thread.
   uint32_t thread_idx = 0;
@@ -505,6 +676,10 @@ static JSONArray::SP GetJSONThreadsInfo(NativeProcessProtocol &process,
        (thread = process.GetThreadAtIndex(thread_idx)) != nullptr;
        ++thread_idx) {
 
+    // In non-stop mode, only the stopped threads have stop info.
+    if (StateIsRunningState(thread->GetState()))
+      continue;
+
     lldb::tid_t tid = thread->GetID();
 
     // Grab the reason this thread stopped.
@@ -526,7 +701,8 @@ static JSONArray::SP GetJSONThreadsInfo(NativeProcessProtocol &process,
     threads_array_sp->AppendObject(thread_obj_sp);
 
     if (!abridged) {
-      if (JSONObject::SP registers_sp = GetRegistersAsJSON(*thread))
+      if (JSONObject::SP registers_sp =
+              GetRegistersAsJSON(*thread, options.full_gprs))
         thread_obj_sp->SetObject("registers", registers_sp);
     }
 
@@ -562,7 +738,13 @@ static JSONArray::SP GetJSONThreadsInfo(NativeProcessProtocol &process,
       thread_obj_sp->SetObject("medata", medata_array_sp);
     }
 
-    // TODO: Expedite interesting regions of inferior memory
+    // Expedite the stack, so that backtracing the thread doesn't need any
+    // memory reads.
+    if (!abridged) {
+      if (JSONArray::SP memory_sp =
+              GetMemoryAsJSON(process, *thread, memory_budget))
+        thread_obj_sp->SetObject("memory", memory_sp);
+    }
   }
 
   return threads_array_sp;
@@ -586,11 +768,39 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread(
   if (!thread)
     return SendErrorResponse(51);
 
+  StreamString response;
+  if (!PrepareStopReplyPacketForThread(*thread, response))
+    return SendErrorResponse(52);
+
+  return SendPacketNoLock(response.GetString());
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::SendStopNotificationForThread(
+    lldb::tid_t tid) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_THREAD));
+
+  NativeThreadProtocol *thread = m_debugged_process_up->GetThreadByID(tid);
+  StreamString response;
+  response.PutCString("Stop:");
+  if (!thread || !PrepareStopReplyPacketForThread(*thread, response)) {
+    LLDB_LOG(log, "failed to prepare a stop notification for tid {0}", tid);
+    return PacketResult::ErrorSendFailed;
+  }
+
+  return SendNotificationPacketNoLock(response.GetString());
+}
+
+bool GDBRemoteCommunicationServerLLGS::PrepareStopReplyPacketForThread(
+    NativeThreadProtocol &thread, StreamString &response) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_THREAD));
+  const lldb::tid_t tid = thread.GetID();
+
   // Grab the reason this thread stopped.
   struct ThreadStopInfo tid_stop_info;
   std::string description;
-  if (!thread->GetStopReason(tid_stop_info, description))
-    return SendErrorResponse(52);
+  if (!thread.GetStopReason(tid_stop_info, description))
+    return false;
 
   // FIXME implement register handling for exec'd inferiors.
   // if (tid_stop_info.reason == eStopReasonExec) {
@@ -598,7 +808,6 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread(
   //     InitializeRegisters(force);
   // }
 
-  StreamString response;
   // Output the T packet with the thread
   response.PutChar('T');
   int signum = tid_stop_info.details.signal.signo;
@@ -615,7 +824,7 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread(
   response.Printf("thread:%" PRIx64 ";", tid);
 
   // Include the thread name if there is one.
-  const std::string thread_name = thread->GetName();
+  const std::string thread_name = thread.GetName();
   if (!thread_name.empty()) {
     size_t thread_name_len = thread_name.length();
 
@@ -641,12 +850,16 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread(
   if (m_list_threads_in_stop_reply) {
     response.PutCString("threads:");
 
+    // In non-stop mode, the threads that are still running are left out.
     uint32_t thread_index = 0;
+    uint32_t num_listed_threads = 0;
     NativeThreadProtocol *listed_thread;
     for (listed_thread = m_debugged_process_up->GetThreadAtIndex(thread_index);
          listed_thread; ++thread_index,
         listed_thread = m_debugged_process_up->GetThreadAtIndex(thread_index)) {
-      if (thread_index > 0)
+      if (StateIsRunningState(listed_thread->GetState()))
+        continue;
+      if (num_listed_threads++ > 0)
         response.PutChar(',');
       response.Printf("%" PRIx64, listed_thread->GetID());
     }
@@ -657,7 +870,7 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread(
     // is hex ascii JSON that contains the thread IDs thread stop info only for
     // threads that have stop reasons. Only send this if we have more than one
     // thread otherwise this packet has all the info it needs.
-    if (thread_index > 0) {
+    if (num_listed_threads > 0) {
       const bool threads_with_valid_stop_info_only = true;
       JSONArray::SP threads_info_sp = GetJSONThreadsInfo(
           *m_debugged_process_up, threads_with_valid_stop_info_only);
@@ -678,6 +891,8 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread(
     for (NativeThreadProtocol *thread;
          (thread = m_debugged_process_up->GetThreadAtIndex(i)) != nullptr;
          ++i) {
+      if (StateIsRunningState(thread->GetState()))
+        continue;
       NativeRegisterContext& reg_ctx = thread->GetRegisterContext();
 
       uint32_t reg_to_read = reg_ctx.ConvertRegisterKindToRegisterNumber(
@@ -711,7 +926,7 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread(
   //
 
   // Grab the register context.
-  NativeRegisterContext& reg_ctx = thread->GetRegisterContext();
+  NativeRegisterContext& reg_ctx = thread.GetRegisterContext();
   // Expedite all registers in the first register set (i.e. should be GPRs)
   // that are not contained in other registers.
   const RegisterSet *reg_set_p;
@@ -758,11 +973,25 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread(
     }
   }
 
+  // Expedite the top of the stack and the first frames.
+  ExpeditedMemoryMap memory_map;
+  ReadExpeditedStackMemory(*m_debugged_process_up, thread,
+                           k_stop_reply_frame_limit, memory_map);
+  for (const auto &entry : memory_map) {
+    response.Printf("memory:0x%" PRIx64 "=", entry.first);
+    response.PutBytesAsRawHex8(entry.second.data(), entry.second.size());
+    response.PutChar(';');
+  }
+
   const char *reason_str = GetStopReasonString(tid_stop_info.reason);
   if (reason_str != nullptr) {
     response.Printf("reason:%s;", reason_str);
   }
 
+  // Tell gdb that the process got to the start of its history too.
+  if (tid_stop_info.reason == eStopReasonHistoryBoundary)
+    response.PutCString("replaylog:begin;");
+
   if (!description.empty()) {
     // Description may contains special chars, send as hex bytes.
     response.PutCString("description:");
@@ -783,7 +1012,7 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread(
     }
   }
 
-  return SendPacketNoLock(response.GetString());
+  return true;
 }
 
 void GDBRemoteCommunicationServerLLGS::HandleInferiorState_Exited(
@@ -794,7 +1023,11 @@ void GDBRemoteCommunicationServerLLGS::HandleInferiorState_Exited(
   if (log)
     log->Printf("GDBRemoteCommunicationServerLLGS::%s called", __FUNCTION__);
 
-  PacketResult result = SendStopReasonForState(StateType::eStateExited);
+  // In non-stop mode, the client learns about the exit like about any other
+  // stop, from a notification.
+  PacketResult result = m_non_stop
+                            ? SendWResponse(process, /*notification=*/true)
+                            : SendStopReasonForState(StateType::eStateExited);
   if (result != PacketResult::Success) {
     if (log)
       log->Printf("GDBRemoteCommunicationServerLLGS::%s failed to send stop "
@@ -850,7 +1083,10 @@ void GDBRemoteCommunicationServerLLGS::ProcessStateChanged(
 
   switch (state) {
   case StateType::eStateRunning:
-    StartSTDIOForwarding();
+    // In non-stop mode the client doesn't wait for a stop reply while the
+    // process runs, so it can't take $O packets.
+    if (!m_non_stop)
+      StartSTDIOForwarding();
     break;
 
   case StateType::eStateStopped:
@@ -865,7 +1101,8 @@ void GDBRemoteCommunicationServerLLGS::ProcessStateChanged(
 
   case StateType::eStateExited:
     // Same as above
-    SendProcessOutput();
+    if (!m_non_stop)
+      SendProcessOutput();
     StopSTDIOForwarding();
     HandleInferiorState_Exited(process);
     break;
@@ -887,6 +1124,24 @@ void GDBRemoteCommunicationServerLLGS::DidExec(NativeProcessProtocol *process) {
   ClearProcessSpecificData();
 }
 
+void GDBRemoteCommunicationServerLLGS::ThreadStopped(
+    NativeProcessProtocol *process, NativeThreadProtocol &thread) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_THREAD));
+  LLDB_LOG(log, "pid {0} tid {1}", process->GetID(), thread.GetID());
+
+  // Only one stop notification is outstanding at a time. The client asks
+  // for the stops queued behind it with vStopped.
+  m_stop_notifications.push_back(thread.GetID());
+  if (m_stop_notifications.size() > 1)
+    return;
+
+  if (SendStopNotificationForThread(thread.GetID()) != PacketResult::Success) {
+    LLDB_LOG(log, "failed to send stop notification for tid {0}",
+             thread.GetID());
+    m_stop_notifications.pop_back();
+  }
+}
+
 void GDBRemoteCommunicationServerLLGS::DataAvailableCallback() {
   Log *log(GetLogIfAnyCategoriesSet(GDBR_LOG_COMM));
 
@@ -1226,6 +1481,11 @@ GDBRemoteCommunicationServerLLGS::Handle_jTraceRead(
 
   json_dict->GetValueForKeyAsInteger("threadid", tid);
 
+  // Clients that saw jTraceBinaryRead+ in qSupported may ask for the data as
+  // escaped binary instead of hex.
+  bool binary = false;
+  json_dict->GetValueForKeyAsBoolean("binary", binary);
+
   // Allocate the response buffer.
   std::unique_ptr<uint8_t[]> buffer (new (std::nothrow) uint8_t[byte_count]);
   if (!buffer)
@@ -1243,6 +1503,12 @@ GDBRemoteCommunicationServerLLGS::Handle_jTraceRead(
   if (error.Fail())
     return SendErrorResponse(error);
 
+  if (binary) {
+    response.PutChar('b');
+    response.PutEscapedBytes(buf.data(), buf.size());
+    return SendPacketNoLock(response.GetString());
+  }
+
   for (auto i : buf)
     response.PutHex8(i);
 
@@ -1427,7 +1693,58 @@ GDBRemoteCommunicationServerLLGS::Handle_C(StringExtractorGDBRemote &packet) {
     return SendErrorResponse(0x38);
   }
 
-  // Don't send an "OK" packet; response is the stopped/exited message.
+  // Don't send an "OK" packet; response is the stopped/exited message. In
+  // non-stop mode, that message is a notification.
+  if (m_non_stop)
+    return SendOKResponse();
+  return PacketResult::Success;
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_bc(StringExtractorGDBRemote &packet) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_THREAD));
+
+  if (!m_debugged_process_up)
+    return SendErrorResponse(GDBRemoteServerError::eErrorNoProcess);
+  if (m_non_stop || !m_record_history)
+    return SendErrorResponse(GDBRemoteServerError::eErrorHistory);
+
+  Status error = m_debugged_process_up->ReverseResume(LLDB_INVALID_THREAD_ID,
+                                                      eStateRunning);
+  if (error.Fail()) {
+    LLDB_LOG(log, "bc failed for process {0}: {1}",
+             m_debugged_process_up->GetID(), error);
+    return SendErrorResponse(GDBRemoteServerError::eErrorHistory);
+  }
+
+  // No response here - the stop comes from the replay, like for c.
+  return PacketResult::Success;
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_bs(StringExtractorGDBRemote &packet) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_THREAD));
+
+  if (!m_debugged_process_up)
+    return SendErrorResponse(GDBRemoteServerError::eErrorNoProcess);
+  if (m_non_stop || !m_record_history)
+    return SendErrorResponse(GDBRemoteServerError::eErrorHistory);
+
+  // Step the same thread s would.
+  lldb::tid_t tid = GetContinueThreadID();
+  if (tid == 0 || tid == LLDB_INVALID_THREAD_ID)
+    tid = GetCurrentThreadID();
+  if (!m_debugged_process_up->GetThreadByID(tid))
+    return SendErrorResponse(0x33);
+
+  Status error = m_debugged_process_up->ReverseResume(tid, eStateStepping);
+  if (error.Fail()) {
+    LLDB_LOG(log, "bs failed for process {0} tid {1}: {2}",
+             m_debugged_process_up->GetID(), tid, error);
+    return SendErrorResponse(GDBRemoteServerError::eErrorHistory);
+  }
+
+  // No response here - the stop comes from the replay, like for s.
   return PacketResult::Success;
 }
 
@@ -1467,7 +1784,10 @@ GDBRemoteCommunicationServerLLGS::Handle_c(StringExtractorGDBRemote &packet) {
   }
 
   LLDB_LOG(log, "continued process {0}", m_debugged_process_up->GetID());
-  // No response required from continue.
+  // No response required from continue, except in non-stop mode where the
+  // stops are reported with notifications.
+  if (m_non_stop)
+    return SendOKResponse();
   return PacketResult::Success;
 }
 
@@ -1475,7 +1795,10 @@ GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle_vCont_actions(
     StringExtractorGDBRemote &packet) {
   StreamString response;
-  response.Printf("vCont;c;C;s;S");
+  response.Printf("vCont;c;C;s;S;r");
+  // Stopping single threads only makes sense in non-stop mode.
+  if (m_non_stop)
+    response.PutCString(";t");
 
   return SendPacketNoLock(response.GetString());
 }
@@ -1526,6 +1849,8 @@ GDBRemoteCommunicationServerLLGS::Handle_vCont(
     thread_action.tid = LLDB_INVALID_THREAD_ID;
     thread_action.state = eStateInvalid;
     thread_action.signal = 0;
+    thread_action.step_range_start = 0;
+    thread_action.step_range_end = 0;
 
     const char action = packet.GetChar();
     switch (action) {
@@ -1553,6 +1878,30 @@ GDBRemoteCommunicationServerLLGS::Handle_vCont(
       thread_action.state = eStateStepping;
       break;
 
+    case 'r':
+      // Step while the pc is in [start, end)
+      thread_action.state = eStateStepping;
+      thread_action.step_range_start =
+          packet.GetHexMaxU64(false, LLDB_INVALID_ADDRESS);
+      if (thread_action.step_range_start == LLDB_INVALID_ADDRESS ||
+          packet.GetChar() != ',')
+        return SendIllFormedResponse(
+            packet, "Could not parse range start in vCont packet r action");
+      thread_action.step_range_end =
+          packet.GetHexMaxU64(false, LLDB_INVALID_ADDRESS);
+      if (thread_action.step_range_end == LLDB_INVALID_ADDRESS)
+        return SendIllFormedResponse(
+            packet, "Could not parse range end in vCont packet r action");
+      break;
+
+    case 't':
+      // Stop
+      if (!m_non_stop)
+        return SendIllFormedResponse(
+            packet, "vCont t action is only supported in non-stop mode");
+      thread_action.state = eStateStopped;
+      break;
+
     default:
       return SendIllFormedResponse(packet, "Unsupported vCont action");
       break;
@@ -1580,7 +1929,9 @@ GDBRemoteCommunicationServerLLGS::Handle_vCont(
   }
 
   LLDB_LOG(log, "continued process {0}", m_debugged_process_up->GetID());
-  // No response required from vCont.
+  // No response required from vCont, except in non-stop mode.
+  if (m_non_stop)
+    return SendOKResponse();
   return PacketResult::Success;
 }
 
@@ -1609,6 +1960,23 @@ GDBRemoteCommunicationServerLLGS::Handle_stop_reason(
   if (!m_debugged_process_up)
     return SendErrorResponse(02);
 
+  // In non-stop mode, report every stopped thread: this one, and the rest in
+  // reply to vStopped.
+  if (m_non_stop && m_debugged_process_up->IsAlive()) {
+    m_stop_notifications.clear();
+    uint32_t thread_index = 0;
+    for (NativeThreadProtocol *thread;
+         (thread = m_debugged_process_up->GetThreadAtIndex(thread_index)) !=
+         nullptr;
+         ++thread_index) {
+      if (!StateIsRunningState(thread->GetState()))
+        m_stop_notifications.push_back(thread->GetID());
+    }
+    if (m_stop_notifications.empty())
+      return SendOKResponse();
+    return SendStopReplyPacketForThread(m_stop_notifications.front());
+  }
+
   return SendStopReasonForState(m_debugged_process_up->GetState());
 }
 
@@ -2680,8 +3048,10 @@ GDBRemoteCommunicationServerLLGS::Handle_s(StringExtractorGDBRemote &packet) {
   ResumeActionList actions;
   actions.Append(action);
 
-  // All other threads stop while we're single stepping a thread.
-  actions.SetDefaultThreadActionIfNeeded(eStateStopped, 0);
+  // All other threads stop while we're single stepping a thread. In non-stop
+  // mode, they are left alone.
+  if (!m_non_stop)
+    actions.SetDefaultThreadActionIfNeeded(eStateStopped, 0);
   Status error = m_debugged_process_up->Resume(actions);
   if (error.Fail()) {
     if (log)
@@ -2693,42 +3063,46 @@ GDBRemoteCommunicationServerLLGS::Handle_s(StringExtractorGDBRemote &packet) {
   }
 
   // No response here - the stop or exit will come from the resulting action.
+  if (m_non_stop)
+    return SendOKResponse();
   return PacketResult::Success;
 }
 
 GDBRemoteCommunication::PacketResult
-GDBRemoteCommunicationServerLLGS::Handle_qXfer_auxv_read(
-    StringExtractorGDBRemote &packet) {
-// *BSD impls should be able to do this too.
-#if defined(__linux__) || defined(__NetBSD__)
+GDBRemoteCommunicationServerLLGS::SendXferReadResponse(
+    StringExtractorGDBRemote &packet, llvm::StringRef prefix,
+    std::unique_ptr<llvm::MemoryBuffer> &buffer_up,
+    llvm::function_ref<llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>()>
+        read_object) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
 
   // Parse out the offset.
-  packet.SetFilePos(strlen("qXfer:auxv:read::"));
+  packet.SetFilePos(prefix.size());
   if (packet.GetBytesLeft() < 1)
-    return SendIllFormedResponse(packet,
-                                 "qXfer:auxv:read:: packet missing offset");
+    return SendIllFormedResponse(
+        packet, (prefix + " packet missing offset").str().c_str());
 
-  const uint64_t auxv_offset =
+  const uint64_t xfer_offset =
       packet.GetHexMaxU64(false, std::numeric_limits<uint64_t>::max());
-  if (auxv_offset == std::numeric_limits<uint64_t>::max())
-    return SendIllFormedResponse(packet,
-                                 "qXfer:auxv:read:: packet missing offset");
+  if (xfer_offset == std::numeric_limits<uint64_t>::max())
+    return SendIllFormedResponse(
+        packet, (prefix + " packet missing offset").str().c_str());
 
   // Parse out comma.
   if (packet.GetBytesLeft() < 1 || packet.GetChar() != ',')
     return SendIllFormedResponse(
-        packet, "qXfer:auxv:read:: packet missing comma after offset");
+        packet,
+        (prefix + " packet missing comma after offset").str().c_str());
 
   // Parse out the length.
-  const uint64_t auxv_length =
+  const uint64_t xfer_length =
       packet.GetHexMaxU64(false, std::numeric_limits<uint64_t>::max());
-  if (auxv_length == std::numeric_limits<uint64_t>::max())
-    return SendIllFormedResponse(packet,
-                                 "qXfer:auxv:read:: packet missing length");
+  if (xfer_length == std::numeric_limits<uint64_t>::max())
+    return SendIllFormedResponse(
+        packet, (prefix + " packet missing length").str().c_str());
 
-  // Grab the auxv data if we need it.
-  if (!m_active_auxv_buffer_up) {
+  // Grab the object data if we need it.
+  if (!buffer_up) {
     // Make sure we have a valid process.
     if (!m_debugged_process_up ||
         (m_debugged_process_up->GetID() == LLDB_INVALID_PROCESS_ID)) {
@@ -2739,38 +3113,37 @@ GDBRemoteCommunicationServerLLGS::Handle_qXfer_auxv_read(
       return SendErrorResponse(0x10);
     }
 
-    // Grab the auxv data.
-    auto buffer_or_error = m_debugged_process_up->GetAuxvData();
+    auto buffer_or_error = read_object();
     if (!buffer_or_error) {
-      std::error_code ec = buffer_or_error.getError();
-      LLDB_LOG(log, "no auxv data retrieved: {0}", ec.message());
-      return SendErrorResponse(ec.value());
+      Status error(buffer_or_error.takeError());
+      LLDB_LOG(log, "no {0} data retrieved: {1}", prefix, error);
+      return SendErrorResponse(error);
     }
-    m_active_auxv_buffer_up = std::move(*buffer_or_error);
+    buffer_up = std::move(*buffer_or_error);
   }
 
   StreamGDBRemote response;
   bool done_with_buffer = false;
 
-  llvm::StringRef buffer = m_active_auxv_buffer_up->getBuffer();
-  if (auxv_offset >= buffer.size()) {
+  llvm::StringRef buffer = buffer_up->getBuffer();
+  if (xfer_offset >= buffer.size()) {
     // We have nothing left to send.  Mark the buffer as complete.
     response.PutChar('l');
     done_with_buffer = true;
   } else {
     // Figure out how many bytes are available starting at the given offset.
-    buffer = buffer.drop_front(auxv_offset);
+    buffer = buffer.drop_front(xfer_offset);
 
     // Mark the response type according to whether we're reading the remainder
-    // of the auxv data.
-    if (auxv_length >= buffer.size()) {
+    // of the data.
+    if (xfer_length >= buffer.size()) {
       // There will be nothing left to read after this
       response.PutChar('l');
       done_with_buffer = true;
     } else {
       // There will still be bytes to read after this request.
       response.PutChar('m');
-      buffer = buffer.take_front(auxv_length);
+      buffer = buffer.take_front(xfer_length);
     }
 
     // Now write the data in encoded binary form.
@@ -2778,14 +3151,111 @@ GDBRemoteCommunicationServerLLGS::Handle_qXfer_auxv_read(
   }
 
   if (done_with_buffer)
-    m_active_auxv_buffer_up.reset();
+    buffer_up.reset();
 
   return SendPacketNoLock(response.GetString());
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_qXfer_auxv_read(
+    StringExtractorGDBRemote &packet) {
+// *BSD impls should be able to do this too.
+#if defined(__linux__) || defined(__NetBSD__)
+  return SendXferReadResponse(
+      packet, "qXfer:auxv:read::", m_active_auxv_buffer_up,
+      [this]() -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> {
+        auto buffer_or_error = m_debugged_process_up->GetAuxvData();
+        if (!buffer_or_error)
+          return llvm::errorCodeToError(buffer_or_error.getError());
+        return std::move(*buffer_or_error);
+      });
+#else
+  return SendUnimplementedResponse("not implemented on this platform");
+#endif
+}
+
+// Escape the characters that can't appear in an XML attribute value.
+static void PutXMLAttributeValue(Stream &stream, llvm::StringRef value) {
+  for (char c : value) {
+    switch (c) {
+    case '&':
+      stream.PutCString("&amp;");
+      break;
+    case '<':
+      stream.PutCString("&lt;");
+      break;
+    case '>':
+      stream.PutCString("&gt;");
+      break;
+    case '"':
+      stream.PutCString("&quot;");
+      break;
+    case '\'':
+      stream.PutCString("&apos;");
+      break;
+    default:
+      stream.PutChar(c);
+      break;
+    }
+  }
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_qXfer_libraries_svr4_read(
+    StringExtractorGDBRemote &packet) {
+#if defined(__linux__)
+  return SendXferReadResponse(
+      packet, "qXfer:libraries-svr4:read::",
+      m_active_libraries_svr4_buffer_up,
+      [this]() -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> {
+        auto libraries_or_error =
+            m_debugged_process_up->GetLoadedSVR4Libraries();
+        if (!libraries_or_error)
+          return libraries_or_error.takeError();
+
+        // The whole list goes out in one document, so the client doesn't
+        // need a memory read per link map entry. There is no main-lm
+        // attribute: the client finds the rendezvous structure through
+        // qShlibInfoAddr, and used to take main-lm for its address.
+        StreamString response;
+        response.PutCString("<library-list-svr4 version=\"1.0\">");
+        for (const SVR4LibraryInfo &library : *libraries_or_error) {
+          // Skip the main executable, it has no name in the link map.
+          if (library.name.empty())
+            continue;
+          response.PutCString("<library name=\"");
+          PutXMLAttributeValue(response, library.name);
+          response.Printf("\" lm=\"0x%" PRIx64 "\" l_addr=\"0x%" PRIx64
+                          "\" l_ld=\"0x%" PRIx64 "\"/>",
+                          library.link_map, library.base_addr,
+                          library.ld_addr);
+        }
+        response.PutCString("</library-list-svr4>");
+        return llvm::MemoryBuffer::getMemBufferCopy(response.GetString(),
+                                                    "libraries-svr4");
+      });
 #else
   return SendUnimplementedResponse("not implemented on this platform");
 #endif
 }
 
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_qShlibInfoAddr(
+    StringExtractorGDBRemote &packet) {
+  // Fail if we don't have a current process.
+  if (!m_debugged_process_up ||
+      m_debugged_process_up->GetID() == LLDB_INVALID_PROCESS_ID)
+    return SendErrorResponse(68);
+
+  const lldb::addr_t addr = m_debugged_process_up->GetDebugEntryAddress();
+  if (addr == LLDB_INVALID_ADDRESS)
+    return SendErrorResponse(69);
+
+  StreamGDBRemote response;
+  response.Printf("%" PRIx64, addr);
+  return SendPacketNoLock(response.GetString());
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle_QSaveRegisterState(
     StringExtractorGDBRemote &packet) {
@@ -2997,7 +3467,7 @@ GDBRemoteCommunicationServerLLGS::Handle_qThreadStopInfo(
 
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle_jThreadsInfo(
-    StringExtractorGDBRemote &) {
+    StringExtractorGDBRemote &packet) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_THREAD));
 
   // Ensure we have a debugged process.
@@ -3006,10 +3476,26 @@ GDBRemoteCommunicationServerLLGS::Handle_jThreadsInfo(
     return SendErrorResponse(50);
   LLDB_LOG(log, "preparing packet for pid {0}", m_debugged_process_up->GetID());
 
+  // Clients that saw jThreadsInfoOptions+ in qSupported may pass options.
+  ThreadsInfoOptions options;
+  if (packet.ConsumeFront("jThreadsInfo:")) {
+    auto json_object = StructuredData::ParseJSON(packet.Peek());
+    if (!json_object ||
+        json_object->GetType() != lldb::eStructuredDataTypeDictionary)
+      return SendIllFormedResponse(packet, "jThreadsInfo: Ill formed packet ");
+
+    auto json_dict = json_object->GetAsDictionary();
+    json_dict->GetValueForKeyAsBoolean("full_gprs", options.full_gprs);
+    uint64_t stack_memory = options.memory_budget;
+    json_dict->GetValueForKeyAsInteger("stack_memory", stack_memory);
+    options.memory_budget =
+        std::min<uint64_t>(stack_memory, k_jthreadsinfo_max_memory_budget);
+  }
+
   StreamString response;
   const bool threads_with_valid_stop_info_only = false;
   JSONArray::SP threads_array_sp = GetJSONThreadsInfo(
-      *m_debugged_process_up, threads_with_valid_stop_info_only);
+      *m_debugged_process_up, threads_with_valid_stop_info_only, options);
   if (!threads_array_sp) {
     LLDB_LOG(log, "failed to prepare a packet for pid {0}",
              m_debugged_process_up->GetID());
@@ -3110,10 +3596,111 @@ GDBRemoteCommunicationServerLLGS::Handle_QPassSignals(
   return SendOKResponse();
 }
 
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_QNonStop(
+    StringExtractorGDBRemote &packet) {
+  packet.SetFilePos(strlen("QNonStop:"));
+  const uint32_t enable = packet.GetU32(UINT32_MAX, 16);
+  if (enable > 1 || packet.GetBytesLeft() > 0)
+    return SendIllFormedResponse(packet, "QNonStop expects 0 or 1");
+
+  if (enable && !m_process_factory.SupportsNonStopMode())
+    return SendErrorResponse(GDBRemoteServerError::eErrorNonStop);
+  // Only the stops of the whole process go into the history.
+  if (enable && m_record_history)
+    return SendErrorResponse(GDBRemoteServerError::eErrorNonStop);
+
+  m_non_stop = enable;
+  m_stop_notifications.clear();
+  if (m_debugged_process_up)
+    m_debugged_process_up->SetNonStopMode(m_non_stop);
+  return SendOKResponse();
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_QRecordHistory(
+    StringExtractorGDBRemote &packet) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
+
+  packet.SetFilePos(strlen("QRecordHistory:"));
+  const uint32_t enable = packet.GetU32(UINT32_MAX, 16);
+  if (enable > 1 || packet.GetBytesLeft() > 0)
+    return SendIllFormedResponse(packet, "QRecordHistory expects 0 or 1");
+
+  if (!m_debugged_process_up)
+    return SendErrorResponse(GDBRemoteServerError::eErrorNoProcess);
+
+  Status error = m_debugged_process_up->SetRecordHistory(enable);
+  if (error.Fail()) {
+    LLDB_LOG(log, "QRecordHistory:{0} failed for process {1}: {2}", enable,
+             m_debugged_process_up->GetID(), error);
+    return SendErrorResponse(GDBRemoteServerError::eErrorHistory);
+  }
+
+  m_record_history = enable;
+  return SendOKResponse();
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_QSharedMemoryTransport(
+    StringExtractorGDBRemote &packet) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  Log *log(GetLogIfAnyCategoriesSet(GDBR_LOG_COMM));
+
+  packet.SetFilePos(strlen("QSharedMemoryTransport:"));
+  std::string uri;
+  packet.GetHexByteString(uri);
+  if (uri.empty() || packet.GetBytesLeft() > 0)
+    return SendIllFormedResponse(packet,
+                                 "QSharedMemoryTransport expects a hex URI");
+
+  std::unique_ptr<ConnectionSharedMemory> conn_up(
+      new ConnectionSharedMemory(m_connection_sp));
+  Status error;
+  if (conn_up->Connect(uri, &error) != eConnectionStatusSuccess) {
+    LLDB_LOG(log, "QSharedMemoryTransport:{0} failed: {1}", uri, error);
+    return SendErrorResponse(error);
+  }
+
+  // The reply goes out on the current connection, the packets after it go
+  // through the shared memory. The main loop keeps waiting on the current
+  // connection, which the client writes to when we need waking up.
+  PacketResult result = SendOKResponse();
+  if (result == PacketResult::Success)
+    m_connection_sp.reset(conn_up.release());
+  return result;
+#else
+  return SendUnimplementedResponse("");
+#endif
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_vStopped(
+    StringExtractorGDBRemote &packet) {
+  if (!m_non_stop || !m_debugged_process_up)
+    return SendErrorResponse(GDBRemoteServerError::eErrorNonStop);
+
+  // The client has seen the stop at the front of the queue.
+  if (!m_stop_notifications.empty())
+    m_stop_notifications.pop_front();
+
+  // Skip the threads that exited or were resumed since they stopped.
+  while (!m_stop_notifications.empty()) {
+    const lldb::tid_t tid = m_stop_notifications.front();
+    NativeThreadProtocol *thread = m_debugged_process_up->GetThreadByID(tid);
+    if (thread && !StateIsRunningState(thread->GetState()))
+      return SendStopReplyPacketForThread(tid);
+    m_stop_notifications.pop_front();
+  }
+  return SendOKResponse();
+}
+
 void GDBRemoteCommunicationServerLLGS::MaybeCloseInferiorTerminalConnection() {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
 
-  // Tell the stdio connection to shut down.
+  // Tell the stdio connection to shut down, once the main loop no longer
+  // watches it.
+  StopSTDIOForwarding();
   if (m_stdio_communication.IsConnected()) {
     auto connection = m_stdio_communication.GetConnection();
     if (connection) {
@@ -3210,6 +3797,8 @@ void GDBRemoteCommunicationServerLLGS::ClearProcessSpecificData() {
 
   LLDB_LOG(log, "clearing auxv buffer: {0}", m_active_auxv_buffer_up.get());
   m_active_auxv_buffer_up.reset();
+  m_active_libraries_svr4_buffer_up.reset();
+  m_stop_notifications.clear();
 }
 
 FileSpec
@@ -12,6 +12,7 @@
 
 // C Includes
 // C++ Includes
+#include <deque>
 #include <mutex>
 #include <unordered_map>
 
@@ -80,6 +81,9 @@ public:
 
   void DidExec(NativeProcessProtocol *process) override;
 
+  void ThreadStopped(NativeProcessProtocol *process,
+                     NativeThreadProtocol &thread) override;
+
   Status InitializeConnection(std::unique_ptr<Connection> &&connection);
 
 protected:
@@ -96,17 +100,32 @@ protected:
 
   lldb::StateType m_inferior_prev_state = lldb::StateType::eStateInvalid;
   std::unique_ptr<llvm::MemoryBuffer> m_active_auxv_buffer_up;
+  std::unique_ptr<llvm::MemoryBuffer> m_active_libraries_svr4_buffer_up;
   std::mutex m_saved_registers_mutex;
   std::unordered_map<uint32_t, lldb::DataBufferSP> m_saved_registers_map;
   uint32_t m_next_saved_registers_id = 1;
   bool m_handshake_completed = false;
 
+  // Set by QNonStop. In non-stop mode, stops are reported one thread at a
+  // time with %Stop notifications.
+  bool m_non_stop = false;
+  // The threads whose stops the client hasn't acknowledged with vStopped
+  // yet. The front one is the last one reported.
+  std::deque<lldb::tid_t> m_stop_notifications;
+
+  // Set by QRecordHistory. The process records its execution history, so
+  // that bs and bc can run it backward.
+  bool m_record_history = false;
+
   PacketResult SendONotification(const char *buffer, uint32_t len);
 
-  PacketResult SendWResponse(NativeProcessProtocol *process);
+  PacketResult SendWResponse(NativeProcessProtocol *process,
+                             bool notification = false);
 
   PacketResult SendStopReplyPacketForThread(lldb::tid_t tid);
 
+  PacketResult SendStopNotificationForThread(lldb::tid_t tid);
+
   PacketResult SendStopReasonForState(lldb::StateType process_state);
 
   PacketResult Handle_k(StringExtractorGDBRemote &packet);
@@ -123,6 +142,10 @@ protected:
 
   PacketResult Handle_C(StringExtractorGDBRemote &packet);
 
+  PacketResult Handle_bc(StringExtractorGDBRemote &packet);
+
+  PacketResult Handle_bs(StringExtractorGDBRemote &packet);
+
   PacketResult Handle_c(StringExtractorGDBRemote &packet);
 
   PacketResult Handle_vCont(StringExtractorGDBRemote &packet);
@@ -165,6 +188,21 @@ protected:
 
   PacketResult Handle_qXfer_auxv_read(StringExtractorGDBRemote &packet);
 
+  PacketResult
+  Handle_qXfer_libraries_svr4_read(StringExtractorGDBRemote &packet);
+
+  PacketResult Handle_qShlibInfoAddr(StringExtractorGDBRemote &packet);
+
+  // Reply to a qXfer read of the form "<prefix><offset>,<length>" with the
+  // requested piece of \a buffer_up, calling \a read_object to fill it in
+  // on the first read. The buffer is released once it has been sent in
+  // full.
+  PacketResult SendXferReadResponse(
+      StringExtractorGDBRemote &packet, llvm::StringRef prefix,
+      std::unique_ptr<llvm::MemoryBuffer> &buffer_up,
+      llvm::function_ref<llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>()>
+          read_object);
+
   PacketResult Handle_QSaveRegisterState(StringExtractorGDBRemote &packet);
 
   PacketResult Handle_jTraceStart(StringExtractorGDBRemote &packet);
@@ -191,6 +229,14 @@ protected:
 
   PacketResult Handle_QPassSignals(StringExtractorGDBRemote &packet);
 
+  PacketResult Handle_QNonStop(StringExtractorGDBRemote &packet);
+
+  PacketResult Handle_QRecordHistory(StringExtractorGDBRemote &packet);
+
+  PacketResult Handle_QSharedMemoryTransport(StringExtractorGDBRemote &packet);
+
+  PacketResult Handle_vStopped(StringExtractorGDBRemote &packet);
+
   void SetCurrentThreadID(lldb::tid_t tid);
 
   lldb::tid_t GetCurrentThreadID() const;
@@ -205,6 +251,10 @@ protected:
                           const ArchSpec &arch) override;
 
 private:
+  // Write the stop reply for \a thread to \a response.
+  bool PrepareStopReplyPacketForThread(NativeThreadProtocol &thread,
+                                       StreamString &response);
+
   void HandleInferiorState_Exited(NativeProcessProtocol *process);
 
   void HandleInferiorState_Stopped(NativeProcessProtocol *process);
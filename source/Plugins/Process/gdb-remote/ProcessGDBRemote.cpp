@@ -115,9 +115,31 @@ static PropertyDefinition g_properties[] = {
      "Specify the default packet timeout in seconds."},
     {"target-definition-file", OptionValue::eTypeFileSpec, true, 0, NULL, NULL,
      "The file that provides the description for remote target registers."},
+    {"record-history", OptionValue::eTypeBoolean, true, 0, NULL, NULL,
+     "Record the execution history of processes so that they can be run "
+     "backward, if the remote stub supports it."},
+    {"shared-memory-transport", OptionValue::eTypeBoolean, true, 0, NULL,
+     NULL, "Exchange packets with the remote stub through shared memory "
+           "rather than its connection, if it supports it and runs on this "
+           "host."},
+    {"expedite-all-gprs", OptionValue::eTypeBoolean, true, 0, NULL, NULL,
+     "Ask the remote stub to send all the general purpose registers of every "
+     "thread when the process stops, rather than those needed to start a "
+     "backtrace, if it supports it."},
+    {"expedited-stack-memory", OptionValue::eTypeUInt64, true, 16 * 1024, NULL,
+     NULL, "The number of bytes of thread stacks the remote stub may send "
+           "across all threads when the process stops, if it supports it. "
+           "Stacks that don't fit are read on demand."},
     {NULL, OptionValue::eTypeInvalid, false, 0, NULL, NULL, NULL}};
 
-enum { ePropertyPacketTimeout, ePropertyTargetDefinitionFile };
+enum {
+  ePropertyPacketTimeout,
+  ePropertyTargetDefinitionFile,
+  ePropertyRecordHistory,
+  ePropertySharedMemoryTransport,
+  ePropertyExpediteAllGPRs,
+  ePropertyExpeditedStackMemory
+};
 
 class PluginProperties : public Properties {
 public:
@@ -147,6 +169,30 @@ public:
     const uint32_t idx = ePropertyTargetDefinitionFile;
     return m_collection_sp->GetPropertyAtIndexAsFileSpec(NULL, idx);
   }
+
+  bool GetRecordHistory() const {
+    const uint32_t idx = ePropertyRecordHistory;
+    return m_collection_sp->GetPropertyAtIndexAsBoolean(
+        NULL, idx, g_properties[idx].default_uint_value != 0);
+  }
+
+  bool GetSharedMemoryTransport() const {
+    const uint32_t idx = ePropertySharedMemoryTransport;
+    return m_collection_sp->GetPropertyAtIndexAsBoolean(
+        NULL, idx, g_properties[idx].default_uint_value != 0);
+  }
+
+  bool GetExpediteAllGPRs() const {
+    const uint32_t idx = ePropertyExpediteAllGPRs;
+    return m_collection_sp->GetPropertyAtIndexAsBoolean(
+        NULL, idx, g_properties[idx].default_uint_value != 0);
+  }
+
+  uint64_t GetExpeditedStackMemory() const {
+    const uint32_t idx = ePropertyExpeditedStackMemory;
+    return m_collection_sp->GetPropertyAtIndexAsUInt64(
+        NULL, idx, g_properties[idx].default_uint_value);
+  }
 };
 
 typedef std::shared_ptr<PluginProperties> ProcessKDPPropertiesSP;
@@ -255,6 +301,7 @@ ProcessGDBRemote::ProcessGDBRemote(lldb::TargetSP target_sp,
       m_async_thread_state_mutex(), m_thread_ids(), m_thread_pcs(),
       m_jstopinfo_sp(), m_jthreadsinfo_sp(), m_continue_c_tids(),
       m_continue_C_tids(), m_continue_s_tids(), m_continue_S_tids(),
+      m_continue_s_ranges(),
       m_max_memory_size(0), m_remote_stub_max_memory_size(0),
       m_addr_to_mmap_size(), m_thread_create_bp_sp(),
       m_waiting_for_attach(false), m_destroy_tried_resuming(false),
@@ -1026,6 +1073,12 @@ Status ProcessGDBRemote::ConnectToDebugserver(llvm::StringRef connect_url) {
   m_gdb_comm.GetVAttachOrWaitSupported();
   m_gdb_comm.EnableErrorStringInPacket();
 
+  // The read thread of non-stop mode reads from the connection, so it can't
+  // be switched under it.
+  if (!GetTarget().GetNonStopModeEnabled() &&
+      GetGlobalPluginProperties()->GetSharedMemoryTransport())
+    m_gdb_comm.EnableSharedMemoryTransport();
+
   // Ask the remote server for the default thread id
   if (GetTarget().GetNonStopModeEnabled())
     m_gdb_comm.GetDefaultThreadId(m_initial_tid);
@@ -1154,6 +1207,22 @@ void ProcessGDBRemote::DidLaunchOrAttach(ArchSpec &process_arch) {
         m_gdb_comm.GetSupportedStructuredDataPlugins();
     if (supported_packets_array)
       MapSupportedStructuredDataPlugins(*supported_packets_array);
+
+    // Start recording the execution history if the process is to be run
+    // backward.
+    if (GetGlobalPluginProperties()->GetRecordHistory()) {
+      if (m_gdb_comm.GetReverseStepSupported() ||
+          m_gdb_comm.GetReverseContinueSupported()) {
+        Status error = m_gdb_comm.SetRecordHistory(true);
+        if (error.Fail() && log)
+          log->Printf("ProcessGDBRemote::%s failed to record the execution "
+                      "history: %s",
+                      __FUNCTION__, error.AsCString());
+      } else if (log)
+        log->Printf("ProcessGDBRemote::%s the remote stub can't run the "
+                    "process backward",
+                    __FUNCTION__);
+    }
   }
 }
 
@@ -1271,12 +1340,13 @@ Status ProcessGDBRemote::WillResume() {
   m_continue_C_tids.clear();
   m_continue_s_tids.clear();
   m_continue_S_tids.clear();
+  m_continue_s_ranges.clear();
   m_jstopinfo_sp.reset();
   m_jthreadsinfo_sp.reset();
   return Status();
 }
 
-Status ProcessGDBRemote::DoResume() {
+Status ProcessGDBRemote::DoResume(RunDirection direction) {
   Status error;
   Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_PROCESS));
   if (log)
@@ -1294,7 +1364,29 @@ Status ProcessGDBRemote::DoResume() {
 
     StreamString continue_packet;
     bool continue_packet_error = false;
-    if (m_gdb_comm.HasAnyVContSupport()) {
+    if (direction == eRunReverse) {
+      // Running backward is all-stop: either one thread steps back while the
+      // others stay put, or all the threads run back together. Signals can't
+      // be delivered backward.
+      if (!m_continue_C_tids.empty() || !m_continue_S_tids.empty()) {
+        continue_packet_error = true;
+      } else if (m_continue_s_tids.size() == 1 &&
+                 m_continue_c_tids.empty()) {
+        if (m_gdb_comm.GetReverseStepSupported()) {
+          m_gdb_comm.SetCurrentThreadForRun(m_continue_s_tids.front());
+          continue_packet.PutCString("bs");
+        } else
+          continue_packet_error = true;
+      } else if (m_continue_s_tids.empty() &&
+                 m_continue_c_tids.size() == num_threads) {
+        if (m_gdb_comm.GetReverseContinueSupported()) {
+          m_gdb_comm.SetCurrentThreadForRun(-1);
+          continue_packet.PutCString("bc");
+        } else
+          continue_packet_error = true;
+      } else
+        continue_packet_error = true;
+    } else if (m_gdb_comm.HasAnyVContSupport()) {
       if (!GetTarget().GetNonStopModeEnabled() &&
           (m_continue_c_tids.size() == num_threads ||
            (m_continue_c_tids.empty() && m_continue_C_tids.empty() &&
@@ -1332,8 +1424,17 @@ Status ProcessGDBRemote::DoResume() {
             for (tid_collection::const_iterator
                      t_pos = m_continue_s_tids.begin(),
                      t_end = m_continue_s_tids.end();
-                 t_pos != t_end; ++t_pos)
-              continue_packet.Printf(";s:%4.4" PRIx64, *t_pos);
+                 t_pos != t_end; ++t_pos) {
+              auto range = m_continue_s_ranges.find(*t_pos);
+              if (range != m_continue_s_ranges.end() &&
+                  m_gdb_comm.GetVContSupported('r'))
+                continue_packet.Printf(";r%" PRIx64 ",%" PRIx64
+                                       ":%4.4" PRIx64,
+                                       range->second.first,
+                                       range->second.second, *t_pos);
+              else
+                continue_packet.Printf(";s:%4.4" PRIx64, *t_pos);
+            }
           } else
             continue_packet_error = true;
         }
@@ -1356,7 +1457,7 @@ Status ProcessGDBRemote::DoResume() {
     } else
       continue_packet_error = true;
 
-    if (continue_packet_error) {
+    if (continue_packet_error && direction == eRunForward) {
       // Either no vCont support, or we tried to use part of the vCont packet
       // that wasn't supported by the remote GDB server. We need to try and
       // make a simple packet that can do our continue
@@ -1461,7 +1562,9 @@ Status ProcessGDBRemote::DoResume() {
       }
     }
 
-    if (continue_packet_error) {
+    if (continue_packet_error && direction == eRunReverse) {
+      error.SetErrorString("the remote stub can't run these threads backward");
+    } else if (continue_packet_error) {
       error.SetErrorString("can't make continue packet for this resume");
     } else {
       EventSP event_sp;
@@ -1645,12 +1748,21 @@ bool ProcessGDBRemote::UpdateThreadList(ThreadList &old_thread_list,
     num_thread_ids = m_thread_ids.size();
   }
 
+  // In non-stop mode, the thread IDs are those of the stopped threads only.
+  const bool non_stop = GetTarget().GetNonStopModeEnabled();
   ThreadList old_thread_list_copy(old_thread_list);
   if (num_thread_ids > 0) {
     for (size_t i = 0; i < num_thread_ids; ++i) {
       tid_t tid = m_thread_ids[i];
       ThreadSP thread_sp(
           old_thread_list_copy.RemoveThreadByProtocolID(tid, false));
+      if (!thread_sp) {
+        auto pos = m_non_stop_running_threads.find(tid);
+        if (pos != m_non_stop_running_threads.end()) {
+          thread_sp = pos->second;
+          m_non_stop_running_threads.erase(pos);
+        }
+      }
       if (!thread_sp) {
         thread_sp.reset(new ThreadGDBRemote(*this, tid));
         LLDB_LOGV(log, "Making new thread: {0} for thread ID: {1:x}.",
@@ -1666,13 +1778,17 @@ bool ProcessGDBRemote::UpdateThreadList(ThreadList &old_thread_list,
   }
 
   // Whatever that is left in old_thread_list_copy are not present in
-  // new_thread_list. Remove non-existent threads from internal id table.
+  // new_thread_list. Remove non-existent threads from internal id table. In
+  // non-stop mode, they are still running instead, so hold on to them.
   size_t old_num_thread_ids = old_thread_list_copy.GetSize(false);
   for (size_t i = 0; i < old_num_thread_ids; i++) {
     ThreadSP old_thread_sp(old_thread_list_copy.GetThreadAtIndex(i, false));
     if (old_thread_sp) {
       lldb::tid_t old_thread_id = old_thread_sp->GetProtocolID();
-      m_thread_id_to_index_id_map.erase(old_thread_id);
+      if (non_stop)
+        m_non_stop_running_threads[old_thread_id] = old_thread_sp;
+      else
+        m_thread_id_to_index_id_map.erase(old_thread_id);
     }
   }
 
@@ -1914,6 +2030,12 @@ ThreadSP ProcessGDBRemote::SetThreadStopInfo(
               thread_sp->SetStopInfo(
                   StopInfo::CreateStopReasonWithExec(*thread_sp));
               handled = true;
+            } else if (reason.compare("history boundary") == 0) {
+              thread_sp->SetStopInfo(
+                  StopInfo::CreateStopReasonHistoryBoundary(
+                      *thread_sp,
+                      description.empty() ? nullptr : description.c_str()));
+              handled = true;
             }
           } else if (!signo) {
             addr_t pc = thread_sp->GetRegisterContext()->GetPC();
@@ -2319,6 +2441,10 @@ StateType ProcessGDBRemote::SetThreadStopInfo(StringExtractor &stop_packet) {
         StreamString ostr;
         ostr.Printf("%" PRIu64 " %" PRIu32, wp_addr, wp_index);
         description = ostr.GetString();
+      } else if (key.compare("replaylog") == 0) {
+        // Standard GDB stop reply 'replaylog:begin' or 'replaylog:end': the
+        // process got to an end of its recorded execution history.
+        reason = "history boundary";
       } else if (key.compare("library") == 0) {
         LoadModules();
       } else if (key.size() == 2 && ::isxdigit(key[0]) && ::isxdigit(key[1])) {
@@ -2670,17 +2796,12 @@ bool ProcessGDBRemote::IsAlive() {
 }
 
 addr_t ProcessGDBRemote::GetImageInfoAddress() {
-  // request the link map address via the $qShlibInfoAddr packet
-  lldb::addr_t addr = m_gdb_comm.GetShlibInfoAddr();
-
-  // the loaded module list can also provides a link map address
-  if (addr == LLDB_INVALID_ADDRESS) {
-    LoadedModuleInfoList list;
-    if (GetLoadedModuleList(list).Success())
-      addr = list.m_link_map;
-  }
-
-  return addr;
+  // Request the address of the dynamic loader information via the
+  // $qShlibInfoAddr packet. The main-lm attribute of the library list is the
+  // link map entry of the main executable, not this address, so if the stub
+  // doesn't know it the dynamic loader falls back to the executable's
+  // object file.
+  return m_gdb_comm.GetShlibInfoAddr();
 }
 
 void ProcessGDBRemote::WillPublicStop() {
@@ -2689,7 +2810,9 @@ void ProcessGDBRemote::WillPublicStop() {
   // runtime queue information (iOS and MacOSX only), and more. Expediting
   // memory will help stack backtracing be much faster. Expediting registers
   // will make sure we don't have to read the thread registers for GPRs.
-  m_jthreadsinfo_sp = m_gdb_comm.GetThreadsInfo();
+  m_jthreadsinfo_sp = m_gdb_comm.GetThreadsInfo(
+      GetGlobalPluginProperties()->GetExpediteAllGPRs(),
+      GetGlobalPluginProperties()->GetExpeditedStackMemory());
 
   if (m_jthreadsinfo_sp) {
     // Now set the stop info for each thread and also expedite any registers
@@ -3210,6 +3333,14 @@ Status ProcessGDBRemote::EnableBreakpointSite(BreakpointSite *bp_site) {
   return EnableSoftwareBreakpoint(bp_site);
 }
 
+bool ProcessGDBRemote::StepsOverBreakpointSite(BreakpointSite &bp_site) {
+  // The stub can only step over the breakpoints it inserted, and only does
+  // so in all-stop mode.
+  return bp_site.GetType() == BreakpointSite::eExternal &&
+         !GetTarget().GetNonStopModeEnabled() &&
+         m_gdb_comm.GetBreakpointStepOverSupported();
+}
+
 Status ProcessGDBRemote::DisableBreakpointSite(BreakpointSite *bp_site) {
   Status error;
   assert(bp_site != NULL);
@@ -3628,6 +3759,17 @@ bool ProcessGDBRemote::HandleNotifyPacket(StringExtractorGDBRemote &packet) {
   // skip %stop:
   StringExtractorGDBRemote stop_info(pkt.c_str() + 5);
 
+  // The process exited or was killed by a signal.
+  const char stop_type = stop_info.GetChar();
+  if (stop_type == 'W' || stop_type == 'X') {
+    const int exit_status = stop_info.GetHexU8();
+    ClearThreadIDList();
+    m_non_stop_running_threads.clear();
+    SetExitStatus(exit_status, nullptr);
+    return true;
+  }
+  stop_info.SetFilePos(0);
+
   // pass as a thread stop info packet
   SetLastStopPacket(stop_info);
 
@@ -4201,10 +4343,13 @@ bool ProcessGDBRemote::GetModuleSpec(const FileSpec &module_file_spec,
 
   const ModuleCacheKey key(module_file_spec.GetPath(),
                            arch.GetTriple().getTriple());
-  auto cached = m_cached_module_specs.find(key);
-  if (cached != m_cached_module_specs.end()) {
-    module_spec = cached->second;
-    return bool(module_spec);
+  {
+    std::lock_guard<std::mutex> guard(m_cached_module_specs_mutex);
+    auto cached = m_cached_module_specs.find(key);
+    if (cached != m_cached_module_specs.end()) {
+      module_spec = cached->second;
+      return bool(module_spec);
+    }
   }
 
   if (!m_gdb_comm.GetModuleInfo(module_file_spec, arch, module_spec)) {
@@ -4223,6 +4368,7 @@ bool ProcessGDBRemote::GetModuleSpec(const FileSpec &module_file_spec,
                 arch.GetTriple().getTriple().c_str(), stream.GetData());
   }
 
+  std::lock_guard<std::mutex> guard(m_cached_module_specs_mutex);
   m_cached_module_specs[key] = module_spec;
   return true;
 }
@@ -4231,6 +4377,7 @@ void ProcessGDBRemote::PrefetchModuleSpecs(
     llvm::ArrayRef<FileSpec> module_file_specs, const llvm::Triple &triple) {
   auto module_specs = m_gdb_comm.GetModulesInfo(module_file_specs, triple);
   if (module_specs) {
+    std::lock_guard<std::mutex> guard(m_cached_module_specs_mutex);
     for (const FileSpec &spec : module_file_specs)
       m_cached_module_specs[ModuleCacheKey(spec.GetPath(),
                                            triple.getTriple())] = ModuleSpec();
@@ -113,7 +113,7 @@ public:
   //------------------------------------------------------------------
   Status WillResume() override;
 
-  Status DoResume() override;
+  Status DoResume(lldb::RunDirection direction) override;
 
   Status DoHalt(bool &caused_stop) override;
 
@@ -170,6 +170,8 @@ public:
 
   Status DisableBreakpointSite(BreakpointSite *bp_site) override;
 
+  bool StepsOverBreakpointSite(BreakpointSite &bp_site) override;
+
   //----------------------------------------------------------------------
   // Process Watchpoints
   //----------------------------------------------------------------------
@@ -223,6 +225,9 @@ public:
 
   size_t LoadModules() override;
 
+  // Query remote GDBServer for a detailed loaded library list
+  Status GetLoadedModuleList(LoadedModuleInfoList &) override;
+
   Status GetFileLoadAddress(const FileSpec &file, bool &is_loaded,
                             lldb::addr_t &load_addr) override;
 
@@ -282,6 +287,10 @@ protected:
   tid_collection m_thread_ids; // Thread IDs for all threads. This list gets
                                // updated after stopping
   std::vector<lldb::addr_t> m_thread_pcs;     // PC values for all the threads.
+  // In non-stop mode, the threads that kept running through the last stop.
+  // They are left out of the thread list, but keep their state, such as
+  // their thread plans, until they stop again.
+  std::map<lldb::tid_t, lldb::ThreadSP> m_non_stop_running_threads;
   StructuredData::ObjectSP m_jstopinfo_sp;    // Stop info only for any threads
                                               // that have valid stop infos
   StructuredData::ObjectSP m_jthreadsinfo_sp; // Full stop info, expedited
@@ -292,6 +301,8 @@ protected:
   tid_sig_collection m_continue_C_tids;       // 'C' for continue with signal
   tid_collection m_continue_s_tids;           // 's' for step
   tid_sig_collection m_continue_S_tids;       // 'S' for step with signal
+  std::map<lldb::tid_t, std::pair<lldb::addr_t, lldb::addr_t>>
+      m_continue_s_ranges; // Ranges to step the 's' threads through with 'r'
   uint64_t m_max_memory_size; // The maximum number of bytes to read/write when
                               // reading and writing memory
   uint64_t m_remote_stub_max_memory_size; // The maximum memory size the remote
@@ -405,9 +416,6 @@ protected:
   // Query remote GDBServer for register information
   bool GetGDBServerRegisterInfo(ArchSpec &arch);
 
-  // Query remote GDBServer for a detailed loaded library list
-  Status GetLoadedModuleList(LoadedModuleInfoList &);
-
   lldb::ModuleSP LoadModuleAtAddress(const FileSpec &file,
                                      lldb::addr_t link_map,
                                      lldb::addr_t base_addr,
@@ -465,6 +473,9 @@ private:
     }
   };
 
+  // Modules are looked up from several threads at once when they are loaded
+  // in parallel.
+  std::mutex m_cached_module_specs_mutex;
   llvm::DenseMap<ModuleCacheKey, ModuleSpec, ModuleCacheInfo>
       m_cached_module_specs;
 
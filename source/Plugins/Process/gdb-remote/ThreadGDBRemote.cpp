@@ -17,6 +17,7 @@
 #include "lldb/Target/StopInfo.h"
 #include "lldb/Target/SystemRuntime.h"
 #include "lldb/Target/Target.h"
+#include "lldb/Target/ThreadPlan.h"
 #include "lldb/Target/UnixSignals.h"
 #include "lldb/Target/Unwind.h"
 #include "lldb/Utility/DataExtractor.h"
@@ -258,8 +259,13 @@ void ThreadGDBRemote::WillResume(StateType resume_state) {
     case eStateStepping:
       if (gdb_process->GetUnixSignals()->SignalIsValid(signo))
         gdb_process->m_continue_S_tids.push_back(std::make_pair(tid, signo));
-      else
+      else {
         gdb_process->m_continue_s_tids.push_back(tid);
+        // Let the stub step through the range the plan steps in, if any.
+        lldb::addr_t start, end;
+        if (GetCurrentPlan()->GetSteppingRange(start, end))
+          gdb_process->m_continue_s_ranges[tid] = std::make_pair(start, end);
+      }
       break;
 
     default:
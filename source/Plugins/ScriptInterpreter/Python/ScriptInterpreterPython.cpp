@@ -56,6 +56,12 @@
 using namespace lldb;
 using namespace lldb_private;
 
+// The name synthetic children providers are accounted under in the
+// formatter statistics.
+static llvm::StringRef GetImplementorClassName(void *implementor) {
+  return Py_TYPE(static_cast<PyObject *>(implementor))->tp_name;
+}
+
 static ScriptInterpreterPython::SWIGInitCallback g_swig_init_callback = nullptr;
 static ScriptInterpreterPython::SWIGBreakpointCallbackFunction
     g_swig_breakpoint_callback = nullptr;
@@ -239,6 +245,10 @@ bool ScriptInterpreterPython::Locker::DoFreeLock() {
 bool ScriptInterpreterPython::Locker::DoTearDownSession() {
   if (!m_python_interpreter)
     return false;
+  // Another thread took over a parked formatter batch session, which is now
+  // its own to leave.
+  if (m_python_interpreter->m_session_owner != std::this_thread::get_id())
+    return false;
   m_python_interpreter->LeaveSession();
   return true;
 }
@@ -260,8 +270,13 @@ ScriptInterpreterPython::ScriptInterpreterPython(
       m_dictionary_name(
           interpreter.GetDebugger().GetInstanceName().AsCString()),
       m_terminal_state(), m_active_io_handler(eIOHandlerNone),
-      m_session_is_active(false), m_pty_slave_is_open(false),
-      m_valid_session(true), m_lock_count(0), m_command_thread_state(nullptr) {
+      m_session_is_active(false), m_session_owner(), m_pty_slave_is_open(false),
+      m_valid_session(true), m_lock_count(0), m_command_thread_state(nullptr),
+      m_formatter_batch_mutex(), m_formatter_batch_owner(),
+      m_formatter_batch_depth(0), m_formatter_batch_lock(),
+      m_formatter_batch_thread_state(nullptr),
+      m_formatter_batch_session_lost(false),
+      m_formatter_stats_mutex(), m_formatter_stats() {
   InitializePrivate();
 
   m_dictionary_name.append("_dict");
@@ -558,6 +573,7 @@ void ScriptInterpreterPython::LeaveSession() {
   }
 
   m_session_is_active = false;
+  m_session_owner = std::thread::id();
 }
 
 bool ScriptInterpreterPython::SetStdHandle(File &file, const char *py_name,
@@ -585,7 +601,7 @@ bool ScriptInterpreterPython::EnterSession(uint16_t on_entry_flags, FILE *in,
   // If we have already entered the session, without having officially 'left'
   // it, then there is no need to 'enter' it again.
   Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_SCRIPT));
-  if (m_session_is_active) {
+  if (m_session_is_active && !TakeOverFormatterBatchSession()) {
     if (log)
       log->Printf(
           "ScriptInterpreterPython::EnterSession(on_entry_flags=0x%" PRIx16
@@ -600,6 +616,7 @@ bool ScriptInterpreterPython::EnterSession(uint16_t on_entry_flags, FILE *in,
         on_entry_flags);
 
   m_session_is_active = true;
+  m_session_owner = std::this_thread::get_id();
 
   StreamString run_string;
 
@@ -1936,9 +1953,11 @@ ScriptInterpreterPython::CreateSyntheticScriptedProvider(
 
   void *ret_val = nullptr;
 
+  AcquireFormatterBatchLock();
   {
     Locker py_lock(this,
                    Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+    FormatterTimer timer(*this, class_name);
     ret_val = g_swig_synthetic_script(
         class_name, python_interpreter->m_dictionary_name.c_str(), valobj);
   }
@@ -2055,10 +2074,12 @@ bool ScriptInterpreterPython::GetScriptedSummary(
 
   bool ret_val;
   if (python_function_name && *python_function_name) {
+    AcquireFormatterBatchLock();
     {
       Locker py_lock(this, Locker::AcquireLock | Locker::InitSession |
                                Locker::NoSTDIN);
       {
+        FormatterTimer timer(*this, python_function_name);
         TypeSummaryOptionsSP options_sp(new TypeSummaryOptions(options));
 
         static Timer::Category func_cat("g_swig_typescript_callback");
@@ -2207,9 +2228,11 @@ size_t ScriptInterpreterPython::CalculateNumChildren(
 
   size_t ret_val = 0;
 
+  AcquireFormatterBatchLock();
   {
     Locker py_lock(this,
                    Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+    FormatterTimer timer(*this, GetImplementorClassName(implementor));
     ret_val = g_swig_calc_children(implementor, max);
   }
 
@@ -2233,9 +2256,11 @@ lldb::ValueObjectSP ScriptInterpreterPython::GetChildAtIndex(
 
   lldb::ValueObjectSP ret_val;
 
+  AcquireFormatterBatchLock();
   {
     Locker py_lock(this,
                    Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+    FormatterTimer timer(*this, GetImplementorClassName(implementor));
     void *child_ptr = g_swig_get_child_index(implementor, idx);
     if (child_ptr != nullptr && child_ptr != Py_None) {
       lldb::SBValue *sb_value_ptr =
@@ -2269,9 +2294,11 @@ int ScriptInterpreterPython::GetIndexOfChildWithName(
 
   int ret_val = UINT32_MAX;
 
+  AcquireFormatterBatchLock();
   {
     Locker py_lock(this,
                    Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+    FormatterTimer timer(*this, GetImplementorClassName(implementor));
     ret_val = g_swig_get_index_child(implementor, child_name);
   }
 
@@ -2295,9 +2322,11 @@ bool ScriptInterpreterPython::UpdateSynthProviderInstance(
   if (!g_swig_update_provider)
     return ret_val;
 
+  AcquireFormatterBatchLock();
   {
     Locker py_lock(this,
                    Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+    FormatterTimer timer(*this, GetImplementorClassName(implementor));
     ret_val = g_swig_update_provider(implementor);
   }
 
@@ -2321,9 +2350,11 @@ bool ScriptInterpreterPython::MightHaveChildrenSynthProviderInstance(
   if (!g_swig_mighthavechildren_provider)
     return ret_val;
 
+  AcquireFormatterBatchLock();
   {
     Locker py_lock(this,
                    Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+    FormatterTimer timer(*this, GetImplementorClassName(implementor));
     ret_val = g_swig_mighthavechildren_provider(implementor);
   }
 
@@ -2348,9 +2379,11 @@ lldb::ValueObjectSP ScriptInterpreterPython::GetSyntheticValue(
       !g_swig_get_valobj_sp_from_sbvalue)
     return ret_val;
 
+  AcquireFormatterBatchLock();
   {
     Locker py_lock(this,
                    Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+    FormatterTimer timer(*this, GetImplementorClassName(implementor));
     void *child_ptr = g_swig_getvalue_provider(implementor);
     if (child_ptr != nullptr && child_ptr != Py_None) {
       lldb::SBValue *sb_value_ptr =
@@ -3083,6 +3116,156 @@ ScriptInterpreterPython::AcquireInterpreterLock() {
   return py_lock;
 }
 
+void ScriptInterpreterPython::BeginFormatterBatch() {
+  std::lock_guard<std::mutex> guard(m_formatter_batch_mutex);
+  const std::thread::id current = std::this_thread::get_id();
+  // Only one thread can own the batch. Other threads keep taking the lock
+  // for each callback, exactly as if no batch was active.
+  if (m_formatter_batch_depth == 0)
+    m_formatter_batch_owner = current;
+  if (m_formatter_batch_owner == current)
+    ++m_formatter_batch_depth;
+}
+
+void ScriptInterpreterPython::EndFormatterBatch() {
+  std::unique_ptr<Locker> batch_lock;
+  PyThreadState *thread_state = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(m_formatter_batch_mutex);
+    if (m_formatter_batch_depth == 0 ||
+        m_formatter_batch_owner != std::this_thread::get_id())
+      return;
+    if (--m_formatter_batch_depth > 0)
+      return;
+    m_formatter_batch_owner = std::thread::id();
+    m_formatter_batch_session_lost = false;
+    batch_lock = std::move(m_formatter_batch_lock);
+    thread_state = m_formatter_batch_thread_state;
+    m_formatter_batch_thread_state = nullptr;
+  }
+  ReleaseFormatterBatchLock(std::move(batch_lock), thread_state);
+}
+
+void ScriptInterpreterPython::ReleaseFormatterBatchLock(
+    std::unique_ptr<Locker> batch_lock, PyThreadState *thread_state) {
+  if (!batch_lock)
+    return;
+  // Take back the GIL the batch lock was created with, then leave the
+  // session, if it is still ours, and release the GIL, outside of the batch
+  // mutex.
+  PyEval_RestoreThread(thread_state);
+  batch_lock.reset();
+}
+
+void ScriptInterpreterPython::AcquireFormatterBatchLock() {
+  std::unique_ptr<Locker> lost_lock;
+  PyThreadState *lost_thread_state = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(m_formatter_batch_mutex);
+    if (m_formatter_batch_depth == 0 ||
+        m_formatter_batch_owner != std::this_thread::get_id())
+      return;
+    if (m_formatter_batch_lock) {
+      if (!m_formatter_batch_session_lost)
+        return;
+      // Another thread ran Python in between and took the session over.
+      // Drop the old batch lock and enter the session again.
+      m_formatter_batch_session_lost = false;
+      lost_lock = std::move(m_formatter_batch_lock);
+      lost_thread_state = m_formatter_batch_thread_state;
+      m_formatter_batch_thread_state = nullptr;
+    }
+  }
+  ReleaseFormatterBatchLock(std::move(lost_lock), lost_thread_state);
+
+  // Only the owning thread ever creates or releases the batch lock, so it is
+  // safe to take the GIL without holding the batch mutex. The per-callback
+  // lockers nested inside this one find the session already entered by
+  // their thread, so they skip the expensive session setup and teardown.
+  std::unique_ptr<Locker> batch_lock(new Locker(
+      this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN,
+      Locker::FreeLock | Locker::TearDownSession));
+  // Publish the lock while still holding the GIL, so that any thread that
+  // gets the GIL next knows the session is a parked batch session.
+  {
+    std::lock_guard<std::mutex> guard(m_formatter_batch_mutex);
+    m_formatter_batch_lock = std::move(batch_lock);
+  }
+  // Don't hold the GIL between callbacks: printing reads target memory and
+  // may run C++ formatters or wait on other threads that run Python. The
+  // per-callback lockers take it back with PyGILState_Ensure, and give it
+  // up again when they are done.
+  PyThreadState *thread_state = PyEval_SaveThread();
+  std::lock_guard<std::mutex> guard(m_formatter_batch_mutex);
+  m_formatter_batch_thread_state = thread_state;
+}
+
+bool ScriptInterpreterPython::TakeOverFormatterBatchSession() {
+  // Called with the GIL held, by a thread about to enter the session.
+  const std::thread::id current = std::this_thread::get_id();
+  if (m_session_owner == current)
+    return false;
+  {
+    std::lock_guard<std::mutex> guard(m_formatter_batch_mutex);
+    // Only a batch session is parked without the GIL between the callbacks
+    // of its thread. Any other session stays shared, as before.
+    if (!m_formatter_batch_lock || m_formatter_batch_owner != m_session_owner)
+      return false;
+    m_formatter_batch_session_lost = true;
+  }
+  // The globals and sys.std* of the batch session are those of another
+  // thread: leave it, so that this thread enters a session of its own. The
+  // batch thread enters it again before its next callback.
+  LeaveSession();
+  return true;
+}
+
+ScriptInterpreterPython::FormatterTimer::FormatterTimer(
+    ScriptInterpreterPython &interpreter, llvm::StringRef name)
+    : m_interpreter(interpreter), m_name(name),
+      m_start(std::chrono::steady_clock::now()) {}
+
+ScriptInterpreterPython::FormatterTimer::~FormatterTimer() {
+  if (m_name.empty())
+    return;
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - m_start);
+  std::lock_guard<std::mutex> guard(m_interpreter.m_formatter_stats_mutex);
+  FormatterStatistics &stats = m_interpreter.m_formatter_stats[m_name];
+  ++stats.num_calls;
+  stats.total_time += elapsed;
+}
+
+void ScriptInterpreterPython::DumpFormatterStatistics(Stream &strm) {
+  std::vector<std::pair<std::string, FormatterStatistics>> sorted;
+  {
+    std::lock_guard<std::mutex> guard(m_formatter_stats_mutex);
+    for (const auto &entry : m_formatter_stats)
+      sorted.emplace_back(entry.getKey().str(), entry.getValue());
+  }
+  if (sorted.empty())
+    return;
+
+  llvm::sort(sorted.begin(), sorted.end(),
+             [](const std::pair<std::string, FormatterStatistics> &lhs,
+                const std::pair<std::string, FormatterStatistics> &rhs) {
+               return lhs.second.total_time > rhs.second.total_time;
+             });
+
+  strm.PutCString("Python formatters:\n");
+  for (const auto &entry : sorted) {
+    const double seconds =
+        std::chrono::duration<double>(entry.second.total_time).count();
+    strm.Printf("  %.9f sec (%" PRIu64 " calls) for %s\n", seconds,
+                entry.second.num_calls, entry.first.c_str());
+  }
+}
+
+void ScriptInterpreterPython::ClearFormatterStatistics() {
+  std::lock_guard<std::mutex> guard(m_formatter_stats_mutex);
+  m_formatter_stats.clear();
+}
+
 void ScriptInterpreterPython::InitializeInterpreter(
     SWIGInitCallback swig_init_callback,
     SWIGBreakpointCallbackFunction swig_breakpoint_callback,
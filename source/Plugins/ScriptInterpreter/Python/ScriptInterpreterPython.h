@@ -18,11 +18,16 @@
 
 // C Includes
 // C++ Includes
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 // Other libraries and framework includes
+#include "llvm/ADT/StringMap.h"
+
 // Project includes
 #include "PythonDataObjects.h"
 #include "lldb/Breakpoint/BreakpointOptions.h"
@@ -354,6 +359,14 @@ public:
 
   std::unique_ptr<ScriptInterpreterLocker> AcquireInterpreterLock() override;
 
+  void BeginFormatterBatch() override;
+
+  void EndFormatterBatch() override;
+
+  void DumpFormatterStatistics(Stream &strm) override;
+
+  void ClearFormatterStatistics() override;
+
   void CollectDataForBreakpointCommandCallback(
       std::vector<BreakpointOptions *> &bp_options_vec,
       CommandReturnObject &result) override;
@@ -508,6 +521,38 @@ protected:
 
   enum class AddLocation { Beginning, End };
 
+  struct FormatterStatistics {
+    uint64_t num_calls = 0;
+    std::chrono::nanoseconds total_time{0};
+  };
+
+  // Accounts the time spent in one scripted formatter callback.
+  class FormatterTimer {
+  public:
+    FormatterTimer(ScriptInterpreterPython &interpreter, llvm::StringRef name);
+
+    ~FormatterTimer();
+
+  private:
+    ScriptInterpreterPython &m_interpreter;
+    llvm::StringRef m_name;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  // If the calling thread owns the active formatter batch, enter the
+  // session on its behalf and keep it until the batch ends, or until another
+  // thread takes it over. The GIL is released again right away, each
+  // callback takes it for its own duration.
+  void AcquireFormatterBatchLock();
+
+  void ReleaseFormatterBatchLock(std::unique_ptr<Locker> batch_lock,
+                                 PyThreadState *thread_state);
+
+  // If the session is the parked formatter batch session of another thread,
+  // leave it so that the calling thread can enter its own. Returns true if
+  // it did.
+  bool TakeOverFormatterBatchSession();
+
   static void AddToSysPath(AddLocation location, std::string path);
 
   static void ComputePythonDirForApple(llvm::SmallVectorImpl<char> &path);
@@ -562,10 +607,19 @@ protected:
   TerminalState m_terminal_state;
   ActiveIOHandler m_active_io_handler;
   bool m_session_is_active;
+  std::thread::id m_session_owner; // the thread that entered the session
   bool m_pty_slave_is_open;
   bool m_valid_session;
   uint32_t m_lock_count;
   PyThreadState *m_command_thread_state;
+  std::mutex m_formatter_batch_mutex;
+  std::thread::id m_formatter_batch_owner;
+  uint32_t m_formatter_batch_depth;
+  std::unique_ptr<Locker> m_formatter_batch_lock;
+  PyThreadState *m_formatter_batch_thread_state;
+  bool m_formatter_batch_session_lost; // another thread took the session over
+  std::mutex m_formatter_stats_mutex;
+  llvm::StringMap<FormatterStatistics> m_formatter_stats;
 };
 
 } // namespace lldb_private
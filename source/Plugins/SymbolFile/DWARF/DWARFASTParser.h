@@ -15,7 +15,10 @@
 #include "lldb/Symbol/CompilerDecl.h"
 #include "lldb/Symbol/CompilerDeclContext.h"
 
+#include <vector>
+
 class DWARFDIE;
+class DWARFDebugInfoEntry;
 
 class DWARFASTParser {
 public:
@@ -45,6 +48,11 @@ public:
 
   virtual std::vector<DWARFDIE>
   GetDIEForDeclContext(lldb_private::CompilerDeclContext decl_context) = 0;
+
+  // Append the DIEs the parser keeps pointers to. Their units must not be
+  // freed while the parser is alive.
+  virtual void
+  CollectDIEPointers(std::vector<const DWARFDebugInfoEntry *> &dies) const {}
 };
 
 #endif // SymbolFileDWARF_DWARFASTParser_h_
@@ -62,6 +62,18 @@ DWARFASTParserClang::DWARFASTParserClang(ClangASTContext &ast)
 
 DWARFASTParserClang::~DWARFASTParserClang() {}
 
+void DWARFASTParserClang::CollectDIEPointers(
+    std::vector<const DWARFDebugInfoEntry *> &dies) const {
+  for (const auto &entry : m_die_to_decl)
+    dies.push_back(entry.first);
+  for (const auto &entry : m_decl_to_die)
+    dies.insert(dies.end(), entry.second.begin(), entry.second.end());
+  for (const auto &entry : m_die_to_decl_ctx)
+    dies.push_back(entry.first);
+  for (const auto &entry : m_decl_ctx_to_die)
+    dies.push_back(entry.second.GetDIE());
+}
+
 static AccessType DW_ACCESS_to_AccessType(uint32_t dwarf_accessibility) {
   switch (dwarf_accessibility) {
   case DW_ACCESS_public:
@@ -60,6 +60,9 @@ public:
   lldb_private::CompilerDeclContext
   GetDeclContextContainingUIDFromDWARF(const DWARFDIE &die) override;
 
+  void CollectDIEPointers(
+      std::vector<const DWARFDebugInfoEntry *> &dies) const override;
+
   lldb_private::ClangASTImporter &GetClangASTImporter();
 
 protected:
@@ -10,6 +10,7 @@
 #include "DWARFUnit.h"
 
 #include "lldb/Core/Module.h"
+#include "lldb/Core/ModuleList.h"
 #include "lldb/Host/StringConvert.h"
 #include "lldb/Symbol/CompileUnit.h"
 #include "lldb/Symbol/LineTable.h"
@@ -25,6 +26,9 @@
 #include "SymbolFileDWARFDebugMap.h"
 #include "SymbolFileDWARFDwo.h"
 
+#include <algorithm>
+#include <chrono>
+
 using namespace lldb;
 using namespace lldb_private;
 using namespace std;
@@ -157,6 +161,9 @@ DWARFUnit::ScopedExtractDIEs &DWARFUnit::ScopedExtractDIEs::operator=(
 void DWARFUnit::ExtractDIEsRWLocked() {
   llvm::sys::ScopedWriter first_die_lock(m_first_die_mutex);
 
+  const bool reparse = m_dies_freed;
+  const auto start_time = std::chrono::steady_clock::now();
+
   static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
   Timer scoped_timer(
       func_cat, "%8.8x: DWARFUnit::ExtractDIEsIfNeeded()", m_offset);
@@ -273,6 +280,17 @@ void DWARFUnit::ExtractDIEsRWLocked() {
     DWARFUnit *dwo_cu = m_dwo_symbol_file->GetCompileUnit();
     dwo_cu->ExtractDIEsIfNeeded();
   }
+
+  if (reparse) {
+    m_dies_freed = false;
+    ModuleList::DebugInfoEvictionStats &stats =
+        ModuleList::GetDebugInfoEvictionStats();
+    stats.num_reparses.fetch_add(1);
+    stats.reparse_nanos.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_time)
+            .count());
+  }
 }
 
 //--------------------------------------------------------------------------
@@ -403,6 +421,58 @@ void DWARFUnit::SetAddrBase(dw_addr_t addr_base,
   m_base_obj_offset = base_obj_offset;
 }
 
+size_t DWARFUnit::GetDIEMemoryUsage() const {
+  size_t size;
+  {
+    llvm::sys::ScopedReader lock(m_die_array_mutex);
+    size = m_die_array.capacity() * sizeof(DWARFDebugInfoEntry);
+  }
+  if (m_dwo_symbol_file)
+    size += m_dwo_symbol_file->GetCompileUnit()->GetDIEMemoryUsage();
+  return size;
+}
+
+static bool
+IsAnyDIEIn(const DWARFDebugInfoEntry::collection &die_array,
+           llvm::ArrayRef<const DWARFDebugInfoEntry *> sorted_dies) {
+  if (die_array.empty())
+    return false;
+  std::less<const DWARFDebugInfoEntry *> less;
+  const DWARFDebugInfoEntry *begin = die_array.data();
+  const DWARFDebugInfoEntry *end = begin + die_array.size();
+  auto pos = std::lower_bound(sorted_dies.begin(), sorted_dies.end(), begin,
+                              less);
+  return pos != sorted_dies.end() && less(*pos, end);
+}
+
+size_t DWARFUnit::FreeDIEsIfUnreferenced(
+    llvm::ArrayRef<const DWARFDebugInfoEntry *> sorted_dies) {
+  // Wait for the ScopedExtractDIEs instances to go away.
+  llvm::sys::ScopedWriter lock_scoped(m_die_array_scoped_mutex);
+  llvm::sys::ScopedWriter lock(m_die_array_mutex);
+  if (m_die_array.empty())
+    return 0;
+
+  DWARFUnit *dwo_cu =
+      m_dwo_symbol_file ? m_dwo_symbol_file->GetCompileUnit() : nullptr;
+  if (IsAnyDIEIn(m_die_array, sorted_dies) ||
+      (dwo_cu && IsAnyDIEIn(dwo_cu->m_die_array, sorted_dies)))
+    return 0;
+
+  size_t size = m_die_array.capacity() * sizeof(DWARFDebugInfoEntry);
+  if (dwo_cu)
+    size += dwo_cu->m_die_array.capacity() * sizeof(DWARFDebugInfoEntry);
+  ClearDIEsRWLocked();
+
+  // ExtractDIEsIfNeeded() has been called to keep the DIEs forever, which is
+  // undone now.
+  m_cancel_scopes = false;
+  m_dies_freed = true;
+  if (dwo_cu)
+    dwo_cu->m_cancel_scopes = false;
+  return size;
+}
+
 // It may be called only with m_die_array_mutex held R/W.
 void DWARFUnit::ClearDIEsRWLocked() {
   m_die_array.clear();
@@ -13,6 +13,7 @@
 #include "DWARFDIE.h"
 #include "DWARFDebugInfoEntry.h"
 #include "lldb/lldb-enumerations.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/RWMutex.h"
 #include <atomic>
 
@@ -56,6 +57,16 @@ public:
   };
   ScopedExtractDIEs ExtractDIEsScoped();
 
+  // The number of bytes used by the extracted DIEs of this unit and of its
+  // DWO unit.
+  size_t GetDIEMemoryUsage() const;
+
+  // Free the extracted DIEs of this unit and of its DWO unit, unless one of
+  // them is in \a sorted_dies, which must be sorted with std::less. They are
+  // extracted again when needed. Returns the number of bytes freed.
+  size_t FreeDIEsIfUnreferenced(
+      llvm::ArrayRef<const DWARFDebugInfoEntry *> sorted_dies);
+
   DWARFDIE LookupAddress(const dw_addr_t address);
   size_t AppendDIEsWithTag(const dw_tag_t tag,
                            DWARFDIECollection &matching_dies,
@@ -192,6 +203,9 @@ protected:
   // ScopedExtractDIEs instances should not call ClearDIEsRWLocked()
   // as someone called ExtractDIEsIfNeeded().
   std::atomic<bool> m_cancel_scopes;
+  // Set when FreeDIEsIfUnreferenced() freed the DIEs, so extracting them
+  // again can be counted. Protected by m_die_array_mutex.
+  bool m_dies_freed = false;
   // GetUnitDIEPtrOnly() needs to return pointer to the first DIE.
   // But the first element of m_die_array after ExtractUnitDIEIfNeeded()
   // would possibly move in memory after later ExtractDIEsIfNeeded().
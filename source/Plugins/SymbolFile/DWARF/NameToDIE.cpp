@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "NameToDIE.h"
+#include "lldb/Core/ModuleList.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Utility/ConstString.h"
 #include "lldb/Utility/RegularExpression.h"
@@ -36,7 +37,35 @@ size_t NameToDIE::Find(const ConstString &name, DIEArray &info_array) const {
 
 size_t NameToDIE::Find(const RegularExpression &regex,
                        DIEArray &info_array) const {
-  return m_map.GetValues(regex, info_array);
+  if (!ModuleList::GetGlobalModuleListProperties().GetEnableRegexIndex())
+    return m_map.GetValues(regex, info_array);
+
+  std::call_once(m_regex_index_once, [this] { BuildRegexIndex(); });
+  std::vector<uint32_t> candidates;
+  if (!m_regex_index.FindCandidates(regex, candidates))
+    return m_map.GetValues(regex, info_array);
+
+  const size_t initial_size = info_array.size();
+  const uint32_t size = m_map.GetSize();
+  for (uint32_t i : candidates) {
+    ConstString name = m_map.GetCStringAtIndexUnchecked(i);
+    if (!regex.Execute(name.GetStringRef()))
+      continue;
+    for (uint32_t j = i;
+         j < size && m_map.GetCStringAtIndexUnchecked(j) == name; ++j)
+      info_array.push_back(m_map.GetValueAtIndexUnchecked(j));
+  }
+  return info_array.size() - initial_size;
+}
+
+void NameToDIE::BuildRegexIndex() const {
+  const uint32_t size = m_map.GetSize();
+  for (uint32_t i = 0; i < size; ++i) {
+    ConstString name = m_map.GetCStringAtIndexUnchecked(i);
+    if (i == 0 || m_map.GetCStringAtIndexUnchecked(i - 1) != name)
+      m_regex_index.Insert(i, name.GetStringRef());
+  }
+  m_regex_index.Finalize();
 }
 
 size_t NameToDIE::FindAllEntriesForCompileUnit(dw_offset_t cu_offset,
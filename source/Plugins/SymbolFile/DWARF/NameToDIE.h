@@ -11,10 +11,12 @@
 #define SymbolFileDWARF_NameToDIE_h_
 
 #include <functional>
+#include <mutex>
 
 #include "DIERef.h"
 #include "lldb/Core/UniqueCStringMap.h"
 #include "lldb/Core/dwarf.h"
+#include "lldb/Utility/TrigramIndex.h"
 #include "lldb/lldb-defines.h"
 
 class SymbolFileDWARF;
@@ -48,7 +50,14 @@ public:
               &callback) const;
 
 protected:
+  // Build the trigram index used to speed up regular expression searches.
+  // Every run of entries with the same name is indexed once, under the
+  // position of its first entry.
+  void BuildRegexIndex() const;
+
   lldb_private::UniqueCStringMap<DIERef> m_map;
+  mutable std::once_flag m_regex_index_once;
+  mutable lldb_private::TrigramIndex m_regex_index;
 };
 
 #endif // SymbolFileDWARF_NameToDIE_h_
@@ -32,6 +32,7 @@
 #include "lldb/Host/FileSystem.h"
 #include "lldb/Host/Host.h"
 #include "lldb/Host/Symbols.h"
+#include "lldb/Host/TaskPool.h"
 
 #include "lldb/Interpreter/OptionValueFileSpecList.h"
 #include "lldb/Interpreter/OptionValueProperties.h"
@@ -1980,6 +1981,164 @@ void SymbolFileDWARF::PreloadSymbols() {
   m_index->Preload();
 }
 
+static uint64_t GetPrefetchKey(const DIERef &ref) {
+  return uint64_t(ref.cu_offset) << 32 | ref.die_offset;
+}
+
+// Append the DIEs that die and its children refer to as their types,
+// declarations or abstract origins to refs. This only reads DIEs that are
+// already extracted, so it can run on several threads at once.
+static void CollectReferencedDIEs(const DWARFDIE &die, DIEArray &refs) {
+  DWARFAttributes attributes;
+  const size_t num_attributes = die.GetAttributes(attributes);
+  for (size_t i = 0; i < num_attributes; ++i) {
+    switch (attributes.AttributeAtIndex(i)) {
+    case DW_AT_type:
+    case DW_AT_containing_type:
+    case DW_AT_specification:
+    case DW_AT_abstract_origin:
+    case DW_AT_import:
+      break;
+    default:
+      continue;
+    }
+    DWARFFormValue form_value;
+    if (!attributes.ExtractFormValueAtIndex(i, form_value) ||
+        form_value.Form() == DW_FORM_ref_sig8)
+      continue;
+    DIERef ref(form_value);
+    // The target of a DW_FORM_ref_addr may be in any unit.
+    if (form_value.Form() == DW_FORM_ref_addr)
+      ref.cu_offset = DW_INVALID_OFFSET;
+    if (ref.die_offset != DW_INVALID_OFFSET)
+      refs.push_back(ref);
+  }
+
+  for (DWARFDIE child = die.GetFirstChild(); child;
+       child = child.GetSibling())
+    CollectReferencedDIEs(child, refs);
+}
+
+void SymbolFileDWARF::PrefetchTypes(llvm::ArrayRef<ConstString> names) {
+  std::lock_guard<std::recursive_mutex> guard(
+      GetObjectFile()->GetModule()->GetMutex());
+  DWARFDebugInfo *info = DebugInfo();
+  if (!info || names.empty())
+    return;
+
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, "%s (%zu names)", LLVM_PRETTY_FUNCTION,
+                     names.size());
+
+  DIEArray roots;
+  for (ConstString name : names)
+    m_index->GetTypes(name, roots);
+
+  // Parsing a type reads the DIEs of its members, bases and template
+  // arguments, and those of their types in turn. Most of that time goes to
+  // extracting the DIEs of the units involved. Do that a few levels deep on
+  // the task pool, with each task collecting references into its own list.
+  // ExtractDIEsIfNeeded() is thread safe, and once it is done the DIEs are
+  // only read.
+  const int kMaxDepth = 3;
+  const size_t kMaxDIEs = 4096;
+  size_t num_new = 0;
+  DIEArray pending;
+  for (const DIERef &ref : roots) {
+    if (m_prefetched_dies.insert(GetPrefetchKey(ref)).second) {
+      pending.push_back(ref);
+      ++num_new;
+    }
+  }
+
+  // Parse the unit headers before the units are used from several threads.
+  info->GetNumCompileUnits();
+  for (int depth = 0; depth < kMaxDepth && !pending.empty(); ++depth) {
+    std::vector<DWARFUnit *> units;
+    for (const DIERef &ref : pending)
+      if (DWARFUnit *cu = info->GetCompileUnit(ref))
+        units.push_back(cu);
+    std::sort(units.begin(), units.end());
+    units.erase(std::unique(units.begin(), units.end()), units.end());
+    TaskMapOverInt(0, units.size(),
+                   [&units](size_t idx) { units[idx]->ExtractDIEsIfNeeded(); });
+
+    std::mutex next_mutex;
+    DIEArray next;
+    TaskMapOverInt(0, pending.size(), [&](size_t idx) {
+      DIEArray refs;
+      if (DWARFDIE die = info->GetDIE(pending[idx]))
+        CollectReferencedDIEs(die, refs);
+      std::lock_guard<std::mutex> lock(next_mutex);
+      for (const DIERef &ref : refs) {
+        if (num_new < kMaxDIEs &&
+            m_prefetched_dies.insert(GetPrefetchKey(ref)).second) {
+          next.push_back(ref);
+          ++num_new;
+        }
+      }
+    });
+    pending.swap(next);
+  }
+
+  // Create the types for the names themselves, as FindTypes() would. The
+  // type system is not thread safe, so this is done here, serially.
+  for (const DIERef &ref : roots) {
+    if (DWARFDIE die = info->GetDIE(ref))
+      ResolveType(die, true, true);
+  }
+
+  Log *log(LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS));
+  LLDB_LOG(log, "{0} names matched {1} type DIEs, read {2} new DIEs",
+           names.size(), roots.size(), num_new);
+}
+
+size_t SymbolFileDWARF::GetParsedDataSize() {
+  if (!m_info || GetDebugMapSymfile())
+    return 0;
+  size_t size = 0;
+  const size_t num_units = m_info->GetNumCompileUnits();
+  for (size_t i = 0; i < num_units; ++i)
+    size += m_info->GetCompileUnitAtIndex(i)->GetDIEMemoryUsage();
+  return size;
+}
+
+size_t SymbolFileDWARF::FreeParsedData() {
+  // Only the extracted DIEs are freed. Types, variables and line tables
+  // refer to each other and to the AST, and callers hold on to them.
+  if (!m_info || GetDebugMapSymfile())
+    return 0;
+
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, "SymbolFileDWARF::FreeParsedData() for %s",
+                     GetObjectFile()->GetFileSpec().GetPath().c_str());
+
+  // Units whose DIEs are pointed to from the maps below have to stay.
+  std::vector<const DWARFDebugInfoEntry *> dies;
+  for (const auto &entry : GetDIEToType())
+    dies.push_back(entry.first);
+  for (const auto &entry : GetDIEToVariable())
+    dies.push_back(entry.first);
+  for (const auto &entry : GetForwardDeclDieToClangType())
+    dies.push_back(entry.first);
+  GetUniqueDWARFASTTypeMap().CollectDIEPointers(dies);
+  GetObjectFile()->GetModule()->ForEachTypeSystem([&](TypeSystem *ts) {
+    if (DWARFASTParser *parser = ts->GetDWARFParser())
+      parser->CollectDIEPointers(dies);
+    return true;
+  });
+  std::sort(dies.begin(), dies.end(),
+            std::less<const DWARFDebugInfoEntry *>());
+
+  size_t freed = 0;
+  const size_t num_units = m_info->GetNumCompileUnits();
+  for (size_t i = 0; i < num_units; ++i)
+    freed += m_info->GetCompileUnitAtIndex(i)->FreeDIEsIfUnreferenced(dies);
+  if (freed)
+    m_prefetched_dies.clear();
+  return freed;
+}
+
 bool SymbolFileDWARF::DeclContextMatchesThisSymbolFile(
     const lldb_private::CompilerDeclContext *decl_ctx) {
   if (decl_ctx == nullptr || !decl_ctx->IsValid()) {
@@ -21,6 +21,7 @@
 
 // Other libraries and framework includes
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/Support/Threading.h"
 
 #include "lldb/Utility/Flags.h"
@@ -227,6 +228,12 @@ public:
 
   void PreloadSymbols() override;
 
+  void PrefetchTypes(llvm::ArrayRef<lldb_private::ConstString> names) override;
+
+  size_t GetParsedDataSize() override;
+
+  size_t FreeParsedData() override;
+
   //------------------------------------------------------------------
   // PluginInterface protocol
   //------------------------------------------------------------------
@@ -492,6 +499,9 @@ protected:
 
   ExternalTypeModuleMap m_external_type_modules;
   std::unique_ptr<lldb_private::DWARFIndex> m_index;
+  // DIEs whose references PrefetchTypes() has already followed, as
+  // (cu_offset << 32 | die_offset).
+  llvm::DenseSet<uint64_t> m_prefetched_dies;
   bool m_fetched_external_modules : 1;
   lldb_private::LazyBool m_supports_DW_AT_APPLE_objc_complete_type;
 
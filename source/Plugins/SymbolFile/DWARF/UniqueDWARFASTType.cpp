@@ -76,3 +76,9 @@ bool UniqueDWARFASTTypeList::Find(const DWARFDIE &die,
   }
   return false;
 }
+
+void UniqueDWARFASTTypeList::CollectDIEPointers(
+    std::vector<const DWARFDebugInfoEntry *> &dies) const {
+  for (const UniqueDWARFASTType &udt : m_collection)
+    dies.push_back(udt.m_die.GetDIE());
+}
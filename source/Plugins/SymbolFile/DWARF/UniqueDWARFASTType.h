@@ -74,6 +74,8 @@ public:
   bool Find(const DWARFDIE &die, const lldb_private::Declaration &decl,
             const int32_t byte_size, UniqueDWARFASTType &entry) const;
 
+  void CollectDIEPointers(std::vector<const DWARFDebugInfoEntry *> &dies) const;
+
 protected:
   typedef std::vector<UniqueDWARFASTType> collection;
   collection m_collection;
@@ -101,6 +103,12 @@ public:
     return false;
   }
 
+  void
+  CollectDIEPointers(std::vector<const DWARFDebugInfoEntry *> &dies) const {
+    for (const auto &entry : m_collection)
+      entry.second.CollectDIEPointers(dies);
+  }
+
 protected:
   // A unique name string should be used
   typedef llvm::DenseMap<const char *, UniqueDWARFASTTypeList> collection;
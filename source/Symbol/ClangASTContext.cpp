@@ -9653,6 +9653,13 @@ DWARFASTParser *ClangASTContext::GetDWARFParser() {
   return m_dwarf_ast_parser_ap.get();
 }
 
+size_t ClangASTContext::MemorySize() {
+  if (!m_ast_ap)
+    return 0;
+  return m_ast_ap->getASTAllocatedMemory() +
+         m_ast_ap->getSideTableAllocatedMemory();
+}
+
 PDBASTParser *ClangASTContext::GetPDBParser() {
   if (!m_pdb_ast_parser_ap)
     m_pdb_ast_parser_ap.reset(new PDBASTParser(*this));
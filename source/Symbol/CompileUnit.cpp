@@ -207,6 +207,10 @@ LineTable *CompileUnit::GetLineTable() {
   return m_line_table_ap.get();
 }
 
+size_t CompileUnit::GetLineTableMemorySize() const {
+  return m_line_table_ap ? m_line_table_ap->MemorySize() : 0;
+}
+
 void CompileUnit::SetLineTable(LineTable *line_table) {
   if (line_table == nullptr)
     m_flags.Clear(flagsParsedLineTable);
@@ -18,8 +18,12 @@
 #include "lldb/Symbol/Symtab.h"
 #include "lldb/Target/Process.h"
 #include "lldb/Target/Target.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/Stream.h"
 
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/raw_ostream.h"
+
 using namespace lldb;
 using namespace lldb_private;
 
@@ -564,3 +568,77 @@ bool Symbol::GetDisassembly(const ExecutionContext &exe_ctx, const char *flavor,
 bool Symbol::ContainsFileAddress(lldb::addr_t file_addr) const {
   return m_addr_range.ContainsFileAddress(file_addr);
 }
+
+template <typename T> static void Write(llvm::raw_ostream &os, T value) {
+  uint8_t bytes[sizeof(T)];
+  llvm::support::endian::write<T, llvm::support::little,
+                               llvm::support::unaligned>(bytes, value);
+  os.write(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+}
+
+void Symbol::Encode(
+    llvm::raw_ostream &os,
+    llvm::function_ref<uint32_t(const ConstString &)> add_string) const {
+  const uint16_t bits = m_type_data_resolved | m_is_synthetic << 1 |
+                        m_is_debug << 2 | m_is_external << 3 |
+                        m_size_is_sibling << 4 | m_size_is_synthesized << 5 |
+                        m_size_is_valid << 6 |
+                        m_demangled_is_synthesized << 7 |
+                        m_contains_linker_annotations << 8 | m_type << 9;
+  const Address &base = m_addr_range.GetBaseAddress();
+  const SectionSP section_sp = base.GetSection();
+  Write<uint32_t>(os, m_uid);
+  Write<uint16_t>(os, m_type_data);
+  Write<uint16_t>(os, bits);
+  Write<uint32_t>(os, add_string(m_mangled.GetMangledName()));
+  // Only what the name indexes demangled is saved. The rest is demangled on
+  // demand after loading, as it would have been without the cache.
+  Write<uint32_t>(os, add_string(m_mangled.GetDemangledNameIfComputed()));
+  Write<uint64_t>(os, section_sp ? section_sp->GetID() : LLDB_INVALID_UID);
+  Write<uint64_t>(os, base.GetOffset());
+  Write<uint64_t>(os, m_addr_range.GetByteSize());
+  Write<uint32_t>(os, m_flags);
+}
+
+bool Symbol::Decode(
+    const DataExtractor &data, lldb::offset_t *offset_ptr,
+    llvm::function_ref<SectionSP(lldb::user_id_t)> find_section,
+    llvm::function_ref<bool(uint32_t, ConstString &)> get_string) {
+  if (!data.ValidOffsetForDataOfSize(*offset_ptr, kEncodedSize))
+    return false;
+  m_uid = data.GetU32(offset_ptr);
+  m_type_data = data.GetU16(offset_ptr);
+  const uint16_t bits = data.GetU16(offset_ptr);
+  m_type_data_resolved = bits & 1;
+  m_is_synthetic = (bits >> 1) & 1;
+  m_is_debug = (bits >> 2) & 1;
+  m_is_external = (bits >> 3) & 1;
+  m_size_is_sibling = (bits >> 4) & 1;
+  m_size_is_synthesized = (bits >> 5) & 1;
+  m_size_is_valid = (bits >> 6) & 1;
+  m_demangled_is_synthesized = (bits >> 7) & 1;
+  m_contains_linker_annotations = (bits >> 8) & 1;
+  m_type = bits >> 9;
+
+  ConstString mangled, demangled;
+  if (!get_string(data.GetU32(offset_ptr), mangled) ||
+      !get_string(data.GetU32(offset_ptr), demangled))
+    return false;
+  m_mangled.SetMangledName(mangled);
+  m_mangled.SetDemangledName(demangled);
+
+  const lldb::user_id_t section_id = data.GetU64(offset_ptr);
+  const lldb::addr_t offset = data.GetU64(offset_ptr);
+  if (section_id == LLDB_INVALID_UID) {
+    m_addr_range.GetBaseAddress().SetRawAddress(offset);
+  } else {
+    SectionSP section_sp = find_section(section_id);
+    if (!section_sp)
+      return false;
+    m_addr_range.GetBaseAddress().SetSection(section_sp);
+    m_addr_range.GetBaseAddress().SetOffset(offset);
+  }
+  m_addr_range.SetByteSize(data.GetU64(offset_ptr));
+  m_flags = data.GetU32(offset_ptr);
+  return true;
+}
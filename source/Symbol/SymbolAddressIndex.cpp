@@ -0,0 +1,162 @@
+//===-- SymbolAddressIndex.cpp ----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Symbol/SymbolAddressIndex.h"
+#include "lldb/lldb-defines.h"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace lldb;
+using namespace lldb_private;
+
+constexpr uint32_t SymbolAddressIndex::kLarge;
+
+void SymbolAddressIndex::Clear() {
+  m_bases.clear();
+  m_sizes.clear();
+  m_symbol_indexes.clear();
+  m_reaches.clear();
+  m_large_sizes.clear();
+}
+
+void SymbolAddressIndex::Append(addr_t base, addr_t size,
+                                uint32_t symbol_idx) {
+  m_bases.push_back(base);
+  m_sizes.push_back(0);
+  m_symbol_indexes.push_back(symbol_idx);
+  SetByteSizeAtIndex(m_bases.size() - 1, size);
+}
+
+addr_t SymbolAddressIndex::GetByteSizeAtIndex(size_t i) const {
+  const uint32_t size = m_sizes[i];
+  if (size != kLarge)
+    return size;
+  auto pos = m_large_sizes.find(i);
+  return pos == m_large_sizes.end() ? size : pos->second;
+}
+
+void SymbolAddressIndex::SetByteSizeAtIndex(size_t i, addr_t size) {
+  if (size < kLarge) {
+    if (m_sizes[i] == kLarge)
+      m_large_sizes.erase(i);
+    m_sizes[i] = size;
+  } else {
+    m_sizes[i] = kLarge;
+    m_large_sizes[i] = size;
+  }
+}
+
+void SymbolAddressIndex::Sort() {
+  const size_t num_entries = m_bases.size();
+  std::vector<uint32_t> order(num_entries);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](uint32_t lhs,
+                                                      uint32_t rhs) {
+    if (m_bases[lhs] != m_bases[rhs])
+      return m_bases[lhs] < m_bases[rhs];
+    const addr_t lhs_size = GetByteSizeAtIndex(lhs);
+    const addr_t rhs_size = GetByteSizeAtIndex(rhs);
+    if (lhs_size != rhs_size)
+      return lhs_size < rhs_size;
+    return m_symbol_indexes[lhs] < m_symbol_indexes[rhs];
+  });
+
+  std::vector<addr_t> bases(num_entries);
+  std::vector<uint32_t> sizes(num_entries);
+  std::vector<uint32_t> symbol_indexes(num_entries);
+  llvm::DenseMap<uint32_t, addr_t> large_sizes;
+  for (size_t i = 0; i < num_entries; ++i) {
+    const uint32_t from = order[i];
+    bases[i] = m_bases[from];
+    sizes[i] = m_sizes[from];
+    symbol_indexes[i] = m_symbol_indexes[from];
+    if (sizes[i] == kLarge)
+      large_sizes[i] = m_large_sizes.lookup(from);
+  }
+  m_bases.swap(bases);
+  m_sizes.swap(sizes);
+  m_symbol_indexes.swap(symbol_indexes);
+  m_large_sizes.swap(large_sizes);
+  ComputeReaches();
+}
+
+void SymbolAddressIndex::ComputeReaches() {
+  const size_t num_entries = m_bases.size();
+  m_reaches.resize(num_entries);
+  addr_t max_end = 0;
+  for (size_t i = 0; i < num_entries; ++i) {
+    const addr_t base = m_bases[i];
+    const addr_t size = GetByteSizeAtIndex(i);
+    const addr_t end = size > LLDB_INVALID_ADDRESS - base
+                           ? LLDB_INVALID_ADDRESS
+                           : base + size;
+    max_end = std::max(max_end, end);
+    m_reaches[i] = std::min<addr_t>(max_end - base, kLarge);
+  }
+}
+
+template <typename F>
+void SymbolAddressIndex::ForEachContainingEntry(addr_t addr,
+                                                F callback) const {
+  // Entries after the last one starting at or before addr can't contain it.
+  size_t i = std::upper_bound(m_bases.begin(), m_bases.end(), addr) -
+             m_bases.begin();
+  while (i-- > 0) {
+    // Neither this entry nor any before it reaches addr.
+    if (m_reaches[i] != kLarge && addr - m_bases[i] >= m_reaches[i])
+      return;
+    if (Contains(i, addr) && !callback(i))
+      return;
+  }
+}
+
+uint32_t SymbolAddressIndex::FindSymbolIndexStartingAt(addr_t addr) const {
+  auto pos = std::lower_bound(m_bases.begin(), m_bases.end(), addr);
+  if (pos == m_bases.end() || *pos != addr)
+    return UINT32_MAX;
+  return m_symbol_indexes[pos - m_bases.begin()];
+}
+
+uint32_t SymbolAddressIndex::FindSymbolIndexContaining(addr_t addr) const {
+  // Entries are visited backwards, so the last one visited is the first.
+  uint32_t symbol_idx = UINT32_MAX;
+  ForEachContainingEntry(addr, [this, &symbol_idx](size_t i) {
+    symbol_idx = m_symbol_indexes[i];
+    return true;
+  });
+  return symbol_idx;
+}
+
+size_t SymbolAddressIndex::FindSymbolIndexesContaining(
+    addr_t addr, std::vector<uint32_t> &symbol_indexes) const {
+  const size_t old_size = symbol_indexes.size();
+  ForEachContainingEntry(addr, [this, &symbol_indexes](size_t i) {
+    symbol_indexes.push_back(m_symbol_indexes[i]);
+    return true;
+  });
+  std::reverse(symbol_indexes.begin() + old_size, symbol_indexes.end());
+  return symbol_indexes.size() - old_size;
+}
+
+void SymbolAddressIndex::SizeToFit() {
+  m_bases.shrink_to_fit();
+  m_sizes.shrink_to_fit();
+  m_symbol_indexes.shrink_to_fit();
+  m_reaches.shrink_to_fit();
+}
+
+size_t SymbolAddressIndex::MemorySize() const {
+  return sizeof(SymbolAddressIndex) +
+         m_bases.capacity() * sizeof(addr_t) +
+         (m_sizes.capacity() + m_symbol_indexes.capacity() +
+          m_reaches.capacity()) *
+             sizeof(uint32_t) +
+         m_large_sizes.getMemorySize();
+}
@@ -105,6 +105,18 @@ bool SymbolVendor::SetCompileUnitAtIndex(size_t idx, const CompUnitSP &cu_sp) {
   return false;
 }
 
+size_t SymbolVendor::GetLineTablesMemorySize() {
+  ModuleSP module_sp(GetModule());
+  if (!module_sp)
+    return 0;
+  std::lock_guard<std::recursive_mutex> guard(module_sp->GetMutex());
+  size_t size = 0;
+  for (const CompUnitSP &cu_sp : m_compile_units)
+    if (cu_sp)
+      size += cu_sp->GetLineTableMemorySize();
+  return size;
+}
+
 size_t SymbolVendor::GetNumCompileUnits() {
   ModuleSP module_sp(GetModule());
   if (module_sp) {
@@ -13,15 +13,25 @@
 #include "Plugins/Language/CPlusPlus/CPlusPlusLanguage.h"
 #include "Plugins/Language/ObjC/ObjCLanguage.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Core/ModuleList.h"
 #include "lldb/Core/STLUtils.h"
 #include "lldb/Core/Section.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Symbol/Symbol.h"
 #include "lldb/Symbol/SymbolContext.h"
 #include "lldb/Symbol/Symtab.h"
+#include "lldb/Utility/DataBufferLLVM.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/RegularExpression.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/Timer.h"
+#include "lldb/Utility/TrigramIndex.h"
+
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/DJB.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace lldb;
 using namespace lldb_private;
@@ -43,6 +53,7 @@ Symbol *Symtab::Resize(size_t count) {
   // Clients should grab the mutex from this symbol table and lock it manually
   // when calling this function to avoid performance issues.
   m_symbols.resize(count);
+  m_regex_index.reset();
   return m_symbols.empty() ? nullptr : &m_symbols[0];
 }
 
@@ -53,6 +64,7 @@ uint32_t Symtab::AddSymbol(const Symbol &symbol) {
   m_name_to_index.Clear();
   m_file_addr_to_index.Clear();
   m_symbols.push_back(symbol);
+  m_regex_index.reset();
   m_file_addr_to_index_computed = false;
   m_name_indexes_computed = false;
   return symbol_idx;
@@ -63,6 +75,23 @@ size_t Symtab::GetNumSymbols() const {
   return m_symbols.size();
 }
 
+size_t Symtab::GetSymbolsMemorySize() const {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  return m_symbols.capacity() * sizeof(Symbol);
+}
+
+size_t Symtab::GetIndexesMemorySize() const {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  size_t size = m_file_addr_to_index.MemorySize() +
+                m_name_to_index.MemorySize() +
+                m_basename_to_index.MemorySize() +
+                m_method_to_index.MemorySize() +
+                m_selector_to_index.MemorySize();
+  if (m_regex_index)
+    size += m_regex_index->GetMemoryUsage();
+  return size;
+}
+
 void Symtab::SectionFileAddressesChanged() {
   m_name_to_index.Clear();
   m_file_addr_to_index_computed = false;
@@ -131,7 +160,8 @@ void Symtab::Dump(Stream *s, Target *target, SortOrder sort_order) {
       const size_t num_entries = m_file_addr_to_index.GetSize();
       for (size_t i = 0; i < num_entries; ++i) {
         s->Indent();
-        const uint32_t symbol_idx = m_file_addr_to_index.GetEntryRef(i).data;
+        const uint32_t symbol_idx =
+            m_file_addr_to_index.GetSymbolIndexAtIndex(i);
         m_symbols[symbol_idx].Dump(s, target, symbol_idx);
       }
       break;
@@ -674,9 +704,8 @@ uint32_t Symtab::AppendSymbolIndexesMatchingRegExAndType(
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
 
   uint32_t prev_size = indexes.size();
-  uint32_t sym_end = m_symbols.size();
 
-  for (uint32_t i = 0; i < sym_end; i++) {
+  ForEachRegexCandidate(regexp, [&](uint32_t i) {
     if (symbol_type == eSymbolTypeAny ||
         m_symbols[i].GetType() == symbol_type) {
       const char *name = m_symbols[i].GetName().AsCString();
@@ -685,7 +714,7 @@ uint32_t Symtab::AppendSymbolIndexesMatchingRegExAndType(
           indexes.push_back(i);
       }
     }
-  }
+  });
   return indexes.size() - prev_size;
 }
 
@@ -696,13 +725,12 @@ uint32_t Symtab::AppendSymbolIndexesMatchingRegExAndType(
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
 
   uint32_t prev_size = indexes.size();
-  uint32_t sym_end = m_symbols.size();
 
-  for (uint32_t i = 0; i < sym_end; i++) {
+  ForEachRegexCandidate(regexp, [&](uint32_t i) {
     if (symbol_type == eSymbolTypeAny ||
         m_symbols[i].GetType() == symbol_type) {
       if (CheckSymbolAtIndex(i, symbol_debug_type, symbol_visibility) == false)
-        continue;
+        return;
 
       const char *name = m_symbols[i].GetName().AsCString();
       if (name) {
@@ -710,10 +738,450 @@ uint32_t Symtab::AppendSymbolIndexesMatchingRegExAndType(
           indexes.push_back(i);
       }
     }
-  }
+  });
   return indexes.size() - prev_size;
 }
 
+//----------------------------------------------------------------------
+// Index cache
+//
+// Cached files start with a small header that ties them to the symbol
+// table they were built from. The UUID (and the object file name, as a
+// module and its symbol file share a UUID) names the file. A UUID doesn't
+// always change when a module is rebuilt, so each kind of file also records
+// what it was built from and checks it on load.
+//----------------------------------------------------------------------
+static FileSpec GetIndexCacheFile(ObjectFile *objfile,
+                                  llvm::StringRef extension) {
+  FileSpec cache_dir =
+      ModuleList::GetGlobalModuleListProperties().GetIndexCachePath();
+  if (!cache_dir || !objfile)
+    return FileSpec();
+  ModuleSP module_sp = objfile->GetModule();
+  if (!module_sp || !module_sp->GetUUID().IsValid())
+    return FileSpec();
+  std::string name = module_sp->GetUUID().GetAsString("") + "-" +
+                     objfile->GetFileSpec().GetFilename().GetStringRef().str() +
+                     extension.str();
+  cache_dir.AppendPathComponent(name);
+  return cache_dir;
+}
+
+static bool CheckIndexCacheHeader(const DataExtractor &data,
+                                  lldb::offset_t *offset_ptr,
+                                  const char (&magic)[8], uint32_t version) {
+  const void *data_magic = data.GetData(offset_ptr, sizeof(magic));
+  return data_magic && memcmp(data_magic, magic, sizeof(magic)) == 0 &&
+         data.GetU32(offset_ptr) == version;
+}
+
+template <typename T> static void Write(llvm::raw_ostream &os, T value) {
+  uint8_t bytes[sizeof(T)];
+  llvm::support::endian::write<T, llvm::support::little,
+                               llvm::support::unaligned>(bytes, value);
+  os.write(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+}
+
+static void WriteIndexCacheFile(
+    const FileSpec &file, const char (&magic)[8], uint32_t version,
+    llvm::function_ref<void(llvm::raw_ostream &)> write_contents) {
+  // Write a private file and move it into place, so that concurrent
+  // debuggers never see a partial file.
+  if (llvm::sys::fs::create_directories(file.GetDirectory().GetStringRef()))
+    return;
+  int fd;
+  llvm::SmallString<128> temp_path;
+  if (llvm::sys::fs::createUniqueFile(file.GetPath() + "-%%%%%%", fd,
+                                      temp_path))
+    return;
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os.write(magic, sizeof(magic));
+    Write<uint32_t>(os, version);
+    write_contents(os);
+    os.close();
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(temp_path);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(temp_path, file.GetPath()))
+    llvm::sys::fs::remove(temp_path);
+}
+
+//----------------------------------------------------------------------
+// Regular expression index
+//
+// The header is followed by the generation of the symbol table the index
+// was built from and the encoded TrigramIndex. The UUID alone doesn't pin
+// down the symbols: a module can be rebuilt without changing it, and lldb
+// adds synthetic symbols to some symbol tables.
+//----------------------------------------------------------------------
+static const char g_regex_index_magic[8] = {'L', 'L', 'D', 'B', 'T', 'R', 'I',
+                                            'G'};
+static const uint32_t g_regex_index_version = 2;
+
+namespace {
+struct SymtabGeneration {
+  uint32_t num_symbols;
+  uint32_t names_hash;
+  int64_t mod_time;
+
+  bool operator==(const SymtabGeneration &rhs) const {
+    return num_symbols == rhs.num_symbols && names_hash == rhs.names_hash &&
+           mod_time == rhs.mod_time;
+  }
+};
+} // namespace
+
+static SymtabGeneration GetSymtabGeneration(ObjectFile *objfile,
+                                            llvm::ArrayRef<Symbol> symbols) {
+  SymtabGeneration generation = {0, 0, 0};
+  generation.num_symbols = symbols.size();
+  generation.names_hash = 0;
+  for (const Symbol &symbol : symbols)
+    generation.names_hash =
+        llvm::djbHash(symbol.GetName().GetStringRef(), generation.names_hash);
+  generation.mod_time = 0;
+  if (ModuleSP module_sp = objfile->GetModule())
+    generation.mod_time =
+        llvm::sys::toTimeT(module_sp->GetObjectModificationTime());
+  return generation;
+}
+
+static bool LoadRegexIndex(const FileSpec &file,
+                           const SymtabGeneration &generation,
+                           TrigramIndex &index) {
+  auto data_sp = DataBufferLLVM::CreateFromPath(file.GetPath());
+  if (!data_sp)
+    return false;
+  DataExtractor data(data_sp, eByteOrderLittle, 8);
+  lldb::offset_t offset = 0;
+  if (!CheckIndexCacheHeader(data, &offset, g_regex_index_magic,
+                             g_regex_index_version))
+    return false;
+  SymtabGeneration cached;
+  cached.num_symbols = data.GetU32(&offset);
+  cached.names_hash = data.GetU32(&offset);
+  cached.mod_time = data.GetU64(&offset);
+  if (!(cached == generation))
+    return false;
+  return index.Decode(data, &offset);
+}
+
+static void SaveRegexIndex(const FileSpec &file,
+                           const SymtabGeneration &generation,
+                           const TrigramIndex &index) {
+  WriteIndexCacheFile(file, g_regex_index_magic, g_regex_index_version,
+                      [&](llvm::raw_ostream &os) {
+                        Write<uint32_t>(os, generation.num_symbols);
+                        Write<uint32_t>(os, generation.names_hash);
+                        Write<int64_t>(os, generation.mod_time);
+                        index.Encode(os);
+                      });
+}
+
+const TrigramIndex *Symtab::GetRegexIndex() {
+  if (!ModuleList::GetGlobalModuleListProperties().GetEnableRegexIndex())
+    return nullptr;
+  if (m_regex_index)
+    return m_regex_index.get();
+
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, "%s", LLVM_PRETTY_FUNCTION);
+  m_regex_index.reset(new TrigramIndex());
+  const FileSpec cache_file = GetIndexCacheFile(m_objfile, ".regex-index");
+  SymtabGeneration generation = {0, 0, 0};
+  if (cache_file) {
+    generation = GetSymtabGeneration(m_objfile, m_symbols);
+    if (LoadRegexIndex(cache_file, generation, *m_regex_index))
+      return m_regex_index.get();
+  }
+
+  const uint32_t num_symbols = m_symbols.size();
+  for (uint32_t i = 0; i < num_symbols; ++i)
+    m_regex_index->Insert(i, m_symbols[i].GetName().GetStringRef());
+  m_regex_index->Finalize();
+  if (cache_file)
+    SaveRegexIndex(cache_file, generation, *m_regex_index);
+  return m_regex_index.get();
+}
+
+void Symtab::ForEachRegexCandidate(
+    const RegularExpression &regexp,
+    llvm::function_ref<void(uint32_t)> callback) {
+  std::vector<uint32_t> candidates;
+  const TrigramIndex *index = GetRegexIndex();
+  if (index && index->FindCandidates(regexp, candidates)) {
+    for (uint32_t i : candidates)
+      callback(i);
+    return;
+  }
+  const uint32_t sym_end = m_symbols.size();
+  for (uint32_t i = 0; i < sym_end; i++)
+    callback(i);
+}
+
+//----------------------------------------------------------------------
+// Symbol table snapshot
+//
+// The header is followed by the modification time and size of the object
+// file, the number of symbols, a string table and fixed size symbol records,
+// so loading a snapshot is a pass over a mapped file. The name and address
+// indexes follow as (string, symbol index) and (address, size, symbol index)
+// entries. Names are offsets into the string table; offset zero is the
+// empty name. The object file is checked because a module rebuilt without a
+// build-id can keep its UUID, and a UUID derived from a CRC can collide.
+//----------------------------------------------------------------------
+static const char g_symtab_cache_magic[8] = {'L', 'L', 'D', 'B', 'S', 'Y', 'M',
+                                             'T'};
+static const uint32_t g_symtab_cache_version = 2;
+
+namespace {
+struct ObjectFileStamp {
+  int64_t mod_time; // nanoseconds since the epoch
+  uint64_t size;
+
+  bool operator==(const ObjectFileStamp &rhs) const {
+    return mod_time == rhs.mod_time && size == rhs.size;
+  }
+};
+
+class StringTableWriter {
+public:
+  StringTableWriter() : m_data(1, '\0') {}
+
+  uint32_t Add(const ConstString &str) {
+    if (str.IsEmpty())
+      return 0;
+    auto insertion = m_offsets.insert({str.GetCString(), m_data.size()});
+    if (insertion.second) {
+      m_data.append(str.GetCString(), str.GetLength());
+      m_data.push_back('\0');
+    }
+    return insertion.first->second;
+  }
+
+  const std::string &GetData() const { return m_data; }
+
+private:
+  llvm::DenseMap<const char *, uint32_t> m_offsets;
+  std::string m_data;
+};
+
+class StringTableReader {
+public:
+  StringTableReader(const char *data, size_t size)
+      : m_data(data), m_size(size) {}
+
+  // The table has to start with the empty name and end with a terminator.
+  bool IsValid() const {
+    return m_data && m_size && m_data[0] == '\0' && m_data[m_size - 1] == '\0';
+  }
+
+  bool Get(uint32_t offset, ConstString &str) const {
+    if (offset >= m_size)
+      return false;
+    if (offset == 0)
+      str.Clear();
+    else
+      str.SetCString(m_data + offset);
+    return true;
+  }
+
+private:
+  const char *m_data;
+  size_t m_size;
+};
+} // namespace
+
+static void EncodeNameMap(llvm::raw_ostream &os, StringTableWriter &strtab,
+                          const UniqueCStringMap<uint32_t> &map) {
+  const size_t size = map.GetSize();
+  Write<uint32_t>(os, size);
+  for (size_t i = 0; i < size; ++i) {
+    Write<uint32_t>(os, strtab.Add(map.GetCStringAtIndexUnchecked(i)));
+    Write<uint32_t>(os, map.GetValueAtIndexUnchecked(i));
+  }
+}
+
+static bool DecodeNameMap(const DataExtractor &data,
+                          lldb::offset_t *offset_ptr,
+                          const StringTableReader &strtab, size_t num_symbols,
+                          UniqueCStringMap<uint32_t> &map) {
+  const uint64_t size = data.GetU32(offset_ptr);
+  if (!data.ValidOffsetForDataOfSize(*offset_ptr, size * 8))
+    return false;
+  map.Clear();
+  map.Reserve(size);
+  ConstString name;
+  for (uint64_t i = 0; i < size; ++i) {
+    if (!strtab.Get(data.GetU32(offset_ptr), name))
+      return false;
+    const uint32_t symbol_idx = data.GetU32(offset_ptr);
+    if (symbol_idx >= num_symbols)
+      return false;
+    map.Append(name, symbol_idx);
+  }
+  // The map is sorted by string pool address, which changes between runs.
+  map.Sort();
+  return true;
+}
+
+static void
+AddSectionsToIDMap(const SectionList &section_list,
+                   llvm::DenseMap<lldb::user_id_t, SectionSP> &sections) {
+  const size_t num_sections = section_list.GetSize();
+  for (size_t i = 0; i < num_sections; ++i) {
+    SectionSP section_sp = section_list.GetSectionAtIndex(i);
+    sections.insert({section_sp->GetID(), section_sp});
+    AddSectionsToIDMap(section_sp->GetChildren(), sections);
+  }
+}
+
+// Objects read from memory have no file to compare with, so they aren't
+// cached.
+static bool GetObjectFileStamp(ObjectFile *objfile, ObjectFileStamp &stamp) {
+  if (objfile->IsInMemory() || !objfile->GetFileSpec())
+    return false;
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(objfile->GetFileSpec().GetPath(), status))
+    return false;
+  stamp.mod_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       status.getLastModificationTime().time_since_epoch())
+                       .count();
+  stamp.size = status.getSize();
+  return true;
+}
+
+void Symtab::SaveToCache() {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  const FileSpec cache_file = GetIndexCacheFile(m_objfile, ".symtab");
+  ObjectFileStamp stamp;
+  if (!cache_file || !GetObjectFileStamp(m_objfile, stamp))
+    return;
+
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, "%s", LLVM_PRETTY_FUNCTION);
+  InitNameIndexes();
+  InitAddressIndexes();
+
+  // The string table is written first, so encode the rest into a buffer.
+  StringTableWriter strtab;
+  std::string contents;
+  llvm::raw_string_ostream os(contents);
+  auto add_string = [&strtab](const ConstString &str) {
+    return strtab.Add(str);
+  };
+  for (const Symbol &symbol : m_symbols)
+    symbol.Encode(os, add_string);
+  EncodeNameMap(os, strtab, m_name_to_index);
+  EncodeNameMap(os, strtab, m_basename_to_index);
+  EncodeNameMap(os, strtab, m_method_to_index);
+  EncodeNameMap(os, strtab, m_selector_to_index);
+  const size_t num_addr_entries = m_file_addr_to_index.GetSize();
+  Write<uint32_t>(os, num_addr_entries);
+  for (size_t i = 0; i < num_addr_entries; ++i) {
+    Write<uint64_t>(os, m_file_addr_to_index.GetBaseAtIndex(i));
+    Write<uint64_t>(os, m_file_addr_to_index.GetByteSizeAtIndex(i));
+    Write<uint32_t>(os, m_file_addr_to_index.GetSymbolIndexAtIndex(i));
+  }
+  os.flush();
+
+  const uint32_t num_symbols = m_symbols.size();
+  WriteIndexCacheFile(cache_file, g_symtab_cache_magic,
+                      g_symtab_cache_version, [&](llvm::raw_ostream &file_os) {
+                        Write<int64_t>(file_os, stamp.mod_time);
+                        Write<uint64_t>(file_os, stamp.size);
+                        Write<uint32_t>(file_os, num_symbols);
+                        Write<uint32_t>(file_os, strtab.GetData().size());
+                        file_os << strtab.GetData() << contents;
+                      });
+}
+
+bool Symtab::LoadFromCache() {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  const FileSpec cache_file = GetIndexCacheFile(m_objfile, ".symtab");
+  ObjectFileStamp stamp;
+  if (!cache_file || !GetObjectFileStamp(m_objfile, stamp))
+    return false;
+  SectionList *section_list = m_objfile->GetModule()->GetSectionList();
+  if (!section_list)
+    return false;
+  auto data_sp = DataBufferLLVM::CreateFromPath(cache_file.GetPath());
+  if (!data_sp)
+    return false;
+
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, "%s", LLVM_PRETTY_FUNCTION);
+  DataExtractor data(data_sp, eByteOrderLittle, 8);
+  lldb::offset_t offset = 0;
+  if (!CheckIndexCacheHeader(data, &offset, g_symtab_cache_magic,
+                             g_symtab_cache_version))
+    return false;
+  ObjectFileStamp cached_stamp;
+  cached_stamp.mod_time = data.GetU64(&offset);
+  cached_stamp.size = data.GetU64(&offset);
+  if (!(cached_stamp == stamp))
+    return false;
+  const uint64_t num_symbols = data.GetU32(&offset);
+  const uint32_t strtab_size = data.GetU32(&offset);
+  StringTableReader strtab(
+      static_cast<const char *>(data.GetData(&offset, strtab_size)),
+      strtab_size);
+  if (!strtab.IsValid() ||
+      !data.ValidOffsetForDataOfSize(offset,
+                                     num_symbols * Symbol::kEncodedSize))
+    return false;
+
+  llvm::DenseMap<lldb::user_id_t, SectionSP> sections;
+  AddSectionsToIDMap(*section_list, sections);
+  auto find_section = [&sections](lldb::user_id_t id) {
+    return sections.lookup(id);
+  };
+  auto get_string = [&strtab](uint32_t str_offset, ConstString &str) {
+    return strtab.Get(str_offset, str);
+  };
+
+  collection symbols(num_symbols);
+  for (Symbol &symbol : symbols) {
+    if (!symbol.Decode(data, &offset, find_section, get_string))
+      return false;
+  }
+
+  UniqueCStringMap<uint32_t> name_maps[4];
+  for (UniqueCStringMap<uint32_t> &map : name_maps) {
+    if (!DecodeNameMap(data, &offset, strtab, num_symbols, map))
+      return false;
+  }
+
+  SymbolAddressIndex addr_index;
+  const uint64_t num_addr_entries = data.GetU32(&offset);
+  if (!data.ValidOffsetForDataOfSize(offset, num_addr_entries * 20))
+    return false;
+  for (uint64_t i = 0; i < num_addr_entries; ++i) {
+    const addr_t base = data.GetU64(&offset);
+    const addr_t size = data.GetU64(&offset);
+    const uint32_t symbol_idx = data.GetU32(&offset);
+    if (symbol_idx >= num_symbols)
+      return false;
+    addr_index.Append(base, size, symbol_idx);
+  }
+  addr_index.Sort();
+
+  m_symbols.swap(symbols);
+  m_name_to_index = std::move(name_maps[0]);
+  m_basename_to_index = std::move(name_maps[1]);
+  m_method_to_index = std::move(name_maps[2]);
+  m_selector_to_index = std::move(name_maps[3]);
+  m_file_addr_to_index = std::move(addr_index);
+  m_name_indexes_computed = true;
+  m_file_addr_to_index_computed = true;
+  m_regex_index.reset();
+  return true;
+}
+
 Symbol *Symtab::FindSymbolWithType(SymbolType symbol_type,
                                    Debug symbol_debug_type,
                                    Visibility symbol_visibility,
@@ -857,23 +1325,21 @@ void Symtab::InitAddressIndexes() {
   if (!m_file_addr_to_index_computed && !m_symbols.empty()) {
     m_file_addr_to_index_computed = true;
 
-    FileRangeToIndexMap::Entry entry;
+    m_file_addr_to_index.Clear();
     const_iterator begin = m_symbols.begin();
     const_iterator end = m_symbols.end();
     for (const_iterator pos = m_symbols.begin(); pos != end; ++pos) {
-      if (pos->ValueIsAddress()) {
-        entry.SetRangeBase(pos->GetAddressRef().GetFileAddress());
-        entry.SetByteSize(pos->GetByteSize());
-        entry.data = std::distance(begin, pos);
-        m_file_addr_to_index.Append(entry);
-      }
+      if (pos->ValueIsAddress())
+        m_file_addr_to_index.Append(pos->GetAddressRef().GetFileAddress(),
+                                    pos->GetByteSize(),
+                                    std::distance(begin, pos));
     }
     const size_t num_entries = m_file_addr_to_index.GetSize();
     if (num_entries > 0) {
       m_file_addr_to_index.Sort();
 
       // Create a RangeVector with the start & size of all the sections for
-      // this objfile.  We'll need to check this for any FileRangeToIndexMap
+      // this objfile.  We'll need to check this for any address index
       // entries with an uninitialized size, which could potentially be a large
       // number so reconstituting the weak pointer is busywork when it is
       // invariant information.
@@ -884,15 +1350,13 @@ void Symtab::InitAddressIndexes() {
         section_ranges.Sort();
       }
 
-      // Iterate through the FileRangeToIndexMap and fill in the size for any
+      // Iterate through the address index and fill in the size for any
       // entries that didn't already have a size from the Symbol (e.g. if we
       // have a plain linker symbol with an address only, instead of debug info
       // where we get an address and a size and a type, etc.)
       for (size_t i = 0; i < num_entries; i++) {
-        FileRangeToIndexMap::Entry *entry =
-            m_file_addr_to_index.GetMutableEntryAtIndex(i);
-        if (entry->GetByteSize() == 0) {
-          addr_t curr_base_addr = entry->GetRangeBase();
+        if (m_file_addr_to_index.GetByteSizeAtIndex(i) == 0) {
+          addr_t curr_base_addr = m_file_addr_to_index.GetBaseAtIndex(i);
           const RangeVector<addr_t, addr_t>::Entry *containing_section =
               section_ranges.FindEntryThatContains(curr_base_addr);
 
@@ -901,13 +1365,11 @@ void Symtab::InitAddressIndexes() {
           if (containing_section) {
             sym_size =
                 containing_section->GetByteSize() -
-                (entry->GetRangeBase() - containing_section->GetRangeBase());
+                (curr_base_addr - containing_section->GetRangeBase());
           }
 
           for (size_t j = i; j < num_entries; j++) {
-            FileRangeToIndexMap::Entry *next_entry =
-                m_file_addr_to_index.GetMutableEntryAtIndex(j);
-            addr_t next_base_addr = next_entry->GetRangeBase();
+            addr_t next_base_addr = m_file_addr_to_index.GetBaseAtIndex(j);
             if (next_base_addr > curr_base_addr) {
               addr_t size_to_next_symbol = next_base_addr - curr_base_addr;
 
@@ -921,8 +1383,9 @@ void Symtab::InitAddressIndexes() {
           }
 
           if (sym_size > 0) {
-            entry->SetByteSize(sym_size);
-            Symbol &symbol = m_symbols[entry->data];
+            m_file_addr_to_index.SetByteSizeAtIndex(i, sym_size);
+            Symbol &symbol =
+                m_symbols[m_file_addr_to_index.GetSymbolIndexAtIndex(i)];
             symbol.SetByteSize(sym_size);
             symbol.SetSizeIsSynthesized(true);
           }
@@ -947,16 +1410,14 @@ void Symtab::CalculateSymbolSizes() {
     for (size_t i = 0; i < num_entries; ++i) {
       // The entries in the m_file_addr_to_index have calculated the sizes
       // already so we will use this size if we need to.
-      const FileRangeToIndexMap::Entry &entry =
-          m_file_addr_to_index.GetEntryRef(i);
-
-      Symbol &symbol = m_symbols[entry.data];
+      Symbol &symbol =
+          m_symbols[m_file_addr_to_index.GetSymbolIndexAtIndex(i)];
 
       // If the symbol size is already valid, no need to do anything
       if (symbol.GetByteSizeIsValid())
         continue;
 
-      const addr_t range_size = entry.GetByteSize();
+      const addr_t range_size = m_file_addr_to_index.GetByteSizeAtIndex(i);
       if (range_size > 0) {
         symbol.SetByteSize(range_size);
         symbol.SetSizeIsSynthesized(true);
@@ -970,10 +1431,10 @@ Symbol *Symtab::FindSymbolAtFileAddress(addr_t file_addr) {
   if (!m_file_addr_to_index_computed)
     InitAddressIndexes();
 
-  const FileRangeToIndexMap::Entry *entry =
-      m_file_addr_to_index.FindEntryStartsAt(file_addr);
-  if (entry) {
-    Symbol *symbol = SymbolAtIndex(entry->data);
+  const uint32_t symbol_idx =
+      m_file_addr_to_index.FindSymbolIndexStartingAt(file_addr);
+  if (symbol_idx != UINT32_MAX) {
+    Symbol *symbol = SymbolAtIndex(symbol_idx);
     if (symbol->GetFileAddress() == file_addr)
       return symbol;
   }
@@ -986,10 +1447,10 @@ Symbol *Symtab::FindSymbolContainingFileAddress(addr_t file_addr) {
   if (!m_file_addr_to_index_computed)
     InitAddressIndexes();
 
-  const FileRangeToIndexMap::Entry *entry =
-      m_file_addr_to_index.FindEntryThatContains(file_addr);
-  if (entry) {
-    Symbol *symbol = SymbolAtIndex(entry->data);
+  const uint32_t symbol_idx =
+      m_file_addr_to_index.FindSymbolIndexContaining(file_addr);
+  if (symbol_idx != UINT32_MAX) {
+    Symbol *symbol = SymbolAtIndex(symbol_idx);
     if (symbol->ContainsFileAddress(file_addr))
       return symbol;
   }
@@ -1007,7 +1468,7 @@ void Symtab::ForEachSymbolContainingFileAddress(
 
   // Get all symbols with file_addr
   const size_t addr_match_count =
-      m_file_addr_to_index.FindEntryIndexesThatContain(file_addr,
+      m_file_addr_to_index.FindSymbolIndexesContaining(file_addr,
                                                        all_addr_indexes);
 
   for (size_t i = 0; i < addr_match_count; ++i) {
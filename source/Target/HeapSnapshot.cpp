@@ -0,0 +1,851 @@
+//===-- HeapSnapshot.cpp ----------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// C Includes
+// C++ Includes
+#include <algorithm>
+
+// Other libraries and framework includes
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Endian.h"
+
+// Project includes
+#include "lldb/Core/Address.h"
+#include "lldb/Host/File.h"
+#include "lldb/Symbol/Symbol.h"
+#include "lldb/Target/HeapSnapshot.h"
+#include "lldb/Target/MemoryChunkReader.h"
+#include "lldb/Target/MemoryRegionInfo.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Target/Target.h"
+#include "lldb/Utility/DataBufferLLVM.h"
+#include "lldb/Utility/DataExtractor.h"
+#include "lldb/Utility/FileSpec.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+//----------------------------------------------------------------------
+// Snapshot file format. Everything is little endian.
+//
+//   char     magic[8]            "LLDBHEAP"
+//   uint32_t version
+//   uint32_t reserved
+//   uint64_t num_objects
+//   uint64_t num_references
+//   uint64_t num_types
+//   uint64_t addresses[num_objects]
+//   uint64_t sizes[num_objects]
+//   uint32_t types[num_objects]
+//   uint8_t  flags[num_objects]
+//   uint64_t reference_offsets[num_objects + 1]
+//   uint32_t references[num_references]
+//   char     type_names[num_types][]   NULL terminated
+//
+// Only the roots are recorded in the flags; reachability, dominators and
+// retained sizes are recomputed when a snapshot is loaded.
+//----------------------------------------------------------------------
+static const char g_snapshot_magic[8] = {'L', 'L', 'D', 'B',
+                                         'H', 'E', 'A', 'P'};
+static const uint32_t g_snapshot_version = 1;
+
+const uint32_t HeapSnapshot::kInvalidIndex;
+
+HeapSnapshot::HeapSnapshot() {
+  // Type index 0 is used for objects of unknown type.
+  GetTypeIndex(llvm::StringRef());
+}
+
+uint32_t HeapSnapshot::GetTypeIndex(llvm::StringRef type_name) {
+  auto insert_result =
+      m_type_indexes.insert(std::make_pair(type_name, m_type_names.size()));
+  if (insert_result.second)
+    m_type_names.push_back(type_name.str());
+  return insert_result.first->second;
+}
+
+uint32_t HeapSnapshot::AddObject(addr_t addr, uint64_t size,
+                                 llvm::StringRef type_name) {
+  assert((m_addrs.empty() || m_addrs.back() + m_sizes.back() <= addr) &&
+         "objects must be added in address order");
+  m_addrs.push_back(addr);
+  m_sizes.push_back(size);
+  m_types.push_back(GetTypeIndex(type_name));
+  m_flags.push_back(0);
+  return m_addrs.size() - 1;
+}
+
+void HeapSnapshot::AddReference(uint32_t from, uint32_t to) {
+  if (from != to)
+    m_pending_edges.emplace_back(from, to);
+}
+
+void HeapSnapshot::SetIsRoot(uint32_t idx) { m_flags[idx] |= eFlagRoot; }
+
+void HeapSnapshot::Finalize() {
+  if (!m_pending_edges.empty()) {
+    // Merge the new references with the existing ones.
+    for (uint32_t i = 0; i + 1 < m_edge_offsets.size(); ++i) {
+      for (uint64_t e = m_edge_offsets[i]; e < m_edge_offsets[i + 1]; ++e)
+        m_pending_edges.emplace_back(i, m_edge_targets[e]);
+    }
+    std::sort(m_pending_edges.begin(), m_pending_edges.end());
+    m_pending_edges.erase(
+        std::unique(m_pending_edges.begin(), m_pending_edges.end()),
+        m_pending_edges.end());
+  }
+
+  const size_t num_objects = GetNumObjects();
+  if (m_edge_offsets.size() != num_objects + 1 || !m_pending_edges.empty()) {
+    m_edge_offsets.assign(num_objects + 1, 0);
+    m_edge_targets.clear();
+    m_edge_targets.reserve(m_pending_edges.size());
+    for (const auto &edge : m_pending_edges) {
+      ++m_edge_offsets[edge.first + 1];
+      m_edge_targets.push_back(edge.second);
+    }
+    for (size_t i = 0; i < num_objects; ++i)
+      m_edge_offsets[i + 1] += m_edge_offsets[i];
+    m_pending_edges.clear();
+    m_pending_edges.shrink_to_fit();
+  }
+
+  ComputeReachability();
+  ComputeDominators();
+}
+
+llvm::ArrayRef<uint32_t> HeapSnapshot::GetReferences(uint32_t idx) const {
+  const uint64_t begin = m_edge_offsets[idx];
+  return llvm::makeArrayRef(m_edge_targets)
+      .slice(begin, m_edge_offsets[idx + 1] - begin);
+}
+
+uint32_t HeapSnapshot::FindObjectContaining(addr_t addr) const {
+  auto pos = std::upper_bound(m_addrs.begin(), m_addrs.end(), addr);
+  if (pos == m_addrs.begin())
+    return kInvalidIndex;
+  const uint32_t idx = std::distance(m_addrs.begin(), pos) - 1;
+  if (addr - m_addrs[idx] < m_sizes[idx])
+    return idx;
+  return kInvalidIndex;
+}
+
+void HeapSnapshot::ComputeReachability() {
+  std::vector<uint32_t> worklist;
+  for (uint32_t i = 0; i < GetNumObjects(); ++i) {
+    m_flags[i] &= ~eFlagReachable;
+    if (m_flags[i] & eFlagRoot) {
+      m_flags[i] |= eFlagReachable;
+      worklist.push_back(i);
+    }
+  }
+  while (!worklist.empty()) {
+    const uint32_t idx = worklist.back();
+    worklist.pop_back();
+    for (uint32_t target : GetReferences(idx)) {
+      if (!(m_flags[target] & eFlagReachable)) {
+        m_flags[target] |= eFlagReachable;
+        worklist.push_back(target);
+      }
+    }
+  }
+}
+
+// Compute the dominator tree with the iterative algorithm from Cooper,
+// Harvey and Kennedy, "A Simple, Fast Dominance Algorithm". The graph gets
+// a virtual root that points at every root object. Unreachable objects are
+// attached to the virtual root as well, starting with the ones nothing
+// points at, so that each leaked structure is dominated by its head and
+// reports its whole size as retained.
+void HeapSnapshot::ComputeDominators() {
+  const uint32_t num_objects = GetNumObjects();
+  const uint32_t virtual_root = num_objects;
+
+  m_idom.assign(num_objects, kInvalidIndex);
+  m_retained = m_sizes;
+  if (num_objects == 0)
+    return;
+
+  // Predecessors, in compressed sparse row form.
+  std::vector<uint64_t> pred_offsets(num_objects + 1, 0);
+  for (uint32_t target : m_edge_targets)
+    ++pred_offsets[target + 1];
+  for (uint32_t i = 0; i < num_objects; ++i)
+    pred_offsets[i + 1] += pred_offsets[i];
+  std::vector<uint32_t> preds(m_edge_targets.size());
+  {
+    std::vector<uint64_t> fill(pred_offsets.begin(), pred_offsets.end() - 1);
+    for (uint32_t i = 0; i < num_objects; ++i)
+      for (uint32_t target : GetReferences(i))
+        preds[fill[target]++] = i;
+  }
+
+  // Depth first search from the virtual root, recording the post order.
+  const uint32_t kUnvisited = UINT32_MAX;
+  std::vector<uint32_t> post_number(num_objects + 1, kUnvisited);
+  std::vector<uint32_t> post_order;
+  post_order.reserve(num_objects + 1);
+  std::vector<bool> from_virtual_root(num_objects, false);
+  std::vector<std::pair<uint32_t, uint64_t>> stack;
+  std::vector<bool> visited(num_objects, false);
+
+  auto visit = [&](uint32_t start) {
+    if (visited[start])
+      return;
+    visited[start] = true;
+    stack.emplace_back(start, m_edge_offsets[start]);
+    while (!stack.empty()) {
+      auto &top = stack.back();
+      const uint32_t node = top.first;
+      if (top.second < m_edge_offsets[node + 1]) {
+        const uint32_t next = m_edge_targets[top.second++];
+        if (!visited[next]) {
+          visited[next] = true;
+          stack.emplace_back(next, m_edge_offsets[next]);
+        }
+        continue;
+      }
+      post_number[node] = post_order.size();
+      post_order.push_back(node);
+      stack.pop_back();
+    }
+  };
+
+  for (uint32_t i = 0; i < num_objects; ++i)
+    if (m_flags[i] & eFlagRoot)
+      from_virtual_root[i] = true;
+  for (uint32_t i = 0; i < num_objects; ++i)
+    if (m_flags[i] & eFlagRoot)
+      visit(i);
+  for (uint32_t i = 0; i < num_objects; ++i) {
+    if (!visited[i] && pred_offsets[i] == pred_offsets[i + 1]) {
+      from_virtual_root[i] = true;
+      visit(i);
+    }
+  }
+  // Whatever is left is only part of unreachable cycles.
+  for (uint32_t i = 0; i < num_objects; ++i) {
+    if (!visited[i]) {
+      from_virtual_root[i] = true;
+      visit(i);
+    }
+  }
+  post_number[virtual_root] = post_order.size();
+
+  std::vector<uint32_t> idom(num_objects + 1, kUnvisited);
+  idom[virtual_root] = virtual_root;
+
+  auto intersect = [&](uint32_t a, uint32_t b) {
+    while (a != b) {
+      while (post_number[a] < post_number[b])
+        a = idom[a];
+      while (post_number[b] < post_number[a])
+        b = idom[b];
+    }
+    return a;
+  };
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    // Reverse post order.
+    for (auto pos = post_order.rbegin(); pos != post_order.rend(); ++pos) {
+      const uint32_t node = *pos;
+      uint32_t new_idom = from_virtual_root[node] ? virtual_root : kUnvisited;
+      for (uint64_t p = pred_offsets[node]; p < pred_offsets[node + 1]; ++p) {
+        const uint32_t pred = preds[p];
+        if (idom[pred] == kUnvisited)
+          continue;
+        new_idom =
+            new_idom == kUnvisited ? pred : intersect(pred, new_idom);
+      }
+      if (idom[node] != new_idom) {
+        idom[node] = new_idom;
+        changed = true;
+      }
+    }
+  }
+
+  // Dominated objects come before their dominators in post order.
+  for (uint32_t node : post_order) {
+    const uint32_t dominator = idom[node];
+    if (dominator == virtual_root || dominator == kUnvisited)
+      continue;
+    m_idom[node] = dominator;
+    m_retained[dominator] += m_retained[node];
+  }
+}
+
+std::vector<HeapSnapshot::TypeStatistics>
+HeapSnapshot::GetTypeStatistics() const {
+  const uint32_t num_objects = GetNumObjects();
+  std::vector<TypeStatistics> stats(m_type_names.size());
+  for (size_t i = 0; i < m_type_names.size(); ++i)
+    stats[i].name = m_type_names[i];
+
+  for (uint32_t i = 0; i < num_objects; ++i) {
+    TypeStatistics &type_stats = stats[m_types[i]];
+    ++type_stats.count;
+    type_stats.size += m_sizes[i];
+    if (!IsReachable(i)) {
+      ++type_stats.unreachable_count;
+      type_stats.unreachable_size += m_sizes[i];
+    }
+  }
+
+  // Walk the dominator tree, only counting the retained size of an object
+  // if none of its dominators has the same type, so that e.g. the nodes of
+  // a linked list are not counted once per node.
+  std::vector<uint64_t> child_offsets(num_objects + 1, 0);
+  for (uint32_t i = 0; i < num_objects; ++i)
+    if (m_idom[i] != kInvalidIndex)
+      ++child_offsets[m_idom[i] + 1];
+  for (uint32_t i = 0; i < num_objects; ++i)
+    child_offsets[i + 1] += child_offsets[i];
+  std::vector<uint32_t> children(child_offsets.back());
+  {
+    std::vector<uint64_t> fill(child_offsets.begin(), child_offsets.end() - 1);
+    for (uint32_t i = 0; i < num_objects; ++i)
+      if (m_idom[i] != kInvalidIndex)
+        children[fill[m_idom[i]]++] = i;
+  }
+
+  std::vector<uint32_t> active(m_type_names.size(), 0);
+  // Entries with the high bit set mark leaving a node.
+  const uint64_t kExit = 1ULL << 63;
+  std::vector<uint64_t> stack;
+  for (uint32_t i = 0; i < num_objects; ++i) {
+    if (m_idom[i] != kInvalidIndex)
+      continue;
+    stack.push_back(i);
+    while (!stack.empty()) {
+      const uint64_t entry = stack.back();
+      stack.pop_back();
+      const uint32_t node = entry & ~kExit;
+      const uint32_t type = m_types[node];
+      if (entry & kExit) {
+        --active[type];
+        continue;
+      }
+      if (active[type]++ == 0)
+        stats[type].retained_size += m_retained[node];
+      stack.push_back(node | kExit);
+      for (uint64_t c = child_offsets[node]; c < child_offsets[node + 1]; ++c)
+        stack.push_back(children[c]);
+    }
+  }
+
+  stats.erase(std::remove_if(stats.begin(), stats.end(),
+                             [](const TypeStatistics &s) {
+                               return s.count == 0;
+                             }),
+              stats.end());
+  std::sort(stats.begin(), stats.end(),
+            [](const TypeStatistics &lhs, const TypeStatistics &rhs) {
+              if (lhs.retained_size != rhs.retained_size)
+                return lhs.retained_size > rhs.retained_size;
+              return lhs.name < rhs.name;
+            });
+  return stats;
+}
+
+std::vector<HeapSnapshot::TypeDelta>
+HeapSnapshot::Diff(const HeapSnapshot &before, const HeapSnapshot &after) {
+  llvm::StringMap<TypeDelta> deltas;
+  for (uint32_t i = 0; i < before.GetNumObjects(); ++i) {
+    TypeDelta &delta = deltas[before.GetObjectTypeName(i)];
+    --delta.count_delta;
+    delta.size_delta -= before.GetObjectSize(i);
+  }
+  for (uint32_t i = 0; i < after.GetNumObjects(); ++i) {
+    const llvm::StringRef type_name = after.GetObjectTypeName(i);
+    TypeDelta &delta = deltas[type_name];
+    ++delta.count_delta;
+    delta.size_delta += after.GetObjectSize(i);
+
+    const uint32_t old_idx =
+        before.FindObjectContaining(after.GetObjectAddress(i));
+    if (old_idx == kInvalidIndex ||
+        before.GetObjectAddress(old_idx) != after.GetObjectAddress(i) ||
+        before.GetObjectSize(old_idx) != after.GetObjectSize(i) ||
+        before.GetObjectTypeName(old_idx) != type_name)
+      ++delta.new_objects;
+  }
+
+  std::vector<TypeDelta> result;
+  for (auto &entry : deltas) {
+    TypeDelta delta = entry.second;
+    if (delta.count_delta == 0 && delta.size_delta == 0 &&
+        delta.new_objects == 0)
+      continue;
+    delta.name = entry.first().str();
+    result.push_back(std::move(delta));
+  }
+  std::sort(result.begin(), result.end(),
+            [](const TypeDelta &lhs, const TypeDelta &rhs) {
+              if (lhs.size_delta != rhs.size_delta)
+                return lhs.size_delta > rhs.size_delta;
+              if (lhs.count_delta != rhs.count_delta)
+                return lhs.count_delta > rhs.count_delta;
+              return lhs.name < rhs.name;
+            });
+  return result;
+}
+
+//----------------------------------------------------------------------
+// Saving and loading
+//----------------------------------------------------------------------
+namespace {
+class ColumnWriter {
+public:
+  explicit ColumnWriter(File &file) : m_file(file) {}
+
+  template <typename T> void Write(T value) {
+    uint8_t bytes[sizeof(T)];
+    llvm::support::endian::write<T, llvm::support::little,
+                                 llvm::support::unaligned>(bytes, value);
+    Append(bytes, sizeof(bytes));
+  }
+
+  template <typename T> void WriteColumn(llvm::ArrayRef<T> values) {
+    for (const T &value : values)
+      Write(value);
+  }
+
+  void Append(const void *bytes, size_t size) {
+    const uint8_t *src = static_cast<const uint8_t *>(bytes);
+    m_buffer.insert(m_buffer.end(), src, src + size);
+    if (m_buffer.size() >= kFlushSize)
+      Flush();
+  }
+
+  void Flush() {
+    if (m_buffer.empty() || m_error.Fail())
+      return;
+    size_t num_bytes = m_buffer.size();
+    m_error = m_file.Write(m_buffer.data(), num_bytes);
+    if (m_error.Success() && num_bytes != m_buffer.size())
+      m_error.SetErrorString("short write");
+    m_buffer.clear();
+  }
+
+  const Status &GetError() const { return m_error; }
+
+private:
+  static const size_t kFlushSize = 1024 * 1024;
+  File &m_file;
+  std::vector<uint8_t> m_buffer;
+  Status m_error;
+};
+} // namespace
+
+Status HeapSnapshot::Save(const FileSpec &file_spec) const {
+  File file;
+  Status error = file.Open(file_spec.GetPath().c_str(),
+                           File::eOpenOptionWrite | File::eOpenOptionCanCreate |
+                               File::eOpenOptionTruncate);
+  if (error.Fail())
+    return error;
+
+  const size_t num_objects = GetNumObjects();
+  ColumnWriter writer(file);
+  writer.Append(g_snapshot_magic, sizeof(g_snapshot_magic));
+  writer.Write<uint32_t>(g_snapshot_version);
+  writer.Write<uint32_t>(0);
+  writer.Write<uint64_t>(num_objects);
+  writer.Write<uint64_t>(m_edge_targets.size());
+  writer.Write<uint64_t>(m_type_names.size());
+  writer.WriteColumn<uint64_t>(m_addrs);
+  writer.WriteColumn<uint64_t>(m_sizes);
+  writer.WriteColumn<uint32_t>(m_types);
+  for (uint8_t flags : m_flags)
+    writer.Write<uint8_t>(flags & eFlagRoot);
+  if (m_edge_offsets.size() == num_objects + 1)
+    writer.WriteColumn<uint64_t>(m_edge_offsets);
+  else
+    for (size_t i = 0; i <= num_objects; ++i)
+      writer.Write<uint64_t>(0);
+  writer.WriteColumn<uint32_t>(m_edge_targets);
+  for (const std::string &name : m_type_names)
+    writer.Append(name.c_str(), name.size() + 1);
+  writer.Flush();
+  return writer.GetError();
+}
+
+Status HeapSnapshot::Load(const FileSpec &file_spec, HeapSnapshot &snapshot) {
+  snapshot = HeapSnapshot();
+
+  auto data_sp = DataBufferLLVM::CreateFromPath(file_spec.GetPath());
+  if (!data_sp)
+    return Status("unable to read '%s'", file_spec.GetPath().c_str());
+
+  DataExtractor data(data_sp, eByteOrderLittle, 8);
+  lldb::offset_t offset = 0;
+  const void *magic = data.GetData(&offset, sizeof(g_snapshot_magic));
+  if (!magic || memcmp(magic, g_snapshot_magic, sizeof(g_snapshot_magic)) != 0)
+    return Status("'%s' is not a heap snapshot", file_spec.GetPath().c_str());
+  const uint32_t version = data.GetU32(&offset);
+  if (version != g_snapshot_version)
+    return Status("unsupported heap snapshot version %u", version);
+  data.GetU32(&offset); // Reserved.
+  const uint64_t num_objects = data.GetU64(&offset);
+  const uint64_t num_references = data.GetU64(&offset);
+  const uint64_t num_types = data.GetU64(&offset);
+
+  // Make sure the columns fit in the file before allocating anything.
+  const uint64_t columns_size =
+      num_objects * (8 + 8 + 4 + 1) + (num_objects + 1) * 8 +
+      num_references * 4;
+  if (num_objects >= UINT32_MAX || num_types >= UINT32_MAX ||
+      num_references > data.GetByteSize() ||
+      !data.ValidOffsetForDataOfSize(offset, columns_size))
+    return Status("heap snapshot '%s' is truncated",
+                  file_spec.GetPath().c_str());
+
+  snapshot.m_addrs.resize(num_objects);
+  snapshot.m_sizes.resize(num_objects);
+  snapshot.m_types.resize(num_objects);
+  snapshot.m_flags.resize(num_objects);
+  snapshot.m_edge_offsets.resize(num_objects + 1);
+  snapshot.m_edge_targets.resize(num_references);
+  for (auto &addr : snapshot.m_addrs)
+    addr = data.GetU64(&offset);
+  for (auto &size : snapshot.m_sizes)
+    size = data.GetU64(&offset);
+  for (auto &type : snapshot.m_types)
+    type = data.GetU32(&offset);
+  for (auto &flags : snapshot.m_flags)
+    flags = data.GetU8(&offset) & eFlagRoot;
+  for (auto &edge_offset : snapshot.m_edge_offsets)
+    edge_offset = data.GetU64(&offset);
+  for (auto &target : snapshot.m_edge_targets)
+    target = data.GetU32(&offset);
+
+  snapshot.m_type_names.clear();
+  snapshot.m_type_indexes.clear();
+  for (uint64_t i = 0; i < num_types; ++i) {
+    const char *name = data.GetCStr(&offset);
+    if (!name)
+      return Status("heap snapshot '%s' is truncated",
+                    file_spec.GetPath().c_str());
+    snapshot.m_type_indexes.insert(
+        std::make_pair(llvm::StringRef(name), (uint32_t)i));
+    snapshot.m_type_names.push_back(name);
+  }
+
+  // Validate everything that is used as an index.
+  for (size_t i = 0; i < num_objects; ++i) {
+    if (snapshot.m_types[i] >= num_types ||
+        snapshot.m_edge_offsets[i] > snapshot.m_edge_offsets[i + 1] ||
+        (i > 0 && snapshot.m_addrs[i] < snapshot.m_addrs[i - 1]))
+      return Status("heap snapshot '%s' is corrupt",
+                    file_spec.GetPath().c_str());
+  }
+  if (snapshot.m_edge_offsets[0] != 0 ||
+      snapshot.m_edge_offsets[num_objects] != num_references ||
+      std::any_of(snapshot.m_edge_targets.begin(),
+                  snapshot.m_edge_targets.end(),
+                  [&](uint32_t target) { return target >= num_objects; }))
+    return Status("heap snapshot '%s' is corrupt", file_spec.GetPath().c_str());
+  if (num_types == 0)
+    snapshot.GetTypeIndex(llvm::StringRef());
+
+  snapshot.Finalize();
+  return Status();
+}
+
+//----------------------------------------------------------------------
+// Capturing
+//----------------------------------------------------------------------
+namespace {
+
+// Reads pointer sized words from the process through a window, so that
+// walking a chain of malloc chunk headers costs one read per window rather
+// than one read per chunk.
+class WindowedWordReader {
+public:
+  explicit WindowedWordReader(Process &process)
+      : m_process(process), m_word_size(process.GetAddressByteSize()),
+        m_byte_order(process.GetByteOrder()),
+        m_window_addr(LLDB_INVALID_ADDRESS) {}
+
+  uint32_t GetWordSize() const { return m_word_size; }
+
+  // Read the word at |addr|, never reading at or past |limit|.
+  bool ReadWord(addr_t addr, addr_t limit, uint64_t &value) {
+    if (addr + m_word_size > limit)
+      return false;
+    if (m_window_addr == LLDB_INVALID_ADDRESS || addr < m_window_addr ||
+        addr + m_word_size > m_window_addr + m_window.size()) {
+      const size_t size =
+          std::min<addr_t>(kWindowSize, limit - addr);
+      m_window.resize(size);
+      Status error;
+      m_window.resize(m_process.ReadMemory(addr, m_window.data(), size, error));
+      m_window_addr = addr;
+      if (m_window.size() < m_word_size)
+        return false;
+    }
+    DataExtractor data(m_window.data() + (addr - m_window_addr), m_word_size,
+                       m_byte_order, m_word_size);
+    lldb::offset_t offset = 0;
+    value = data.GetMaxU64(&offset, m_word_size);
+    return true;
+  }
+
+private:
+  static const size_t kWindowSize = 64 * 1024;
+
+  Process &m_process;
+  const uint32_t m_word_size;
+  const ByteOrder m_byte_order;
+  addr_t m_window_addr;
+  std::vector<uint8_t> m_window;
+};
+
+struct HeapChunk {
+  addr_t addr; // The address malloc returned.
+  uint64_t size;
+};
+
+// glibc chunk header flags, stored in the low bits of the size field.
+const uint64_t kPrevInUse = 0x1;
+const uint64_t kIsMMapped = 0x2;
+const uint64_t kSizeFlags = 0x7;
+
+// Walk the malloc chunks in [start, end), where |start| is the address of
+// the first chunk header. A heap is a contiguous chain of chunks that ends
+// in the top chunk right at the end of the region, so anything that
+// doesn't chain up like that is rejected.
+bool WalkChunkChain(WindowedWordReader &reader, addr_t start, addr_t end,
+                    std::vector<HeapChunk> &chunks) {
+  const uint64_t word_size = reader.GetWordSize();
+  const uint64_t alignment = 2 * word_size;
+  const uint64_t min_size = 4 * word_size;
+
+  std::vector<HeapChunk> found;
+  bool have_prev = false;
+  HeapChunk prev = {0, 0};
+  addr_t chunk = start;
+  while (true) {
+    uint64_t size_field;
+    if (!reader.ReadWord(chunk + word_size, end, size_field))
+      return false;
+    const uint64_t size = size_field & ~kSizeFlags;
+    if (size < min_size || size % alignment != 0 || size > end - chunk ||
+        (size_field & kIsMMapped))
+      return false;
+    // In-use bits are tracked by the following chunk.
+    if (have_prev && (size_field & kPrevInUse))
+      found.push_back(prev);
+    const addr_t next = chunk + size;
+    if (end - next < min_size)
+      break; // This is the top chunk.
+    // An in-use chunk can also use the prev_size field of the next one.
+    prev = {chunk + alignment, size - word_size};
+    have_prev = true;
+    chunk = next;
+  }
+  chunks.insert(chunks.end(), found.begin(), found.end());
+  return true;
+}
+
+// Large allocations are served by mmap; each one is a single chunk with
+// the IS_MMAPPED bit set. Adjacent mappings are often merged into one
+// region by the kernel, so keep going as long as chunks follow each other.
+void WalkMMappedChunks(WindowedWordReader &reader, addr_t start, addr_t end,
+                       std::vector<HeapChunk> &chunks) {
+  const uint64_t word_size = reader.GetWordSize();
+  const uint64_t page_size = 4096;
+  addr_t chunk = start;
+  while (chunk < end) {
+    uint64_t prev_size, size_field;
+    if (!reader.ReadWord(chunk, end, prev_size) ||
+        !reader.ReadWord(chunk + word_size, end, size_field))
+      return;
+    const uint64_t size = size_field & ~kSizeFlags;
+    if (!(size_field & kIsMMapped) || size == 0 ||
+        (prev_size + size) % page_size != 0 || size > end - chunk)
+      return;
+    chunks.push_back({chunk + 2 * word_size, size - 2 * word_size});
+    chunk += prev_size + size;
+  }
+}
+
+// Find the malloc chunks in one writable memory region.
+void FindHeapChunks(WindowedWordReader &reader, const MemoryRegionInfo &region,
+                    std::vector<HeapChunk> &chunks) {
+  const addr_t start = region.GetRange().GetRangeBase();
+  const addr_t end = region.GetRange().GetRangeEnd();
+  const uint64_t word_size = reader.GetWordSize();
+  const uint64_t alignment = 2 * word_size;
+
+  // The main arena grows the [heap] region with brk, and its first chunk
+  // starts right at the beginning of the region.
+  if (WalkChunkChain(reader, start, end, chunks))
+    return;
+
+  // Other arenas live in mmapped heaps that are aligned to HEAP_MAX_SIZE
+  // and start with a heap_info header. The first heap of an arena also
+  // holds the arena's malloc_state, whose size depends on the glibc
+  // version, so look for the first offset that yields a valid chain.
+  const uint64_t heap_max_size = word_size == 8 ? 64 * 1024 * 1024
+                                                : 1024 * 1024;
+  if (start % heap_max_size == 0) {
+    const uint64_t heap_info_size = 4 * word_size;
+    uint64_t ar_ptr;
+    if (reader.ReadWord(start, end, ar_ptr)) {
+      if (ar_ptr != start + heap_info_size) {
+        if (WalkChunkChain(reader, start + heap_info_size, end, chunks))
+          return;
+      } else {
+        for (uint64_t offset = heap_info_size + alignment;
+             offset < 8192 && start + offset < end; offset += alignment) {
+          if (WalkChunkChain(reader, start + offset, end, chunks))
+            return;
+        }
+      }
+    }
+  }
+
+  WalkMMappedChunks(reader, start, end, chunks);
+}
+
+bool IsScannable(const MemoryRegionInfo &region) {
+  return region.GetReadable() == MemoryRegionInfo::eYes &&
+         region.GetWritable() == MemoryRegionInfo::eYes;
+}
+
+} // namespace
+
+Status HeapSnapshot::Capture(Process &process, HeapSnapshot &snapshot) {
+  snapshot = HeapSnapshot();
+
+  std::vector<MemoryRegionInfoSP> regions;
+  Status error = process.GetMemoryRegions(regions);
+  if (error.Fail())
+    return error;
+  if (regions.empty())
+    return Status("the process doesn't describe its memory regions");
+
+  WindowedWordReader reader(process);
+  const uint32_t word_size = reader.GetWordSize();
+
+  // Find all the allocated chunks and the regions that hold them.
+  std::vector<HeapChunk> chunks;
+  std::vector<bool> is_heap_region(regions.size(), false);
+  // Read-only data regions; vtables live in .data.rel.ro.
+  std::vector<std::pair<addr_t, addr_t>> const_ranges;
+  for (size_t i = 0; i < regions.size(); ++i) {
+    const MemoryRegionInfo &region = *regions[i];
+    if (IsScannable(region)) {
+      const size_t num_chunks = chunks.size();
+      FindHeapChunks(reader, region, chunks);
+      is_heap_region[i] = chunks.size() != num_chunks;
+    } else if (region.GetReadable() == MemoryRegionInfo::eYes &&
+               region.GetExecutable() != MemoryRegionInfo::eYes) {
+      const_ranges.emplace_back(region.GetRange().GetRangeBase(),
+                                region.GetRange().GetRangeEnd());
+    }
+  }
+
+  std::sort(chunks.begin(), chunks.end(),
+            [](const HeapChunk &lhs, const HeapChunk &rhs) {
+              return lhs.addr < rhs.addr;
+            });
+  for (const HeapChunk &chunk : chunks) {
+    if (snapshot.m_addrs.empty() ||
+        snapshot.m_addrs.back() + snapshot.m_sizes.back() <= chunk.addr)
+      snapshot.AddObject(chunk.addr, chunk.size);
+  }
+  chunks.clear();
+  chunks.shrink_to_fit();
+  if (snapshot.GetNumObjects() == 0) {
+    snapshot.Finalize();
+    return Status("no malloc heap found in the process");
+  }
+
+  const addr_t heap_low = snapshot.m_addrs.front();
+  const addr_t heap_high = snapshot.m_addrs.back() + snapshot.m_sizes.back();
+
+  // Name objects after their dynamic type if their first word points into
+  // a vtable.
+  Target &target = process.GetTarget();
+  llvm::DenseMap<addr_t, uint32_t> vtable_types;
+  auto get_vtable_type = [&](addr_t value) -> uint32_t {
+    auto range = std::upper_bound(
+        const_ranges.begin(), const_ranges.end(),
+        std::make_pair(value, LLDB_INVALID_ADDRESS));
+    if (range == const_ranges.begin() || value >= std::prev(range)->second)
+      return 0;
+    auto pos = vtable_types.find(value);
+    if (pos != vtable_types.end())
+      return pos->second;
+    uint32_t type = 0;
+    Address so_addr;
+    if (target.ResolveLoadAddress(value, so_addr)) {
+      if (Symbol *symbol = so_addr.CalculateSymbolContextSymbol()) {
+        llvm::StringRef name = symbol->GetName().GetStringRef();
+        if (name.consume_front("vtable for "))
+          type = snapshot.GetTypeIndex(name);
+      }
+    }
+    vtable_types[value] = type;
+    return type;
+  };
+
+  // Scan all the writable memory for pointers into the heap.
+  ProcessSP process_sp = process.shared_from_this();
+  DataExtractor word_data;
+  for (size_t i = 0; i < regions.size(); ++i) {
+    const MemoryRegionInfo &region = *regions[i];
+    if (!IsScannable(region))
+      continue;
+    const bool in_heap = is_heap_region[i];
+
+    MemoryChunkReader chunk_reader(process_sp, region.GetRange().GetRangeBase(),
+                                   region.GetRange().GetRangeEnd());
+    addr_t chunk_addr, fresh_addr;
+    llvm::ArrayRef<uint8_t> chunk;
+    uint32_t source = kInvalidIndex;
+    while (chunk_reader.ReadNextChunk(chunk_addr, chunk, fresh_addr)) {
+      word_data.SetData(chunk.data(), chunk.size(), process.GetByteOrder());
+      word_data.SetAddressByteSize(word_size);
+      lldb::offset_t offset = (word_size - chunk_addr % word_size) % word_size;
+      for (; offset + word_size <= chunk.size(); offset += word_size) {
+        const addr_t addr = chunk_addr + offset;
+        lldb::offset_t value_offset = offset;
+        const uint64_t value = word_data.GetMaxU64(&value_offset, word_size);
+
+        if (in_heap) {
+          if (source == kInvalidIndex ||
+              addr - snapshot.m_addrs[source] >= snapshot.m_sizes[source])
+            source = snapshot.FindObjectContaining(addr);
+          if (source == kInvalidIndex)
+            continue;
+          if (addr == snapshot.m_addrs[source] && value % word_size == 0)
+            snapshot.m_types[source] = get_vtable_type(value);
+        }
+
+        if (value < heap_low || value >= heap_high)
+          continue;
+        const uint32_t target_idx = snapshot.FindObjectContaining(value);
+        if (target_idx == kInvalidIndex)
+          continue;
+        if (in_heap)
+          snapshot.AddReference(source, target_idx);
+        else
+          snapshot.SetIsRoot(target_idx);
+      }
+    }
+  }
+
+  snapshot.Finalize();
+  return Status();
+}
@@ -26,8 +26,8 @@ using namespace lldb_private;
 // MemoryCache constructor
 //----------------------------------------------------------------------
 MemoryCache::MemoryCache(Process &process)
-    : m_mutex(), m_L1_cache(), m_L2_cache(), m_invalid_ranges(),
-      m_process(process),
+    : m_mutex(), m_L1_cache(), m_L2_cache(), m_L1_cache_byte_size(0),
+      m_invalid_ranges(), m_process(process),
       m_L2_cache_line_byte_size(process.GetMemoryCacheLineSize()) {}
 
 //----------------------------------------------------------------------
@@ -39,6 +39,7 @@ void MemoryCache::Clear(bool clear_invalid_ranges) {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
   m_L1_cache.clear();
   m_L2_cache.clear();
+  m_L1_cache_byte_size = 0;
   if (clear_invalid_ranges)
     m_invalid_ranges.Clear();
   m_L2_cache_line_byte_size = m_process.GetMemoryCacheLineSize();
@@ -53,7 +54,17 @@ void MemoryCache::AddL1CacheData(lldb::addr_t addr, const void *src,
 void MemoryCache::AddL1CacheData(lldb::addr_t addr,
                                  const DataBufferSP &data_buffer_sp) {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
-  m_L1_cache[addr] = data_buffer_sp;
+  DataBufferSP &entry = m_L1_cache[addr];
+  if (entry)
+    m_L1_cache_byte_size -= entry->GetByteSize();
+  entry = data_buffer_sp;
+  if (entry)
+    m_L1_cache_byte_size += entry->GetByteSize();
+}
+
+size_t MemoryCache::GetMemorySize() {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  return m_L1_cache_byte_size + m_L2_cache.size() * m_L2_cache_line_byte_size;
 }
 
 void MemoryCache::Flush(addr_t addr, size_t size) {
@@ -73,6 +84,7 @@ void MemoryCache::Flush(addr_t addr, size_t size) {
       AddrRange chunk_range(pos->first, pos->second->GetByteSize());
       if (!chunk_range.DoesIntersect(flush_range))
         break;
+      m_L1_cache_byte_size -= pos->second->GetByteSize();
       pos = m_L1_cache.erase(pos);
     }
   }
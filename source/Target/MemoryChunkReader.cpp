@@ -0,0 +1,127 @@
+//===-- MemoryChunkReader.cpp -----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// C Includes
+// C++ Includes
+#include <algorithm>
+
+// Other libraries and framework includes
+// Project includes
+#include "lldb/Host/TaskPool.h"
+#include "lldb/Target/MemoryChunkReader.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Utility/Status.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+MemoryChunkReader::MemoryChunkReader(const ProcessSP &process_sp, addr_t low,
+                                     addr_t high, size_t chunk_size,
+                                     size_t overlap)
+    : m_process_sp(process_sp), m_next_addr(low), m_high_addr(high),
+      m_chunk_size(std::max<size_t>(chunk_size, 1)), m_overlap(overlap),
+      m_region(), m_use_region_info(true), m_pending(), m_buffer(),
+      m_buffer_addr(LLDB_INVALID_ADDRESS), m_bytes_read(0),
+      m_bytes_skipped(0) {
+  if (m_process_sp)
+    StartNextRead();
+}
+
+MemoryChunkReader::~MemoryChunkReader() {
+  // Don't leave a read in flight once the caller is done with the range.
+  if (m_pending.valid())
+    m_pending.wait();
+}
+
+MemoryChunkReader::Chunk MemoryChunkReader::ReadChunk(ProcessSP process_sp,
+                                                      addr_t addr,
+                                                      size_t size) {
+  Chunk chunk;
+  chunk.addr = addr;
+  chunk.requested_size = size;
+  chunk.bytes.resize(size);
+  Status error;
+  const size_t bytes_read =
+      process_sp->ReadMemory(addr, chunk.bytes.data(), size, error);
+  chunk.bytes.resize(bytes_read);
+  return chunk;
+}
+
+bool MemoryChunkReader::GetNextReadRange(addr_t &addr, size_t &size) {
+  while (m_next_addr < m_high_addr) {
+    addr_t end = m_next_addr + std::min<addr_t>(m_chunk_size,
+                                                m_high_addr - m_next_addr);
+    if (m_use_region_info && !m_region.GetRange().Contains(m_next_addr)) {
+      // Not every process plugin can describe its memory regions; just try
+      // to read everything in that case.
+      if (m_process_sp->GetMemoryRegionInfo(m_next_addr, m_region).Fail())
+        m_use_region_info = false;
+    }
+    if (m_use_region_info && m_region.GetRange().Contains(m_next_addr)) {
+      const addr_t region_end = m_region.GetRange().GetRangeEnd();
+      if (m_region.GetReadable() == MemoryRegionInfo::eNo) {
+        const addr_t skip_end = std::min(region_end, m_high_addr);
+        m_bytes_skipped += skip_end - m_next_addr;
+        m_next_addr = skip_end;
+        continue;
+      }
+      end = std::min(end, region_end);
+    }
+    addr = m_next_addr;
+    size = end - m_next_addr;
+    m_next_addr = end;
+    return true;
+  }
+  return false;
+}
+
+void MemoryChunkReader::StartNextRead() {
+  addr_t addr;
+  size_t size;
+  if (GetNextReadRange(addr, size))
+    m_pending = TaskPool::AddTask(&MemoryChunkReader::ReadChunk, m_process_sp,
+                                  addr, size);
+  else
+    m_pending = std::future<Chunk>();
+}
+
+bool MemoryChunkReader::ReadNextChunk(addr_t &addr,
+                                      llvm::ArrayRef<uint8_t> &data,
+                                      addr_t &fresh_addr) {
+  while (m_pending.valid()) {
+    Chunk chunk = m_pending.get();
+    // Get the following read going before handing this chunk out.
+    StartNextRead();
+
+    m_bytes_read += chunk.bytes.size();
+    m_bytes_skipped += chunk.requested_size - chunk.bytes.size();
+    if (chunk.bytes.empty())
+      continue;
+
+    // Carry the tail of the previous chunk over if the two are contiguous.
+    size_t keep = 0;
+    if (m_overlap > 0 && m_buffer_addr != LLDB_INVALID_ADDRESS &&
+        m_buffer_addr + m_buffer.size() == chunk.addr)
+      keep = std::min(m_overlap, m_buffer.size());
+    if (keep > 0) {
+      std::copy(m_buffer.end() - keep, m_buffer.end(), m_buffer.begin());
+      m_buffer.resize(keep);
+      m_buffer.insert(m_buffer.end(), chunk.bytes.begin(), chunk.bytes.end());
+    } else {
+      m_buffer.swap(chunk.bytes);
+    }
+    m_buffer_addr = chunk.addr - keep;
+
+    addr = m_buffer_addr;
+    data = m_buffer;
+    fresh_addr = chunk.addr;
+    return true;
+  }
+  return false;
+}
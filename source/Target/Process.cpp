@@ -23,6 +23,7 @@
 #include "lldb/Core/Debugger.h"
 #include "lldb/Core/Event.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Core/ModuleList.h"
 #include "lldb/Core/ModuleSpec.h"
 #include "lldb/Core/PluginManager.h"
 #include "lldb/Core/State.h"
@@ -748,6 +749,7 @@ Process::Process(lldb::TargetSP target_sp, ListenerSP listener_sp,
       m_should_detach(false), m_next_event_action_ap(), m_public_run_lock(),
       m_private_run_lock(), m_finalizing(false), m_finalize_called(false),
       m_clear_thread_plans_on_stop(false), m_force_next_event_delivery(false),
+      m_base_direction(eRunForward),
       m_last_broadcast_state(eStateInvalid), m_destroy_in_process(false),
       m_can_interpret_function_calls(false), m_warnings_issued(),
       m_run_thread_plan_lock(), m_can_jit(eCanJITDontKnow) {
@@ -1161,6 +1163,7 @@ bool Process::HandleProcessStateChangedEvent(const EventSP &event_sp,
             case eStopReasonExec:
             case eStopReasonThreadExiting:
             case eStopReasonInstrumentation:
+            case eStopReasonHistoryBoundary:
               if (!other_thread)
                 other_thread = thread;
               break;
@@ -3269,6 +3272,7 @@ Status Process::PrivateResume() {
   UpdateAutomaticSignalFiltering();
 
   Status error(WillResume());
+  RunDirection direction = eRunForward;
   // Tell the process it is about to resume before the thread list
   if (error.Success()) {
     // Now let the thread list know we are about to resume so it can let all of
@@ -3283,9 +3287,9 @@ Status Process::PrivateResume() {
       if (!RunPreResumeActions()) {
         error.SetErrorStringWithFormat(
             "Process::PrivateResume PreResumeActions failed, not resuming.");
-      } else {
+      } else if (GetResumeDirection(direction, error)) {
         m_mod_id.BumpResumeID();
-        error = DoResume();
+        error = DoResume(direction);
         if (error.Success()) {
           DidResume();
           m_thread_list.DidResume();
@@ -3311,6 +3315,27 @@ Status Process::PrivateResume() {
   return error;
 }
 
+bool Process::GetResumeDirection(RunDirection &direction, Status &error) {
+  // The threads with plans of their own run the way these plans want, the
+  // others in the base direction.
+  direction = m_base_direction;
+  bool plan_has_direction = false;
+  for (ThreadSP thread_sp : m_thread_list.Threads()) {
+    if (thread_sp->GetTemporaryResumeState() == eStateSuspended)
+      continue;
+    ThreadPlan *plan = thread_sp->GetCurrentPlan();
+    if (!plan || plan->IsBasePlan())
+      continue;
+    if (plan_has_direction && plan->GetDirection() != direction) {
+      error.SetErrorString("threads can't run forward and backward at once");
+      return false;
+    }
+    direction = plan->GetDirection();
+    plan_has_direction = true;
+  }
+  return true;
+}
+
 Status Process::Halt(bool clear_thread_plans, bool use_run_lock) {
   if (!StateIsRunningState(m_public_state.GetValue()))
     return Status("Process is not running.");
@@ -4260,6 +4285,8 @@ void Process::ProcessEventData::DoOnRemoval(Event *event_ptr) {
         process_sp->GetTarget().RunStopHooks();
         if (process_sp->GetPrivateState() == eStateRunning)
           SetRestarted(true);
+        else
+          process_sp->GetTarget().GetImages().EnforceDebugInfoMemoryBudget();
       }
     }
   }
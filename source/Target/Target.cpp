@@ -2060,6 +2060,15 @@ void Target::ImageSearchPathsChanged(const PathMappingList &path_list,
     target->SetExecutableModule(exe_module_sp, true);
 }
 
+size_t Target::GetScratchTypeSystemsMemorySize() {
+  size_t size = 0;
+  m_scratch_type_system_map.ForEach([&size](TypeSystem *type_system) {
+    size += type_system->MemorySize();
+    return true;
+  });
+  return size;
+}
+
 TypeSystem *Target::GetScratchTypeSystemForLanguage(Status *error,
                                                     lldb::LanguageType language,
                                                     bool create_on_demand) {
@@ -3390,6 +3399,10 @@ static PropertyDefinition g_properties[] = {
      nullptr, "Automatically apply fix-it hints to expressions."},
     {"notify-about-fixits", OptionValue::eTypeBoolean, false, true, nullptr,
      nullptr, "Print the fixed expression text."},
+    {"prefetch-expression-types", OptionValue::eTypeBoolean, false, false,
+     nullptr, nullptr,
+     "Before parsing an expression, look up the types named in it and read "
+     "their debug information in parallel."},
     {"save-jit-objects", OptionValue::eTypeBoolean, false, false, nullptr,
      nullptr, "Save intermediate object files generated by the LLVM JIT"},
     {"max-children-count", OptionValue::eTypeSInt64, false, 256, nullptr,
@@ -3429,6 +3442,11 @@ static PropertyDefinition g_properties[] = {
               "loses connection with lldb."},
     {"preload-symbols", OptionValue::eTypeBoolean, false, true, nullptr, nullptr,
      "Enable loading of symbol tables before they are needed."},
+    {"parallel-module-load", OptionValue::eTypeBoolean, false, true, nullptr,
+     nullptr,
+     "Locate, parse and set up the symbol files of the shared libraries a "
+     "process has loaded in parallel when the dynamic loader finds several "
+     "at once."},
     {"disable-aslr", OptionValue::eTypeBoolean, false, true, nullptr, nullptr,
      "Disable Address Space Layout Randomization (ASLR)"},
     {"disable-stdio", OptionValue::eTypeBoolean, false, false, nullptr, nullptr,
@@ -3518,6 +3536,7 @@ enum {
   ePropertyAutoImportClangModules,
   ePropertyAutoApplyFixIts,
   ePropertyNotifyAboutFixIts,
+  ePropertyPrefetchExpressionTypes,
   ePropertySaveObjects,
   ePropertyMaxChildrenCount,
   ePropertyMaxSummaryLength,
@@ -3532,6 +3551,7 @@ enum {
   ePropertyErrorPath,
   ePropertyDetachOnError,
   ePropertyPreloadSymbols,
+  ePropertyParallelModuleLoad,
   ePropertyDisableASLR,
   ePropertyDisableSTDIO,
   ePropertyInlineStrategy,
@@ -3801,6 +3821,12 @@ void TargetProperties::SetPreloadSymbols(bool b) {
   m_collection_sp->SetPropertyAtIndexAsBoolean(nullptr, idx, b);
 }
 
+bool TargetProperties::GetParallelModuleLoad() const {
+  const uint32_t idx = ePropertyParallelModuleLoad;
+  return m_collection_sp->GetPropertyAtIndexAsBoolean(
+      nullptr, idx, g_properties[idx].default_uint_value != 0);
+}
+
 bool TargetProperties::GetDisableASLR() const {
   const uint32_t idx = ePropertyDisableASLR;
   return m_collection_sp->GetPropertyAtIndexAsBoolean(
@@ -3949,6 +3975,12 @@ bool TargetProperties::GetEnableNotifyAboutFixIts() const {
       nullptr, idx, g_properties[idx].default_uint_value != 0);
 }
 
+bool TargetProperties::GetPrefetchExpressionTypes() const {
+  const uint32_t idx = ePropertyPrefetchExpressionTypes;
+  return m_collection_sp->GetPropertyAtIndexAsBoolean(
+      nullptr, idx, g_properties[idx].default_uint_value != 0);
+}
+
 bool TargetProperties::GetEnableSaveObjects() const {
   const uint32_t idx = ePropertySaveObjects;
   return m_collection_sp->GetPropertyAtIndexAsBoolean(
@@ -38,6 +38,7 @@
 #include "lldb/Target/ThreadPlanCallFunction.h"
 #include "lldb/Target/ThreadPlanPython.h"
 #include "lldb/Target/ThreadPlanRunToAddress.h"
+#include "lldb/Target/ThreadPlanReverseStepOut.h"
 #include "lldb/Target/ThreadPlanStepInRange.h"
 #include "lldb/Target/ThreadPlanStepInstruction.h"
 #include "lldb/Target/ThreadPlanStepOut.h"
@@ -608,7 +609,10 @@ void Thread::SetupForResume() {
       const addr_t thread_pc = reg_ctx_sp->GetPC();
       BreakpointSiteSP bp_site_sp =
           GetProcess()->GetBreakpointSiteList().FindByAddress(thread_pc);
-      if (bp_site_sp) {
+      // Running backward leaves the breakpoint behind, there is nothing to
+      // step over. Some processes step over breakpoints on their own.
+      if (bp_site_sp && GetCurrentPlan()->GetDirection() == eRunForward &&
+          !GetProcess()->StepsOverBreakpointSite(*bp_site_sp)) {
         // Note, don't assume there's a ThreadPlanStepOverBreakpoint, the
         // target may not require anything special to step over a breakpoint.
 
@@ -1340,9 +1344,11 @@ ThreadPlanSP Thread::QueueFundamentalPlan(bool abort_other_plans) {
 }
 
 ThreadPlanSP Thread::QueueThreadPlanForStepSingleInstruction(
-    bool step_over, bool abort_other_plans, bool stop_other_threads) {
+    bool step_over, bool abort_other_plans, bool stop_other_threads,
+    RunDirection direction) {
   ThreadPlanSP thread_plan_sp(new ThreadPlanStepInstruction(
-      *this, step_over, stop_other_threads, eVoteNoOpinion, eVoteNoOpinion));
+      *this, step_over, stop_other_threads, eVoteNoOpinion, eVoteNoOpinion,
+      direction));
   QueueThreadPlan(thread_plan_sp, abort_other_plans);
   return thread_plan_sp;
 }
@@ -1422,6 +1428,21 @@ ThreadPlanSP Thread::QueueThreadPlanForStepOut(
   }
 }
 
+ThreadPlanSP Thread::QueueThreadPlanForReverseStepOut(bool abort_other_plans,
+                                                      bool stop_other_threads,
+                                                      Vote stop_vote,
+                                                      Vote run_vote) {
+  ThreadPlanSP thread_plan_sp(new ThreadPlanReverseStepOut(
+      *this, stop_other_threads, stop_vote, run_vote));
+
+  if (thread_plan_sp->ValidatePlan(nullptr)) {
+    QueueThreadPlan(thread_plan_sp, abort_other_plans);
+    return thread_plan_sp;
+  } else {
+    return ThreadPlanSP();
+  }
+}
+
 ThreadPlanSP Thread::QueueThreadPlanForStepOutNoShouldStop(
     bool abort_other_plans, SymbolContext *addr_context, bool first_insn,
     bool stop_other_threads, Vote stop_vote, Vote run_vote, uint32_t frame_idx,
@@ -1862,6 +1883,8 @@ const char *Thread::StopReasonAsCString(lldb::StopReason reason) {
     return "thread exiting";
   case eStopReasonInstrumentation:
     return "instrumentation break";
+  case eStopReasonHistoryBoundary:
+    return "history boundary";
   }
 
   static char unknown_state_string[64];
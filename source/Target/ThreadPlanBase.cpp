@@ -152,6 +152,17 @@ bool ThreadPlanBase::ShouldStop(Event *event_ptr) {
       m_thread.DiscardThreadPlans(false);
       return true;
 
+    case eStopReasonHistoryBoundary:
+      // Running in reverse can't go any further, so whatever the plans were
+      // doing can't be completed.
+      if (log)
+        log->Printf(
+            "Base plan discarding thread plans for thread tid = 0x%4.4" PRIx64
+            " (history boundary.)",
+            m_thread.GetID());
+      m_thread.DiscardThreadPlans(false);
+      return true;
+
     case eStopReasonThreadExiting:
     case eStopReasonSignal:
       if (stop_info_sp->ShouldStop(event_ptr)) {
@@ -189,6 +200,10 @@ bool ThreadPlanBase::StopOthers() { return false; }
 
 StateType ThreadPlanBase::GetPlanRunState() { return eStateRunning; }
 
+RunDirection ThreadPlanBase::GetDirection() {
+  return m_thread.GetProcess()->GetBaseDirection();
+}
+
 bool ThreadPlanBase::WillStop() { return true; }
 
 bool ThreadPlanBase::DoWillResume(lldb::StateType resume_state,
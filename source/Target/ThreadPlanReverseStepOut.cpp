@@ -0,0 +1,203 @@
+//===-- ThreadPlanReverseStepOut.cpp ----------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// C Includes
+// C++ Includes
+// Other libraries and framework includes
+// Project includes
+#include "lldb/Target/ThreadPlanReverseStepOut.h"
+#include "lldb/Breakpoint/Breakpoint.h"
+#include "lldb/Symbol/Function.h"
+#include "lldb/Symbol/Symbol.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Target/RegisterContext.h"
+#include "lldb/Target/StopInfo.h"
+#include "lldb/Target/Target.h"
+#include "lldb/Utility/Log.h"
+#include "lldb/Utility/Stream.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+//----------------------------------------------------------------------
+// ThreadPlanReverseStepOut: Step backward out of the current function
+//----------------------------------------------------------------------
+
+ThreadPlanReverseStepOut::ThreadPlanReverseStepOut(Thread &thread,
+                                                   bool stop_others,
+                                                   Vote stop_vote,
+                                                   Vote run_vote)
+    : ThreadPlan(ThreadPlan::eKindReverseStepOut, "Reverse step out", thread,
+                 stop_vote, run_vote),
+      m_stop_others(stop_others), m_step_from_insn(LLDB_INVALID_ADDRESS),
+      m_entry_addr(LLDB_INVALID_ADDRESS), m_cfa(LLDB_INVALID_ADDRESS),
+      m_entry_bp_id(LLDB_INVALID_BREAK_ID) {
+  StackFrameSP frame_sp(m_thread.GetStackFrameAtIndex(0));
+  if (!frame_sp)
+    return;
+
+  Target &target = GetTarget();
+  m_step_from_insn = m_thread.GetRegisterContext()->GetPC();
+  m_cfa = frame_sp->GetStackID().GetCallFrameAddress();
+
+  // Inlined functions weren't called, so step out of the concrete function
+  // they are inlined into.
+  const SymbolContext &sc =
+      frame_sp->GetSymbolContext(eSymbolContextFunction | eSymbolContextSymbol);
+  if (sc.function)
+    m_entry_addr = sc.function->GetAddressRange()
+                       .GetBaseAddress()
+                       .GetOpcodeLoadAddress(&target);
+  else if (sc.symbol)
+    m_entry_addr = sc.symbol->GetAddressRef().GetOpcodeLoadAddress(&target);
+  if (m_entry_addr == LLDB_INVALID_ADDRESS)
+    return;
+
+  // If we are already at the entry, we only need to step back to the call.
+  if (m_step_from_insn == m_entry_addr)
+    return;
+
+  Breakpoint *entry_bp =
+      target.CreateBreakpoint(m_entry_addr, true, false).get();
+  if (entry_bp != nullptr) {
+    entry_bp->SetThreadID(m_thread.GetID());
+    entry_bp->SetBreakpointKind("reverse-step-out");
+    m_entry_bp_id = entry_bp->GetID();
+  }
+}
+
+ThreadPlanReverseStepOut::~ThreadPlanReverseStepOut() {
+  RemoveEntryBreakpoint();
+}
+
+void ThreadPlanReverseStepOut::DidPush() {
+  if (m_entry_addr != LLDB_INVALID_ADDRESS && m_step_from_insn == m_entry_addr)
+    QueueStepBackPlan();
+}
+
+void ThreadPlanReverseStepOut::GetDescription(Stream *s,
+                                              lldb::DescriptionLevel level) {
+  if (level == lldb::eDescriptionLevelBrief) {
+    s->Printf("reverse step out");
+    return;
+  }
+
+  if (m_step_back_plan_sp) {
+    s->Printf("Stepping back from the function entry to its caller.");
+    return;
+  }
+
+  s->Printf("Stepping backward out from ");
+  Address tmp_address;
+  if (tmp_address.SetLoadAddress(m_step_from_insn, &GetTarget())) {
+    tmp_address.Dump(s, &GetThread(), Address::DumpStyleResolvedDescription,
+                     Address::DumpStyleLoadAddress);
+  } else {
+    s->Printf("address 0x%" PRIx64 "", (uint64_t)m_step_from_insn);
+  }
+  s->Printf(" to the call of the function at 0x%" PRIx64, m_entry_addr);
+  if (level == eDescriptionLevelVerbose)
+    s->Printf(" using breakpoint %d", m_entry_bp_id);
+}
+
+bool ThreadPlanReverseStepOut::ValidatePlan(Stream *error) {
+  if (m_entry_addr == LLDB_INVALID_ADDRESS) {
+    if (error)
+      error->PutCString("Could not find the function to step out of.");
+    return false;
+  }
+  if (m_step_from_insn != m_entry_addr &&
+      m_entry_bp_id == LLDB_INVALID_BREAK_ID) {
+    if (error)
+      error->PutCString("Could not create function entry breakpoint.");
+    return false;
+  }
+  return true;
+}
+
+bool ThreadPlanReverseStepOut::DoPlanExplainsStop(Event *event_ptr) {
+  // Once we are stepping back to the call, the step plan explains the stops.
+  if (m_step_back_plan_sp)
+    return m_step_back_plan_sp->MischiefManaged();
+
+  StopInfoSP stop_info_sp = GetPrivateStopInfo();
+  if (!stop_info_sp)
+    return true;
+
+  StopReason reason = stop_info_sp->GetStopReason();
+  if (reason == eStopReasonBreakpoint) {
+    BreakpointSiteSP site_sp(
+        m_thread.GetProcess()->GetBreakpointSiteList().FindByID(
+            stop_info_sp->GetValue()));
+    // If a user breakpoint is at the function entry too, report it rather
+    // than stepping on.
+    return site_sp && site_sp->IsBreakpointAtThisSite(m_entry_bp_id) &&
+           site_sp->GetNumberOfOwners() == 1;
+  }
+  return !IsUsuallyUnexplainedStopReason(reason);
+}
+
+bool ThreadPlanReverseStepOut::ShouldStop(Event *event_ptr) {
+  if (IsPlanComplete())
+    return true;
+
+  if (m_step_back_plan_sp) {
+    if (!m_step_back_plan_sp->MischiefManaged())
+      return m_step_back_plan_sp->ShouldStop(event_ptr);
+    SetPlanComplete(m_step_back_plan_sp->PlanSucceeded());
+    return true;
+  }
+
+  // A recursive call of the function reaches the entry breakpoint too: keep
+  // running backward until the frame we started from reaches it.
+  if (!AtFrameEntry())
+    return false;
+
+  Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_STEP));
+  if (log)
+    log->Printf("ThreadPlanReverseStepOut reached the function entry at "
+                "0x%" PRIx64 ", stepping back to the call.",
+                m_entry_addr);
+  RemoveEntryBreakpoint();
+  QueueStepBackPlan();
+  return false;
+}
+
+bool ThreadPlanReverseStepOut::MischiefManaged() {
+  if (!IsPlanComplete())
+    return false;
+
+  Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_STEP));
+  if (log)
+    log->Printf("Completed reverse step out plan.");
+  RemoveEntryBreakpoint();
+  ThreadPlan::MischiefManaged();
+  return true;
+}
+
+bool ThreadPlanReverseStepOut::AtFrameEntry() {
+  if (m_thread.GetRegisterContext()->GetPC() != m_entry_addr)
+    return false;
+  StackFrameSP frame_sp(m_thread.GetStackFrameAtIndex(0));
+  return frame_sp && frame_sp->GetStackID().GetCallFrameAddress() == m_cfa;
+}
+
+void ThreadPlanReverseStepOut::QueueStepBackPlan() {
+  m_step_back_plan_sp = m_thread.QueueThreadPlanForStepSingleInstruction(
+      false, false, m_stop_others, eRunReverse);
+  if (m_step_back_plan_sp)
+    m_step_back_plan_sp->SetPrivate(true);
+}
+
+void ThreadPlanReverseStepOut::RemoveEntryBreakpoint() {
+  if (m_entry_bp_id != LLDB_INVALID_BREAK_ID) {
+    m_thread.CalculateTarget()->RemoveBreakpointByID(m_entry_bp_id);
+    m_entry_bp_id = LLDB_INVALID_BREAK_ID;
+  }
+}
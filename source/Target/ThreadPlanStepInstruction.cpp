@@ -31,11 +31,13 @@ ThreadPlanStepInstruction::ThreadPlanStepInstruction(Thread &thread,
                                                      bool step_over,
                                                      bool stop_other_threads,
                                                      Vote stop_vote,
-                                                     Vote run_vote)
+                                                     Vote run_vote,
+                                                     RunDirection direction)
     : ThreadPlan(ThreadPlan::eKindStepInstruction,
                  "Step over single instruction", thread, stop_vote, run_vote),
       m_instruction_addr(0), m_stop_other_threads(stop_other_threads),
-      m_step_over(step_over) {
+      m_step_over(step_over && direction == eRunForward),
+      m_direction(direction) {
   m_takes_iteration_count = true;
   SetUpState();
 }
@@ -58,10 +60,15 @@ void ThreadPlanStepInstruction::SetUpState() {
 void ThreadPlanStepInstruction::GetDescription(Stream *s,
                                                lldb::DescriptionLevel level) {
   if (level == lldb::eDescriptionLevelBrief) {
-    if (m_step_over)
+    if (m_direction == eRunReverse)
+      s->Printf("instruction step back");
+    else if (m_step_over)
       s->Printf("instruction step over");
     else
       s->Printf("instruction step into");
+  } else if (m_direction == eRunReverse) {
+    s->Printf("Stepping back one instruction from ");
+    s->Address(m_instruction_addr, sizeof(addr_t));
   } else {
     s->Printf("Stepping one instruction past ");
     s->Address(m_instruction_addr, sizeof(addr_t));
@@ -91,6 +98,10 @@ bool ThreadPlanStepInstruction::DoPlanExplainsStop(Event *event_ptr) {
 }
 
 bool ThreadPlanStepInstruction::IsPlanStale() {
+  // Stepping back may land anywhere, even at the same pc.
+  if (m_direction == eRunReverse)
+    return false;
+
   Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_STEP));
   StackID cur_frame_id = m_thread.GetStackFrameAtIndex(0)->GetStackID();
   if (cur_frame_id == m_stack_id) {
@@ -119,6 +130,17 @@ bool ThreadPlanStepInstruction::IsPlanStale() {
 }
 
 bool ThreadPlanStepInstruction::ShouldStop(Event *event_ptr) {
+  if (m_direction == eRunReverse) {
+    // Every stop we explain is one instruction back, the previous one may
+    // even be at the same pc.
+    if (--m_iteration_count <= 0) {
+      SetPlanComplete();
+      return true;
+    }
+    SetUpState();
+    return false;
+  }
+
   if (m_step_over) {
     Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_STEP));
 
@@ -407,6 +407,24 @@ StateType ThreadPlanStepRange::GetPlanRunState() {
     return eStateStepping;
 }
 
+bool ThreadPlanStepRange::GetSteppingRange(lldb::addr_t &start,
+                                           lldb::addr_t &end) {
+  if (GetPlanRunState() != eStateStepping)
+    return false;
+
+  // Step through the range the thread is in.
+  lldb::addr_t pc_load_addr = m_thread.GetRegisterContext()->GetPC();
+  Target *target = m_thread.CalculateTarget().get();
+  for (const AddressRange &range : m_address_ranges) {
+    if (range.ContainsLoadAddress(pc_load_addr, target)) {
+      start = range.GetBaseAddress().GetLoadAddress(target);
+      end = start + range.GetByteSize();
+      return start != LLDB_INVALID_ADDRESS;
+    }
+  }
+  return false;
+}
+
 bool ThreadPlanStepRange::MischiefManaged() {
   // If we have pushed some plans between ShouldStop & MischiefManaged, then
   // we're not done...
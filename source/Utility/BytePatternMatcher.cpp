@@ -0,0 +1,129 @@
+//===-- BytePatternMatcher.cpp ----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Utility/BytePatternMatcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace lldb_private;
+
+// Rank how useful a byte value is as a memchr anchor; lower is better. Zero
+// and all-ones bytes are everywhere in typical process memory (padding,
+// pointers' high bytes, cleared buffers), so avoid them whenever the pattern
+// has anything else to offer.
+static unsigned GetAnchorRank(uint8_t byte) {
+  if (byte == 0x00)
+    return 2;
+  if (byte == 0xff)
+    return 1;
+  return 0;
+}
+
+bool BytePatternMatcher::AddPattern(llvm::ArrayRef<uint8_t> bytes,
+                                    llvm::ArrayRef<uint8_t> mask) {
+  if (bytes.empty())
+    return false;
+  if (!mask.empty() && mask.size() != bytes.size())
+    return false;
+
+  Pattern pattern;
+  pattern.bytes = bytes.vec();
+  pattern.anchor = 0;
+  pattern.has_anchor = false;
+  if (std::any_of(mask.begin(), mask.end(),
+                  [](uint8_t m) { return m != 0xff; })) {
+    pattern.mask = mask.vec();
+    // Store the pattern pre-masked so comparisons only need to mask the
+    // memory side.
+    for (size_t i = 0; i < bytes.size(); ++i)
+      pattern.bytes[i] &= pattern.mask[i];
+  }
+
+  unsigned best_rank = UINT32_MAX;
+  for (size_t i = 0; i < pattern.bytes.size(); ++i) {
+    if (!pattern.mask.empty() && pattern.mask[i] != 0xff)
+      continue;
+    const unsigned rank = GetAnchorRank(pattern.bytes[i]);
+    if (rank < best_rank) {
+      best_rank = rank;
+      pattern.anchor = i;
+      pattern.has_anchor = true;
+      if (rank == 0)
+        break;
+    }
+  }
+
+  m_max_size = std::max(m_max_size, pattern.bytes.size());
+  m_patterns.push_back(std::move(pattern));
+  return true;
+}
+
+bool BytePatternMatcher::MatchesAt(const Pattern &pattern,
+                                   const uint8_t *data) const {
+  const size_t size = pattern.bytes.size();
+  if (pattern.mask.empty())
+    return ::memcmp(data, pattern.bytes.data(), size) == 0;
+  for (size_t i = 0; i < size; ++i) {
+    if ((data[i] & pattern.mask[i]) != pattern.bytes[i])
+      return false;
+  }
+  return true;
+}
+
+void BytePatternMatcher::FindPatternMatches(const Pattern &pattern,
+                                            size_t pattern_index,
+                                            llvm::ArrayRef<uint8_t> data,
+                                            lldb::addr_t base_addr,
+                                            std::vector<Match> &matches) const {
+  const size_t size = pattern.bytes.size();
+  if (data.size() < size)
+    return;
+  const uint8_t *begin = data.data();
+  const size_t last_offset = data.size() - size;
+
+  if (!pattern.has_anchor) {
+    // Nothing to anchor on, so try every aligned offset.
+    size_t offset = 0;
+    if (const uint64_t misalignment = base_addr % m_alignment)
+      offset = m_alignment - misalignment;
+    for (; offset <= last_offset; offset += m_alignment) {
+      if (MatchesAt(pattern, begin + offset))
+        matches.push_back({base_addr + offset, pattern_index});
+    }
+    return;
+  }
+
+  const uint8_t anchor_byte = pattern.bytes[pattern.anchor];
+  const uint8_t *search = begin + pattern.anchor;
+  const uint8_t *search_end = begin + last_offset + pattern.anchor + 1;
+  while (search < search_end) {
+    const uint8_t *hit = static_cast<const uint8_t *>(
+        ::memchr(search, anchor_byte, search_end - search));
+    if (hit == nullptr)
+      break;
+    const size_t offset = (hit - begin) - pattern.anchor;
+    if ((base_addr + offset) % m_alignment == 0 &&
+        MatchesAt(pattern, begin + offset))
+      matches.push_back({base_addr + offset, pattern_index});
+    search = hit + 1;
+  }
+}
+
+void BytePatternMatcher::FindMatches(llvm::ArrayRef<uint8_t> data,
+                                     lldb::addr_t base_addr,
+                                     std::vector<Match> &matches) const {
+  const size_t first_new = matches.size();
+  for (size_t i = 0; i < m_patterns.size(); ++i)
+    FindPatternMatches(m_patterns[i], i, data, base_addr, matches);
+  // Each pattern's matches come out in address order already; only the
+  // results of different patterns need to be merged.
+  if (m_patterns.size() > 1)
+    std::sort(matches.begin() + first_new, matches.end());
+}
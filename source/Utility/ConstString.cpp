@@ -168,6 +168,20 @@ public:
     return mem_size;
   }
 
+  ConstString::MemoryStats GetMemoryStats() const {
+    ConstString::MemoryStats stats;
+    for (const auto &pool : m_string_pools) {
+      llvm::sys::SmartScopedReader<false> rlock(pool.m_mutex);
+      const llvm::BumpPtrAllocator &alloc = pool.m_string_map.getAllocator();
+      // The hash table: a pointer and a hash value per bucket.
+      const size_t table_size = pool.m_string_map.getNumBuckets() *
+                                (sizeof(void *) + sizeof(unsigned));
+      stats.bytes_total += alloc.getTotalMemory() + table_size;
+      stats.bytes_used += alloc.getBytesAllocated() + table_size;
+    }
+    return stats;
+  }
+
 protected:
   uint8_t hash(const llvm::StringRef &s) const {
     uint32_t h = llvm::djbHash(s);
@@ -331,6 +345,10 @@ size_t ConstString::StaticMemorySize() {
   return StringPool().MemorySize();
 }
 
+ConstString::MemoryStats ConstString::GetMemoryStats() {
+  return StringPool().GetMemoryStats();
+}
+
 void llvm::format_provider<ConstString>::format(const ConstString &CS,
                                                 llvm::raw_ostream &OS,
                                                 llvm::StringRef Options) {
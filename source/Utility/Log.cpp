@@ -23,9 +23,12 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include <chrono> // for duration, system_clock, syst...
+#include <condition_variable>
 #include <cstdarg>
 #include <mutex>
+#include <thread>
 #include <utility> // for pair
+#include <vector>
 
 #include <assert.h>  // for assert
 #if defined(_WIN32)
@@ -39,6 +42,295 @@ using namespace lldb_private;
 
 llvm::ManagedStatic<Log::ChannelMap> Log::g_channel_map;
 
+static std::atomic<uint32_t> g_sequence_id(0);
+
+// Serializes writes to streams of channels with LLDB_LOG_OPTION_THREADSAFE
+// and the writes of the asynchronous log writer.
+static std::recursive_mutex &GetLogThreadedMutex() {
+  static std::recursive_mutex *g_mutex = new std::recursive_mutex();
+  return *g_mutex;
+}
+
+static void WriteHeaderFields(llvm::raw_ostream &OS, Flags options,
+                              uint32_t sequence_id,
+                              std::chrono::system_clock::time_point time,
+                              uint64_t tid, llvm::StringRef thread_name,
+                              llvm::StringRef backtrace, llvm::StringRef file,
+                              llvm::StringRef function) {
+  // Add a sequence ID if requested
+  if (options.Test(LLDB_LOG_OPTION_PREPEND_SEQUENCE))
+    OS << sequence_id << " ";
+
+  // Timestamp if requested
+  if (options.Test(LLDB_LOG_OPTION_PREPEND_TIMESTAMP)) {
+    auto now = std::chrono::duration<double>(time.time_since_epoch());
+    OS << llvm::formatv("{0:f9} ", now.count());
+  }
+
+  // Add the process and thread if requested
+  if (options.Test(LLDB_LOG_OPTION_PREPEND_PROC_AND_THREAD))
+    OS << llvm::formatv("[{0,0+4}/{1,0+4}] ", getpid(), tid);
+
+  // Add the thread name if requested
+  if (options.Test(LLDB_LOG_OPTION_PREPEND_THREAD_NAME)) {
+    llvm::SmallString<12> format_str;
+    llvm::raw_svector_ostream format_os(format_str);
+    format_os << "{0,-" << llvm::alignTo<16>(thread_name.size()) << "} ";
+    OS << llvm::formatv(format_str.c_str(), thread_name);
+  }
+
+  if (options.Test(LLDB_LOG_OPTION_BACKTRACE))
+    OS << backtrace;
+
+  if (options.Test(LLDB_LOG_OPTION_PREPEND_FILE_FUNCTION) &&
+      (!file.empty() || !function.empty())) {
+    file = llvm::sys::path::filename(file).take_front(40);
+    function = function.take_front(40);
+    OS << llvm::formatv("{0,-60:60} ", (file + ":" + function).str());
+  }
+}
+
+namespace {
+// A message of a channel with LLDB_LOG_OPTION_ASYNC. The message itself is
+// formatted by the thread that logs it, since its arguments don't outlive
+// the call, but the header is formatted by the writer from these fields.
+struct AsyncRecord {
+  std::shared_ptr<llvm::raw_ostream> stream;
+  Flags options;
+  uint32_t sequence_id;
+  std::chrono::system_clock::time_point time;
+  // These come from __FILE__ and __func__.
+  llvm::StringRef file;
+  llvm::StringRef function;
+  std::string backtrace;
+  std::string message;
+};
+
+// The messages logged by one thread, in order. Only that thread pushes and
+// only the writer pops, so the queue needs no locks. When it is full new
+// messages are counted and dropped instead of making the thread wait.
+class AsyncRecordQueue {
+public:
+  static constexpr size_t kCapacity = 4096;
+
+  AsyncRecordQueue() : m_tid(llvm::get_threadid()) {
+    llvm::get_thread_name(m_thread_name);
+  }
+
+  ~AsyncRecordQueue() {
+    while (Pop())
+      ;
+  }
+
+  // Returns the number of messages in the queue, including this one.
+  size_t Push(std::unique_ptr<AsyncRecord> record) {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t size = tail - m_head.load(std::memory_order_acquire);
+    if (size == kCapacity) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return size;
+    }
+    m_records[tail % kCapacity] = record.release();
+    m_tail.store(tail + 1, std::memory_order_release);
+    return size + 1;
+  }
+
+  std::unique_ptr<AsyncRecord> Pop() {
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire))
+      return nullptr;
+    std::unique_ptr<AsyncRecord> record(m_records[head % kCapacity]);
+    m_head.store(head + 1, std::memory_order_release);
+    return record;
+  }
+
+  uint64_t TakeDropped() {
+    return m_dropped.exchange(0, std::memory_order_relaxed);
+  }
+
+  const uint64_t m_tid;
+  llvm::SmallString<32> m_thread_name;
+  // Set when the thread exits; the writer frees the queue once it is empty.
+  std::atomic<bool> m_orphaned{false};
+
+private:
+  std::atomic<size_t> m_head{0};
+  std::atomic<size_t> m_tail{0};
+  std::atomic<uint64_t> m_dropped{0};
+  AsyncRecord *m_records[kCapacity];
+};
+
+// Writes the messages of asynchronous channels on a background thread. It
+// wakes up periodically, when a queue fills up, or when someone is waiting
+// for the messages to be written, and writes out everything that has been
+// logged, flushing each stream once per batch.
+class AsyncLogWriter {
+public:
+  static AsyncLogWriter &Get() {
+    if (AsyncLogWriter *writer = GetIfCreated())
+      return *writer;
+    // Writers are leaked, since the thread may still be running at exit.
+    AsyncLogWriter *writer = new AsyncLogWriter();
+    AsyncLogWriter *expected = nullptr;
+    if (!g_created_writer.compare_exchange_strong(expected, writer)) {
+      delete writer;
+      return *expected;
+    }
+    std::thread(&AsyncLogWriter::Run, writer).detach();
+    return *writer;
+  }
+
+  static AsyncLogWriter *GetIfCreated() {
+    return g_created_writer.load(std::memory_order_acquire);
+  }
+
+  // A forked child has no writer thread, and the writer's locks may be held
+  // by threads that don't exist in it either. The child leaves the writer
+  // behind, along with the messages that the parent will write, and starts
+  // a new one if it logs asynchronously again.
+  static void ForgetAfterFork() { g_created_writer.store(nullptr); }
+
+  void Push(std::unique_ptr<AsyncRecord> record) {
+    if (GetQueueForCurrentThread().Push(std::move(record)) >=
+        AsyncRecordQueue::kCapacity / 4)
+      Wake();
+  }
+
+  // Wait until the messages that were pushed before the call are written.
+  void Flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const uint64_t ticket = ++m_flush_requested;
+    m_wake_cv.notify_one();
+    m_flushed_cv.wait(lock, [&] { return m_flush_completed >= ticket; });
+  }
+
+private:
+  static constexpr std::chrono::milliseconds kWritePeriod{20};
+
+  AsyncRecordQueue &GetQueueForCurrentThread() {
+    struct QueueHolder {
+      AsyncLogWriter *writer = nullptr;
+      AsyncRecordQueue *queue = nullptr;
+      ~QueueHolder() {
+        if (queue)
+          queue->m_orphaned.store(true, std::memory_order_release);
+      }
+    };
+    static thread_local QueueHolder g_holder;
+    // After a fork the forking thread's queue belongs to the old writer.
+    if (g_holder.writer != this) {
+      auto queue = llvm::make_unique<AsyncRecordQueue>();
+      g_holder.writer = this;
+      g_holder.queue = queue.get();
+      std::lock_guard<std::mutex> lock(m_queues_mutex);
+      m_queues.push_back(std::move(queue));
+    }
+    return *g_holder.queue;
+  }
+
+  void Wake() {
+    if (!m_wake.exchange(true, std::memory_order_relaxed))
+      m_wake_cv.notify_one();
+  }
+
+  void Run() {
+    llvm::set_thread_name("lldb.log.writer");
+    while (true) {
+      uint64_t ticket;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake_cv.wait_for(lock, kWritePeriod, [&] {
+          return m_wake.load(std::memory_order_relaxed) ||
+                 m_flush_requested != m_flush_completed;
+        });
+        m_wake.store(false, std::memory_order_relaxed);
+        ticket = m_flush_requested;
+      }
+      WriteAll();
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_flush_completed = ticket;
+      }
+      m_flushed_cv.notify_all();
+    }
+  }
+
+  void WriteAll() {
+    std::vector<AsyncRecordQueue *> queues;
+    std::vector<AsyncRecordQueue *> orphaned;
+    {
+      std::lock_guard<std::mutex> lock(m_queues_mutex);
+      for (const auto &queue : m_queues) {
+        queues.push_back(queue.get());
+        // Everything an exited thread logged is visible once we see the
+        // flag, so the queue can go after this pass.
+        if (queue->m_orphaned.load(std::memory_order_acquire))
+          orphaned.push_back(queue.get());
+      }
+    }
+
+    std::vector<std::shared_ptr<llvm::raw_ostream>> streams;
+    {
+      std::lock_guard<std::recursive_mutex> guard(GetLogThreadedMutex());
+      for (AsyncRecordQueue *queue : queues)
+        WriteQueue(*queue, streams);
+      for (const auto &stream_sp : streams)
+        stream_sp->flush();
+    }
+
+    if (!orphaned.empty()) {
+      std::lock_guard<std::mutex> lock(m_queues_mutex);
+      m_queues.erase(
+          std::remove_if(m_queues.begin(), m_queues.end(),
+                         [&](const std::unique_ptr<AsyncRecordQueue> &queue) {
+                           return llvm::is_contained(orphaned, queue.get());
+                         }),
+          m_queues.end());
+    }
+  }
+
+  void WriteQueue(AsyncRecordQueue &queue,
+                  std::vector<std::shared_ptr<llvm::raw_ostream>> &streams) {
+    std::shared_ptr<llvm::raw_ostream> last_stream_sp;
+    while (std::unique_ptr<AsyncRecord> record = queue.Pop()) {
+      llvm::raw_ostream &OS = *record->stream;
+      WriteHeaderFields(OS, record->options, record->sequence_id,
+                        record->time, queue.m_tid, queue.m_thread_name,
+                        record->backtrace, record->file, record->function);
+      OS << record->message;
+      if (record->stream != last_stream_sp) {
+        last_stream_sp = std::move(record->stream);
+        if (!llvm::is_contained(streams, last_stream_sp))
+          streams.push_back(last_stream_sp);
+      }
+    }
+
+    if (uint64_t dropped = queue.TakeDropped()) {
+      if (last_stream_sp)
+        *last_stream_sp << llvm::formatv(
+            "[{0} log messages from thread {1} were dropped]\n", dropped,
+            queue.m_tid);
+    }
+  }
+
+  static std::atomic<AsyncLogWriter *> g_created_writer;
+
+  std::mutex m_queues_mutex;
+  std::vector<std::unique_ptr<AsyncRecordQueue>> m_queues;
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake_cv;
+  std::condition_variable m_flushed_cv;
+  std::atomic<bool> m_wake{false};
+  uint64_t m_flush_requested = 0;
+  uint64_t m_flush_completed = 0;
+};
+
+constexpr size_t AsyncRecordQueue::kCapacity;
+constexpr std::chrono::milliseconds AsyncLogWriter::kWritePeriod;
+std::atomic<AsyncLogWriter *> AsyncLogWriter::g_created_writer;
+} // namespace
+
 void Log::ListCategories(llvm::raw_ostream &stream, const ChannelMap::value_type &entry) {
   stream << llvm::formatv("Logging categories for '{0}':\n", entry.first());
   stream << "  all - all available logging categories\n";
@@ -126,6 +418,14 @@ void Log::Printf(const char *format, ...) {
 // file handle, we also log to the file.
 //----------------------------------------------------------------------
 void Log::VAPrintf(const char *format, va_list args) {
+  Flags options = GetOptions();
+  if (options.Test(LLDB_LOG_OPTION_ASYNC)) {
+    llvm::SmallString<64> Content;
+    lldb_private::VASprintf(Content, format, args);
+    WriteMessageAsync(options, "", "", (Content + "\n").str());
+    return;
+  }
+
   llvm::SmallString<64> FinalMessage;
   llvm::raw_svector_ostream Stream(FinalMessage);
   WriteHeader(Stream, "", "");
@@ -229,6 +529,7 @@ bool Log::DisableLogChannel(llvm::StringRef channel,
                        ? UINT32_MAX
                        : GetFlags(error_stream, *iter, categories);
   iter->second.Disable(flags);
+  FlushAsyncMessages();
   return true;
 }
 
@@ -246,6 +547,7 @@ bool Log::ListChannelCategories(llvm::StringRef channel,
 void Log::DisableAllLogChannels() {
   for (auto &entry : *g_channel_map)
     entry.second.Disable(UINT32_MAX);
+  FlushAsyncMessages();
 }
 
 void Log::ListAllLogChannels(llvm::raw_ostream &stream) {
@@ -265,43 +567,23 @@ bool Log::GetVerbose() const {
 void Log::WriteHeader(llvm::raw_ostream &OS, llvm::StringRef file,
                       llvm::StringRef function) {
   Flags options = GetOptions();
-  static uint32_t g_sequence_id = 0;
-  // Add a sequence ID if requested
+  uint32_t sequence_id = 0;
   if (options.Test(LLDB_LOG_OPTION_PREPEND_SEQUENCE))
-    OS << ++g_sequence_id << " ";
-
-  // Timestamp if requested
-  if (options.Test(LLDB_LOG_OPTION_PREPEND_TIMESTAMP)) {
-    auto now = std::chrono::duration<double>(
-        std::chrono::system_clock::now().time_since_epoch());
-    OS << llvm::formatv("{0:f9} ", now.count());
-  }
+    sequence_id = ++g_sequence_id;
 
-  // Add the process and thread if requested
-  if (options.Test(LLDB_LOG_OPTION_PREPEND_PROC_AND_THREAD))
-    OS << llvm::formatv("[{0,0+4}/{1,0+4}] ", getpid(),
-                        llvm::get_threadid());
-
-  // Add the thread name if requested
-  if (options.Test(LLDB_LOG_OPTION_PREPEND_THREAD_NAME)) {
-    llvm::SmallString<32> thread_name;
+  llvm::SmallString<32> thread_name;
+  if (options.Test(LLDB_LOG_OPTION_PREPEND_THREAD_NAME))
     llvm::get_thread_name(thread_name);
 
-    llvm::SmallString<12> format_str;
-    llvm::raw_svector_ostream format_os(format_str);
-    format_os << "{0,-" << llvm::alignTo<16>(thread_name.size()) << "} ";
-    OS << llvm::formatv(format_str.c_str(), thread_name);
+  std::string backtrace;
+  if (options.Test(LLDB_LOG_OPTION_BACKTRACE)) {
+    llvm::raw_string_ostream backtrace_os(backtrace);
+    llvm::sys::PrintStackTrace(backtrace_os);
   }
 
-  if (options.Test(LLDB_LOG_OPTION_BACKTRACE))
-    llvm::sys::PrintStackTrace(OS);
-
-  if (options.Test(LLDB_LOG_OPTION_PREPEND_FILE_FUNCTION) &&
-      (!file.empty() || !function.empty())) {
-    file = llvm::sys::path::filename(file).take_front(40);
-    function = function.take_front(40);
-    OS << llvm::formatv("{0,-60:60} ", (file + ":" + function).str());
-  }
+  WriteHeaderFields(OS, options, sequence_id, std::chrono::system_clock::now(),
+                    llvm::get_threadid(), thread_name, backtrace, file,
+                    function);
 }
 
 void Log::WriteMessage(const std::string &message) {
@@ -313,8 +595,7 @@ void Log::WriteMessage(const std::string &message) {
 
   Flags options = GetOptions();
   if (options.Test(LLDB_LOG_OPTION_THREADSAFE)) {
-    static std::recursive_mutex g_LogThreadedMutex;
-    std::lock_guard<std::recursive_mutex> guard(g_LogThreadedMutex);
+    std::lock_guard<std::recursive_mutex> guard(GetLogThreadedMutex());
     *stream_sp << message;
     stream_sp->flush();
   } else {
@@ -323,8 +604,38 @@ void Log::WriteMessage(const std::string &message) {
   }
 }
 
+void Log::WriteMessageAsync(Flags options, llvm::StringRef file,
+                            llvm::StringRef function, std::string message) {
+  auto record = llvm::make_unique<AsyncRecord>();
+  record->stream = GetStream();
+  if (!record->stream)
+    return;
+
+  record->options = options;
+  if (options.Test(LLDB_LOG_OPTION_PREPEND_SEQUENCE))
+    record->sequence_id = ++g_sequence_id;
+  record->time = std::chrono::system_clock::now();
+  record->file = file;
+  record->function = function;
+  if (options.Test(LLDB_LOG_OPTION_BACKTRACE)) {
+    llvm::raw_string_ostream backtrace_os(record->backtrace);
+    llvm::sys::PrintStackTrace(backtrace_os);
+  }
+  record->message = std::move(message);
+  AsyncLogWriter::Get().Push(std::move(record));
+}
+
 void Log::Format(llvm::StringRef file, llvm::StringRef function,
                  const llvm::formatv_object_base &payload) {
+  Flags options = GetOptions();
+  if (options.Test(LLDB_LOG_OPTION_ASYNC)) {
+    std::string message;
+    llvm::raw_string_ostream message_os(message);
+    message_os << payload << "\n";
+    WriteMessageAsync(options, file, function, std::move(message_os.str()));
+    return;
+  }
+
   std::string message_string;
   llvm::raw_string_ostream message(message_string);
   WriteHeader(message, file, function);
@@ -332,10 +643,16 @@ void Log::Format(llvm::StringRef file, llvm::StringRef function,
   WriteMessage(message.str());
 }
 
+void Log::FlushAsyncMessages() {
+  if (AsyncLogWriter *writer = AsyncLogWriter::GetIfCreated())
+    writer->Flush();
+}
+
 void Log::DisableLoggingChild() {
   // Disable logging by clearing out the atomic variable after forking -- if we
   // forked while another thread held the channel mutex, we would deadlock when
   // trying to write to the log.
   for (auto &c: *g_channel_map)
     c.second.m_channel.log_ptr.store(nullptr, std::memory_order_relaxed);
+  AsyncLogWriter::ForgetAfterFork();
 }
@@ -177,6 +177,8 @@ void RegularExpression::Free() {
   }
 }
 
+int RegularExpression::GetCompileFlags() const { return DEFAULT_COMPILE_FLAGS; }
+
 size_t RegularExpression::GetErrorAsCString(char *err_str,
                                             size_t err_str_max_len) const {
   if (m_comp_err == 0) {
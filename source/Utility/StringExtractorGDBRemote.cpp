@@ -98,6 +98,13 @@ StringExtractorGDBRemote::GetServerPacketType() const {
         return eServerPacketType_QEnvironmentHexEncoded;
       if (PACKET_STARTS_WITH("QEnableErrorStrings"))
         return eServerPacketType_QEnableErrorStrings;
+      if (PACKET_STARTS_WITH("QEnableCompression:"))
+        return eServerPacketType_QEnableCompression;
+      break;
+
+    case 'N':
+      if (PACKET_STARTS_WITH("QNonStop:"))
+        return eServerPacketType_QNonStop;
       break;
 
     case 'P':
@@ -130,6 +137,8 @@ StringExtractorGDBRemote::GetServerPacketType() const {
         return eServerPacketType_QSetMaxPayloadSize;
       if (PACKET_STARTS_WITH("QSetEnableAsyncProfiling;"))
         return eServerPacketType_QSetEnableAsyncProfiling;
+      if (PACKET_STARTS_WITH("QSharedMemoryTransport:"))
+        return eServerPacketType_QSharedMemoryTransport;
       if (PACKET_STARTS_WITH("QSyncThreadState:"))
         return eServerPacketType_QSyncThreadState;
       break;
@@ -142,6 +151,8 @@ StringExtractorGDBRemote::GetServerPacketType() const {
       break;
 
     case 'R':
+      if (PACKET_STARTS_WITH("QRecordHistory:"))
+        return eServerPacketType_QRecordHistory;
       if (PACKET_STARTS_WITH("QRestoreRegisterState:"))
         return eServerPacketType_QRestoreRegisterState;
       break;
@@ -288,6 +299,8 @@ StringExtractorGDBRemote::GetServerPacketType() const {
     case 'X':
       if (PACKET_STARTS_WITH("qXfer:auxv:read::"))
         return eServerPacketType_qXfer_auxv_read;
+      if (PACKET_STARTS_WITH("qXfer:libraries-svr4:read::"))
+        return eServerPacketType_qXfer_libraries_svr4_read;
       break;
     }
     break;
@@ -297,7 +310,7 @@ StringExtractorGDBRemote::GetServerPacketType() const {
       return eServerPacketType_jModulesInfo;
     if (PACKET_MATCHES("jSignalsInfo"))
       return eServerPacketType_jSignalsInfo;
-    if (PACKET_MATCHES("jThreadsInfo"))
+    if (PACKET_MATCHES("jThreadsInfo") || PACKET_STARTS_WITH("jThreadsInfo:"))
       return eServerPacketType_jThreadsInfo;
     if (PACKET_STARTS_WITH("jTraceBufferRead:"))
       return eServerPacketType_jTraceBufferRead;
@@ -349,6 +362,8 @@ StringExtractorGDBRemote::GetServerPacketType() const {
         return eServerPacketType_vCont;
       if (PACKET_MATCHES("vCont?"))
         return eServerPacketType_vCont_actions;
+      if (PACKET_MATCHES("vStopped"))
+        return eServerPacketType_vStopped;
     }
     break;
   case '_':
@@ -366,6 +381,13 @@ StringExtractorGDBRemote::GetServerPacketType() const {
       return eServerPacketType_stop_reason;
     break;
 
+  case 'b':
+    if (PACKET_MATCHES("bc"))
+      return eServerPacketType_bc;
+    if (PACKET_MATCHES("bs"))
+      return eServerPacketType_bs;
+    break;
+
   case 'c':
     return eServerPacketType_c;
 
@@ -9,8 +9,14 @@
 #include "lldb/Utility/Timer.h"
 #include "lldb/Utility/Stream.h"
 
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <utility> // for pair
 #include <vector>
@@ -18,6 +24,7 @@
 #include <assert.h> // for assert
 #include <stdarg.h> // for va_end, va_list, va_start
 #include <stdio.h>
+#include <string.h>
 
 using namespace lldb_private;
 
@@ -26,10 +33,49 @@ using namespace lldb_private;
 namespace {
 typedef std::vector<Timer *> TimerStack;
 static std::atomic<Timer::Category *> g_categories;
+
+// A traced timer. The event is claimed when the timer starts, so events
+// are ordered by start time, and its duration is filled in when the timer
+// stops.
+struct TraceEvent {
+  static constexpr uint64_t kInProgress = UINT64_MAX;
+
+  const char *name;
+  uint64_t start_nanos;
+  std::atomic<uint64_t> duration_nanos;
+  char detail[48];
+};
+
+// The trace events of one thread. Only the owning thread writes to it, so
+// it needs no locks. DumpTrace() reads it from other threads and uses the
+// claimed/written counters to skip events that are being overwritten, in
+// the manner of a sequence lock.
+struct TraceBuffer {
+  static constexpr uint64_t kNumEvents = 1 << 14;
+
+  TraceBuffer()
+      : tid(llvm::get_threadid()), events(new TraceEvent[kNumEvents]) {
+    llvm::get_thread_name(thread_name);
+  }
+
+  const uint64_t tid;
+  llvm::SmallString<32> thread_name;
+  std::unique_ptr<TraceEvent[]> events;
+  // Events below first_event were dropped by Timer::ResetTrace().
+  std::atomic<uint64_t> first_event{0};
+  // The owning thread bumps claimed_events before it starts overwriting the
+  // oldest event, and written_events once the new event is readable.
+  std::atomic<uint64_t> claimed_events{0};
+  std::atomic<uint64_t> written_events{0};
+  TraceBuffer *next = nullptr;
+};
+
+static std::atomic<TraceBuffer *> g_trace_buffers;
 } // end of anonymous namespace
 
 std::atomic<bool> Timer::g_quiet(true);
 std::atomic<unsigned> Timer::g_display_depth(0);
+std::atomic<bool> Timer::g_tracing(false);
 static std::mutex &GetFileMutex() {
   static std::mutex *g_file_mutex_ptr = new std::mutex();
   return *g_file_mutex_ptr;
@@ -40,6 +86,25 @@ static TimerStack &GetTimerStackForCurrentThread() {
   return g_stack;
 }
 
+// Buffers outlive their threads so that DumpTrace() can still show what
+// finished threads did.
+static TraceBuffer &GetTraceBufferForCurrentThread() {
+  static thread_local TraceBuffer *g_buffer = nullptr;
+  if (!g_buffer) {
+    g_buffer = new TraceBuffer();
+    TraceBuffer *expected = g_trace_buffers;
+    do {
+      g_buffer->next = expected;
+    } while (!g_trace_buffers.compare_exchange_weak(expected, g_buffer));
+  }
+  return *g_buffer;
+}
+
+static std::chrono::steady_clock::time_point GetTraceEpoch() {
+  static const auto g_epoch = std::chrono::steady_clock::now();
+  return g_epoch;
+}
+
 Timer::Category::Category(const char *cat) : m_name(cat) {
   m_nanos.store(0, std::memory_order_release);
   Category *expected = g_categories;
@@ -69,6 +134,28 @@ Timer::Timer(Timer::Category &category, const char *format, ...)
     // Newline
     ::fprintf(stdout, "\n");
   }
+
+  if (IsTracing()) {
+    TraceBuffer &buffer = GetTraceBufferForCurrentThread();
+    const uint64_t index =
+        buffer.claimed_events.load(std::memory_order_relaxed);
+    buffer.claimed_events.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TraceEvent &event = buffer.events[index % TraceBuffer::kNumEvents];
+    event.name = category.m_name;
+    event.start_nanos =
+        std::chrono::nanoseconds(m_total_start - GetTraceEpoch()).count();
+    event.duration_nanos.store(TraceEvent::kInProgress,
+                               std::memory_order_relaxed);
+    va_list args;
+    va_start(args, format);
+    ::vsnprintf(event.detail, sizeof(event.detail), format, args);
+    va_end(args);
+
+    buffer.written_events.store(index + 1, std::memory_order_release);
+    m_trace_index = index;
+  }
 }
 
 Timer::~Timer() {
@@ -94,6 +181,18 @@ Timer::~Timer() {
 
   // Keep total results for each category so we can dump results.
   m_category.m_nanos += std::chrono::nanoseconds(timer_dur).count();
+
+  if (m_trace_index != UINT64_MAX) {
+    TraceBuffer &buffer = GetTraceBufferForCurrentThread();
+    // Nested timers may have wrapped the buffer around since this one
+    // started.
+    if (buffer.claimed_events.load(std::memory_order_relaxed) -
+            m_trace_index <=
+        TraceBuffer::kNumEvents)
+      buffer.events[m_trace_index % TraceBuffer::kNumEvents]
+          .duration_nanos.store(nanoseconds(total_dur).count(),
+                                std::memory_order_release);
+  }
 }
 
 void Timer::SetDisplayDepth(uint32_t depth) { g_display_depth = depth; }
@@ -130,3 +229,116 @@ void Timer::DumpCategoryTimes(Stream *s) {
   for (const auto &timer : sorted)
     s->Printf("%.9f sec for %s\n", timer.second / 1000000000., timer.first);
 }
+
+void Timer::SetTracing(bool enable) {
+  // Make sure all events share an epoch from before the first of them.
+  GetTraceEpoch();
+  g_tracing = enable;
+}
+
+void Timer::ResetTrace() {
+  for (TraceBuffer *buffer = g_trace_buffers; buffer; buffer = buffer->next)
+    buffer->first_event.store(
+        buffer->written_events.load(std::memory_order_acquire));
+}
+
+// Details can hold raw packet bytes and can be truncated in the middle of a
+// UTF-8 sequence, so anything outside printable ASCII is written as an
+// escaped code point to keep the output valid JSON.
+static void WriteJSONString(llvm::raw_ostream &os, llvm::StringRef str) {
+  os << '"';
+  for (unsigned char c : str) {
+    if (c == '"' || c == '\\')
+      os << '\\' << c;
+    else if (c < 0x20 || c >= 0x7f)
+      os << llvm::format("\\u%04x", c);
+    else
+      os << c;
+  }
+  os << '"';
+}
+
+// Trace timestamps are in microseconds.
+static void WriteMicroseconds(llvm::raw_ostream &os, uint64_t nanos) {
+  os << nanos / 1000 << '.' << llvm::format("%03u", unsigned(nanos % 1000));
+}
+
+void Timer::DumpTrace(llvm::raw_ostream &os) {
+  // All of lldb is one process in the trace.
+  const char *pid = "1";
+  bool first = true;
+  auto begin_event = [&]() {
+    os << (first ? "\n" : ",\n");
+    first = false;
+  };
+
+  os << "{\"traceEvents\":[";
+  for (TraceBuffer *buffer = g_trace_buffers; buffer; buffer = buffer->next) {
+    if (!buffer->thread_name.empty()) {
+      begin_event();
+      os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+         << ",\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+      WriteJSONString(os, buffer->thread_name);
+      os << "}}";
+    }
+
+    const uint64_t written =
+        buffer->written_events.load(std::memory_order_acquire);
+    uint64_t begin = buffer->first_event.load(std::memory_order_relaxed);
+    if (written > TraceBuffer::kNumEvents)
+      begin = std::max(begin, written - TraceBuffer::kNumEvents);
+    if (begin >= written)
+      continue;
+
+    struct Copy {
+      const char *name;
+      uint64_t start_nanos;
+      uint64_t duration_nanos;
+      char detail[sizeof(TraceEvent::detail)];
+    };
+    const uint64_t copied_begin = begin;
+    std::vector<Copy> copies(written - begin);
+    for (uint64_t index = begin; index < written; ++index) {
+      const TraceEvent &event =
+          buffer->events[index % TraceBuffer::kNumEvents];
+      Copy &copy = copies[index - copied_begin];
+      copy.duration_nanos =
+          event.duration_nanos.load(std::memory_order_acquire);
+      copy.name = event.name;
+      copy.start_nanos = event.start_nanos;
+      ::memcpy(copy.detail, event.detail, sizeof(copy.detail));
+      copy.detail[sizeof(copy.detail) - 1] = '\0';
+    }
+
+    // Events the owning thread started overwriting while we were copying
+    // may be torn.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t claimed =
+        buffer->claimed_events.load(std::memory_order_relaxed);
+    if (claimed > TraceBuffer::kNumEvents)
+      begin = std::max(begin, claimed - TraceBuffer::kNumEvents);
+
+    for (uint64_t index = begin; index < written; ++index) {
+      const Copy &copy = copies[index - copied_begin];
+      if (copy.duration_nanos == TraceEvent::kInProgress)
+        continue;
+      begin_event();
+      os << "{\"name\":";
+      WriteJSONString(os, copy.name);
+      os << ",\"cat\":\"lldb\",\"ph\":\"X\",\"pid\":" << pid
+         << ",\"tid\":" << buffer->tid << ",\"ts\":";
+      WriteMicroseconds(os, copy.start_nanos);
+      os << ",\"dur\":";
+      WriteMicroseconds(os, copy.duration_nanos);
+      // Many timers just repeat their category name.
+      if (copy.detail[0] &&
+          !llvm::StringRef(copy.name).startswith(copy.detail)) {
+        os << ",\"args\":{\"detail\":";
+        WriteJSONString(os, copy.detail);
+        os << "}";
+      }
+      os << "}";
+    }
+  }
+  os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
@@ -0,0 +1,362 @@
+//===-- TrigramIndex.cpp ----------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Utility/TrigramIndex.h"
+#include "lldb/Utility/DataExtractor.h"
+#include "lldb/Utility/RegularExpression.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+
+using namespace lldb;
+using namespace lldb_private;
+
+static uint32_t MakeTrigram(const char *chars) {
+  return ((uint32_t)(uint8_t)llvm::toLower(chars[0]) << 16) |
+         ((uint32_t)(uint8_t)llvm::toLower(chars[1]) << 8) |
+         (uint32_t)(uint8_t)llvm::toLower(chars[2]);
+}
+
+void TrigramIndex::Insert(uint32_t id, llvm::StringRef name) {
+  if (name.size() < 3)
+    return;
+  const char *chars = name.data();
+  for (size_t i = 0, e = name.size() - 2; i < e; ++i) {
+    std::vector<uint32_t> &postings = m_pending[MakeTrigram(chars + i)];
+    // Ids come in increasing order, so duplicates are always adjacent.
+    if (postings.empty() || postings.back() != id)
+      postings.push_back(id);
+  }
+}
+
+void TrigramIndex::Finalize() {
+  m_trigrams.clear();
+  m_trigrams.reserve(m_pending.size());
+  size_t num_postings = 0;
+  for (const auto &entry : m_pending) {
+    m_trigrams.push_back(entry.first);
+    num_postings += entry.second.size();
+  }
+  std::sort(m_trigrams.begin(), m_trigrams.end());
+
+  m_offsets.clear();
+  m_offsets.reserve(m_trigrams.size() + 1);
+  m_postings.clear();
+  m_postings.reserve(num_postings);
+  for (uint32_t trigram : m_trigrams) {
+    m_offsets.push_back(m_postings.size());
+    const std::vector<uint32_t> &postings = m_pending[trigram];
+    m_postings.insert(m_postings.end(), postings.begin(), postings.end());
+  }
+  m_offsets.push_back(m_postings.size());
+  m_pending.shrink_and_clear();
+}
+
+void TrigramIndex::Clear() {
+  m_trigrams.clear();
+  m_offsets.clear();
+  m_postings.clear();
+  m_pending.shrink_and_clear();
+}
+
+llvm::ArrayRef<uint32_t> TrigramIndex::GetPostings(uint32_t trigram) const {
+  auto pos = std::lower_bound(m_trigrams.begin(), m_trigrams.end(), trigram);
+  if (pos == m_trigrams.end() || *pos != trigram)
+    return llvm::ArrayRef<uint32_t>();
+  const size_t idx = pos - m_trigrams.begin();
+  return llvm::makeArrayRef(m_postings.data() + m_offsets[idx],
+                            m_offsets[idx + 1] - m_offsets[idx]);
+}
+
+bool TrigramIndex::FindCandidates(llvm::StringRef regex,
+                                  std::vector<uint32_t> &ids) const {
+  std::vector<uint32_t> trigrams;
+  for (const std::string &literal : GetRequiredLiterals(regex)) {
+    for (size_t i = 0; i + 3 <= literal.size(); ++i)
+      trigrams.push_back(MakeTrigram(literal.data() + i));
+  }
+  if (trigrams.empty())
+    return false;
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()),
+                 trigrams.end());
+
+  // Intersect the shortest lists first to keep the working set small.
+  std::vector<llvm::ArrayRef<uint32_t>> lists;
+  for (uint32_t trigram : trigrams)
+    lists.push_back(GetPostings(trigram));
+  std::sort(lists.begin(), lists.end(),
+            [](llvm::ArrayRef<uint32_t> lhs, llvm::ArrayRef<uint32_t> rhs) {
+              return lhs.size() < rhs.size();
+            });
+
+  ids.assign(lists.front().begin(), lists.front().end());
+  std::vector<uint32_t> intersection;
+  for (size_t i = 1; i < lists.size() && !ids.empty(); ++i) {
+    intersection.clear();
+    std::set_intersection(ids.begin(), ids.end(), lists[i].begin(),
+                          lists[i].end(), std::back_inserter(intersection));
+    ids.swap(intersection);
+  }
+  return true;
+}
+
+bool TrigramIndex::FindCandidates(const RegularExpression &regex,
+                                  std::vector<uint32_t> &ids) const {
+  // GetRequiredLiterals() reads POSIX extended syntax, and is careful enough
+  // with escapes for the enhanced syntax too. Trigrams are case folded, and
+  // the remaining flags don't change what the text of the expression means.
+  int known_flags = REG_EXTENDED | REG_ICASE | REG_NOSUB | REG_NEWLINE;
+#if defined(REG_ENHANCED)
+  known_flags |= REG_ENHANCED;
+#endif
+  const int flags = regex.GetCompileFlags();
+  if (!regex.IsValid() || (flags & REG_EXTENDED) == 0 ||
+      (flags & ~known_flags) != 0)
+    return false;
+  return FindCandidates(regex.GetText(), ids);
+}
+
+// Return the index just past the bracket expression starting at \a pos, or
+// npos if it isn't terminated.
+static size_t SkipBracketExpression(llvm::StringRef regex, size_t pos) {
+  ++pos; // '['
+  if (pos < regex.size() && regex[pos] == '^')
+    ++pos;
+  // A ']' right at the start is part of the set.
+  if (pos < regex.size() && regex[pos] == ']')
+    ++pos;
+  while (pos < regex.size()) {
+    const char c = regex[pos];
+    if (c == ']')
+      return pos + 1;
+    // Character classes, collating symbols and equivalence classes.
+    if (c == '[' && pos + 1 < regex.size() &&
+        (regex[pos + 1] == ':' || regex[pos + 1] == '.' ||
+         regex[pos + 1] == '=')) {
+      const char terminator[3] = {regex[pos + 1], ']', '\0'};
+      const size_t end = regex.find(terminator, pos + 2);
+      if (end == llvm::StringRef::npos)
+        return llvm::StringRef::npos;
+      pos = end + 2;
+      continue;
+    }
+    ++pos;
+  }
+  return llvm::StringRef::npos;
+}
+
+// Return the index just past the parenthesized group starting at \a pos, or
+// npos if it isn't terminated.
+static size_t SkipGroup(llvm::StringRef regex, size_t pos) {
+  int depth = 0;
+  while (pos < regex.size()) {
+    switch (regex[pos]) {
+    case '\\':
+      pos += 2;
+      continue;
+    case '[':
+      pos = SkipBracketExpression(regex, pos);
+      if (pos == llvm::StringRef::npos)
+        return pos;
+      continue;
+    case '(':
+      ++depth;
+      break;
+    case ')':
+      if (--depth == 0)
+        return pos + 1;
+      break;
+    }
+    ++pos;
+  }
+  return llvm::StringRef::npos;
+}
+
+static bool HasTopLevelAlternation(llvm::StringRef regex) {
+  size_t pos = 0;
+  while (pos < regex.size()) {
+    switch (regex[pos]) {
+    case '\\':
+      pos += 2;
+      continue;
+    case '[':
+      pos = SkipBracketExpression(regex, pos);
+      continue;
+    case '(':
+      pos = SkipGroup(regex, pos);
+      continue;
+    case '|':
+      return true;
+    }
+    ++pos;
+  }
+  return false;
+}
+
+std::vector<std::string>
+TrigramIndex::GetRequiredLiterals(llvm::StringRef regex) {
+  std::vector<std::string> literals;
+  if (HasTopLevelAlternation(regex))
+    return literals;
+
+  std::string current;
+  auto flush = [&]() {
+    if (!current.empty())
+      literals.push_back(current);
+    current.clear();
+  };
+
+  bool after_quantifier = false;
+  size_t pos = 0;
+  while (pos < regex.size()) {
+    const char c = regex[pos];
+    const bool is_quantifier = c == '*' || c == '?' || c == '+' || c == '{';
+    // Stacked quantifiers ("a+?") mean different things to different regex
+    // engines. Don't guess.
+    if (is_quantifier && after_quantifier)
+      return std::vector<std::string>();
+    after_quantifier = is_quantifier;
+
+    switch (c) {
+    case '\\': {
+      if (pos + 1 >= regex.size())
+        return std::vector<std::string>();
+      const char escaped = regex[pos + 1];
+      // Escaped letters and digits are classes, anchors or back references
+      // in some dialect or other; everything else stands for itself.
+      if (llvm::isAlnum(escaped) || escaped == '<' || escaped == '>' ||
+          escaped == '`' || escaped == '\'')
+        flush();
+      else
+        current.push_back(escaped);
+      pos += 2;
+      continue;
+    }
+
+    case '[':
+      flush();
+      pos = SkipBracketExpression(regex, pos);
+      if (pos == llvm::StringRef::npos)
+        return std::vector<std::string>();
+      continue;
+
+    case '(':
+      // A group may be quantified or contain alternatives; skip it.
+      flush();
+      pos = SkipGroup(regex, pos);
+      if (pos == llvm::StringRef::npos)
+        return std::vector<std::string>();
+      continue;
+
+    case '{': {
+      // The previous character may be repeated zero times.
+      if (!current.empty())
+        current.pop_back();
+      flush();
+      const size_t end = regex.find('}', pos);
+      if (end == llvm::StringRef::npos)
+        return std::vector<std::string>();
+      pos = end + 1;
+      continue;
+    }
+
+    case '*':
+    case '?':
+      if (!current.empty())
+        current.pop_back();
+      flush();
+      break;
+
+    case '+': {
+      // The previous character appears at least once, but whatever follows
+      // is only adjacent to the last repetition.
+      if (current.empty())
+        break;
+      const char repeated = current.back();
+      flush();
+      current.push_back(repeated);
+      break;
+    }
+
+    case '.':
+    case '^':
+    case '$':
+    case ')':
+      flush();
+      break;
+
+    default:
+      current.push_back(c);
+      break;
+    }
+    ++pos;
+  }
+  flush();
+  return literals;
+}
+
+size_t TrigramIndex::GetMemoryUsage() const {
+  size_t usage = (m_trigrams.capacity() + m_offsets.capacity() +
+                  m_postings.capacity()) *
+                 sizeof(uint32_t);
+  for (const auto &entry : m_pending)
+    usage += entry.second.capacity() * sizeof(uint32_t);
+  return usage + m_pending.getMemorySize();
+}
+
+static void WriteU32(llvm::raw_ostream &os, uint32_t value) {
+  uint8_t bytes[sizeof(value)];
+  llvm::support::endian::write<uint32_t, llvm::support::little,
+                               llvm::support::unaligned>(bytes, value);
+  os.write(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+}
+
+void TrigramIndex::Encode(llvm::raw_ostream &os) const {
+  WriteU32(os, m_trigrams.size());
+  WriteU32(os, m_postings.size());
+  for (uint32_t trigram : m_trigrams)
+    WriteU32(os, trigram);
+  for (uint32_t offset : m_offsets)
+    WriteU32(os, offset);
+  for (uint32_t id : m_postings)
+    WriteU32(os, id);
+}
+
+bool TrigramIndex::Decode(const DataExtractor &data,
+                          lldb::offset_t *offset_ptr) {
+  Clear();
+  const uint64_t num_trigrams = data.GetU32(offset_ptr);
+  const uint64_t num_postings = data.GetU32(offset_ptr);
+  const uint64_t size = (num_trigrams * 2 + 1 + num_postings) * 4;
+  if (!data.ValidOffsetForDataOfSize(*offset_ptr, size))
+    return false;
+
+  m_trigrams.resize(num_trigrams);
+  m_offsets.resize(num_trigrams + 1);
+  m_postings.resize(num_postings);
+  for (uint32_t &trigram : m_trigrams)
+    trigram = data.GetU32(offset_ptr);
+  for (uint32_t &offset : m_offsets)
+    offset = data.GetU32(offset_ptr);
+  for (uint32_t &id : m_postings)
+    id = data.GetU32(offset_ptr);
+
+  bool valid = m_offsets.front() == 0 && m_offsets.back() == num_postings;
+  for (size_t i = 0; valid && i < num_trigrams; ++i) {
+    valid = m_offsets[i] <= m_offsets[i + 1] &&
+            (i == 0 || m_trigrams[i - 1] < m_trigrams[i]);
+  }
+  if (!valid)
+    Clear();
+  return valid;
+}
@@ -11,8 +11,13 @@
 #include "Decoder.h"
 
 // C/C++ Includes
+#include <algorithm>
+#include <cerrno>
 #include <cinttypes>
 #include <cstring>
+#include <iterator>
+#include <limits>
+#include <thread>
 
 // Other libraries and framework includes
 #include "lldb/API/SBModule.h"
@@ -21,6 +26,24 @@
 
 using namespace ptdecoder_private;
 
+// Size of each read of raw trace data from LLDB. Large enough that a 64 MB
+// trace buffer only needs a few dozen packets, small enough that decoding can
+// start early.
+static const uint64_t k_trace_read_window = 1024 * 1024;
+
+// Minimum size of the segments of raw trace that are decoded in parallel. Each
+// segment needs a decoder of its own, so segments shouldn't be too small.
+static const uint64_t k_min_segment_size = 1024 * 1024;
+
+// Number of entries of an instruction log between two entries of its index.
+// Reading from an arbitrary position decodes at most this many entries that
+// aren't returned.
+static const uint64_t k_index_interval = 1024;
+
+// Number of bytes of an instruction log that are buffered before they are
+// written to the temporary file as one chunk.
+static const size_t k_log_chunk_size = 64 * 1024;
+
 // This function removes entries of all the processes/threads which were once
 // registered in the class but are not alive anymore because they died or
 // finished executing.
@@ -251,9 +274,10 @@ void Decoder::StopProcessorTrace(lldb::SBProcess &sbprocess,
   }
 }
 
-void Decoder::ReadTraceDataAndImageInfo(lldb::SBProcess &sbprocess,
-                                        lldb::tid_t tid, lldb::SBError &sberror,
-                                        ThreadTraceInfo &threadTraceInfo) {
+void Decoder::ReadTraceConfigAndImageInfo(lldb::SBProcess &sbprocess,
+                                          lldb::tid_t tid,
+                                          lldb::SBError &sberror,
+                                          ThreadTraceInfo &threadTraceInfo) {
   // Allocate trace data buffer and parse cpu info for 'tid' if it is registered
   // for the first time in class
   lldb::SBTrace &trace = threadTraceInfo.GetUniqueTraceInstance();
@@ -287,17 +311,6 @@ void Decoder::ReadTraceDataAndImageInfo(lldb::SBProcess &sbprocess,
       return;
   }
 
-  // Call LLDB API to get raw trace data for this thread
-  size_t bytes_written = trace.GetTraceData(error, (void *)pt_buffer.data(),
-                                            pt_buffer.size(), 0, tid);
-  if (!error.Success()) {
-    sberror.SetErrorStringWithFormat(
-        "%s; thread_id = %" PRIu64 ",  ProcessID = %" PRIu64,
-        error.GetCString(), tid, sbprocess.GetProcessID());
-    return;
-  }
-  std::fill(pt_buffer.begin() + bytes_written, pt_buffer.end(), 0);
-
   // Get information of all the modules of the inferior
   lldb::SBTarget sbtarget = sbprocess.GetTarget();
   ReadExecuteSectionInfos &readExecuteSectionInfos =
@@ -310,23 +323,187 @@ void Decoder::ReadTraceDataAndImageInfo(lldb::SBProcess &sbprocess,
 void Decoder::DecodeProcessorTrace(lldb::SBProcess &sbprocess, lldb::tid_t tid,
                                    lldb::SBError &sberror,
                                    ThreadTraceInfo &threadTraceInfo) {
-  // Initialize instruction decoder
-  struct pt_insn_decoder *decoder = nullptr;
-  struct pt_config config;
   Buffer &pt_buffer = threadTraceInfo.GetPTBuffer();
   CPUInfo &pt_cpu = threadTraceInfo.GetCPUInfo();
   ReadExecuteSectionInfos &readExecuteSectionInfos =
       threadTraceInfo.GetReadExecuteSectionInfos();
 
-  InitializePTInstDecoder(&decoder, &config, pt_cpu, pt_buffer,
-                          readExecuteSectionInfos, sberror);
-  if (!sberror.Success())
+  // The logs of all segments go to the same temporary file
+  std::shared_ptr<InstructionLogFile> log_file =
+      std::make_shared<InstructionLogFile>();
+  if (!log_file->IsValid()) {
+    sberror.SetErrorStringWithFormat(
+        "can't create a temporary file for the instruction log: %s",
+        strerror(errno));
+    return;
+  }
+
+  // Call LLDB API to get raw trace data for this thread on a separate thread
+  lldb::SBTrace &trace = threadTraceInfo.GetUniqueTraceInstance();
+  TraceDataStream stream(pt_buffer);
+  std::thread reader([&stream, &trace, tid]() { stream.Read(trace, tid); });
+
+  // Decode the segments of the raw trace on one thread per core, in the order
+  // in which they are queued
+  std::vector<std::unique_ptr<TraceSegment>> segments;
+  std::mutex segments_mutex;
+  std::condition_variable segments_queued;
+  size_t next_segment = 0;
+  bool all_segments_queued = false;
+
+  unsigned num_workers = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < num_workers; i++) {
+    workers.emplace_back([&]() {
+      while (1) {
+        TraceSegment *segment = nullptr;
+        {
+          std::unique_lock<std::mutex> lock(segments_mutex);
+          segments_queued.wait(lock, [&]() {
+            return next_segment < segments.size() || all_segments_queued;
+          });
+          if (next_segment == segments.size())
+            return;
+          segment = segments[next_segment++].get();
+        }
+        DecodeSegment(pt_cpu, pt_buffer, readExecuteSectionInfos, log_file,
+                      *segment);
+      }
+    });
+  }
+
+  // Split the raw trace at PSB packets while it arrives. Every segment except
+  // the last one ends at the first PSB packet after k_min_segment_size bytes.
+  uint64_t segment_begin = 0;
+  bool more_segments = true;
+  while (more_segments) {
+    uint64_t segment_end = 0;
+    more_segments = stream.WaitForSyncPoint(
+        segment_begin + k_min_segment_size, segment_end);
+    {
+      std::lock_guard<std::mutex> guard(segments_mutex);
+      if (segment_end > segment_begin)
+        segments.emplace_back(new TraceSegment(segment_begin, segment_end));
+      all_segments_queued = !more_segments;
+    }
+    segments_queued.notify_all();
+    segment_begin = segment_end;
+  }
+
+  reader.join();
+  for (auto &worker : workers)
+    worker.join();
+
+  InstructionLogs &instruction_logs = threadTraceInfo.GetInstructionLogs();
+  instruction_logs.clear();
+
+  lldb::SBError &error = stream.GetError();
+  if (!error.Success()) {
+    sberror.SetErrorStringWithFormat(
+        "%s; thread_id = %" PRIu64 ",  ProcessID = %" PRIu64,
+        error.GetCString(), tid, sbprocess.GetProcessID());
+    return;
+  }
+
+  // Join the logs of all segments into the instruction log of the thread
+  for (size_t i = 0; i < segments.size(); i++) {
+    TraceSegment &segment = *segments[i];
+    if (!segment.instruction_log)
+      continue;
+    // The decoder of a segment that ends at a PSB packet keeps decoding the
+    // instructions that don't need trace (e.g. that aren't branches) after
+    // the last branch of the segment, past the address at which the PSB
+    // packet was generated. The decoder of the next segment starts at that
+    // address. They are all part of the straight line code after the last
+    // branch, so the address can only appear once among them.
+    if (i + 1 < segments.size() && segments[i + 1]->instruction_log)
+      segment.instruction_log->TrimOverlap(segment.linear_run_begin,
+                                           *segments[i + 1]->instruction_log);
+    if (!segment.error.Success() && sberror.Success())
+      sberror = segment.error;
+    instruction_logs.push_back(std::move(segment.instruction_log));
+  }
+}
+
+void Decoder::TraceDataStream::Read(lldb::SBTrace &trace, lldb::tid_t tid) {
+  uint64_t offset = 0;
+  while (offset < m_pt_buffer.size()) {
+    size_t window_size =
+        std::min<uint64_t>(k_trace_read_window, m_pt_buffer.size() - offset);
+    size_t bytes_read =
+        trace.GetTraceData(m_error, (void *)(m_pt_buffer.data() + offset),
+                           window_size, offset, tid);
+    if (!m_error.Success())
+      break;
+
+    offset += bytes_read;
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_bytes_available = offset;
+    }
+    m_data_available.notify_all();
+
+    // A short read means there is no more trace
+    if (bytes_read < window_size)
+      break;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_done = true;
+  }
+  m_data_available.notify_all();
+}
+
+bool Decoder::TraceDataStream::WaitForSyncPoint(uint64_t offset,
+                                                uint64_t &sync_offset) {
+  // A PSB packet is the 16 byte pattern 0x02 0x82 repeated 8 times
+  static const uint8_t psb[] = {0x02, 0x82, 0x02, 0x82, 0x02, 0x82,
+                                0x02, 0x82, 0x02, 0x82, 0x02, 0x82,
+                                0x02, 0x82, 0x02, 0x82};
+
+  bool found = false;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_data_available.wait(lock, [&]() {
+    if (m_bytes_available > offset) {
+      auto begin = m_pt_buffer.begin() + offset;
+      auto end = m_pt_buffer.begin() + m_bytes_available;
+      auto psb_itr = std::search(begin, end, std::begin(psb), std::end(psb));
+      if (psb_itr != end) {
+        sync_offset = psb_itr - m_pt_buffer.begin();
+        found = true;
+        return true;
+      }
+    }
+    sync_offset = m_bytes_available;
+    return m_done;
+  });
+  return found;
+}
+
+void Decoder::DecodeSegment(
+    const CPUInfo &pt_cpu, Buffer &pt_buffer,
+    const ReadExecuteSectionInfos &readExecuteSectionInfos,
+    const std::shared_ptr<InstructionLogFile> &log_file,
+    TraceSegment &segment) const {
+  // Initialize instruction decoder
+  struct pt_insn_decoder *decoder = nullptr;
+  struct pt_config config;
+  InitializePTInstDecoder(&decoder, &config, pt_cpu,
+                          pt_buffer.data() + segment.begin,
+                          pt_buffer.data() + segment.end,
+                          readExecuteSectionInfos, segment.error);
+  if (!segment.error.Success())
     return;
 
   // Start raw trace decoding
-  Instructions &instruction_list = threadTraceInfo.GetInstructionLog();
-  instruction_list.clear();
-  DecodeTrace(decoder, instruction_list, sberror);
+  segment.instruction_log.reset(new InstructionLog(log_file));
+  DecodeTrace(decoder, segment);
+  pt_insn_free_decoder(decoder);
+
+  if (!segment.instruction_log->Flush() && segment.error.Success())
+    segment.error.SetErrorStringWithFormat(
+        "can't write the instruction log: %s", strerror(errno));
 }
 
 // Raw trace decoding requires information of Read & Execute sections of each
@@ -383,18 +560,11 @@ void Decoder::GetTargetModulesInfo(
       uint32_t section_permission = section.GetPermissions();
       if ((section_permission & lldb::Permissions::ePermissionsReadable) &&
           (section_permission & lldb::Permissions::ePermissionsExecutable)) {
-        lldb::SBData section_data = section.GetSectionData();
-        if (!section_data.IsValid()) {
-          sberror.SetErrorStringWithFormat(
-              "Can't get module info [ %" PRIu32 " ]   \"%s\"  of target "
-              "\"%s\" from LLDB, invalid "
-              "data in \"%s\" section",
-              i, image, target_file_spec.GetFilename(), section.GetName());
-          return;
-        }
-
-        // In case section has no data, skip it.
-        if (section_data.GetByteSize() == 0)
+        // In case section has no data in the file, skip it. The data itself
+        // is mapped from the file by the image section cache below rather
+        // than copied out of LLDB.
+        uint64_t section_size = section.GetFileByteSize();
+        if (section_size == 0)
           continue;
 
         if (!path_length) {
@@ -406,10 +576,25 @@ void Decoder::GetTargetModulesInfo(
           return;
         }
 
+        // The cache returns the id of the existing section if it was added
+        // before, so each section is only mapped once per Decoder instance
         std::string image_path(image_complete_path, path_length);
-        readExecuteSectionInfos.emplace_back(
-            section.GetLoadAddress(sbtarget), section.GetFileOffset(),
-            section_data.GetByteSize(), image_path);
+        uint64_t load_address = section.GetLoadAddress(sbtarget);
+        int isid = pt_iscache_add_file(m_image_section_cache,
+                                       image_path.c_str(),
+                                       section.GetFileOffset(), section_size,
+                                       load_address);
+        if (isid < 0) {
+          sberror.SetErrorStringWithFormat(
+              "processor trace decoding library: pt_iscache_add_file() "
+              "failed for \"%s\" section of \"%s\" with error: \"%s\"",
+              section.GetName(), image_path.c_str(),
+              pt_errstr(pt_errcode(isid)));
+          return;
+        }
+        readExecuteSectionInfos.emplace_back(load_address,
+                                             section.GetFileOffset(),
+                                             section_size, image_path, isid);
       }
     }
   }
@@ -510,7 +695,7 @@ void Decoder::ParseCPUInfo(CPUInfo &pt_cpu, lldb::SBStructuredData &s,
 // in trace decoder.
 void Decoder::InitializePTInstDecoder(
     struct pt_insn_decoder **decoder, struct pt_config *config,
-    const CPUInfo &pt_cpu, Buffer &pt_buffer,
+    const CPUInfo &pt_cpu, uint8_t *begin, uint8_t *end,
     const ReadExecuteSectionInfos &readExecuteSectionInfos,
     lldb::SBError &sberror) const {
   if (!decoder || !config) {
@@ -531,8 +716,8 @@ void Decoder::InitializePTInstDecoder(
   }
 
   // Load trace buffer's starting and end address in pt_config struct
-  config->begin = pt_buffer.data();
-  config->end = pt_buffer.data() + pt_buffer.size();
+  config->begin = begin;
+  config->end = end;
 
   // Fill trace decoder with pt_config struct
   *decoder = pt_insn_alloc_decoder(config);
@@ -553,13 +738,15 @@ void Decoder::InitializePTInstDecoder(
     return;
   }
 
+  // The sections were mapped into the image section cache by
+  // GetTargetModulesInfo(), the image only refers to them
   for (auto &itr : readExecuteSectionInfos) {
-    errcode = pt_image_add_file(image, itr.image_path.c_str(), itr.file_offset,
-                                itr.size, nullptr, itr.load_address);
+    errcode = pt_image_add_cached(image, m_image_section_cache, itr.isid,
+                                  nullptr);
     if (errcode < 0) {
       sberror.SetErrorStringWithFormat("processor trace decoding library:  "
-                                       "pt_image_add_file() failed with error: "
-                                       "\"%s\"",
+                                       "pt_image_add_cached() failed with "
+                                       "error: \"%s\"",
                                        pt_errstr(pt_errcode(errcode)));
       pt_insn_free_decoder(*decoder);
       return;
@@ -567,10 +754,11 @@ void Decoder::InitializePTInstDecoder(
   }
 }
 
-// Start actual decoding of raw trace
+// Start actual decoding of raw trace segment
 void Decoder::DecodeTrace(struct pt_insn_decoder *decoder,
-                          Instructions &instruction_list,
-                          lldb::SBError &sberror) {
+                          TraceSegment &segment) const {
+  InstructionLog &instruction_log = *segment.instruction_log;
+  lldb::SBError &sberror = segment.error;
   uint64_t decoder_offset = 0;
 
   while (1) {
@@ -591,15 +779,17 @@ void Decoder::DecodeTrace(struct pt_insn_decoder *decoder,
         sberror.SetErrorStringWithFormat(
             "processor trace decoding library: \"%s\"",
             pt_errstr(pt_errcode(errcode)));
-        instruction_list.emplace_back(sberror.GetCString());
+        instruction_log.Append(sberror.GetCString());
+        segment.linear_run_begin = instruction_log.GetSize();
         return;
       }
 
       sberror.SetErrorStringWithFormat(
           "processor trace decoding library: \"%s\"  [decoder_offset] => "
           "[0x%" PRIu64 "]",
-          pt_errstr(pt_errcode(errcode)), decoder_offset);
-      instruction_list.emplace_back(sberror.GetCString());
+          pt_errstr(pt_errcode(errcode)), segment.begin + decoder_offset);
+      instruction_log.Append(sberror.GetCString());
+      segment.linear_run_begin = instruction_log.GetSize();
       while (1) {
         errcode = pt_insn_sync_forward(decoder);
         if (errcode >= 0)
@@ -614,7 +804,8 @@ void Decoder::DecodeTrace(struct pt_insn_decoder *decoder,
           sberror.SetErrorStringWithFormat(
               "processor trace decoding library: \"%s\"",
               pt_errstr(pt_errcode(errcode)));
-          instruction_list.emplace_back(sberror.GetCString());
+          instruction_log.Append(sberror.GetCString());
+          segment.linear_run_begin = instruction_log.GetSize();
           return;
         } else if (new_decoder_offset <= decoder_offset) {
           // We tried resyncing the decoder and decoder didn't make any
@@ -625,8 +816,9 @@ void Decoder::DecodeTrace(struct pt_insn_decoder *decoder,
         sberror.SetErrorStringWithFormat(
             "processor trace decoding library: \"%s\"  [decoder_offset] => "
             "[0x%" PRIu64 "]",
-            pt_errstr(pt_errcode(errcode)), new_decoder_offset);
-        instruction_list.emplace_back(sberror.GetCString());
+            pt_errstr(pt_errcode(errcode)), segment.begin + new_decoder_offset);
+        instruction_log.Append(sberror.GetCString());
+        segment.linear_run_begin = instruction_log.GetSize();
         decoder_offset = new_decoder_offset;
       }
     }
@@ -637,16 +829,19 @@ void Decoder::DecodeTrace(struct pt_insn_decoder *decoder,
         if (insn.iclass == ptic_error)
           break;
 
-        instruction_list.emplace_back(insn);
+        instruction_log.Append(insn);
 
         if (errcode == -pte_eos)
           return;
 
-        Diagnose(decoder, errcode, sberror, &insn);
-        instruction_list.emplace_back(sberror.GetCString());
+        Diagnose(decoder, errcode, sberror, segment.begin, &insn);
+        instruction_log.Append(sberror.GetCString());
+        segment.linear_run_begin = instruction_log.GetSize();
         break;
       }
-      instruction_list.emplace_back(insn);
+      instruction_log.Append(insn);
+      if (insn.iclass != ptic_other)
+        segment.linear_run_begin = instruction_log.GetSize();
       if (errcode & pts_eos)
         return;
     }
@@ -655,11 +850,15 @@ void Decoder::DecodeTrace(struct pt_insn_decoder *decoder,
 
 // Function to diagnose and indicate errors during raw trace decoding
 void Decoder::Diagnose(struct pt_insn_decoder *decoder, int decode_error,
-                       lldb::SBError &sberror, const struct pt_insn *insn) {
+                       lldb::SBError &sberror, uint64_t base_offset,
+                       const struct pt_insn *insn) const {
   int errcode;
   uint64_t offset;
 
   errcode = pt_insn_get_offset(decoder, &offset);
+  // Report the offset in the whole raw trace rather than in the segment
+  if (errcode >= 0)
+    offset += base_offset;
   if (insn) {
     if (errcode < 0)
       sberror.SetErrorStringWithFormat(
@@ -710,10 +909,11 @@ void Decoder::GetInstructionLogAtOffset(lldb::SBProcess &sbprocess,
   }
 
   // Return instruction log by populating 'result_list'
-  Instructions &insn_list = threadTraceInfo->GetInstructionLog();
+  InstructionLogs &insn_logs = threadTraceInfo->GetInstructionLogs();
+  uint64_t insn_log_size = threadTraceInfo->GetInstructionLogSize();
   uint64_t sum = (uint64_t)offset + 1;
-  if (((insn_list.size() <= offset) && (count <= sum) &&
-       ((sum - count) >= insn_list.size())) ||
+  if (((insn_log_size <= offset) && (count <= sum) &&
+       ((sum - count) >= insn_log_size)) ||
       (count < 1)) {
     sberror.SetErrorStringWithFormat(
         "Instruction Log not available for offset=%" PRIu32
@@ -722,16 +922,19 @@ void Decoder::GetInstructionLogAtOffset(lldb::SBProcess &sbprocess,
     return;
   }
 
-  Instructions::iterator itr_first =
-      (insn_list.size() <= offset) ? insn_list.begin()
-                                   : insn_list.begin() + insn_list.size() - sum;
-  Instructions::iterator itr_last =
-      (count <= sum) ? insn_list.begin() + insn_list.size() - (sum - count)
-                     : insn_list.end();
-  Instructions::iterator itr = itr_first;
-  while (itr != itr_last) {
-    result_list.AppendInstruction(*itr);
-    ++itr;
+  uint64_t first = (insn_log_size <= offset) ? 0 : insn_log_size - sum;
+  uint64_t last =
+      (count <= sum) ? insn_log_size - (sum - count) : insn_log_size;
+
+  // The range may span the logs of several trace segments
+  for (auto &insn_log : insn_logs) {
+    if (first >= last)
+      break;
+    uint64_t log_size = insn_log->GetSize();
+    if (first < log_size)
+      insn_log->Read(first, std::min(last, log_size) - first, result_list);
+    first = (first < log_size) ? 0 : first - log_size;
+    last = (last < log_size) ? 0 : last - log_size;
   }
 }
 
@@ -792,7 +995,7 @@ void Decoder::GetProcessorTraceInfo(lldb::SBProcess &sbprocess, lldb::tid_t tid,
   if (!sberror.Success())
     return;
   options.setTraceParams(sbstructdata);
-  options.setInstructionLogSize(threadTraceInfo->GetInstructionLog().size());
+  options.setInstructionLogSize(threadTraceInfo->GetInstructionLogSize());
 }
 
 void Decoder::FetchAndDecode(lldb::SBProcess &sbprocess, lldb::tid_t tid,
@@ -853,19 +1056,17 @@ void Decoder::FetchAndDecode(lldb::SBProcess &sbprocess, lldb::tid_t tid,
     itr_thread = mapThreadID_TraceInfo.find(tid);
   }
 
-  // Get raw trace data and inferior image from LLDB for the registered thread
-  ReadTraceDataAndImageInfo(sbprocess, tid, sberror, itr_thread->second);
+  // Get trace configuration and inferior image from LLDB for the registered
+  // thread, then read and decode raw trace data
+  ReadTraceConfigAndImageInfo(sbprocess, tid, sberror, itr_thread->second);
+  if (sberror.Success())
+    DecodeProcessorTrace(sbprocess, tid, sberror, itr_thread->second);
   if (!sberror.Success()) {
     std::string error_string(sberror.GetCString());
     if (error_string.find("tracing not active") != std::string::npos)
       mapThreadID_TraceInfo.erase(itr_thread);
     return;
   }
-  // Decode raw trace data
-  DecodeProcessorTrace(sbprocess, tid, sberror, itr_thread->second);
-  if (!sberror.Success()) {
-    return;
-  }
   *threadTraceInfo = &(itr_thread->second);
 }
 
@@ -902,3 +1103,250 @@ void Decoder::CheckDebuggerID(lldb::SBProcess &sbprocess,
     return;
   }
 }
+
+InstructionLogFile::InstructionLogFile()
+    : m_mutex(), m_file(tmpfile()), m_size(0) {}
+
+InstructionLogFile::~InstructionLogFile() {
+  if (m_file)
+    fclose(m_file);
+}
+
+off_t InstructionLogFile::Write(const uint8_t *data, size_t size) {
+  std::lock_guard<std::mutex> guard(m_mutex);
+  if (m_file == nullptr || fseeko(m_file, m_size, SEEK_SET) != 0 ||
+      fwrite(data, 1, size, m_file) != size)
+    return -1;
+  off_t offset = m_size;
+  m_size += size;
+  return offset;
+}
+
+bool InstructionLogFile::Read(off_t offset, uint8_t *data, size_t size) {
+  std::lock_guard<std::mutex> guard(m_mutex);
+  return m_file != nullptr && fseeko(m_file, offset, SEEK_SET) == 0 &&
+         fread(data, 1, size, m_file) == size;
+}
+
+InstructionLog::InstructionLog(std::shared_ptr<InstructionLogFile> file)
+    : m_file(std::move(file)), m_buffer(), m_chunks(), m_write_error(false),
+      m_size(0), m_next_ip(0), m_index(), m_read_buffer(),
+      m_read_chunk(SIZE_MAX), m_read_offset(0) {}
+
+InstructionLog::~InstructionLog() {}
+
+void InstructionLog::Append(const struct pt_insn &insn) {
+  if ((m_size % k_index_interval) == 0)
+    m_index.push_back({m_chunks.size(), m_buffer.size(), m_next_ip});
+
+  bool sequential = (insn.ip == m_next_ip);
+  uint8_t header = insn.size & 0x0f;
+  if (insn.speculative)
+    header |= 0x20;
+  if (sequential)
+    header |= 0x40;
+  if (insn.iclass != ptic_other)
+    header |= 0x10;
+  m_buffer.push_back(header);
+  if (insn.iclass != ptic_other)
+    m_buffer.push_back(insn.iclass);
+  if (!sequential) {
+    // Zigzag encoding keeps small backward jumps small
+    int64_t delta = (int64_t)(insn.ip - m_next_ip);
+    WriteULEB128(((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+  }
+  m_buffer.insert(m_buffer.end(), insn.raw, insn.raw + (header & 0x0f));
+  m_next_ip = insn.ip + (header & 0x0f);
+  m_size++;
+
+  if (m_buffer.size() >= k_log_chunk_size)
+    Flush();
+}
+
+void InstructionLog::Append(const char *error) {
+  if ((m_size % k_index_interval) == 0)
+    m_index.push_back({m_chunks.size(), m_buffer.size(), m_next_ip});
+
+  size_t length = error ? strlen(error) : 0;
+  m_buffer.push_back(0x80);
+  WriteULEB128(length);
+  m_buffer.insert(m_buffer.end(), error, error + length);
+  m_size++;
+
+  if (m_buffer.size() >= k_log_chunk_size)
+    Flush();
+}
+
+bool InstructionLog::Flush() {
+  if (!m_buffer.empty()) {
+    off_t offset = m_file->Write(m_buffer.data(), m_buffer.size());
+    if (offset < 0)
+      m_write_error = true;
+    m_chunks.push_back({offset, m_buffer.size()});
+    // Free the buffer, a log that is done doesn't need it anymore
+    std::vector<uint8_t>().swap(m_buffer);
+  }
+  return !m_write_error;
+}
+
+void InstructionLog::Truncate(uint64_t index) {
+  if (index >= m_size)
+    return;
+
+  // The entries after 'index' stay in the file, they are just no longer
+  // part of any chunk
+  uint64_t next_ip = 0;
+  Seek(index, next_ip);
+  if (m_read_chunk != SIZE_MAX) {
+    m_chunks.resize(m_read_chunk + 1);
+    m_chunks.back().size = m_read_offset;
+    if (m_read_offset == 0)
+      m_chunks.pop_back();
+  }
+  m_size = index;
+  m_next_ip = next_ip;
+  m_index.resize((index + k_index_interval - 1) / k_index_interval);
+  ReleaseReadBuffer();
+}
+
+void InstructionLog::Read(uint64_t index, uint64_t count,
+                          InstructionList &result_list) {
+  if (index >= m_size)
+    return;
+
+  count = std::min(count, m_size - index);
+  uint64_t next_ip = 0;
+  Seek(index, next_ip);
+  for (uint64_t i = 0; i < count; i++)
+    result_list.AppendInstruction(ReadEntry(next_ip));
+  ReleaseReadBuffer();
+}
+
+void InstructionLog::TrimOverlap(uint64_t index, InstructionLog &next_log) {
+  if (next_log.GetSize() == 0 || m_size <= index)
+    return;
+
+  InstructionList first;
+  next_log.Read(0, 1, first);
+  Instruction next_insn = first.GetInstructionAtIndex(0);
+  if (!next_insn.GetError().empty())
+    return;
+
+  InstructionList run;
+  Read(index, m_size - index, run);
+  for (size_t i = 0; i < run.GetSize(); i++) {
+    Instruction insn = run.GetInstructionAtIndex(i);
+    if (insn.GetError().empty() &&
+        insn.GetInsnAddress() == next_insn.GetInsnAddress()) {
+      Truncate(index + i);
+      return;
+    }
+  }
+}
+
+void InstructionLog::Seek(uint64_t index, uint64_t &next_ip) {
+  Flush();
+  const IndexEntry &entry = m_index[index / k_index_interval];
+  if (entry.chunk != m_read_chunk && !LoadChunk(entry.chunk))
+    m_read_buffer.clear();
+  m_read_offset = entry.offset;
+  next_ip = entry.next_ip;
+  for (uint64_t i = index - (index % k_index_interval); i < index; i++)
+    ReadEntry(next_ip);
+}
+
+Instruction InstructionLog::ReadEntry(uint64_t &next_ip) {
+  // Entries don't span chunks
+  if (m_read_offset >= m_read_buffer.size() &&
+      (m_read_chunk == SIZE_MAX || !LoadChunk(m_read_chunk + 1)))
+    return Instruction("can't read the instruction log");
+
+  int header = ReadByte();
+  if (header == EOF)
+    return Instruction("can't read the instruction log");
+
+  if (header & 0x80) {
+    std::string error(ReadULEB128(), '\0');
+    if (!ReadBytes(&error[0], error.size()))
+      return Instruction("can't read the instruction log");
+    return Instruction(error.c_str());
+  }
+
+  struct pt_insn insn;
+  memset(&insn, 0, sizeof(insn));
+  insn.size = header & 0x0f;
+  insn.speculative = (header & 0x20) ? 1 : 0;
+  insn.iclass = (header & 0x10) ? (enum pt_insn_class)ReadByte() : ptic_other;
+  if (header & 0x40) {
+    insn.ip = next_ip;
+  } else {
+    uint64_t zigzag = ReadULEB128();
+    insn.ip = next_ip + ((zigzag >> 1) ^ (0 - (zigzag & 1)));
+  }
+  if (!ReadBytes(insn.raw, insn.size))
+    return Instruction("can't read the instruction log");
+  next_ip = insn.ip + insn.size;
+  return Instruction(insn);
+}
+
+bool InstructionLog::LoadChunk(size_t chunk) {
+  m_read_offset = 0;
+  if (chunk >= m_chunks.size()) {
+    ReleaseReadBuffer();
+    return false;
+  }
+
+  const Chunk &entry = m_chunks[chunk];
+  m_read_buffer.resize(entry.size);
+  if (entry.file_offset < 0 ||
+      !m_file->Read(entry.file_offset, m_read_buffer.data(), entry.size)) {
+    ReleaseReadBuffer();
+    return false;
+  }
+  m_read_chunk = chunk;
+  return true;
+}
+
+void InstructionLog::ReleaseReadBuffer() {
+  std::vector<uint8_t>().swap(m_read_buffer);
+  m_read_chunk = SIZE_MAX;
+  m_read_offset = 0;
+}
+
+int InstructionLog::ReadByte() {
+  if (m_read_offset >= m_read_buffer.size())
+    return EOF;
+  return m_read_buffer[m_read_offset++];
+}
+
+bool InstructionLog::ReadBytes(void *data, size_t size) {
+  if (size > m_read_buffer.size() - m_read_offset)
+    return false;
+  memcpy(data, m_read_buffer.data() + m_read_offset, size);
+  m_read_offset += size;
+  return true;
+}
+
+void InstructionLog::WriteULEB128(uint64_t value) {
+  do {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    if (value != 0)
+      byte |= 0x80;
+    m_buffer.push_back(byte);
+  } while (value != 0);
+}
+
+uint64_t InstructionLog::ReadULEB128() {
+  uint64_t value = 0;
+  unsigned shift = 0;
+  int byte;
+  do {
+    byte = ReadByte();
+    if (byte == EOF || shift >= 64)
+      break;
+    value |= (uint64_t)(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return value;
+}
@@ -11,9 +11,14 @@
 #define Decoder_h_
 
 // C/C++ Includes
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <sys/types.h>
 #include <vector>
 
 // Project includes, Other libraries and framework includes
@@ -111,6 +116,133 @@ private:
   std::vector<Instruction> m_insn_vec;
 };
 
+//----------------------------------------------------------------------
+/// @class InstructionLogFile
+/// The temporary file in which the instruction logs of a trace are kept.
+///     The logs of all segments of a trace share it, so decoding a long
+///     trace doesn't need a file descriptor per segment. Logs append to it
+///     in chunks from several threads.
+//----------------------------------------------------------------------
+class InstructionLogFile {
+public:
+  InstructionLogFile();
+
+  ~InstructionLogFile();
+
+  // Whether the temporary file could be created
+  bool IsValid() const { return m_file != nullptr; }
+
+  // Append 'size' bytes at the end of the file. Returns the offset at which
+  // they were written, or -1 if writing failed.
+  off_t Write(const uint8_t *data, size_t size);
+
+  // Read 'size' bytes at 'offset'
+  bool Read(off_t offset, uint8_t *data, size_t size);
+
+private:
+  std::mutex m_mutex;
+  FILE *m_file;
+  off_t m_size; // bytes written to m_file so far
+
+  InstructionLogFile(const InstructionLogFile &) = delete;
+  const InstructionLogFile &operator=(const InstructionLogFile &) = delete;
+};
+
+//----------------------------------------------------------------------
+/// @class InstructionLog
+/// Represents the sequence of instructions decoded from a trace. It is
+///     kept in a compact encoding in a temporary file rather than in memory,
+///     since a trace of a few seconds decodes to billions of instructions,
+///     and is indexed so that any part of it can be read back.
+///
+///     Every instruction is stored as a header byte (raw byte count,
+///     whether it was executed speculatively, whether it directly follows
+///     the previous instruction and whether a classification byte
+///     follows), an optional classification byte, the address as a LEB128
+///     delta from the end of the previous instruction unless it directly
+///     follows it, and the raw bytes. An error is stored as a header byte
+///     with the top bit set followed by the LEB128 length and the bytes of
+///     the error string.
+///
+///     Entries are buffered in memory and written to the file in chunks of
+///     whole entries, which are read back a chunk at a time.
+//----------------------------------------------------------------------
+class InstructionLog {
+public:
+  InstructionLog(std::shared_ptr<InstructionLogFile> file);
+
+  ~InstructionLog();
+
+  // Get number of instructions (and errors) in the log
+  uint64_t GetSize() const { return m_size; }
+
+  // Append an instruction or an error at the end of the log
+  void Append(const struct pt_insn &insn);
+  void Append(const char *error);
+
+  // Write the buffered entries to the file. Returns false if writing this or
+  // an earlier chunk of the log failed.
+  bool Flush();
+
+  // Remove the entries at 'index' and after it
+  void Truncate(uint64_t index);
+
+  // Append 'count' entries starting at 'index' to 'result_list'
+  void Read(uint64_t index, uint64_t count, InstructionList &result_list);
+
+  // If the first entry of 'next_log' is an instruction at the same address
+  // as one of the entries of this log from 'index' on, remove the entries of
+  // this log from that one on
+  void TrimOverlap(uint64_t index, InstructionLog &next_log);
+
+private:
+  // A part of the log written to m_file in one piece
+  struct Chunk {
+    off_t file_offset; // -1 if writing the chunk failed
+    size_t size;
+  };
+
+  // One entry for every k_index_interval entries of the log
+  struct IndexEntry {
+    size_t chunk;     // index of the chunk holding the entry in m_chunks
+    size_t offset;    // offset of the entry in the chunk
+    uint64_t next_ip; // end address of the instruction before the entry
+  };
+
+  // Position the log at entry 'index', reading entries that aren't indexed.
+  // Updates 'next_ip' to the end address of the instruction before it.
+  void Seek(uint64_t index, uint64_t &next_ip);
+
+  // Read the entry at the current position
+  Instruction ReadEntry(uint64_t &next_ip);
+
+  // Make chunk 'chunk' the one that is read, from its start
+  bool LoadChunk(size_t chunk);
+
+  // Free the chunk that was read last
+  void ReleaseReadBuffer();
+
+  int ReadByte();
+  bool ReadBytes(void *data, size_t size);
+
+  void WriteULEB128(uint64_t value);
+  uint64_t ReadULEB128();
+
+  std::shared_ptr<InstructionLogFile> m_file;
+  std::vector<uint8_t> m_buffer;    // entries not written to m_file yet
+  std::vector<Chunk> m_chunks;      // parts of m_file holding the log
+  bool m_write_error;               // writing a chunk failed
+  uint64_t m_size;                  // number of entries
+  uint64_t m_next_ip;               // end address of the last instruction
+  std::vector<IndexEntry> m_index;
+  std::vector<uint8_t> m_read_buffer; // contents of chunk m_read_chunk
+  size_t m_read_chunk;                // SIZE_MAX if none was read
+  size_t m_read_offset;               // read position in m_read_buffer
+
+  InstructionLog(const InstructionLog &) = delete;
+  const InstructionLog &operator=(const InstructionLog &) = delete;
+};
+
 //----------------------------------------------------------------------
 /// @class TraceOptions
 /// Provides Intel(R) Processor Trace specific configuration options and
@@ -161,14 +293,15 @@ private:
 //----------------------------------------------------------------------
 class Decoder {
 public:
-  typedef std::vector<Instruction> Instructions;
+  typedef std::vector<std::unique_ptr<InstructionLog>> InstructionLogs;
 
   Decoder(lldb::SBDebugger &sbdebugger)
       : m_mapProcessUID_mapThreadID_TraceInfo_mutex(),
         m_mapProcessUID_mapThreadID_TraceInfo(),
-        m_debugger_user_id(sbdebugger.GetID()) {}
+        m_debugger_user_id(sbdebugger.GetID()),
+        m_image_section_cache(pt_iscache_alloc(nullptr)) {}
 
-  ~Decoder() {}
+  ~Decoder() { pt_iscache_free(m_image_section_cache); }
 
   void StartProcessorTrace(lldb::SBProcess &sbprocess,
                            lldb::SBTraceOptions &sbtraceoptions,
@@ -196,10 +329,13 @@ private:
     uint64_t file_offset;
     uint64_t size;
     std::string image_path;
+    int isid; // id of the section in the image section cache
 
     ReadExecuteSectionInfo(const uint64_t addr, const uint64_t offset,
-                           const uint64_t sz, const std::string &path)
-        : load_address(addr), file_offset(offset), size(sz), image_path(path) {}
+                           const uint64_t sz, const std::string &path,
+                           const int id)
+        : load_address(addr), file_offset(offset), size(sz), image_path(path),
+          isid(id) {}
 
     ReadExecuteSectionInfo(const ReadExecuteSectionInfo &rxsection) = default;
   };
@@ -207,6 +343,51 @@ private:
   typedef struct pt_cpu CPUInfo;
   typedef std::vector<ReadExecuteSectionInfo> ReadExecuteSectionInfos;
 
+  // internal class to read the raw trace of a thread from LLDB in windows on
+  // a separate thread, so that decoding can start before all of it arrived
+  class TraceDataStream {
+  public:
+    TraceDataStream(Buffer &pt_buffer)
+        : m_pt_buffer(pt_buffer), m_mutex(), m_data_available(),
+          m_bytes_available(0), m_done(false), m_error() {}
+
+    // Read the trace into the buffer window by window. Runs on the reading
+    // thread.
+    void Read(lldb::SBTrace &trace, lldb::tid_t tid);
+
+    // Block until a PSB packet at or after 'offset' arrived and return true
+    // with its offset in 'sync_offset'. Returns false with the size of the
+    // trace in 'sync_offset' if all of the trace was read without finding
+    // one.
+    bool WaitForSyncPoint(uint64_t offset, uint64_t &sync_offset);
+
+    // Only valid once the reading thread finished.
+    lldb::SBError &GetError() { return m_error; }
+
+  private:
+    Buffer &m_pt_buffer;
+    std::mutex m_mutex;
+    std::condition_variable m_data_available;
+    uint64_t m_bytes_available; // bytes of m_pt_buffer read so far
+    bool m_done;                // whole trace read (or reading failed)
+    lldb::SBError m_error;      // error of the reading thread
+  };
+
+  // A part of the raw trace that starts at a PSB packet (except for the first
+  // one) and is decoded independently of the other parts
+  struct TraceSegment {
+    uint64_t begin; // offset of the segment in the raw trace buffer
+    uint64_t end;
+    std::unique_ptr<InstructionLog> instruction_log;
+    lldb::SBError error;
+    // Index in the log of the first instruction after the last instruction
+    // that needed trace to be decoded (e.g. a branch)
+    uint64_t linear_run_begin;
+
+    TraceSegment(uint64_t b, uint64_t e)
+        : begin(b), end(e), instruction_log(), error(), linear_run_begin(0) {}
+  };
+
   // Check whether the provided SBProcess belongs to the same SBDebugger with
   // which Decoder class instance was constructed.
   void CheckDebuggerID(lldb::SBProcess &sbprocess, lldb::SBError &sberror);
@@ -223,27 +404,27 @@ private:
   ///  - Checks if the given thread is registered in the class or not. If not
   ///  then tries to register it if trace was ever started on the entire
   ///  process. Else returns error.
-  ///  - fetches trace and other necessary information from LLDB (using
-  ///  ReadTraceDataAndImageInfo()) and decodes the trace (using
-  ///  DecodeProcessorTrace())
+  ///  - fetches trace configuration and other necessary information from
+  ///  LLDB (using ReadTraceConfigAndImageInfo()) and reads and decodes the
+  ///  trace (using DecodeProcessorTrace())
   ///------------------------------------------------------------------------
   void FetchAndDecode(lldb::SBProcess &sbprocess, lldb::tid_t tid,
                       lldb::SBError &sberror,
                       ThreadTraceInfo **threadTraceInfo);
 
-  // Helper function of FetchAndDecode() to get raw trace data and memory image
-  // info of inferior from LLDB
-  void ReadTraceDataAndImageInfo(lldb::SBProcess &sbprocess, lldb::tid_t tid,
-                                 lldb::SBError &sberror,
-                                 ThreadTraceInfo &threadTraceInfo);
+  // Helper function of FetchAndDecode() to get trace configuration and memory
+  // image info of inferior from LLDB
+  void ReadTraceConfigAndImageInfo(lldb::SBProcess &sbprocess, lldb::tid_t tid,
+                                   lldb::SBError &sberror,
+                                   ThreadTraceInfo &threadTraceInfo);
 
-  // Helper function of FetchAndDecode() to initialize raw trace decoder and
-  // start trace decoding
+  // Helper function of FetchAndDecode() to read raw trace data from LLDB, split
+  // it into segments while it arrives and decode the segments in parallel
   void DecodeProcessorTrace(lldb::SBProcess &sbprocess, lldb::tid_t tid,
                             lldb::SBError &sberror,
                             ThreadTraceInfo &threadTraceInfo);
 
-  // Helper function of ReadTraceDataAndImageInfo() function for gathering
+  // Helper function of ReadTraceConfigAndImageInfo() function for gathering
   // inferior's memory image info along with all dynamic libraries linked with
   // it
   void GetTargetModulesInfo(lldb::SBTarget &sbtarget,
@@ -252,29 +433,34 @@ private:
 
   ///------------------------------------------------------------------------
   /// Helper functions of DecodeProcessorTrace() function for:
+  ///  - decoding one segment of the raw trace
   ///  - initializing raw trace decoder (provided by Intel(R) Processor Trace
   ///    Decoding library)
   ///  - start trace decoding
   ///------------------------------------------------------------------------
+  void DecodeSegment(const CPUInfo &pt_cpu, Buffer &pt_buffer,
+                     const ReadExecuteSectionInfos &readExecuteSectionInfos,
+                     const std::shared_ptr<InstructionLogFile> &log_file,
+                     TraceSegment &segment) const;
   void InitializePTInstDecoder(
       struct pt_insn_decoder **decoder, struct pt_config *config,
-      const CPUInfo &pt_cpu, Buffer &pt_buffer,
+      const CPUInfo &pt_cpu, uint8_t *begin, uint8_t *end,
       const ReadExecuteSectionInfos &readExecuteSectionInfos,
       lldb::SBError &sberror) const;
   void DecodeTrace(struct pt_insn_decoder *decoder,
-                   Instructions &instruction_list, lldb::SBError &sberror);
+                   TraceSegment &segment) const;
 
-  // Function to diagnose and indicate errors during raw trace decoding
+  // Function to diagnose and indicate errors during raw trace decoding.
+  // 'base_offset' is the offset of the decoded segment in the raw trace.
   void Diagnose(struct pt_insn_decoder *decoder, int errcode,
-                lldb::SBError &sberror, const struct pt_insn *insn = nullptr);
+                lldb::SBError &sberror, uint64_t base_offset,
+                const struct pt_insn *insn = nullptr) const;
 
   class ThreadTraceInfo {
   public:
     ThreadTraceInfo()
         : m_pt_buffer(), m_readExecuteSectionInfos(), m_thread_stop_id(0),
-          m_trace(), m_pt_cpu(), m_instruction_log() {}
-
-    ThreadTraceInfo(const ThreadTraceInfo &trace_info) = default;
+          m_trace(), m_pt_cpu(), m_instruction_logs() {}
 
     ~ThreadTraceInfo() {}
 
@@ -288,7 +474,15 @@ private:
 
     CPUInfo &GetCPUInfo() { return m_pt_cpu; }
 
-    Instructions &GetInstructionLog() { return m_instruction_log; }
+    // The instruction log is made of one log for each trace segment
+    InstructionLogs &GetInstructionLogs() { return m_instruction_logs; }
+
+    uint64_t GetInstructionLogSize() const {
+      uint64_t size = 0;
+      for (auto &log : m_instruction_logs)
+        size += log->GetSize();
+      return size;
+    }
 
     uint32_t GetStopID() const { return m_thread_stop_id; }
 
@@ -307,7 +501,7 @@ private:
     uint32_t m_thread_stop_id;     // stop id for thread
     lldb::SBTrace m_trace; // unique tracing instance of a thread/process
     CPUInfo m_pt_cpu; // cpu info of the target on which inferior is running
-    Instructions m_instruction_log; // complete instruction log
+    InstructionLogs m_instruction_logs; // complete instruction log
   };
 
   typedef std::map<lldb::user_id_t, ThreadTraceInfo> MapThreadID_TraceInfo;
@@ -321,6 +515,9 @@ private:
                                              // threads
   lldb::user_id_t m_debugger_user_id; // SBDebugger instance which is associated
                                       // to this Decoder instance
+  struct pt_image_section_cache
+      *m_image_section_cache; // sections of the inferior's modules, mapped
+                              // once and shared by all trace decoders
 };
 
 } // namespace ptdecoder_private
@@ -1041,6 +1041,9 @@ bool CMICmnLLDBDebuggerHandleEvents::HandleProcessEventStateStopped(
   case lldb::eStopReasonInstrumentation:
     pEventType = "eStopReasonInstrumentation";
     break;
+  case lldb::eStopReasonHistoryBoundary:
+    pEventType = "eStopReasonHistoryBoundary";
+    break;
   }
 
   // ToDo: Remove when finished coding application
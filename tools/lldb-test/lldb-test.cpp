@@ -23,7 +23,9 @@
 #include "lldb/Symbol/ClangASTImporter.h"
 #include "lldb/Symbol/CompileUnit.h"
 #include "lldb/Symbol/LineTable.h"
+#include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Symbol/SymbolVendor.h"
+#include "lldb/Symbol/Symtab.h"
 #include "lldb/Symbol/TypeList.h"
 #include "lldb/Symbol/VariableList.h"
 #include "lldb/Target/Process.h"
@@ -149,6 +151,11 @@ static FunctionNameType getFunctionNameFlags() {
 static cl::opt<bool> Verify("verify", cl::desc("Verify symbol information."),
                             cl::sub(SymbolsSubcommand));
 
+static cl::opt<bool> SymtabMemory(
+    "symtab-memory",
+    cl::desc("Print the memory used by the symbol table and its indexes."),
+    cl::sub(SymbolsSubcommand));
+
 static cl::opt<std::string> File("file",
                                  cl::desc("File (compile unit) to search."),
                                  cl::sub(SymbolsSubcommand));
@@ -163,6 +170,7 @@ static Error findTypes(lldb_private::Module &Module);
 static Error findVariables(lldb_private::Module &Module);
 static Error dumpModule(lldb_private::Module &Module);
 static Error verify(lldb_private::Module &Module);
+static Error dumpSymtabMemory(lldb_private::Module &Module);
 
 static Expected<Error (*)(lldb_private::Module &)> getAction();
 static int dumpSymbols(Debugger &Dbg);
@@ -522,7 +530,41 @@ Error opts::symbols::verify(lldb_private::Module &Module) {
   return Error::success();
 }
 
+Error opts::symbols::dumpSymtabMemory(lldb_private::Module &Module) {
+  ObjectFile *ObjFile = Module.GetObjectFile();
+  Symtab *Table = ObjFile ? ObjFile->GetSymtab() : nullptr;
+  if (!Table)
+    return make_string_error("Module has no symbol table.");
+
+  // Build the name and address indexes, as the first lookups would.
+  Table->PreloadSymbols();
+  Table->CalculateSymbolSizes();
+
+  const size_t NumSymbols = Table->GetNumSymbols();
+  const size_t SymbolBytes = Table->GetSymbolsMemorySize();
+  const size_t IndexBytes = Table->GetIndexesMemorySize();
+  outs() << formatv("Symbols: {0}\n", NumSymbols);
+  outs() << formatv("Symbol bytes: {0}\n", SymbolBytes);
+  outs() << formatv("Index bytes: {0}\n", IndexBytes);
+  if (NumSymbols)
+    outs() << formatv("Bytes per symbol: {0:f1}\n",
+                      double(SymbolBytes + IndexBytes) / NumSymbols);
+  return Error::success();
+}
+
 Expected<Error (*)(lldb_private::Module &)> opts::symbols::getAction() {
+  if (SymtabMemory) {
+    if (Verify || Find != FindType::None)
+      return make_string_error("-symtab-memory cannot be combined with "
+                               "-verify or -find.");
+    if (Regex || !Context.empty() || !Name.empty() || !File.empty() ||
+        Line != 0)
+      return make_string_error(
+          "-regex, -context, -name, -file and -line options are not "
+          "applicable for -symtab-memory.");
+    return dumpSymtabMemory;
+  }
+
   if (Verify) {
     if (Find != FindType::None)
       return make_string_error(
@@ -9,6 +9,7 @@
 
 #include "lldb/Host/MainLoop.h"
 #include "lldb/Host/ConnectionFileDescriptor.h"
+#include "lldb/Host/File.h"
 #include "lldb/Host/PseudoTerminal.h"
 #include "lldb/Host/common/TCPSocket.h"
 #include "gtest/gtest.h"
@@ -108,7 +109,53 @@ TEST_F(MainLoopTest, TerminatesImmediately) {
   ASSERT_EQ(1u, callback_count);
 }
 
+TEST_F(MainLoopTest, UnregisterInCallback) {
+  char X = 'X';
+  size_t len = sizeof(X);
+  ASSERT_TRUE(socketpair[0]->Write(&X, len).Success());
+  ASSERT_TRUE(socketpair[1]->Write(&X, len).Success());
+
+  // Both sockets are readable. Whichever callback runs first unregisters the
+  // other socket, whose callback must not run anymore.
+  MainLoop loop;
+  Status error;
+  MainLoop::ReadHandleUP handles[2];
+  unsigned calls[2] = {0, 0};
+  for (int i = 0; i < 2; ++i) {
+    handles[i] = loop.RegisterReadObject(socketpair[i],
+                                         [&, i](MainLoopBase &main_loop) {
+                                           ++calls[i];
+                                           handles[1 - i].reset();
+                                           if (calls[i] == 2)
+                                             main_loop.RequestTermination();
+                                         },
+                                         error);
+    ASSERT_TRUE(error.Success());
+  }
+
+  ASSERT_TRUE(loop.Run().Success());
+  ASSERT_EQ(2u, calls[0] + calls[1]);
+  ASSERT_TRUE(calls[0] == 0 || calls[1] == 0);
+}
+
 #ifdef LLVM_ON_UNIX
+TEST_F(MainLoopTest, RegularFile) {
+  FILE *stream = tmpfile();
+  ASSERT_NE(nullptr, stream);
+  auto file = std::make_shared<File>(fileno(stream), false);
+
+  // A regular file is always readable.
+  {
+    MainLoop loop;
+    Status error;
+    auto handle = loop.RegisterReadObject(file, make_callback(), error);
+    ASSERT_TRUE(error.Success());
+    ASSERT_TRUE(loop.Run().Success());
+    ASSERT_EQ(1u, callback_count);
+  }
+  fclose(stream);
+}
+
 TEST_F(MainLoopTest, DetectsEOF) {
   PseudoTerminal term;
   ASSERT_TRUE(term.OpenFirstAvailableMaster(O_RDWR, nullptr, 0));
@@ -0,0 +1,188 @@
+//===-- TaskPoolBenchmarkTest.cpp -------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// Timings of the task pool against the single queue pool it replaced. These
+// are disabled by default; run them with
+//   HostTests --gtest_also_run_disabled_tests --gtest_filter='*Benchmark*'
+
+#include "gtest/gtest.h"
+
+#include "lldb/Host/TaskPool.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace lldb_private;
+
+namespace {
+// The previous TaskPool: one locked queue of std::function, every task in a
+// heap allocated std::packaged_task and waits that block on futures.
+class LegacyTaskPool {
+public:
+  static LegacyTaskPool &GetInstance() {
+    static LegacyTaskPool *g_pool = new LegacyTaskPool();
+    return *g_pool;
+  }
+
+  template <typename F> std::future<void> AddTask(F &&f) {
+    auto task_sp =
+        std::make_shared<std::packaged_task<void()>>(std::forward<F>(f));
+    std::function<void()> task_fn = [task_sp]() { (*task_sp)(); };
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push(std::move(task_fn));
+    if (m_thread_count < GetHardwareConcurrencyHint()) {
+      m_thread_count++;
+      std::thread(&LegacyTaskPool::Worker, this).detach();
+    }
+    return task_sp->get_future();
+  }
+
+  void TaskMapOverInt(size_t begin, size_t end,
+                      const llvm::function_ref<void(size_t)> &func) {
+    const size_t num_workers =
+        std::min<size_t>(end - begin, GetHardwareConcurrencyHint());
+    std::atomic<size_t> idx{begin};
+    auto wrapper = [&idx, end, &func]() {
+      while (true) {
+        size_t i = idx.fetch_add(1);
+        if (i >= end)
+          break;
+        func(i);
+      }
+    };
+
+    std::vector<std::future<void>> futures;
+    for (size_t i = 0; i < num_workers; i++)
+      futures.push_back(AddTask(wrapper));
+    for (auto &future : futures)
+      future.wait();
+  }
+
+private:
+  void Worker() {
+    while (true) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_tasks.empty()) {
+        m_thread_count--;
+        break;
+      }
+      std::function<void()> f = std::move(m_tasks.front());
+      m_tasks.pop();
+      lock.unlock();
+      f();
+    }
+  }
+
+  std::mutex m_mutex;
+  std::queue<std::function<void()>> m_tasks;
+  uint32_t m_thread_count = 0;
+};
+} // namespace
+
+template <typename F> static double TimeIt(F &&f) {
+  const int kRepetitions = 5;
+  double best = 0;
+  for (int i = 0; i < kRepetitions; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (i == 0 || elapsed.count() < best)
+      best = elapsed.count();
+  }
+  return best;
+}
+
+static void Report(llvm::StringRef name, double legacy, double current) {
+  llvm::errs() << llvm::format("%-28s legacy %9.3f ms  current %9.3f ms\n",
+                               name.str().c_str(), legacy, current);
+}
+
+// A little work that the compiler can't throw away.
+static void Spin(std::atomic<size_t> &sink, size_t n) {
+  size_t value = n;
+  for (int i = 0; i < 64; ++i)
+    value = value * 2654435761u + i;
+  sink.fetch_add(value & 1, std::memory_order_relaxed);
+}
+
+TEST(TaskPoolBenchmarkTest, DISABLED_SmallTasks) {
+  const size_t kNumTasks = 100000;
+  std::atomic<size_t> sink{0};
+
+  double legacy = TimeIt([&]() {
+    std::vector<std::future<void>> futures;
+    futures.reserve(kNumTasks);
+    for (size_t i = 0; i < kNumTasks; ++i)
+      futures.push_back(
+          LegacyTaskPool::GetInstance().AddTask([&sink, i]() {
+            Spin(sink, i);
+          }));
+    for (auto &future : futures)
+      future.wait();
+  });
+
+  double current = TimeIt([&]() {
+    TaskGroup group;
+    for (size_t i = 0; i < kNumTasks; ++i)
+      group.Add([&sink, i]() { Spin(sink, i); });
+    group.Wait();
+  });
+
+  Report("small tasks", legacy, current);
+}
+
+TEST(TaskPoolBenchmarkTest, DISABLED_ParallelFor) {
+  const size_t kNumItems = 4000000;
+  std::atomic<size_t> sink{0};
+  auto fn = [&sink](size_t i) { Spin(sink, i); };
+
+  LegacyTaskPool &legacy_pool = LegacyTaskPool::GetInstance();
+  double legacy =
+      TimeIt([&]() { legacy_pool.TaskMapOverInt(0, kNumItems, fn); });
+  double current = TimeIt([&]() { TaskMapOverInt(0, kNumItems, fn); });
+  double batched = TimeIt(
+      [&]() { TaskMapOverInt(0, kNumItems, fn, /*batch_size=*/1024); });
+
+  Report("parallel for", legacy, current);
+  Report("parallel for, batch 1024", legacy, batched);
+}
+
+TEST(TaskPoolBenchmarkTest, DISABLED_NestedParallelFor) {
+  // Each outer item runs a parallel loop of its own, like indexing a module
+  // while modules are loaded in parallel. The legacy pool can't wait from a
+  // pool thread, so its inner loops run serially.
+  const size_t kOuter = 64;
+  const size_t kInner = 20000;
+  std::atomic<size_t> sink{0};
+
+  double legacy = TimeIt([&]() {
+    LegacyTaskPool::GetInstance().TaskMapOverInt(0, kOuter, [&](size_t) {
+      for (size_t j = 0; j < kInner; ++j)
+        Spin(sink, j);
+    });
+  });
+
+  double current = TimeIt([&]() {
+    TaskMapOverInt(0, kOuter, [&](size_t) {
+      TaskMapOverInt(0, kInner, [&](size_t j) { Spin(sink, j); },
+                     /*batch_size=*/256);
+    });
+  });
+
+  Report("nested parallel for", legacy, current);
+}
@@ -2,6 +2,10 @@
 
 #include "lldb/Host/TaskPool.h"
 
+#include <array>
+#include <chrono>
+#include <thread>
+
 using namespace lldb_private;
 
 TEST(TaskPoolTest, AddTask) {
@@ -43,3 +47,100 @@ TEST(TaskPoolTest, TaskMap) {
   ASSERT_EQ(data[2], 4);
   ASSERT_EQ(data[3], 9);
 }
+
+TEST(TaskPoolTest, TaskMapBatches) {
+  std::vector<std::atomic<int>> data(1000);
+  for (auto &value : data)
+    value = 0;
+  TaskMapOverInt(10, data.size(), [&data](size_t x) { data[x]++; },
+                 /*batch_size=*/7);
+
+  for (size_t x = 0; x < data.size(); ++x)
+    ASSERT_EQ(x < 10 ? 0 : 1, data[x]) << x;
+}
+
+TEST(TaskPoolTest, TaskMapMaxParallelism) {
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  TaskMapOverInt(0, 64,
+                 [&](size_t) {
+                   int now = ++running;
+                   int max = max_running;
+                   while (now > max &&
+                          !max_running.compare_exchange_weak(max, now))
+                     ;
+                   std::this_thread::sleep_for(std::chrono::microseconds(100));
+                   --running;
+                 },
+                 /*batch_size=*/1, /*max_parallelism=*/2);
+  EXPECT_LE(max_running, 2);
+}
+
+TEST(TaskPoolTest, NestedWaits) {
+  // Every task waits for more tasks. This needs the waiting threads to run
+  // queued tasks themselves, as there are more waits than pool threads.
+  const size_t outer = 4 * GetHardwareConcurrencyHint();
+  std::vector<size_t> sums(outer);
+  TaskMapOverInt(0, outer, [&sums](size_t i) {
+    std::vector<size_t> values(16);
+    TaskMapOverInt(0, values.size(), [&values, i](size_t j) {
+      TaskPool::RunTasks([&values, i, j]() { values[j] = i * j; });
+    });
+    for (size_t value : values)
+      sums[i] += value;
+  });
+
+  for (size_t i = 0; i < outer; ++i)
+    ASSERT_EQ(i * 120, sums[i]);
+}
+
+TEST(TaskPoolTest, WaitRunsOnlyItsGroup) {
+  // Tasks of another group are queued first, but the waiting thread leaves
+  // them to the pool.
+  const std::thread::id waiter = std::this_thread::get_id();
+  std::atomic<bool> waiting{false};
+  std::atomic<bool> ran_other{false};
+  TaskGroup other;
+  for (size_t i = 0; i < 100; ++i)
+    other.Add([&] {
+      if (waiting && std::this_thread::get_id() == waiter)
+        ran_other = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+
+  std::atomic<size_t> count{0};
+  TaskGroup group;
+  for (size_t i = 0; i < 10; ++i)
+    group.Add([&count] { ++count; });
+  waiting = true;
+  group.Wait();
+  waiting = false;
+  EXPECT_EQ(10u, count);
+  EXPECT_FALSE(ran_other);
+  other.Wait();
+}
+
+TEST(TaskPoolTest, TaskStorage) {
+  // Small callables live inside the Task, large ones on the heap; both have
+  // to survive being moved around.
+  int small_result = 0;
+  Task small([&small_result]() { small_result = 1; });
+  Task moved(std::move(small));
+  EXPECT_FALSE(small);
+  moved();
+  EXPECT_EQ(1, small_result);
+
+  std::array<int, 32> big_data;
+  big_data.fill(2);
+  int big_result = 0;
+  Task big([big_data, &big_result]() { big_result = big_data[31]; });
+  Task other;
+  other = std::move(big);
+  other();
+  EXPECT_EQ(2, big_result);
+
+  std::unique_ptr<int> owned(new int(3));
+  auto get = [](const std::unique_ptr<int> &value) { return *value; };
+  auto future = TaskPool::AddTask(get, std::move(owned));
+  EXPECT_EQ(3, future.get());
+}
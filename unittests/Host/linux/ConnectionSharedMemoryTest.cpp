@@ -0,0 +1,213 @@
+//===-- ConnectionSharedMemoryTest.cpp --------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Host/linux/ConnectionSharedMemory.h"
+#include "lldb/Host/ConnectionFileDescriptor.h"
+#include "lldb/Host/MainLoop.h"
+#include "lldb/Host/common/TCPSocket.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "gtest/gtest.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <future>
+#include <vector>
+
+using namespace lldb_private;
+using namespace lldb;
+
+namespace {
+class ConnectionSharedMemoryTest : public testing::Test {
+public:
+  void SetUp() override {
+    bool child_processes_inherit = false;
+    std::unique_ptr<TCPSocket> listen_socket_up(
+        new TCPSocket(true, child_processes_inherit));
+    ASSERT_TRUE(listen_socket_up->Listen("localhost:0", 5).Success());
+
+    Socket *accept_socket;
+    std::future<Status> accept_error = std::async(std::launch::async, [&] {
+      return listen_socket_up->Accept(accept_socket);
+    });
+
+    std::unique_ptr<TCPSocket> connect_socket_up(
+        new TCPSocket(true, child_processes_inherit));
+    ASSERT_TRUE(connect_socket_up
+                    ->Connect(llvm::formatv("localhost:{0}",
+                                            listen_socket_up
+                                                ->GetLocalPortNumber())
+                                  .str())
+                    .Success());
+    ASSERT_TRUE(accept_error.get().Success());
+
+    creator_control_sp = std::make_shared<ConnectionFileDescriptor>(
+        connect_socket_up.release());
+    creator.reset(new ConnectionSharedMemory(creator_control_sp));
+    peer.reset(new ConnectionSharedMemory(
+        std::make_shared<ConnectionFileDescriptor>(accept_socket)));
+  }
+
+protected:
+  void Connect() {
+    ASSERT_TRUE(creator->Create().Success());
+    Status error;
+    ASSERT_EQ(eConnectionStatusSuccess,
+              peer->Connect(creator->GetURI(), &error));
+    ASSERT_TRUE(error.Success());
+  }
+
+  ConnectionSP creator_control_sp;
+  std::unique_ptr<ConnectionSharedMemory> creator;
+  std::unique_ptr<ConnectionSharedMemory> peer;
+};
+} // namespace
+
+TEST_F(ConnectionSharedMemoryTest, ReadWrite) {
+  Connect();
+  llvm::StringRef path = llvm::StringRef(creator->GetURI()).drop_front(6);
+  ASSERT_FALSE(llvm::sys::fs::exists(path));
+
+  ConnectionStatus status;
+  char buffer[16];
+  ASSERT_EQ(0u, peer->Read(buffer, sizeof(buffer),
+                           std::chrono::microseconds(0), status, nullptr));
+  ASSERT_EQ(eConnectionStatusTimedOut, status);
+
+  // The peer was found waiting, so the write wakes up its main loop.
+  ASSERT_EQ(5u, creator->Write("hello", 5, status, nullptr));
+  MainLoop loop;
+  Status error;
+  auto handle = loop.RegisterReadObject(
+      peer->GetReadObject(),
+      [](MainLoopBase &loop) { loop.RequestTermination(); }, error);
+  ASSERT_TRUE(error.Success());
+  ASSERT_TRUE(loop.Run().Success());
+  ASSERT_EQ(5u, peer->Read(buffer, sizeof(buffer), std::chrono::seconds(1),
+                           status, nullptr));
+  ASSERT_EQ("hello", llvm::StringRef(buffer, 5));
+
+  ASSERT_EQ(5u, peer->Write("world", 5, status, nullptr));
+  ASSERT_EQ(5u, creator->Read(buffer, sizeof(buffer), std::chrono::seconds(1),
+                              status, nullptr));
+  ASSERT_EQ("world", llvm::StringRef(buffer, 5));
+}
+
+TEST_F(ConnectionSharedMemoryTest, LargeWrite) {
+  Connect();
+
+  // More than a ring holds, so the writer waits for the reader to make room
+  // and the data wraps around.
+  const size_t size = 5 << 20;
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = i % 251;
+  std::future<size_t> written = std::async(std::launch::async, [&] {
+    ConnectionStatus status;
+    return peer->Write(data.data(), data.size(), status, nullptr);
+  });
+
+  std::vector<uint8_t> received;
+  std::vector<uint8_t> buffer(64 * 1024);
+  while (received.size() < size) {
+    ConnectionStatus status;
+    size_t bytes_read = creator->Read(buffer.data(), buffer.size(),
+                                      std::chrono::seconds(5), status, nullptr);
+    ASSERT_EQ(eConnectionStatusSuccess, status);
+    received.insert(received.end(), buffer.begin(),
+                    buffer.begin() + bytes_read);
+  }
+  ASSERT_EQ(size, written.get());
+  ASSERT_TRUE(data == received);
+}
+
+TEST_F(ConnectionSharedMemoryTest, Disconnect) {
+  Connect();
+
+  std::future<std::string> read = std::async(std::launch::async, [&] {
+    std::string result;
+    char buffer[16];
+    ConnectionStatus status = eConnectionStatusSuccess;
+    while (status == eConnectionStatusSuccess) {
+      size_t bytes_read =
+          creator->Read(buffer, sizeof(buffer), llvm::None, status, nullptr);
+      result.append(buffer, bytes_read);
+    }
+    if (status != eConnectionStatusEndOfFile)
+      result = "unexpected status";
+    return result;
+  });
+
+  // What was written before the peer went away still gets read.
+  ConnectionStatus status;
+  ASSERT_EQ(3u, peer->Write("bye", 3, status, nullptr));
+  peer->Disconnect(nullptr);
+  ASSERT_EQ("bye", read.get());
+  ASSERT_EQ(0u, creator->Write("x", 1, status, nullptr));
+  ASSERT_EQ(eConnectionStatusLostConnection, status);
+}
+
+TEST_F(ConnectionSharedMemoryTest, InvalidURI) {
+  Status error;
+  ASSERT_EQ(eConnectionStatusError,
+            peer->Connect("shm:///dev/shm/lldb-does-not-exist", &error));
+  ASSERT_TRUE(error.Fail());
+
+  // A file that isn't a mapping is left alone.
+  const std::string path =
+      llvm::formatv("/dev/shm/lldb-test-{0}", getpid()).str();
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  ASSERT_NE(-1, fd);
+  ASSERT_EQ(0, ftruncate(fd, 8192));
+  close(fd);
+  ASSERT_EQ(eConnectionStatusError, peer->Connect("shm://" + path, &error));
+  ASSERT_TRUE(llvm::sys::fs::exists(path));
+
+  // So is a file that other users can access.
+  ASSERT_EQ(0, chmod(path.c_str(), 0644));
+  ASSERT_EQ(eConnectionStatusError, peer->Connect("shm://" + path, &error));
+  ASSERT_TRUE(llvm::sys::fs::exists(path));
+
+  // Symbolic links aren't followed.
+  const std::string link_path = path + "-link";
+  ASSERT_EQ(0, symlink(path.c_str(), link_path.c_str()));
+  ASSERT_EQ(eConnectionStatusError,
+            peer->Connect("shm://" + link_path, &error));
+  ASSERT_TRUE(llvm::sys::fs::exists(link_path));
+  llvm::sys::fs::remove(link_path);
+  llvm::sys::fs::remove(path);
+
+  // Only files that Create() could have made are opened at all.
+  int temp_fd;
+  llvm::SmallString<64> temp_path;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("shm-test", "", temp_fd, temp_path));
+  close(temp_fd);
+  ASSERT_EQ(eConnectionStatusError,
+            peer->Connect(("shm://" + temp_path).str(), &error));
+  ASSERT_TRUE(llvm::sys::fs::exists(temp_path));
+  llvm::sys::fs::remove(temp_path);
+  ASSERT_EQ(eConnectionStatusError,
+            peer->Connect("shm:///dev/shm/lldb-../lldb-test", &error));
+  ASSERT_FALSE(peer->IsConnected());
+}
+
+TEST_F(ConnectionSharedMemoryTest, NeverMapped) {
+  ASSERT_TRUE(creator->Create().Success());
+  std::string path = llvm::StringRef(creator->GetURI()).drop_front(6).str();
+  ASSERT_TRUE(llvm::sys::fs::exists(path));
+
+  // The creator cleans up after a peer that never came, and the control
+  // connection stays with its owner.
+  creator.reset();
+  ASSERT_FALSE(llvm::sys::fs::exists(path));
+  ASSERT_TRUE(creator_control_sp->IsConnected());
+}
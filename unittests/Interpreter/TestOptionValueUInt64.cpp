@@ -0,0 +1,44 @@
+//===-- TestOptionValueUInt64.cpp -------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+#include "lldb/Interpreter/OptionValueUInt64.h"
+
+using namespace lldb_private;
+
+static uint64_t Parse(llvm::StringRef str, bool &success) {
+  OptionValueUInt64 value(0, 0);
+  success = value.SetValueFromString(str).Success();
+  return value.GetCurrentValue();
+}
+
+TEST(OptionValueUInt64Test, SizeSuffixes) {
+  bool success;
+  EXPECT_EQ(1234u, Parse("1234", success));
+  EXPECT_TRUE(success);
+  EXPECT_EQ(0x10u, Parse("0x10", success));
+  EXPECT_TRUE(success);
+  EXPECT_EQ(2048u, Parse("2k", success));
+  EXPECT_TRUE(success);
+  EXPECT_EQ(3u << 20, Parse("3MB", success));
+  EXPECT_TRUE(success);
+  EXPECT_EQ(8ull << 30, Parse("8GB", success));
+  EXPECT_TRUE(success);
+  EXPECT_EQ(8ull << 30, Parse("8 GiB", success));
+  EXPECT_TRUE(success);
+
+  Parse("GB", success);
+  EXPECT_FALSE(success);
+  Parse("8TB", success);
+  EXPECT_FALSE(success);
+  Parse("8Gx", success);
+  EXPECT_FALSE(success);
+  Parse("99999999999999999999G", success);
+  EXPECT_FALSE(success);
+}
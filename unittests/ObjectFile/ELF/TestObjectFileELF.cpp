@@ -12,9 +12,11 @@
 #include "Plugins/SymbolVendor/ELF/SymbolVendorELF.h"
 #include "TestingSupport/TestUtilities.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Core/ModuleList.h"
 #include "lldb/Core/ModuleSpec.h"
 #include "lldb/Core/Section.h"
 #include "lldb/Host/HostInfo.h"
+#include "lldb/Host/TaskPool.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/FileUtilities.h"
@@ -138,3 +140,39 @@ TEST_F(ObjectFileELFTest, GetModuleSpecifications_EarlySectionHeaders) {
   Uuid.SetFromStringRef("1b8a73ac238390e32a7ff4ac8ebe4d6a41ecf5c9", 20);
   EXPECT_EQ(Spec.GetUUID(), Uuid);
 }
+
+TEST_F(ObjectFileELFTest, GetSharedModuleConcurrently) {
+  // Get each of a few copies of the same library from many threads at once.
+  // Their object files are parsed outside of the shared module list's lock,
+  // but every thread asking for the same file still has to get the same
+  // module.
+  std::string SO = GetInputFilePath("early-section-headers.so");
+  const size_t num_files = 8;
+  const size_t num_requests = 8 * num_files;
+  std::vector<llvm::SmallString<128>> files(num_files);
+  std::vector<std::unique_ptr<llvm::FileRemover>> removers;
+  for (llvm::SmallString<128> &file : files) {
+    ASSERT_NO_ERROR(llvm::sys::fs::createTemporaryFile(
+        "get-shared-module-%%%%%%", "so", file));
+    removers.emplace_back(new llvm::FileRemover(file));
+    ASSERT_NO_ERROR(llvm::sys::fs::copy_file(SO, file));
+  }
+
+  std::vector<ModuleSP> modules(num_requests);
+  TaskMapOverInt(0, num_requests, [&](size_t idx) {
+    ModuleSpec spec{FileSpec(files[idx % num_files], false)};
+    ModuleList::GetSharedModule(spec, modules[idx], nullptr, nullptr,
+                                nullptr);
+  });
+
+  for (size_t idx = 0; idx < num_requests; ++idx) {
+    ASSERT_NE(nullptr, modules[idx]);
+    EXPECT_EQ(modules[idx % num_files], modules[idx]);
+    if (idx < num_files) {
+      for (size_t other = 0; other < idx; ++other)
+        EXPECT_NE(modules[other], modules[idx]);
+    }
+  }
+  for (size_t idx = 0; idx < num_files; ++idx)
+    ModuleList::RemoveSharedModule(modules[idx]);
+}
@@ -437,6 +437,7 @@ TEST_F(GDBRemoteCommunicationClientTest, SendGetDataPacket) {
   std::string expected_packet1 =
       R"(jTraceBufferRead:{"buffersize" : 32,"offset" : 0,"threadid" : 35,)";
   std::string expected_packet2 = R"("traceid" : 3})";
+  HandlePacket(server, testing::StartsWith("qSupported:"), "");
   HandlePacket(server, expected_packet1+expected_packet2, "123456");
   ASSERT_TRUE(result.get().Success());
   ASSERT_EQ(buffer.size(), 3u);
@@ -454,6 +455,42 @@ TEST_F(GDBRemoteCommunicationClientTest, SendGetDataPacket) {
   ASSERT_EQ(buffer2.size(), 0u);
 }
 
+TEST_F(GDBRemoteCommunicationClientTest, SendGetDataPacketBinary) {
+  lldb::tid_t thread_id = 0x23;
+  lldb::user_id_t trace_id = 3;
+
+  uint8_t buf[32] = {};
+  llvm::MutableArrayRef<uint8_t> buffer(buf, 32);
+  size_t offset = 0;
+
+  std::future<Status> result = std::async(std::launch::async, [&] {
+    return client.SendGetDataPacket(trace_id, thread_id, buffer, offset);
+  });
+
+  std::string expected_packet1 = R"(jTraceBufferRead:{"binary" : true,)";
+  std::string expected_packet2 =
+      R"("buffersize" : 32,"offset" : 0,"threadid" : 35,"traceid" : 3})";
+  HandlePacket(server, testing::StartsWith("qSupported:"),
+               "PacketSize=20000;jTraceBinaryRead+");
+  // 0x23 ('#') is sent escaped as 0x7d 0x03.
+  HandlePacket(server, expected_packet1 + expected_packet2,
+               llvm::StringRef("b\x12\x7d\x03\x00", 5));
+  ASSERT_TRUE(result.get().Success());
+  ASSERT_EQ(buffer.size(), 3u);
+  ASSERT_EQ(buf[0], 0x12);
+  ASSERT_EQ(buf[1], 0x23);
+  ASSERT_EQ(buf[2], 0x00);
+
+  llvm::MutableArrayRef<uint8_t> buffer2(buf, 32);
+  result = std::async(std::launch::async, [&] {
+    return client.SendGetDataPacket(trace_id, thread_id, buffer2, offset);
+  });
+
+  HandlePacket(server, expected_packet1 + expected_packet2, "E23");
+  ASSERT_FALSE(result.get().Success());
+  ASSERT_EQ(buffer2.size(), 0u);
+}
+
 TEST_F(GDBRemoteCommunicationClientTest, SendGetMetaDataPacket) {
   lldb::tid_t thread_id = 0x23;
   lldb::user_id_t trace_id = 3;
@@ -469,6 +506,7 @@ TEST_F(GDBRemoteCommunicationClientTest, SendGetMetaDataPacket) {
   std::string expected_packet1 =
       R"(jTraceMetaRead:{"buffersize" : 32,"offset" : 0,"threadid" : 35,)";
   std::string expected_packet2 = R"("traceid" : 3})";
+  HandlePacket(server, testing::StartsWith("qSupported:"), "");
   HandlePacket(server, expected_packet1+expected_packet2, "123456");
   ASSERT_TRUE(result.get().Success());
   ASSERT_EQ(buffer.size(), 3u);
@@ -7,8 +7,14 @@
 //
 //===----------------------------------------------------------------------===//
 #include "GDBRemoteTestUtils.h"
+#include "lldb/Utility/StreamString.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Testing/Support/Error.h"
 
+#include <chrono>
+#include <future>
+
 using namespace lldb_private::process_gdb_remote;
 using namespace lldb_private;
 using namespace lldb;
@@ -25,6 +31,8 @@ public:
     return GDBRemoteCommunication::ReadPacket(response, std::chrono::seconds(1),
                                               /*sync_on_timeout*/ false);
   }
+
+  void DisableAcks() { m_send_acks = false; }
 };
 
 class GDBRemoteCommunicationTest : public GDBRemoteTest {
@@ -65,3 +73,60 @@ TEST_F(GDBRemoteCommunicationTest, ReadPacket_checksum) {
     ASSERT_EQ(PacketResult::Success, server.GetAck());
   }
 }
+
+TEST_F(GDBRemoteCommunicationTest, ReadPacket_many) {
+  // Write many packets at once, and the last one in two parts, to read them
+  // out of the same buffer.
+  const unsigned count = 2000;
+  StreamString packets;
+  for (unsigned i = 0; i < count; ++i) {
+    std::string payload = llvm::formatv("packet{0}", i).str();
+    uint8_t checksum = 0;
+    for (char c : payload)
+      checksum += c;
+    packets.Printf("$%s#%2.2x", payload.c_str(), checksum);
+  }
+  llvm::StringRef last = "$last#b4";
+  ASSERT_TRUE(Write(packets.GetString()));
+  ASSERT_TRUE(Write(last.take_front(3)));
+
+  StringExtractorGDBRemote response;
+  for (unsigned i = 0; i < count; ++i) {
+    ASSERT_EQ(PacketResult::Success, client.ReadPacket(response));
+    ASSERT_EQ(llvm::formatv("packet{0}", i).str(), response.GetStringRef());
+    ASSERT_EQ(PacketResult::Success, server.GetAck());
+  }
+
+  ASSERT_TRUE(Write(last.drop_front(3)));
+  ASSERT_EQ(PacketResult::Success, client.ReadPacket(response));
+  ASSERT_EQ("last", response.GetStringRef());
+  ASSERT_EQ(PacketResult::Success, server.GetAck());
+}
+
+// Packets per second read from a loopback socket. This is disabled by
+// default; run it with
+//   ProcessGdbRemoteTests --gtest_also_run_disabled_tests \
+//     --gtest_filter='*Benchmark*'
+TEST_F(GDBRemoteCommunicationTest, DISABLED_Benchmark_PacketsPerSecond) {
+  const unsigned count = 200000;
+  client.DisableAcks();
+  std::string payload(64, 'x');
+
+  auto start = std::chrono::steady_clock::now();
+  std::future<bool> sent = std::async(std::launch::async, [&] {
+    for (unsigned i = 0; i < count; ++i)
+      if (server.SendPacket(payload) != PacketResult::Success)
+        return false;
+    return true;
+  });
+  StringExtractorGDBRemote response;
+  for (unsigned i = 0; i < count; ++i)
+    ASSERT_EQ(PacketResult::Success, client.ReadPacket(response));
+  ASSERT_TRUE(sent.get());
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  llvm::errs() << llvm::format("%u packets in %.3f s: %.0f packets/s\n",
+                               count, elapsed.count(),
+                               count / elapsed.count());
+}
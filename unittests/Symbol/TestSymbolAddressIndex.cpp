@@ -0,0 +1,116 @@
+//===-- TestSymbolAddressIndex.cpp ------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "lldb/Symbol/SymbolAddressIndex.h"
+
+using namespace lldb_private;
+
+using Indexes = std::vector<uint32_t>;
+
+static Indexes FindAll(const SymbolAddressIndex &index, lldb::addr_t addr) {
+  Indexes indexes;
+  size_t count = index.FindSymbolIndexesContaining(addr, indexes);
+  EXPECT_EQ(count, indexes.size());
+  return indexes;
+}
+
+TEST(SymbolAddressIndexTest, Sort) {
+  SymbolAddressIndex index;
+  index.Append(0x300, 0x10, 0);
+  index.Append(0x100, 0x20, 1);
+  index.Append(0x100, 0x10, 2);
+  index.Append(0x200, 0x100000000ULL, 3);
+  index.Append(0x100, 0x10, 4);
+  index.Sort();
+
+  ASSERT_EQ(5u, index.GetSize());
+  EXPECT_EQ(0x100u, index.GetBaseAtIndex(0));
+  EXPECT_EQ(2u, index.GetSymbolIndexAtIndex(0));
+  EXPECT_EQ(4u, index.GetSymbolIndexAtIndex(1));
+  EXPECT_EQ(1u, index.GetSymbolIndexAtIndex(2));
+  EXPECT_EQ(0x20u, index.GetByteSizeAtIndex(2));
+  EXPECT_EQ(3u, index.GetSymbolIndexAtIndex(3));
+  EXPECT_EQ(0x100000000ULL, index.GetByteSizeAtIndex(3));
+  EXPECT_EQ(0u, index.GetSymbolIndexAtIndex(4));
+  EXPECT_EQ(0x300u, index.GetBaseAtIndex(4));
+
+  index.SetByteSizeAtIndex(3, 0x10);
+  EXPECT_EQ(0x10u, index.GetByteSizeAtIndex(3));
+}
+
+TEST(SymbolAddressIndexTest, FindStartingAt) {
+  SymbolAddressIndex index;
+  index.Append(0x200, 0x10, 0);
+  index.Append(0x100, 0, 1);
+  index.Append(0x100, 0x20, 2);
+  index.Sort();
+
+  EXPECT_EQ(1u, index.FindSymbolIndexStartingAt(0x100));
+  EXPECT_EQ(0u, index.FindSymbolIndexStartingAt(0x200));
+  EXPECT_EQ(UINT32_MAX, index.FindSymbolIndexStartingAt(0x108));
+  EXPECT_EQ(UINT32_MAX, index.FindSymbolIndexStartingAt(0x300));
+}
+
+TEST(SymbolAddressIndexTest, FindContaining) {
+  SymbolAddressIndex index;
+  // A function with a nested label, followed by a large range that covers
+  // everything after it and an empty symbol.
+  index.Append(0x1000, 0x100, 0);
+  index.Append(0x1010, 0x10, 1);
+  index.Append(0x1040, 0x10, 2);
+  index.Append(0x2000, 0x100000000ULL, 3);
+  index.Append(0x3000, 0x10, 4);
+  index.Append(0x3100, 0, 5);
+  index.Sort();
+
+  EXPECT_EQ(UINT32_MAX, index.FindSymbolIndexContaining(0xfff));
+  EXPECT_EQ(0u, index.FindSymbolIndexContaining(0x1000));
+  EXPECT_EQ(0u, index.FindSymbolIndexContaining(0x1018));
+  EXPECT_EQ(UINT32_MAX, index.FindSymbolIndexContaining(0x1100));
+  EXPECT_EQ(3u, index.FindSymbolIndexContaining(0x3008));
+
+  EXPECT_EQ(Indexes(), FindAll(index, 0x1100));
+  EXPECT_EQ(Indexes({0}), FindAll(index, 0x1020));
+  EXPECT_EQ(Indexes({0, 1}), FindAll(index, 0x1010));
+  // Entry 1 ends before 0x1048, entry 0 is still found behind it.
+  EXPECT_EQ(Indexes({0, 2}), FindAll(index, 0x1048));
+  EXPECT_EQ(Indexes({3, 4}), FindAll(index, 0x3000));
+  // Symbols without a size don't contain anything.
+  EXPECT_EQ(Indexes({3}), FindAll(index, 0x3100));
+  EXPECT_EQ(Indexes(), FindAll(index, 0x100002000ULL));
+}
+
+TEST(SymbolAddressIndexTest, FindContainingMany) {
+  // Compare against a linear scan on overlapping ranges.
+  SymbolAddressIndex index;
+  std::vector<std::pair<lldb::addr_t, lldb::addr_t>> ranges;
+  for (uint32_t i = 0; i < 500; ++i) {
+    lldb::addr_t base = (i * 7919) % 4000;
+    lldb::addr_t size = (i * 104729) % 97;
+    ranges.emplace_back(base, size);
+    index.Append(base, size, i);
+  }
+  index.Sort();
+
+  for (lldb::addr_t addr = 0; addr < 4200; addr += 3) {
+    Indexes expected;
+    for (size_t i = 0; i < index.GetSize(); ++i) {
+      const uint32_t idx = index.GetSymbolIndexAtIndex(i);
+      if (addr >= ranges[idx].first &&
+          addr < ranges[idx].first + ranges[idx].second)
+        expected.push_back(idx);
+    }
+    EXPECT_EQ(expected, FindAll(index, addr)) << addr;
+    EXPECT_EQ(expected.empty() ? UINT32_MAX : expected.front(),
+              index.FindSymbolIndexContaining(addr))
+        << addr;
+  }
+}
@@ -0,0 +1,183 @@
+//===-- HeapSnapshotTest.cpp ------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+
+#include "lldb/Target/HeapSnapshot.h"
+#include "lldb/Utility/FileSpec.h"
+
+using namespace lldb_private;
+
+namespace {
+// root -> a -> b -> c, root -> a -> d, and an unreachable cycle e <-> f that
+// is pointed at by g.
+//
+//   addresses: a=0x1000 b=0x2000 c=0x3000 d=0x4000 e=0x5000 f=0x6000
+//              g=0x7000
+class HeapSnapshotTest : public testing::Test {
+public:
+  void SetUp() override {
+    a = snapshot.AddObject(0x1000, 0x10, "Node");
+    b = snapshot.AddObject(0x2000, 0x20, "Node");
+    c = snapshot.AddObject(0x3000, 0x40, "Leaf");
+    d = snapshot.AddObject(0x4000, 0x80);
+    e = snapshot.AddObject(0x5000, 0x100, "Node");
+    f = snapshot.AddObject(0x6000, 0x200, "Node");
+    g = snapshot.AddObject(0x7000, 0x400, "Leaf");
+    snapshot.SetIsRoot(a);
+    snapshot.AddReference(a, b);
+    snapshot.AddReference(b, c);
+    snapshot.AddReference(a, d);
+    snapshot.AddReference(a, d); // Duplicates are merged.
+    snapshot.AddReference(e, f);
+    snapshot.AddReference(f, e);
+    snapshot.AddReference(g, e);
+    snapshot.Finalize();
+  }
+
+  HeapSnapshot snapshot;
+  uint32_t a, b, c, d, e, f, g;
+};
+} // namespace
+
+TEST_F(HeapSnapshotTest, Graph) {
+  ASSERT_EQ(7u, snapshot.GetNumObjects());
+  EXPECT_EQ(6u, snapshot.GetNumReferences());
+  EXPECT_EQ(2u, snapshot.GetReferences(a).size());
+  EXPECT_EQ("Node", snapshot.GetObjectTypeName(a));
+  EXPECT_EQ("", snapshot.GetObjectTypeName(d));
+
+  EXPECT_EQ(b, snapshot.FindObjectContaining(0x2000));
+  EXPECT_EQ(b, snapshot.FindObjectContaining(0x201f));
+  EXPECT_EQ(HeapSnapshot::kInvalidIndex, snapshot.FindObjectContaining(0x2020));
+  EXPECT_EQ(HeapSnapshot::kInvalidIndex, snapshot.FindObjectContaining(0xfff));
+}
+
+TEST_F(HeapSnapshotTest, Reachability) {
+  EXPECT_TRUE(snapshot.IsRoot(a));
+  EXPECT_FALSE(snapshot.IsRoot(b));
+  for (uint32_t idx : {a, b, c, d})
+    EXPECT_TRUE(snapshot.IsReachable(idx));
+  for (uint32_t idx : {e, f, g})
+    EXPECT_FALSE(snapshot.IsReachable(idx));
+}
+
+TEST_F(HeapSnapshotTest, Dominators) {
+  EXPECT_EQ(HeapSnapshot::kInvalidIndex, snapshot.GetDominator(a));
+  EXPECT_EQ(a, snapshot.GetDominator(b));
+  EXPECT_EQ(b, snapshot.GetDominator(c));
+  EXPECT_EQ(a, snapshot.GetDominator(d));
+  EXPECT_EQ(0x10u + 0x20 + 0x40 + 0x80, snapshot.GetRetainedSize(a));
+  EXPECT_EQ(0x20u + 0x40, snapshot.GetRetainedSize(b));
+  EXPECT_EQ(0x40u, snapshot.GetRetainedSize(c));
+
+  // The leaked cycle hangs off g, which nothing points to.
+  EXPECT_EQ(HeapSnapshot::kInvalidIndex, snapshot.GetDominator(g));
+  EXPECT_EQ(g, snapshot.GetDominator(e));
+  EXPECT_EQ(e, snapshot.GetDominator(f));
+  EXPECT_EQ(0x400u + 0x100 + 0x200, snapshot.GetRetainedSize(g));
+}
+
+TEST_F(HeapSnapshotTest, TypeStatistics) {
+  std::vector<HeapSnapshot::TypeStatistics> stats =
+      snapshot.GetTypeStatistics();
+  ASSERT_EQ(3u, stats.size());
+
+  // Leaf: c retains 0x40 and g retains 0x700.
+  EXPECT_EQ("Leaf", stats[0].name);
+  EXPECT_EQ(2u, stats[0].count);
+  EXPECT_EQ(0x440u, stats[0].size);
+  EXPECT_EQ(0x740u, stats[0].retained_size);
+  EXPECT_EQ(1u, stats[0].unreachable_count);
+  EXPECT_EQ(0x400u, stats[0].unreachable_size);
+
+  // Node: a retains everything reachable, e retains the cycle. b and f are
+  // dominated by other nodes, so they aren't counted again.
+  EXPECT_EQ("Node", stats[1].name);
+  EXPECT_EQ(4u, stats[1].count);
+  EXPECT_EQ(0x330u, stats[1].size);
+  EXPECT_EQ(0xf0u + 0x300, stats[1].retained_size);
+  EXPECT_EQ(2u, stats[1].unreachable_count);
+
+  EXPECT_EQ("", stats[2].name);
+  EXPECT_EQ(1u, stats[2].count);
+  EXPECT_EQ(0x80u, stats[2].retained_size);
+}
+
+TEST_F(HeapSnapshotTest, Diff) {
+  HeapSnapshot later;
+  later.AddObject(0x1000, 0x10, "Node");
+  later.AddObject(0x2000, 0x20, "Node");
+  later.AddObject(0x3000, 0x40, "Leaf");
+  later.AddObject(0x4000, 0x80);
+  later.AddObject(0x8000, 0x1000, "Leaf");
+  later.AddObject(0x9000, 0x1000, "Leaf");
+  later.Finalize();
+
+  std::vector<HeapSnapshot::TypeDelta> deltas =
+      HeapSnapshot::Diff(snapshot, later);
+  ASSERT_EQ(2u, deltas.size());
+  EXPECT_EQ("Leaf", deltas[0].name);
+  EXPECT_EQ(1, deltas[0].count_delta);
+  EXPECT_EQ(0x2000 - 0x400, deltas[0].size_delta);
+  EXPECT_EQ(2u, deltas[0].new_objects);
+  EXPECT_EQ("Node", deltas[1].name);
+  EXPECT_EQ(-2, deltas[1].count_delta);
+  EXPECT_EQ(-0x300, deltas[1].size_delta);
+  EXPECT_EQ(0u, deltas[1].new_objects);
+}
+
+TEST_F(HeapSnapshotTest, SaveAndLoad) {
+  llvm::SmallString<128> path;
+  int fd;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("heap", "snapshot", fd, path));
+  ::close(fd);
+  FileSpec file(path, false);
+
+  ASSERT_TRUE(snapshot.Save(file).Success());
+  HeapSnapshot loaded;
+  Status error = HeapSnapshot::Load(file, loaded);
+  llvm::sys::fs::remove(path);
+  ASSERT_TRUE(error.Success()) << error.AsCString();
+
+  ASSERT_EQ(snapshot.GetNumObjects(), loaded.GetNumObjects());
+  ASSERT_EQ(snapshot.GetNumReferences(), loaded.GetNumReferences());
+  for (uint32_t i = 0; i < snapshot.GetNumObjects(); ++i) {
+    EXPECT_EQ(snapshot.GetObjectAddress(i), loaded.GetObjectAddress(i));
+    EXPECT_EQ(snapshot.GetObjectSize(i), loaded.GetObjectSize(i));
+    EXPECT_EQ(snapshot.GetObjectTypeName(i), loaded.GetObjectTypeName(i));
+    EXPECT_EQ(snapshot.IsRoot(i), loaded.IsRoot(i));
+    EXPECT_EQ(snapshot.IsReachable(i), loaded.IsReachable(i));
+    EXPECT_EQ(snapshot.GetRetainedSize(i), loaded.GetRetainedSize(i));
+    EXPECT_EQ(snapshot.GetReferences(i), loaded.GetReferences(i));
+  }
+}
+
+TEST(HeapSnapshotLoadTest, RejectsGarbage) {
+  llvm::SmallString<128> path;
+  int fd;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("heap", "snapshot", fd, path));
+  const char garbage[] = "LLDBHEAP\x01\x00\x00\x00\x00\x00\x00\x00"
+                         "\xff\xff\xff\xff\x00\x00\x00\x00";
+  ASSERT_EQ((ssize_t)sizeof(garbage), ::write(fd, garbage, sizeof(garbage)));
+  ::close(fd);
+
+  HeapSnapshot loaded;
+  Status error = HeapSnapshot::Load(FileSpec(path, false), loaded);
+  llvm::sys::fs::remove(path);
+  EXPECT_TRUE(error.Fail());
+  EXPECT_EQ(0u, loaded.GetNumObjects());
+}
@@ -0,0 +1,123 @@
+//===-- BytePatternMatcherTest.cpp ------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Utility/BytePatternMatcher.h"
+#include "gtest/gtest.h"
+
+#include "llvm/ADT/StringRef.h"
+
+using namespace lldb_private;
+
+static llvm::ArrayRef<uint8_t> Bytes(llvm::StringRef str) {
+  return llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(str.data()), str.size());
+}
+
+static std::vector<lldb::addr_t> FindAddresses(const BytePatternMatcher &m,
+                                               llvm::StringRef data,
+                                               lldb::addr_t base = 0) {
+  std::vector<BytePatternMatcher::Match> matches;
+  m.FindMatches(Bytes(data), base, matches);
+  std::vector<lldb::addr_t> result;
+  for (const auto &match : matches)
+    result.push_back(match.addr);
+  return result;
+}
+
+TEST(BytePatternMatcherTest, RejectsMalformedPatterns) {
+  BytePatternMatcher m;
+  EXPECT_FALSE(m.AddPattern(Bytes("")));
+  EXPECT_FALSE(m.AddPattern(Bytes("abc"), Bytes("ab")));
+  EXPECT_EQ(0u, m.GetNumPatterns());
+}
+
+TEST(BytePatternMatcherTest, SinglePattern) {
+  BytePatternMatcher m;
+  ASSERT_TRUE(m.AddPattern(Bytes("needle")));
+  EXPECT_EQ(6u, m.GetMaxPatternSize());
+  EXPECT_EQ((std::vector<lldb::addr_t>{4, 14}),
+            FindAddresses(m, "hay needle hayneedle"));
+  EXPECT_EQ((std::vector<lldb::addr_t>{0x1004, 0x100e}),
+            FindAddresses(m, "hay needle hayneedle", 0x1000));
+  EXPECT_TRUE(FindAddresses(m, "needl").empty());
+  EXPECT_TRUE(FindAddresses(m, "").empty());
+}
+
+TEST(BytePatternMatcherTest, OverlappingMatches) {
+  BytePatternMatcher m;
+  ASSERT_TRUE(m.AddPattern(Bytes("aa")));
+  EXPECT_EQ((std::vector<lldb::addr_t>{0, 1, 2}), FindAddresses(m, "aaaa"));
+}
+
+TEST(BytePatternMatcherTest, MultiplePatterns) {
+  BytePatternMatcher m;
+  ASSERT_TRUE(m.AddPattern(Bytes("cd")));
+  ASSERT_TRUE(m.AddPattern(Bytes("abc")));
+  EXPECT_EQ(3u, m.GetMaxPatternSize());
+
+  std::vector<BytePatternMatcher::Match> matches;
+  m.FindMatches(Bytes("abcdxxcd"), 0, matches);
+  ASSERT_EQ(3u, matches.size());
+  EXPECT_EQ(0u, matches[0].addr);
+  EXPECT_EQ(1u, matches[0].pattern_index);
+  EXPECT_EQ(2u, matches[1].addr);
+  EXPECT_EQ(0u, matches[1].pattern_index);
+  EXPECT_EQ(6u, matches[2].addr);
+  EXPECT_EQ(0u, matches[2].pattern_index);
+}
+
+TEST(BytePatternMatcherTest, Mask) {
+  const uint8_t pattern[] = {0xde, 0xad, 0x00, 0xef};
+  const uint8_t mask[] = {0xff, 0xff, 0x00, 0xf0};
+  const uint8_t data[] = {0x00, 0xde, 0xad, 0x12, 0xe3,
+                          0xde, 0xad, 0x34, 0x3f};
+  BytePatternMatcher m;
+  ASSERT_TRUE(m.AddPattern(pattern, mask));
+  std::vector<BytePatternMatcher::Match> matches;
+  m.FindMatches(data, 0, matches);
+  ASSERT_EQ(1u, matches.size());
+  EXPECT_EQ(1u, matches[0].addr);
+}
+
+TEST(BytePatternMatcherTest, FullyMaskedPattern) {
+  // No byte can serve as an anchor, so every offset has to be compared.
+  const uint8_t pattern[] = {0x10, 0x20};
+  const uint8_t mask[] = {0xf0, 0xf0};
+  const uint8_t data[] = {0x1a, 0x2b, 0x00, 0x1c, 0x2d};
+  BytePatternMatcher m;
+  ASSERT_TRUE(m.AddPattern(pattern, mask));
+  std::vector<BytePatternMatcher::Match> matches;
+  m.FindMatches(data, 0, matches);
+  ASSERT_EQ(2u, matches.size());
+  EXPECT_EQ(0u, matches[0].addr);
+  EXPECT_EQ(3u, matches[1].addr);
+}
+
+TEST(BytePatternMatcherTest, Alignment) {
+  BytePatternMatcher m;
+  ASSERT_TRUE(m.AddPattern(Bytes("ab")));
+  m.SetAlignment(4);
+  EXPECT_EQ((std::vector<lldb::addr_t>{0x1008}),
+            FindAddresses(m, "xxabxxxxabxab", 0x1000));
+  // The alignment is relative to the address, not to the data.
+  EXPECT_EQ((std::vector<lldb::addr_t>{0x1004}),
+            FindAddresses(m, "xxabxxxxabxab", 0x1002));
+
+  const uint8_t pattern[] = {0x00};
+  const uint8_t mask[] = {0x0f};
+  const uint8_t data[] = {0x10, 0x20, 0x30, 0x40, 0x50};
+  BytePatternMatcher masked;
+  ASSERT_TRUE(masked.AddPattern(pattern, mask));
+  masked.SetAlignment(2);
+  std::vector<BytePatternMatcher::Match> matches;
+  masked.FindMatches(data, 1, matches);
+  ASSERT_EQ(2u, matches.size());
+  EXPECT_EQ(2u, matches[0].addr);
+  EXPECT_EQ(4u, matches[1].addr);
+}
@@ -16,6 +16,11 @@
 #include "llvm/Support/Threading.h"
 #include <thread>
 
+#if defined(LLVM_ON_UNIX)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 using namespace lldb;
 using namespace lldb_private;
 
@@ -312,3 +317,84 @@ TEST_F(LogChannelEnabledTest, LogGetLogThread) {
   // any undefined behavior (run the test under TSAN to verify this).
   EXPECT_THAT(mask, testing::AnyOf(0, FOO));
 }
+
+TEST_F(LogChannelEnabledTest, Async) {
+  std::string err;
+  EXPECT_TRUE(EnableChannel(getStream(),
+                            LLDB_LOG_OPTION_ASYNC |
+                                LLDB_LOG_OPTION_PREPEND_PROC_AND_THREAD,
+                            "chan", {}, err));
+
+  const size_t num_threads = 4;
+  const size_t num_messages = 100;
+  std::vector<std::thread> threads;
+  std::vector<uint64_t> tids(num_threads);
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([this, t, &tids] {
+      tids[t] = llvm::get_threadid();
+      for (size_t i = 0; i < num_messages; ++i)
+        LLDB_LOG(getLog(), "{0} {1}", t, i);
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+  getLog()->Printf("Printf %d", 47);
+  Log::FlushAsyncMessages();
+
+  // Every message arrives, with the header of the thread that logged it, in
+  // the order that thread logged them.
+  llvm::SmallVector<llvm::StringRef, 0> lines;
+  takeOutput().split(lines, '\n', -1, false);
+  ASSERT_EQ(num_threads * num_messages + 1, lines.size());
+  std::vector<size_t> next(num_threads);
+  for (llvm::StringRef line : llvm::makeArrayRef(lines).drop_back()) {
+    unsigned pid;
+    uint64_t tid;
+    size_t t, i;
+    ASSERT_EQ(4, sscanf(line.str().c_str(), "[%u/%" SCNu64 "] %zu %zu", &pid,
+                        &tid, &t, &i))
+        << line.str();
+    ASSERT_LT(t, num_threads);
+    EXPECT_EQ(tids[t], tid);
+    EXPECT_EQ(next[t]++, i);
+  }
+  EXPECT_EQ(llvm::formatv("[{0,0+4}/{1,0+4}] Printf 47", ::getpid(),
+                          llvm::get_threadid())
+                .str(),
+            lines.back());
+}
+
+#if defined(LLVM_ON_UNIX)
+TEST_F(LogChannelEnabledTest, AsyncAfterFork) {
+  // Installs the fork handler.
+  Log::Initialize();
+  std::string err;
+  EXPECT_TRUE(
+      EnableChannel(getStream(), LLDB_LOG_OPTION_ASYNC, "chan", {}, err));
+  LLDB_LOG(getLog(), "parent");
+
+  ::pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    // The writer thread isn't there in the child, so a flush that waited for
+    // it would hang.
+    alarm(10);
+    Log::FlushAsyncMessages();
+    std::string message;
+    auto stream_sp = std::make_shared<llvm::raw_string_ostream>(message);
+    if (!Log::EnableLogChannel(stream_sp, LLDB_LOG_OPTION_ASYNC, "chan", {},
+                               llvm::nulls()))
+      _exit(1);
+    LLDB_LOG(test_channel.GetLogIfAll(FOO), "child");
+    Log::FlushAsyncMessages();
+    _exit(stream_sp->str() == "child\n" ? 0 : 2);
+  }
+
+  int status;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+  Log::FlushAsyncMessages();
+  EXPECT_EQ("parent\n", takeOutput());
+}
+#endif
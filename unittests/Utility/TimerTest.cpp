@@ -9,6 +9,7 @@
 
 #include "lldb/Utility/StreamString.h"
 #include "lldb/Utility/Timer.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 #include <thread>
 
@@ -70,3 +71,50 @@ TEST(TimerTest, CategoryTimes2) {
   EXPECT_LT(0.001, seconds2);
   EXPECT_GT(0.1, seconds2);
 }
+
+TEST(TimerTest, Trace) {
+  static Timer::Category tcat1("CAT1");
+  static Timer::Category tcat2("CAT\"2\"");
+  Timer::SetTracing(true);
+  Timer::ResetTrace();
+  {
+    Timer t1(tcat1, "outer");
+    { Timer t5(tcat1, "bin\x01\x7f\xc3"); }
+    std::thread([] { Timer t2(tcat2, "inner %d", 42); }).join();
+    {
+      // Not finished when the trace is dumped.
+      Timer t3(tcat1, "running");
+      std::string trace;
+      llvm::raw_string_ostream os(trace);
+      Timer::DumpTrace(os);
+      os.flush();
+      EXPECT_EQ(std::string::npos, trace.find("running"));
+    }
+  }
+  Timer::SetTracing(false);
+  {
+    Timer t4(tcat1, "untraced");
+  }
+
+  std::string trace;
+  llvm::raw_string_ostream os(trace);
+  Timer::DumpTrace(os);
+  os.flush();
+
+  EXPECT_EQ(0u, trace.find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos,
+            trace.find("{\"name\":\"CAT1\",\"cat\":\"lldb\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos, trace.find("\"args\":{\"detail\":\"outer\"}"));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"CAT\\\"2\\\"\""));
+  EXPECT_NE(std::string::npos, trace.find("\"detail\":\"inner 42\""));
+  EXPECT_NE(std::string::npos, trace.find("\"detail\":\"running\""));
+  EXPECT_NE(std::string::npos,
+            trace.find("\"detail\":\"bin\\u0001\\u007f\\u00c3\""));
+  EXPECT_EQ(std::string::npos, trace.find("untraced"));
+
+  Timer::ResetTrace();
+  trace.clear();
+  Timer::DumpTrace(os);
+  os.flush();
+  EXPECT_EQ(std::string::npos, trace.find("\"ph\":\"X\""));
+}
@@ -0,0 +1,128 @@
+//===-- TrigramIndexTest.cpp ------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "lldb/Utility/DataExtractor.h"
+#include "lldb/Utility/RegularExpression.h"
+#include "lldb/Utility/TrigramIndex.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace lldb_private;
+
+using Literals = std::vector<std::string>;
+
+TEST(TrigramIndexTest, RequiredLiterals) {
+  EXPECT_EQ(Literals({"foo::bar"}),
+            TrigramIndex::GetRequiredLiterals("foo::bar"));
+  EXPECT_EQ(Literals({"std::vector<"}),
+            TrigramIndex::GetRequiredLiterals("^std::vector<"));
+  EXPECT_EQ(Literals({"foo", "bar"}),
+            TrigramIndex::GetRequiredLiterals("foo.*bar$"));
+  EXPECT_EQ(Literals({"fo", "bar"}),
+            TrigramIndex::GetRequiredLiterals("foo?bar"));
+  EXPECT_EQ(Literals({"fo", "bar"}),
+            TrigramIndex::GetRequiredLiterals("foo{0,3}bar"));
+  EXPECT_EQ(Literals({"foo", "obar"}),
+            TrigramIndex::GetRequiredLiterals("foo+bar"));
+  EXPECT_EQ(Literals({"a.b"}), TrigramIndex::GetRequiredLiterals("a\\.b"));
+  EXPECT_EQ(Literals({"get", "at"}),
+            TrigramIndex::GetRequiredLiterals("get[A-Z_]at"));
+  EXPECT_EQ(Literals({"x", "y"}),
+            TrigramIndex::GetRequiredLiterals("x[[:alpha:]]y"));
+  EXPECT_EQ(Literals({"pre", "post"}),
+            TrigramIndex::GetRequiredLiterals("pre(a|b)*post"));
+  EXPECT_EQ(Literals({"set", "value"}),
+            TrigramIndex::GetRequiredLiterals("set\\wvalue"));
+
+  // Nothing is required of every match.
+  EXPECT_EQ(Literals(), TrigramIndex::GetRequiredLiterals("foo|bar"));
+  EXPECT_EQ(Literals(), TrigramIndex::GetRequiredLiterals(".*"));
+  EXPECT_EQ(Literals(), TrigramIndex::GetRequiredLiterals("foo+?"));
+  EXPECT_EQ(Literals(), TrigramIndex::GetRequiredLiterals("foo[bar"));
+  EXPECT_EQ(Literals(), TrigramIndex::GetRequiredLiterals("foo(bar"));
+}
+
+static TrigramIndex MakeIndex() {
+  TrigramIndex index;
+  index.Insert(0, "main");
+  index.Insert(1, "foo::Bar::method()");
+  index.Insert(2, "foo::Baz::method()");
+  index.Insert(3, "FOO::BAR");
+  index.Insert(4, "ab");
+  index.Insert(5, "bar");
+  index.Insert(5, "_Z3barv");
+  index.Finalize();
+  return index;
+}
+
+TEST(TrigramIndexTest, FindCandidates) {
+  TrigramIndex index = MakeIndex();
+  std::vector<uint32_t> ids;
+
+  ASSERT_TRUE(index.FindCandidates("foo::bar", ids));
+  EXPECT_EQ(std::vector<uint32_t>({1, 3}), ids);
+
+  ASSERT_TRUE(index.FindCandidates("^foo.*method", ids));
+  EXPECT_EQ(std::vector<uint32_t>({1, 2}), ids);
+
+  ASSERT_TRUE(index.FindCandidates("bar", ids));
+  EXPECT_EQ(std::vector<uint32_t>({1, 3, 5}), ids);
+
+  ASSERT_TRUE(index.FindCandidates("nothing", ids));
+  EXPECT_TRUE(ids.empty());
+
+  // Literals that are too short or missing don't narrow anything down.
+  ids.assign(1, 42);
+  EXPECT_FALSE(index.FindCandidates("ab", ids));
+  EXPECT_FALSE(index.FindCandidates("main|foo", ids));
+  EXPECT_EQ(std::vector<uint32_t>({42}), ids);
+}
+
+TEST(TrigramIndexTest, FindCandidatesRegularExpression) {
+  TrigramIndex index = MakeIndex();
+  std::vector<uint32_t> ids;
+
+  RegularExpression regex(llvm::StringRef("foo::bar"));
+  ASSERT_TRUE(index.FindCandidates(regex, ids));
+  EXPECT_EQ(std::vector<uint32_t>({1, 3}), ids);
+
+  // An expression that didn't compile can't be used to narrow anything.
+  RegularExpression invalid(llvm::StringRef("foo::bar("));
+  ASSERT_FALSE(invalid.IsValid());
+  EXPECT_FALSE(index.FindCandidates(invalid, ids));
+}
+
+TEST(TrigramIndexTest, EncodeDecode) {
+  TrigramIndex index = MakeIndex();
+  std::string buffer;
+  llvm::raw_string_ostream os(buffer);
+  index.Encode(os);
+  os.flush();
+
+  DataExtractor data(buffer.data(), buffer.size(), lldb::eByteOrderLittle, 8);
+  lldb::offset_t offset = 0;
+  TrigramIndex decoded;
+  ASSERT_TRUE(decoded.Decode(data, &offset));
+  EXPECT_EQ(buffer.size(), offset);
+
+  std::vector<uint32_t> expected, ids;
+  for (const char *regex : {"foo::bar", "method", "bar", "nothing"}) {
+    ASSERT_TRUE(index.FindCandidates(regex, expected));
+    ASSERT_TRUE(decoded.FindCandidates(regex, ids));
+    EXPECT_EQ(expected, ids) << regex;
+  }
+
+  // Truncated data is rejected.
+  DataExtractor truncated(buffer.data(), buffer.size() - 1,
+                          lldb::eByteOrderLittle, 8);
+  offset = 0;
+  EXPECT_FALSE(decoded.Decode(truncated, &offset));
+  EXPECT_TRUE(decoded.IsEmpty());
+}
@@ -0,0 +1,224 @@
+//===-- InstructionLogTest.cpp ----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Decoder.h"
+#include "gtest/gtest.h"
+
+using namespace ptdecoder_private;
+
+namespace {
+struct pt_insn MakeInsn(uint64_t ip, uint8_t size, uint8_t fill = 0x90,
+                        enum pt_insn_class iclass = ptic_other,
+                        bool speculative = false) {
+  struct pt_insn insn;
+  memset(&insn, 0, sizeof(insn));
+  insn.ip = ip;
+  insn.size = size;
+  memset(insn.raw, fill, size);
+  insn.iclass = iclass;
+  insn.speculative = speculative ? 1 : 0;
+  return insn;
+}
+
+std::vector<uint8_t> GetBytes(const Instruction &insn) {
+  std::vector<uint8_t> bytes(insn.GetRawBytes(nullptr, 0));
+  insn.GetRawBytes(bytes.data(), bytes.size());
+  return bytes;
+}
+
+class InstructionLogTest : public testing::Test {
+public:
+  void SetUp() override {
+    file = std::make_shared<InstructionLogFile>();
+    ASSERT_TRUE(file->IsValid());
+  }
+
+protected:
+  std::shared_ptr<InstructionLogFile> file;
+};
+} // namespace
+
+TEST_F(InstructionLogTest, Encoding) {
+  InstructionLog log(file);
+  log.Append(MakeInsn(0x400000, 1));                  // first instruction
+  log.Append(MakeInsn(0x400001, 5, 0xe8, ptic_call)); // sequential
+  log.Append(MakeInsn(0x400100, 15, 0x66));           // jump forward
+  log.Append(MakeInsn(0x3ff000, 2, 0x74, ptic_cond_jump, true)); // backward
+  log.Append("decode error");
+  log.Append(MakeInsn(0x7fffffffe000, 3)); // far jump, after the error
+  log.Append(MakeInsn(0x7fffffffe003, 4));
+  ASSERT_EQ(7u, log.GetSize());
+
+  InstructionList list;
+  log.Read(0, 7, list);
+  ASSERT_EQ(7u, list.GetSize());
+
+  const uint64_t addresses[] = {0x400000, 0x400001,       0x400100, 0x3ff000,
+                                0,        0x7fffffffe000, 0x7fffffffe003};
+  const size_t sizes[] = {1, 5, 15, 2, 0, 3, 4};
+  for (size_t i = 0; i < 7; i++) {
+    Instruction insn = list.GetInstructionAtIndex(i);
+    EXPECT_EQ(addresses[i], insn.GetInsnAddress()) << "entry " << i;
+    EXPECT_EQ(sizes[i], GetBytes(insn).size()) << "entry " << i;
+  }
+  EXPECT_EQ(std::vector<uint8_t>(5, 0xe8),
+            GetBytes(list.GetInstructionAtIndex(1)));
+  EXPECT_EQ(std::vector<uint8_t>(15, 0x66),
+            GetBytes(list.GetInstructionAtIndex(2)));
+  EXPECT_FALSE(list.GetInstructionAtIndex(2).GetSpeculative());
+  EXPECT_TRUE(list.GetInstructionAtIndex(3).GetSpeculative());
+  EXPECT_EQ("decode error", list.GetInstructionAtIndex(4).GetError());
+  EXPECT_TRUE(list.GetInstructionAtIndex(5).GetError().empty());
+
+  // Reads are clamped to the end of the log.
+  InstructionList tail;
+  log.Read(6, 10, tail);
+  ASSERT_EQ(1u, tail.GetSize());
+  EXPECT_EQ(0x7fffffffe003u, tail.GetInstructionAtIndex(0).GetInsnAddress());
+  InstructionList none;
+  log.Read(7, 1, none);
+  EXPECT_EQ(0u, none.GetSize());
+}
+
+TEST_F(InstructionLogTest, ReadAcrossIndexAndChunks) {
+  // Enough entries to need several index entries and chunks.
+  const uint64_t count = 50000;
+  InstructionLog log(file);
+  uint64_t ip = 0x1000;
+  for (uint64_t i = 0; i < count; i++) {
+    // A jump every 7 instructions.
+    if (i % 7 == 0)
+      ip += 0x100;
+    log.Append(MakeInsn(ip, 3, i & 0xff));
+    ip += 3;
+  }
+  ASSERT_EQ(count, log.GetSize());
+
+  InstructionList all;
+  log.Read(0, count, all);
+  ASSERT_EQ(count, all.GetSize());
+
+  const uint64_t starts[] = {0, 1023, 1024, 1025, 33333, count - 3};
+  for (uint64_t start : starts) {
+    InstructionList part;
+    log.Read(start, 3, part);
+    ASSERT_EQ(3u, part.GetSize());
+    for (uint64_t i = 0; i < 3; i++) {
+      Instruction expected = all.GetInstructionAtIndex(start + i);
+      Instruction actual = part.GetInstructionAtIndex(i);
+      EXPECT_EQ(expected.GetInsnAddress(), actual.GetInsnAddress());
+      EXPECT_EQ(std::vector<uint8_t>(3, (start + i) & 0xff), GetBytes(actual));
+    }
+  }
+}
+
+TEST_F(InstructionLogTest, SharedFile) {
+  // Logs that share a file write to it in interleaved chunks.
+  InstructionLog log1(file);
+  InstructionLog log2(file);
+  const uint64_t count = 40000;
+  for (uint64_t i = 0; i < count; i++) {
+    log1.Append(MakeInsn(0x10000 + 2 * i, 2, 0x11));
+    log2.Append(MakeInsn(0x90000 - 2 * i, 2, 0x22));
+  }
+  ASSERT_TRUE(log1.Flush());
+  ASSERT_TRUE(log2.Flush());
+
+  InstructionList list1, list2;
+  log1.Read(0, count, list1);
+  log2.Read(0, count, list2);
+  ASSERT_EQ(count, list1.GetSize());
+  ASSERT_EQ(count, list2.GetSize());
+  for (uint64_t i = 0; i < count; i += 997) {
+    EXPECT_EQ(0x10000 + 2 * i,
+              list1.GetInstructionAtIndex(i).GetInsnAddress());
+    EXPECT_EQ(0x90000 - 2 * i,
+              list2.GetInstructionAtIndex(i).GetInsnAddress());
+    EXPECT_EQ(std::vector<uint8_t>(2, 0x22),
+              GetBytes(list2.GetInstructionAtIndex(i)));
+  }
+}
+
+TEST_F(InstructionLogTest, TruncateAndAppend) {
+  InstructionLog log(file);
+  for (uint64_t i = 0; i < 3000; i++)
+    log.Append(MakeInsn(0x1000 + 4 * i, 4));
+
+  log.Truncate(2048);
+  ASSERT_EQ(2048u, log.GetSize());
+
+  // The next instruction is encoded relative to the new last one.
+  log.Append(MakeInsn(0x1000 + 4 * 2048, 4, 0xcc));
+  log.Append(MakeInsn(0x500, 1, 0xc3));
+  ASSERT_EQ(2050u, log.GetSize());
+
+  InstructionList list;
+  log.Read(2046, 10, list);
+  ASSERT_EQ(4u, list.GetSize());
+  EXPECT_EQ(0x1000u + 4 * 2046, list.GetInstructionAtIndex(0).GetInsnAddress());
+  EXPECT_EQ(0x1000u + 4 * 2048, list.GetInstructionAtIndex(2).GetInsnAddress());
+  EXPECT_EQ(std::vector<uint8_t>(4, 0xcc),
+            GetBytes(list.GetInstructionAtIndex(2)));
+  EXPECT_EQ(0x500u, list.GetInstructionAtIndex(3).GetInsnAddress());
+
+  // Truncating past the end does nothing.
+  log.Truncate(5000);
+  EXPECT_EQ(2050u, log.GetSize());
+}
+
+TEST_F(InstructionLogTest, TrimOverlap) {
+  // A segment ending with a branch followed by straight line code, and the
+  // next segment starting in the middle of that code.
+  InstructionLog log(file);
+  log.Append(MakeInsn(0x104, 2)); // same address as the overlap, before it
+  log.Append(MakeInsn(0x200, 2, 0x75, ptic_cond_jump));
+  log.Append(MakeInsn(0x100, 2));
+  log.Append(MakeInsn(0x102, 2));
+  log.Append(MakeInsn(0x104, 2));
+  log.Append(MakeInsn(0x106, 2));
+  InstructionLog next_log(file);
+  next_log.Append(MakeInsn(0x104, 2));
+  next_log.Append(MakeInsn(0x106, 2));
+
+  log.TrimOverlap(2, next_log);
+  ASSERT_EQ(4u, log.GetSize());
+  EXPECT_EQ(2u, next_log.GetSize());
+  InstructionList list;
+  log.Read(3, 1, list);
+  EXPECT_EQ(0x102u, list.GetInstructionAtIndex(0).GetInsnAddress());
+}
+
+TEST_F(InstructionLogTest, TrimOverlapWithoutMatch) {
+  InstructionLog log(file);
+  log.Append(MakeInsn(0x100, 2));
+  log.Append(MakeInsn(0x102, 2));
+
+  // No common address.
+  InstructionLog next_log(file);
+  next_log.Append(MakeInsn(0x300, 2));
+  log.TrimOverlap(0, next_log);
+  EXPECT_EQ(2u, log.GetSize());
+
+  // The address only appears before the straight line code.
+  InstructionLog next_log2(file);
+  next_log2.Append(MakeInsn(0x100, 2));
+  log.TrimOverlap(1, next_log2);
+  EXPECT_EQ(2u, log.GetSize());
+
+  // The next segment starts with an error.
+  InstructionLog next_log3(file);
+  next_log3.Append("no sync");
+  log.TrimOverlap(0, next_log3);
+  EXPECT_EQ(2u, log.GetSize());
+
+  // The next segment is empty.
+  InstructionLog next_log4(file);
+  log.TrimOverlap(0, next_log4);
+  EXPECT_EQ(2u, log.GetSize());
+}